@@ -213,6 +213,157 @@ void test_render_result() {
     std::cout << "✓\n";
 }
 
+void test_render_view() {
+    std::cout << "Testing RenderView... ";
+
+    try {
+        ucra::Engine engine;
+        ucra::RenderConfig config(44100, 2, 512);
+        config.add_note(ucra::NoteSegment(0.0, 0.1, 69, 80, "a"));
+
+        ucra::RenderResult copied = engine.render(config);
+        ucra::RenderView view = engine.render_view(config);
+        assert(view.status() == UCRA_SUCCESS);
+        assert(view.frames() == copied.frames() && view.channels() == 2);
+        assert(view.pcm().size() == copied.pcm().size());
+        for (size_t i = 0; i < view.pcm().size(); ++i) {
+            assert(view.pcm()[i] == copied.pcm()[i]);
+        }
+        for (const auto& kv : view.metadata()) {
+            assert(view.metadata_value(kv.key) != nullptr);
+        }
+        assert(view.metadata_value("no_such_key") == nullptr);
+
+        std::cout << "✓\n";
+    } catch (const ucra::UcraException& e) {
+        std::cout << "⚠ (RenderView test skipped: " << e.what() << ")\n";
+    }
+}
+
+void test_stream_read_into() {
+    std::cout << "Testing Stream::read_into... ";
+
+    try {
+        ucra::RenderConfig config(44100, 2, 256);
+        ucra::Stream stream(config, [] {
+            ucra::RenderConfig next(44100, 2, 256);
+            next.add_note(ucra::NoteSegment(0.0, 1.0, 69, 80, "a"));
+            return next;
+        });
+        assert(stream.channels() == 2);
+
+        // An odd sample count holds only whole frames
+        std::vector<float> block(2 * 256 + 1, -2.0f);
+        uint32_t frames = stream.read_into(block);
+        assert(frames <= 256);
+        assert(block.back() == -2.0f);
+
+        float small[1];
+        assert(stream.read_into(small) == 0);
+
+        std::cout << "✓\n";
+    } catch (const ucra::UcraException& e) {
+        std::cout << "⚠ (Stream test skipped: " << e.what() << ")\n";
+    }
+}
+
+static ucra::RenderConfig pool_config(double duration_sec, int16_t midi_note) {
+    ucra::RenderConfig config(44100, 1, 512);
+    config.add_note(ucra::NoteSegment(0.0, duration_sec, midi_note, 80, "a"));
+    config.add_note(ucra::NoteSegment(duration_sec, duration_sec, midi_note + 2, 80, "i"));
+    return config;
+}
+
+#ifdef UCRA_CPP_HAS_COROUTINES
+struct DetachedTask {
+    struct promise_type {
+        DetachedTask get_return_object() { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+};
+
+static DetachedTask await_render(ucra::EnginePool& pool, ucra::RenderConfig config, std::promise<uint64_t>& frames) {
+    ucra::RenderResult result = co_await pool.render_async(std::move(config));
+    frames.set_value(result.frames());
+}
+#endif
+
+void test_engine_pool() {
+    std::cout << "Testing EnginePool... ";
+
+    try {
+        ucra::Engine engine;
+        ucra::EnginePool pool({}, 2, 2);
+        assert(pool.size() == 2 && pool.queue_capacity() == 2);
+
+        // More renders than workers and queue slots; each matches a blocking render
+        std::vector<ucra::PendingRender> pending;
+        for (int i = 0; i < 8; ++i) {
+            pending.push_back(pool.render_async(pool_config(0.05, static_cast<int16_t>(60 + i))));
+        }
+        for (int i = 0; i < 8; ++i) {
+            ucra::RenderConfig config = pool_config(0.05, static_cast<int16_t>(60 + i));
+            ucra::RenderResult expected = engine.render(config);
+            ucra::RenderResult result = pending[i].get();
+            assert(result.frames() == expected.frames());
+            assert(result.pcm() == expected.pcm());
+            assert(!pending[i].valid() && !pending[i].cancel());
+        }
+
+        // A render still queued behind a long one can be dropped
+        ucra::EnginePool single({}, 1, 4);
+        ucra::PendingRender running = single.render_async(pool_config(2.0, 60));
+        ucra::PendingRender queued = single.render_async(pool_config(0.05, 62));
+        if (queued.cancel()) {
+            bool cancelled = false;
+            try {
+                queued.get();
+            } catch (const ucra::RenderCancelled&) {
+                cancelled = true;
+            }
+            assert(cancelled);
+        }
+        assert(running.get().status() == UCRA_SUCCESS);
+
+        // A full queue turns try_render_async away without taking the config
+        bool refused = false;
+        std::vector<ucra::PendingRender> accepted;
+        for (int i = 0; i < 8 && !refused; ++i) {
+            ucra::RenderConfig config = pool_config(0.5, 60);
+            std::optional<ucra::PendingRender> attempt = single.try_render_async(config);
+            if (attempt) {
+                accepted.push_back(std::move(*attempt));
+            } else {
+                refused = config.notes().size() == 2;
+            }
+        }
+        assert(refused);
+
+        // Errors surface through the future; layout 3 is not a layout
+        bool failed = false;
+        try {
+            single.render_async(ucra::RenderConfig(44100, 1, 512, UCRA_RENDER_LAYOUT_MASK)).get();
+        } catch (const ucra::UcraException& e) {
+            failed = e.error_code() == UCRA_ERR_INVALID_ARGUMENT;
+        }
+        assert(failed);
+
+#ifdef UCRA_CPP_HAS_COROUTINES
+        std::promise<uint64_t> frames;
+        std::future<uint64_t> awaited = frames.get_future();
+        await_render(pool, pool_config(0.05, 64), frames);
+        assert(awaited.get() == 2 * 2205);
+#endif
+
+        std::cout << "✓\n";
+    } catch (const ucra::UcraException& e) {
+        std::cout << "⚠ (EnginePool test skipped: " << e.what() << ")\n";
+    }
+}
+
 int main() {
     std::cout << "Running UCRA C++ Wrapper Tests\n";
     std::cout << "===============================\n\n";
@@ -225,6 +376,9 @@ int main() {
     test_render_config();
     test_render_result();
     test_engine_lifecycle();
+    test_render_view();
+    test_stream_read_into();
+    test_engine_pool();
     test_manifest_loading();
 
     std::cout << "\n✅ All tests completed successfully!\n";
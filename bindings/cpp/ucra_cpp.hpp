@@ -21,6 +21,28 @@
 #include <unordered_map>
 #include <optional>
 #include <functional>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <thread>
+
+#if __cplusplus >= 202002L && defined(__has_include)
+#if __has_include(<span>)
+#include <span>
+#endif
+#endif
+
+#if defined(__cpp_impl_coroutine) && defined(__has_include)
+#if __has_include(<coroutine>)
+#include <coroutine>
+#define UCRA_CPP_HAS_COROUTINES 1
+#endif
+#endif
 
 namespace ucra {
 
@@ -52,11 +74,20 @@ private:
             case UCRA_ERR_FILE_NOT_FOUND: return "File not found";
             case UCRA_ERR_INVALID_JSON: return "Invalid JSON";
             case UCRA_ERR_INVALID_MANIFEST: return "Invalid manifest";
+            case UCRA_STREAM_UNCHANGED: return "Stream configuration unchanged";
             default: return "Unknown error";
         }
     }
 };
 
+/**
+ * @brief Thrown by the result of an asynchronous render cancelled before it started
+ */
+class RenderCancelled : public std::runtime_error {
+public:
+    RenderCancelled() : std::runtime_error("Render cancelled") {}
+};
+
 /**
  * @brief Utility function to check UCRA result and throw on error
  */
@@ -66,6 +97,47 @@ inline void check_result(UCRA_Result result) {
     }
 }
 
+#if defined(__cpp_lib_span)
+/** @brief Non-owning view of contiguous elements */
+template <typename T>
+using Span = std::span<T>;
+#else
+/**
+ * @brief Non-owning view of contiguous elements
+ *
+ * The subset of C++20 std::span the binding uses; with C++20 Span is std::span.
+ */
+template <typename T>
+class Span {
+public:
+    using element_type = T;
+    using iterator = T*;
+
+    constexpr Span() noexcept = default;
+    constexpr Span(T* data, size_t size) noexcept : data_(data), size_(size) {}
+
+    template <size_t N>
+    constexpr Span(T (&array)[N]) noexcept : data_(array), size_(N) {}
+
+    /** Any contiguous container with data() and size(), such as std::vector or std::array */
+    template <typename Container,
+              typename = std::enable_if_t<!std::is_same<std::decay_t<Container>, Span>::value &&
+                  std::is_convertible<decltype(std::declval<Container&>().data()), T*>::value>>
+    constexpr Span(Container& container) noexcept : data_(container.data()), size_(container.size()) {}
+
+    constexpr T* data() const noexcept { return data_; }
+    constexpr size_t size() const noexcept { return size_; }
+    constexpr bool empty() const noexcept { return size_ == 0; }
+    constexpr T& operator[](size_t index) const noexcept { return data_[index]; }
+    constexpr iterator begin() const noexcept { return data_; }
+    constexpr iterator end() const noexcept { return data_ + size_; }
+
+private:
+    T* data_{nullptr};
+    size_t size_{0};
+};
+#endif
+
 /**
  * @brief RAII wrapper for key-value pairs
  */
@@ -112,16 +184,18 @@ public:
         update_c_struct();
     }
 
+    /** Refreshed on every call, so copies and moves never point into another curve */
     const UCRA_F0Curve* c_struct() const noexcept {
+        update_c_struct();
         return time_sec_.empty() ? nullptr : &c_curve_;
     }
 
 private:
     std::vector<float> time_sec_;
     std::vector<float> f0_hz_;
-    UCRA_F0Curve c_curve_{};
+    mutable UCRA_F0Curve c_curve_{};
 
-    void update_c_struct() {
+    void update_c_struct() const {
         if (!time_sec_.empty()) {
             c_curve_.time_sec = time_sec_.data();
             c_curve_.f0_hz = f0_hz_.data();
@@ -158,16 +232,18 @@ public:
         update_c_struct();
     }
 
+    /** Refreshed on every call, so copies and moves never point into another curve */
     const UCRA_EnvCurve* c_struct() const noexcept {
+        update_c_struct();
         return time_sec_.empty() ? nullptr : &c_curve_;
     }
 
 private:
     std::vector<float> time_sec_;
     std::vector<float> value_;
-    UCRA_EnvCurve c_curve_{};
+    mutable UCRA_EnvCurve c_curve_{};
 
-    void update_c_struct() {
+    void update_c_struct() const {
         if (!time_sec_.empty()) {
             c_curve_.time_sec = time_sec_.data();
             c_curve_.value = value_.data();
@@ -210,7 +286,11 @@ public:
     void set_f0_override(F0Curve f0_override) { f0_override_ = std::move(f0_override); update_c_struct(); }
     void set_env_override(EnvCurve env_override) { env_override_ = std::move(env_override); update_c_struct(); }
 
-    const UCRA_NoteSegment& c_struct() const noexcept { return c_note_; }
+    /** Refreshed on every call, so copies and moves never point into another note */
+    const UCRA_NoteSegment& c_struct() const noexcept {
+        update_c_struct();
+        return c_note_;
+    }
 
 private:
     double start_sec_{0.0};
@@ -220,9 +300,9 @@ private:
     std::string lyric_;
     F0Curve f0_override_;
     EnvCurve env_override_;
-    UCRA_NoteSegment c_note_{};
+    mutable UCRA_NoteSegment c_note_{};
 
-    void update_c_struct() {
+    void update_c_struct() const {
         c_note_.start_sec = start_sec_;
         c_note_.duration_sec = duration_sec_;
         c_note_.midi_note = midi_note_;
@@ -343,15 +423,21 @@ public:
     RenderResult(RenderResult&&) = default;
     RenderResult& operator=(RenderResult&&) = default;
 
-    void update_from_c_result(const UCRA_RenderResult& c_result) {
+    /**
+     * @param c_result Result to copy
+     * @param flags Flags of the config it was rendered with, which select the PCM layout
+     */
+    void update_from_c_result(const UCRA_RenderResult& c_result, uint32_t flags = 0) {
         frames_ = c_result.frames;
         channels_ = c_result.channels;
         sample_rate_ = c_result.sample_rate;
         status_ = c_result.status;
+        layout_ = UCRA_RENDER_LAYOUT(flags);
 
         // Copy PCM data
         if (c_result.pcm && c_result.frames > 0) {
-            const size_t total_samples = c_result.frames * c_result.channels;
+            const size_t total_samples = layout_ == UCRA_RENDER_LAYOUT_MONO
+                ? c_result.frames : c_result.frames * c_result.channels;
             pcm_.assign(c_result.pcm, c_result.pcm + total_samples);
         } else {
             pcm_.clear();
@@ -373,17 +459,80 @@ public:
     uint32_t channels() const noexcept { return channels_; }
     uint32_t sample_rate() const noexcept { return sample_rate_; }
     UCRA_Result status() const noexcept { return status_; }
+    /** PCM layout (UCRA_RENDER_LAYOUT_*); for mono layout pcm() holds frames() samples */
+    uint32_t layout() const noexcept { return layout_; }
     const std::unordered_map<std::string, std::string>& metadata() const noexcept { return metadata_; }
 
 private:
+    friend class Engine;
+
     std::vector<float> pcm_;
     uint64_t frames_{0};
     uint32_t channels_{0};
     uint32_t sample_rate_{0};
     UCRA_Result status_{UCRA_SUCCESS};
+    uint32_t layout_{UCRA_RENDER_LAYOUT_INTERLEAVED};
     std::unordered_map<std::string, std::string> metadata_;
 };
 
+/**
+ * @brief Non-owning view of a render held by the engine
+ *
+ * Nothing is copied: pcm() and metadata() point into engine memory, which
+ * stays valid until the next render_view() or render() on the same engine
+ * or its destruction. Copy into a RenderResult to keep the audio longer.
+ */
+class RenderView {
+public:
+    RenderView() = default;
+
+    /**
+     * @param c_result Result to view
+     * @param flags Flags of the config it was rendered with, which select the PCM layout
+     */
+    explicit RenderView(const UCRA_RenderResult& c_result, uint32_t flags = 0)
+        : frames_(c_result.frames), channels_(c_result.channels), sample_rate_(c_result.sample_rate)
+        , status_(c_result.status), layout_(UCRA_RENDER_LAYOUT(flags)) {
+        if (c_result.pcm && c_result.frames > 0) {
+            const size_t total_samples = layout_ == UCRA_RENDER_LAYOUT_MONO
+                ? c_result.frames : c_result.frames * c_result.channels;
+            pcm_ = Span<const float>(c_result.pcm, total_samples);
+        }
+        if (c_result.metadata) {
+            metadata_ = Span<const UCRA_KeyValue>(c_result.metadata, c_result.metadata_count);
+        }
+    }
+
+    // Getters
+    Span<const float> pcm() const noexcept { return pcm_; }
+    uint64_t frames() const noexcept { return frames_; }
+    uint32_t channels() const noexcept { return channels_; }
+    uint32_t sample_rate() const noexcept { return sample_rate_; }
+    UCRA_Result status() const noexcept { return status_; }
+    /** PCM layout (UCRA_RENDER_LAYOUT_*); for mono layout pcm() holds frames() samples */
+    uint32_t layout() const noexcept { return layout_; }
+    Span<const UCRA_KeyValue> metadata() const noexcept { return metadata_; }
+
+    /** @return The metadata value for key, or nullptr if the render has none */
+    const char* metadata_value(const char* key) const noexcept {
+        for (const auto& kv : metadata_) {
+            if (kv.key && kv.value && std::strcmp(kv.key, key) == 0) {
+                return kv.value;
+            }
+        }
+        return nullptr;
+    }
+
+private:
+    Span<const float> pcm_;
+    uint64_t frames_{0};
+    uint32_t channels_{0};
+    uint32_t sample_rate_{0};
+    UCRA_Result status_{UCRA_SUCCESS};
+    uint32_t layout_{UCRA_RENDER_LAYOUT_INTERLEAVED};
+    Span<const UCRA_KeyValue> metadata_;
+};
+
 /**
  * @brief RAII wrapper for UCRA Engine
  */
@@ -457,13 +606,120 @@ public:
      * @return Render result
      */
     RenderResult render(RenderConfig& config) const {
+        RenderResult cpp_result;
+        render(config, cpp_result);
+        return cpp_result;
+    }
+
+    /**
+     * @brief Render audio without copying it out of the engine
+     * @param config Render configuration
+     * @return View of the engine's result, valid until the next render on this engine
+     */
+    RenderView render_view(RenderConfig& config) const {
         UCRA_RenderResult c_result;
-        UCRA_Result result = ucra_render(handle_, &config.c_struct(), &c_result);
+        check_result(ucra_render(handle_, &config.c_struct(), &c_result));
+        return RenderView(c_result, config.flags());
+    }
+
+    /**
+     * @brief Render audio into an existing result, reusing its PCM storage
+     *
+     * The engine writes directly into the result's buffer, which only grows,
+     * so rendering many short notes into the same result does not allocate.
+     * @param config Render configuration
+     * @param out Result to overwrite
+     */
+    void render(RenderConfig& config, RenderResult& out) const {
+        const size_t samples = query_size(config);
+        if (out.pcm_.size() < samples) {
+            out.pcm_.resize(samples);
+        }
+
+        UCRA_RenderResult c_result;
+        UCRA_Result result = ucra_render_into(handle_, &config.c_struct(),
+                                              out.pcm_.data(), out.pcm_.size(), &c_result);
         check_result(result);
 
-        RenderResult cpp_result;
-        cpp_result.update_from_c_result(c_result);
-        return cpp_result;
+        out.pcm_.resize(samples);
+        out.frames_ = c_result.frames;
+        out.channels_ = c_result.channels;
+        out.sample_rate_ = c_result.sample_rate;
+        out.status_ = c_result.status;
+        out.layout_ = UCRA_RENDER_LAYOUT(config.flags());
+        out.metadata_.clear();
+        for (uint32_t i = 0; i < c_result.metadata_count; ++i) {
+            const auto& kv = c_result.metadata[i];
+            if (kv.key && kv.value) {
+                out.metadata_[kv.key] = kv.value;
+            }
+        }
+    }
+
+    /**
+     * @brief Number of float samples a render of config will produce
+     * @param config Render configuration
+     * @return Required buffer size in samples (frames * channels)
+     */
+    size_t query_size(RenderConfig& config) const {
+        uint64_t samples = 0;
+        UCRA_Result result = ucra_render_query_size(handle_, &config.c_struct(), nullptr, &samples);
+        check_result(result);
+        return static_cast<size_t>(samples);
+    }
+
+    /**
+     * @brief Render audio into a caller-owned buffer
+     * @param config Render configuration
+     * @param out_pcm Destination for interleaved PCM32F data
+     * @param capacity_samples Number of floats available in out_pcm
+     * @return Number of frames written
+     */
+    uint64_t render_into(RenderConfig& config, float* out_pcm, size_t capacity_samples) const {
+        UCRA_RenderResult c_result;
+        UCRA_Result result = ucra_render_into(handle_, &config.c_struct(),
+                                              out_pcm, capacity_samples, &c_result);
+        check_result(result);
+        return c_result.frames;
+    }
+
+    /**
+     * @brief Render frames [start_frame, start_frame + frame_count) of a configuration
+     *
+     * Consecutive blocks over the same notes continue the engine's carried state.
+     * @param config Render configuration
+     * @param start_frame First frame to render
+     * @param frame_count Number of frames to render
+     * @param out_pcm Destination for frame_count frames in the config's layout
+     */
+    void render_block(RenderConfig& config, uint64_t start_frame, uint32_t frame_count, float* out_pcm) const {
+        check_result(ucra_render_block(handle_, &config.c_struct(), start_frame, frame_count, out_pcm));
+    }
+
+    /**
+     * @brief Render many independent configurations on the engine's worker pool
+     *
+     * Failed jobs do not throw; check each result's status().
+     * @param configs Render configurations
+     * @return One result per configuration, in the same order
+     */
+    std::vector<RenderResult> render_batch(std::vector<RenderConfig>& configs) const {
+        std::vector<UCRA_RenderConfig> c_configs;
+        c_configs.reserve(configs.size());
+        for (auto& config : configs) {
+            c_configs.push_back(config.c_struct());
+        }
+
+        std::vector<UCRA_RenderResult> c_results(configs.size());
+        // Every failure, including out-of-memory, is reported through each job's status
+        (void)ucra_render_batch(handle_, c_configs.data(), c_results.data(),
+                                static_cast<uint32_t>(c_results.size()));
+
+        std::vector<RenderResult> results(c_results.size());
+        for (size_t i = 0; i < c_results.size(); ++i) {
+            results[i].update_from_c_result(c_results[i], configs[i].flags());
+        }
+        return results;
     }
 
     /**
@@ -476,6 +732,282 @@ private:
     UCRA_Handle handle_{nullptr};
 };
 
+namespace detail {
+
+/**
+ * @brief State shared by an asynchronous render, its PendingRender and the pool
+ *
+ * The phase moves from queued to running to finished, or straight from queued
+ * to finished when the render is cancelled; whichever side leaves queued fulfils
+ * the promise.
+ */
+struct AsyncRender {
+    enum Phase { queued, running, finished };
+
+    explicit AsyncRender(RenderConfig render_config) : config(std::move(render_config)) {}
+
+    RenderConfig config;
+    std::promise<RenderResult> promise;
+    std::mutex mutex;
+    Phase phase{queued};
+#ifdef UCRA_CPP_HAS_COROUTINES
+    std::coroutine_handle<> waiter;
+#endif
+
+    /** @return false if the render was cancelled and must not run */
+    bool start() {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (phase != queued) {
+            return false;
+        }
+        phase = running;
+        return true;
+    }
+
+    /** @return true if the render had not started; its result then throws RenderCancelled */
+    bool cancel() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (phase != queued) {
+                return false;
+            }
+            promise.set_exception(std::make_exception_ptr(RenderCancelled()));
+        }
+        finish();
+        return true;
+    }
+
+    /** Mark the render finished, once its promise is fulfilled, and resume an awaiting coroutine */
+    void finish() {
+#ifdef UCRA_CPP_HAS_COROUTINES
+        std::coroutine_handle<> resume;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            phase = finished;
+            resume = std::exchange(waiter, nullptr);
+        }
+        if (resume) {
+            resume.resume();
+        }
+#else
+        std::lock_guard<std::mutex> lock(mutex);
+        phase = finished;
+#endif
+    }
+};
+
+} // namespace detail
+
+/**
+ * @brief Handle of a render queued on an EnginePool
+ *
+ * The result is moved out of the worker, never copied. Wait on it through
+ * future(), get() or, with C++20 coroutines, co_await; a coroutine is resumed
+ * on the worker thread that finished the render. Only one coroutine may await
+ * a render.
+ */
+class PendingRender {
+public:
+    PendingRender() = default;
+
+    /** @brief Future of the result; throws what the render threw, or RenderCancelled */
+    std::future<RenderResult>& future() noexcept { return future_; }
+
+    /** @brief Wait for the result and take it */
+    RenderResult get() { return future_.get(); }
+
+    /** @brief Whether the result has not been taken yet */
+    bool valid() const noexcept { return future_.valid(); }
+
+    /**
+     * @brief Drop the render if no engine has started it
+     * @return true if it was dropped; a render already running completes normally
+     */
+    bool cancel() { return state_ && state_->cancel(); }
+
+#ifdef UCRA_CPP_HAS_COROUTINES
+    struct Awaiter {
+        PendingRender& pending;
+
+        bool await_ready() const noexcept {
+            return pending.future_.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+        }
+        bool await_suspend(std::coroutine_handle<> handle) {
+            std::lock_guard<std::mutex> lock(pending.state_->mutex);
+            if (pending.state_->phase == detail::AsyncRender::finished) {
+                return false;
+            }
+            pending.state_->waiter = handle;
+            return true;
+        }
+        RenderResult await_resume() { return pending.future_.get(); }
+    };
+
+    Awaiter operator co_await() noexcept { return Awaiter{*this}; }
+#endif
+
+private:
+    friend class EnginePool;
+
+    explicit PendingRender(std::shared_ptr<detail::AsyncRender> state)
+        : state_(std::move(state)), future_(state_->promise.get_future()) {}
+
+    std::shared_ptr<detail::AsyncRender> state_;
+    std::future<RenderResult> future_;
+};
+
+/**
+ * @brief Engines, one per worker thread, that render queued configurations concurrently
+ *
+ * Each worker owns its engine, so renders of different requests never share
+ * a handle. The queue is bounded: render_async() waits for room and
+ * try_render_async() gives up instead. Renders still queued when the pool is
+ * destroyed are cancelled; running ones are finished first.
+ */
+class EnginePool {
+public:
+    /**
+     * @param options Engine creation options, applied to every engine
+     * @param size Number of engines and workers (0: one per hardware thread)
+     * @param queue_capacity Most renders waiting for a worker (0: four per worker)
+     */
+    explicit EnginePool(const std::unordered_map<std::string, std::string>& options = {},
+                        size_t size = 0, size_t queue_capacity = 0) {
+        if (size == 0) {
+            size = std::thread::hardware_concurrency();
+        }
+        if (size == 0) {
+            size = 1;
+        }
+        capacity_ = queue_capacity ? queue_capacity : size * 4;
+
+        engines_.reserve(size);
+        for (size_t i = 0; i < size; ++i) {
+            engines_.emplace_back(options);
+        }
+        workers_.reserve(size);
+        try {
+            for (size_t i = 0; i < size; ++i) {
+                workers_.emplace_back([this, i] { work(engines_[i]); });
+            }
+        } catch (...) {
+            shutdown();
+            throw;
+        }
+    }
+
+    // Workers refer to the pool, so it cannot be copied or moved
+    EnginePool(const EnginePool&) = delete;
+    EnginePool& operator=(const EnginePool&) = delete;
+
+    ~EnginePool() { shutdown(); }
+
+    /** @brief Number of engines, and of renders that run at once */
+    size_t size() const noexcept { return engines_.size(); }
+
+    /** @brief Most renders that wait for a worker */
+    size_t queue_capacity() const noexcept { return capacity_; }
+
+    /**
+     * @brief Queue a render, waiting while the queue is full
+     * @param config Render configuration, moved into the pool
+     */
+    PendingRender render_async(RenderConfig config) {
+        auto state = std::make_shared<detail::AsyncRender>(std::move(config));
+        PendingRender pending(state);
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            not_full_.wait(lock, [this] { return stopping_ || queue_.size() < capacity_; });
+            if (!stopping_) {
+                queue_.push_back(state);
+                state = nullptr;
+            }
+        }
+        if (state) {
+            state->cancel();  // the pool is being destroyed
+        } else {
+            not_empty_.notify_one();
+        }
+        return pending;
+    }
+
+    /**
+     * @brief Queue a render unless the queue is full
+     * @param config Render configuration, moved into the pool only if it is queued
+     * @return The pending render, or nothing if the queue is full
+     */
+    std::optional<PendingRender> try_render_async(RenderConfig& config) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (queue_.size() >= capacity_) {
+            return std::nullopt;
+        }
+        auto state = std::make_shared<detail::AsyncRender>(std::move(config));
+        PendingRender pending(state);
+        queue_.push_back(std::move(state));
+        lock.unlock();
+        not_empty_.notify_one();
+        return pending;
+    }
+
+private:
+    std::vector<Engine> engines_;
+    std::vector<std::thread> workers_;
+    std::deque<std::shared_ptr<detail::AsyncRender>> queue_;
+    size_t capacity_{0};
+    std::mutex mutex_;
+    std::condition_variable not_empty_;
+    std::condition_variable not_full_;
+    bool stopping_{false};
+
+    void work(const Engine& engine) {
+        for (;;) {
+            std::shared_ptr<detail::AsyncRender> job;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                not_empty_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+                if (stopping_) {
+                    return;
+                }
+                job = std::move(queue_.front());
+                queue_.pop_front();
+            }
+            not_full_.notify_one();
+            if (!job->start()) {
+                continue;
+            }
+
+            // The engine renders straight into the result that the future hands over
+            try {
+                RenderResult result;
+                engine.render(job->config, result);
+                job->promise.set_value(std::move(result));
+            } catch (...) {
+                job->promise.set_exception(std::current_exception());
+            }
+            job->finish();
+        }
+    }
+
+    void shutdown() {
+        std::deque<std::shared_ptr<detail::AsyncRender>> abandoned;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+            abandoned.swap(queue_);
+        }
+        not_empty_.notify_all();
+        not_full_.notify_all();
+        for (auto& job : abandoned) {
+            job->cancel();
+        }
+        for (auto& worker : workers_) {
+            if (worker.joinable()) {
+                worker.join();
+            }
+        }
+    }
+};
+
 /**
  * @brief RAII wrapper for UCRA Manifest
  */
@@ -548,14 +1080,17 @@ private:
 class Stream {
 public:
     using PullCallback = std::function<RenderConfig()>;
+    using ChangedCallback = std::function<bool()>;
 
     /**
      * @brief Create a new streaming session
      * @param config Base render configuration
      * @param callback Function to call when more data is needed
+     * @param changed Optional; when it returns false the stream keeps the previous
+     *        configuration and callback is not called
      */
-    Stream(RenderConfig& config, PullCallback callback)
-        : callback_(std::move(callback)) {
+    Stream(RenderConfig& config, PullCallback callback, ChangedCallback changed = nullptr)
+        : channels_(config.channels()), callback_(std::move(callback)), changed_(std::move(changed)) {
 
         UCRA_Result result = ucra_stream_open(
             &handle_,
@@ -567,12 +1102,35 @@ public:
         check_result(result);
     }
 
+    /**
+     * @brief Create a streaming session that plays the engine's render of the callback's notes
+     * @param engine Engine rendering the stream; must outlive the stream
+     * @param config Base render configuration
+     * @param callback Function to call when more data is needed
+     * @param changed Optional; when it returns false the stream keeps the previous
+     *        configuration and callback is not called
+     */
+    Stream(Engine& engine, RenderConfig& config, PullCallback callback, ChangedCallback changed = nullptr)
+        : channels_(config.channels()), callback_(std::move(callback)), changed_(std::move(changed)) {
+
+        UCRA_Result result = ucra_stream_open_engine(
+            &handle_,
+            engine.handle(),
+            &config.c_struct(),
+            &Stream::static_pull_callback,
+            this
+        );
+
+        check_result(result);
+    }
+
     // Move-only semantics
     Stream(const Stream&) = delete;
     Stream& operator=(const Stream&) = delete;
 
     Stream(Stream&& other) noexcept
-        : handle_(other.handle_), callback_(std::move(other.callback_)) {
+        : handle_(other.handle_), channels_(other.channels_), callback_(std::move(other.callback_)),
+          changed_(std::move(other.changed_)) {
         other.handle_ = nullptr;
     }
 
@@ -582,7 +1140,9 @@ public:
                 ucra_stream_close(handle_);
             }
             handle_ = other.handle_;
+            channels_ = other.channels_;
             callback_ = std::move(other.callback_);
+            changed_ = std::move(other.changed_);
             other.handle_ = nullptr;
         }
         return *this;
@@ -594,39 +1154,93 @@ public:
         }
     }
 
+    /**
+     * @brief Frames borrowed from the stream's buffer by acquire()
+     *
+     * Interleaved float32 in one or two contiguous pieces; valid until release().
+     */
+    struct Regions {
+        const float* first{nullptr};
+        uint32_t first_frames{0};
+        const float* second{nullptr};
+        uint32_t second_frames{0};
+        uint32_t frames() const noexcept { return first_frames + second_frames; }
+    };
+
     /**
      * @brief Read PCM data from the stream
      * @param frame_count Number of frames to read
      * @return PCM data and actual frames read
      */
     std::pair<std::vector<float>, uint32_t> read(uint32_t frame_count) {
-        // Estimate buffer size (assuming stereo for safety)
-        std::vector<float> buffer(frame_count * 2);
+        std::vector<float> buffer(static_cast<size_t>(frame_count) * channels_);
+        uint32_t frames_read = read(buffer.data(), frame_count);
+        buffer.resize(static_cast<size_t>(frames_read) * channels_);
+        return {std::move(buffer), frames_read};
+    }
+
+    /**
+     * @brief Read PCM data into a caller-owned buffer
+     * @param out Destination for frame_count * channels() interleaved samples
+     * @param frame_count Number of frames to read
+     * @return Frames actually read
+     */
+    uint32_t read(float* out, uint32_t frame_count) {
         uint32_t frames_read = 0;
+        check_result(ucra_stream_read(handle_, out, frame_count, &frames_read));
+        return frames_read;
+    }
 
-        UCRA_Result result = ucra_stream_read(
-            handle_,
-            buffer.data(),
-            frame_count,
-            &frames_read
-        );
+    /**
+     * @brief Read as many whole frames as fit into a caller-owned buffer
+     * @param out Destination for interleaved samples, channels() per frame
+     * @return Frames actually read
+     */
+    uint32_t read_into(Span<float> out) {
+        const size_t frames = out.size() / channels_;
+        return read(out.data(), frames > UINT32_MAX ? UINT32_MAX : static_cast<uint32_t>(frames));
+    }
 
-        check_result(result);
+    /**
+     * @brief Borrow up to max_frames buffered frames without copying them
+     * @param max_frames Most frames to expose
+     * @return The frames, to be handed back with release()
+     */
+    Regions acquire(uint32_t max_frames) {
+        Regions regions;
+        check_result(ucra_stream_acquire(handle_, max_frames, &regions.first, &regions.first_frames,
+                                         &regions.second, &regions.second_frames));
+        return regions;
+    }
 
-        // Resize buffer to actual data size
-        buffer.resize(frames_read * 2); // Adjust based on actual channel count if needed
-        return {std::move(buffer), frames_read};
+    /**
+     * @brief Consume the first frame_count frames of the last acquire()
+     * @param frame_count Frames used; the rest are exposed again by the next acquire()
+     */
+    void release(uint32_t frame_count) {
+        check_result(ucra_stream_release(handle_, frame_count));
     }
 
+    /** @brief Interleaved channels per frame */
+    uint32_t channels() const noexcept { return channels_; }
+
 private:
     UCRA_StreamHandle handle_{nullptr};
+    uint32_t channels_{1};
     PullCallback callback_;
+    ChangedCallback changed_;
     RenderConfig current_config_{};
+    bool has_config_{false};
 
     static UCRA_Result UCRA_CALL static_pull_callback(void* user_data, UCRA_RenderConfig* out_config) {
         try {
             auto* stream = static_cast<Stream*>(user_data);
+            // current_config_ backs the previous native config, so it can be reused as is
+            if (stream->has_config_ && stream->changed_ && !stream->changed_()) {
+                return UCRA_STREAM_UNCHANGED;
+            }
             stream->current_config_ = stream->callback_();
+            stream->has_config_ = true;
             *out_config = stream->current_config_.c_struct();
             return UCRA_SUCCESS;
         } catch (...) {
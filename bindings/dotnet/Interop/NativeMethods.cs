@@ -22,9 +22,13 @@ namespace UCRA.Interop
             Internal = 4,
             FileNotFound = 5,
             InvalidJson = 6,
-            InvalidManifest = 7
+            InvalidManifest = 7,
+            Unchanged = 100 // pull callback only: keep the previous configuration
         }
 
+        // RenderConfig.Flags bit, pull callback only: notes were edited in place
+        public const uint RenderNotesEdited = 0x8;
+
         #endregion
 
         #region Structures
@@ -75,6 +79,8 @@ namespace UCRA.Interop
             public uint NoteCount;
             public IntPtr Options;      // const KeyValue*
             public uint OptionCount;
+            public IntPtr TypedOptions; // const TypedValue*, read with UCRA_RENDER_TYPED_OPTIONS only
+            public uint TypedOptionCount;
         }
 
         [StructLayout(LayoutKind.Sequential)]
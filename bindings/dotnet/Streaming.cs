@@ -1,5 +1,4 @@
 using System;
-using System.Collections.Generic;
 using System.Runtime.InteropServices;
 using UCRA.Interop;
 
@@ -13,8 +12,13 @@ namespace UCRA
         private IntPtr _handle;
         private bool _disposed;
         private readonly Func<RenderConfig> _provider;
+        private readonly Func<bool> _hasChanged;
         private readonly object _allocLock = new object();
-        private readonly List<IntPtr> _pendingAllocations = new List<IntPtr>();
+        private readonly uint _channels;
+        private IntPtr _currentNotes; // Backs the last config handed to the stream, which it may keep using
+        private int _noteCapacity;    // Notes _currentNotes has room for; it is reused until it must grow
+        private NativeMethods.RenderConfig _currentConfig; // Last config handed to the stream
+        private bool _hasConfig;
         private NativeMethods.PullPCMCallback _nativeCallback; // Keep delegate alive
 
         /// <summary>
@@ -22,10 +26,14 @@ namespace UCRA
         /// </summary>
         /// <param name="initialConfig">Initial stream configuration (sample rate, channels, block size).</param>
         /// <param name="provider">Callback that supplies a RenderConfig for each pull.</param>
-        public StreamSession(RenderConfig initialConfig, Func<RenderConfig> provider)
+        /// <param name="hasChanged">Optional check run before each pull; when it returns false the stream
+        /// keeps the previous configuration and <paramref name="provider"/> is not called.</param>
+        public StreamSession(RenderConfig initialConfig, Func<RenderConfig> provider, Func<bool> hasChanged = null)
         {
             _provider = provider ?? throw new ArgumentNullException(nameof(provider));
+            _hasChanged = hasChanged;
             if (initialConfig == null) throw new ArgumentNullException(nameof(initialConfig));
+            _channels = initialConfig.Channels > 0 ? initialConfig.Channels : 1;
 
             _nativeCallback = OnPullPcm; // capture delegate
 
@@ -43,17 +51,19 @@ namespace UCRA
             };
 
             var result = NativeMethods.ucra_stream_open(out _handle, ref nativeCfg, _nativeCallback, IntPtr.Zero);
-            try
-            {
-                ErrorHelper.CheckResult(result, "Failed to open UCRA stream");
-            }
-            finally
+            if (result != NativeMethods.UCRAResult.Success)
             {
                 // Free any unmanaged memory allocated during ucra_stream_open callback prefill
-                FreePendingAllocations();
+                FreeCurrentNotes();
             }
+            ErrorHelper.CheckResult(result, "Failed to open UCRA stream");
         }
 
+        /// <summary>
+        /// Channels interleaved in each frame read.
+        /// </summary>
+        public uint Channels => _channels;
+
         /// <summary>
         /// Read PCM frames into the supplied buffer.
         /// </summary>
@@ -63,31 +73,40 @@ namespace UCRA
         public void Read(float[] buffer, uint frames, out uint framesRead)
         {
             if (buffer == null) throw new ArgumentNullException(nameof(buffer));
-            ThrowIfDisposed();
-
-            // Allocate unmanaged temp buffer (channels unknown until pull, but safe upper bound using buffer length)
-            int samples = buffer.Length;
-            int bytes = samples * sizeof(float);
-            IntPtr unmanaged = Marshal.AllocHGlobal(bytes);
-            try
+            if ((ulong)frames * _channels > (ulong)buffer.Length)
             {
-                var result = NativeMethods.ucra_stream_read(_handle, unmanaged, frames, out framesRead);
-                ErrorHelper.CheckResult(result, "Failed to read from UCRA stream");
-
-                // Determine channels best-effort: assume caller sized buffer properly
-                int channels = samples / (int)frames;
-                if (channels <= 0) channels = 1;
-                int samplesToCopy = (int)framesRead * channels;
-                if (samplesToCopy > buffer.Length) samplesToCopy = buffer.Length;
-
-                Marshal.Copy(unmanaged, buffer, 0, samplesToCopy);
+                throw new ArgumentException("Buffer is smaller than frames * channels", nameof(buffer));
             }
-            finally
+            framesRead = Read(buffer.AsSpan(0, (int)(frames * _channels)));
+        }
+
+        /// <summary>
+        /// Read as many whole frames as fit into the buffer. The stream writes
+        /// straight into the pinned buffer; nothing is allocated or copied.
+        /// </summary>
+        /// <param name="buffer">Destination for interleaved samples.</param>
+        /// <returns>Frames read.</returns>
+        public unsafe uint Read(Span<float> buffer)
+        {
+            ThrowIfDisposed();
+            uint frames = (uint)buffer.Length / _channels;
+            uint framesRead;
+            fixed (float* samples = buffer)
             {
-                Marshal.FreeHGlobal(unmanaged);
-                // Free any unmanaged memory allocated during the callback
-                FreePendingAllocations();
+                var result = NativeMethods.ucra_stream_read(_handle, (IntPtr)samples, frames, out framesRead);
+                ErrorHelper.CheckResult(result, "Failed to read from UCRA stream");
             }
+            return framesRead;
+        }
+
+        /// <summary>
+        /// Read as many whole frames as fit into the buffer; see <see cref="Read(Span{float})"/>.
+        /// </summary>
+        /// <param name="buffer">Destination for interleaved samples.</param>
+        /// <returns>Frames read.</returns>
+        public uint Read(Memory<float> buffer)
+        {
+            return Read(buffer.Span);
         }
 
         /// <summary>
@@ -101,12 +120,19 @@ namespace UCRA
                 NativeMethods.ucra_stream_close(_handle);
                 _handle = IntPtr.Zero;
             }
-            FreePendingAllocations();
+            FreeCurrentNotes();
             _disposed = true;
         }
 
         private NativeMethods.UCRAResult OnPullPcm(IntPtr userData, out NativeMethods.RenderConfig outConfig)
         {
+            // Nothing changed: the stream reuses the config (and notes) from the last pull
+            if (_hasConfig && _hasChanged != null && !_hasChanged())
+            {
+                outConfig = default;
+                return NativeMethods.UCRAResult.Unchanged;
+            }
+
             // Build native config from managed RenderConfig provided by caller
             var cfg = _provider();
             if (cfg == null)
@@ -115,26 +141,33 @@ namespace UCRA
                 return NativeMethods.UCRAResult.InvalidArgument;
             }
 
-            outConfig = new NativeMethods.RenderConfig
+            // The native copy of the notes is rewritten in place; a config equal to the
+            // last one is reported unchanged, so the stream keeps what it prepared
+            int count = cfg.Notes.Count;
+            bool same = _hasConfig &&
+                        _currentConfig.SampleRate == cfg.SampleRate &&
+                        _currentConfig.Channels == cfg.Channels &&
+                        _currentConfig.BlockSize == cfg.BlockSize &&
+                        _currentConfig.Flags == cfg.Flags &&
+                        _currentConfig.NoteCount == (uint)count;
+            bool reused = _hasConfig && count <= _noteCapacity;
+            if (count > _noteCapacity)
             {
-                SampleRate = cfg.SampleRate,
-                Channels = cfg.Channels,
-                BlockSize = cfg.BlockSize,
-                Flags = cfg.Flags,
-                Notes = IntPtr.Zero,
-                NoteCount = 0,
-                Options = IntPtr.Zero,
-                OptionCount = 0
-            };
+                // The previous copy is no longer referenced once this returns
+                IntPtr grown = Marshal.AllocHGlobal(Marshal.SizeOf<NativeMethods.NoteSegment>() * count);
+                FreeCurrentNotes();
+                lock (_allocLock)
+                {
+                    _currentNotes = grown;
+                    _noteCapacity = count;
+                }
+                same = false;
+            }
 
-            // Notes (allocate unmanaged copy)
-            if (cfg.Notes.Count > 0)
+            unsafe
             {
-                int sz = Marshal.SizeOf<NativeMethods.NoteSegment>();
-                IntPtr notesPtr = Marshal.AllocHGlobal(sz * cfg.Notes.Count);
-                lock (_allocLock) _pendingAllocations.Add(notesPtr);
-
-                for (int i = 0; i < cfg.Notes.Count; i++)
+                var notes = (NativeMethods.NoteSegment*)_currentNotes;
+                for (int i = 0; i < count; i++)
                 {
                     var n = cfg.Notes[i];
                     var native = new NativeMethods.NoteSegment
@@ -147,30 +180,53 @@ namespace UCRA
                         F0Override = IntPtr.Zero,
                         EnvOverride = IntPtr.Zero
                     };
-                    IntPtr dst = notesPtr + i * sz;
-                    Marshal.StructureToPtr(native, dst, false);
+                    if (same && (notes[i].StartSec != native.StartSec || notes[i].DurationSec != native.DurationSec ||
+                                 notes[i].MidiNote != native.MidiNote || notes[i].Velocity != native.Velocity))
+                    {
+                        same = false;
+                    }
+                    notes[i] = native;
                 }
+            }
 
-                outConfig.Notes = notesPtr;
-                outConfig.NoteCount = (uint)cfg.Notes.Count;
+            if (same)
+            {
+                outConfig = default;
+                return NativeMethods.UCRAResult.Unchanged;
             }
 
             // Options: omit for now (OpenUtau adapter can map via Engine options in future)
+            _currentConfig = new NativeMethods.RenderConfig
+            {
+                SampleRate = cfg.SampleRate,
+                Channels = cfg.Channels,
+                BlockSize = cfg.BlockSize,
+                Flags = cfg.Flags,
+                Notes = count > 0 ? _currentNotes : IntPtr.Zero,
+                NoteCount = (uint)count,
+                Options = IntPtr.Zero,
+                OptionCount = 0
+            };
+            outConfig = _currentConfig;
+            if (reused)
+            {
+                // Same array, possibly the same count: have the stream re-index the notes
+                outConfig.Flags |= NativeMethods.RenderNotesEdited;
+            }
+            _hasConfig = true;
             return NativeMethods.UCRAResult.Success;
         }
 
-        private void FreePendingAllocations()
+        private void FreeCurrentNotes()
         {
             lock (_allocLock)
             {
-                for (int i = 0; i < _pendingAllocations.Count; i++)
+                if (_currentNotes != IntPtr.Zero)
                 {
-                    if (_pendingAllocations[i] != IntPtr.Zero)
-                    {
-                        Marshal.FreeHGlobal(_pendingAllocations[i]);
-                    }
+                    Marshal.FreeHGlobal(_currentNotes);
+                    _currentNotes = IntPtr.Zero;
+                    _noteCapacity = 0;
                 }
-                _pendingAllocations.Clear();
             }
         }
 
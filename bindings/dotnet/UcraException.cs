@@ -63,6 +63,7 @@ namespace UCRA
                 NativeMethods.UCRAResult.FileNotFound => "File not found",
                 NativeMethods.UCRAResult.InvalidJson => "Invalid JSON",
                 NativeMethods.UCRAResult.InvalidManifest => "Invalid manifest",
+                NativeMethods.UCRAResult.Unchanged => "Stream configuration unchanged",
                 _ => $"Unknown error ({(uint)errorCode})"
             };
         }
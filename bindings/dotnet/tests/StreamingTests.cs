@@ -42,5 +42,145 @@ namespace UCRA.NET.Tests
                 Assert.Pass("Streaming not supported in this environment (expected)");
             }
         }
+
+        [Test]
+        public void Stream_UnchangedConfig_IsNotRebuilt()
+        {
+            var initial = new UCRA.RenderConfig
+            {
+                SampleRate = 44100,
+                Channels = 1,
+                BlockSize = 512
+            };
+
+            int pulls = 0;
+            int checks = 0;
+            Func<UCRA.RenderConfig> provider = () =>
+            {
+                pulls++;
+                var cfg = new UCRA.RenderConfig
+                {
+                    SampleRate = 44100,
+                    Channels = 1,
+                    BlockSize = 512
+                };
+                cfg.Notes.Add(new UCRA.NoteSegment(0.0, 1.0, 69, 100, "a"));
+                return cfg;
+            };
+
+            try
+            {
+                using var session = new UCRA.StreamSession(initial, provider, () => { checks++; return false; });
+                float[] buffer = new float[initial.BlockSize * initial.Channels];
+                for (int i = 0; i < 16; i++)
+                {
+                    session.Read(buffer, initial.BlockSize, out uint read);
+                }
+                Assert.AreEqual(1, pulls);
+                Assert.Greater(checks, 0);
+            }
+            catch (UCRA.UcraException ex)
+            {
+                Assert.AreEqual(UCRA.Interop.NativeMethods.UCRAResult.NotSupported, ex.ErrorCode);
+                Assert.Pass("Streaming not supported in this environment (expected)");
+            }
+        }
+
+        [Test]
+        public void Stream_SpanRead_MatchesArrayRead()
+        {
+            var initial = new UCRA.RenderConfig
+            {
+                SampleRate = 44100,
+                Channels = 2,
+                BlockSize = 512
+            };
+
+            // A fresh but equal config on every pull, as a host rebuilding its notes would return
+            Func<UCRA.RenderConfig> provider = () =>
+            {
+                var cfg = new UCRA.RenderConfig
+                {
+                    SampleRate = 44100,
+                    Channels = 2,
+                    BlockSize = 512
+                };
+                cfg.Notes.Add(new UCRA.NoteSegment(0.0, 0.5, 69, 100, "a"));
+                cfg.Notes.Add(new UCRA.NoteSegment(0.5, 0.5, 72, 90, "i"));
+                return cfg;
+            };
+
+            try
+            {
+                using var arrays = new UCRA.StreamSession(initial, provider);
+                using var spans = new UCRA.StreamSession(initial, provider);
+                Assert.AreEqual(2u, spans.Channels);
+
+                float[] expected = new float[700 * 2];
+                float[] actual = new float[700 * 2 + 1]; // the odd sample is not a whole frame
+                for (int i = 0; i < 8; i++)
+                {
+                    arrays.Read(expected, 700, out uint expectedFrames);
+                    uint frames = i % 2 == 0 ? spans.Read(actual.AsSpan()) : spans.Read(actual.AsMemory());
+                    Assert.AreEqual(expectedFrames, frames);
+                    Assert.AreEqual(expected.AsSpan(0, (int)frames * 2).ToArray(), actual.AsSpan(0, (int)frames * 2).ToArray());
+                }
+
+                Assert.Throws<ArgumentException>(() => arrays.Read(new float[10], 700, out _));
+            }
+            catch (UCRA.UcraException ex)
+            {
+                Assert.AreEqual(UCRA.Interop.NativeMethods.UCRAResult.NotSupported, ex.ErrorCode);
+                Assert.Pass("Streaming not supported in this environment (expected)");
+            }
+        }
+
+        [Test]
+        public void Stream_NotesMovedInPlace_PlayAtTheirNewTimes()
+        {
+            var initial = new UCRA.RenderConfig
+            {
+                SampleRate = 44100,
+                Channels = 1,
+                BlockSize = 256
+            };
+
+            // Two notes whose times swap half a second in; the session rewrites its native copy in place
+            Func<double, double, UCRA.RenderConfig> notes = (first, second) =>
+            {
+                var cfg = new UCRA.RenderConfig
+                {
+                    SampleRate = 44100,
+                    Channels = 1,
+                    BlockSize = 256
+                };
+                cfg.Notes.Add(new UCRA.NoteSegment(first, 0.5, 60, 100, "a"));
+                cfg.Notes.Add(new UCRA.NoteSegment(second, 0.5, 67, 100, "i"));
+                return cfg;
+            };
+
+            try
+            {
+                int read = 0;
+                using var edited = new UCRA.StreamSession(initial, () => read >= 22050 ? notes(2.0, 1.0) : notes(1.0, 2.0));
+                using var moved = new UCRA.StreamSession(initial, () => notes(2.0, 1.0));
+                float[] expected = new float[512];
+                float[] actual = new float[512];
+                while (read < 110250)
+                {
+                    uint frames = edited.Read(actual.AsSpan());
+                    moved.Read(expected, frames, out uint expectedFrames);
+                    Assert.AreEqual(frames, expectedFrames);
+                    Assert.AreEqual(expected.AsSpan(0, (int)frames).ToArray(), actual.AsSpan(0, (int)frames).ToArray(),
+                                    $"frames from {read}");
+                    read += (int)frames;
+                }
+            }
+            catch (UCRA.UcraException ex)
+            {
+                Assert.AreEqual(UCRA.Interop.NativeMethods.UCRAResult.NotSupported, ex.ErrorCode);
+                Assert.Pass("Streaming not supported in this environment (expected)");
+            }
+        }
     }
 }
@@ -6,6 +6,8 @@
 #include <memory>
 #include <vector>
 #include <cstring>
+#include <mutex>
+#include <string>
 
 namespace py = pybind11;
 
@@ -94,6 +96,8 @@ public:
         config_.notes = nullptr;
         config_.options = nullptr;
         config_.option_count = 0;
+        config_.typed_options = nullptr;
+        config_.typed_option_count = 0;
     }
 
     // Delete copy constructor and assignment operator
@@ -136,9 +140,14 @@ public:
 };
 
 // Python wrapper for UCRA Engine
+// Native calls run without the GIL, so Python threads render in parallel on
+// separate engines; calls on the same engine take turns on mutex_, since a
+// handle is not safe for concurrent use. A config must not be changed while
+// it is being rendered.
 class PyEngine {
 private:
     UCRA_Handle engine_;
+    std::mutex mutex_;
 
 public:
     PyEngine(const std::map<std::string, std::string>& options = {}) {
@@ -169,22 +178,45 @@ public:
     PyEngine(const PyEngine&) = delete;
     PyEngine& operator=(const PyEngine&) = delete;
 
+    // For streams rendering on this engine
+    UCRA_Handle handle() const { return engine_; }
+    std::mutex& mutex() { return mutex_; }
+
     // Render method returning NumPy array (subclass with metadata attributes)
     py::object render(PyRenderConfig& config) {
-        UCRA_RenderResult result_data;
-        UCRA_Result result = ucra_render(engine_, config.get_raw(), &result_data);
+        uint64_t frames = 0;
+        uint64_t samples = 0;
+        UCRA_Result result;
+        {
+            py::gil_scoped_release release;
+            std::lock_guard<std::mutex> lock(mutex_);
+            result = ucra_render_query_size(engine_, config.get_raw(), &frames, &samples);
+        }
         check_ucra_result(result, "Rendering");
+        uint32_t layout = UCRA_RENDER_LAYOUT(config.get_flags());
+        uint64_t planes = frames > 0 ? samples / frames : (config.get_channels() > 0 ? config.get_channels() : 1);
+
+        // Allocate the NumPy array up front and let the engine render straight into it.
+        // Interleaved output is (frames, channels); planar is (channels, frames); mono
+        // layout is a single (frames, 1) column that the caller broadcasts to channels.
+        std::vector<py::ssize_t> shape;
+        if (layout == UCRA_RENDER_LAYOUT_PLANAR) {
+            shape = { static_cast<py::ssize_t>(planes), static_cast<py::ssize_t>(frames) };
+        } else {
+            shape = { static_cast<py::ssize_t>(frames), static_cast<py::ssize_t>(planes) };
+        }
+        auto numpy_result = py::array_t<float>(shape);
 
-        // Create NumPy array with the audio data
-        size_t total_samples = result_data.frames * result_data.channels;
-        auto numpy_result = py::array_t<float>(
-            { static_cast<py::ssize_t>(result_data.frames), static_cast<py::ssize_t>(result_data.channels) },
-            { sizeof(float) * result_data.channels, sizeof(float) }
-        );
-
-        // Copy data to NumPy array
-        auto buf = numpy_result.request();
-        std::memcpy(buf.ptr, result_data.pcm, total_samples * sizeof(float));
+        UCRA_RenderResult result_data;
+        auto buf = numpy_result.request(true);
+        {
+            // numpy_result keeps the buffer alive while the GIL is released
+            py::gil_scoped_release release;
+            std::lock_guard<std::mutex> lock(mutex_);
+            result = ucra_render_into(engine_, config.get_raw(), static_cast<float*>(buf.ptr),
+                                      samples, &result_data);
+        }
+        check_ucra_result(result, "Rendering");
 
         // Convert to our ndarray subclass so we can attach attributes
         // Fetch the AudioArray class defined in module init (see main.cpp)
@@ -199,9 +231,215 @@ public:
 
         return view;
     }
+
+    // Render into a caller-provided float32 C-contiguous array; returns frames written
+    uint64_t render_into(PyRenderConfig& config,
+                         py::array_t<float, py::array::c_style> out) {
+        auto buf = out.request(true);
+
+        UCRA_RenderResult result_data;
+        UCRA_Result result;
+        {
+            py::gil_scoped_release release;
+            std::lock_guard<std::mutex> lock(mutex_);
+            result = ucra_render_into(engine_, config.get_raw(), static_cast<float*>(buf.ptr),
+                                      static_cast<uint64_t>(buf.size), &result_data);
+        }
+        if (result == UCRA_ERR_INVALID_ARGUMENT && result_data.frames > 0) {
+            throw std::runtime_error("Rendering failed: output array too small, need " +
+                                     std::to_string(result_data.frames * result_data.channels) +
+                                     " samples");
+        }
+        check_ucra_result(result, "Rendering");
+        return result_data.frames;
+    }
+};
+
+// Streaming session playing an engine's render, read block by block from Python.
+// Reads run without the GIL. Python is asked for notes only when they change:
+// set_config() queues a new config without a callback, and invalidate() makes
+// the next refill call on_config() once, with the GIL; every other refill keeps
+// the current config and never touches Python. A config must not be changed
+// once it is handed to the stream. The stream renders on the engine only inside
+// reads, which hold the engine's lock, so "stream_render_ahead" is refused: its
+// producer thread would render blocks on the engine without that lock.
+class PyStream {
+public:
+    PyStream(py::object engine, py::object config, uint32_t block_frames, py::object on_config)
+        : engine_obj_(std::move(engine)), live_(std::move(config)), on_config_(std::move(on_config)) {
+        engine_ = &engine_obj_.cast<PyEngine&>();
+        const PyRenderConfig& base = live_.cast<const PyRenderConfig&>();
+        if (block_frames == 0) {
+            throw std::invalid_argument("Block size must be positive");
+        }
+        for (uint32_t i = 0; i < base.get_raw()->option_count; i++) {
+            const UCRA_KeyValue& option = base.get_raw()->options[i];
+            if (option.key && option.value && std::strcmp(option.key, "stream_render_ahead") == 0 &&
+                (std::strcmp(option.value, "1") == 0 || std::strcmp(option.value, "true") == 0)) {
+                throw std::invalid_argument("Streams on a Python engine cannot render ahead");
+            }
+        }
+        channels_ = base.get_channels() > 0 ? base.get_channels() : 1;
+        has_on_config_ = !on_config_.is_none();
+        buffer_ = py::array_t<float>({ static_cast<py::ssize_t>(block_frames), static_cast<py::ssize_t>(channels_) });
+
+        UCRA_Result result;
+        {
+            // The stream prefills on the engine, and may call back, before it returns
+            py::gil_scoped_release release;
+            std::lock_guard<std::mutex> lock(engine_->mutex());
+            result = ucra_stream_open_engine(&stream_, engine_->handle(), base.get_raw(), &PyStream::pull, this);
+        }
+        throw_callback_error();
+        check_ucra_result(result, "Stream creation");
+    }
+
+    ~PyStream() { close(); }
+
+    PyStream(const PyStream&) = delete;
+    PyStream& operator=(const PyStream&) = delete;
+
+    // Queue config for the next refill; Python is not called back for it
+    void set_config(py::object config) {
+        queue_config(std::move(config));
+    }
+
+    // Have the next refill ask on_config() for the notes
+    void invalidate() {
+        std::lock_guard<std::mutex> lock(config_mutex_);
+        invalidated_ = true;
+    }
+
+    // Read whole frames into a caller-provided C-contiguous float32 array; returns frames read
+    uint32_t read_into(py::array_t<float, py::array::c_style> out) {
+        auto buf = out.request(true);
+        uint64_t frames = static_cast<uint64_t>(buf.size) / channels_;
+        return read(static_cast<float*>(buf.ptr), frames > UINT32_MAX ? UINT32_MAX : static_cast<uint32_t>(frames));
+    }
+
+    // Next block in the stream's own buffer, which the following block overwrites;
+    // a short read returns the filled rows only
+    py::object next_block() {
+        if (!stream_) {
+            throw py::stop_iteration();
+        }
+        uint32_t block_frames = static_cast<uint32_t>(buffer_.shape(0));
+        uint32_t frames = read(buffer_.mutable_data(), block_frames);
+        if (frames == block_frames) {
+            return buffer_;
+        }
+        return buffer_[py::slice(0, frames, 1)];
+    }
+
+    void close() {
+        if (!stream_) {
+            return;
+        }
+        // Nothing renders between reads, so closing takes neither the engine lock nor the GIL
+        py::gil_scoped_release release;
+        ucra_stream_close(stream_);
+        stream_ = nullptr;
+    }
+
+    uint32_t get_channels() const { return channels_; }
+    uint32_t get_block_frames() const { return static_cast<uint32_t>(buffer_.shape(0)); }
+    py::array_t<float> get_buffer() const { return buffer_; }
+
+private:
+    py::object engine_obj_;
+    PyEngine* engine_{nullptr};
+    UCRA_StreamHandle stream_{nullptr};
+    uint32_t channels_{1};
+    py::array_t<float> buffer_;
+
+    // Configs are Python objects, so their references only change with the GIL
+    // held; the callback, without it, only moves next_raw_ along
+    std::mutex config_mutex_;
+    py::object live_;                              // config the stream renders
+    py::object next_;                              // queued config, live once taken
+    const UCRA_RenderConfig* next_raw_{nullptr};   // next_ until the callback takes it
+    bool next_taken_{false};
+    bool invalidated_{false};
+    bool has_on_config_{false};
+    py::object on_config_;
+    std::string callback_error_;
+
+    uint32_t read(float* out, uint32_t frame_count) {
+        if (!stream_) {
+            throw std::runtime_error("Stream is closed");
+        }
+        uint32_t frames_read = 0;
+        UCRA_Result result;
+        {
+            py::gil_scoped_release release;
+            std::lock_guard<std::mutex> lock(engine_->mutex());
+            result = ucra_stream_read(stream_, out, frame_count, &frames_read);
+        }
+        throw_callback_error();
+        check_ucra_result(result, "Stream read");
+        return frames_read;
+    }
+
+    // With the GIL held
+    void queue_config(py::object config) {
+        const UCRA_RenderConfig* raw = config.cast<const PyRenderConfig&>().get_raw();
+        std::lock_guard<std::mutex> lock(config_mutex_);
+        if (next_taken_) {
+            live_ = std::move(next_);
+            next_taken_ = false;
+        }
+        next_ = std::move(config);
+        next_raw_ = raw;
+    }
+
+    void throw_callback_error() {
+        std::string error;
+        {
+            std::lock_guard<std::mutex> lock(config_mutex_);
+            error.swap(callback_error_);
+        }
+        if (!error.empty()) {
+            throw std::runtime_error("Stream config callback failed: " + error);
+        }
+    }
+
+    static UCRA_Result UCRA_CALL pull(void* user_data, UCRA_RenderConfig* out_config) {
+        auto* self = static_cast<PyStream*>(user_data);
+        std::unique_lock<std::mutex> lock(self->config_mutex_);
+        if (!self->next_raw_ && self->invalidated_ && self->has_on_config_) {
+            self->invalidated_ = false;
+            lock.unlock();
+            std::string error;
+            {
+                py::gil_scoped_acquire gil;
+                try {
+                    self->queue_config(self->on_config_());
+                } catch (const std::exception& e) {
+                    error = e.what();
+                }
+            }
+            lock.lock();
+            if (!error.empty()) {
+                self->callback_error_ = error;
+                return UCRA_ERR_INTERNAL;
+            }
+        }
+        if (!self->next_raw_) {
+            return UCRA_STREAM_UNCHANGED;
+        }
+        *out_config = *self->next_raw_;
+        self->next_raw_ = nullptr;
+        self->next_taken_ = true;
+        return UCRA_SUCCESS;
+    }
 };
 
 void bind_engine(py::module& m) {
+    // Output layouts for RenderConfig.flags
+    m.attr("RENDER_LAYOUT_INTERLEAVED") = py::int_(UCRA_RENDER_LAYOUT_INTERLEAVED);
+    m.attr("RENDER_LAYOUT_PLANAR") = py::int_(UCRA_RENDER_LAYOUT_PLANAR);
+    m.attr("RENDER_LAYOUT_MONO") = py::int_(UCRA_RENDER_LAYOUT_MONO);
+
     py::class_<PyNoteSegment>(m, "NoteSegment")
         .def(py::init<double, double, int, int, const std::string&>(),
              py::arg("start_sec"), py::arg("duration_sec"),
@@ -229,5 +467,30 @@ void bind_engine(py::module& m) {
         .def(py::init<const std::map<std::string, std::string>&>(),
              py::arg("options") = std::map<std::string, std::string>{},
              "Create a UCRA engine")
-        .def("render", &PyEngine::render, py::arg("config"), "Render audio with given configuration");
+        .def("render", &PyEngine::render, py::arg("config"),
+             "Render audio with given configuration into a new array; the GIL is released while rendering")
+        // noconvert: a converted temporary would receive the audio instead of out
+        .def("render_into", &PyEngine::render_into, py::arg("config"), py::arg("out").noconvert(),
+             "Render into a preallocated C-contiguous float32 array, releasing the GIL; "
+             "returns the number of frames written");
+
+    py::class_<PyStream>(m, "Stream")
+        .def(py::init<py::object, py::object, uint32_t, py::object>(),
+             py::arg("engine"), py::arg("config"), py::arg("block_frames") = 512,
+             py::arg("on_config") = py::none(),
+             "Stream the engine's render of config; on_config() is called for new notes only after invalidate()")
+        .def("set_config", &PyStream::set_config, py::arg("config"),
+             "Use config from the next refill on, without calling on_config")
+        .def("invalidate", &PyStream::invalidate, "Ask on_config for the notes at the next refill")
+        .def("read_into", &PyStream::read_into, py::arg("out").noconvert(),
+             "Read whole frames into a C-contiguous float32 array, releasing the GIL; returns frames read")
+        .def("__iter__", [](py::object self) { return self; })
+        .def("__next__", &PyStream::next_block,
+             "Next block, in the stream's reused buffer; copy it to keep it past the next block")
+        .def("close", &PyStream::close, "Close the stream")
+        .def("__enter__", [](py::object self) { return self; })
+        .def("__exit__", [](PyStream& self, py::args) { self.close(); })
+        .def_property_readonly("channels", &PyStream::get_channels, "Interleaved channels per frame")
+        .def_property_readonly("block_frames", &PyStream::get_block_frames, "Frames per iterated block")
+        .def_property_readonly("buffer", &PyStream::get_buffer, "The (block_frames, channels) buffer blocks are read into");
 }
@@ -233,6 +233,138 @@ class TestEngine:
             # Expected in test environment
             pytest.skip(f"Engine not available for rendering test: {e}")
 
+    def test_render_threads(self):
+        """Renders from several threads, sharing an engine or not, match a serial render."""
+        from concurrent.futures import ThreadPoolExecutor
+
+        try:
+            shared = ucra.Engine()
+        except ucra.UcraError as e:
+            pytest.skip(f"Engine not available for rendering test: {e}")
+
+        def make_config():
+            config = ucra.RenderConfig(44100, 2)
+            config.add_note(ucra.NoteSegment(0.0, 0.5, 69, 80, "a"))
+            return config
+
+        expected = np.asarray(shared.render(make_config()))
+
+        def render_shared(_):
+            return np.asarray(shared.render(make_config()))
+
+        def render_own(_):
+            engine = ucra.Engine()
+            out = np.empty_like(expected)
+            frames = engine.render_into(make_config(), out)
+            assert frames == expected.shape[0]
+            return out
+
+        with ThreadPoolExecutor(max_workers=4) as pool:
+            for result in list(pool.map(render_shared, range(8))) + list(pool.map(render_own, range(8))):
+                np.testing.assert_array_equal(result, expected)
+
+    def test_render_into_requires_float32(self):
+        """render_into writes into the caller's array, so it is never converted."""
+        try:
+            engine = ucra.Engine()
+        except ucra.UcraError as e:
+            pytest.skip(f"Engine not available for rendering test: {e}")
+
+        config = ucra.RenderConfig()
+        config.add_note(ucra.NoteSegment(0.0, 0.1, 69, 80, "a"))
+        with pytest.raises(TypeError):
+            engine.render_into(config, np.zeros((4410, 1), dtype=np.float64))
+
+
+
+class TestStream:
+    """Test Stream functionality."""
+
+    @staticmethod
+    def make_config():
+        config = ucra.RenderConfig(44100, 2)
+        config.add_note(ucra.NoteSegment(0.0, 0.3, 69, 80, "a"))
+        config.add_note(ucra.NoteSegment(0.3, 0.2, 72, 90, "i"))
+        return config
+
+    def open_engine(self):
+        try:
+            return ucra.Engine()
+        except ucra.UcraError as e:
+            pytest.skip(f"Engine not available for streaming test: {e}")
+
+    def test_blocks_play_render(self):
+        """The blocks of a stream, concatenated, are the offline render, yielded in one reused buffer."""
+        engine = self.open_engine()
+        expected = np.asarray(engine.render(self.make_config()))
+
+        with ucra.Stream(engine, self.make_config(), block_frames=700) as stream:
+            assert stream.channels == 2 and stream.block_frames == 700
+            assert stream.buffer.shape == (700, 2) and stream.buffer.dtype == np.float32
+            blocks = []
+            for block in stream:
+                assert np.shares_memory(block, stream.buffer)
+                blocks.append(block.copy())
+                if sum(len(b) for b in blocks) >= expected.shape[0]:
+                    break
+        played = np.concatenate(blocks)[:expected.shape[0]]
+        np.testing.assert_array_equal(played, expected)
+
+    def test_on_config_only_after_invalidate(self):
+        """Python is only called for notes once the stream is invalidated."""
+        engine = self.open_engine()
+        calls = []
+
+        def on_config():
+            calls.append(1)
+            return self.make_config()
+
+        stream = ucra.Stream(engine, self.make_config(), block_frames=256, on_config=on_config)
+        for _ in range(20):
+            next(stream)
+        assert calls == []
+
+        stream.invalidate()
+        for _ in range(20):
+            next(stream)
+        assert len(calls) == 1
+
+        stream.set_config(self.make_config())
+        next(stream)
+        assert len(calls) == 1
+        stream.close()
+        with pytest.raises(StopIteration):
+            next(stream)
+
+    def test_on_config_error(self):
+        """An exception from on_config is raised by the read that needed it."""
+        engine = self.open_engine()
+
+        def on_config():
+            raise ValueError("no notes")
+
+        stream = ucra.Stream(engine, self.make_config(), block_frames=256, on_config=on_config)
+        stream.invalidate()
+        with pytest.raises(ucra.UcraError, match="no notes"):
+            for _ in range(100):
+                next(stream)
+        stream.close()
+
+    def test_read_into(self):
+        """read_into fills the caller's float32 array and never converts it."""
+        engine = self.open_engine()
+        expected = np.asarray(engine.render(self.make_config()))
+
+        stream = ucra.Stream(engine, self.make_config())
+        out = np.zeros((1000, 2), dtype=np.float32)
+        frames = 0
+        while frames == 0:
+            frames = stream.read_into(out)
+        np.testing.assert_array_equal(out[:frames], expected[:frames])
+        with pytest.raises(TypeError):
+            stream.read_into(np.zeros((1000, 2), dtype=np.float64))
+        stream.close()
+
 
 class TestManifest:
     """Test Manifest functionality."""
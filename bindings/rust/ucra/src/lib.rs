@@ -1,4 +1,13 @@
-use std::{marker::PhantomData, mem::MaybeUninit, ptr};
+use std::{
+    marker::PhantomData,
+    mem::MaybeUninit,
+    ptr,
+    sync::{
+        atomic::{AtomicUsize, Ordering},
+        Condvar, Mutex,
+    },
+    thread,
+};
 
 use thiserror::Error;
 use ucra_sys as sys;
@@ -67,8 +76,42 @@ impl Engine {
         let out = unsafe { out.assume_init() };
         Ok(RenderResult { raw: out, _marker: PhantomData })
     }
+
+    /// Renders straight into `buffer`, reusing its allocation; the engine
+    /// writes the samples into the `Vec`, so nothing is copied afterwards.
+    pub fn render_to(&mut self, config: &RenderConfig<'_>, buffer: &mut RenderBuffer) -> Result<()> {
+        let mut samples = 0u64;
+        unsafe { check(sys::ucra_render_query_size(self.raw, &config.raw, ptr::null_mut(), &mut samples))? };
+        let samples = usize::try_from(samples).map_err(|_| Error::OutOfMemory)?;
+        buffer.pcm.clear();
+        buffer.pcm.try_reserve(samples).map_err(|_| Error::OutOfMemory)?;
+
+        let mut out = MaybeUninit::<sys::UCRA_RenderResult>::zeroed();
+        unsafe {
+            check(sys::ucra_render_into(self.raw, &config.raw, buffer.pcm.as_mut_ptr(),
+                                        samples as u64, out.as_mut_ptr()))?;
+            // The engine wrote every one of the samples it asked room for
+            buffer.pcm.set_len(samples);
+        }
+        let out = unsafe { out.assume_init() };
+        buffer.frames = out.frames;
+        buffer.channels = out.channels;
+        buffer.sample_rate = out.sample_rate;
+        Ok(())
+    }
+
+    /// Renders into a new buffer owned by the caller.
+    pub fn render_owned(&mut self, config: &RenderConfig<'_>) -> Result<RenderBuffer> {
+        let mut buffer = RenderBuffer::default();
+        self.render_to(config, &mut buffer)?;
+        Ok(buffer)
+    }
 }
 
+// A handle has no thread affinity and engines share no state, so one may move
+// to another thread; it still renders one call at a time, hence `&mut self`.
+unsafe impl Send for Engine {}
+
 impl Drop for Engine {
     fn drop(&mut self) {
         unsafe { sys::ucra_engine_destroy(self.raw) }
@@ -103,9 +146,14 @@ impl<'a> From<&NoteSegment<'a>> for sys::UCRA_NoteSegment {
 }
 
 pub struct F0Curve<'a> { raw: sys::UCRA_F0Curve, _p: PhantomData<&'a ()> }
+// Curves only point at the slices they borrow, which are never written through
+unsafe impl Send for F0Curve<'_> {}
+unsafe impl Sync for F0Curve<'_> {}
 impl<'a> F0Curve<'a> { pub fn new(time_sec: &'a [f32], f0_hz: &'a [f32]) -> Self { assert_eq!(time_sec.len(), f0_hz.len()); Self { raw: sys::UCRA_F0Curve { time_sec: time_sec.as_ptr(), f0_hz: f0_hz.as_ptr(), length: time_sec.len() as u32 }, _p: PhantomData } } }
 
 pub struct EnvCurve<'a> { raw: sys::UCRA_EnvCurve, _p: PhantomData<&'a ()> }
+unsafe impl Send for EnvCurve<'_> {}
+unsafe impl Sync for EnvCurve<'_> {}
 impl<'a> EnvCurve<'a> { pub fn new(time_sec: &'a [f32], value: &'a [f32]) -> Self { assert_eq!(time_sec.len(), value.len()); Self { raw: sys::UCRA_EnvCurve { time_sec: time_sec.as_ptr(), value: value.as_ptr(), length: time_sec.len() as u32 }, _p: PhantomData } } }
 
 pub struct RenderConfig<'a> {
@@ -128,11 +176,18 @@ impl<'a> RenderConfig<'a> {
             note_count: c_notes.len() as u32,
             options: ptr::null(),
             option_count: 0,
+            typed_options: ptr::null(),
+            typed_option_count: 0,
         };
         Self { raw, c_notes, _p: PhantomData }
     }
 }
 
+// raw points into c_notes, whose heap storage does not move with the config,
+// and at curves borrowed for 'a; engines only read through it
+unsafe impl Send for RenderConfig<'_> {}
+unsafe impl Sync for RenderConfig<'_> {}
+
 pub struct RenderResult<'a> {
     raw: sys::UCRA_RenderResult,
     _marker: PhantomData<&'a ()>,
@@ -149,6 +204,117 @@ impl<'a> RenderResult<'a> {
     pub fn sample_rate(&self) -> u32 { self.raw.sample_rate }
 }
 
+/// PCM owned by the caller, free to cross threads; reuse one with
+/// `Engine::render_to` or `EnginePool::render_to` to skip the allocation.
+#[derive(Debug, Clone, Default)]
+pub struct RenderBuffer {
+    pcm: Vec<f32>,
+    frames: u64,
+    channels: u32,
+    sample_rate: u32,
+}
+
+impl RenderBuffer {
+    pub fn new() -> Self { Self::default() }
+    pub fn pcm(&self) -> &[f32] { &self.pcm }
+    pub fn frames(&self) -> u64 { self.frames }
+    pub fn channels(&self) -> u32 { self.channels }
+    pub fn sample_rate(&self) -> u32 { self.sample_rate }
+    pub fn into_vec(self) -> Vec<f32> { self.pcm }
+}
+
+/// Engines that any number of threads render on at once, each render
+/// checking out an idle engine for its duration.
+///
+/// The pool is `Send + Sync`, so it can be shared by reference with scoped
+/// threads or rayon's parallel iterators:
+/// `configs.par_iter().map(|c| pool.render(c))`.
+pub struct EnginePool {
+    idle: Mutex<Vec<Engine>>,
+    available: Condvar,
+    size: usize,
+}
+
+impl EnginePool {
+    /// Creates `size` engines; 0 means one per available CPU.
+    pub fn new(size: usize) -> Result<Self> {
+        let size = if size == 0 {
+            thread::available_parallelism().map(|n| n.get()).unwrap_or(1)
+        } else {
+            size
+        };
+        let engines = (0..size).map(|_| Engine::new()).collect::<Result<Vec<_>>>()?;
+        Ok(Self { idle: Mutex::new(engines), available: Condvar::new(), size })
+    }
+
+    /// Number of engines, and of renders that run at once.
+    pub fn size(&self) -> usize { self.size }
+
+    /// Renders on an idle engine, waiting for one if all are busy.
+    pub fn render(&self, config: &RenderConfig<'_>) -> Result<RenderBuffer> {
+        let mut buffer = RenderBuffer::default();
+        self.render_to(config, &mut buffer)?;
+        Ok(buffer)
+    }
+
+    /// Like `render`, into a buffer whose allocation is reused.
+    pub fn render_to(&self, config: &RenderConfig<'_>, buffer: &mut RenderBuffer) -> Result<()> {
+        let mut engine = self.checkout();
+        let result = engine.render_to(config, buffer);
+        self.checkin(engine);
+        result
+    }
+
+    /// Renders every config on up to `size()` threads; results are in the
+    /// order of `configs`, and one failed render does not stop the others.
+    pub fn render_batch(&self, configs: &[RenderConfig<'_>]) -> Vec<Result<RenderBuffer>> {
+        let workers = self.size.min(configs.len());
+        if workers <= 1 {
+            return configs.iter().map(|c| self.render(c)).collect();
+        }
+
+        // Each worker keeps one engine for the whole batch and claims configs in turn
+        let next = AtomicUsize::new(0);
+        let mut results: Vec<(usize, Result<RenderBuffer>)> = thread::scope(|scope| {
+            let handles: Vec<_> = (0..workers)
+                .map(|_| {
+                    scope.spawn(|| {
+                        let mut engine = self.checkout();
+                        let mut done = Vec::new();
+                        loop {
+                            let i = next.fetch_add(1, Ordering::Relaxed);
+                            if i >= configs.len() {
+                                break;
+                            }
+                            done.push((i, engine.render_owned(&configs[i])));
+                        }
+                        self.checkin(engine);
+                        done
+                    })
+                })
+                .collect();
+            handles.into_iter().flat_map(|h| h.join().unwrap()).collect()
+        });
+        results.sort_unstable_by_key(|(i, _)| *i);
+        results.into_iter().map(|(_, r)| r).collect()
+    }
+
+    fn checkout(&self) -> Engine {
+        let mut idle = self.idle.lock().unwrap_or_else(|e| e.into_inner());
+        loop {
+            if let Some(engine) = idle.pop() {
+                return engine;
+            }
+            idle = self.available.wait(idle).unwrap_or_else(|e| e.into_inner());
+        }
+    }
+
+    fn checkin(&self, engine: Engine) {
+        self.idle.lock().unwrap_or_else(|e| e.into_inner()).push(engine);
+        self.available.notify_one();
+    }
+}
+
 #[cfg(test)]
 mod tests {
     use super::*;
@@ -171,4 +337,22 @@ mod tests {
         let pcm = out.pcm().unwrap();
         assert!(!pcm.is_empty());
     }
+
+    #[test]
+    fn render_owned_matches_render() {
+        let mut eng = Engine::new().unwrap();
+        let notes = [NoteSegment { start_sec: 0.0, duration_sec: 0.1, midi_note: 69, velocity: 100, ..Default::default() }];
+        let cfg = RenderConfig::new(44100, 2, &notes);
+        let expected = eng.render(&cfg).unwrap().pcm().unwrap().to_vec();
+
+        let mut buffer = eng.render_owned(&cfg).unwrap();
+        assert_eq!(buffer.pcm(), &expected[..]);
+        assert_eq!(buffer.frames() as usize * 2, expected.len());
+
+        // a reused buffer keeps its allocation
+        let capacity_ptr = buffer.pcm().as_ptr();
+        eng.render_to(&cfg, &mut buffer).unwrap();
+        assert_eq!(buffer.pcm().as_ptr(), capacity_ptr);
+        assert_eq!(buffer.pcm(), &expected[..]);
+    }
 }
@@ -14,3 +14,40 @@ fn basic_render_flow() {
     let pcm = out.pcm().unwrap();
     assert_eq!(pcm.len(), out.frames() as usize * out.channels() as usize);
 }
+
+#[test]
+fn pool_renders_from_many_threads() {
+    fn assert_send_sync<T: Send + Sync>() {}
+    assert_send_sync::<EnginePool>();
+    assert_send_sync::<RenderConfig<'static>>();
+    assert_send_sync::<RenderBuffer>();
+
+    let pool = EnginePool::new(3).unwrap();
+    assert_eq!(pool.size(), 3);
+
+    let notes: Vec<[NoteSegment; 1]> = (0..8)
+        .map(|i| [NoteSegment { start_sec: 0.0, duration_sec: 0.05, midi_note: 60 + i, velocity: 100, ..Default::default() }])
+        .collect();
+    let configs: Vec<RenderConfig> = notes.iter().map(|n| RenderConfig::new(44100, 2, n)).collect();
+
+    let mut serial = Engine::new().unwrap();
+    let expected: Vec<Vec<f32>> = configs.iter().map(|c| serial.render(c).unwrap().pcm().unwrap().to_vec()).collect();
+
+    // a batch keeps the order of its configs
+    let batch = pool.render_batch(&configs);
+    assert_eq!(batch.len(), configs.len());
+    for (result, want) in batch.iter().zip(&expected) {
+        assert_eq!(result.as_ref().unwrap().pcm(), &want[..]);
+    }
+
+    // more threads than engines share the pool by reference, and results cross threads
+    let rendered: Vec<RenderBuffer> = std::thread::scope(|scope| {
+        let handles: Vec<_> = configs.iter().map(|c| { let pool = &pool; scope.spawn(move || pool.render(c).unwrap()) }).collect();
+        handles.into_iter().map(|h| h.join().unwrap()).collect()
+    });
+    for (buffer, want) in rendered.iter().zip(&expected) {
+        assert_eq!(buffer.pcm(), &want[..]);
+        assert_eq!(buffer.channels(), 2);
+        assert_eq!(buffer.sample_rate(), 44100);
+    }
+}
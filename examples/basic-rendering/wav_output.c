@@ -9,41 +9,6 @@
 #include <stdint.h>
 #include "ucra/ucra.h"
 
-// 간단한 WAV 파일 헤더 구조체
-typedef struct {
-    char riff[4];           // "RIFF"
-    uint32_t chunk_size;
-    char wave[4];           // "WAVE"
-    char fmt[4];            // "fmt "
-    uint32_t fmt_size;
-    uint16_t audio_format;
-    uint16_t num_channels;
-    uint32_t sample_rate;
-    uint32_t byte_rate;
-    uint16_t block_align;
-    uint16_t bits_per_sample;
-    char data[4];           // "data"
-    uint32_t data_size;
-} WAVHeader;
-
-// WAV 헤더 생성
-void create_wav_header(WAVHeader* header, uint32_t sample_rate, uint32_t num_samples) {
-    memcpy(header->riff, "RIFF", 4);
-    memcpy(header->wave, "WAVE", 4);
-    memcpy(header->fmt, "fmt ", 4);
-    memcpy(header->data, "data", 4);
-
-    header->fmt_size = 16;
-    header->audio_format = 1; // PCM
-    header->num_channels = 1; // 모노
-    header->sample_rate = sample_rate;
-    header->bits_per_sample = 16;
-    header->block_align = header->num_channels * header->bits_per_sample / 8;
-    header->byte_rate = header->sample_rate * header->block_align;
-    header->data_size = num_samples * header->block_align;
-    header->chunk_size = 36 + header->data_size;
-}
-
 int main(void) {
     printf("UCRA WAV Output Example\n");
     printf("=======================\n\n");
@@ -90,32 +55,25 @@ int main(void) {
 
     printf("✓ 렌더링 완료 (%llu 프레임)\n", render_result.frames);
 
-    // WAV 파일로 저장
+    // WAV 파일로 저장: 16비트 PCM으로 변환 (디더 적용)
     const char* filename = "output.wav";
-    FILE* file = fopen(filename, "wb");
-    if (!file) {
+    UCRA_WavWriterHandle writer = NULL;
+    result = ucra_wav_writer_open(&writer, filename, render_result.sample_rate, render_result.channels,
+                                  UCRA_SAMPLE_PCM16, 0);
+    if (result != UCRA_SUCCESS) {
         printf("❌ 파일 생성 실패: %s\n", filename);
         ucra_engine_destroy(engine);
         return 1;
     }
 
-    // WAV 헤더 작성
-    WAVHeader header;
-    create_wav_header(&header, config.sample_rate, render_result.frames);
-    fwrite(&header, sizeof(header), 1, file);
-
-    // 오디오 데이터를 16비트 PCM으로 변환하여 작성
-    for (uint64_t i = 0; i < render_result.frames; i++) {
-        // float를 16비트 정수로 변환 (-1.0 ~ 1.0 -> -32768 ~ 32767)
-        float sample = render_result.pcm[i];
-        if (sample > 1.0f) sample = 1.0f;
-        if (sample < -1.0f) sample = -1.0f;
-
-        int16_t pcm_sample = (int16_t)(sample * 32767.0f);
-        fwrite(&pcm_sample, sizeof(pcm_sample), 1, file);
+    // 블록 단위로 써도 결과는 같음 (스트리밍 출력도 같은 방식)
+    result = ucra_wav_writer_write(writer, render_result.pcm, render_result.frames);
+    UCRA_Result closed = ucra_wav_writer_close(writer);
+    if (result != UCRA_SUCCESS || closed != UCRA_SUCCESS) {
+        printf("❌ 파일 쓰기 실패: %s\n", filename);
+        ucra_engine_destroy(engine);
+        return 1;
     }
-
-    fclose(file);
     printf("✓ WAV 파일 저장됨: %s\n", filename);
 
     // 정리
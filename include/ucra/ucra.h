@@ -59,6 +59,30 @@ typedef struct UCRA_Engine_* UCRA_Handle;
 /** @brief Opaque stream handle for streaming API */
 typedef struct UCRA_StreamState_* UCRA_StreamHandle;
 
+/** @brief Opaque mixer handle for the mixer API */
+typedef struct UCRA_MixerState_* UCRA_MixerHandle;
+
+/** @brief Opaque handle for a set of discovered voicebanks */
+typedef struct UCRA_VoicebankSet_* UCRA_VoicebankSetHandle;
+
+/** @brief Opaque handle for an on-disk render cache */
+typedef struct UCRA_RenderCache_* UCRA_RenderCacheHandle;
+
+/** @brief Opaque handle for an incremental WAV file writer */
+typedef struct UCRA_WavWriter_* UCRA_WavWriterHandle;
+
+/** @brief Opaque handle holding the points of a loaded F0 curve file */
+typedef struct UCRA_F0File_* UCRA_F0FileHandle;
+
+/** @brief Opaque handle for a timeline that joins rendered notes */
+typedef struct UCRA_Timeline_* UCRA_TimelineHandle;
+
+/** @brief Opaque handle for a streaming sample-rate converter */
+typedef struct UCRA_Resampler_* UCRA_ResamplerHandle;
+
+/** @brief Opaque handle for a render session that re-renders only what edits change */
+typedef struct UCRA_RenderSession_* UCRA_RenderSessionHandle;
+
 /**
  * @brief Result / Error codes (0 == success)
  *
@@ -73,7 +97,8 @@ typedef enum UCRA_Result {
     UCRA_ERR_INTERNAL = 4,           /**< Internal engine error */
     UCRA_ERR_FILE_NOT_FOUND = 5,     /**< Requested file not found */
     UCRA_ERR_INVALID_JSON = 6,       /**< JSON parsing error */
-    UCRA_ERR_INVALID_MANIFEST = 7    /**< Manifest validation error */
+    UCRA_ERR_INVALID_MANIFEST = 7,   /**< Manifest validation error */
+    UCRA_STREAM_UNCHANGED = 100      /**< Pull callback only: the previous configuration still applies (not an error) */
 } UCRA_Result;
 
 /**
@@ -87,6 +112,30 @@ typedef struct UCRA_KeyValue {
     const char* value; /**< UTF-8 value (null-terminated) */
 } UCRA_KeyValue;
 
+/**
+ * @brief Type of a UCRA_TypedValue
+ */
+typedef enum UCRA_ValueType {
+    UCRA_VALUE_STRING = 0, /**< text holds the value */
+    UCRA_VALUE_INT = 1,    /**< number holds an integral value */
+    UCRA_VALUE_FLOAT = 2,  /**< number holds the value */
+    UCRA_VALUE_BOOL = 3,   /**< number is 0 or 1 */
+    UCRA_VALUE_ENUM = 4    /**< number is the value's index, text its name */
+} UCRA_ValueType;
+
+/**
+ * @brief Key with an already parsed value
+ *
+ * Carries option and flag values without a string round trip. Integers are
+ * exact up to 2^53.
+ */
+typedef struct UCRA_TypedValue {
+    const char* key;     /**< UTF-8 key (null-terminated) */
+    UCRA_ValueType type; /**< Which fields hold the value */
+    double number;       /**< INT, FLOAT and BOOL values and ENUM indexes */
+    const char* text;    /**< STRING values and ENUM names, NULL otherwise */
+} UCRA_TypedValue;
+
 /**
  * @brief Manifest flag definition
  *
@@ -186,6 +235,34 @@ typedef struct UCRA_NoteSegment {
     const UCRA_EnvCurve* env_override;/**< optional envelope curve override */
 } UCRA_NoteSegment;
 
+/**
+ * @name Render output layouts
+ * Selected with the low bits of UCRA_RenderConfig.flags.
+ * @{
+ */
+#define UCRA_RENDER_LAYOUT_MASK        0x3u /**< Bits of flags holding the output layout */
+#define UCRA_RENDER_LAYOUT_INTERLEAVED 0x0u /**< frames*channels samples, channel-interleaved (default) */
+#define UCRA_RENDER_LAYOUT_PLANAR      0x1u /**< channels planes of frames samples each, one after another */
+#define UCRA_RENDER_LAYOUT_MONO        0x2u /**< one plane of frames samples shared by every channel */
+
+/** Output layout selected by a flags value */
+#define UCRA_RENDER_LAYOUT(flags) ((flags) & UCRA_RENDER_LAYOUT_MASK)
+/** @} */
+
+/**
+ * UCRA_RenderConfig.typed_options and typed_option_count are set. Without
+ * this flag they are not read, so a config from code built against an older
+ * header, which lacks those fields, stays valid.
+ */
+#define UCRA_RENDER_TYPED_OPTIONS 0x4u
+
+/**
+ * Stream pull callbacks only: the notes were edited in place. A stream re-indexes
+ * the notes a callback returns only when the array or note count differs from the
+ * previous call's, or when this flag is set.
+ */
+#define UCRA_RENDER_NOTES_EDITED 0x8u
+
 /**
  * @brief Render configuration
  *
@@ -196,13 +273,18 @@ typedef struct UCRA_RenderConfig {
     uint32_t sample_rate;      /**< Sample rate (e.g., 44100, 48000) */
     uint32_t channels;         /**< Channel count (1=mono, 2=stereo, ...) */
     uint32_t block_size;       /**< Frames per block for streaming (e.g., 256, 512) */
-    uint32_t flags;            /**< Reserved for future use */
+    uint32_t flags;            /**< Render flags; low bits select the output layout (UCRA_RENDER_LAYOUT_*) */
 
     const UCRA_NoteSegment* notes; /**< Pointer to array of notes */
     uint32_t note_count;           /**< Number of notes in the array */
 
     const UCRA_KeyValue* options;  /**< Optional engine options */
     uint32_t option_count;         /**< Number of options */
+
+    /** Options with parsed values, read only with UCRA_RENDER_TYPED_OPTIONS in flags;
+     *  an engine looks a key up here before options */
+    const UCRA_TypedValue* typed_options;
+    uint32_t typed_option_count;   /**< Number of typed options */
 } UCRA_RenderConfig;
 
 /**
@@ -210,9 +292,12 @@ typedef struct UCRA_RenderConfig {
  *
  * Result of audio rendering, containing synthesized PCM data and metadata.
  * The PCM data remains valid until the next render call or engine destruction.
+ * pcm is laid out as requested in UCRA_RenderConfig.flags; with
+ * UCRA_RENDER_LAYOUT_MONO it holds frames samples that every one of the
+ * channels plays.
  */
 typedef struct UCRA_RenderResult {
-    const float* pcm;          /**< Interleaved PCM32F data (frames*channels length) */
+    const float* pcm;          /**< PCM32F data, interleaved unless another layout was requested */
     uint64_t frames;           /**< Number of frames in PCM data */
     uint32_t channels;         /**< Channel count for PCM data */
     uint32_t sample_rate;      /**< Sample rate for PCM data */
@@ -231,11 +316,21 @@ typedef struct UCRA_RenderResult {
  * @brief Callback function for pulling PCM data during streaming
  *
  * The host application provides this callback to supply note segments
- * and render parameters for the next audio block.
+ * and render parameters for the next audio block. out_config starts as the
+ * configuration the stream was opened with.
+ *
+ * When nothing changed since the previous call, the callback may return
+ * UCRA_STREAM_UNCHANGED without filling out_config; the stream then keeps
+ * rendering with the configuration the last successful call provided, so its
+ * notes, curves and options must stay valid until they are replaced. A callback
+ * that moves or resizes notes in place, returning the same array and note
+ * count, sets UCRA_RENDER_NOTES_EDITED in out_config->flags; so does one
+ * whose new array may have been allocated where the previous one was freed.
  *
  * @param user_data User-provided context data
  * @param out_config Output render configuration for the next block
  * @return UCRA_SUCCESS if the configuration was provided successfully,
+ *         UCRA_STREAM_UNCHANGED to keep the previous one,
  *         or an error code if no more data is available or an error occurred.
  */
 typedef UCRA_Result (UCRA_CALL *UCRA_PullPCM)(void* user_data,
@@ -296,6 +391,32 @@ ucra_engine_getinfo(UCRA_Handle engine,
                     char* outBuffer,
                     size_t buffer_size);
 
+/**
+ * @name Engine capabilities
+ * Bits reported by ucra_engine_get_capabilities().
+ * @{
+ */
+/**
+ * A note shapes only the frames around it, and ucra_render_block() gives the
+ * samples ucra_render() does, so re-rendering the span of an edited note,
+ * widened by however far the engine's notes reach (nothing for the built-in
+ * engine), reproduces a full render. Engines whose synthesis carries state
+ * along the timeline, such as WORLD's pulse phase, do not report it.
+ */
+#define UCRA_ENGINE_CAP_NOTE_LOCAL 0x1u
+/** @} */
+
+/**
+ * @brief Query what an engine guarantees about its output
+ *
+ * @param engine Engine handle
+ * @param out_caps Receives UCRA_ENGINE_CAP_* bits; 0 for an engine that claims none
+ * @return UCRA_SUCCESS, or UCRA_ERR_INVALID_ARGUMENT
+ */
+UCRA_API UCRA_Result UCRA_CALL
+ucra_engine_get_capabilities(UCRA_Handle engine,
+                             uint32_t* out_caps);
+
 /**
  * @brief Render audio for the provided configuration
  *
@@ -313,6 +434,217 @@ ucra_render(UCRA_Handle engine,
             const UCRA_RenderConfig* config,
             UCRA_RenderResult* outResult);
 
+/**
+ * @brief Query the output size of a render
+ *
+ * Computes how many frames, and how many float samples in total, rendering
+ * the configuration would produce, without synthesizing anything. Use it to
+ * size the buffer passed to ucra_render_into().
+ *
+ * @param engine Engine handle
+ * @param config Render configuration including notes and options
+ * @param out_frames Receives the frame count (may be NULL)
+ * @param out_samples Receives the number of float samples needed (may be NULL)
+ * @return UCRA_SUCCESS on success
+ */
+UCRA_API UCRA_Result UCRA_CALL
+ucra_render_query_size(UCRA_Handle engine,
+                       const UCRA_RenderConfig* config,
+                       uint64_t* out_frames,
+                       uint64_t* out_samples);
+
+/**
+ * @brief Render audio into a caller-owned buffer
+ *
+ * Same as ucra_render(), but the engine writes PCM directly into out_pcm
+ * instead of its own buffer, so no allocation or copy is needed per render.
+ * On success outResult->pcm points at out_pcm.
+ *
+ * If out_pcm is NULL or capacity_samples is too small, nothing is rendered,
+ * UCRA_ERR_INVALID_ARGUMENT is returned and outResult->frames/channels report
+ * the required size.
+ *
+ * @param engine Engine handle
+ * @param config Render configuration including notes and options
+ * @param out_pcm Destination buffer for PCM32F data in the requested layout
+ * @param capacity_samples Number of floats available in out_pcm
+ * @param outResult Pointer to store the render result
+ * @return UCRA_SUCCESS on successful rendering
+ */
+UCRA_API UCRA_Result UCRA_CALL
+ucra_render_into(UCRA_Handle engine,
+                 const UCRA_RenderConfig* config,
+                 float* out_pcm,
+                 uint64_t capacity_samples,
+                 UCRA_RenderResult* outResult);
+
+/**
+ * @brief Render many independent configurations in one call
+ *
+ * Jobs are spread over the engine's internal work-stealing worker pool, each
+ * worker with its own scratch state, and the call returns once every job is
+ * done. Each results[i] receives the outcome of configs[i], including its own
+ * status, so one bad job does not affect the others.
+ *
+ * PCM of all jobs is owned by the engine and remains valid until the next
+ * ucra_render_batch() call on the same engine or engine destruction; ucra_render()
+ * does not invalidate it.
+ *
+ * @param engine Engine handle
+ * @param configs Array of count render configurations
+ * @param results Array of count results to fill
+ * @param count Number of jobs
+ * @return UCRA_SUCCESS if every job succeeded, otherwise the status of the first failed job
+ */
+UCRA_API UCRA_Result UCRA_CALL
+ucra_render_batch(UCRA_Handle engine,
+                  const UCRA_RenderConfig* configs,
+                  UCRA_RenderResult* results,
+                  uint32_t count);
+
+/**
+ * @brief Render the frames [start_frame, start_frame + frame_count) of a configuration
+ *
+ * Writes exactly the samples ucra_render() would produce for those frames, in
+ * the layout selected by config->flags for a frame_count-long buffer; frames
+ * past the end of the render are silence. The engine keeps the synthesis
+ * state (oscillator phases, curve positions) at the end of each block, so a
+ * sequence of blocks over the same notes, each starting where the previous
+ * one ended, costs no more than one ucra_render(). Any other start frame, or
+ * a change of notes, sample rate or options, restarts from the notes. (The
+ * WORLD engine restarts on a backward seek or a rate change only; like its
+ * streams, it picks up edited notes from the next synthesis chunk.)
+ *
+ * The engine tracks one such sequence at a time, and the notes and curves
+ * must stay valid while it is in use. ucra_render() and friends do not
+ * disturb it.
+ *
+ * @param engine Engine handle
+ * @param config Render configuration including notes and options
+ * @param start_frame First frame to render
+ * @param frame_count Number of frames to render
+ * @param out_pcm Destination buffer for frame_count frames in the requested layout
+ * @return UCRA_SUCCESS on success
+ */
+UCRA_API UCRA_Result UCRA_CALL
+ucra_render_block(UCRA_Handle engine,
+                  const UCRA_RenderConfig* config,
+                  uint64_t start_frame,
+                  uint32_t frame_count,
+                  float* out_pcm);
+
+/** @} */
+
+/**
+ * @brief Engine Loader API
+ * @defgroup EngineLoaderAPI Loading Engines from Shared Libraries
+ * @{
+ *
+ * A manifest whose entry type is "dll" names a shared library (entry.path)
+ * and an entry function in it (entry.symbol, "ucra_entry" by default). The
+ * library is opened the first time an engine is created from it and stays
+ * loaded for the life of the process; the function table its entry returns is
+ * cached by canonical path and symbol. Engines created this way are used
+ * through the ordinary API (ucra_render(), streams, render caches, mixers),
+ * which forwards every call to the library, so engines of several libraries
+ * run side by side in one process.
+ *
+ * A library should keep its engine functions out of the ucra_* namespace:
+ * on ELF platforms its own references to those names may bind to the host's.
+ *
+ * An "ipc" entry names an executable instead. Each engine created from it
+ * launches the executable as a host process, which serves the engine through
+ * ucra_ipc_serve(); requests and PCM travel through shared memory, and a host
+ * that crashes fails the calls of its engine instead of taking the caller's
+ * process down. ucra_engine_host is a host running the built-in engine.
+ * "ipc" entries are supported on POSIX systems.
+ */
+
+/** Version of UCRA_EngineTable this header describes */
+#define UCRA_ENGINE_ABI_VERSION 1u
+
+/** Default entry symbol of a "dll" engine */
+#define UCRA_ENGINE_DEFAULT_SYMBOL "ucra_entry"
+
+/**
+ * @brief Functions of a loaded engine
+ *
+ * The handles these functions take and return are the library's own. Later
+ * ABI versions only append members, so a table reports the size it has.
+ */
+typedef struct UCRA_EngineTable {
+    uint32_t abi_version; /**< UCRA_ENGINE_ABI_VERSION the library was built against */
+    uint32_t struct_size; /**< sizeof(UCRA_EngineTable) in that version */
+
+    /* Required */
+    UCRA_Result (UCRA_CALL *engine_create)(UCRA_Handle* outEngine, const UCRA_KeyValue* options,
+                                           uint32_t option_count);
+    void (UCRA_CALL *engine_destroy)(UCRA_Handle engine);
+    UCRA_Result (UCRA_CALL *render)(UCRA_Handle engine, const UCRA_RenderConfig* config,
+                                    UCRA_RenderResult* outResult);
+
+    /* Optional: NULL makes the corresponding call return UCRA_ERR_NOT_SUPPORTED */
+    UCRA_Result (UCRA_CALL *engine_getinfo)(UCRA_Handle engine, char* outBuffer, size_t buffer_size);
+    UCRA_Result (UCRA_CALL *render_query_size)(UCRA_Handle engine, const UCRA_RenderConfig* config,
+                                               uint64_t* out_frames, uint64_t* out_samples);
+    UCRA_Result (UCRA_CALL *render_into)(UCRA_Handle engine, const UCRA_RenderConfig* config,
+                                         float* out_pcm, uint64_t capacity_samples,
+                                         UCRA_RenderResult* outResult);
+    UCRA_Result (UCRA_CALL *render_batch)(UCRA_Handle engine, const UCRA_RenderConfig* configs,
+                                          UCRA_RenderResult* results, uint32_t count);
+    UCRA_Result (UCRA_CALL *render_block)(UCRA_Handle engine, const UCRA_RenderConfig* config,
+                                          uint64_t start_frame, uint32_t frame_count,
+                                          float* out_pcm); /**< Needed by engine-backed streams */
+    UCRA_Result (UCRA_CALL *engine_get_capabilities)(UCRA_Handle engine,
+                                                     uint32_t* out_caps); /**< Missing: no capabilities */
+} UCRA_EngineTable;
+
+/**
+ * @brief Entry function a "dll" engine exports under its manifest's symbol
+ *
+ * @param host_abi_version UCRA_ENGINE_ABI_VERSION of the host
+ * @return The library's table, which must stay valid while it is loaded, or
+ *         NULL if the library cannot serve that host version
+ */
+typedef const UCRA_EngineTable* (UCRA_CALL *UCRA_EngineEntry)(uint32_t host_abi_version);
+
+/**
+ * @brief Create an engine from the library a manifest names
+ *
+ * @param outEngine Receives the engine; destroy it with ucra_engine_destroy()
+ * @param manifest Manifest whose entry type is "dll" or "ipc"
+ * @param base_dir Directory a relative entry.path is resolved against, such as
+ *        UCRA_VoicebankEntry.directory (NULL: the working directory)
+ * @param options Engine options passed to the library's engine_create (may be NULL)
+ * @param option_count Number of options
+ * @return UCRA_SUCCESS; UCRA_ERR_FILE_NOT_FOUND if the library cannot be
+ *         opened; UCRA_ERR_NOT_SUPPORTED for other entry types, a missing entry
+ *         symbol or an incompatible table; or the error of engine_create
+ */
+UCRA_API UCRA_Result UCRA_CALL
+ucra_engine_create_from_manifest(UCRA_Handle* outEngine,
+                                 const UCRA_Manifest* manifest,
+                                 const char* base_dir,
+                                 const UCRA_KeyValue* options,
+                                 uint32_t option_count);
+
+/**
+ * @brief Serve one engine to the process that launched this one for an "ipc" entry
+ *
+ * Call it from the main() of an engine host executable. It returns once the
+ * client destroys the engine or exits.
+ *
+ * @param argc Argument count as passed to main()
+ * @param argv Arguments as passed to main(); they name the shared memory to serve
+ * @param table Engine to serve (NULL: the built-in engine)
+ * @return UCRA_SUCCESS after a clean shutdown; UCRA_ERR_INVALID_ARGUMENT if
+ *         the arguments name no channel, or table is invalid;
+ *         UCRA_ERR_FILE_NOT_FOUND if the channel does not exist;
+ *         UCRA_ERR_NOT_SUPPORTED on Windows
+ */
+UCRA_API UCRA_Result UCRA_CALL
+ucra_ipc_serve(int argc, char** argv, const UCRA_EngineTable* table);
+
 /** @} */
 
 /**
@@ -339,12 +671,643 @@ ucra_manifest_load(const char* manifest_path,
  * @brief Free a manifest and all associated memory
  *
  * Releases all memory allocated for the manifest structure and its contents.
+ * For a manifest from ucra_manifest_acquire() this is ucra_manifest_release().
  *
  * @param manifest Manifest to free (may be NULL)
  */
 UCRA_API void UCRA_CALL
 ucra_manifest_free(UCRA_Manifest* manifest);
 
+/**
+ * @brief Look up a flag definition by key
+ *
+ * Uses a hash index built when the manifest was loaded, so the cost does not
+ * grow with the number of flags. Only for manifests from ucra_manifest_load()
+ * or ucra_manifest_acquire().
+ *
+ * @param manifest Loaded manifest
+ * @param key Flag key
+ * @return The flag (pointing into manifest->flags), or NULL if there is none
+ */
+UCRA_API const UCRA_ManifestFlag* UCRA_CALL
+ucra_manifest_find_flag(const UCRA_Manifest* manifest,
+                        const char* key);
+
+/**
+ * @brief Get a shared manifest from the process-wide registry
+ *
+ * Returns the registry's parsed copy of the file, loading it on first use or
+ * when the file changed since (by modification time, size or identity). The
+ * same path reached by different names shares one entry. Manifests are
+ * immutable and reference-counted: each successful call must be paired with
+ * ucra_manifest_release(), and a manifest stays valid until then even if the
+ * file is replaced meanwhile. Safe to call from any thread.
+ *
+ * @param manifest_path Path to the manifest JSON file
+ * @param outManifest Receives the shared manifest
+ * @return UCRA_SUCCESS on success, or the ucra_manifest_load() error
+ */
+UCRA_API UCRA_Result UCRA_CALL
+ucra_manifest_acquire(const char* manifest_path,
+                      const UCRA_Manifest** outManifest);
+
+/**
+ * @brief Release a manifest returned by ucra_manifest_acquire()
+ *
+ * @param manifest Manifest to release (may be NULL)
+ */
+UCRA_API void UCRA_CALL
+ucra_manifest_release(const UCRA_Manifest* manifest);
+
+/**
+ * @brief Drop every manifest the registry holds
+ *
+ * Manifests still acquired stay valid until released; later acquires parse
+ * their files again.
+ */
+UCRA_API void UCRA_CALL
+ucra_manifest_registry_clear(void);
+
+/** Manifest file name that marks a voicebank directory */
+#define UCRA_VOICEBANK_MANIFEST "resampler.json"
+
+/**
+ * @brief One voicebank found by ucra_voicebank_discover()
+ */
+typedef struct UCRA_VoicebankEntry {
+    const char* directory;         /**< Voicebank directory, or the root that could not be read */
+    const char* manifest_path;     /**< directory + "/" UCRA_VOICEBANK_MANIFEST */
+    const UCRA_Manifest* manifest; /**< Shared manifest, NULL unless status is UCRA_SUCCESS */
+    UCRA_Result status;            /**< Result of loading this voicebank's manifest */
+} UCRA_VoicebankEntry;
+
+/**
+ * @brief Find and load the voicebanks under several roots in parallel
+ *
+ * A root holding a UCRA_VOICEBANK_MANIFEST is a voicebank itself; otherwise
+ * each of its subdirectories that holds one is. Roots are listed and
+ * manifests loaded on up to io_threads threads. Manifests come from the
+ * shared registry (see ucra_manifest_acquire()). A manifest that fails to
+ * load, or a root that cannot be read, is reported as an entry with its
+ * error rather than failing the call.
+ *
+ * Entries follow the order of roots, and within a root are sorted by
+ * directory name.
+ *
+ * @param out_set Receives the set; free it with ucra_voicebank_destroy()
+ * @param roots Root directories
+ * @param root_count Number of roots
+ * @param io_threads Maximum concurrent file system operations, 0 for the default (8)
+ * @return UCRA_SUCCESS, UCRA_ERR_INVALID_ARGUMENT or UCRA_ERR_OUT_OF_MEMORY
+ */
+UCRA_API UCRA_Result UCRA_CALL
+ucra_voicebank_discover(UCRA_VoicebankSetHandle* out_set,
+                        const char* const* roots,
+                        uint32_t root_count,
+                        uint32_t io_threads);
+
+/** @brief Number of entries in a voicebank set (0 for NULL) */
+UCRA_API uint32_t UCRA_CALL
+ucra_voicebank_count(UCRA_VoicebankSetHandle set);
+
+/**
+ * @brief Entry of a voicebank set
+ *
+ * @return The entry, valid until ucra_voicebank_destroy(), or NULL if index is out of range
+ */
+UCRA_API const UCRA_VoicebankEntry* UCRA_CALL
+ucra_voicebank_entry(UCRA_VoicebankSetHandle set,
+                     uint32_t index);
+
+/**
+ * @brief Free a voicebank set and release its manifests
+ *
+ * @param set Set to free (may be NULL)
+ */
+UCRA_API void UCRA_CALL
+ucra_voicebank_destroy(UCRA_VoicebankSetHandle set);
+
+/** @} */
+
+/**
+ * @brief Render Cache API
+ * @defgroup RenderCacheAPI On-disk Render Output Cache
+ * @{
+ *
+ * Renders are stored under a key hashed from everything that determines the
+ * output: the engine's manifest name and version, the output format and
+ * flags, every note with its lyric and curves, and the options (in any order)
+ * and typed options. Repeating a render then reads the stored PCM instead of
+ * synthesizing again. Entries are files in one directory; the total size is
+ * kept under a bound by removing the least recently used ones.
+ *
+ * @note Threading: a cache handle is used by one thread at a time. Several
+ *   handles, in one or more processes, may share a directory.
+ */
+
+/**
+ * @brief Open (and create if needed) a render cache directory
+ *
+ * @param out_cache Receives the cache; free it with ucra_render_cache_close()
+ * @param directory Cache directory; its parent must exist
+ * @param max_bytes Total size of the entries to keep, 0 for no bound
+ * @return UCRA_SUCCESS, UCRA_ERR_INVALID_ARGUMENT, UCRA_ERR_FILE_NOT_FOUND if
+ *         the directory cannot be created, or UCRA_ERR_OUT_OF_MEMORY
+ */
+UCRA_API UCRA_Result UCRA_CALL
+ucra_render_cache_open(UCRA_RenderCacheHandle* out_cache,
+                       const char* directory,
+                       uint64_t max_bytes);
+
+/**
+ * @brief Render through the cache
+ *
+ * Returns the stored PCM of an identical earlier render, or else calls
+ * ucra_render() and stores its output. A failure to store is not an error;
+ * the render is just not cached. On a hit outResult has no metadata, and its
+ * PCM is owned by the cache and valid until the next call on the same cache
+ * or ucra_render_cache_close(); on a miss it is the engine's, as for
+ * ucra_render().
+ *
+ * @param cache Cache handle
+ * @param engine Engine handle, used on a miss
+ * @param manifest Manifest of the engine's voicebank, part of the key (may be NULL)
+ * @param config Render configuration including notes and options
+ * @param outResult Pointer to store the render result
+ * @param out_hit Set to 1 on a cache hit, 0 otherwise (may be NULL)
+ * @return UCRA_SUCCESS, or the error of ucra_render()
+ */
+UCRA_API UCRA_Result UCRA_CALL
+ucra_render_cached(UCRA_RenderCacheHandle cache,
+                   UCRA_Handle engine,
+                   const UCRA_Manifest* manifest,
+                   const UCRA_RenderConfig* config,
+                   UCRA_RenderResult* outResult,
+                   int* out_hit);
+
+/**
+ * @brief Close a render cache; its files stay on disk
+ *
+ * @param cache Cache to close (may be NULL)
+ */
+UCRA_API void UCRA_CALL
+ucra_render_cache_close(UCRA_RenderCacheHandle cache);
+
+/** @} */
+
+/**
+ * @brief Render Session API
+ * @defgroup RenderSessionAPI Incremental Re-rendering
+ * @{
+ *
+ * A session keeps the notes and the output of its last render. The next
+ * render compares the notes it is given with those: notes that are
+ * unchanged, wherever they are in the array, keep their audio, and only the
+ * frames under notes that were added, removed or edited, widened by the
+ * session's margin, are rendered again with ucra_render_block() and spliced
+ * into the kept output. An edit therefore costs about as much as the notes
+ * it touches. A change of sample rate, channels, flags or options renders
+ * everything again.
+ *
+ * Only engines that report UCRA_ENGINE_CAP_NOTE_LOCAL are re-rendered in
+ * part; with any other engine, a render whose notes changed, or only
+ * moved within the array, renders everything, so the output is always what ucra_render() gives for the same
+ * config. The margin covers how far a note-local engine's notes reach past
+ * their ends; the built-in engine needs none.
+ *
+ * @note Threading: a session is used by one thread at a time, and it uses
+ *   its engine's block render, which the engine tracks one of at a time.
+ */
+
+/** A run of frames */
+typedef struct UCRA_FrameRange {
+    uint64_t start;  /**< first frame */
+    uint64_t frames; /**< number of frames */
+} UCRA_FrameRange;
+
+/**
+ * @brief Create a session rendering with engine
+ *
+ * @param out_session Receives the session; free it with ucra_render_session_destroy()
+ * @param engine Engine to render with; it must outlive the session
+ * @param margin_sec How far around an edited note its edit may change the
+ *        output of a note-local engine, in seconds (>= 0)
+ * @return UCRA_SUCCESS, UCRA_ERR_INVALID_ARGUMENT or UCRA_ERR_OUT_OF_MEMORY
+ */
+UCRA_API UCRA_Result UCRA_CALL
+ucra_render_session_create(UCRA_RenderSessionHandle* out_session,
+                           UCRA_Handle engine,
+                           double margin_sec);
+
+/**
+ * @brief Render config, re-rendering only what changed since the last render
+ *
+ * The first render, and any render after ucra_render_session_invalidate(),
+ * renders everything. outResult's PCM is owned by the session and valid
+ * until its next render or ucra_render_session_destroy(); it has no
+ * metadata. The session keeps its own copy of the notes, so the caller may
+ * edit its arrays in place between renders.
+ *
+ * @param session Session handle
+ * @param config Render configuration including notes and options
+ * @param outResult Receives the output
+ * @return UCRA_SUCCESS, UCRA_ERR_INVALID_ARGUMENT, UCRA_ERR_OUT_OF_MEMORY, or
+ *         the engine's error; after an error the next render renders everything
+ */
+UCRA_API UCRA_Result UCRA_CALL
+ucra_render_session_render(UCRA_RenderSessionHandle session,
+                           const UCRA_RenderConfig* config,
+                           UCRA_RenderResult* outResult);
+
+/**
+ * @brief Frames the last render rendered, in ascending order
+ *
+ * Everything else was kept from the render before it. A player can restart
+ * from the first range instead of from the top.
+ *
+ * @param session Session handle
+ * @param out_ranges Receives the ranges, owned by the session and valid until
+ *        its next render
+ * @param out_count Receives the number of ranges
+ * @return UCRA_SUCCESS or UCRA_ERR_INVALID_ARGUMENT
+ */
+UCRA_API UCRA_Result UCRA_CALL
+ucra_render_session_dirty(UCRA_RenderSessionHandle session,
+                          const UCRA_FrameRange** out_ranges,
+                          uint32_t* out_count);
+
+/**
+ * @brief Make the next render render everything
+ *
+ * Needed when something the session cannot see changed, such as the
+ * engine's voicebank.
+ */
+UCRA_API void UCRA_CALL
+ucra_render_session_invalidate(UCRA_RenderSessionHandle session);
+
+/**
+ * @brief Free a session (NULL is ignored)
+ */
+UCRA_API void UCRA_CALL
+ucra_render_session_destroy(UCRA_RenderSessionHandle session);
+
+/** @} */
+
+/**
+ * @brief WAV Output API
+ * @defgroup WavOutputAPI Incremental WAV File Writing
+ * @{
+ *
+ * A writer takes interleaved float PCM in blocks of any size, converts it to
+ * the file's sample format and writes it in large buffered writes, so a render
+ * can go to disk as it is produced instead of being collected first. The
+ * header is completed when the writer is closed.
+ */
+
+/** @brief Sample encoding of a written WAV file */
+typedef enum UCRA_SampleFormat {
+    UCRA_SAMPLE_FLOAT32 = 0, /**< 32-bit IEEE float, samples written as given */
+    UCRA_SAMPLE_PCM16 = 1,   /**< 16-bit integer PCM, clipped to [-1, 1) and dithered */
+    UCRA_SAMPLE_PCM24 = 2    /**< 24-bit integer PCM, clipped to [-1, 1) and rounded */
+} UCRA_SampleFormat;
+
+/**
+ * @name WAV writer flags
+ * @{
+ */
+/** Round 16-bit PCM without the default triangular (TPDF) dither of +-1 LSB.
+ *  24-bit PCM is never dithered: float samples carry no finer detail to preserve. */
+#define UCRA_WAV_NO_DITHER 0x1u
+/** Reserve room for an RF64 header, so the file may grow past 4 GB; the file
+ *  stays plain RIFF (with a JUNK chunk) unless it does */
+#define UCRA_WAV_RF64      0x2u
+/** @} */
+
+/**
+ * @brief Create (or truncate) a WAV file for writing
+ *
+ * Without UCRA_WAV_RF64 the file has the canonical 44-byte header that simple
+ * readers expect, and writes that would take it past 4 GB fail.
+ *
+ * @param out_writer Receives the writer; finish it with ucra_wav_writer_close()
+ * @param path File to write
+ * @param sample_rate Sample rate in Hz
+ * @param channels Channel count of the interleaved PCM to write
+ * @param format Sample encoding of the file
+ * @param flags UCRA_WAV_* flags
+ * @return UCRA_SUCCESS, UCRA_ERR_INVALID_ARGUMENT, UCRA_ERR_FILE_NOT_FOUND if
+ *         path cannot be created, or UCRA_ERR_OUT_OF_MEMORY
+ */
+UCRA_API UCRA_Result UCRA_CALL
+ucra_wav_writer_open(UCRA_WavWriterHandle* out_writer,
+                     const char* path,
+                     uint32_t sample_rate,
+                     uint32_t channels,
+                     UCRA_SampleFormat format,
+                     uint32_t flags);
+
+/**
+ * @brief Append frames of interleaved float PCM
+ *
+ * After a failed write every later call fails with the same error, and
+ * ucra_wav_writer_close() reports it as well.
+ *
+ * @param writer Writer handle
+ * @param pcm frames * channels samples
+ * @param frames Number of frames
+ * @return UCRA_SUCCESS, UCRA_ERR_INVALID_ARGUMENT, UCRA_ERR_NOT_SUPPORTED if
+ *         the file would pass 4 GB without UCRA_WAV_RF64, or UCRA_ERR_INTERNAL
+ *         if writing failed
+ */
+UCRA_API UCRA_Result UCRA_CALL
+ucra_wav_writer_write(UCRA_WavWriterHandle writer,
+                      const float* pcm,
+                      uint64_t frames);
+
+/** @brief Frames written so far (0 for NULL) */
+UCRA_API uint64_t UCRA_CALL
+ucra_wav_writer_frames(UCRA_WavWriterHandle writer);
+
+/**
+ * @brief Write the remaining buffered data and the final header, then close the file
+ *
+ * The writer is freed whatever the result.
+ *
+ * @param writer Writer to close
+ * @return UCRA_SUCCESS once the whole file is written, otherwise the first
+ *         error (UCRA_ERR_INVALID_ARGUMENT for NULL)
+ */
+UCRA_API UCRA_Result UCRA_CALL
+ucra_wav_writer_close(UCRA_WavWriterHandle writer);
+
+/** @} */
+
+/**
+ * @brief F0 Curve File API
+ * @defgroup CurveFileAPI F0 Curve File Loading
+ * @{
+ *
+ * Two formats hold an F0 curve:
+ * - text: one "time_sec f0_hz" pair per line; blank lines, lines starting
+ *   with '#' and lines that do not start with two numbers are skipped;
+ * - binary: the 4 bytes "UCF0", then little-endian uint32 version (1), point
+ *   count and a reserved 0, followed by count float times and count float F0
+ *   values. It is memory-mapped, and the loaded curve points into the mapping.
+ */
+
+/**
+ * @brief Load an F0 curve file in either format
+ *
+ * @param out_file Receives the handle that owns the points; release it with ucra_f0_curve_close()
+ * @param path Curve file; the format is told from its first bytes
+ * @param out_curve Receives the curve, valid until the handle is closed
+ * @return UCRA_SUCCESS, UCRA_ERR_INVALID_ARGUMENT if the file holds no points
+ *         or a malformed binary curve, UCRA_ERR_FILE_NOT_FOUND, or UCRA_ERR_OUT_OF_MEMORY
+ */
+UCRA_API UCRA_Result UCRA_CALL
+ucra_f0_curve_open(UCRA_F0FileHandle* out_file,
+                   const char* path,
+                   UCRA_F0Curve* out_curve);
+
+/**
+ * @brief Release a loaded curve file (NULL is ignored)
+ */
+UCRA_API void UCRA_CALL
+ucra_f0_curve_close(UCRA_F0FileHandle file);
+
+/**
+ * @brief Write a curve in the binary format
+ *
+ * The file is written beside path and then moved over it, so no reader sees
+ * a partly written curve.
+ *
+ * @param path File to write
+ * @param curve Curve with at least one point
+ * @return UCRA_SUCCESS, UCRA_ERR_INVALID_ARGUMENT, UCRA_ERR_FILE_NOT_FOUND if
+ *         path cannot be created, or UCRA_ERR_INTERNAL if writing failed
+ */
+UCRA_API UCRA_Result UCRA_CALL
+ucra_f0_curve_save(const char* path,
+                   const UCRA_F0Curve* curve);
+
+/** @} */
+
+/**
+ * @brief Timeline API
+ * @defgroup TimelineAPI Joining Rendered Notes
+ * @{
+ *
+ * A timeline does what the wavtool stage of the UTAU pipeline does: it lays
+ * rendered notes out in time and joins them into one voice line. A note
+ * starts its preutterance before its position. Over its overlap it
+ * crossfades with what is there already, and it replaces everything mixed
+ * after that. Its own envelope points shape it as well.
+ *
+ * The output goes to a caller buffer or, as it is finished, to a sink. A
+ * sink only needs memory for the notes that currently overlap.
+ */
+
+/**
+ * @brief A rendered note to place on a timeline
+ */
+typedef struct UCRA_TimelineNote {
+    const float* pcm;           /**< interleaved frames in the timeline's channel count */
+    uint64_t frames;            /**< number of frames in pcm */
+    double start_sec;           /**< timeline position of the note (its downbeat) */
+    double preutter_sec;        /**< pcm starts this long before start_sec */
+    double overlap_sec;         /**< crossfade with the audio already there, from pcm's start */
+    const UCRA_EnvCurve* envelope; /**< linear gains at times from pcm's start, interpolated
+                                        linearly and held past the ends; NULL for unity */
+} UCRA_TimelineNote;
+
+/**
+ * @brief Receives finished timeline audio, in order
+ *
+ * @return UCRA_SUCCESS to go on; any other value fails the timeline with it
+ */
+typedef UCRA_Result (UCRA_CALL *UCRA_TimelineSink)(void* user_data,
+                                                   const float* pcm,
+                                                   uint32_t frames);
+
+/**
+ * @brief Create a timeline that mixes into a caller buffer
+ *
+ * The buffer is cleared; audio past its end is dropped.
+ *
+ * @param out_timeline Receives the timeline; free it with ucra_timeline_destroy()
+ * @param sample_rate Sample rate of the notes in Hz
+ * @param channels Channel count of the notes
+ * @param buffer frame_capacity * channels floats, valid while the timeline is used
+ * @param frame_capacity Frames in buffer
+ * @return UCRA_SUCCESS, UCRA_ERR_INVALID_ARGUMENT or UCRA_ERR_OUT_OF_MEMORY
+ */
+UCRA_API UCRA_Result UCRA_CALL
+ucra_timeline_create_buffer(UCRA_TimelineHandle* out_timeline,
+                            uint32_t sample_rate,
+                            uint32_t channels,
+                            float* buffer,
+                            uint64_t frame_capacity);
+
+/**
+ * @brief Create a timeline that hands finished audio to a sink
+ *
+ * Audio before the start of the latest note can no longer change, so it goes
+ * to sink when that note is added; the rest goes at ucra_timeline_finish().
+ *
+ * @param out_timeline Receives the timeline; free it with ucra_timeline_destroy()
+ * @param sample_rate Sample rate of the notes in Hz
+ * @param channels Channel count of the notes
+ * @param sink Called with each finished piece
+ * @param user_data Passed to sink
+ * @return UCRA_SUCCESS, UCRA_ERR_INVALID_ARGUMENT or UCRA_ERR_OUT_OF_MEMORY
+ */
+UCRA_API UCRA_Result UCRA_CALL
+ucra_timeline_create_stream(UCRA_TimelineHandle* out_timeline,
+                            uint32_t sample_rate,
+                            uint32_t channels,
+                            UCRA_TimelineSink sink,
+                            void* user_data);
+
+/**
+ * @brief Mix a note into the timeline
+ *
+ * Notes are added in order: each one's pcm may not start before the previous
+ * one's. The timeline starts at 0, and audio before 0 is dropped. The note's
+ * PCM is not kept after the call.
+ *
+ * @param timeline Timeline handle
+ * @param note Note to place
+ * @return UCRA_SUCCESS, UCRA_ERR_INVALID_ARGUMENT (also for a note out of
+ *         order or a finished timeline), UCRA_ERR_OUT_OF_MEMORY, or the
+ *         sink's error
+ */
+UCRA_API UCRA_Result UCRA_CALL
+ucra_timeline_add(UCRA_TimelineHandle timeline,
+                  const UCRA_TimelineNote* note);
+
+/**
+ * @brief End the timeline, handing the remaining audio to the sink
+ *
+ * @param timeline Timeline handle
+ * @param out_frames Receives the timeline's length in frames (for a buffer,
+ *        at most its capacity), may be NULL
+ * @return UCRA_SUCCESS, UCRA_ERR_INVALID_ARGUMENT, or the first error of the
+ *         timeline's sink
+ */
+UCRA_API UCRA_Result UCRA_CALL
+ucra_timeline_finish(UCRA_TimelineHandle timeline,
+                     uint64_t* out_frames);
+
+/**
+ * @brief Free a timeline (NULL is ignored)
+ */
+UCRA_API void UCRA_CALL
+ucra_timeline_destroy(UCRA_TimelineHandle timeline);
+
+/** @} */
+
+/**
+ * @brief Sample-Rate Conversion API
+ * @defgroup ResamplerAPI Converting PCM between Sample Rates
+ * @{
+ *
+ * A resampler converts interleaved PCM from one rate to another with a
+ * polyphase windowed-sinc filter, so an engine can render, or a voicebank
+ * sample be analysed, at its own rate and the result be converted once. The
+ * filter for a pair of rates is computed the first time it is used and then
+ * shared by every resampler of that ratio in the process.
+ *
+ * Input is taken in pieces of any size. Output frame j is the input signal
+ * at time j / out_rate, so converted audio lines up with its source; it is
+ * emitted once ucra_resampler_latency() input frames past that time have
+ * arrived, and ucra_resampler_drain() emits the rest at the end.
+ */
+
+/** Most filter phases (out_rate / gcd(in_rate, out_rate)) a resampler supports */
+#define UCRA_RESAMPLER_MAX_PHASES 1024u
+/** Highest in_rate / out_rate a resampler supports; its filter grows with the ratio */
+#define UCRA_RESAMPLER_MAX_DECIMATION 64u
+
+/**
+ * @brief Create a resampler
+ *
+ * @param out_resampler Receives the resampler; free it with ucra_resampler_destroy()
+ * @param in_rate Sample rate of the input in Hz
+ * @param out_rate Sample rate of the output in Hz
+ * @param channels Channel count of both
+ * @return UCRA_SUCCESS, UCRA_ERR_INVALID_ARGUMENT, UCRA_ERR_OUT_OF_MEMORY, or
+ *         UCRA_ERR_NOT_SUPPORTED if the ratio needs more than
+ *         UCRA_RESAMPLER_MAX_PHASES phases or decimates by more than
+ *         UCRA_RESAMPLER_MAX_DECIMATION
+ */
+UCRA_API UCRA_Result UCRA_CALL
+ucra_resampler_create(UCRA_ResamplerHandle* out_resampler,
+                      uint32_t in_rate,
+                      uint32_t out_rate,
+                      uint32_t channels);
+
+/**
+ * @brief Convert input, stopping early when the output is full
+ *
+ * @param resampler Resampler handle
+ * @param in in_frames interleaved input frames (may be NULL if in_frames is 0)
+ * @param in_frames Frames in in
+ * @param in_used Receives the frames of in consumed; call again with the rest
+ *        once the output has been used (may be NULL if everything always fits)
+ * @param out Receives up to out_capacity interleaved output frames
+ * @param out_capacity Frames out holds
+ * @param out_frames Receives the frames written to out
+ * @return UCRA_SUCCESS, or UCRA_ERR_INVALID_ARGUMENT (also after
+ *         ucra_resampler_drain() until ucra_resampler_reset())
+ */
+UCRA_API UCRA_Result UCRA_CALL
+ucra_resampler_process(UCRA_ResamplerHandle resampler,
+                       const float* in,
+                       uint32_t in_frames,
+                       uint32_t* in_used,
+                       float* out,
+                       uint32_t out_capacity,
+                       uint32_t* out_frames);
+
+/**
+ * @brief End the input and emit the output it still holds
+ *
+ * Call it until out_frames is less than out_capacity. After that the input
+ * has given ucra_resampler_output_frames() frames in all.
+ *
+ * @return UCRA_SUCCESS or UCRA_ERR_INVALID_ARGUMENT
+ */
+UCRA_API UCRA_Result UCRA_CALL
+ucra_resampler_drain(UCRA_ResamplerHandle resampler,
+                     float* out,
+                     uint32_t out_capacity,
+                     uint32_t* out_frames);
+
+/**
+ * @brief Output frames that in_frames input frames convert to, drain included
+ */
+UCRA_API uint64_t UCRA_CALL
+ucra_resampler_output_frames(UCRA_ResamplerHandle resampler,
+                             uint64_t in_frames);
+
+/**
+ * @brief Input frames past an output frame's time needed before it is emitted
+ */
+UCRA_API uint32_t UCRA_CALL
+ucra_resampler_latency(UCRA_ResamplerHandle resampler);
+
+/**
+ * @brief Forget all input, as if the resampler were new
+ */
+UCRA_API void UCRA_CALL
+ucra_resampler_reset(UCRA_ResamplerHandle resampler);
+
+/**
+ * @brief Free a resampler (NULL is ignored)
+ */
+UCRA_API void UCRA_CALL
+ucra_resampler_destroy(UCRA_ResamplerHandle resampler);
+
 /** @} */
 
 /**
@@ -359,6 +1322,13 @@ ucra_manifest_free(UCRA_Manifest* manifest);
  * Creates a streaming session with the provided configuration and callback.
  * The callback will be invoked when more PCM data is needed.
  *
+ * Buffering is tuned with config->options (values in frames unless noted):
+ * "stream_buffer_frames" (ring size, rounded up to a power of two),
+ * "stream_prefill_frames" (rendered before this call returns; default a full
+ * ring), "stream_low_watermark" / "stream_high_watermark" (refill below the
+ * low mark, up to the high one) and "stream_render_ahead" ("1" to render on a
+ * background producer thread, which then also runs the callback).
+ *
  * @param out_stream Output stream handle
  * @param config Base render configuration (sample_rate, channels, block_size)
  * @param callback Function to call when more data is needed
@@ -371,10 +1341,37 @@ ucra_stream_open(UCRA_StreamHandle* out_stream,
                  UCRA_PullPCM callback,
                  void* user_data);
 
+/**
+ * @brief Initialize a streaming session that plays an engine's render
+ *
+ * Like ucra_stream_open(), but the frames come from ucra_render_block() on
+ * engine, so the stream carries the same audio ucra_render() produces for the
+ * notes the callback supplies. The notes returned by the callback must cover
+ * the whole song, in song time, and stay valid until the next callback; the
+ * stream asks the engine for the frames that follow the ones it already has.
+ * The engine must outlive the stream and must not render blocks for anyone
+ * else meanwhile. A NULL engine behaves exactly like ucra_stream_open().
+ *
+ * @param out_stream Output stream handle
+ * @param engine Engine that renders the stream (may be NULL)
+ * @param config Base render configuration (sample_rate, channels, block_size)
+ * @param callback Function to call when more data is needed
+ * @param user_data User context data passed to the callback
+ * @return UCRA_SUCCESS on success, or an error code on failure
+ */
+UCRA_API UCRA_Result UCRA_CALL
+ucra_stream_open_engine(UCRA_StreamHandle* out_stream,
+                        UCRA_Handle engine,
+                        const UCRA_RenderConfig* config,
+                        UCRA_PullPCM callback,
+                        void* user_data);
+
 /**
  * @brief Read a block of PCM data from the stream
  *
- * This function may block until sufficient data is available.
+ * Never waits for the producer: without render-ahead the block is rendered
+ * on the calling thread, with render-ahead this only copies buffered frames and
+ * an underrun is reported as a short read.
  *
  * @param stream Stream handle
  * @param out_buffer Buffer to write PCM data (interleaved float32)
@@ -388,6 +1385,85 @@ ucra_stream_read(UCRA_StreamHandle stream,
                  uint32_t frame_count,
                  uint32_t* out_frames_read);
 
+/**
+ * @brief Borrow buffered PCM from the stream without copying it
+ *
+ * Exposes up to max_frames frames of the stream's ring as one or two
+ * contiguous regions of interleaved float32 (the second is used when the
+ * frames wrap around the end of the ring, and is NULL otherwise). Rendering
+ * follows the same rules as ucra_stream_read(): nothing waits, so fewer
+ * frames than requested, or none, may be returned.
+ *
+ * The regions stay valid and unchanged until ucra_stream_release(); calling
+ * ucra_stream_acquire() again before that exposes the same frames first.
+ * Consuming frames with ucra_stream_read() meanwhile invalidates them.
+ *
+ * @param stream Stream handle
+ * @param max_frames Most frames to expose
+ * @param out_first Start of the first region (NULL if no frames)
+ * @param out_first_frames Frames in the first region
+ * @param out_second Start of the second region (NULL if unused)
+ * @param out_second_frames Frames in the second region
+ * @return UCRA_SUCCESS on success, or an error code on failure
+ */
+UCRA_API UCRA_Result UCRA_CALL
+ucra_stream_acquire(UCRA_StreamHandle stream,
+                    uint32_t max_frames,
+                    const float** out_first,
+                    uint32_t* out_first_frames,
+                    const float** out_second,
+                    uint32_t* out_second_frames);
+
+/**
+ * @brief Return frames borrowed with ucra_stream_acquire() to the stream
+ *
+ * The first frame_count acquired frames are consumed, as if read; the rest
+ * stay buffered and are exposed again by the next acquire.
+ *
+ * @param stream Stream handle
+ * @param frame_count Frames consumed, at most the number last acquired
+ * @return UCRA_SUCCESS, or UCRA_ERR_INVALID_ARGUMENT if more frames are released than acquired
+ */
+UCRA_API UCRA_Result UCRA_CALL
+ucra_stream_release(UCRA_StreamHandle stream,
+                    uint32_t frame_count);
+
+/**
+ * @brief Performance counters of a stream, cumulative since it was opened
+ *
+ * Times are in nanoseconds. A block is config->block_size frames; the render
+ * time of a refill that renders several blocks is split evenly between them.
+ */
+typedef struct UCRA_StreamStats {
+    uint64_t frames_produced;  /**< Frames rendered into the stream's buffer */
+    uint64_t reads;            /**< ucra_stream_read() and ucra_stream_acquire() calls */
+    uint64_t underruns;        /**< Reads that returned fewer frames than requested */
+    uint32_t fill_min;         /**< Fewest frames buffered when a read started */
+    uint32_t fill_max;         /**< Most frames buffered when a read started */
+    uint64_t callback_count;   /**< Pull callback invocations */
+    uint64_t callback_ns;      /**< Total time spent in the pull callback */
+    uint64_t blocks_rendered;  /**< Blocks synthesized */
+    uint64_t render_ns_min;    /**< Fastest block */
+    uint64_t render_ns_avg;    /**< Mean block */
+    uint64_t render_ns_max;    /**< Slowest block */
+    uint64_t render_ns_p99;    /**< 99th percentile block, rounded up by at most 25% */
+} UCRA_StreamStats;
+
+/**
+ * @brief Sample a stream's performance counters
+ *
+ * The counters are kept with plain atomic stores on the render and read
+ * paths, so they are always on; this call may be made from any thread while
+ * the stream is in use.
+ *
+ * @param stream Stream handle
+ * @param out_stats Receives the counters
+ * @return UCRA_SUCCESS on success
+ */
+UCRA_API UCRA_Result UCRA_CALL
+ucra_stream_get_stats(UCRA_StreamHandle stream,
+                      UCRA_StreamStats* out_stats);
+
 /**
  * @brief Close and cleanup a streaming session
  *
@@ -398,6 +1474,189 @@ ucra_stream_read(UCRA_StreamHandle stream,
 UCRA_API void UCRA_CALL
 ucra_stream_close(UCRA_StreamHandle stream);
 
+/**
+ * @brief Mixer API
+ *
+ * A mixer sums several streams (tracks) into one output stream. Each read
+ * pulls the next frames of every track in parallel on a worker pool shared by
+ * all tracks, then applies each track's gain and pan. A mixer is used from one
+ * thread, like a stream; ucra_mixer_set_track() may be called from any thread.
+ */
+
+/**
+ * @brief Create an empty mixer
+ *
+ * config supplies the output sample_rate, channels (1 or 2) and block_size;
+ * its notes are ignored. The option "render_threads" sets the number of
+ * threads tracks are rendered on (default 0, one per CPU).
+ *
+ * @param out_mixer Receives the mixer handle
+ * @param config Output format
+ * @return UCRA_SUCCESS on success, UCRA_ERR_INVALID_ARGUMENT for other channel counts
+ */
+UCRA_API UCRA_Result UCRA_CALL
+ucra_mixer_create(UCRA_MixerHandle* out_mixer,
+                  const UCRA_RenderConfig* config);
+
+/**
+ * @brief Add a track rendered by its own stream
+ *
+ * The track is opened like ucra_stream_open_engine() with the mixer's sample
+ * rate and block size and one channel; the other fields of config, including
+ * its options, apply to the track alone. Tracks rendered in parallel must not
+ * share an engine. Tracks start at unity gain, centred.
+ *
+ * @param mixer Mixer handle
+ * @param engine Engine rendering the track, or NULL for the built-in renderer
+ * @param config Track configuration passed to callback, may be NULL
+ * @param callback Pull callback of the track
+ * @param user_data User data passed to callback
+ * @param out_track Receives the track index, may be NULL
+ * @return UCRA_SUCCESS on success
+ */
+UCRA_API UCRA_Result UCRA_CALL
+ucra_mixer_add_track(UCRA_MixerHandle mixer,
+                     UCRA_Handle engine,
+                     const UCRA_RenderConfig* config,
+                     UCRA_PullPCM callback,
+                     void* user_data,
+                     uint32_t* out_track);
+
+/**
+ * @brief Set a track's gain and pan
+ *
+ * Pan runs from -1 (left) to 1 (right) with a constant-power law; a mono
+ * mixer ignores it. Takes effect from the next read.
+ *
+ * @param mixer Mixer handle
+ * @param track Track index
+ * @param gain Linear gain
+ * @param pan Pan position in [-1, 1]
+ * @return UCRA_SUCCESS on success
+ */
+UCRA_API UCRA_Result UCRA_CALL
+ucra_mixer_set_track(UCRA_MixerHandle mixer,
+                     uint32_t track,
+                     float gain,
+                     float pan);
+
+/**
+ * @brief Stream behind a track, e.g. for ucra_stream_get_stats()
+ *
+ * The stream stays owned by the mixer and must not be read or closed.
+ *
+ * @param mixer Mixer handle
+ * @param track Track index
+ * @param out_stream Receives the track's stream
+ * @return UCRA_SUCCESS on success
+ */
+UCRA_API UCRA_Result UCRA_CALL
+ucra_mixer_get_track_stream(UCRA_MixerHandle mixer,
+                            uint32_t track,
+                            UCRA_StreamHandle* out_stream);
+
+/**
+ * @brief Read mixed audio
+ *
+ * Fills out_buffer with interleaved frames of the mixer's channel count.
+ * Tracks that end early are silent for the rest of the read; a short read
+ * means no track had more to deliver. Does not allocate.
+ *
+ * @param mixer Mixer handle
+ * @param out_buffer Buffer of frame_count * channels floats
+ * @param frame_count Frames requested
+ * @param out_frames_read Receives the frames written
+ * @return UCRA_SUCCESS on success
+ */
+UCRA_API UCRA_Result UCRA_CALL
+ucra_mixer_read(UCRA_MixerHandle mixer,
+                float* out_buffer,
+                uint32_t frame_count,
+                uint32_t* out_frames_read);
+
+/**
+ * @brief Destroy a mixer, closing its tracks' streams
+ *
+ * @param mixer Mixer handle
+ */
+UCRA_API void UCRA_CALL
+ucra_mixer_destroy(UCRA_MixerHandle mixer);
+
+/** @} */
+
+/**
+ * @brief Tracing API
+ * @defgroup TracingAPI Hot-path Tracing
+ * @{
+ *
+ * Libraries built with UCRA_ENABLE_TRACING (which defines UCRA_TRACING)
+ * time the stages of a render: manifest loading, flag mapping, F0
+ * preparation, spectral envelope fill, synthesis, channel fan-out and stream
+ * refills. Each thread records into its own fixed-size buffer without locks;
+ * a full buffer drops new events until it is drained. Without the option the
+ * hooks compile to nothing and these functions return UCRA_ERR_NOT_SUPPORTED.
+ */
+
+/** @brief One timed span */
+typedef struct UCRA_TraceEvent {
+    const char* name;     /**< Stage, such as "engine.render"; a static string */
+    uint64_t start_ns;    /**< Start on the monotonic clock, in nanoseconds */
+    uint64_t duration_ns; /**< Length in nanoseconds */
+    uint32_t thread_id;   /**< Small id of the recording thread, reused after it exits */
+} UCRA_TraceEvent;
+
+/**
+ * @brief Receives drained trace events
+ *
+ * @param user_data Context passed to ucra_trace_drain()
+ * @param events Events of one thread, oldest first; valid during the call
+ * @param count Number of events
+ */
+typedef void (UCRA_CALL *UCRA_TraceCallback)(void* user_data,
+                                             const UCRA_TraceEvent* events,
+                                             uint32_t count);
+
+/**
+ * @brief Start or stop recording trace events
+ *
+ * Off by default. While off, each hook costs one load of a flag.
+ *
+ * @param enabled Nonzero to record
+ * @return UCRA_SUCCESS, or UCRA_ERR_NOT_SUPPORTED without UCRA_TRACING
+ */
+UCRA_API UCRA_Result UCRA_CALL
+ucra_trace_enable(int enabled);
+
+/**
+ * @brief Hand every recorded event to callback and remove it
+ *
+ * May run while other threads record; events finished after the call starts
+ * may be left for the next drain. Drains are serialized, and the callback
+ * must not drain again.
+ *
+ * @param callback Receives the events, in batches
+ * @param user_data Passed to callback
+ * @param out_dropped Receives the events dropped since the previous drain because a buffer was full (may be NULL)
+ * @return UCRA_SUCCESS, UCRA_ERR_INVALID_ARGUMENT, or UCRA_ERR_NOT_SUPPORTED without UCRA_TRACING
+ */
+UCRA_API UCRA_Result UCRA_CALL
+ucra_trace_drain(UCRA_TraceCallback callback,
+                 void* user_data,
+                 uint64_t* out_dropped);
+
+/**
+ * @brief Drain every recorded event into a Chrome trace file
+ *
+ * Writes the JSON object format, one complete ("X") event per span, for
+ * chrome://tracing or Perfetto.
+ *
+ * @param path File to create or replace
+ * @return UCRA_SUCCESS, UCRA_ERR_FILE_NOT_FOUND if the file cannot be written,
+ *         or UCRA_ERR_NOT_SUPPORTED without UCRA_TRACING
+ */
+UCRA_API UCRA_Result UCRA_CALL
+ucra_trace_write_chrome(const char* path);
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif
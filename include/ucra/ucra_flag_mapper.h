@@ -12,6 +12,7 @@
 #define UCRA_FLAG_MAPPER_H
 
 #include "ucra/ucra.h"
+#include <stddef.h>
 #include <stdint.h>
 
 #ifdef __cplusplus
@@ -48,8 +49,12 @@ typedef struct UCRA_FlagRule {
     uint32_t map_count;       /**< Number of map entries */
     char* constant_value;     /**< Constant value for constant transform */
     char* default_value;      /**< Default value if source not found */
+    UCRA_ValueType value_type; /**< Type ucra_flag_mapper_apply_typed() gives the target */
 } UCRA_FlagRule;
 
+/** @brief Lookup tables built by ucra_flag_mapper_compile() (opaque) */
+typedef struct UCRA_FlagMapperIndex UCRA_FlagMapperIndex;
+
 /**
  * @brief Flag mapping ruleset
  *
@@ -60,6 +65,7 @@ typedef struct UCRA_FlagMapper {
     char* version;           /**< Mapper version */
     UCRA_FlagRule* rules;    /**< Array of mapping rules */
     uint32_t rule_count;     /**< Number of rules */
+    UCRA_FlagMapperIndex* index; /**< Hash indexes over the rules, NULL if not compiled */
 } UCRA_FlagMapper;
 
 /**
@@ -93,6 +99,20 @@ typedef struct UCRA_FlagMapResult {
  */
 UCRA_API UCRA_Result UCRA_CALL ucra_flag_mapper_load(const char* json_path, UCRA_FlagMapper** mapper);
 
+/**
+ * @brief Build the hash indexes of a mapper
+ *
+ * Indexes the rules by source name and each map transform by key, and
+ * precomputes the scale factors, so ucra_flag_mapper_apply() runs in time
+ * proportional to the number of rules plus legacy flags. ucra_flag_mapper_load()
+ * compiles the mappers it returns; call this again after changing the rules
+ * of a mapper. A mapper without an index is applied by linear search.
+ *
+ * @param mapper Mapper to index
+ * @return UCRA_SUCCESS, or UCRA_ERR_OUT_OF_MEMORY (the mapper then stays usable without an index)
+ */
+UCRA_API UCRA_Result UCRA_CALL ucra_flag_mapper_compile(UCRA_FlagMapper* mapper);
+
 /**
  * @brief Free flag mapper resources
  *
@@ -118,6 +138,66 @@ UCRA_API UCRA_Result UCRA_CALL ucra_flag_mapper_apply(const UCRA_FlagMapper* map
                                                      const UCRA_KeyValue* legacy_flags, uint32_t legacy_count,
                                                      UCRA_FlagMapResult* result);
 
+/**
+ * @brief Arena size that ucra_flag_mapper_apply_into() needs for a mapper
+ *
+ * A bound for any input, so an arena of this size can be allocated once
+ * and reused for every call with the same mapper.
+ *
+ * @param mapper Flag mapper (0 for NULL)
+ * @return Size in bytes
+ */
+UCRA_API size_t UCRA_CALL ucra_flag_mapper_arena_size(const UCRA_FlagMapper* mapper);
+
+/**
+ * @brief Apply flag mapping rules without allocating
+ *
+ * Same mapping as ucra_flag_mapper_apply(), but the result lives in the
+ * caller's arena and in the storage it was made from: keys point at the
+ * mapper's target names, and copied, mapped, constant and default values
+ * at the mapper's or legacy_flags' strings. Only scaled numbers and warnings
+ * are written into the arena. The result stays valid while the mapper,
+ * legacy_flags and the arena do, and must not be passed to
+ * ucra_flag_map_result_free().
+ *
+ * @param mapper Flag mapper containing the rules
+ * @param legacy_flags Array of legacy flags to transform
+ * @param legacy_count Number of legacy flags
+ * @param arena Caller-owned scratch memory
+ * @param arena_size Size of arena, at least ucra_flag_mapper_arena_size(mapper)
+ * @param result Result structure to populate
+ * @return UCRA_SUCCESS, or UCRA_ERR_INVALID_ARGUMENT if the arena is missing or too small
+ */
+UCRA_API UCRA_Result UCRA_CALL ucra_flag_mapper_apply_into(const UCRA_FlagMapper* mapper,
+                                                          const UCRA_KeyValue* legacy_flags, uint32_t legacy_count,
+                                                          void* arena, size_t arena_size,
+                                                          UCRA_FlagMapResult* result);
+
+/**
+ * @brief Apply flag mapping rules into typed values
+ *
+ * Same mapping as ucra_flag_mapper_apply(), but each target is produced as
+ * its rule's value_type, so engines read numbers without formatting and
+ * parsing them again: scaled values stay doubles, INT values are rounded,
+ * BOOL accepts true/false, yes/no, on/off or a number, and an ENUM carries
+ * its map entry index and mapped value. Text fields point at the mapper's or
+ * legacy_flags' strings and keys at the mapper's target names, so nothing is
+ * allocated. Inputs that do not convert to the rule's type are skipped;
+ * use ucra_flag_mapper_apply() to get warnings for them.
+ *
+ * @param mapper Flag mapper containing the rules
+ * @param legacy_flags Array of legacy flags to transform
+ * @param legacy_count Number of legacy flags
+ * @param out_values Values to fill, one per rule at most
+ * @param capacity Number of elements in out_values
+ * @param out_count Number of values written
+ * @return UCRA_SUCCESS, or UCRA_ERR_INVALID_ARGUMENT if capacity is less than the rule count
+ */
+UCRA_API UCRA_Result UCRA_CALL ucra_flag_mapper_apply_typed(const UCRA_FlagMapper* mapper,
+                                                           const UCRA_KeyValue* legacy_flags, uint32_t legacy_count,
+                                                           UCRA_TypedValue* out_values, uint32_t capacity,
+                                                           uint32_t* out_count);
+
 /**
  * @brief Free flag mapping result
  *
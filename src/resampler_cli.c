@@ -1,19 +1,61 @@
 /*
  * UCRA Legacy CLI Bridge (resampler.exe)
- * Drop-in replacement for UTAU resamplers with CLI compatibility
+ * Drop-in replacement for UTAU resamplers with CLI compatibility.
+ *
+ * Besides one note per process, the bridge can run as a server that keeps the
+ * engine, the flag mapper and the voicebank manifests loaded and renders one
+ * legacy invocation per line from stdin or a local socket. With
+ * UCRA_RESAMPLER_SOCKET set, a plain invocation forwards its arguments to such
+ * a server and only renders itself when none is listening.
  */
 
 #include "ucra/ucra.h"
 #include "ucra/ucra_flag_mapper.h"
+#include "ucra_sample_store.h"
+#include "ucra_threads.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
 
-#ifndef M_PI
-#define M_PI 3.14159265358979323846
+#ifdef _WIN32
+    #include <direct.h>
+    #define ucra_chdir(path) _chdir(path)
+    #define ucra_getcwd(buf, size) _getcwd(buf, (int)(size))
+#else
+    #include <unistd.h>
+    #include <sys/socket.h>
+    #include <sys/un.h>
+    #define ucra_chdir(path) chdir(path)
+    #define ucra_getcwd(buf, size) getcwd(buf, size)
 #endif
 
+/* Environment variable naming the socket of a running server */
+#define UCRA_SERVER_SOCKET_ENV "UCRA_RESAMPLER_SOCKET"
+
+/* Mapping loaded for legacy flags unless --mapping names another */
+#define UCRA_DEFAULT_MAPPING "tools/flag_mapper/mappings/moresampler_map.json"
+
+/* Envelope points a note of a --concat batch may give with --envelope */
+#define UCRA_CLI_ENV_POINTS 8
+
+/* Render cache bound unless --cache-size gives another, in MB */
+#define UCRA_DEFAULT_CACHE_MB 1024
+
+/* Longest request line and most arguments in one */
+#define UCRA_CLI_LINE_MAX 8192
+#define UCRA_CLI_MAX_ARGS 64
+
+/* Exit codes, also the codes of server replies */
+#define UCRA_EXIT_OK 0
+#define UCRA_EXIT_USAGE 1     /* help requested or required argument missing */
+#define UCRA_EXIT_ARGS 2      /* arguments could not be parsed */
+#define UCRA_EXIT_MANIFEST 3
+#define UCRA_EXIT_NOTE 4
+#define UCRA_EXIT_CONFIG 5
+#define UCRA_EXIT_RENDER 6
+#define UCRA_EXIT_WRITE 7
+
 /* Cross-platform argument parsing (Windows compatible) */
 static int ucra_find_arg(int argc, char* argv[], const char* short_opt, const char* long_opt, char** value) {
     *value = NULL;
@@ -51,6 +93,17 @@ typedef struct UCRA_CLIArgs {
     char* vb_root;          /* --vb-root */
     char* oto_file;         /* --oto */
     uint32_t sample_rate;   /* --rate */
+    double offset_ms;       /* --offset: start of the used region of the input */
+    double cutoff_ms;       /* --cutoff: > 0 trims from the end, < 0 is the length from the offset */
+    UCRA_SampleFormat wav_format; /* --wav-format */
+
+    /* Placement on the --concat timeline */
+    double preutter_ms;     /* --preutter */
+    double overlap_ms;      /* --overlap */
+    uint32_t env_points;    /* --envelope: ms from the note's start (from its end if from_end), gain */
+    double env_ms[UCRA_CLI_ENV_POINTS];
+    float env_gain[UCRA_CLI_ENV_POINTS];
+    uint8_t env_from_end[UCRA_CLI_ENV_POINTS];
 
     /* Parsed note information */
     char* lyric;
@@ -135,35 +188,82 @@ static UCRA_Result ucra_parse_note_info(const char* note_str, UCRA_CLIArgs* args
     return UCRA_SUCCESS;
 }
 
-/* Print usage information */
-static void ucra_print_usage(const char* program_name) {
-    printf("UCRA Legacy CLI Bridge v1.0\n");
-    printf("Usage: %s [options]\n\n", program_name);
-    printf("Required options:\n");
-    printf("  -i, --input PATH        Input WAV file path\n");
-    printf("  -o, --output PATH       Output WAV file path\n");
-    printf("  -n, --note INFO         Note information (lyric midi_note velocity)\n");
-    printf("  -v, --vb-root PATH      Voicebank root directory\n\n");
-    printf("Optional options:\n");
-    printf("  -t, --tempo BPM         Tempo in BPM (default: 120)\n");
-    printf("  -f, --flags FLAGS       Engine-specific flags\n");
-    printf("  -c, --f0-curve PATH     F0 curve file path\n");
-    printf("  -O, --oto PATH          OTO configuration file\n");
-    printf("  -r, --rate RATE         Sample rate (default: 44100)\n");
-    printf("  -h, --help              Show this help message\n\n");
-    printf("Example:\n");
-    printf("  %s -i input.wav -o output.wav -n \"a 60 100\" -v /path/to/voicebank\n", program_name);
-}
-
-/* Parse command line arguments using cross-platform approach */
-static UCRA_Result ucra_parse_cli_args(int argc, char* argv[], UCRA_CLIArgs* args) {
+/* Print usage information to out */
+static void ucra_print_usage(FILE* out, const char* program_name) {
+    fprintf(out, "UCRA Legacy CLI Bridge v1.0\n");
+    fprintf(out, "Usage: %s [options]\n\n", program_name);
+    fprintf(out, "Required options:\n");
+    fprintf(out, "  -i, --input PATH        Input WAV file path\n");
+    fprintf(out, "  -o, --output PATH       Output WAV file path\n");
+    fprintf(out, "  -n, --note INFO         Note information (lyric midi_note velocity)\n");
+    fprintf(out, "  -v, --vb-root PATH      Voicebank root directory\n\n");
+    fprintf(out, "Optional options:\n");
+    fprintf(out, "  -t, --tempo BPM         Tempo in BPM (default: 120)\n");
+    fprintf(out, "  -f, --flags FLAGS       Engine-specific flags\n");
+    fprintf(out, "  -c, --f0-curve PATH     F0 curve file path\n");
+    fprintf(out, "  -O, --oto PATH          OTO configuration file\n");
+    fprintf(out, "  -r, --rate RATE         Sample rate (default: 44100)\n");
+    fprintf(out, "  -a, --offset MS         Start of the input region to use (default: 0)\n");
+    fprintf(out, "  -e, --cutoff MS         Trim from the input's end, or region length if negative\n");
+    fprintf(out, "  -w, --wav-format FMT    Output samples: float, 16 or 24 (default: float)\n");
+    fprintf(out, "  -m, --mapping PATH      Flag mapping (default: %s)\n", UCRA_DEFAULT_MAPPING);
+    fprintf(out, "  -k, --cache DIR         Reuse identical renders stored in DIR\n");
+    fprintf(out, "  -K, --cache-size MB     Size the render cache is kept under (default: %d)\n",
+            UCRA_DEFAULT_CACHE_MB);
+    fprintf(out, "  -h, --help              Show this help message\n\n");
+    fprintf(out, "Server mode:\n");
+    fprintf(out, "  -S, --server            Render one invocation's options per stdin line\n");
+    fprintf(out, "  -s, --socket PATH       With --server, accept requests on a local socket instead\n\n");
+    fprintf(out, "Batch mode:\n");
+    fprintf(out, "  -b, --batch FILE        Render the requests in FILE (- for stdin), one per line\n");
+    fprintf(out, "  -j, --jobs N            Render threads (default: one per CPU)\n");
+    fprintf(out, "  -C, --concat PATH       Join the notes into one WAV instead of writing their outputs\n");
+    fprintf(out, "  -p, --preutter MS       With --concat, start the note this much before its place\n");
+    fprintf(out, "  -l, --overlap MS        With --concat, crossfade this much with the note before\n");
+    fprintf(out, "  -E, --envelope POINTS   With --concat, gains as ms:percent,... (-ms from the end)\n\n");
+    fprintf(out, "With %s set, invocations are forwarded to the server on that socket.\n\n",
+            UCRA_SERVER_SOCKET_ENV);
+    fprintf(out, "Example:\n");
+    fprintf(out, "  %s -i input.wav -o output.wav -n \"a 60 100\" -v /path/to/voicebank\n", program_name);
+}
+
+/* Parse --envelope points "ms:percent,..." into args; negative ms (also -0) count from the note's end */
+static UCRA_Result ucra_parse_envelope(const char* points, UCRA_CLIArgs* args) {
+    const char* p = points;
+    args->env_points = 0;
+    while (*p) {
+        char* end;
+        if (args->env_points == UCRA_CLI_ENV_POINTS) {
+            return UCRA_ERR_NOT_SUPPORTED;
+        }
+        uint32_t k = args->env_points;
+        p += strspn(p, " ");
+        args->env_from_end[k] = *p == '-';
+        args->env_ms[k] = strtod(p, &end);
+        if (end == p || *end != ':') {
+            return UCRA_ERR_NOT_SUPPORTED;
+        }
+        p = end + 1;
+        double percent = strtod(p, &end);
+        if (end == p || percent < 0.0 || (*end != ',' && *end != '\0')) {
+            return UCRA_ERR_NOT_SUPPORTED;
+        }
+        args->env_gain[k] = (float)(percent / 100.0);
+        args->env_points++;
+        p = *end ? end + 1 : end;
+    }
+    return args->env_points > 0 ? UCRA_SUCCESS : UCRA_ERR_NOT_SUPPORTED;
+}
+
+/* Parse command line arguments using cross-platform approach; -h prints usage to help */
+static UCRA_Result ucra_parse_cli_args(int argc, char* argv[], UCRA_CLIArgs* args, FILE* help) {
     if (!args) {
         return UCRA_ERR_INVALID_ARGUMENT;
     }
 
     /* Check for help first */
     if (ucra_has_flag(argc, argv, "-h", "--help")) {
-        ucra_print_usage(argv[0]);
+        ucra_print_usage(help, argv[0]);
         return UCRA_ERR_INVALID_ARGUMENT; /* Use as "help requested" signal */
     }
 
@@ -213,6 +313,49 @@ static UCRA_Result ucra_parse_cli_args(int argc, char* argv[], UCRA_CLIArgs* arg
         }
     }
 
+    if (ucra_find_arg(argc, argv, "-a", "--offset", &value) && value) {
+        args->offset_ms = atof(value);
+        if (args->offset_ms < 0.0) {
+            args->offset_ms = 0.0;
+        }
+    }
+
+    /* negative cutoffs are common, so the value may start with '-' */
+    int at = ucra_find_arg(argc, argv, "-e", "--cutoff", &value);
+    if (at && at + 1 < argc) {
+        args->cutoff_ms = atof(argv[at + 1]);
+    }
+
+    if (ucra_find_arg(argc, argv, "-w", "--wav-format", &value) && value) {
+        if (strcmp(value, "16") == 0) {
+            args->wav_format = UCRA_SAMPLE_PCM16;
+        } else if (strcmp(value, "24") == 0) {
+            args->wav_format = UCRA_SAMPLE_PCM24;
+        } else if (strcmp(value, "float") == 0) {
+            args->wav_format = UCRA_SAMPLE_FLOAT32;
+        } else {
+            fprintf(stderr, "Error: Unknown WAV format %s (float, 16 or 24)\n", value);
+            return UCRA_ERR_NOT_SUPPORTED;
+        }
+    }
+
+    if (ucra_find_arg(argc, argv, "-p", "--preutter", &value) && value) {
+        args->preutter_ms = atof(value);
+        if (args->preutter_ms < 0.0) args->preutter_ms = 0.0;
+    }
+
+    if (ucra_find_arg(argc, argv, "-l", "--overlap", &value) && value) {
+        args->overlap_ms = atof(value);
+        if (args->overlap_ms < 0.0) args->overlap_ms = 0.0;
+    }
+
+    /* points counted from the end start with '-' */
+    at = ucra_find_arg(argc, argv, "-E", "--envelope", &value);
+    if (at && (at + 1 >= argc || ucra_parse_envelope(argv[at + 1], args) != UCRA_SUCCESS)) {
+        fprintf(stderr, "Error: Envelope must be up to %d points ms:percent,...\n", UCRA_CLI_ENV_POINTS);
+        return UCRA_ERR_NOT_SUPPORTED;
+    }
+
     /* Validate required arguments */
     if (!args->input_wav) {
         fprintf(stderr, "Error: Input WAV file is required (--input)\n");
@@ -244,8 +387,8 @@ static UCRA_Result ucra_parse_cli_args(int argc, char* argv[], UCRA_CLIArgs* arg
     return UCRA_SUCCESS;
 }
 
-/* Load manifest from voicebank directory */
-static UCRA_Result ucra_load_manifest_from_vb(const char* vb_root, UCRA_Manifest** manifest) {
+/* Load manifest from voicebank directory; shared through the manifest registry */
+static UCRA_Result ucra_load_manifest_from_vb(const char* vb_root, const UCRA_Manifest** manifest) {
     if (!vb_root || !manifest) {
         return UCRA_ERR_INVALID_ARGUMENT;
     }
@@ -259,7 +402,7 @@ static UCRA_Result ucra_load_manifest_from_vb(const char* vb_root, UCRA_Manifest
 
     snprintf(manifest_path, path_len, "%s/resampler.json", vb_root);
 
-    UCRA_Result result = ucra_manifest_load(manifest_path, manifest);
+    UCRA_Result result = ucra_manifest_acquire(manifest_path, manifest);
     free(manifest_path);
 
     if (result != UCRA_SUCCESS) {
@@ -269,101 +412,124 @@ static UCRA_Result ucra_load_manifest_from_vb(const char* vb_root, UCRA_Manifest
     return result;
 }
 
-/* Load F0 curve from file */
-static UCRA_Result ucra_load_f0_curve(const char* f0_file, UCRA_F0Curve* curve) {
-    if (!f0_file || !curve) {
+/* Convert CLI args to UCRA_NoteSegment; f0_curve is the loaded --f0-curve and env the input's
+ * envelope, either may be NULL */
+static UCRA_Result ucra_cli_to_note_segment(const UCRA_CLIArgs* args, UCRA_NoteSegment* note,
+                                            const UCRA_F0Curve* f0_curve, const UCRA_EnvCurve* env) {
+    if (!args || !note) {
         return UCRA_ERR_INVALID_ARGUMENT;
     }
 
-    FILE* file = fopen(f0_file, "r");
-    if (!file) {
-        return UCRA_ERR_FILE_NOT_FOUND;
-    }
+    memset(note, 0, sizeof(UCRA_NoteSegment));
+
+    note->start_sec = args->start_sec;
+    note->duration_sec = args->duration_sec;
+    note->midi_note = args->midi_note;
+    note->velocity = args->velocity;
+    note->lyric = args->lyric;
+    note->f0_override = f0_curve;
+    note->env_override = env;
 
-    /* Count lines first */
-    uint32_t line_count = 0;
-    char buffer[256];
-    while (fgets(buffer, sizeof(buffer), file)) {
-        line_count++;
+    return UCRA_SUCCESS;
+}
+
+/* Hop of the input envelope, and the most points it may have (longer regions use longer hops) */
+#define UCRA_INPUT_ENV_HOP_MS 5.0
+#define UCRA_INPUT_ENV_MAX_POINTS 4096
+
+/* Amplitude envelope of the input's region between --offset and --cutoff: the RMS of each hop,
+ * peak-normalized and stretched over the note. The region comes from the process-wide sample
+ * store, so notes sharing a recording and its oto region decode it once, and long recordings cost
+ * no more than the part a note uses. */
+static UCRA_Result ucra_cli_load_input_env(const UCRA_CLIArgs* args, UCRA_EnvCurve* env) {
+    memset(env, 0, sizeof(UCRA_EnvCurve));
+    uint32_t wav_frames = 0, sample_rate = 0;
+    UCRA_Result result = ucra_sample_info(args->input_wav, &wav_frames, &sample_rate);
+    if (result != UCRA_SUCCESS) {
+        return result;
     }
 
-    if (line_count == 0) {
-        fclose(file);
+    double ms_frames = sample_rate / 1000.0;
+    double first = args->offset_ms * ms_frames;
+    double end = args->cutoff_ms < 0.0 ? first - args->cutoff_ms * ms_frames
+                                       : wav_frames - args->cutoff_ms * ms_frames;
+    if (end > wav_frames) end = wav_frames;
+    if (first >= end) {
         return UCRA_ERR_INVALID_ARGUMENT;
     }
-
-    /* Allocate arrays */
-    float* time_sec = malloc(line_count * sizeof(float));
-    float* f0_hz = malloc(line_count * sizeof(float));
-    if (!time_sec || !f0_hz) {
+    uint32_t start = (uint32_t)first;
+    UCRA_SampleView region;
+    result = ucra_sample_get(args->input_wav, start, (uint32_t)end - start, &region);
+    if (result != UCRA_SUCCESS) {
+        return result;
+    }
+    uint32_t frames = region.frames;
+    if (frames == 0) {
+        return UCRA_ERR_INVALID_ARGUMENT; /* the file shrank since it was measured */
+    }
+    uint32_t hop = (uint32_t)(UCRA_INPUT_ENV_HOP_MS * ms_frames);
+    if (hop == 0) hop = 1;
+    if (frames / hop >= UCRA_INPUT_ENV_MAX_POINTS) hop = frames / (UCRA_INPUT_ENV_MAX_POINTS - 1) + 1;
+    uint32_t points = (frames + hop - 1) / hop;
+
+    float* time_sec = malloc(points * sizeof(float));
+    float* value = malloc(points * sizeof(float));
+    if (!time_sec || !value) {
         free(time_sec);
-        free(f0_hz);
-        fclose(file);
+        free(value);
+        ucra_sample_release(&region);
         return UCRA_ERR_OUT_OF_MEMORY;
     }
-
-    /* Read data */
-    rewind(file);
-    uint32_t valid_count = 0;
-    while (fgets(buffer, sizeof(buffer), file) && valid_count < line_count) {
-        float time, f0;
-        if (sscanf(buffer, "%f %f", &time, &f0) == 2) {
-            time_sec[valid_count] = time;
-            f0_hz[valid_count] = f0;
-            valid_count++;
-        }
+    float peak = 0.0f;
+    for (uint32_t k = 0; k < points; k++) {
+        uint32_t offset = k * hop;
+        uint32_t count = frames - offset < hop ? frames - offset : hop;
+        const float* block = region.samples + offset;
+        double energy = 0.0;
+        for (uint32_t n = 0; n < count; n++) energy += (double)block[n] * block[n];
+        value[k] = (float)sqrt(energy / count);
+        time_sec[k] = (float)((offset + 0.5 * count) / frames * args->duration_sec);
+        if (value[k] > peak) peak = value[k];
     }
+    ucra_sample_release(&region);
 
-    fclose(file);
-
-    if (valid_count == 0) {
+    if (peak <= 0.0f) {
         free(time_sec);
-        free(f0_hz);
-        return UCRA_ERR_INVALID_ARGUMENT;
+        free(value);
+        return UCRA_ERR_NOT_SUPPORTED; /* a silent region gives no shape */
     }
-
-    curve->time_sec = time_sec;
-    curve->f0_hz = f0_hz;
-    curve->length = valid_count;
-
+    for (uint32_t k = 0; k < points; k++) value[k] /= peak;
+    env->time_sec = time_sec;
+    env->value = value;
+    env->length = points;
     return UCRA_SUCCESS;
 }
 
-/* Convert CLI args to UCRA_NoteSegment */
-static UCRA_Result ucra_cli_to_note_segment(const UCRA_CLIArgs* args, UCRA_NoteSegment* note, UCRA_F0Curve* f0_curve) {
-    if (!args || !note) {
-        return UCRA_ERR_INVALID_ARGUMENT;
+/* Load the --f0-curve of args (text or binary) into curve, owned by *file; NULL (with a warning)
+ * if there is none or it cannot be read. Release it with ucra_f0_curve_close(*file). */
+static const UCRA_F0Curve* ucra_cli_load_f0(const UCRA_CLIArgs* args, UCRA_F0FileHandle* file,
+                                            UCRA_F0Curve* curve) {
+    *file = NULL;
+    if (!args->f0_curve_file) {
+        return NULL;
     }
-
-    memset(note, 0, sizeof(UCRA_NoteSegment));
-
-    note->start_sec = args->start_sec;
-    note->duration_sec = args->duration_sec;
-    note->midi_note = args->midi_note;
-    note->velocity = args->velocity;
-    note->lyric = args->lyric;
-
-    /* Load F0 curve if provided */
-    if (args->f0_curve_file && f0_curve) {
-        UCRA_Result result = ucra_load_f0_curve(args->f0_curve_file, f0_curve);
-        if (result == UCRA_SUCCESS) {
-            note->f0_override = f0_curve;
-        } else {
-            fprintf(stderr, "Warning: Failed to load F0 curve from %s\n", args->f0_curve_file);
-        }
+    if (ucra_f0_curve_open(file, args->f0_curve_file, curve) != UCRA_SUCCESS) {
+        fprintf(stderr, "Warning: Failed to load F0 curve from %s\n", args->f0_curve_file);
+        return NULL;
     }
-
-    return UCRA_SUCCESS;
+    return curve;
 }
 
-/* Convert CLI args to UCRA_RenderConfig */
-static UCRA_Result ucra_cli_to_render_config(const UCRA_CLIArgs* args, const UCRA_NoteSegment* note,
-                                             UCRA_RenderConfig* config, UCRA_KeyValue* options) {
-    if (!args || !note || !config) {
+/* Convert CLI args to UCRA_RenderConfig; map_result holds mapped flags the config points to */
+static UCRA_Result ucra_cli_to_render_config(const UCRA_CLIArgs* args, const UCRA_FlagMapper* mapper,
+                                             const UCRA_NoteSegment* note, UCRA_RenderConfig* config,
+                                             UCRA_KeyValue* options, UCRA_FlagMapResult* map_result) {
+    if (!args || !note || !config || !map_result) {
         return UCRA_ERR_INVALID_ARGUMENT;
     }
 
     memset(config, 0, sizeof(UCRA_RenderConfig));
+    memset(map_result, 0, sizeof(UCRA_FlagMapResult));
 
     config->sample_rate = args->sample_rate;
     config->channels = 1; /* Mono output for compatibility */
@@ -373,204 +539,861 @@ static UCRA_Result ucra_cli_to_render_config(const UCRA_CLIArgs* args, const UCR
     config->notes = note;
     config->note_count = 1;
 
-    /* Apply flag mapping if provided */
-    if (args->flags_str && options) {
-        /* Parse legacy flags */
-        UCRA_KeyValue* legacy_flags = NULL;
-        uint32_t legacy_count = 0;
-        UCRA_Result result = ucra_parse_legacy_flags(args->flags_str, &legacy_flags, &legacy_count);
-
-        if (result == UCRA_SUCCESS && legacy_count > 0) {
-            /* Try to load default moresampler mapping */
-            UCRA_FlagMapper* mapper = NULL;
-            const char* mapping_path = "tools/flag_mapper/mappings/moresampler_map.json";
-
-            if (ucra_flag_mapper_load(mapping_path, &mapper) == UCRA_SUCCESS) {
-                UCRA_FlagMapResult map_result;
-                if (ucra_flag_mapper_apply(mapper, legacy_flags, legacy_count, &map_result) == UCRA_SUCCESS) {
-                    /* Use mapped flags */
-                    config->options = map_result.flags;
-                    config->option_count = map_result.flag_count;
-
-                    /* Print warnings if any */
-                    for (uint32_t i = 0; i < map_result.warning_count; i++) {
-                        fprintf(stderr, "Flag mapping warning: %s\n", map_result.warnings[i]);
-                    }
-
-                    /* Note: Caller is responsible for cleanup of map_result */
-                } else {
-                    printf("Warning: Flag mapping failed, using raw flags\n");
-                    /* Fallback to simple key=value parsing */
-                    config->options = options;
-                    config->option_count = 1;
-                    options[0].key = "flags";
-                    options[0].value = args->flags_str;
-                }
-                ucra_flag_mapper_free(mapper);
-            } else {
-                printf("Warning: Could not load flag mapping, using raw flags\n");
-                /* Fallback to simple key=value parsing */
-                config->options = options;
-                config->option_count = 1;
-                options[0].key = "flags";
-                options[0].value = args->flags_str;
-            }
+    if (!args->flags_str || !options) {
+        return UCRA_SUCCESS;
+    }
 
-            ucra_free_legacy_flags(legacy_flags, legacy_count);
-        } else {
-            /* Fallback to simple key=value parsing */
-            config->options = options;
-            config->option_count = 1;
-            options[0].key = "flags";
-            options[0].value = args->flags_str;
+    /* Raw flags unless the mapper can translate them */
+    config->options = options;
+    config->option_count = 1;
+    options[0].key = "flags";
+    options[0].value = args->flags_str;
+
+    UCRA_KeyValue* legacy_flags = NULL;
+    uint32_t legacy_count = 0;
+    UCRA_Result result = ucra_parse_legacy_flags(args->flags_str, &legacy_flags, &legacy_count);
+    if (result != UCRA_SUCCESS || legacy_count == 0) {
+        return UCRA_SUCCESS;
+    }
+
+    if (!mapper) {
+        fprintf(stderr, "Warning: Could not load flag mapping, using raw flags\n");
+    } else if (ucra_flag_mapper_apply(mapper, legacy_flags, legacy_count, map_result) == UCRA_SUCCESS) {
+        config->options = map_result->flags;
+        config->option_count = map_result->flag_count;
+        for (uint32_t i = 0; i < map_result->warning_count; i++) {
+            fprintf(stderr, "Flag mapping warning: %s\n", map_result->warnings[i]);
         }
+    } else {
+        fprintf(stderr, "Warning: Flag mapping failed, using raw flags\n");
     }
 
+    ucra_free_legacy_flags(legacy_flags, legacy_count);
     return UCRA_SUCCESS;
 }
 
-/* Write PCM data to WAV file (simplified implementation) */
+/* Write interleaved PCM to a WAV file through the streaming writer */
 static UCRA_Result ucra_write_wav_file(const char* filename, const float* pcm, uint64_t frames,
-                                       uint32_t channels, uint32_t sample_rate) {
-    if (!filename || !pcm || frames == 0) {
-        return UCRA_ERR_INVALID_ARGUMENT;
+                                       uint32_t channels, uint32_t sample_rate, UCRA_SampleFormat format) {
+    UCRA_WavWriterHandle writer = NULL;
+    UCRA_Result result = ucra_wav_writer_open(&writer, filename, sample_rate, channels, format, 0);
+    if (result != UCRA_SUCCESS) {
+        return result;
     }
+    result = ucra_wav_writer_write(writer, pcm, frames);
+    UCRA_Result closed = ucra_wav_writer_close(writer);
+    return result != UCRA_SUCCESS ? result : closed;
+}
 
-    FILE* file = fopen(filename, "wb");
-    if (!file) {
-        return UCRA_ERR_FILE_NOT_FOUND;
+/* A voicebank manifest the session holds a reference to */
+typedef struct UCRA_CLIVoicebank {
+    char* vb_root;
+    const UCRA_Manifest* manifest;
+} UCRA_CLIVoicebank;
+
+/* What one rendering thread renders with */
+typedef struct UCRA_CLIWorker {
+    UCRA_Handle engine;
+    UCRA_RenderCacheHandle cache;  /* NULL without --cache */
+} UCRA_CLIWorker;
+
+/* What stays loaded from one note to the next */
+typedef struct UCRA_CLISession {
+    UCRA_CLIWorker worker;
+    const char* cache_dir;         /* NULL without --cache */
+    uint64_t cache_bytes;
+    const char* mapping_path;
+    UCRA_FlagMapper* mapper;       /* NULL if the mapping could not be loaded */
+    int mapper_loaded;             /* loading the mapping was attempted */
+    UCRA_CLIVoicebank* voicebanks;
+    uint32_t voicebank_count;
+    uint32_t voicebank_capacity;
+    int quiet;                     /* no progress output, as stdout carries server replies */
+} UCRA_CLISession;
+
+/* Create a worker's engine, and its cache handle if the session caches; a cache that cannot be
+ * opened only disables caching */
+static UCRA_Result ucra_cli_worker_init(UCRA_CLIWorker* worker, const UCRA_CLISession* session) {
+    memset(worker, 0, sizeof(UCRA_CLIWorker));
+    if (session->cache_dir) {
+        UCRA_Result result = ucra_render_cache_open(&worker->cache, session->cache_dir, session->cache_bytes);
+        if (result != UCRA_SUCCESS) {
+            fprintf(stderr, "Warning: Cannot open render cache %s (error %d), rendering without it\n",
+                    session->cache_dir, result);
+            worker->cache = NULL;
+        }
     }
+    return ucra_engine_create(&worker->engine, NULL, 0);
+}
 
-    /* Write basic WAV header (simplified) */
-    uint32_t data_size = (uint32_t)(frames * channels * sizeof(float));
-    uint32_t file_size = data_size + 36;
-
-    /* RIFF header */
-    fwrite("RIFF", 1, 4, file);
-    fwrite(&file_size, 4, 1, file);
-    fwrite("WAVE", 1, 4, file);
+static void ucra_cli_worker_free(UCRA_CLIWorker* worker) {
+    ucra_render_cache_close(worker->cache);
+    ucra_engine_destroy(worker->engine);
+    memset(worker, 0, sizeof(UCRA_CLIWorker));
+}
 
-    /* fmt chunk */
-    fwrite("fmt ", 1, 4, file);
-    uint32_t fmt_size = 16;
-    uint16_t audio_format = 3; /* IEEE float */
-    uint16_t num_channels = (uint16_t)channels;
-    uint32_t byte_rate = sample_rate * channels * sizeof(float);
-    uint16_t block_align = (uint16_t)(channels * sizeof(float));
-    uint16_t bits_per_sample = 32;
+static UCRA_Result ucra_cli_session_init(UCRA_CLISession* session, const char* mapping_path,
+                                         const char* cache_dir, uint64_t cache_bytes, int quiet) {
+    memset(session, 0, sizeof(UCRA_CLISession));
+    session->mapping_path = mapping_path ? mapping_path : UCRA_DEFAULT_MAPPING;
+    session->cache_dir = cache_dir;
+    session->cache_bytes = cache_bytes;
+    session->quiet = quiet;
+    return ucra_cli_worker_init(&session->worker, session);
+}
 
-    fwrite(&fmt_size, 4, 1, file);
-    fwrite(&audio_format, 2, 1, file);
-    fwrite(&num_channels, 2, 1, file);
-    fwrite(&sample_rate, 4, 1, file);
-    fwrite(&byte_rate, 4, 1, file);
-    fwrite(&block_align, 2, 1, file);
-    fwrite(&bits_per_sample, 2, 1, file);
+static void ucra_cli_session_free(UCRA_CLISession* session) {
+    for (uint32_t i = 0; i < session->voicebank_count; i++) {
+        ucra_manifest_release(session->voicebanks[i].manifest);
+        free(session->voicebanks[i].vb_root);
+    }
+    free(session->voicebanks);
+    ucra_flag_mapper_free(session->mapper);
+    ucra_cli_worker_free(&session->worker);
+    memset(session, 0, sizeof(UCRA_CLISession));
+}
 
-    /* data chunk */
-    fwrite("data", 1, 4, file);
-    fwrite(&data_size, 4, 1, file);
-    fwrite(pcm, sizeof(float), frames * channels, file);
+/* Manifest of vb_root, loaded on first use; edited manifests are picked up through the registry */
+static UCRA_Result ucra_cli_session_manifest(UCRA_CLISession* session, const char* vb_root,
+                                             const UCRA_Manifest** manifest) {
+    for (uint32_t i = 0; i < session->voicebank_count; i++) {
+        UCRA_CLIVoicebank* vb = &session->voicebanks[i];
+        if (strcmp(vb->vb_root, vb_root) != 0) continue;
+        /* reacquire so a changed file replaces the cached manifest */
+        const UCRA_Manifest* current = NULL;
+        UCRA_Result result = ucra_load_manifest_from_vb(vb_root, &current);
+        if (result != UCRA_SUCCESS) {
+            return result;
+        }
+        ucra_manifest_release(vb->manifest);
+        vb->manifest = current;
+        *manifest = current;
+        return UCRA_SUCCESS;
+    }
 
-    fclose(file);
+    if (session->voicebank_count == session->voicebank_capacity) {
+        uint32_t capacity = session->voicebank_capacity ? session->voicebank_capacity * 2 : 4;
+        UCRA_CLIVoicebank* voicebanks = realloc(session->voicebanks, capacity * sizeof(UCRA_CLIVoicebank));
+        if (!voicebanks) {
+            return UCRA_ERR_OUT_OF_MEMORY;
+        }
+        session->voicebanks = voicebanks;
+        session->voicebank_capacity = capacity;
+    }
+    char* root = strdup(vb_root);
+    if (!root) {
+        return UCRA_ERR_OUT_OF_MEMORY;
+    }
+    UCRA_Result result = ucra_load_manifest_from_vb(vb_root, manifest);
+    if (result != UCRA_SUCCESS) {
+        free(root);
+        return result;
+    }
+    session->voicebanks[session->voicebank_count].vb_root = root;
+    session->voicebanks[session->voicebank_count].manifest = *manifest;
+    session->voicebank_count++;
     return UCRA_SUCCESS;
 }
 
-/* Main CLI bridge function */
-int main(int argc, char* argv[]) {
+static const UCRA_FlagMapper* ucra_cli_session_mapper(UCRA_CLISession* session) {
+    if (!session->mapper_loaded) {
+        session->mapper_loaded = 1;
+        if (ucra_flag_mapper_load(session->mapping_path, &session->mapper) != UCRA_SUCCESS) {
+            session->mapper = NULL;
+        }
+    }
+    return session->mapper;
+}
+
+/* PCM of a note that is handed on instead of written to its own WAV */
+typedef struct UCRA_CLIOutput {
+    float* pcm;
+    uint64_t frames;
+    uint32_t channels;
+    uint32_t sample_rate;
+} UCRA_CLIOutput;
+
+/* Render config on the worker, through its cache if it has one, and write the output WAV, or copy
+ * the PCM to keep if it is not NULL */
+static int ucra_cli_output(UCRA_CLIWorker* worker, const UCRA_Manifest* manifest, const UCRA_RenderConfig* config,
+                           const UCRA_CLIArgs* args, int quiet, UCRA_CLIOutput* keep) {
+    int exit_code = UCRA_EXIT_OK;
+    int hit = 0;
+    UCRA_RenderResult rendered;
+    memset(&rendered, 0, sizeof(rendered));
+    UCRA_Result result = worker->cache
+                             ? ucra_render_cached(worker->cache, worker->engine, manifest, config, &rendered, &hit)
+                             : ucra_render(worker->engine, config, &rendered);
+    if (result != UCRA_SUCCESS) {
+        fprintf(stderr, "Error: Rendering failed (error %d)\n", result);
+        exit_code = UCRA_EXIT_RENDER;
+    } else if (keep) {
+        /* the engine and the cache reuse their buffers on the next render */
+        size_t samples = (size_t)rendered.frames * rendered.channels;
+        keep->pcm = malloc((samples ? samples : 1) * sizeof(float));
+        if (!keep->pcm) {
+            exit_code = UCRA_EXIT_RENDER;
+        } else {
+            memcpy(keep->pcm, rendered.pcm, samples * sizeof(float));
+            keep->frames = rendered.frames;
+            keep->channels = rendered.channels;
+            keep->sample_rate = rendered.sample_rate;
+        }
+    } else {
+        result = ucra_write_wav_file(args->output_wav, rendered.pcm, rendered.frames,
+                                     rendered.channels, rendered.sample_rate, args->wav_format);
+        if (result != UCRA_SUCCESS) {
+            fprintf(stderr, "Error: Failed to write WAV file (error %d)\n", result);
+            exit_code = UCRA_EXIT_WRITE;
+        } else if (!quiet) {
+            printf("✓ %s %llu frames to %s\n", hit ? "Reused" : "Rendered",
+                   (unsigned long long)rendered.frames, args->output_wav);
+        }
+    }
+
+    return exit_code;
+}
+
+/* Render parsed args for manifest's voicebank on worker; writes the output WAV, or copies the PCM to
+ * keep if it is not NULL. Thread-safe for distinct workers. Returns the exit code. */
+static int ucra_cli_render(UCRA_CLIWorker* worker, const UCRA_Manifest* manifest, const UCRA_CLIArgs* args,
+                           const UCRA_FlagMapper* mapper, const UCRA_F0Curve* f0_curve, int quiet,
+                           UCRA_CLIOutput* keep) {
+    UCRA_NoteSegment note;
+    UCRA_RenderConfig config;
+    UCRA_FlagMapResult map_result;
+    UCRA_KeyValue options[8] = {0}; /* Space for engine options */
+    UCRA_EnvCurve env;
+    memset(&map_result, 0, sizeof(map_result));
+
+    UCRA_Result result = ucra_cli_load_input_env(args, &env);
+    if (result != UCRA_SUCCESS) {
+        fprintf(stderr, "Warning: Input %s gives no envelope (error %d), rendering without it\n",
+                args->input_wav, result);
+    }
+    int exit_code = UCRA_EXIT_OK;
+    result = ucra_cli_to_note_segment(args, &note, f0_curve, env.length ? &env : NULL);
+    if (result != UCRA_SUCCESS) {
+        fprintf(stderr, "Error: Failed to convert note data (error %d)\n", result);
+        exit_code = UCRA_EXIT_NOTE;
+    } else if ((result = ucra_cli_to_render_config(args, mapper, &note, &config, options,
+                                                   &map_result)) != UCRA_SUCCESS) {
+        fprintf(stderr, "Error: Failed to create render config (error %d)\n", result);
+        exit_code = UCRA_EXIT_CONFIG;
+    }
+
+    if (exit_code == UCRA_EXIT_OK) {
+        exit_code = ucra_cli_output(worker, manifest, &config, args, quiet, keep);
+    }
+
+    ucra_flag_map_result_free(&map_result);
+    free((void*)env.time_sec);
+    free((void*)env.value);
+    return exit_code;
+}
+
+/* Render one legacy invocation with the session's worker; returns its exit code */
+static int ucra_cli_run(UCRA_CLISession* session, int argc, char* argv[]) {
     UCRA_CLIArgs args;
-    UCRA_Manifest* manifest = NULL;
-    UCRA_Handle engine = NULL;
+    const UCRA_Manifest* manifest = NULL;
+    UCRA_F0FileHandle f0_file = NULL;
     UCRA_F0Curve f0_curve = {0};
-    UCRA_KeyValue options[8] = {0}; /* Space for engine options */
 
     ucra_cli_args_init(&args);
 
-    /* Parse command line arguments */
-    UCRA_Result result = ucra_parse_cli_args(argc, argv, &args);
+    /* Parse command line arguments; a server's stdout carries its replies, so help goes to stderr */
+    UCRA_Result result = ucra_parse_cli_args(argc, argv, &args, session->quiet ? stderr : stdout);
     if (result != UCRA_SUCCESS) {
         ucra_cli_args_free(&args);
-        return (result == UCRA_ERR_INVALID_ARGUMENT) ? 1 : 2; /* 1 for help, 2 for error */
+        return (result == UCRA_ERR_INVALID_ARGUMENT) ? UCRA_EXIT_USAGE : UCRA_EXIT_ARGS;
     }
 
-    printf("UCRA Legacy CLI Bridge\n");
-    printf("Input: %s\n", args.input_wav);
-    printf("Output: %s\n", args.output_wav);
-    printf("Note: %s (MIDI %d, Vel %d)\n", args.lyric, args.midi_note, args.velocity);
-    printf("Voicebank: %s\n", args.vb_root);
+    if (!session->quiet) {
+        printf("UCRA Legacy CLI Bridge\n");
+        printf("Input: %s\n", args.input_wav);
+        printf("Output: %s\n", args.output_wav);
+        printf("Note: %s (MIDI %d, Vel %d)\n", args.lyric, args.midi_note, args.velocity);
+        printf("Voicebank: %s\n", args.vb_root);
+    }
 
     /* Load manifest from voicebank */
-    result = ucra_load_manifest_from_vb(args.vb_root, &manifest);
+    result = ucra_cli_session_manifest(session, args.vb_root, &manifest);
     if (result != UCRA_SUCCESS) {
         fprintf(stderr, "Error: Failed to load manifest (error %d)\n", result);
         ucra_cli_args_free(&args);
-        return 3;
+        return UCRA_EXIT_MANIFEST;
+    }
+
+    if (!session->quiet) {
+        printf("Loaded engine: %s v%s by %s\n",
+               manifest->name ? manifest->name : "Unknown",
+               manifest->version ? manifest->version : "Unknown",
+               manifest->vendor ? manifest->vendor : "Unknown");
     }
 
-    printf("Loaded engine: %s v%s by %s\n",
-           manifest->name ? manifest->name : "Unknown",
-           manifest->version ? manifest->version : "Unknown",
-           manifest->vendor ? manifest->vendor : "Unknown");
+    /* The manifest stays with the session */
+    const UCRA_FlagMapper* mapper = args.flags_str ? ucra_cli_session_mapper(session) : NULL;
+    int exit_code = ucra_cli_render(&session->worker, manifest, &args, mapper,
+                                    ucra_cli_load_f0(&args, &f0_file, &f0_curve), session->quiet, NULL);
+    ucra_f0_curve_close(f0_file);
+    ucra_cli_args_free(&args);
+    return exit_code;
+}
 
-    /* Create engine (placeholder - would need actual engine implementation) */
-    printf("Note: Engine creation and rendering not yet implemented\n");
-    printf("      This is a placeholder CLI bridge demonstration\n");
+/* Split line in place into argv[1..]: whitespace separates, "..." groups and \ escapes inside quotes */
+static int ucra_cli_split(char* line, char* argv[], int max_args) {
+    int argc = 1;
+    char* in = line;
+    while (*in) {
+        while (*in == ' ' || *in == '\t' || *in == '\r' || *in == '\n') in++;
+        if (!*in) break;
+        if (argc == max_args) return -1;
+        char* out = in;
+        argv[argc++] = out;
+        if (*in == '"') {
+            in++;
+            while (*in && *in != '"') {
+                if (*in == '\\' && in[1]) in++;
+                *out++ = *in++;
+            }
+            if (*in == '"') in++;
+        } else {
+            while (*in && *in != ' ' && *in != '\t' && *in != '\r' && *in != '\n') *out++ = *in++;
+            if (*in) in++; /* out may point at this separator */
+        }
+        *out = '\0';
+    }
+    return argc;
+}
 
-    /* Convert CLI arguments to UCRA structures */
-    UCRA_NoteSegment note;
-    result = ucra_cli_to_note_segment(&args, &note, &f0_curve);
+/* Append arg to line as one quoted argument of ucra_cli_split(); 0 if line is full */
+static int ucra_cli_append_quoted(char* line, size_t size, size_t* length, const char* arg) {
+    size_t n = *length;
+    if (n + 3 >= size) return 0;
+    if (n > 0) line[n++] = ' ';
+    line[n++] = '"';
+    for (const char* c = arg; *c; c++) {
+        if (n + 3 >= size) return 0;
+        if (*c == '"' || *c == '\\') line[n++] = '\\';
+        line[n++] = *c;
+    }
+    line[n++] = '"';
+    line[n] = '\0';
+    *length = n;
+    return 1;
+}
+
+/* Serve requests from in until EOF or "quit": one invocation's options per line, with an optional
+ * leading "--cwd DIR" that relative paths are resolved against. Every request gets a reply line
+ * "OK" or "ERR <exit code>". Returns 1 if a request asked the server to stop. */
+static int ucra_cli_serve(UCRA_CLISession* session, FILE* in, FILE* out) {
+    char line[UCRA_CLI_LINE_MAX];
+    char* argv[UCRA_CLI_MAX_ARGS];
+    argv[0] = "resampler";
+    while (fgets(line, sizeof(line), in)) {
+        int argc = ucra_cli_split(line, argv, UCRA_CLI_MAX_ARGS);
+        if (argc == 1) continue;
+        if (argc == 2 && strcmp(argv[1], "quit") == 0) {
+            fprintf(out, "OK\n");
+            fflush(out);
+            return 1;
+        }
+
+        int exit_code = argc < 0 ? UCRA_EXIT_ARGS : UCRA_EXIT_OK;
+        int first = 1;
+        if (argc >= 3 && strcmp(argv[1], "--cwd") == 0) {
+            if (ucra_chdir(argv[2]) != 0) {
+                fprintf(stderr, "Error: Cannot change to %s\n", argv[2]);
+                exit_code = UCRA_EXIT_ARGS;
+            }
+            first = 3;
+        }
+        if (exit_code == UCRA_EXIT_OK) {
+            argv[first - 1] = argv[0];
+            exit_code = ucra_cli_run(session, argc - first + 1, argv + first - 1);
+        }
+        if (exit_code == UCRA_EXIT_OK) {
+            fprintf(out, "OK\n");
+        } else {
+            fprintf(out, "ERR %d\n", exit_code);
+        }
+        fflush(out);
+    }
+    return 0;
+}
+
+/* One request of a batch */
+typedef struct UCRA_BatchNote {
+    char* line;                 /* the request, split into argv in place */
+    UCRA_CLIArgs args;
+    const UCRA_Manifest* manifest; /* held by the session */
+    const UCRA_F0Curve* f0;     /* shared with every note naming the same file */
+    UCRA_CLIOutput output;      /* with --concat */
+    int exit_code;              /* -1 while the note still has to be rendered */
+} UCRA_BatchNote;
+
+/* An F0 curve file loaded once for the whole batch */
+typedef struct UCRA_BatchCurve {
+    const char* path;
+    UCRA_F0FileHandle file;     /* NULL if it could not be loaded */
+    UCRA_F0Curve curve;
+} UCRA_BatchCurve;
+
+typedef struct UCRA_BatchJob {
+    UCRA_BatchNote* notes;
+    const uint32_t* pending;    /* notes to render */
+    uint32_t pending_count;
+    UCRA_CLIWorker* workers;    /* one per pool worker */
+    const UCRA_FlagMapper* mapper;
+    int keep;                   /* hand the PCM on instead of writing WAVs */
+} UCRA_BatchJob;
+
+static void ucra_batch_render_job(void* ctx, uint32_t job, uint32_t worker) {
+    UCRA_BatchJob* batch = (UCRA_BatchJob*)ctx;
+    UCRA_BatchNote* note = &batch->notes[batch->pending[job]];
+    /* each worker takes a contiguous run of jobs, so its next note is usually the next job: have its
+     * recording read in while this one renders */
+    if (job + 1 < batch->pending_count) {
+        ucra_sample_prefetch(batch->notes[batch->pending[job + 1]].args.input_wav);
+    }
+    note->exit_code = ucra_cli_render(&batch->workers[worker], note->manifest, &note->args,
+                                      note->args.flags_str ? batch->mapper : NULL, note->f0, 1,
+                                      batch->keep ? &note->output : NULL);
+}
+
+/* Read requests (the lines ucra_cli_serve() takes) from in; NULL on allocation failure */
+static UCRA_BatchNote* ucra_batch_read(FILE* in, uint32_t* out_count) {
+    char line[UCRA_CLI_LINE_MAX];
+    UCRA_BatchNote* notes = NULL;
+    uint32_t count = 0, capacity = 0;
+    *out_count = 0;
+    while (fgets(line, sizeof(line), in)) {
+        size_t length = strspn(line, " \t\r\n");
+        if (line[length] == '\0') continue;
+        if (count == capacity) {
+            capacity = capacity ? capacity * 2 : 64;
+            UCRA_BatchNote* grown = realloc(notes, capacity * sizeof(UCRA_BatchNote));
+            if (!grown) break;
+            notes = grown;
+        }
+        memset(&notes[count], 0, sizeof(UCRA_BatchNote));
+        notes[count].line = strdup(line);
+        if (!notes[count].line) break;
+        count++;
+    }
+    if (!feof(in)) {
+        for (uint32_t i = 0; i < count; i++) free(notes[i].line);
+        free(notes);
+        return NULL;
+    }
+    *out_count = count;
+    return notes ? notes : calloc(1, sizeof(UCRA_BatchNote));
+}
+
+static UCRA_Result UCRA_CALL ucra_batch_sink(void* user_data, const float* pcm, uint32_t frames) {
+    return ucra_wav_writer_write((UCRA_WavWriterHandle)user_data, pcm, frames);
+}
+
+/* The --envelope of args as a curve over a note of duration seconds, points in time order */
+static void ucra_batch_envelope(const UCRA_CLIArgs* args, double duration, float* time_sec, float* gain,
+                                UCRA_EnvCurve* env) {
+    for (uint32_t k = 0; k < args->env_points; k++) {
+        double t = args->env_ms[k] / 1000.0 + (args->env_from_end[k] ? duration : 0.0);
+        uint32_t j = k;
+        for (; j > 0 && time_sec[j - 1] > (float)t; j--) {
+            time_sec[j] = time_sec[j - 1];
+            gain[j] = gain[j - 1];
+        }
+        time_sec[j] = (float)t;
+        gain[j] = args->env_gain[k];
+    }
+    env->time_sec = time_sec;
+    env->value = gain;
+    env->length = args->env_points;
+}
+
+/* Convert output's PCM to sample_rate in place */
+static UCRA_Result ucra_batch_convert_rate(UCRA_CLIOutput* output, uint32_t sample_rate) {
+    UCRA_ResamplerHandle resampler = NULL;
+    UCRA_Result result = ucra_resampler_create(&resampler, output->sample_rate, sample_rate, output->channels);
     if (result != UCRA_SUCCESS) {
-        fprintf(stderr, "Error: Failed to convert note data (error %d)\n", result);
-        ucra_manifest_free(manifest);
-        ucra_cli_args_free(&args);
-        return 4;
+        return result;
+    }
+    uint64_t frames = ucra_resampler_output_frames(resampler, output->frames);
+    float* pcm = output->frames <= UINT32_MAX && frames < UINT32_MAX
+                     ? malloc((size_t)(frames + 1) * output->channels * sizeof(float)) : NULL;
+    uint32_t written = 0, drained = 0;
+    if (!pcm) {
+        result = UCRA_ERR_OUT_OF_MEMORY;
+    } else {
+        result = ucra_resampler_process(resampler, output->pcm, (uint32_t)output->frames, NULL,
+                                        pcm, (uint32_t)frames + 1, &written);
+    }
+    if (result == UCRA_SUCCESS) {
+        result = ucra_resampler_drain(resampler, pcm + (size_t)written * output->channels,
+                                      (uint32_t)frames + 1 - written, &drained);
+    }
+    ucra_resampler_destroy(resampler);
+    if (result != UCRA_SUCCESS) {
+        free(pcm);
+        return result;
     }
+    free(output->pcm);
+    output->pcm = pcm;
+    output->frames = (uint64_t)written + drained;
+    output->sample_rate = sample_rate;
+    return UCRA_SUCCESS;
+}
 
-    UCRA_RenderConfig config;
-    result = ucra_cli_to_render_config(&args, &note, &config, options);
+/* Join the kept notes into path on a timeline, in the first note's WAV format: each one starts its
+ * --preutter before the end of the one before, crossfades over its --overlap and is shaped by its
+ * --envelope; without them the notes are back to back. Notes at another sample rate than the first
+ * are converted to it; notes with other channels fail. The file may grow past 4 GB (RF64). */
+static int ucra_batch_concat(UCRA_BatchNote* notes, uint32_t count, const char* path) {
+    uint64_t frames = 0;
+    const UCRA_BatchNote* first = NULL;
+    for (uint32_t i = 0; i < count; i++) {
+        UCRA_CLIOutput* output = &notes[i].output;
+        if (notes[i].exit_code != UCRA_EXIT_OK) continue;
+        if (!first) {
+            first = &notes[i];
+        } else if (output->channels != first->output.channels) {
+            fprintf(stderr, "Error: Note %u does not match the channels of the first\n", i + 1);
+            notes[i].exit_code = UCRA_EXIT_CONFIG;
+            continue;
+        } else if (output->sample_rate != first->output.sample_rate) {
+            UCRA_Result converted = ucra_batch_convert_rate(output, first->output.sample_rate);
+            if (converted != UCRA_SUCCESS) {
+                fprintf(stderr, "Error: Note %u cannot be converted to %u Hz (error %d)\n", i + 1,
+                        first->output.sample_rate, converted);
+                notes[i].exit_code = UCRA_EXIT_CONFIG;
+                continue;
+            }
+        }
+        frames += output->frames;
+    }
+    if (!first || frames == 0) {
+        fprintf(stderr, "Error: No rendered notes to write to %s\n", path);
+        return UCRA_EXIT_WRITE;
+    }
+
+    double rate = (double)first->output.sample_rate;
+    UCRA_WavWriterHandle writer = NULL;
+    UCRA_TimelineHandle timeline = NULL;
+    UCRA_Result result = ucra_wav_writer_open(&writer, path, first->output.sample_rate, first->output.channels,
+                                              first->args.wav_format, UCRA_WAV_RF64);
+    if (result == UCRA_SUCCESS) {
+        result = ucra_timeline_create_stream(&timeline, first->output.sample_rate, first->output.channels,
+                                             ucra_batch_sink, writer);
+    }
+    double begin = 0.0;           /* where the note before ends: the next note's place */
+    double previous = 0.0;        /* duration of the note before */
+    for (uint32_t i = 0; result == UCRA_SUCCESS && i < count; i++) {
+        if (notes[i].exit_code != UCRA_EXIT_OK) continue;
+        const UCRA_CLIArgs* args = &notes[i].args;
+        double duration = (double)notes[i].output.frames / rate;
+        double preutter = args->preutter_ms / 1000.0;
+        if (preutter > previous) preutter = previous; /* never before the note it follows */
+        float env_time[UCRA_CLI_ENV_POINTS], env_gain[UCRA_CLI_ENV_POINTS];
+        UCRA_EnvCurve env;
+        ucra_batch_envelope(args, duration, env_time, env_gain, &env);
+
+        UCRA_TimelineNote note = { notes[i].output.pcm, notes[i].output.frames, begin, preutter,
+                                   args->overlap_ms / 1000.0, env.length ? &env : NULL };
+        result = ucra_timeline_add(timeline, &note);
+        begin += duration - preutter;
+        previous = duration;
+    }
+    if (timeline) {
+        UCRA_Result finished = ucra_timeline_finish(timeline, NULL);
+        if (result == UCRA_SUCCESS) result = finished;
+        ucra_timeline_destroy(timeline);
+    }
+    if (writer) {
+        UCRA_Result closed = ucra_wav_writer_close(writer);
+        if (result == UCRA_SUCCESS) result = closed;
+    }
     if (result != UCRA_SUCCESS) {
-        fprintf(stderr, "Error: Failed to create render config (error %d)\n", result);
-        ucra_manifest_free(manifest);
-        ucra_cli_args_free(&args);
-        return 5;
+        fprintf(stderr, "Error: Failed to write WAV file %s (error %d)\n", path, result);
+        return UCRA_EXIT_WRITE;
     }
+    return UCRA_EXIT_OK;
+}
 
-    printf("✓ Successfully parsed CLI arguments\n");
-    printf("✓ Successfully loaded manifest\n");
-    printf("✓ Successfully converted to UCRA structures\n");
-    printf("✓ CLI bridge framework is working\n");
+/* Render every request of in on jobs workers (0 = one per CPU) and report "<line> OK" or
+ * "<line> ERR <exit code>" per note, in input order. Manifests, the flag mapping and F0 curve files
+ * are loaded once for the whole batch. With concat_path, the notes are joined into that one WAV in
+ * input order instead of being written to their own outputs. Returns the first failing note's code. */
+static int ucra_cli_batch(UCRA_CLISession* session, FILE* in, uint32_t jobs, const char* concat_path) {
+    uint32_t count = 0;
+    UCRA_BatchNote* notes = ucra_batch_read(in, &count);
+    if (!notes) {
+        fprintf(stderr, "Error: Failed to read the batch\n");
+        return UCRA_EXIT_ARGS;
+    }
+    uint32_t* pending = malloc((count ? count : 1) * sizeof(uint32_t));
+    UCRA_BatchCurve* curves = calloc(count ? count : 1, sizeof(UCRA_BatchCurve));
+    uint32_t pending_count = 0, curve_count = 0;
+    int needs_mapper = 0;
+
+    /* Everything shared is resolved here, so the workers only render */
+    for (uint32_t i = 0; pending && curves && i < count; i++) {
+        UCRA_BatchNote* note = &notes[i];
+        char* argv[UCRA_CLI_MAX_ARGS];
+        argv[0] = "resampler";
+        ucra_cli_args_init(&note->args);
+        int argc = ucra_cli_split(note->line, argv, UCRA_CLI_MAX_ARGS);
+        UCRA_Result result = argc < 0 ? UCRA_ERR_INTERNAL : ucra_parse_cli_args(argc, argv, &note->args, stderr);
+        if (result != UCRA_SUCCESS) {
+            note->exit_code = result == UCRA_ERR_INVALID_ARGUMENT ? UCRA_EXIT_USAGE : UCRA_EXIT_ARGS;
+            continue;
+        }
+        if (ucra_cli_session_manifest(session, note->args.vb_root, &note->manifest) != UCRA_SUCCESS) {
+            note->exit_code = UCRA_EXIT_MANIFEST;
+            continue;
+        }
+        if (note->args.f0_curve_file) {
+            uint32_t c = 0;
+            while (c < curve_count && strcmp(curves[c].path, note->args.f0_curve_file) != 0) c++;
+            if (c == curve_count) {
+                curves[c].path = note->args.f0_curve_file;
+                ucra_cli_load_f0(&note->args, &curves[c].file, &curves[c].curve);
+                curve_count++;
+            }
+            note->f0 = curves[c].file ? &curves[c].curve : NULL;
+        }
+        needs_mapper |= note->args.flags_str != NULL;
+        note->exit_code = -1;
+        pending[pending_count++] = i;
+    }
 
-    /* TODO: Implement actual engine creation and rendering */
-    /* For now, create a simple test tone as placeholder output */
-    const uint64_t test_frames = (uint64_t)(args.sample_rate * args.duration_sec);
-    float* test_pcm = malloc(test_frames * sizeof(float));
-    if (test_pcm) {
-        /* Generate simple sine wave at the specified MIDI note frequency */
-        double frequency = 440.0 * pow(2.0, (args.midi_note - 69) / 12.0);
-        for (uint64_t i = 0; i < test_frames; i++) {
-            double t = (double)i / args.sample_rate;
-            test_pcm[i] = 0.5f * sin(2.0 * M_PI * frequency * t);
+    /* One engine (and cache handle) per worker, as a render's result lives in its engine */
+    UCRA_ThreadPool* pool = NULL;
+    uint32_t workers = jobs ? jobs : ucra_cpu_count();
+    if (workers > pending_count) workers = pending_count;
+    if (workers > 1 && ucra_pool_create(workers, &pool) != UCRA_SUCCESS) {
+        pool = NULL; /* render on this thread instead */
+    }
+    workers = pool ? ucra_pool_size(pool) : 1;
+    UCRA_CLIWorker* worker_state = calloc(workers, sizeof(UCRA_CLIWorker));
+    int ready = pending && curves && worker_state;
+    if (ready) {
+        worker_state[0] = session->worker;
+        for (uint32_t w = 1; ready && w < workers; w++) {
+            ready = ucra_cli_worker_init(&worker_state[w], session) == UCRA_SUCCESS;
         }
+    }
 
-        result = ucra_write_wav_file(args.output_wav, test_pcm, test_frames, 1, args.sample_rate);
-        if (result == UCRA_SUCCESS) {
-            printf("✓ Test WAV file written to %s\n", args.output_wav);
+    int exit_code = UCRA_EXIT_OK;
+    if (ready) {
+        UCRA_BatchJob job = { notes, pending, pending_count, worker_state,
+                              needs_mapper ? ucra_cli_session_mapper(session) : NULL, concat_path != NULL };
+        ucra_pool_run(pool, pending_count, ucra_batch_render_job, &job);
+        if (concat_path) {
+            exit_code = ucra_batch_concat(notes, count, concat_path);
+        }
+    } else {
+        fprintf(stderr, "Error: Failed to set up the batch\n");
+        exit_code = UCRA_EXIT_RENDER;
+    }
+    ucra_pool_destroy(pool);
+
+    for (uint32_t i = 0; i < count; i++) {
+        int code = notes[i].exit_code < 0 ? UCRA_EXIT_RENDER : notes[i].exit_code;
+        if (code == UCRA_EXIT_OK) {
+            printf("%u OK\n", i + 1);
         } else {
-            fprintf(stderr, "Error: Failed to write WAV file (error %d)\n", result);
+            printf("%u ERR %d\n", i + 1, code);
+            if (exit_code == UCRA_EXIT_OK) exit_code = code;
         }
+        free(notes[i].output.pcm);
+        ucra_cli_args_free(&notes[i].args);
+        free(notes[i].line);
+    }
+    fflush(stdout);
 
-        free(test_pcm);
+    for (uint32_t w = 1; worker_state && w < workers; w++) {
+        ucra_cli_worker_free(&worker_state[w]);
+    }
+    for (uint32_t c = 0; c < curve_count; c++) {
+        ucra_f0_curve_close(curves[c].file);
     }
+    free(worker_state);
+    free(curves);
+    free(pending);
+    free(notes);
+    return exit_code;
+}
 
-    /* Cleanup */
-    if (f0_curve.time_sec) {
-        free((void*)f0_curve.time_sec);
-        free((void*)f0_curve.f0_hz);
+#ifndef _WIN32
+static int ucra_cli_socket_address(const char* path, struct sockaddr_un* address) {
+    memset(address, 0, sizeof(*address));
+    address->sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(address->sun_path)) {
+        fprintf(stderr, "Error: Socket path too long: %s\n", path);
+        return 0;
     }
+    strcpy(address->sun_path, path);
+    return 1;
+}
 
-    ucra_manifest_free(manifest);
-    ucra_cli_args_free(&args);
+/* Serve connections on a local socket until a request asks to stop */
+static int ucra_cli_serve_socket(UCRA_CLISession* session, const char* path) {
+    struct sockaddr_un address;
+    if (!ucra_cli_socket_address(path, &address)) return UCRA_EXIT_ARGS;
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0) {
+        perror("socket");
+        return UCRA_EXIT_ARGS;
+    }
+    unlink(path); /* a stale socket of a server that did not shut down */
+    if (bind(listener, (struct sockaddr*)&address, sizeof(address)) != 0 || listen(listener, 16) != 0) {
+        perror(path);
+        close(listener);
+        return UCRA_EXIT_ARGS;
+    }
 
-    printf("UCRA CLI Bridge completed successfully\n");
-    return 0;
+    int stop = 0;
+    while (!stop) {
+        int connection = accept(listener, NULL, NULL);
+        if (connection < 0) continue;
+        int reply_fd = dup(connection);
+        FILE* in = fdopen(connection, "r");
+        FILE* out = reply_fd >= 0 ? fdopen(reply_fd, "w") : NULL;
+        if (in && out) {
+            stop = ucra_cli_serve(session, in, out);
+        }
+        if (in) fclose(in); else close(connection);
+        if (out) fclose(out); else if (reply_fd >= 0) close(reply_fd);
+    }
+    close(listener);
+    unlink(path);
+    return UCRA_EXIT_OK;
+}
+
+/* Send this invocation to the server at path; -1 if none is listening, else its reply's exit code */
+static int ucra_cli_forward(const char* path, int argc, char* argv[]) {
+    struct sockaddr_un address;
+    char line[UCRA_CLI_LINE_MAX];
+    char cwd[4096];
+    size_t length = 0;
+    line[0] = '\0';
+    if (!ucra_cli_socket_address(path, &address)) return -1;
+    if (ucra_getcwd(cwd, sizeof(cwd))) {
+        if (!ucra_cli_append_quoted(line, sizeof(line), &length, "--cwd") ||
+            !ucra_cli_append_quoted(line, sizeof(line), &length, cwd)) {
+            return -1;
+        }
+    }
+    for (int i = 1; i < argc; i++) {
+        if (!ucra_cli_append_quoted(line, sizeof(line), &length, argv[i])) return -1;
+    }
+    if (length + 2 > sizeof(line)) return -1;
+    line[length++] = '\n';
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    if (connect(fd, (struct sockaddr*)&address, sizeof(address)) != 0) {
+        close(fd);
+        return -1;
+    }
+    for (size_t sent = 0; sent < length;) {
+        ssize_t n = write(fd, line + sent, length - sent);
+        if (n <= 0) {
+            close(fd);
+            return UCRA_EXIT_RENDER;
+        }
+        sent += (size_t)n;
+    }
+
+    FILE* in = fdopen(fd, "r");
+    if (!in) {
+        close(fd);
+        return UCRA_EXIT_RENDER;
+    }
+    int exit_code = UCRA_EXIT_RENDER; /* the server went away mid-request */
+    char reply[64];
+    if (fgets(reply, sizeof(reply), in)) {
+        if (strncmp(reply, "OK", 2) == 0) {
+            exit_code = UCRA_EXIT_OK;
+        } else if (sscanf(reply, "ERR %d", &exit_code) != 1) {
+            exit_code = UCRA_EXIT_RENDER;
+        }
+    }
+    fclose(in);
+    return exit_code;
+}
+#endif
+
+/* Main CLI bridge function */
+int main(int argc, char* argv[]) {
+    char* mapping_path = NULL;
+    char* socket_path = NULL;
+    char* batch_path = NULL;
+    char* concat_path = NULL;
+    char* jobs = NULL;
+    char* cache_dir = NULL;
+    char* cache_size = NULL;
+    ucra_find_arg(argc, argv, "-m", "--mapping", &mapping_path);
+    ucra_find_arg(argc, argv, "-k", "--cache", &cache_dir);
+    ucra_find_arg(argc, argv, "-K", "--cache-size", &cache_size);
+    ucra_find_arg(argc, argv, "-s", "--socket", &socket_path);
+    ucra_find_arg(argc, argv, "-j", "--jobs", &jobs);
+    ucra_find_arg(argc, argv, "-C", "--concat", &concat_path);
+    int batch = ucra_find_arg(argc, argv, "-b", "--batch", &batch_path);
+    if (batch && !batch_path && batch + 1 < argc && strcmp(argv[batch + 1], "-") == 0) {
+        batch_path = argv[batch + 1]; /* "-" reads stdin */
+    }
+    int server = batch || ucra_has_flag(argc, argv, "-S", "--server"); /* stdout carries reports */
+
+#ifndef _WIN32
+    /* A plain invocation prefers a running server, and renders itself when there is none */
+    const char* forward_path = getenv(UCRA_SERVER_SOCKET_ENV);
+    if (!server && forward_path && *forward_path && !ucra_has_flag(argc, argv, "-h", "--help")) {
+        int exit_code = ucra_cli_forward(forward_path, argc, argv);
+        if (exit_code >= 0) {
+            return exit_code;
+        }
+    }
+#endif
+
+    UCRA_CLISession session;
+    double cache_mb = cache_size ? atof(cache_size) : UCRA_DEFAULT_CACHE_MB;
+    if (!(cache_mb > 0.0)) cache_mb = UCRA_DEFAULT_CACHE_MB;
+    if (ucra_cli_session_init(&session, mapping_path, cache_dir, (uint64_t)(cache_mb * 1024.0 * 1024.0),
+                              server) != UCRA_SUCCESS) {
+        fprintf(stderr, "Error: Failed to create engine\n");
+        ucra_cli_session_free(&session);
+        return UCRA_EXIT_RENDER;
+    }
+
+    int exit_code = UCRA_EXIT_OK;
+    if (batch) {
+        FILE* in = batch_path && strcmp(batch_path, "-") != 0 ? fopen(batch_path, "r") : stdin;
+        long n = jobs ? strtol(jobs, NULL, 10) : 0;
+        if (!in) {
+            fprintf(stderr, "Error: Cannot open batch file %s\n", batch_path);
+            exit_code = UCRA_EXIT_ARGS;
+        } else {
+            exit_code = ucra_cli_batch(&session, in, n > 0 ? (uint32_t)n : 0, concat_path);
+            if (in != stdin) fclose(in);
+        }
+    } else if (!server) {
+        exit_code = ucra_cli_run(&session, argc, argv);
+        if (exit_code == UCRA_EXIT_OK) {
+            printf("UCRA CLI Bridge completed successfully\n");
+        }
+    } else if (socket_path) {
+#ifndef _WIN32
+        exit_code = ucra_cli_serve_socket(&session, socket_path);
+#else
+        fprintf(stderr, "Error: --socket is not supported on this platform; use stdin\n");
+        exit_code = UCRA_EXIT_ARGS;
+#endif
+    } else {
+        ucra_cli_serve(&session, stdin, stdout);
+    }
+
+    ucra_cli_session_free(&session);
+    return exit_code;
 }
@@ -0,0 +1,417 @@
+/*
+ * UCRA Analysis Cache
+ * Cache file format, memory-mapped loading and the lazily filled sample store.
+ */
+
+#include "ucra_analysis.h"
+#include "ucra_file.h"
+#include "ucra_threads.h"
+#include "ucra_wav.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define UCRA_ANALYSIS_MAGIC "UCRAANA"
+#define UCRA_ANALYSIS_SUFFIX "_wav.ucra"
+
+
+/* On-disk header; the float payload follows: f0, spectrogram rows, aperiodicity rows */
+typedef struct UCRA_AnalysisHeader {
+    char magic[8];          /* UCRA_ANALYSIS_MAGIC, NUL padded */
+    uint32_t version;       /* UCRA_ANALYSIS_VERSION */
+    uint32_t header_size;   /* sizeof(UCRA_AnalysisHeader), also marks the byte order */
+    uint64_t source_hash;
+    uint64_t options_hash;
+    uint32_t sample_rate;
+    uint32_t frame_count;
+    uint32_t bins;
+    uint32_t reserved;
+    double frame_period;
+    uint64_t reserved2;
+} UCRA_AnalysisHeader;
+
+struct UCRA_AnalysisFile {
+    UCRA_AnalysisData data;
+    UCRA_FileMap map;       /* whole file when mapped, empty for in-memory results */
+    float* owned[3];        /* in-memory results: f0, spectrogram, aperiodicity */
+};
+
+UCRA_Result ucra_analysis_hash_file(const char* path, uint64_t* out_hash) {
+    if (!path || !out_hash) return UCRA_ERR_INVALID_ARGUMENT;
+    FILE* file = fopen(path, "rb");
+    if (!file) return UCRA_ERR_FILE_NOT_FOUND;
+
+    unsigned char chunk[65536];
+    uint64_t hash = UCRA_FNV_OFFSET;
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), file)) > 0) {
+        hash = ucra_fnv1a(hash, chunk, n);
+    }
+    int failed = ferror(file);
+    fclose(file);
+    if (failed) return UCRA_ERR_INTERNAL;
+    *out_hash = hash;
+    return UCRA_SUCCESS;
+}
+
+uint64_t ucra_analysis_options_hash(const UCRA_AnalysisOptions* options) {
+    uint64_t hash = UCRA_FNV_OFFSET;
+    uint32_t version = UCRA_ANALYSIS_VERSION;
+    hash = ucra_fnv1a(hash, &version, sizeof(version));
+    hash = ucra_fnv1a(hash, &options->frame_period, sizeof(options->frame_period));
+    hash = ucra_fnv1a(hash, &options->f0_floor, sizeof(options->f0_floor));
+    hash = ucra_fnv1a(hash, &options->f0_ceil, sizeof(options->f0_ceil));
+    hash = ucra_fnv1a(hash, &options->f0_method, sizeof(options->f0_method));
+    return hash;
+}
+
+UCRA_Result ucra_analysis_cache_path(const char* wav_path, char* out, size_t out_size) {
+    if (!wav_path || !out) return UCRA_ERR_INVALID_ARGUMENT;
+    size_t len = strlen(wav_path);
+    /* drop a .wav extension, then append the suffix */
+    if (len >= 4 && (strcmp(wav_path + len - 4, ".wav") == 0 || strcmp(wav_path + len - 4, ".WAV") == 0)) {
+        len -= 4;
+    }
+    if (len + sizeof(UCRA_ANALYSIS_SUFFIX) > out_size) return UCRA_ERR_INVALID_ARGUMENT;
+    memcpy(out, wav_path, len);
+    memcpy(out + len, UCRA_ANALYSIS_SUFFIX, sizeof(UCRA_ANALYSIS_SUFFIX));
+    return UCRA_SUCCESS;
+}
+
+/* payload floats for a header, or 0 if the sizes overflow */
+static size_t payload_floats(uint32_t frame_count, uint32_t bins) {
+    uint64_t floats = (uint64_t)frame_count * (1 + 2 * (uint64_t)bins);
+    if (floats > SIZE_MAX / sizeof(float)) return 0;
+    return (size_t)floats;
+}
+
+UCRA_Result ucra_analysis_save(const char* path, uint64_t source_hash, uint64_t options_hash,
+                               const UCRA_AnalysisData* data) {
+    if (!path || !data || (data->frame_count > 0 && (!data->f0 || !data->spectrogram || !data->aperiodicity))) {
+        return UCRA_ERR_INVALID_ARGUMENT;
+    }
+
+    UCRA_AnalysisHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, UCRA_ANALYSIS_MAGIC, sizeof(UCRA_ANALYSIS_MAGIC));
+    header.version = UCRA_ANALYSIS_VERSION;
+    header.header_size = sizeof(header);
+    header.source_hash = source_hash;
+    header.options_hash = options_hash;
+    header.sample_rate = data->sample_rate;
+    header.frame_count = data->frame_count;
+    header.bins = data->bins;
+    header.frame_period = data->frame_period;
+
+    size_t path_len = strlen(path);
+    char* temp_path = malloc(path_len + 5);
+    if (!temp_path) return UCRA_ERR_OUT_OF_MEMORY;
+    memcpy(temp_path, path, path_len);
+    memcpy(temp_path + path_len, ".tmp", 5);
+
+    FILE* file = fopen(temp_path, "wb");
+    if (!file) {
+        free(temp_path);
+        return UCRA_ERR_INTERNAL;
+    }
+    size_t cells = (size_t)data->frame_count * data->bins;
+    int ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+             fwrite(data->f0, sizeof(float), data->frame_count, file) == data->frame_count &&
+             fwrite(data->spectrogram, sizeof(float), cells, file) == cells &&
+             fwrite(data->aperiodicity, sizeof(float), cells, file) == cells;
+    ok = fclose(file) == 0 && ok;
+
+    UCRA_Result result = ok ? ucra_file_replace(temp_path, path) : UCRA_ERR_INTERNAL;
+    if (!ok) remove(temp_path);
+    free(temp_path);
+    return result;
+}
+
+UCRA_Result ucra_analysis_open(const char* path, uint64_t source_hash, uint64_t options_hash,
+                               UCRA_AnalysisFile** out_file) {
+    if (!path || !out_file) return UCRA_ERR_INVALID_ARGUMENT;
+    *out_file = NULL;
+
+    UCRA_AnalysisFile* file = calloc(1, sizeof(UCRA_AnalysisFile));
+    if (!file) return UCRA_ERR_OUT_OF_MEMORY;
+    UCRA_Result result = ucra_file_map(path, &file->map);
+    if (result != UCRA_SUCCESS) {
+        free(file);
+        return result;
+    }
+    if (file->map.size < sizeof(UCRA_AnalysisHeader)) {
+        ucra_analysis_close(file);
+        return UCRA_ERR_INTERNAL;
+    }
+
+    UCRA_AnalysisHeader header;
+    memcpy(&header, file->map.data, sizeof(header));
+    size_t floats = payload_floats(header.frame_count, header.bins);
+    int valid = memcmp(header.magic, UCRA_ANALYSIS_MAGIC, sizeof(UCRA_ANALYSIS_MAGIC)) == 0 &&
+                header.version == UCRA_ANALYSIS_VERSION &&
+                header.header_size == sizeof(header) &&
+                header.source_hash == source_hash &&
+                header.options_hash == options_hash &&
+                (header.frame_count == 0 || floats > 0) &&
+                file->map.size == sizeof(header) + floats * sizeof(float);
+    if (!valid) {
+        ucra_analysis_close(file);
+        return UCRA_ERR_INTERNAL;
+    }
+
+    const float* payload = (const float*)((const char*)file->map.data + sizeof(header));
+    size_t cells = (size_t)header.frame_count * header.bins;
+    file->data.sample_rate = header.sample_rate;
+    file->data.frame_period = header.frame_period;
+    file->data.frame_count = header.frame_count;
+    file->data.bins = header.bins;
+    file->data.f0 = payload;
+    file->data.spectrogram = payload + header.frame_count;
+    file->data.aperiodicity = payload + header.frame_count + cells;
+    *out_file = file;
+    return UCRA_SUCCESS;
+}
+
+const UCRA_AnalysisData* ucra_analysis_data(const UCRA_AnalysisFile* file) {
+    return file ? &file->data : NULL;
+}
+
+void ucra_analysis_close(UCRA_AnalysisFile* file) {
+    if (!file) return;
+    ucra_file_unmap(&file->map);
+    for (int i = 0; i < 3; ++i) free(file->owned[i]);
+    free(file);
+}
+
+/* ---------------------------------------------------------------------------
+ * Store
+ * ------------------------------------------------------------------------- */
+
+typedef enum UCRA_EntryState {
+    UCRA_ENTRY_LOADING,
+    UCRA_ENTRY_READY,
+    UCRA_ENTRY_FAILED
+} UCRA_EntryState;
+
+typedef struct UCRA_AnalysisEntry {
+    char* wav_path;
+    uint64_t path_hash;
+    UCRA_EntryState state;
+    UCRA_Result status;      /* why loading failed */
+    UCRA_AnalysisFile* file;
+} UCRA_AnalysisEntry;
+
+struct UCRA_AnalysisStore {
+    UCRA_AnalysisOptions options;
+    uint64_t options_hash;
+    UCRA_AnalyzeFn analyze;
+    void* ctx;
+
+    UCRA_Mutex lock;
+    UCRA_Cond loaded;        /* broadcast whenever an entry leaves LOADING */
+
+    /* open-addressed by path hash; entries are heap-allocated so they stay put on growth */
+    UCRA_AnalysisEntry** slots;
+    uint32_t slot_count;     /* power of two */
+    uint32_t entry_count;
+    uint64_t analyzed;
+};
+
+UCRA_Result ucra_analysis_store_create(const UCRA_AnalysisOptions* options, UCRA_AnalyzeFn analyze,
+                                       void* ctx, UCRA_AnalysisStore** out_store) {
+    if (!options || !analyze || !out_store) return UCRA_ERR_INVALID_ARGUMENT;
+    *out_store = NULL;
+
+    UCRA_AnalysisStore* store = calloc(1, sizeof(UCRA_AnalysisStore));
+    if (!store) return UCRA_ERR_OUT_OF_MEMORY;
+    store->options = *options;
+    store->options_hash = ucra_analysis_options_hash(options);
+    store->analyze = analyze;
+    store->ctx = ctx;
+    store->slot_count = 64;
+    store->slots = calloc(store->slot_count, sizeof(UCRA_AnalysisEntry*));
+    if (!store->slots) {
+        free(store);
+        return UCRA_ERR_OUT_OF_MEMORY;
+    }
+    if (ucra_mutex_init(&store->lock) != 0) {
+        free(store->slots);
+        free(store);
+        return UCRA_ERR_INTERNAL;
+    }
+    if (ucra_cond_init(&store->loaded) != 0) {
+        ucra_mutex_destroy(&store->lock);
+        free(store->slots);
+        free(store);
+        return UCRA_ERR_INTERNAL;
+    }
+    *out_store = store;
+    return UCRA_SUCCESS;
+}
+
+void ucra_analysis_store_destroy(UCRA_AnalysisStore* store) {
+    if (!store) return;
+    for (uint32_t i = 0; i < store->slot_count; ++i) {
+        UCRA_AnalysisEntry* entry = store->slots[i];
+        if (!entry) continue;
+        ucra_analysis_close(entry->file);
+        free(entry->wav_path);
+        free(entry);
+    }
+    ucra_cond_destroy(&store->loaded);
+    ucra_mutex_destroy(&store->lock);
+    free(store->slots);
+    free(store);
+}
+
+/* slot holding wav_path, or the empty slot where it belongs */
+static uint32_t find_slot(const UCRA_AnalysisStore* store, const char* wav_path, uint64_t path_hash) {
+    uint32_t mask = store->slot_count - 1;
+    uint32_t i = (uint32_t)path_hash & mask;
+    while (store->slots[i] &&
+           (store->slots[i]->path_hash != path_hash || strcmp(store->slots[i]->wav_path, wav_path) != 0)) {
+        i = (i + 1) & mask;
+    }
+    return i;
+}
+
+/* keep the table at most half full */
+static UCRA_Result grow_slots(UCRA_AnalysisStore* store) {
+    if ((store->entry_count + 1) * 2 <= store->slot_count) return UCRA_SUCCESS;
+    uint32_t count = store->slot_count * 2;
+    UCRA_AnalysisEntry** slots = calloc(count, sizeof(UCRA_AnalysisEntry*));
+    if (!slots) return UCRA_ERR_OUT_OF_MEMORY;
+    for (uint32_t i = 0; i < store->slot_count; ++i) {
+        UCRA_AnalysisEntry* entry = store->slots[i];
+        if (!entry) continue;
+        uint32_t j = (uint32_t)entry->path_hash & (count - 1);
+        while (slots[j]) j = (j + 1) & (count - 1);
+        slots[j] = entry;
+    }
+    free(store->slots);
+    store->slots = slots;
+    store->slot_count = count;
+    return UCRA_SUCCESS;
+}
+
+/* cache file if it is current, else analyze the WAV and try to persist the result */
+static UCRA_Result load_entry(UCRA_AnalysisStore* store, const char* wav_path,
+                              UCRA_AnalysisFile** out_file, int* out_analyzed) {
+    *out_analyzed = 0;
+    uint64_t source_hash = 0;
+    UCRA_Result result = ucra_analysis_hash_file(wav_path, &source_hash);
+    if (result != UCRA_SUCCESS) return result;
+
+    size_t path_size = strlen(wav_path) + sizeof(UCRA_ANALYSIS_SUFFIX);
+    char* cache_path = malloc(path_size);
+    if (!cache_path) return UCRA_ERR_OUT_OF_MEMORY;
+    ucra_analysis_cache_path(wav_path, cache_path, path_size);
+
+    if (ucra_analysis_open(cache_path, source_hash, store->options_hash, out_file) == UCRA_SUCCESS) {
+        free(cache_path);
+        return UCRA_SUCCESS;
+    }
+
+    float* samples = NULL;
+    uint32_t length = 0, sample_rate = 0;
+    result = ucra_wav_read_mono(wav_path, &samples, &length, &sample_rate);
+    if (result != UCRA_SUCCESS) {
+        free(cache_path);
+        return result;
+    }
+
+    UCRA_AnalysisData data;
+    memset(&data, 0, sizeof(data));
+    result = store->analyze(store->ctx, samples, length, sample_rate, &data);
+    free(samples);
+    *out_analyzed = 1;
+    if (result != UCRA_SUCCESS) {
+        free((void*)data.f0);
+        free((void*)data.spectrogram);
+        free((void*)data.aperiodicity);
+        free(cache_path);
+        return result;
+    }
+
+    /* prefer the mapped file so every process shares one copy; keep it in memory otherwise */
+    if (ucra_analysis_save(cache_path, source_hash, store->options_hash, &data) == UCRA_SUCCESS &&
+        ucra_analysis_open(cache_path, source_hash, store->options_hash, out_file) == UCRA_SUCCESS) {
+        free((void*)data.f0);
+        free((void*)data.spectrogram);
+        free((void*)data.aperiodicity);
+        free(cache_path);
+        return UCRA_SUCCESS;
+    }
+    free(cache_path);
+
+    UCRA_AnalysisFile* file = calloc(1, sizeof(UCRA_AnalysisFile));
+    if (!file) {
+        free((void*)data.f0);
+        free((void*)data.spectrogram);
+        free((void*)data.aperiodicity);
+        return UCRA_ERR_OUT_OF_MEMORY;
+    }
+    file->data = data;
+    file->owned[0] = (float*)data.f0;
+    file->owned[1] = (float*)data.spectrogram;
+    file->owned[2] = (float*)data.aperiodicity;
+    *out_file = file;
+    return UCRA_SUCCESS;
+}
+
+UCRA_Result ucra_analysis_store_get(UCRA_AnalysisStore* store, const char* wav_path,
+                                    const UCRA_AnalysisData** out_data) {
+    if (!store || !wav_path || !out_data) return UCRA_ERR_INVALID_ARGUMENT;
+    *out_data = NULL;
+    uint64_t path_hash = ucra_fnv1a(UCRA_FNV_OFFSET, wav_path, strlen(wav_path));
+
+    ucra_mutex_lock(&store->lock);
+    uint32_t slot = find_slot(store, wav_path, path_hash);
+    UCRA_AnalysisEntry* entry = store->slots[slot];
+    if (!entry) {
+        UCRA_Result result = grow_slots(store);
+        entry = result == UCRA_SUCCESS ? calloc(1, sizeof(UCRA_AnalysisEntry)) : NULL;
+        char* path_copy = entry ? malloc(strlen(wav_path) + 1) : NULL;
+        if (!path_copy) {
+            free(entry);
+            ucra_mutex_unlock(&store->lock);
+            return UCRA_ERR_OUT_OF_MEMORY;
+        }
+        strcpy(path_copy, wav_path);
+        entry->wav_path = path_copy;
+        entry->path_hash = path_hash;
+        entry->state = UCRA_ENTRY_LOADING;
+        store->slots[find_slot(store, wav_path, path_hash)] = entry;
+        store->entry_count++;
+
+        /* load without the lock so other samples can be fetched meanwhile */
+        ucra_mutex_unlock(&store->lock);
+        UCRA_AnalysisFile* file = NULL;
+        int analyzed = 0;
+        result = load_entry(store, wav_path, &file, &analyzed);
+        ucra_mutex_lock(&store->lock);
+
+        entry->file = file;
+        entry->status = result;
+        entry->state = result == UCRA_SUCCESS ? UCRA_ENTRY_READY : UCRA_ENTRY_FAILED;
+        store->analyzed += (uint64_t)analyzed;
+        ucra_cond_broadcast(&store->loaded);
+    }
+    while (entry->state == UCRA_ENTRY_LOADING) {
+        ucra_cond_wait(&store->loaded, &store->lock);
+    }
+    UCRA_Result status = entry->state == UCRA_ENTRY_READY ? UCRA_SUCCESS : entry->status;
+    if (status == UCRA_SUCCESS) *out_data = &entry->file->data;
+    ucra_mutex_unlock(&store->lock);
+    return status;
+}
+
+uint64_t ucra_analysis_store_analyzed(const UCRA_AnalysisStore* store) {
+    if (!store) return 0;
+    UCRA_AnalysisStore* mutable_store = (UCRA_AnalysisStore*)store;
+    ucra_mutex_lock(&mutable_store->lock);
+    uint64_t analyzed = store->analyzed;
+    ucra_mutex_unlock(&mutable_store->lock);
+    return analyzed;
+}
@@ -0,0 +1,130 @@
+/*
+ * UCRA Analysis Cache (internal)
+ * Versioned on-disk store of per-sample vocoder analysis (F0, spectral envelope,
+ * aperiodicity) kept next to the voicebank WAVs, and a lazily filled in-memory
+ * store that maps those files on first use.
+ *
+ * A cache file "<stem>_wav.ucra" belongs to "<stem>.wav". It records a hash of
+ * the WAV bytes and of the analysis options, so an edited sample or a change of
+ * options is detected and re-analyzed. The payload is float32 in native byte
+ * order and is used in place from a read-only memory mapping.
+ */
+#ifndef UCRA_ANALYSIS_H
+#define UCRA_ANALYSIS_H
+
+#include "ucra/ucra.h"
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Bumped whenever the file layout or the meaning of its fields changes */
+#define UCRA_ANALYSIS_VERSION 1
+
+/** F0 estimators an analyzer may use (UCRA_AnalysisOptions.f0_method) */
+#define UCRA_ANALYSIS_F0_HARVEST 0
+#define UCRA_ANALYSIS_F0_DIO 1
+
+/** Defaults shared by the engine and the pre-analysis tool, so both produce the same cache key */
+#define UCRA_ANALYSIS_DEFAULT_FRAME_PERIOD 5.0
+#define UCRA_ANALYSIS_DEFAULT_F0_FLOOR 71.0
+#define UCRA_ANALYSIS_DEFAULT_F0_CEIL 800.0
+
+/** Settings that change the analysis result; all of them feed the options hash */
+typedef struct UCRA_AnalysisOptions {
+    double frame_period; /**< Analysis hop in milliseconds */
+    double f0_floor;     /**< Lowest F0 searched, Hz */
+    double f0_ceil;      /**< Highest F0 searched, Hz */
+    uint32_t f0_method;  /**< UCRA_ANALYSIS_F0_* */
+} UCRA_AnalysisOptions;
+
+/** Analysis of one sample; arrays are frame-major */
+typedef struct UCRA_AnalysisData {
+    uint32_t sample_rate;
+    double frame_period;       /**< milliseconds */
+    uint32_t frame_count;
+    uint32_t bins;             /**< fft_size / 2 + 1 */
+    const float* f0;           /**< frame_count values, 0 for unvoiced frames */
+    const float* spectrogram;  /**< frame_count rows of bins */
+    const float* aperiodicity; /**< frame_count rows of bins */
+} UCRA_AnalysisData;
+
+/** 64-bit FNV-1a hash of a file's contents */
+UCRA_Result ucra_analysis_hash_file(const char* path, uint64_t* out_hash);
+
+/** Hash of the analysis options, stored in and checked against cache files */
+uint64_t ucra_analysis_options_hash(const UCRA_AnalysisOptions* options);
+
+/**
+ * @brief Cache file path for a WAV: "dir/a.wav" -> "dir/a_wav.ucra"
+ * @return UCRA_SUCCESS, or UCRA_ERR_INVALID_ARGUMENT if out is too small
+ */
+UCRA_Result ucra_analysis_cache_path(const char* wav_path, char* out, size_t out_size);
+
+/**
+ * @brief Write data to path, replacing any existing file atomically
+ *
+ * The file is written next to path and renamed into place, so a concurrent
+ * reader sees either the old or the new file.
+ */
+UCRA_Result ucra_analysis_save(const char* path, uint64_t source_hash, uint64_t options_hash,
+                               const UCRA_AnalysisData* data);
+
+typedef struct UCRA_AnalysisFile UCRA_AnalysisFile;
+
+/**
+ * @brief Map a cache file and validate it against the expected hashes
+ * @return UCRA_SUCCESS, UCRA_ERR_FILE_NOT_FOUND if absent, UCRA_ERR_INTERNAL if the
+ *         file is corrupt, from another version, or stale for these hashes
+ */
+UCRA_Result ucra_analysis_open(const char* path, uint64_t source_hash, uint64_t options_hash,
+                               UCRA_AnalysisFile** out_file);
+
+/** Arrays of an open file; valid until ucra_analysis_close() */
+const UCRA_AnalysisData* ucra_analysis_data(const UCRA_AnalysisFile* file);
+
+void ucra_analysis_close(UCRA_AnalysisFile* file);
+
+/**
+ * @brief Analysis callback used by the store on a cache miss
+ *
+ * Fills out with malloc'd f0/spectrogram/aperiodicity arrays; the store takes
+ * ownership and releases them with free().
+ */
+typedef UCRA_Result (*UCRA_AnalyzeFn)(void* ctx, const float* samples, uint32_t length,
+                                      uint32_t sample_rate, UCRA_AnalysisData* out);
+
+typedef struct UCRA_AnalysisStore UCRA_AnalysisStore;
+
+/**
+ * @brief Create a store that analyzes samples with analyze under options
+ *
+ * Safe to share between threads: lookups and first-use loads are serialized
+ * internally, and returned data stays valid until the store is destroyed.
+ */
+UCRA_Result ucra_analysis_store_create(const UCRA_AnalysisOptions* options, UCRA_AnalyzeFn analyze,
+                                       void* ctx, UCRA_AnalysisStore** out_store);
+
+void ucra_analysis_store_destroy(UCRA_AnalysisStore* store);
+
+/**
+ * @brief Analysis of a WAV, loaded on first use
+ *
+ * Uses the cache file when it matches the WAV and options; otherwise runs the
+ * analyzer once and writes the cache file (a read-only voicebank just keeps the
+ * result in memory). Failures are remembered, so a missing sample is only
+ * looked for once.
+ */
+UCRA_Result ucra_analysis_store_get(UCRA_AnalysisStore* store, const char* wav_path,
+                                    const UCRA_AnalysisData** out_data);
+
+/** Number of samples the store had to analyze rather than load */
+uint64_t ucra_analysis_store_analyzed(const UCRA_AnalysisStore* store);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* UCRA_ANALYSIS_H */
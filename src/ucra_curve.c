@@ -0,0 +1,172 @@
+/*
+ * UCRA Curve Evaluation
+ * Monotonic cursors over F0/envelope curves with step, linear and cubic kernels.
+ */
+
+#include "ucra_curve.h"
+#include "ucra_options.h"
+
+#include <string.h>
+
+/* forward steps tried before a jump is treated as a seek */
+#define UCRA_CURVE_MAX_WALK 8
+
+void ucra_curve_cursor_f0(UCRA_CurveCursor* cursor, const UCRA_F0Curve* curve) {
+    memset(cursor, 0, sizeof(*cursor));
+    if (!curve || curve->length == 0 || !curve->time_sec || !curve->f0_hz) return;
+    cursor->time = curve->time_sec;
+    cursor->value = curve->f0_hz;
+    cursor->length = curve->length;
+    cursor->hold_nonpositive = 1;
+}
+
+void ucra_curve_cursor_env(UCRA_CurveCursor* cursor, const UCRA_EnvCurve* curve) {
+    memset(cursor, 0, sizeof(*cursor));
+    if (!curve || curve->length == 0 || !curve->time_sec || !curve->value) return;
+    cursor->time = curve->time_sec;
+    cursor->value = curve->value;
+    cursor->length = curve->length;
+}
+
+void ucra_curve_seek(UCRA_CurveCursor* cursor, double t) {
+    /* last i with time[i] <= t, or 0 when t precedes the curve */
+    uint32_t lo = 0, hi = cursor->length;
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if ((double)cursor->time[mid] <= t) lo = mid + 1; else hi = mid;
+    }
+    cursor->index = lo > 0 ? lo - 1 : 0;
+}
+
+/* move the cursor to the segment holding t */
+static inline void curve_advance(UCRA_CurveCursor* c, double t) {
+    if (t < (double)c->time[c->index] && c->index > 0) {
+        ucra_curve_seek(c, t);
+        return;
+    }
+    for (int walk = 0; c->index + 1 < c->length && (double)c->time[c->index + 1] <= t; ++walk) {
+        if (walk == UCRA_CURVE_MAX_WALK) {
+            ucra_curve_seek(c, t);
+            return;
+        }
+        c->index++;
+    }
+}
+
+static inline double eval_step(const UCRA_CurveCursor* c, double t) {
+    (void)t;
+    return (double)c->value[c->index];
+}
+
+static inline double eval_linear(const UCRA_CurveCursor* c, double t) {
+    uint32_t i = c->index;
+    double t0 = (double)c->time[i];
+    if (i + 1 >= c->length || t <= t0) return (double)c->value[i];
+
+    double v0 = (double)c->value[i];
+    double v1 = (double)c->value[i + 1];
+    double h = (double)c->time[i + 1] - t0;
+    if (h <= 0.0 || (c->hold_nonpositive && (v0 <= 0.0 || v1 <= 0.0))) return v0;
+    return v0 + (t - t0) / h * (v1 - v0);
+}
+
+/* slope between points a and b, or 0 if they coincide in time */
+static inline double curve_slope(const UCRA_CurveCursor* c, uint32_t a, uint32_t b) {
+    double h = (double)c->time[b] - (double)c->time[a];
+    return h > 0.0 ? ((double)c->value[b] - (double)c->value[a]) / h : 0.0;
+}
+
+static inline double eval_cubic(const UCRA_CurveCursor* c, double t) {
+    uint32_t i = c->index;
+    double t0 = (double)c->time[i];
+    if (i + 1 >= c->length || t <= t0) return (double)c->value[i];
+
+    double v0 = (double)c->value[i];
+    double v1 = (double)c->value[i + 1];
+    double h = (double)c->time[i + 1] - t0;
+    if (h <= 0.0 || (c->hold_nonpositive && (v0 <= 0.0 || v1 <= 0.0))) return v0;
+
+    /* Catmull-Rom tangents, one-sided at the ends and next to unvoiced points */
+    int has_prev = i > 0 && !(c->hold_nonpositive && c->value[i - 1] <= 0.0f);
+    int has_next = i + 2 < c->length && !(c->hold_nonpositive && c->value[i + 2] <= 0.0f);
+    double m0 = has_prev ? curve_slope(c, i - 1, i + 1) : curve_slope(c, i, i + 1);
+    double m1 = has_next ? curve_slope(c, i, i + 2) : curve_slope(c, i, i + 1);
+
+    double u = (t - t0) / h;
+    double u2 = u * u;
+    double u3 = u2 * u;
+    return (2.0 * u3 - 3.0 * u2 + 1.0) * v0
+         + (u3 - 2.0 * u2 + u) * h * m0
+         + (-2.0 * u3 + 3.0 * u2) * v1
+         + (u3 - u2) * h * m1;
+}
+
+double ucra_curve_sample(UCRA_CurveCursor* cursor, UCRA_CurveInterp interp, double t) {
+    curve_advance(cursor, t);
+    switch (interp) {
+        case UCRA_CURVE_LINEAR: return eval_linear(cursor, t);
+        case UCRA_CURVE_CUBIC: return eval_cubic(cursor, t);
+        case UCRA_CURVE_STEP:
+        default: return eval_step(cursor, t);
+    }
+}
+
+/* one loop per kernel so the evaluator inlines without a per-sample switch */
+#define UCRA_CURVE_BLOCK_LOOP(eval)                      \
+    for (uint32_t i = 0; i < n; ++i) {                   \
+        double t = t0 + (double)i * dt;                  \
+        curve_advance(cursor, t);                        \
+        out[i] = eval(cursor, t);                        \
+    }
+
+void ucra_curve_sample_block(UCRA_CurveCursor* cursor, UCRA_CurveInterp interp,
+                             double t0, double dt, uint32_t n, double* out) {
+    switch (interp) {
+        case UCRA_CURVE_LINEAR: UCRA_CURVE_BLOCK_LOOP(eval_linear) break;
+        case UCRA_CURVE_CUBIC: UCRA_CURVE_BLOCK_LOOP(eval_cubic) break;
+        case UCRA_CURVE_STEP:
+        default: UCRA_CURVE_BLOCK_LOOP(eval_step) break;
+    }
+}
+
+#undef UCRA_CURVE_BLOCK_LOOP
+
+UCRA_Result ucra_curve_parse_interp(const char* name, UCRA_CurveInterp* out) {
+    if (!name || !out) return UCRA_ERR_INVALID_ARGUMENT;
+    if (strcmp(name, "step") == 0) *out = UCRA_CURVE_STEP;
+    else if (strcmp(name, "linear") == 0) *out = UCRA_CURVE_LINEAR;
+    else if (strcmp(name, "cubic") == 0) *out = UCRA_CURVE_CUBIC;
+    else return UCRA_ERR_INVALID_ARGUMENT;
+    return UCRA_SUCCESS;
+}
+
+UCRA_CurveInterp ucra_curve_interp_from_options(const UCRA_KeyValue* options, uint32_t option_count) {
+    UCRA_CurveInterp interp = UCRA_CURVE_STEP;
+    if (!options) return interp;
+    for (uint32_t i = 0; i < option_count; ++i) {
+        if (options[i].key && strcmp(options[i].key, UCRA_CURVE_INTERP_OPTION) == 0) {
+            if (ucra_curve_parse_interp(options[i].value, &interp) != UCRA_SUCCESS) {
+                interp = UCRA_CURVE_STEP;
+            }
+        }
+    }
+    return interp;
+}
+
+UCRA_CurveInterp ucra_curve_interp_from_config(const UCRA_RenderConfig* config) {
+    const UCRA_TypedValue* typed = ucra_typed_option(config, UCRA_CURVE_INTERP_OPTION);
+    if (typed) {
+        UCRA_CurveInterp interp = UCRA_CURVE_STEP;
+        if ((typed->type == UCRA_VALUE_STRING || typed->type == UCRA_VALUE_ENUM) && typed->text) {
+            if (ucra_curve_parse_interp(typed->text, &interp) != UCRA_SUCCESS) {
+                interp = UCRA_CURVE_STEP;
+            }
+        } else if (typed->type == UCRA_VALUE_INT || typed->type == UCRA_VALUE_ENUM) {
+            if (typed->number == UCRA_CURVE_LINEAR || typed->number == UCRA_CURVE_CUBIC) {
+                interp = (UCRA_CurveInterp)(int)typed->number;
+            }
+        }
+        return interp;
+    }
+    return config ? ucra_curve_interp_from_options(config->options, config->option_count) : UCRA_CURVE_STEP;
+}
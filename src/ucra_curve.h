@@ -0,0 +1,94 @@
+/*
+ * UCRA Curve Evaluation (internal)
+ * Cursor-based sampling of F0 and envelope curves shared by the renderers.
+ * Cursors walk forward through the curve as time advances and only fall back
+ * to a binary search when the requested time jumps backwards or far ahead.
+ */
+#ifndef UCRA_CURVE_H
+#define UCRA_CURVE_H
+
+#include "ucra/ucra.h"
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Render option selecting how F0/envelope curves are interpolated */
+#define UCRA_CURVE_INTERP_OPTION "curve_interpolation"
+
+/**
+ * @brief Interpolation between curve points
+ */
+typedef enum UCRA_CurveInterp {
+    UCRA_CURVE_STEP = 0,   /**< hold the last point at or before t (default) */
+    UCRA_CURVE_LINEAR = 1, /**< straight line between neighbouring points */
+    UCRA_CURVE_CUBIC = 2   /**< cubic Hermite with Catmull-Rom tangents */
+} UCRA_CurveInterp;
+
+/**
+ * @brief Read position in a curve
+ *
+ * index is the segment holding the last sampled time: time[index] <= t < time[index + 1],
+ * or 0 before the first point. Times must be non-decreasing.
+ */
+typedef struct UCRA_CurveCursor {
+    const float* time;
+    const float* value;
+    uint32_t length;
+    uint32_t index;
+    /* points whose value is <= 0 are unvoiced: never interpolate across them */
+    int hold_nonpositive;
+} UCRA_CurveCursor;
+
+/** Point a cursor at an F0 curve (may be NULL or empty; then ucra_curve_valid() is false) */
+void ucra_curve_cursor_f0(UCRA_CurveCursor* cursor, const UCRA_F0Curve* curve);
+
+/** Point a cursor at an envelope curve (may be NULL or empty) */
+void ucra_curve_cursor_env(UCRA_CurveCursor* cursor, const UCRA_EnvCurve* curve);
+
+/** Non-zero if the cursor refers to a curve with at least one point */
+static inline int ucra_curve_valid(const UCRA_CurveCursor* cursor) {
+    return cursor->length > 0;
+}
+
+/** Reposition the cursor at t with a binary search */
+void ucra_curve_seek(UCRA_CurveCursor* cursor, double t);
+
+/** Sample the curve at t; the cursor advances, so increasing t is amortized O(1) */
+double ucra_curve_sample(UCRA_CurveCursor* cursor, UCRA_CurveInterp interp, double t);
+
+/**
+ * @brief Sample n evenly spaced times t0 + i * dt into out
+ *
+ * The interpolation kernel is chosen once per block, so the inner loop carries
+ * no per-sample mode branch.
+ */
+void ucra_curve_sample_block(UCRA_CurveCursor* cursor, UCRA_CurveInterp interp,
+                             double t0, double dt, uint32_t n, double* out);
+
+/**
+ * @brief Parse an interpolation name ("step", "linear", "cubic")
+ * @return UCRA_SUCCESS, or UCRA_ERR_INVALID_ARGUMENT for unknown names
+ */
+UCRA_Result ucra_curve_parse_interp(const char* name, UCRA_CurveInterp* out);
+
+/** Look up UCRA_CURVE_INTERP_OPTION in render options; missing or unknown values give step */
+UCRA_CurveInterp ucra_curve_interp_from_options(const UCRA_KeyValue* options, uint32_t option_count);
+
+/**
+ * @brief Interpolation a render config selects
+ *
+ * A typed UCRA_CURVE_INTERP_OPTION wins over a string one: a STRING or a
+ * named ENUM is parsed like the string option, an INT or unnamed ENUM number
+ * is a UCRA_CurveInterp value. Otherwise this is
+ * ucra_curve_interp_from_options().
+ */
+UCRA_CurveInterp ucra_curve_interp_from_config(const UCRA_RenderConfig* config);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* UCRA_CURVE_H */
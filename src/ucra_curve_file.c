@@ -0,0 +1,326 @@
+/*
+ * UCRA F0 Curve Files
+ * Loads F0 curves from two-column text files in one pass over a memory-mapped
+ * file, with a hand-rolled number scanner in place of sscanf, and from the
+ * binary curve format, whose point arrays the returned curve points into
+ * without copying.
+ */
+
+#include "ucra/ucra.h"
+#include "ucra_file.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+/* Binary layout: magic, version, point count and a reserved word, then the
+ * times and the F0 values as two arrays of little-endian floats */
+#define F0_FILE_MAGIC "UCF0"
+#define F0_FILE_VERSION 1u
+#define F0_FILE_HEADER_BYTES 16u
+
+/* Points the text parser allocates for at first; it doubles from there */
+#define F0_TEXT_INITIAL_POINTS 256u
+
+/* Significant digits the scanner keeps; more cannot change a float */
+#define SCAN_MAX_DIGITS 19
+
+typedef struct UCRA_F0File_ {
+    UCRA_FileMap map;   /* a binary file read in place */
+    float* time_sec;    /* parsed text, or a binary file decoded on a big-endian host */
+    float* f0_hz;
+    uint32_t length;
+    uint32_t capacity;
+} UCRA_F0File;
+
+static const double powers_of_ten[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+static uint32_t read_le32(const unsigned char* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void put_le32(unsigned char* p, uint32_t v) {
+    p[0] = (unsigned char)v;
+    p[1] = (unsigned char)(v >> 8);
+    p[2] = (unsigned char)(v >> 16);
+    p[3] = (unsigned char)(v >> 24);
+}
+
+static int host_is_little_endian(void) {
+    uint16_t one = 1;
+    unsigned char first;
+    memcpy(&first, &one, 1);
+    return first == 1;
+}
+
+static int is_blank(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+static const char* skip_blanks(const char* p, const char* end) {
+    while (p < end && is_blank(*p)) p++;
+    return p;
+}
+
+/* Scan a decimal number ([sign] digits [. digits] [e [sign] digits]) at p;
+ * returns the position after it, or NULL if there is none */
+static const char* scan_float(const char* p, const char* end, float* out) {
+    int negative = 0;
+    if (p < end && (*p == '+' || *p == '-')) {
+        negative = *p == '-';
+        p++;
+    }
+
+    uint64_t mantissa = 0;
+    int digits = 0;     /* significant digits in mantissa */
+    int exponent = 0;
+    int any = 0;
+    for (; p < end && *p >= '0' && *p <= '9'; p++) {
+        any = 1;
+        if (digits < SCAN_MAX_DIGITS) {
+            mantissa = mantissa * 10 + (uint64_t)(*p - '0');
+            digits += mantissa != 0;
+        } else {
+            exponent++;
+        }
+    }
+    if (p < end && *p == '.') {
+        for (p++; p < end && *p >= '0' && *p <= '9'; p++) {
+            any = 1;
+            if (digits < SCAN_MAX_DIGITS) {
+                mantissa = mantissa * 10 + (uint64_t)(*p - '0');
+                digits += mantissa != 0;
+                exponent--;
+            }
+        }
+    }
+    if (!any) {
+        return NULL;
+    }
+
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        const char* q = p + 1;
+        int exp_negative = 0;
+        if (q < end && (*q == '+' || *q == '-')) {
+            exp_negative = *q == '-';
+            q++;
+        }
+        if (q < end && *q >= '0' && *q <= '9') {
+            int value = 0;
+            for (; q < end && *q >= '0' && *q <= '9'; q++) {
+                if (value < 10000) value = value * 10 + (*q - '0');
+            }
+            exponent += exp_negative ? -value : value;
+            p = q;
+        }
+        /* otherwise the 'e' is not part of the number */
+    }
+
+    double value = (double)mantissa;
+    if (mantissa != 0) {
+        if (exponent >= 0 && exponent <= 22) {
+            value *= powers_of_ten[exponent];
+        } else if (exponent < 0 && exponent >= -22) {
+            value /= powers_of_ten[-exponent];
+        } else {
+            value *= pow(10.0, exponent);
+        }
+    }
+    *out = (float)(negative ? -value : value);
+    return p;
+}
+
+static UCRA_Result append_point(UCRA_F0File* file, float time, float f0) {
+    if (file->length == file->capacity) {
+        if (file->capacity > UINT32_MAX / 2) {
+            return UCRA_ERR_OUT_OF_MEMORY;
+        }
+        uint32_t capacity = file->capacity ? file->capacity * 2 : F0_TEXT_INITIAL_POINTS;
+        float* time_sec = realloc(file->time_sec, (size_t)capacity * sizeof(float));
+        if (!time_sec) {
+            return UCRA_ERR_OUT_OF_MEMORY;
+        }
+        file->time_sec = time_sec;
+        float* f0_hz = realloc(file->f0_hz, (size_t)capacity * sizeof(float));
+        if (!f0_hz) {
+            return UCRA_ERR_OUT_OF_MEMORY;
+        }
+        file->f0_hz = f0_hz;
+        file->capacity = capacity;
+    }
+    file->time_sec[file->length] = time;
+    file->f0_hz[file->length] = f0;
+    file->length++;
+    return UCRA_SUCCESS;
+}
+
+/* Lines of "time f0"; blank lines, lines starting with '#' and lines that do not
+ * begin with two numbers are skipped, and anything after the two numbers is ignored */
+static UCRA_Result parse_text(UCRA_F0File* file, const char* text, size_t size) {
+    const char* p = text;
+    const char* end = text + size;
+    if (size >= 3 && memcmp(p, "\xEF\xBB\xBF", 3) == 0) {
+        p += 3; /* UTF-8 byte order mark */
+    }
+
+    while (p < end) {
+        const char* line_end = memchr(p, '\n', (size_t)(end - p));
+        if (!line_end) line_end = end;
+
+        float time, f0;
+        const char* q = skip_blanks(p, line_end);
+        if (q < line_end && *q != '#' &&
+            (q = scan_float(q, line_end, &time)) != NULL &&
+            scan_float(skip_blanks(q, line_end), line_end, &f0) != NULL) {
+            UCRA_Result result = append_point(file, time, f0);
+            if (result != UCRA_SUCCESS) {
+                return result;
+            }
+        }
+        p = line_end + 1;
+    }
+    return file->length > 0 ? UCRA_SUCCESS : UCRA_ERR_INVALID_ARGUMENT;
+}
+
+static UCRA_Result open_binary(UCRA_F0File* file) {
+    const unsigned char* bytes = (const unsigned char*)file->map.data;
+    uint32_t count = read_le32(bytes + 8);
+    if (read_le32(bytes + 4) != F0_FILE_VERSION || count == 0 ||
+        (uint64_t)file->map.size != F0_FILE_HEADER_BYTES + (uint64_t)count * 2 * sizeof(float)) {
+        return UCRA_ERR_INVALID_ARGUMENT;
+    }
+    file->length = count;
+    if (host_is_little_endian()) {
+        return UCRA_SUCCESS; /* the mapping is page-aligned, so the arrays are float-aligned */
+    }
+
+    file->time_sec = malloc((size_t)count * sizeof(float));
+    file->f0_hz = malloc((size_t)count * sizeof(float));
+    if (!file->time_sec || !file->f0_hz) {
+        return UCRA_ERR_OUT_OF_MEMORY;
+    }
+    const unsigned char* p = bytes + F0_FILE_HEADER_BYTES;
+    for (uint32_t i = 0; i < count; i++, p += 4) {
+        uint32_t raw = read_le32(p);
+        memcpy(&file->time_sec[i], &raw, sizeof(float));
+    }
+    for (uint32_t i = 0; i < count; i++, p += 4) {
+        uint32_t raw = read_le32(p);
+        memcpy(&file->f0_hz[i], &raw, sizeof(float));
+    }
+    return UCRA_SUCCESS;
+}
+
+UCRA_Result ucra_f0_curve_open(UCRA_F0FileHandle* out_file, const char* path, UCRA_F0Curve* out_curve) {
+    if (out_file) *out_file = NULL;
+    if (!out_file || !path || !out_curve) {
+        return UCRA_ERR_INVALID_ARGUMENT;
+    }
+    memset(out_curve, 0, sizeof(*out_curve));
+
+    UCRA_F0File* file = calloc(1, sizeof(UCRA_F0File));
+    if (!file) {
+        return UCRA_ERR_OUT_OF_MEMORY;
+    }
+    UCRA_Result result = ucra_file_map(path, &file->map);
+    if (result != UCRA_SUCCESS) {
+        free(file);
+        /* an empty file maps to nothing */
+        return result == UCRA_ERR_INTERNAL ? UCRA_ERR_INVALID_ARGUMENT : result;
+    }
+
+    int binary = file->map.size >= F0_FILE_HEADER_BYTES && memcmp(file->map.data, F0_FILE_MAGIC, 4) == 0;
+    if (binary) {
+        result = open_binary(file);
+    } else {
+        result = parse_text(file, (const char*)file->map.data, file->map.size);
+    }
+    if (!binary || file->time_sec) {
+        ucra_file_unmap(&file->map); /* the points were copied out */
+    }
+    if (result != UCRA_SUCCESS) {
+        ucra_f0_curve_close(file);
+        return result;
+    }
+
+    if (file->time_sec) {
+        out_curve->time_sec = file->time_sec;
+        out_curve->f0_hz = file->f0_hz;
+    } else {
+        const float* points = (const float*)((const unsigned char*)file->map.data + F0_FILE_HEADER_BYTES);
+        out_curve->time_sec = points;
+        out_curve->f0_hz = points + file->length;
+    }
+    out_curve->length = file->length;
+    *out_file = file;
+    return UCRA_SUCCESS;
+}
+
+void ucra_f0_curve_close(UCRA_F0FileHandle file) {
+    if (!file) {
+        return;
+    }
+    ucra_file_unmap(&file->map);
+    free(file->time_sec);
+    free(file->f0_hz);
+    free(file);
+}
+
+static int write_floats(FILE* out, const float* values, uint32_t count) {
+    unsigned char buffer[4096];
+    while (count > 0) {
+        uint32_t n = count < sizeof(buffer) / 4 ? count : (uint32_t)(sizeof(buffer) / 4);
+        for (uint32_t i = 0; i < n; i++) {
+            uint32_t raw;
+            memcpy(&raw, &values[i], sizeof(raw));
+            put_le32(buffer + 4 * i, raw);
+        }
+        if (fwrite(buffer, 4, n, out) != n) {
+            return -1;
+        }
+        values += n;
+        count -= n;
+    }
+    return 0;
+}
+
+UCRA_Result ucra_f0_curve_save(const char* path, const UCRA_F0Curve* curve) {
+    if (!path || !curve || !curve->time_sec || !curve->f0_hz || curve->length == 0) {
+        return UCRA_ERR_INVALID_ARGUMENT;
+    }
+
+    /* written beside path and moved over it, so no reader sees a partly written file */
+    size_t temp_len = strlen(path) + 5;
+    char* temp_path = malloc(temp_len);
+    if (!temp_path) {
+        return UCRA_ERR_OUT_OF_MEMORY;
+    }
+    snprintf(temp_path, temp_len, "%s.tmp", path);
+
+    FILE* out = fopen(temp_path, "wb");
+    if (!out) {
+        free(temp_path);
+        return UCRA_ERR_FILE_NOT_FOUND;
+    }
+    unsigned char header[F0_FILE_HEADER_BYTES];
+    memcpy(header, F0_FILE_MAGIC, 4);
+    put_le32(header + 4, F0_FILE_VERSION);
+    put_le32(header + 8, curve->length);
+    put_le32(header + 12, 0);
+    int failed = fwrite(header, 1, sizeof(header), out) != sizeof(header) ||
+                 write_floats(out, curve->time_sec, curve->length) != 0 ||
+                 write_floats(out, curve->f0_hz, curve->length) != 0;
+    failed |= fclose(out) != 0;
+    if (failed) {
+        remove(temp_path);
+        free(temp_path);
+        return UCRA_ERR_INTERNAL;
+    }
+
+    UCRA_Result result = ucra_file_replace(temp_path, path);
+    free(temp_path);
+    return result;
+}
@@ -5,6 +5,11 @@
  */
 
 #include "ucra/ucra.h"
+#include "ucra_curve.h"
+#include "ucra_engine_loader.h"
+#include "ucra_kernels.h"
+#include "ucra_threads.h"
+#include "ucra_trace.h"
 
 #include <math.h>
 #include <stdlib.h>
@@ -14,13 +19,104 @@
 #define M_PI 3.14159265358979323846
 #endif
 
+/* Frames rendered per scheduling step; tiles are aligned to absolute frame positions */
+#define UCRA_RENDER_TILE_FRAMES 256
+
+/* Curve-driven oscillators re-anchor their phase at every chunk boundary. The chunk
+ * size is fixed, so chunks can be rendered on any thread and in any order while the
+ * output stays bit-identical to a single-threaded render. */
+#define UCRA_RENDER_CHUNK_TILES 64
+#define UCRA_RENDER_CHUNK_FRAMES ((uint64_t)UCRA_RENDER_TILE_FRAMES * UCRA_RENDER_CHUNK_TILES)
+
+/* Engine option selecting the number of render threads (0 = one per CPU) */
+#define UCRA_RENDER_THREADS_OPTION "render_threads"
+
+/* Sort key for the sweep-line scheduler */
+typedef struct UCRA_NoteKey {
+    double start_sec;
+    uint32_t index;           /* index into config->notes */
+} UCRA_NoteKey;
+
+/* Per-note oscillator state while a note is in the active set */
+typedef struct UCRA_Voice {
+    const UCRA_NoteSegment* note;
+    uint64_t start_frame;     /* first frame at which the note sounds */
+    uint64_t end_frame;       /* one past the last frame at which the note sounds */
+    double phase;             /* phase at the start of the current chunk, in [0, 2*pi) */
+    double local;             /* phase advanced since the chunk start, in [0, 2*pi) */
+    double base_hz;           /* MIDI pitch used when there is no F0 override */
+    double gain;              /* velocity-derived gain */
+    UCRA_CurveCursor f0;      /* read positions in the note's override curves */
+    UCRA_CurveCursor env;
+} UCRA_Voice;
+
+/* Scheduler scratch, grown on demand and reused across renders. The engine owns one
+ * for ucra_render() and one per pool worker for ucra_render_batch(). */
+typedef struct UCRA_RenderScratch {
+    UCRA_NoteKey* note_order; /* notes sorted by start time */
+    UCRA_Voice* voices;       /* active set, kept in start order */
+    uint32_t capacity;
+} UCRA_RenderScratch;
+
+/* Position of the serial sweep between two tiles */
+typedef struct UCRA_Sweep {
+    const UCRA_NoteSegment* notes;
+    uint32_t note_count;
+    const UCRA_NoteKey* order;
+    UCRA_Voice* voices;       /* active set */
+    uint32_t active_count;
+    uint32_t next_note;       /* next entry of order to admit */
+    UCRA_Voice pending;       /* order[next_note - 1], admitted once its tile is reached */
+    int has_pending;
+    uint64_t tile_start;      /* first frame of the next tile */
+} UCRA_Sweep;
+
+/* Carried state of ucra_render_block(): a sweep paused after the last tile it rendered */
+typedef struct UCRA_BlockRender {
+    UCRA_RenderScratch scratch;
+    UCRA_NoteSegment* notes;  /* copy of the notes the sweep runs over */
+    uint32_t notes_capacity;
+    UCRA_Sweep sweep;
+    int valid;
+    double sr;
+    UCRA_CurveInterp interp;
+    uint64_t frames;          /* length of the matching ucra_render() output */
+    uint64_t next_frame;      /* start frame that continues the previous block */
+    float mix[UCRA_RENDER_TILE_FRAMES]; /* last rendered tile, clipped */
+    uint64_t mix_start;
+    uint32_t mix_frames;
+} UCRA_BlockRender;
+
 typedef struct UCRA_Engine_ {
+    uint32_t kind; /* UCRA_ENGINE_KIND_BUILTIN; see ucra_engine_loader.h */
     double sample_rate;
     /* simple state to own last render buffers */
     float* last_pcm;
     size_t last_pcm_size; /* number of float samples in last_pcm */
     UCRA_KeyValue* last_metadata;
     uint32_t last_metadata_count;
+
+    UCRA_RenderScratch scratch;
+
+    /* worker pool for chunked renders and batches; started on first use */
+    uint32_t pool_threads;    /* 0 = one per CPU */
+    int chunked_render;       /* split single renders across the pool */
+    UCRA_ThreadPool* pool;
+    UCRA_Voice* chunk_voices; /* per-worker active sets, chunk_capacity each */
+    uint32_t chunk_capacity;
+    size_t* anchor_base;      /* per sorted note: first slot in anchors, or SIZE_MAX */
+    double* anchors;          /* chunk-start phases of F0-curve voices */
+    size_t anchor_capacity;
+
+    /* ucra_render_batch(): per-worker scratch and one arena for all job outputs */
+    UCRA_RenderScratch* batch_scratch;
+    uint32_t batch_scratch_count;
+    float* batch_pcm;
+    size_t batch_pcm_capacity;
+    uint64_t* batch_offsets;
+    uint32_t batch_offsets_capacity;
+
+    UCRA_BlockRender block;
 } UCRA_Engine_;
 
 static double midi_to_hz(int16_t midi_note) {
@@ -28,49 +124,199 @@ static double midi_to_hz(int16_t midi_note) {
     return 440.0 * pow(2.0, ((double)midi_note - 69.0) / 12.0);
 }
 
-/* sample a step-wise curve by picking the last point <= t (seconds). */
-static double sample_f0_curve(const UCRA_F0Curve* c, double t, double fallback_hz) {
-    if (!c || c->length == 0 || !c->time_sec || !c->f0_hz) return fallback_hz;
-    uint32_t idx = 0;
-    for (uint32_t i = 0; i + 1 < c->length; ++i) {
-        if ((double)c->time_sec[i] <= t) idx = i; else break;
+/* order notes by onset; ties keep the caller's order so output is deterministic */
+static int compare_note_keys(const void* a, const void* b) {
+    const UCRA_NoteKey* ka = (const UCRA_NoteKey*)a;
+    const UCRA_NoteKey* kb = (const UCRA_NoteKey*)b;
+    if (ka->start_sec < kb->start_sec) return -1;
+    if (ka->start_sec > kb->start_sec) return 1;
+    return (ka->index < kb->index) ? -1 : (ka->index > kb->index);
+}
+
+/* first frame n with n / sr >= t */
+static uint64_t first_frame_at_or_after(double t, double sr) {
+    if (t <= 0.0) return 0;
+    uint64_t n = (uint64_t)ceil(t * sr);
+    while (n > 0 && (double)(n - 1) / sr >= t) --n;
+    while ((double)n / sr < t) ++n;
+    return n;
+}
+
+/* grow the scheduler scratch so it can hold note_count notes */
+static UCRA_Result ensure_scheduler_scratch(UCRA_RenderScratch* scratch, uint32_t note_count) {
+    if (note_count <= scratch->capacity) return UCRA_SUCCESS;
+    UCRA_NoteKey* order = (UCRA_NoteKey*)realloc(scratch->note_order, note_count * sizeof(UCRA_NoteKey));
+    if (!order) return UCRA_ERR_OUT_OF_MEMORY;
+    scratch->note_order = order;
+    UCRA_Voice* voices = (UCRA_Voice*)realloc(scratch->voices, note_count * sizeof(UCRA_Voice));
+    if (!voices) return UCRA_ERR_OUT_OF_MEMORY;
+    scratch->voices = voices;
+    scratch->capacity = note_count;
+    return UCRA_SUCCESS;
+}
+
+static void free_scheduler_scratch(UCRA_RenderScratch* scratch) {
+    free(scratch->note_order);
+    free(scratch->voices);
+}
+
+/* set up a voice for a note entering the active set */
+static void voice_start(UCRA_Voice* v, const UCRA_NoteSegment* note, double sr) {
+    double end = note->start_sec + note->duration_sec;
+    v->note = note;
+    v->start_frame = first_frame_at_or_after(note->start_sec, sr);
+    /* the note sounds while n / sr <= end, so step past a frame landing exactly on end */
+    v->end_frame = first_frame_at_or_after(end, sr);
+    if (end >= 0.0 && (double)v->end_frame / sr <= end) v->end_frame++;
+    v->phase = 0.0;
+    v->local = 0.0;
+    v->base_hz = midi_to_hz(note->midi_note);
+    v->gain = 0.2 * ((double)note->velocity / 127.0); /* conservative gain to avoid clipping */
+    ucra_curve_cursor_f0(&v->f0, note->f0_override);
+    ucra_curve_cursor_env(&v->env, note->env_override);
+}
+
+/* overlap of a voice with a tile; returns 0 if the voice is silent there */
+static int voice_tile_span(const UCRA_Voice* voice, uint64_t tile_start, uint32_t tile_frames,
+                           uint64_t* out_first, uint32_t* out_count) {
+    uint64_t tile_end = tile_start + tile_frames;
+    uint64_t first = voice->start_frame > tile_start ? voice->start_frame : tile_start;
+    uint64_t last = voice->end_frame < tile_end ? voice->end_frame : tile_end;
+    if (first >= last) return 0;
+    *out_first = first;
+    *out_count = (uint32_t)(last - first);
+    return 1;
+}
+
+/* Advance an F0-curve voice over count frames from first. When phase/amp are given
+ * they receive the per-sample oscillator phase and amplitude. The accumulation is
+ * the same with or without outputs, so a dry run yields the exact chunk-end phase. */
+static void voice_curve_span(UCRA_Voice* voice, UCRA_CurveInterp interp, uint64_t first,
+                             uint32_t count, double sr, float* phase, float* amp) {
+    const double two_pi = 2.0 * M_PI;
+    double f0[UCRA_RENDER_TILE_FRAMES];
+    double env[UCRA_RENDER_TILE_FRAMES];
+    int has_env = phase && ucra_curve_valid(&voice->env);
+    double rel_t0 = (double)first / sr - voice->note->start_sec;
+    ucra_curve_sample_block(&voice->f0, interp, rel_t0, 1.0 / sr, count, f0);
+    if (has_env) ucra_curve_sample_block(&voice->env, interp, rel_t0, 1.0 / sr, count, env);
+
+    for (uint32_t i = 0; i < count; ++i) {
+        if (phase) {
+            phase[i] = (float)(voice->phase + voice->local);
+            amp[i] = f0[i] > 0.0 ? (float)(voice->gain * (has_env ? env[i] : 1.0)) : 0.0f;
+        }
+        if (f0[i] <= 0.0) continue; /* unvoiced: hold the phase */
+        voice->local += two_pi * f0[i] / sr;
+        if (voice->local >= two_pi) voice->local = fmod(voice->local, two_pi);
     }
-    return (double)c->f0_hz[idx];
 }
 
-/* sample an envelope curve similarly (step-wise hold). */
-static double sample_env_curve(const UCRA_EnvCurve* c, double t, double fallback) {
-    if (!c || c->length == 0 || !c->time_sec || !c->value) return fallback;
-    uint32_t idx = 0;
-    for (uint32_t i = 0; i + 1 < c->length; ++i) {
-        if ((double)c->time_sec[i] <= t) idx = i; else break;
+/* fold the phase advanced in the finished chunk into the anchor */
+static void voice_rebase(UCRA_Voice* voice) {
+    voice->phase = fmod(voice->phase + voice->local, 2.0 * M_PI);
+    voice->local = 0.0;
+}
+
+/* mix one voice into a tile of the output, advancing its oscillator */
+static void render_voice_tile(UCRA_Voice* voice, const UCRA_Kernels* k, UCRA_CurveInterp interp,
+                              float* mix, uint64_t tile_start, uint32_t tile_frames, double sr) {
+    uint64_t first;
+    uint32_t count;
+    if (!voice_tile_span(voice, tile_start, tile_frames, &first, &count)) return;
+
+    uint32_t offset = (uint32_t)(first - tile_start);
+    const double two_pi = 2.0 * M_PI;
+    float phase[UCRA_RENDER_TILE_FRAMES];
+    float amp[UCRA_RENDER_TILE_FRAMES];
+
+    if (ucra_curve_valid(&voice->f0)) {
+        /* curve-driven pitch: accumulate per sample, then synthesize in one pass */
+        voice_curve_span(voice, interp, first, count, sr, phase, amp);
+        k->sine_mac(mix + offset, phase, amp, count);
+        return;
+    }
+
+    /* fixed pitch: the phase follows from the frame position alone */
+    if (voice->base_hz <= 0.0) return;
+    double inc = two_pi * voice->base_hz / sr;
+    double start_phase = fmod((double)(first - voice->start_frame) * inc, two_pi);
+
+    if (!ucra_curve_valid(&voice->env)) {
+        /* fixed level too: one vectorized ramp over the whole span */
+        k->sine_ramp_mac(mix + offset, count, start_phase, inc, (float)voice->gain);
+        return;
     }
-    return (double)c->value[idx];
+
+    double env[UCRA_RENDER_TILE_FRAMES];
+    double rel_t0 = (double)first / sr - voice->note->start_sec;
+    ucra_curve_sample_block(&voice->env, interp, rel_t0, 1.0 / sr, count, env);
+    double p = start_phase;
+    for (uint32_t i = 0; i < count; ++i) {
+        phase[i] = (float)p;
+        amp[i] = (float)(voice->gain * env[i]);
+        p += inc;
+        if (p >= two_pi) p -= two_pi;
+    }
+    k->sine_mac(mix + offset, phase, amp, count);
 }
 
 UCRA_Result ucra_engine_create(UCRA_Handle* outEngine,
                                const UCRA_KeyValue* options,
                                uint32_t option_count) {
-    (void)options; (void)option_count;
     if (!outEngine) return UCRA_ERR_INVALID_ARGUMENT;
     UCRA_Engine_* eng = (UCRA_Engine_*)calloc(1, sizeof(UCRA_Engine_));
     if (!eng) return UCRA_ERR_OUT_OF_MEMORY;
     eng->sample_rate = 44100.0; /* default */
+    /* single renders stay on the calling thread unless render_threads asks otherwise;
+     * batches use one worker per CPU by default */
+    for (uint32_t i = 0; options && i < option_count; ++i) {
+        if (options[i].key && options[i].value &&
+            strcmp(options[i].key, UCRA_RENDER_THREADS_OPTION) == 0) {
+            long n = strtol(options[i].value, NULL, 10);
+            eng->pool_threads = n > 0 ? (uint32_t)n : (n == 0 ? ucra_cpu_count() : 1);
+            eng->chunked_render = eng->pool_threads > 1;
+        }
+    }
     *outEngine = (UCRA_Handle)eng;
     return UCRA_SUCCESS;
 }
 
 void ucra_engine_destroy(UCRA_Handle engine) {
+    const UCRA_LoadedEngine* loaded = ucra_loaded_engine(engine);
+    if (loaded) {
+        ucra_loaded_engine_destroy(loaded);
+        return;
+    }
     UCRA_Engine_* eng = (UCRA_Engine_*)engine;
     if (!eng) return;
     if (eng->last_pcm) free(eng->last_pcm);
     if (eng->last_metadata) free(eng->last_metadata);
+    free_scheduler_scratch(&eng->scratch);
+    ucra_pool_destroy(eng->pool);
+    free(eng->chunk_voices);
+    free(eng->anchor_base);
+    free(eng->anchors);
+    for (uint32_t i = 0; i < eng->batch_scratch_count; ++i) {
+        free_scheduler_scratch(&eng->batch_scratch[i]);
+    }
+    free(eng->batch_scratch);
+    free(eng->batch_pcm);
+    free(eng->batch_offsets);
+    free_scheduler_scratch(&eng->block.scratch);
+    free(eng->block.notes);
     free(eng);
 }
 
 UCRA_Result ucra_engine_getinfo(UCRA_Handle engine,
                                 char* outBuffer,
                                 size_t buffer_size) {
+    const UCRA_LoadedEngine* loaded = ucra_loaded_engine(engine);
+    if (loaded) {
+        return UCRA_ENGINE_TABLE_HAS(loaded->table, engine_getinfo)
+                   ? loaded->table->engine_getinfo(loaded->inner, outBuffer, buffer_size)
+                   : UCRA_ERR_NOT_SUPPORTED;
+    }
     UCRA_Engine_* eng = (UCRA_Engine_*)engine;
     if (!eng || !outBuffer || buffer_size == 0) return UCRA_ERR_INVALID_ARGUMENT;
     const char* info = "UCRA Reference Engine (no WORLD) v1.0";
@@ -80,83 +326,699 @@ UCRA_Result ucra_engine_getinfo(UCRA_Handle engine,
     return UCRA_SUCCESS;
 }
 
+UCRA_Result ucra_engine_get_capabilities(UCRA_Handle engine, uint32_t* out_caps) {
+    if (!engine || !out_caps) return UCRA_ERR_INVALID_ARGUMENT;
+    const UCRA_LoadedEngine* loaded = ucra_loaded_engine(engine);
+    if (loaded) {
+        *out_caps = 0;
+        return UCRA_ENGINE_TABLE_HAS(loaded->table, engine_get_capabilities)
+                   ? loaded->table->engine_get_capabilities(loaded->inner, out_caps)
+                   : UCRA_SUCCESS;
+    }
+    /* every note is synthesized from its own start, and blocks run the same code as renders */
+    *out_caps = UCRA_ENGINE_CAP_NOTE_LOCAL;
+    return UCRA_SUCCESS;
+}
+
+/* output frame count for a config: the end of the last note, rounded to frames */
+static uint64_t compute_render_frames(const UCRA_RenderConfig* config, double sr) {
+    double total_dur = 0.0;
+    for (uint32_t i = 0; i < config->note_count; ++i) {
+        double end = config->notes[i].start_sec + config->notes[i].duration_sec;
+        if (end > total_dur) total_dur = end;
+    }
+    if (total_dur <= 0.0) return 0;
+
+    uint64_t frames = (uint64_t)(total_dur * sr + 0.5);
+    return frames == 0 ? 1 : frames;
+}
+
+/* sample rate a render of config will use on this engine */
+static double resolve_sample_rate(const UCRA_Engine_* eng, const UCRA_RenderConfig* config) {
+    return config->sample_rate > 0 ? (double)config->sample_rate : eng->sample_rate;
+}
+
+/* float samples an output of frames x channels takes in the layout selected by flags */
+static uint64_t layout_samples(uint32_t flags, uint64_t frames, uint32_t channels) {
+    return UCRA_RENDER_LAYOUT(flags) == UCRA_RENDER_LAYOUT_MONO ? frames : frames * channels;
+}
+
+static int layout_valid(uint32_t flags) {
+    return UCRA_RENDER_LAYOUT(flags) <= UCRA_RENDER_LAYOUT_MONO;
+}
+
+/* write a finished mono tile into dst, which holds frames x channels in layout */
+static void store_tile(const UCRA_Kernels* k, uint32_t layout, float* dst, const float* mix,
+                       uint64_t tile_start, uint32_t tile_frames, uint64_t frames, uint32_t channels) {
+    switch (layout) {
+        case UCRA_RENDER_LAYOUT_PLANAR:
+            for (uint32_t ch = 0; ch < channels; ++ch) {
+                memcpy(dst + (size_t)ch * frames + tile_start, mix, tile_frames * sizeof(float));
+            }
+            break;
+        case UCRA_RENDER_LAYOUT_MONO:
+            /* consumers expand the single plane to channels themselves */
+            memcpy(dst + tile_start, mix, tile_frames * sizeof(float));
+            break;
+        default:
+            k->fan_out(dst + (size_t)tile_start * channels, mix, tile_frames, channels);
+            break;
+    }
+}
+
+static void fill_result(UCRA_RenderResult* outResult, const float* pcm, uint64_t frames,
+                        uint32_t channels, double sr) {
+    outResult->pcm = frames > 0 ? pcm : NULL;
+    outResult->frames = frames;
+    outResult->channels = channels;
+    outResult->sample_rate = (uint32_t)sr;
+    outResult->metadata = NULL;
+    outResult->metadata_count = 0;
+    outResult->status = UCRA_SUCCESS;
+}
+
+/* Shared state of a chunked render */
+typedef struct UCRA_ChunkRender {
+    const UCRA_Voice* voices;   /* every note's voice, in start order */
+    uint32_t note_count;
+    const size_t* anchor_base;
+    double* anchors;
+    UCRA_Voice* scratch;        /* per-worker active sets */
+    uint32_t scratch_stride;
+    const UCRA_Kernels* k;
+    UCRA_CurveInterp interp;
+    double sr;
+    uint64_t frames;
+    uint32_t channels;
+    uint32_t layout;
+    float* dst;
+} UCRA_ChunkRender;
+
+/* number of voices (in start order) whose onset falls before frame */
+static uint32_t voices_starting_before(const UCRA_Voice* voices, uint32_t count, uint64_t frame) {
+    uint32_t lo = 0, hi = count;
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if (voices[mid].start_frame < frame) lo = mid + 1; else hi = mid;
+    }
+    return lo;
+}
+
+/* pass 1: the phase each F0-curve voice advances within a chunk */
+static void chunk_measure_job(void* ctx, uint32_t chunk, uint32_t worker) {
+    (void)worker;
+    UCRA_ChunkRender* job = (UCRA_ChunkRender*)ctx;
+    uint64_t c0 = (uint64_t)chunk * UCRA_RENDER_CHUNK_FRAMES;
+    uint64_t c1 = c0 + UCRA_RENDER_CHUNK_FRAMES < job->frames ? c0 + UCRA_RENDER_CHUNK_FRAMES : job->frames;
+    uint32_t count = voices_starting_before(job->voices, job->note_count, c1);
+
+    for (uint32_t i = 0; i < count; ++i) {
+        if (job->anchor_base[i] == SIZE_MAX || job->voices[i].end_frame <= c0) continue;
+        UCRA_Voice voice = job->voices[i];
+        for (uint64_t tile_start = c0; tile_start < c1; tile_start += UCRA_RENDER_TILE_FRAMES) {
+            uint32_t tile_frames = (uint32_t)(c1 - tile_start < UCRA_RENDER_TILE_FRAMES
+                                              ? c1 - tile_start : UCRA_RENDER_TILE_FRAMES);
+            uint64_t first;
+            uint32_t span;
+            if (voice_tile_span(&voice, tile_start, tile_frames, &first, &span)) {
+                voice_curve_span(&voice, job->interp, first, span, job->sr, NULL, NULL);
+            }
+        }
+        uint64_t first_chunk = voice.start_frame / UCRA_RENDER_CHUNK_FRAMES;
+        job->anchors[job->anchor_base[i] + (chunk - first_chunk)] = voice.local;
+    }
+}
+
+/* pass 2: synthesize one chunk from the anchored phases */
+static void chunk_render_job(void* ctx, uint32_t chunk, uint32_t worker) {
+    UCRA_TRACE_BEGIN(chunk);
+    UCRA_ChunkRender* job = (UCRA_ChunkRender*)ctx;
+    uint64_t c0 = (uint64_t)chunk * UCRA_RENDER_CHUNK_FRAMES;
+    uint64_t c1 = c0 + UCRA_RENDER_CHUNK_FRAMES < job->frames ? c0 + UCRA_RENDER_CHUNK_FRAMES : job->frames;
+    uint32_t count = voices_starting_before(job->voices, job->note_count, c1);
+
+    UCRA_Voice* active = job->scratch + (size_t)worker * job->scratch_stride;
+    uint32_t active_count = 0;
+    for (uint32_t i = 0; i < count; ++i) {
+        if (job->voices[i].end_frame <= c0) continue;
+        UCRA_Voice* v = &active[active_count++];
+        *v = job->voices[i];
+        if (job->anchor_base[i] != SIZE_MAX) {
+            uint64_t first_chunk = v->start_frame / UCRA_RENDER_CHUNK_FRAMES;
+            v->phase = job->anchors[job->anchor_base[i] + (chunk - first_chunk)];
+        }
+    }
+
+    float mix[UCRA_RENDER_TILE_FRAMES];
+    for (uint64_t tile_start = c0; tile_start < c1; tile_start += UCRA_RENDER_TILE_FRAMES) {
+        uint32_t tile_frames = (uint32_t)(c1 - tile_start < UCRA_RENDER_TILE_FRAMES
+                                          ? c1 - tile_start : UCRA_RENDER_TILE_FRAMES);
+        memset(mix, 0, tile_frames * sizeof(float));
+        uint32_t kept = 0;
+        for (uint32_t v = 0; v < active_count; ++v) {
+            if (active[v].end_frame <= tile_start) continue; /* retire */
+            if (kept != v) active[kept] = active[v];
+            render_voice_tile(&active[kept++], job->k, job->interp, mix, tile_start, tile_frames, job->sr);
+        }
+        active_count = kept;
+
+        job->k->clip(mix, tile_frames, -1.0f, 1.0f);
+        store_tile(job->k, job->layout, job->dst, mix, tile_start, tile_frames, job->frames, job->channels);
+    }
+    UCRA_TRACE_END(chunk, "engine.chunk");
+}
+
+static UCRA_Result ensure_pool(UCRA_Engine_* eng) {
+    if (eng->pool) return UCRA_SUCCESS;
+    return ucra_pool_create(eng->pool_threads, &eng->pool);
+}
+
+/* start the pool and size the per-worker scratch for a chunked render */
+static UCRA_Result ensure_parallel_scratch(UCRA_Engine_* eng) {
+    UCRA_Result result = ensure_pool(eng);
+    if (result != UCRA_SUCCESS) return result;
+    /* follows the scheduler scratch, which has already been grown for this render */
+    uint32_t capacity = eng->scratch.capacity;
+    if (eng->chunk_capacity == capacity) return UCRA_SUCCESS;
+
+    size_t workers = ucra_pool_size(eng->pool);
+    UCRA_Voice* voices = (UCRA_Voice*)realloc(eng->chunk_voices, workers * capacity * sizeof(UCRA_Voice));
+    if (!voices) return UCRA_ERR_OUT_OF_MEMORY;
+    eng->chunk_voices = voices;
+    size_t* base = (size_t*)realloc(eng->anchor_base, capacity * sizeof(size_t));
+    if (!base) return UCRA_ERR_OUT_OF_MEMORY;
+    eng->anchor_base = base;
+    eng->chunk_capacity = capacity;
+    return UCRA_SUCCESS;
+}
+
+/* render frames across the worker pool, chunk by chunk */
+static UCRA_Result render_frames_parallel(UCRA_Engine_* eng, const UCRA_RenderConfig* config,
+                                          double sr, uint64_t frames, uint32_t channels, float* dst,
+                                          const UCRA_Kernels* k, UCRA_CurveInterp interp) {
+    UCRA_Result result = ensure_parallel_scratch(eng);
+    if (result != UCRA_SUCCESS) return result;
+
+    uint32_t chunk_count = (uint32_t)((frames + UCRA_RENDER_CHUNK_FRAMES - 1) / UCRA_RENDER_CHUNK_FRAMES);
+    UCRA_Voice* voices = eng->scratch.voices;
+
+    /* every note's voice up front, plus one anchor slot per chunk an F0-curve note spans */
+    size_t anchor_count = 0;
+    for (uint32_t i = 0; i < config->note_count; ++i) {
+        voice_start(&voices[i], &config->notes[eng->scratch.note_order[i].index], sr);
+        eng->anchor_base[i] = SIZE_MAX;
+        const UCRA_Voice* v = &voices[i];
+        if (!ucra_curve_valid(&v->f0) || v->start_frame >= frames || v->end_frame <= v->start_frame) continue;
+        uint64_t first_chunk = v->start_frame / UCRA_RENDER_CHUNK_FRAMES;
+        uint64_t last_chunk = (v->end_frame - 1) / UCRA_RENDER_CHUNK_FRAMES;
+        if (last_chunk >= chunk_count) last_chunk = chunk_count - 1;
+        eng->anchor_base[i] = anchor_count;
+        anchor_count += (size_t)(last_chunk - first_chunk + 1);
+    }
+    if (anchor_count > eng->anchor_capacity) {
+        double* anchors = (double*)realloc(eng->anchors, anchor_count * sizeof(double));
+        if (!anchors) return UCRA_ERR_OUT_OF_MEMORY;
+        eng->anchors = anchors;
+        eng->anchor_capacity = anchor_count;
+    }
+
+    UCRA_ChunkRender job;
+    job.voices = voices;
+    job.note_count = config->note_count;
+    job.anchor_base = eng->anchor_base;
+    job.anchors = eng->anchors;
+    job.scratch = eng->chunk_voices;
+    job.scratch_stride = eng->chunk_capacity;
+    job.k = k;
+    job.interp = interp;
+    job.sr = sr;
+    job.frames = frames;
+    job.channels = channels;
+    job.layout = UCRA_RENDER_LAYOUT(config->flags);
+    job.dst = dst;
+
+    if (anchor_count > 0) {
+        UCRA_TRACE_BEGIN(anchors);
+        ucra_pool_run(eng->pool, chunk_count, chunk_measure_job, &job);
+
+        /* prefix over each note's chunks turns per-chunk advances into chunk-start phases,
+         * folding them exactly as voice_rebase() does in the serial sweep */
+        for (uint32_t i = 0; i < config->note_count; ++i) {
+            if (eng->anchor_base[i] == SIZE_MAX) continue;
+            const UCRA_Voice* v = &voices[i];
+            uint64_t first_chunk = v->start_frame / UCRA_RENDER_CHUNK_FRAMES;
+            uint64_t last_chunk = (v->end_frame - 1) / UCRA_RENDER_CHUNK_FRAMES;
+            if (last_chunk >= chunk_count) last_chunk = chunk_count - 1;
+            double phase = 0.0;
+            for (uint64_t c = 0; c <= last_chunk - first_chunk; ++c) {
+                double* slot = &eng->anchors[eng->anchor_base[i] + c];
+                double advanced = *slot;
+                *slot = phase;
+                phase = fmod(phase + advanced, 2.0 * M_PI);
+            }
+        }
+        UCRA_TRACE_END(anchors, "engine.f0_prepare");
+    }
+
+    UCRA_TRACE_BEGIN(synthesis);
+    ucra_pool_run(eng->pool, chunk_count, chunk_render_job, &job);
+    UCRA_TRACE_END(synthesis, "engine.synthesis");
+    return UCRA_SUCCESS;
+}
+
+/* sort the notes into scratch and place the sweep before the first tile */
+static void sweep_begin(UCRA_Sweep* sweep, UCRA_RenderScratch* scratch,
+                        const UCRA_NoteSegment* notes, uint32_t note_count) {
+    UCRA_NoteKey* order = scratch->note_order;
+    for (uint32_t i = 0; i < note_count; ++i) {
+        order[i].start_sec = notes[i].start_sec;
+        order[i].index = i;
+    }
+    qsort(order, note_count, sizeof(UCRA_NoteKey), compare_note_keys);
+
+    sweep->notes = notes;
+    sweep->note_count = note_count;
+    sweep->order = order;
+    sweep->voices = scratch->voices;
+    sweep->active_count = 0;
+    sweep->next_note = 0;
+    sweep->has_pending = 0;
+    sweep->tile_start = 0;
+}
+
+/* Run the sweep over its next tile of a frames-long render and return the tile's
+ * length. With mix, the tile is synthesized into it and clipped; without, only the
+ * oscillator state advances, exactly as synthesis would advance it. */
+static uint32_t sweep_tile(UCRA_Sweep* sweep, const UCRA_Kernels* k, UCRA_CurveInterp interp,
+                           double sr, uint64_t frames, float* mix) {
+    uint64_t tile_start = sweep->tile_start;
+    uint64_t remaining = frames - tile_start;
+    uint32_t tile_frames = remaining < UCRA_RENDER_TILE_FRAMES ? (uint32_t)remaining
+                                                               : UCRA_RENDER_TILE_FRAMES;
+    uint64_t tile_end = tile_start + tile_frames;
+    UCRA_Voice* voices = sweep->voices;
+
+    /* chunk boundary: re-anchor the oscillators, as the chunked renderer does */
+    if (tile_start % UCRA_RENDER_CHUNK_FRAMES == 0) {
+        for (uint32_t v = 0; v < sweep->active_count; ++v) voice_rebase(&voices[v]);
+    }
+
+    /* admit notes whose onset falls before the end of this tile */
+    for (;;) {
+        if (!sweep->has_pending) {
+            if (sweep->next_note >= sweep->note_count) break;
+            voice_start(&sweep->pending, &sweep->notes[sweep->order[sweep->next_note].index], sr);
+            sweep->next_note++;
+            sweep->has_pending = 1;
+        }
+        if (sweep->pending.start_frame >= tile_end) break;
+        voices[sweep->active_count++] = sweep->pending;
+        sweep->has_pending = 0;
+    }
+
+    if (mix) memset(mix, 0, tile_frames * sizeof(float));
+    uint32_t kept = 0;
+    for (uint32_t v = 0; v < sweep->active_count; ++v) {
+        if (voices[v].end_frame <= tile_start) continue; /* retire */
+        if (kept != v) voices[kept] = voices[v];
+        UCRA_Voice* voice = &voices[kept++];
+        if (mix) {
+            render_voice_tile(voice, k, interp, mix, tile_start, tile_frames, sr);
+        } else if (ucra_curve_valid(&voice->f0)) {
+            /* fixed-pitch voices carry no phase, so only curve voices need the dry run */
+            uint64_t first;
+            uint32_t count;
+            if (voice_tile_span(voice, tile_start, tile_frames, &first, &count)) {
+                voice_curve_span(voice, interp, first, count, sr, NULL, NULL);
+            }
+        }
+    }
+    sweep->active_count = kept;
+
+    /* simple soft clip */
+    if (mix) k->clip(mix, tile_frames, -1.0f, 1.0f);
+    sweep->tile_start = tile_end;
+    return tile_frames;
+}
+
+/* synthesize frames of config into dst, laid out as config->flags asks. Pass eng to allow
+ * splitting the render across the engine's pool; scratch must then be eng->scratch. */
+static UCRA_Result render_frames(UCRA_Engine_* eng, UCRA_RenderScratch* scratch,
+                                 const UCRA_RenderConfig* config, double sr,
+                                 uint64_t frames, uint32_t channels, float* dst) {
+    /* sweep-line additive synthesis: notes enter the active set in start order and
+     * leave it once their last frame has passed, so each frame only touches the notes
+     * that are sounding. Oscillators advance a phase accumulator, which keeps the
+     * waveform continuous when the F0 curve changes. */
+    UCRA_Result scratch_result = ensure_scheduler_scratch(scratch, config->note_count);
+    if (scratch_result != UCRA_SUCCESS) return scratch_result;
+
+    UCRA_Sweep sweep;
+    sweep_begin(&sweep, scratch, config->notes, config->note_count);
+
+    const UCRA_Kernels* k = ucra_kernels();
+    UCRA_CurveInterp interp = ucra_curve_interp_from_config(config);
+    uint32_t layout = UCRA_RENDER_LAYOUT(config->flags);
+
+    if (eng && eng->chunked_render && frames > UCRA_RENDER_CHUNK_FRAMES) {
+        return render_frames_parallel(eng, config, sr, frames, channels, dst, k, interp);
+    }
+
+    UCRA_TRACE_BEGIN(synthesis);
+    float mix[UCRA_RENDER_TILE_FRAMES];
+    while (sweep.tile_start < frames) {
+        uint64_t tile_start = sweep.tile_start;
+        uint32_t tile_frames = sweep_tile(&sweep, k, interp, sr, frames, mix);
+        /* hand the mono mix to the output layout */
+        store_tile(k, layout, dst, mix, tile_start, tile_frames, frames, channels);
+    }
+    UCRA_TRACE_END(synthesis, "engine.synthesis");
+
+    return UCRA_SUCCESS;
+}
+
 UCRA_Result ucra_render(UCRA_Handle engine,
                         const UCRA_RenderConfig* config,
                         UCRA_RenderResult* outResult) {
+    const UCRA_LoadedEngine* loaded = ucra_loaded_engine(engine);
+    if (loaded) return loaded->table->render(loaded->inner, config, outResult);
     UCRA_Engine_* eng = (UCRA_Engine_*)engine;
     if (!eng || !config || !outResult) return UCRA_ERR_INVALID_ARGUMENT;
+    if (!layout_valid(config->flags)) {
+        outResult->status = UCRA_ERR_INVALID_ARGUMENT;
+        return UCRA_ERR_INVALID_ARGUMENT;
+    }
 
     /* Adopt sample rate from config if provided */
-    if (config->sample_rate > 0) eng->sample_rate = (double)config->sample_rate;
+    eng->sample_rate = resolve_sample_rate(eng, config);
     uint32_t channels = config->channels > 0 ? config->channels : 1;
+    uint64_t frames = compute_render_frames(config, eng->sample_rate);
+    size_t total_samples = (size_t)layout_samples(config->flags, frames, channels);
 
-    /* compute total duration from notes */
-    double total_dur = 0.0;
-    for (uint32_t i = 0; i < config->note_count; ++i) {
-        double end = config->notes[i].start_sec + config->notes[i].duration_sec;
-        if (end > total_dur) total_dur = end;
+    /* engine-owned buffer only grows, so repeated renders reuse it */
+    if (total_samples > eng->last_pcm_size) {
+        float* pcm = (float*)realloc(eng->last_pcm, total_samples * sizeof(float));
+        if (!pcm) {
+            outResult->status = UCRA_ERR_OUT_OF_MEMORY;
+            return UCRA_ERR_OUT_OF_MEMORY;
+        }
+        eng->last_pcm = pcm;
+        eng->last_pcm_size = total_samples;
+    }
+
+    UCRA_TRACE_BEGIN(render);
+    UCRA_Result result = render_frames(eng, &eng->scratch, config, eng->sample_rate,
+                                       frames, channels, eng->last_pcm);
+    UCRA_TRACE_END(render, "engine.render");
+    if (result != UCRA_SUCCESS) {
+        outResult->status = result;
+        return result;
+    }
+
+    fill_result(outResult, eng->last_pcm, frames, channels, eng->sample_rate);
+    return UCRA_SUCCESS;
+}
+
+UCRA_Result ucra_render_query_size(UCRA_Handle engine,
+                                   const UCRA_RenderConfig* config,
+                                   uint64_t* out_frames,
+                                   uint64_t* out_samples) {
+    const UCRA_LoadedEngine* loaded = ucra_loaded_engine(engine);
+    if (loaded) {
+        return UCRA_ENGINE_TABLE_HAS(loaded->table, render_query_size)
+                   ? loaded->table->render_query_size(loaded->inner, config, out_frames, out_samples)
+                   : UCRA_ERR_NOT_SUPPORTED;
     }
+    UCRA_Engine_* eng = (UCRA_Engine_*)engine;
+    if (!eng || !config || !layout_valid(config->flags)) return UCRA_ERR_INVALID_ARGUMENT;
+
+    uint32_t channels = config->channels > 0 ? config->channels : 1;
+    uint64_t frames = compute_render_frames(config, resolve_sample_rate(eng, config));
+    if (out_frames) *out_frames = frames;
+    if (out_samples) *out_samples = layout_samples(config->flags, frames, channels);
+    return UCRA_SUCCESS;
+}
+
+UCRA_Result ucra_render_into(UCRA_Handle engine,
+                             const UCRA_RenderConfig* config,
+                             float* out_pcm,
+                             uint64_t capacity_samples,
+                             UCRA_RenderResult* outResult) {
+    const UCRA_LoadedEngine* loaded = ucra_loaded_engine(engine);
+    if (loaded) {
+        return UCRA_ENGINE_TABLE_HAS(loaded->table, render_into)
+                   ? loaded->table->render_into(loaded->inner, config, out_pcm, capacity_samples, outResult)
+                   : UCRA_ERR_NOT_SUPPORTED;
+    }
+    UCRA_Engine_* eng = (UCRA_Engine_*)engine;
+    if (!eng || !config || !outResult) return UCRA_ERR_INVALID_ARGUMENT;
+    if (!layout_valid(config->flags)) {
+        outResult->status = UCRA_ERR_INVALID_ARGUMENT;
+        return UCRA_ERR_INVALID_ARGUMENT;
+    }
+
+    double sr = resolve_sample_rate(eng, config);
+    uint32_t channels = config->channels > 0 ? config->channels : 1;
+    uint64_t frames = compute_render_frames(config, sr);
 
-    if (total_dur <= 0.0) {
+    if (frames > 0 && (!out_pcm || capacity_samples < layout_samples(config->flags, frames, channels))) {
+        /* report the required size so the caller can retry with a larger buffer */
         outResult->pcm = NULL;
-        outResult->frames = 0;
+        outResult->frames = frames;
         outResult->channels = channels;
-        outResult->sample_rate = (uint32_t)eng->sample_rate;
+        outResult->sample_rate = (uint32_t)sr;
         outResult->metadata = NULL;
         outResult->metadata_count = 0;
-        outResult->status = UCRA_SUCCESS;
-        return UCRA_SUCCESS;
+        outResult->status = UCRA_ERR_INVALID_ARGUMENT;
+        return UCRA_ERR_INVALID_ARGUMENT;
     }
 
-    uint64_t frames = (uint64_t)(total_dur * eng->sample_rate + 0.5);
-    if (frames == 0) frames = 1;
-    size_t total_samples = (size_t)frames * (size_t)channels;
+    eng->sample_rate = sr;
+    UCRA_TRACE_BEGIN(render);
+    UCRA_Result result = render_frames(eng, &eng->scratch, config, sr, frames, channels, out_pcm);
+    UCRA_TRACE_END(render, "engine.render");
+    if (result != UCRA_SUCCESS) {
+        outResult->status = result;
+        return result;
+    }
+
+    fill_result(outResult, out_pcm, frames, channels, sr);
+    return UCRA_SUCCESS;
+}
 
-    /* (re)allocate engine-owned buffer */
-    if (eng->last_pcm) { free(eng->last_pcm); eng->last_pcm = NULL; }
-    eng->last_pcm = (float*)malloc(total_samples * sizeof(float));
-    if (!eng->last_pcm) {
-        outResult->status = UCRA_ERR_OUT_OF_MEMORY;
-        return UCRA_ERR_OUT_OF_MEMORY;
+/* whether two note lists render identically (the lyric does not affect this engine) */
+static int notes_equal(const UCRA_NoteSegment* a, const UCRA_NoteSegment* b, uint32_t count) {
+    for (uint32_t i = 0; i < count; ++i) {
+        if (a[i].start_sec != b[i].start_sec || a[i].duration_sec != b[i].duration_sec ||
+            a[i].midi_note != b[i].midi_note || a[i].velocity != b[i].velocity ||
+            a[i].f0_override != b[i].f0_override || a[i].env_override != b[i].env_override) {
+            return 0;
+        }
     }
-    eng->last_pcm_size = total_samples;
+    return 1;
+}
 
-    /* zero initialize */
-    for (size_t i = 0; i < total_samples; ++i) eng->last_pcm[i] = 0.0f;
+/* restart the block sweep for config and run it dry up to the tile holding start_frame */
+static UCRA_Result block_seek(UCRA_BlockRender* block, const UCRA_RenderConfig* config,
+                              double sr, UCRA_CurveInterp interp, uint64_t start_frame) {
+    block->valid = 0;
+    UCRA_Result result = ensure_scheduler_scratch(&block->scratch, config->note_count);
+    if (result != UCRA_SUCCESS) return result;
+    if (config->note_count > block->notes_capacity) {
+        UCRA_NoteSegment* notes = (UCRA_NoteSegment*)realloc(block->notes,
+                                                             config->note_count * sizeof(UCRA_NoteSegment));
+        if (!notes) return UCRA_ERR_OUT_OF_MEMORY;
+        block->notes = notes;
+        block->notes_capacity = config->note_count;
+    }
+    if (config->note_count > 0) {
+        memcpy(block->notes, config->notes, config->note_count * sizeof(UCRA_NoteSegment));
+    }
 
-    /* naive additive synthesis: sine at per-note F0, scaled by velocity and optional env */
-    for (uint64_t n = 0; n < frames; ++n) {
-        double t = (double)n / eng->sample_rate;
-        double mix = 0.0;
-        for (uint32_t i = 0; i < config->note_count; ++i) {
-            const UCRA_NoteSegment* note = &config->notes[i];
-            double start = note->start_sec;
-            double end = note->start_sec + note->duration_sec;
-            if (t < start || t > end) continue;
-
-            double rel_t = t - start;
-            double f0 = note->f0_override ? sample_f0_curve(note->f0_override, rel_t, midi_to_hz(note->midi_note))
-                                          : midi_to_hz(note->midi_note);
-            if (f0 <= 0.0) continue;
-            double env = note->env_override ? sample_env_curve(note->env_override, rel_t, 1.0) : 1.0;
-            double vel = (double)(note->velocity) / 127.0; /* 0..1 */
-            double amp = 0.2 * vel * env; /* conservative gain to avoid clipping */
-            mix += amp * sin(2.0 * M_PI * f0 * t);
+    block->sr = sr;
+    block->interp = interp;
+    block->frames = compute_render_frames(config, sr);
+    block->mix_start = 0;
+    block->mix_frames = 0;
+    sweep_begin(&block->sweep, &block->scratch, block->notes, config->note_count);
+
+    const UCRA_Kernels* k = ucra_kernels();
+    uint64_t target = start_frame - start_frame % UCRA_RENDER_TILE_FRAMES;
+    while (block->sweep.tile_start < target && block->sweep.tile_start < block->frames) {
+        sweep_tile(&block->sweep, k, interp, sr, block->frames, NULL);
+    }
+    block->valid = 1;
+    return UCRA_SUCCESS;
+}
+
+UCRA_Result ucra_render_block(UCRA_Handle engine,
+                              const UCRA_RenderConfig* config,
+                              uint64_t start_frame,
+                              uint32_t frame_count,
+                              float* out_pcm) {
+    const UCRA_LoadedEngine* loaded = ucra_loaded_engine(engine);
+    if (loaded) {
+        return UCRA_ENGINE_TABLE_HAS(loaded->table, render_block)
+                   ? loaded->table->render_block(loaded->inner, config, start_frame, frame_count, out_pcm)
+                   : UCRA_ERR_NOT_SUPPORTED;
+    }
+    UCRA_Engine_* eng = (UCRA_Engine_*)engine;
+    if (!eng || !config || (frame_count > 0 && !out_pcm) || !layout_valid(config->flags) ||
+        (config->note_count > 0 && !config->notes)) {
+        return UCRA_ERR_INVALID_ARGUMENT;
+    }
+
+    double sr = resolve_sample_rate(eng, config);
+    uint32_t channels = config->channels > 0 ? config->channels : 1;
+    UCRA_CurveInterp interp = ucra_curve_interp_from_config(config);
+    UCRA_BlockRender* block = &eng->block;
+
+    /* the carried sweep continues only where the previous block ended, over the same notes */
+    int continues = block->valid && start_frame == block->next_frame && block->sr == sr &&
+                    block->interp == interp && block->sweep.note_count == config->note_count &&
+                    notes_equal(block->notes, config->notes, config->note_count);
+    if (!continues) {
+        UCRA_Result result = block_seek(block, config, sr, interp, start_frame);
+        if (result != UCRA_SUCCESS) return result;
+    }
+    eng->sample_rate = sr;
+
+    const UCRA_Kernels* k = ucra_kernels();
+    uint32_t layout = UCRA_RENDER_LAYOUT(config->flags);
+    float silence[UCRA_RENDER_TILE_FRAMES];
+    memset(silence, 0, sizeof(silence));
+
+    UCRA_TRACE_BEGIN(block);
+    uint64_t frame = start_frame;
+    uint32_t written = 0;
+    while (written < frame_count) {
+        uint32_t n;
+        if (frame >= block->frames) {
+            /* past the end of the render */
+            n = frame_count - written < UCRA_RENDER_TILE_FRAMES ? frame_count - written : UCRA_RENDER_TILE_FRAMES;
+            store_tile(k, layout, out_pcm, silence, written, n, frame_count, channels);
+        } else {
+            if (frame >= block->mix_start + block->mix_frames) {
+                block->mix_start = block->sweep.tile_start;
+                block->mix_frames = sweep_tile(&block->sweep, k, interp, sr, block->frames, block->mix);
+            }
+            uint32_t offset = (uint32_t)(frame - block->mix_start);
+            n = block->mix_frames - offset;
+            if (n > frame_count - written) n = frame_count - written;
+            store_tile(k, layout, out_pcm, block->mix + offset, written, n, frame_count, channels);
+        }
+        written += n;
+        frame += n;
+    }
+    block->next_frame = frame;
+    UCRA_TRACE_END(block, "engine.render_block");
+    return UCRA_SUCCESS;
+}
+
+/* Shared state of a ucra_render_batch() call */
+typedef struct UCRA_BatchRender {
+    UCRA_Engine_* eng;
+    const UCRA_RenderConfig* configs;
+    UCRA_RenderResult* results;
+} UCRA_BatchRender;
+
+static void batch_render_job(void* ctx, uint32_t job, uint32_t worker) {
+    UCRA_BatchRender* batch = (UCRA_BatchRender*)ctx;
+    UCRA_Engine_* eng = batch->eng;
+    const UCRA_RenderConfig* config = &batch->configs[job];
+    UCRA_RenderResult* out = &batch->results[job];
+    if (out->status != UCRA_SUCCESS) return; /* rejected while planning */
+
+    float* dst = out->frames > 0 ? eng->batch_pcm + eng->batch_offsets[job] : NULL;
+    UCRA_TRACE_BEGIN(render);
+    UCRA_Result result = render_frames(NULL, &eng->batch_scratch[worker], config,
+                                       (double)out->sample_rate, out->frames, out->channels, dst);
+    UCRA_TRACE_END(render, "engine.render");
+    if (result != UCRA_SUCCESS) {
+        out->pcm = NULL;
+        out->status = result;
+        return;
+    }
+    out->pcm = dst;
+}
+
+/* per-worker scheduler scratch for batches; entries beyond the old count start empty */
+static UCRA_Result ensure_batch_scratch(UCRA_Engine_* eng, uint32_t workers) {
+    if (workers <= eng->batch_scratch_count) return UCRA_SUCCESS;
+    UCRA_RenderScratch* scratch = (UCRA_RenderScratch*)realloc(eng->batch_scratch,
+                                                               workers * sizeof(UCRA_RenderScratch));
+    if (!scratch) return UCRA_ERR_OUT_OF_MEMORY;
+    memset(scratch + eng->batch_scratch_count, 0,
+           (workers - eng->batch_scratch_count) * sizeof(UCRA_RenderScratch));
+    eng->batch_scratch = scratch;
+    eng->batch_scratch_count = workers;
+    return UCRA_SUCCESS;
+}
+
+UCRA_Result ucra_render_batch(UCRA_Handle engine,
+                              const UCRA_RenderConfig* configs,
+                              UCRA_RenderResult* results,
+                              uint32_t count) {
+    const UCRA_LoadedEngine* loaded = ucra_loaded_engine(engine);
+    if (loaded) {
+        return UCRA_ENGINE_TABLE_HAS(loaded->table, render_batch)
+                   ? loaded->table->render_batch(loaded->inner, configs, results, count)
+                   : UCRA_ERR_NOT_SUPPORTED;
+    }
+    UCRA_Engine_* eng = (UCRA_Engine_*)engine;
+    if (!eng || (count > 0 && (!configs || !results))) return UCRA_ERR_INVALID_ARGUMENT;
+    if (count == 0) return UCRA_SUCCESS;
+
+    UCRA_Result result = ensure_pool(eng);
+    if (result == UCRA_SUCCESS) result = ensure_batch_scratch(eng, ucra_pool_size(eng->pool));
+    if (result == UCRA_SUCCESS && count + 1 > eng->batch_offsets_capacity) {
+        uint64_t* offsets = (uint64_t*)realloc(eng->batch_offsets, (count + 1) * sizeof(uint64_t));
+        if (offsets) {
+            eng->batch_offsets = offsets;
+            eng->batch_offsets_capacity = count + 1;
+        } else {
+            result = UCRA_ERR_OUT_OF_MEMORY;
         }
-        /* simple soft clip */
-        if (mix > 1.0) mix = 1.0; else if (mix < -1.0) mix = -1.0;
-        float sample = (float)mix;
-        for (uint32_t ch = 0; ch < channels; ++ch) {
-            eng->last_pcm[n * channels + ch] = sample;
+    }
+    if (result != UCRA_SUCCESS) {
+        for (uint32_t i = 0; i < count; ++i) results[i].status = result;
+        return result;
+    }
+
+    /* plan: size every job up front so all outputs share one arena */
+    uint64_t total = 0;
+    for (uint32_t i = 0; i < count; ++i) {
+        const UCRA_RenderConfig* config = &configs[i];
+        double sr = resolve_sample_rate(eng, config);
+        uint32_t channels = config->channels > 0 ? config->channels : 1;
+        int valid = (config->note_count == 0 || config->notes != NULL) && layout_valid(config->flags);
+        uint64_t frames = valid ? compute_render_frames(config, sr) : 0;
+
+        fill_result(&results[i], NULL, frames, channels, sr);
+        if (!valid) results[i].status = UCRA_ERR_INVALID_ARGUMENT;
+        eng->batch_offsets[i] = total;
+        total += layout_samples(config->flags, results[i].frames, channels);
+    }
+    eng->batch_offsets[count] = total;
+
+    if (total > eng->batch_pcm_capacity) {
+        float* pcm = (float*)realloc(eng->batch_pcm, (size_t)total * sizeof(float));
+        if (!pcm) {
+            for (uint32_t i = 0; i < count; ++i) results[i].status = UCRA_ERR_OUT_OF_MEMORY;
+            return UCRA_ERR_OUT_OF_MEMORY;
         }
+        eng->batch_pcm = pcm;
+        eng->batch_pcm_capacity = (size_t)total;
     }
 
-    outResult->pcm = eng->last_pcm;
-    outResult->frames = frames;
-    outResult->channels = channels;
-    outResult->sample_rate = (uint32_t)eng->sample_rate;
-    outResult->metadata = NULL;
-    outResult->metadata_count = 0;
-    outResult->status = UCRA_SUCCESS;
+    UCRA_BatchRender batch;
+    batch.eng = eng;
+    batch.configs = configs;
+    batch.results = results;
+    ucra_pool_run(eng->pool, count, batch_render_job, &batch);
+
+    for (uint32_t i = 0; i < count; ++i) {
+        if (results[i].status != UCRA_SUCCESS) return results[i].status;
+    }
     return UCRA_SUCCESS;
 }
@@ -0,0 +1,12 @@
+/*
+ * UCRA Engine Host (ucra_engine_host)
+ * Serves the built-in engine to a process that created it from an "ipc"
+ * manifest entry. Launched by the client with the channel to serve; not
+ * meant to be run by hand.
+ */
+
+#include "ucra/ucra.h"
+
+int main(int argc, char** argv) {
+    return ucra_ipc_serve(argc, argv, NULL) == UCRA_SUCCESS ? 0 : 1;
+}
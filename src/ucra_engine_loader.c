@@ -0,0 +1,201 @@
+/*
+ * UCRA Engine Loader
+ * Opens the shared library of a "dll" manifest entry once per process,
+ * resolves its versioned function table and wraps the library's engines in
+ * proxies that the public API forwards to (see ucra_engine_loader.h). An
+ * "ipc" entry gets the same proxy around a connection to a host process
+ * (see ucra_ipc.h).
+ */
+
+#include "ucra_engine_loader.h"
+#include "ucra_ipc.h"
+#include "ucra_threads.h"
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <dlfcn.h>
+#endif
+
+/* Table members up to render, the last required one */
+#define UCRA_ENGINE_TABLE_MIN_SIZE \
+    (offsetof(UCRA_EngineTable, render) + sizeof(((UCRA_EngineTable*)0)->render))
+
+/* ---------------------------------------------------------------------------
+ * Library cache
+ * ------------------------------------------------------------------------- */
+
+/* One resolved entry; libraries are never closed, so tables stay valid */
+typedef struct UCRA_EngineLibrary {
+    char* path;   /* canonical path */
+    char* symbol;
+    const UCRA_EngineTable* table;
+    struct UCRA_EngineLibrary* next;
+} UCRA_EngineLibrary;
+
+static UCRA_Once g_loader_once = UCRA_ONCE_INIT;
+static UCRA_Mutex g_loader_mutex;
+static UCRA_EngineLibrary* g_libraries;
+
+static void loader_init(void) {
+    ucra_mutex_init(&g_loader_mutex);
+}
+
+static char* copy_string(const char* s) {
+    size_t len = strlen(s) + 1;
+    char* copy = (char*)malloc(len);
+    if (copy) memcpy(copy, s, len);
+    return copy;
+}
+
+static int path_is_absolute(const char* path) {
+#ifdef _WIN32
+    return path[0] == '\\' || path[0] == '/' || (path[0] && path[1] == ':');
+#else
+    return path[0] == '/';
+#endif
+}
+
+/* malloc'd absolute path of the library with links resolved, NULL if it does not exist */
+static char* library_path(const char* path, const char* base_dir) {
+    char* joined = NULL;
+    if (base_dir && *base_dir && !path_is_absolute(path)) {
+        size_t dir_len = strlen(base_dir), path_len = strlen(path);
+        joined = (char*)malloc(dir_len + path_len + 2);
+        if (!joined) return NULL;
+        memcpy(joined, base_dir, dir_len);
+        joined[dir_len] = '/';
+        memcpy(joined + dir_len + 1, path, path_len + 1);
+        path = joined;
+    }
+#ifdef _WIN32
+    char* canonical = _fullpath(NULL, path, 0);
+    if (canonical && GetFileAttributesA(canonical) == INVALID_FILE_ATTRIBUTES) {
+        free(canonical);
+        canonical = NULL;
+    }
+#else
+    char* canonical = realpath(path, NULL);
+#endif
+    free(joined);
+    return canonical;
+}
+
+/* Open the library and resolve its table; the loader mutex must be held */
+static UCRA_Result open_library(const char* path, const char* symbol, const UCRA_EngineTable** out_table) {
+#ifdef _WIN32
+    HMODULE library = LoadLibraryA(path);
+    if (!library) return UCRA_ERR_FILE_NOT_FOUND;
+    UCRA_EngineEntry entry = (UCRA_EngineEntry)(void*)GetProcAddress(library, symbol);
+#else
+    void* library = dlopen(path, RTLD_NOW | RTLD_LOCAL);
+    if (!library) return UCRA_ERR_FILE_NOT_FOUND;
+    UCRA_EngineEntry entry;
+    *(void**)&entry = dlsym(library, symbol);
+#endif
+    const UCRA_EngineTable* table = entry ? entry(UCRA_ENGINE_ABI_VERSION) : NULL;
+    if (!table || table->abi_version != UCRA_ENGINE_ABI_VERSION ||
+        table->struct_size < UCRA_ENGINE_TABLE_MIN_SIZE ||
+        !table->engine_create || !table->engine_destroy || !table->render) {
+        /* nothing from the library is kept, so it may go */
+#ifdef _WIN32
+        FreeLibrary(library);
+#else
+        dlclose(library);
+#endif
+        return UCRA_ERR_NOT_SUPPORTED;
+    }
+    *out_table = table;
+    return UCRA_SUCCESS;
+}
+
+static UCRA_Result find_table(const char* path, const char* symbol, const UCRA_EngineTable** out_table) {
+    ucra_once(&g_loader_once, loader_init);
+    ucra_mutex_lock(&g_loader_mutex);
+    for (UCRA_EngineLibrary* library = g_libraries; library; library = library->next) {
+        if (strcmp(library->path, path) == 0 && strcmp(library->symbol, symbol) == 0) {
+            *out_table = library->table;
+            ucra_mutex_unlock(&g_loader_mutex);
+            return UCRA_SUCCESS;
+        }
+    }
+
+    /* Opened under the lock, so each library's entry runs once */
+    const UCRA_EngineTable* table = NULL;
+    UCRA_Result result = open_library(path, symbol, &table);
+    if (result == UCRA_SUCCESS) {
+        UCRA_EngineLibrary* library = (UCRA_EngineLibrary*)calloc(1, sizeof(UCRA_EngineLibrary));
+        if (library) {
+            library->path = copy_string(path);
+            library->symbol = copy_string(symbol);
+        }
+        if (library && library->path && library->symbol) {
+            library->table = table;
+            library->next = g_libraries;
+            g_libraries = library;
+        } else if (library) {
+            /* the table still works; it is just resolved again next time */
+            free(library->path);
+            free(library->symbol);
+            free(library);
+        }
+        *out_table = table;
+    }
+    ucra_mutex_unlock(&g_loader_mutex);
+    return result;
+}
+
+/* ---------------------------------------------------------------------------
+ * Public API
+ * ------------------------------------------------------------------------- */
+
+UCRA_Result ucra_engine_create_from_manifest(UCRA_Handle* outEngine,
+                                             const UCRA_Manifest* manifest,
+                                             const char* base_dir,
+                                             const UCRA_KeyValue* options,
+                                             uint32_t option_count) {
+    if (!outEngine || !manifest) return UCRA_ERR_INVALID_ARGUMENT;
+    *outEngine = NULL;
+    const char* type = manifest->entry.type;
+    int is_ipc = type && strcmp(type, "ipc") == 0;
+    if (!type || (!is_ipc && strcmp(type, "dll") != 0)) return UCRA_ERR_NOT_SUPPORTED;
+    if (!manifest->entry.path || !*manifest->entry.path) return UCRA_ERR_INVALID_MANIFEST;
+
+    char* path = library_path(manifest->entry.path, base_dir);
+    if (!path) return UCRA_ERR_FILE_NOT_FOUND;
+    UCRA_LoadedEngine* loaded = (UCRA_LoadedEngine*)calloc(1, sizeof(UCRA_LoadedEngine));
+    if (!loaded) {
+        free(path);
+        return UCRA_ERR_OUT_OF_MEMORY;
+    }
+
+    UCRA_Result result;
+    if (is_ipc) {
+        /* each engine gets its own host process, and the connection is the inner handle */
+        result = ucra_ipc_engine_create(path, options, option_count, &loaded->inner, &loaded->table);
+    } else {
+        const char* symbol = manifest->entry.symbol && *manifest->entry.symbol
+                                 ? manifest->entry.symbol : UCRA_ENGINE_DEFAULT_SYMBOL;
+        result = find_table(path, symbol, &loaded->table);
+        if (result == UCRA_SUCCESS) {
+            result = loaded->table->engine_create(&loaded->inner, options, option_count);
+        }
+    }
+    free(path);
+    if (result != UCRA_SUCCESS) {
+        free(loaded);
+        return result;
+    }
+    loaded->kind = UCRA_ENGINE_KIND_LOADED;
+    *outEngine = (UCRA_Handle)(void*)loaded;
+    return UCRA_SUCCESS;
+}
+
+void ucra_loaded_engine_destroy(const UCRA_LoadedEngine* loaded) {
+    loaded->table->engine_destroy(loaded->inner);
+    free((void*)loaded);
+}
@@ -0,0 +1,47 @@
+/*
+ * UCRA Engine Loader (internal)
+ * Engines created from a "dll" manifest entry are proxies that forward to the
+ * library's function table. Every engine handle starts with a uint32_t kind,
+ * so the public entry points can tell a proxy from a built-in engine.
+ */
+#ifndef UCRA_ENGINE_LOADER_H
+#define UCRA_ENGINE_LOADER_H
+
+#include "ucra/ucra.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Values of the kind that begins every engine handle */
+#define UCRA_ENGINE_KIND_BUILTIN 0u
+#define UCRA_ENGINE_KIND_LOADED  0x44454f4cu /* "LOED" */
+
+typedef struct UCRA_LoadedEngine {
+    uint32_t kind;                /* UCRA_ENGINE_KIND_LOADED */
+    const UCRA_EngineTable* table;
+    UCRA_Handle inner;            /* the library's own handle */
+} UCRA_LoadedEngine;
+
+/** Whether table provides member; members past its struct_size count as missing */
+#define UCRA_ENGINE_TABLE_HAS(table, member) \
+    ((table)->struct_size >= offsetof(UCRA_EngineTable, member) + sizeof((table)->member) && \
+     (table)->member != NULL)
+
+/** The proxy behind engine, or NULL for a built-in engine (or NULL) */
+static inline const UCRA_LoadedEngine* ucra_loaded_engine(UCRA_Handle engine) {
+    const UCRA_LoadedEngine* loaded = (const UCRA_LoadedEngine*)(const void*)engine;
+    return loaded && loaded->kind == UCRA_ENGINE_KIND_LOADED ? loaded : NULL;
+}
+
+/** Destroy the library's engine and the proxy */
+void ucra_loaded_engine_destroy(const UCRA_LoadedEngine* loaded);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* UCRA_ENGINE_LOADER_H */
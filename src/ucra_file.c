@@ -0,0 +1,207 @@
+/*
+ * UCRA File Helpers
+ * Memory mapping via mmap or Win32 file mappings; directory listing via
+ * readdir or FindFirstFile.
+ */
+
+#include "ucra_file.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+    #include <direct.h>
+    #include <sys/stat.h>
+    #include <sys/utime.h>
+#else
+    #include <dirent.h>
+    #include <errno.h>
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+    #include <utime.h>
+#endif
+
+#define FNV_PRIME 0x100000001b3ull
+
+UCRA_Result ucra_file_map(const char* path, UCRA_FileMap* out_map) {
+    if (!path || !out_map) return UCRA_ERR_INVALID_ARGUMENT;
+    memset(out_map, 0, sizeof(*out_map));
+#ifdef _WIN32
+    HANDLE handle = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                                FILE_ATTRIBUTE_NORMAL, NULL);
+    if (handle == INVALID_HANDLE_VALUE) return UCRA_ERR_FILE_NOT_FOUND;
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(handle, &size) || size.QuadPart == 0) {
+        CloseHandle(handle);
+        return UCRA_ERR_INTERNAL;
+    }
+    HANDLE map = CreateFileMappingA(handle, NULL, PAGE_READONLY, 0, 0, NULL);
+    void* view = map ? MapViewOfFile(map, FILE_MAP_READ, 0, 0, 0) : NULL;
+    if (!view) {
+        if (map) CloseHandle(map);
+        CloseHandle(handle);
+        return UCRA_ERR_INTERNAL;
+    }
+    out_map->file_handle = handle;
+    out_map->map_handle = map;
+    out_map->data = view;
+    out_map->size = (size_t)size.QuadPart;
+#else
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return UCRA_ERR_FILE_NOT_FOUND;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        close(fd);
+        return UCRA_ERR_INTERNAL;
+    }
+    void* view = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd); /* the mapping keeps the file alive */
+    if (view == MAP_FAILED) return UCRA_ERR_INTERNAL;
+    out_map->data = view;
+    out_map->size = (size_t)st.st_size;
+#endif
+    return UCRA_SUCCESS;
+}
+
+void ucra_file_unmap(UCRA_FileMap* map) {
+    if (!map || !map->data) return;
+#ifdef _WIN32
+    UnmapViewOfFile(map->data);
+    CloseHandle(map->map_handle);
+    CloseHandle(map->file_handle);
+#else
+    munmap((void*)map->data, map->size);
+#endif
+    map->data = NULL;
+    map->size = 0;
+}
+
+void ucra_file_prefetch(const UCRA_FileMap* map, size_t offset, size_t size) {
+    if (!map || !map->data || offset >= map->size) return;
+    if (size > map->size - offset) size = map->size - offset;
+#ifdef _WIN32
+    (void)size; /* PrefetchVirtualMemory needs Windows 8; page faults read the file instead */
+#else
+    /* advice works on whole pages, and the mapping itself starts on one */
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t start = offset / page * page;
+    posix_madvise((char*)map->data + start, size + (offset - start), POSIX_MADV_WILLNEED);
+#endif
+}
+
+UCRA_Result ucra_file_replace(const char* temp_path, const char* path) {
+#ifdef _WIN32
+    /* Windows rename() does not replace an existing file */
+    int ok = MoveFileExA(temp_path, path, MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+    int ok = rename(temp_path, path) == 0;
+#endif
+    if (!ok) remove(temp_path);
+    return ok ? UCRA_SUCCESS : UCRA_ERR_INTERNAL;
+}
+
+UCRA_Result ucra_dir_list(const char* dir, UCRA_DirEntryFn fn, void* ctx) {
+    if (!dir || !fn) return UCRA_ERR_INVALID_ARGUMENT;
+#ifdef _WIN32
+    size_t length = strlen(dir);
+    char* pattern = malloc(length + 3);
+    if (!pattern) return UCRA_ERR_OUT_OF_MEMORY;
+    snprintf(pattern, length + 3, "%s\\*", dir);
+    WIN32_FIND_DATAA entry;
+    HANDLE find = FindFirstFileA(pattern, &entry);
+    free(pattern);
+    if (find == INVALID_HANDLE_VALUE) return UCRA_ERR_FILE_NOT_FOUND;
+    do {
+        if (entry.cFileName[0] == '.') continue;
+        if (fn(ctx, entry.cFileName, (entry.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0)) break;
+    } while (FindNextFileA(find, &entry));
+    FindClose(find);
+#else
+    DIR* handle = opendir(dir);
+    if (!handle) return UCRA_ERR_FILE_NOT_FOUND;
+    struct dirent* entry;
+    while ((entry = readdir(handle)) != NULL) {
+        const char* name = entry->d_name;
+        if (name[0] == '.') continue;
+        int is_directory = -1; /* unknown */
+#ifdef DT_DIR
+        /* the entry type saves a stat per entry, which matters on network storage */
+        if (entry->d_type != DT_UNKNOWN && entry->d_type != DT_LNK) {
+            is_directory = entry->d_type == DT_DIR;
+        }
+#endif
+        if (is_directory < 0) {
+            size_t size = strlen(dir) + strlen(name) + 2;
+            char* path = malloc(size);
+            struct stat info;
+            is_directory = 0;
+            if (path) {
+                snprintf(path, size, "%s/%s", dir, name);
+                is_directory = stat(path, &info) == 0 && S_ISDIR(info.st_mode);
+                free(path);
+            }
+        }
+        if (fn(ctx, name, is_directory)) break;
+    }
+    closedir(handle);
+#endif
+    return UCRA_SUCCESS;
+}
+
+UCRA_Result ucra_file_info(const char* path, uint64_t* out_size, int64_t* out_mtime) {
+    if (!path || !out_size || !out_mtime) return UCRA_ERR_INVALID_ARGUMENT;
+#ifdef _WIN32
+    WIN32_FILE_ATTRIBUTE_DATA info;
+    if (!GetFileAttributesExA(path, GetFileExInfoStandard, &info)) return UCRA_ERR_FILE_NOT_FOUND;
+    *out_size = ((uint64_t)info.nFileSizeHigh << 32) | info.nFileSizeLow;
+    uint64_t ticks = ((uint64_t)info.ftLastWriteTime.dwHighDateTime << 32) | info.ftLastWriteTime.dwLowDateTime;
+    *out_mtime = (int64_t)(ticks * 100); /* 100 ns ticks since 1601 */
+#else
+    struct stat info;
+    if (stat(path, &info) != 0) return UCRA_ERR_FILE_NOT_FOUND;
+    *out_size = (uint64_t)info.st_size;
+#if defined(__APPLE__)
+    *out_mtime = (int64_t)info.st_mtimespec.tv_sec * 1000000000 + info.st_mtimespec.tv_nsec;
+#elif defined(_POSIX_C_SOURCE) && _POSIX_C_SOURCE >= 200809L
+    *out_mtime = (int64_t)info.st_mtim.tv_sec * 1000000000 + info.st_mtim.tv_nsec;
+#else
+    *out_mtime = (int64_t)info.st_mtime * 1000000000;
+#endif
+#endif
+    return UCRA_SUCCESS;
+}
+
+UCRA_Result ucra_file_touch(const char* path) {
+    if (!path) return UCRA_ERR_INVALID_ARGUMENT;
+#ifdef _WIN32
+    return _utime(path, NULL) == 0 ? UCRA_SUCCESS : UCRA_ERR_FILE_NOT_FOUND;
+#else
+    return utime(path, NULL) == 0 ? UCRA_SUCCESS : UCRA_ERR_FILE_NOT_FOUND;
+#endif
+}
+
+UCRA_Result ucra_dir_create(const char* dir) {
+    if (!dir) return UCRA_ERR_INVALID_ARGUMENT;
+#ifdef _WIN32
+    if (_mkdir(dir) == 0) return UCRA_SUCCESS;
+    DWORD attributes = GetFileAttributesA(dir);
+    int exists = attributes != INVALID_FILE_ATTRIBUTES && (attributes & FILE_ATTRIBUTE_DIRECTORY);
+#else
+    if (mkdir(dir, 0755) == 0) return UCRA_SUCCESS;
+    struct stat info;
+    int exists = errno == EEXIST && stat(dir, &info) == 0 && S_ISDIR(info.st_mode);
+#endif
+    return exists ? UCRA_SUCCESS : UCRA_ERR_FILE_NOT_FOUND;
+}
+
+uint64_t ucra_fnv1a(uint64_t hash, const void* bytes, size_t size) {
+    const unsigned char* p = (const unsigned char*)bytes;
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= p[i];
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
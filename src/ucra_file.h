@@ -0,0 +1,94 @@
+/*
+ * UCRA File Helpers (internal)
+ * Read-only memory mapping of whole files, atomic replacement of a file by a
+ * freshly written one, file times, directory listing and creation, and the
+ * FNV-1a hash used to fingerprint file contents.
+ */
+#ifndef UCRA_FILE_H
+#define UCRA_FILE_H
+
+#include "ucra/ucra.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef _WIN32
+    #include <windows.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define UCRA_FNV_OFFSET 0xcbf29ce484222325ull
+
+/** A read-only view of a whole file */
+typedef struct UCRA_FileMap {
+    const void* data; /**< NULL when nothing is mapped */
+    size_t size;
+#ifdef _WIN32
+    HANDLE file_handle;
+    HANDLE map_handle;
+#endif
+} UCRA_FileMap;
+
+/**
+ * @brief Map path read-only
+ * @return UCRA_SUCCESS, UCRA_ERR_FILE_NOT_FOUND if it cannot be opened, or
+ *         UCRA_ERR_INTERNAL if it is empty or cannot be mapped
+ */
+UCRA_Result ucra_file_map(const char* path, UCRA_FileMap* out_map);
+
+/** Release a mapping; a zeroed or already released map is ignored */
+void ucra_file_unmap(UCRA_FileMap* map);
+
+/**
+ * @brief Ask the OS to start reading size bytes of map from offset in the background
+ *
+ * Only a hint: returns at once, and does nothing where the platform has no such call.
+ */
+void ucra_file_prefetch(const UCRA_FileMap* map, size_t offset, size_t size);
+
+/**
+ * @brief Move temp_path over path, replacing any existing file
+ *
+ * Readers see either the old or the new file. temp_path is removed on failure.
+ */
+UCRA_Result ucra_file_replace(const char* temp_path, const char* path);
+
+/** Called for each entry of a listed directory; a nonzero return stops the listing */
+typedef int (*UCRA_DirEntryFn)(void* ctx, const char* name, int is_directory);
+
+/**
+ * @brief Call fn for every entry of dir, except names starting with '.'
+ *
+ * Entries come in the order the file system returns them.
+ *
+ * @return UCRA_SUCCESS, or UCRA_ERR_FILE_NOT_FOUND if dir cannot be opened
+ */
+UCRA_Result ucra_dir_list(const char* dir, UCRA_DirEntryFn fn, void* ctx);
+
+/**
+ * @brief Size and modification time of path
+ *
+ * out_mtime counts nanoseconds from a platform epoch; only its order is
+ * meaningful, as file systems keep it at different resolutions.
+ *
+ * @return UCRA_SUCCESS, or UCRA_ERR_FILE_NOT_FOUND if path does not exist
+ */
+UCRA_Result ucra_file_info(const char* path, uint64_t* out_size, int64_t* out_mtime);
+
+/** Set path's modification time to now */
+UCRA_Result ucra_file_touch(const char* path);
+
+/** Create directory dir (one level); an existing directory is not an error */
+UCRA_Result ucra_dir_create(const char* dir);
+
+/** Continue a 64-bit FNV-1a hash (start from UCRA_FNV_OFFSET) over size bytes */
+uint64_t ucra_fnv1a(uint64_t hash, const void* bytes, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* UCRA_FILE_H */
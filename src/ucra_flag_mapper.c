@@ -1,9 +1,13 @@
 #include "ucra/ucra_flag_mapper.h"
+#include "ucra_file.h"
+#include "ucra_trace.h"
 #include "../third-party/cJSON.h"
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <errno.h>
+#include <math.h>
 
 static char* ucra_strdup(const char* src) {
     if (!src) return NULL;
@@ -15,6 +19,47 @@ static char* ucra_strdup(const char* src) {
     return dst;
 }
 
+/* Per-rule part of a compiled mapper */
+typedef struct UCRA_RuleIndex {
+    uint32_t source;          /* id of the rule's source name */
+    uint32_t map_first;       /* first slot of the rule's map key index */
+    uint32_t map_mask;        /* slot count - 1 of that index */
+    double scale_span;        /* scale_max - scale_min */
+} UCRA_RuleIndex;
+
+/* Open-addressed tables whose slots hold an index + 1, 0 marking an empty slot.
+ * Everything lives in the one allocation headed by this structure. */
+struct UCRA_FlagMapperIndex {
+    UCRA_RuleIndex* rules;
+    const char** source_names; /* distinct source names, by id */
+    uint32_t source_count;
+    uint32_t* source_slots;    /* source name -> id */
+    uint32_t source_mask;
+    uint32_t* map_slots;       /* map key -> entry, one table per map rule */
+};
+
+/* Sources looked up on the stack per apply; more than this many distinct sources use the heap */
+#define UCRA_MAPPER_STACK_SOURCES 64
+
+static uint32_t index_slots(uint32_t count) {
+    uint32_t slots = 4;
+    while (slots < count * 2) slots *= 2;
+    return slots;
+}
+
+static uint32_t name_hash(const char* name) {
+    return (uint32_t)ucra_fnv1a(UCRA_FNV_OFFSET, name, strlen(name));
+}
+
+/* Slot holding name in a table over names[], or the empty slot where it would go */
+static uint32_t find_slot(const uint32_t* slots, uint32_t mask, char* const* names, const char* name) {
+    uint32_t slot = name_hash(name) & mask;
+    while (slots[slot] && strcmp(names[slots[slot] - 1], name) != 0) {
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
 static UCRA_TransformKind ucra_parse_transform_kind(const char* kind_str) {
     if (!kind_str) return UCRA_TRANSFORM_COPY;
     if (strcmp(kind_str, "scale") == 0) return UCRA_TRANSFORM_SCALE;
@@ -23,6 +68,28 @@ static UCRA_TransformKind ucra_parse_transform_kind(const char* kind_str) {
     return UCRA_TRANSFORM_COPY;
 }
 
+/* Target type named in a mapping, or the one its transform and source imply */
+static UCRA_ValueType ucra_parse_value_type(const char* type_str, const UCRA_FlagRule* rule,
+                                            const char* source_type) {
+    if (type_str) {
+        if (strcmp(type_str, "int") == 0) return UCRA_VALUE_INT;
+        if (strcmp(type_str, "float") == 0) return UCRA_VALUE_FLOAT;
+        if (strcmp(type_str, "bool") == 0) return UCRA_VALUE_BOOL;
+        if (strcmp(type_str, "enum") == 0) return UCRA_VALUE_ENUM;
+        return UCRA_VALUE_STRING;
+    }
+    switch (rule->transform_kind) {
+        case UCRA_TRANSFORM_SCALE: return UCRA_VALUE_FLOAT;
+        case UCRA_TRANSFORM_MAP: return UCRA_VALUE_ENUM;
+        case UCRA_TRANSFORM_CONSTANT: return UCRA_VALUE_STRING;
+        case UCRA_TRANSFORM_COPY:
+        default:
+            if (source_type && strcmp(source_type, "number") == 0) return UCRA_VALUE_FLOAT;
+            if (source_type && strcmp(source_type, "bool") == 0) return UCRA_VALUE_BOOL;
+            return UCRA_VALUE_STRING;
+    }
+}
+
 static UCRA_Result ucra_parse_rule(const cJSON* rule_json, UCRA_FlagRule* rule) {
     if (!rule_json || !rule) return UCRA_ERR_INVALID_ARGUMENT;
 
@@ -106,6 +173,9 @@ static UCRA_Result ucra_parse_rule(const cJSON* rule_json, UCRA_FlagRule* rule)
         }
     }
 
+    rule->value_type = ucra_parse_value_type(cJSON_GetStringValue(cJSON_GetObjectItem(target, "type")), rule,
+                                             cJSON_GetStringValue(cJSON_GetObjectItem(source, "type")));
+
     return UCRA_SUCCESS;
 }
 
@@ -207,15 +277,84 @@ UCRA_API UCRA_Result UCRA_CALL ucra_flag_mapper_load(const char* json_path, UCRA
     }
 
     cJSON_Delete(json);
+    if (ucra_flag_mapper_compile(m) != UCRA_SUCCESS) {
+        ucra_flag_mapper_free(m);
+        return UCRA_ERR_OUT_OF_MEMORY;
+    }
     *mapper = m;
     return UCRA_SUCCESS;
 }
 
+UCRA_API UCRA_Result UCRA_CALL ucra_flag_mapper_compile(UCRA_FlagMapper* mapper) {
+    if (!mapper) return UCRA_ERR_INVALID_ARGUMENT;
+
+    free(mapper->index);
+    mapper->index = NULL;
+
+    /* A rule without a source can never match and is left out of the source index */
+    uint32_t source_slot_count = index_slots(mapper->rule_count);
+    uint32_t map_slot_count = 0;
+    for (uint32_t i = 0; i < mapper->rule_count; i++) {
+        const UCRA_FlagRule* rule = &mapper->rules[i];
+        if (rule->transform_kind == UCRA_TRANSFORM_MAP && rule->map_count > 0) {
+            map_slot_count += index_slots(rule->map_count);
+        }
+    }
+
+    size_t rules_at = (sizeof(UCRA_FlagMapperIndex) + sizeof(double) - 1) / sizeof(double) * sizeof(double);
+    size_t names_at = rules_at + (size_t)mapper->rule_count * sizeof(UCRA_RuleIndex);
+    size_t source_slots_at = names_at + (size_t)mapper->rule_count * sizeof(const char*);
+    size_t map_slots_at = source_slots_at + (size_t)source_slot_count * sizeof(uint32_t);
+    char* block = calloc(1, map_slots_at + (size_t)map_slot_count * sizeof(uint32_t));
+    if (!block) return UCRA_ERR_OUT_OF_MEMORY;
+
+    UCRA_FlagMapperIndex* index = (UCRA_FlagMapperIndex*)block;
+    index->rules = (UCRA_RuleIndex*)(block + rules_at);
+    index->source_names = (const char**)(block + names_at);
+    index->source_slots = (uint32_t*)(block + source_slots_at);
+    index->source_mask = source_slot_count - 1;
+    index->map_slots = (uint32_t*)(block + map_slots_at);
+
+    uint32_t map_first = 0;
+    for (uint32_t i = 0; i < mapper->rule_count; i++) {
+        const UCRA_FlagRule* rule = &mapper->rules[i];
+        UCRA_RuleIndex* entry = &index->rules[i];
+        entry->scale_span = rule->scale_max - rule->scale_min;
+
+        /* rules reading the same legacy flag share a source id */
+        uint32_t slot = find_slot(index->source_slots, index->source_mask,
+                                  (char* const*)index->source_names, rule->source_name);
+        if (!index->source_slots[slot]) {
+            index->source_names[index->source_count++] = rule->source_name;
+            index->source_slots[slot] = index->source_count;
+        }
+        entry->source = index->source_slots[slot] - 1;
+
+        if (rule->transform_kind == UCRA_TRANSFORM_MAP && rule->map_count > 0) {
+            uint32_t slots = index_slots(rule->map_count);
+            uint32_t* table = index->map_slots + map_first;
+            entry->map_first = map_first;
+            entry->map_mask = slots - 1;
+            map_first += slots;
+            /* a repeated key keeps its first entry, as the linear search did */
+            for (uint32_t k = 0; k < rule->map_count; k++) {
+                if (!rule->map_keys[k]) continue;
+                uint32_t key_slot = find_slot(table, entry->map_mask, rule->map_keys, rule->map_keys[k]);
+                if (!table[key_slot]) table[key_slot] = k + 1;
+            }
+        }
+    }
+
+    mapper->index = index;
+    return UCRA_SUCCESS;
+}
+
 UCRA_API void UCRA_CALL ucra_flag_mapper_free(UCRA_FlagMapper* mapper) {
     if (!mapper) return;
 
     free(mapper->engine_name);
     free(mapper->version);
+    free(mapper->index);
 
     if (mapper->rules) {
         for (uint32_t i = 0; i < mapper->rule_count; i++) {
@@ -227,58 +366,110 @@ UCRA_API void UCRA_CALL ucra_flag_mapper_free(UCRA_FlagMapper* mapper) {
     free(mapper);
 }
 
-static char* ucra_apply_transform(const UCRA_FlagRule* rule, const char* input_value, char** warning) {
-    if (!rule || !input_value) return NULL;
+/* Map entry for input_value, or -1; entry is the rule's compiled part, NULL to search linearly */
+static int32_t ucra_find_map_entry(const UCRA_FlagRule* rule, const UCRA_FlagMapperIndex* index,
+                                   const UCRA_RuleIndex* entry, const char* input_value) {
+    if (entry) {
+        if (rule->map_count == 0) return -1;
+        uint32_t slot = find_slot(index->map_slots + entry->map_first, entry->map_mask,
+                                  rule->map_keys, input_value);
+        return (int32_t)index->map_slots[entry->map_first + slot] - 1;
+    }
+    for (uint32_t i = 0; i < rule->map_count; i++) {
+        if (rule->map_keys[i] && strcmp(input_value, rule->map_keys[i]) == 0) {
+            return (int32_t)i;
+        }
+    }
+    return -1;
+}
 
-    switch (rule->transform_kind) {
-        case UCRA_TRANSFORM_COPY:
-            return ucra_strdup(input_value);
+/* Text buffers a rule may format its value and warning into */
+#define UCRA_MAP_NUMBER_SIZE 32
+#define UCRA_MAP_MESSAGE_SIZE 128
+
+/* Apply one rule to its input. value and warning point at mapper, legacy or static storage, or at
+ * number / message when the rule had to format them; either may be NULL. */
+static void ucra_apply_transform(const UCRA_FlagRule* rule, const UCRA_FlagMapperIndex* index,
+                                 const UCRA_RuleIndex* entry, const char* input_value,
+                                 char* number, char* message, const char** value, const char** warning) {
+    *value = NULL;
+    *warning = NULL;
+    if (!input_value) {
+        *value = rule->default_value;
+        return;
+    }
 
+    switch (rule->transform_kind) {
         case UCRA_TRANSFORM_SCALE: {
             char* endptr;
             double val = strtod(input_value, &endptr);
             if (*endptr != '\0') {
-                if (warning) {
-                    *warning = ucra_strdup("scale: invalid number format");
-                }
-                return NULL;
-            }
-            double scaled = rule->scale_min + (rule->scale_max - rule->scale_min) * val;
-            char* result = malloc(32);
-            if (result) {
-                snprintf(result, 32, "%.6g", scaled);
+                *warning = "scale: invalid number format";
+                return;
             }
-            return result;
+            double span = entry ? entry->scale_span : rule->scale_max - rule->scale_min;
+            snprintf(number, UCRA_MAP_NUMBER_SIZE, "%.6g", rule->scale_min + span * val);
+            *value = number;
+            return;
         }
 
-        case UCRA_TRANSFORM_MAP:
-            for (uint32_t i = 0; i < rule->map_count; i++) {
-                if (strcmp(input_value, rule->map_keys[i]) == 0) {
-                    return ucra_strdup(rule->map_values[i]);
-                }
+        case UCRA_TRANSFORM_MAP: {
+            int32_t found = ucra_find_map_entry(rule, index, entry, input_value);
+            if (found >= 0) {
+                *value = rule->map_values[found];
+                return;
             }
-            if (warning) {
-                char* msg = malloc(128);
-                if (msg) {
-                    snprintf(msg, 128, "map: value '%s' not found in mapping", input_value);
-                    *warning = msg;
-                }
-            }
-            return NULL;
+            snprintf(message, UCRA_MAP_MESSAGE_SIZE, "map: value '%s' not found in mapping", input_value);
+            *warning = message;
+            return;
+        }
 
         case UCRA_TRANSFORM_CONSTANT:
-            return ucra_strdup(rule->constant_value);
+            *value = rule->constant_value;
+            return;
 
+        case UCRA_TRANSFORM_COPY:
         default:
-            return ucra_strdup(input_value);
+            *value = input_value;
+            return;
+    }
+}
+
+/* Value of each rule's source, by the mapper's source ids; the first legacy flag of a name wins */
+static void ucra_find_inputs(const UCRA_FlagMapperIndex* index, const UCRA_KeyValue* legacy_flags,
+                             uint32_t legacy_count, const char** inputs) {
+    memset(inputs, 0, index->source_count * sizeof(const char*));
+    for (uint32_t j = 0; j < legacy_count && legacy_flags; j++) {
+        if (!legacy_flags[j].key) continue;
+        uint32_t slot = find_slot(index->source_slots, index->source_mask,
+                                  (char* const*)index->source_names, legacy_flags[j].key);
+        uint32_t source = index->source_slots[slot];
+        if (source && !inputs[source - 1]) {
+            inputs[source - 1] = legacy_flags[j].value;
+        }
     }
 }
 
+/* Input of rule i: from inputs when the mapper is compiled and they were found, else by linear search */
+static const char* ucra_rule_input(const UCRA_FlagMapper* mapper, uint32_t i, const char* const* inputs,
+                                   const UCRA_KeyValue* legacy_flags, uint32_t legacy_count) {
+    if (mapper->index && inputs) {
+        return inputs[mapper->index->rules[i].source];
+    }
+    for (uint32_t j = 0; j < legacy_count; j++) {
+        if (legacy_flags[j].key && strcmp(legacy_flags[j].key, mapper->rules[i].source_name) == 0) {
+            return legacy_flags[j].value;
+        }
+    }
+    return NULL;
+}
+
 UCRA_API UCRA_Result UCRA_CALL ucra_flag_mapper_apply(const UCRA_FlagMapper* mapper,
                                                     const UCRA_KeyValue* legacy_flags, uint32_t legacy_count,
                                                     UCRA_FlagMapResult* result) {
     if (!mapper || !result) return UCRA_ERR_INVALID_ARGUMENT;
 
+    UCRA_TRACE_BEGIN(apply);
     memset(result, 0, sizeof(UCRA_FlagMapResult));
 
     /* Allocate result arrays */
@@ -289,46 +480,235 @@ UCRA_API UCRA_Result UCRA_CALL ucra_flag_mapper_apply(const UCRA_FlagMapper* map
         return UCRA_ERR_OUT_OF_MEMORY;
     }
 
+    const UCRA_FlagMapperIndex* index = mapper->index;
+    const char* stack_inputs[UCRA_MAPPER_STACK_SOURCES];
+    const char** inputs = NULL;
+    if (index) {
+        inputs = index->source_count <= UCRA_MAPPER_STACK_SOURCES
+                     ? stack_inputs : malloc(index->source_count * sizeof(const char*));
+        if (!inputs) {
+            ucra_flag_map_result_free(result);
+            return UCRA_ERR_OUT_OF_MEMORY;
+        }
+        ucra_find_inputs(index, legacy_flags, legacy_count, inputs);
+    }
+
     uint32_t flag_count = 0;
     uint32_t warning_count = 0;
 
-    /* Apply each rule */
+    /* Apply each rule; this result owns copies of everything it points to */
     for (uint32_t i = 0; i < mapper->rule_count; i++) {
         const UCRA_FlagRule* rule = &mapper->rules[i];
-        const char* input_value = NULL;
+        char number[UCRA_MAP_NUMBER_SIZE];
+        char message[UCRA_MAP_MESSAGE_SIZE];
+        const char* value;
+        const char* warning;
+        ucra_apply_transform(rule, index, index ? &index->rules[i] : NULL,
+                             ucra_rule_input(mapper, i, inputs, legacy_flags, legacy_count),
+                             number, message, &value, &warning);
+
+        char* output_value = ucra_strdup(value);
+        if (output_value) {
+            result->flags[flag_count].key = ucra_strdup(rule->target_name);
+            result->flags[flag_count].value = output_value;
+            flag_count++;
+        }
 
-        /* Find input value */
-        for (uint32_t j = 0; j < legacy_count; j++) {
-            if (strcmp(legacy_flags[j].key, rule->source_name) == 0) {
-                input_value = legacy_flags[j].value;
-                break;
-            }
+        char* output_warning = ucra_strdup(warning);
+        if (output_warning) {
+            result->warnings[warning_count] = output_warning;
+            warning_count++;
         }
+    }
 
-        char* warning = NULL;
-        char* output_value = NULL;
+    if (inputs != stack_inputs) {
+        free(inputs);
+    }
+    result->flag_count = flag_count;
+    result->warning_count = warning_count;
+    UCRA_TRACE_END(apply, "flag_mapper.apply");
 
-        if (input_value) {
-            output_value = ucra_apply_transform(rule, input_value, &warning);
-        } else if (rule->default_value) {
-            output_value = ucra_strdup(rule->default_value);
-        }
+    return UCRA_SUCCESS;
+}
 
-        if (output_value) {
-            result->flags[flag_count].key = ucra_strdup(rule->target_name);
-            result->flags[flag_count].value = output_value;
+UCRA_API size_t UCRA_CALL ucra_flag_mapper_arena_size(const UCRA_FlagMapper* mapper) {
+    if (!mapper) return 0;
+    uint32_t sources = mapper->index ? mapper->index->source_count : 0;
+    /* alignment slack, the input table, the flag and warning arrays, and per rule
+     * at most one formatted value and one formatted warning */
+    return sizeof(void*) + (size_t)sources * sizeof(const char*) +
+           (size_t)mapper->rule_count * (sizeof(UCRA_KeyValue) + sizeof(char*) +
+                                         UCRA_MAP_NUMBER_SIZE + UCRA_MAP_MESSAGE_SIZE);
+}
+
+UCRA_API UCRA_Result UCRA_CALL ucra_flag_mapper_apply_into(const UCRA_FlagMapper* mapper,
+                                                         const UCRA_KeyValue* legacy_flags, uint32_t legacy_count,
+                                                         void* arena, size_t arena_size,
+                                                         UCRA_FlagMapResult* result) {
+    if (!mapper || !result) return UCRA_ERR_INVALID_ARGUMENT;
+
+    memset(result, 0, sizeof(UCRA_FlagMapResult));
+    if (!arena || arena_size < ucra_flag_mapper_arena_size(mapper)) {
+        return UCRA_ERR_INVALID_ARGUMENT;
+    }
+
+    /* Layout: inputs, flags, warnings, then text written as needed */
+    UCRA_TRACE_BEGIN(apply);
+    const UCRA_FlagMapperIndex* index = mapper->index;
+    char* base = (char*)arena;
+    size_t offset = (sizeof(void*) - (uintptr_t)base % sizeof(void*)) % sizeof(void*);
+    const char** inputs = (const char**)(base + offset);
+    offset += (index ? index->source_count : 0) * sizeof(const char*);
+    UCRA_KeyValue* flags = (UCRA_KeyValue*)(base + offset);
+    offset += mapper->rule_count * sizeof(UCRA_KeyValue);
+    char** warnings = (char**)(base + offset);
+    offset += mapper->rule_count * sizeof(char*);
+    char* text = base + offset;
+
+    if (index) {
+        ucra_find_inputs(index, legacy_flags, legacy_count, inputs);
+    }
+
+    uint32_t flag_count = 0;
+    uint32_t warning_count = 0;
+    for (uint32_t i = 0; i < mapper->rule_count; i++) {
+        const UCRA_FlagRule* rule = &mapper->rules[i];
+        const char* value;
+        const char* warning;
+        ucra_apply_transform(rule, index, index ? &index->rules[i] : NULL,
+                             ucra_rule_input(mapper, i, inputs, legacy_flags, legacy_count),
+                             text, text + UCRA_MAP_NUMBER_SIZE, &value, &warning);
+
+        /* keep the text buffers only if the rule wrote into them */
+        if (value) {
+            flags[flag_count].key = rule->target_name;
+            flags[flag_count].value = value;
             flag_count++;
         }
-
         if (warning) {
-            result->warnings[warning_count] = warning;
-            warning_count++;
+            warnings[warning_count++] = (char*)warning;
+        }
+        if (value == text) {
+            text += UCRA_MAP_NUMBER_SIZE;
+        } else if (warning == text + UCRA_MAP_NUMBER_SIZE) {
+            memmove(text, warning, strlen(warning) + 1);
+            warnings[warning_count - 1] = text;
+            text += strlen(text) + 1;
         }
     }
 
+    result->flags = flags;
     result->flag_count = flag_count;
+    result->warnings = warnings;
     result->warning_count = warning_count;
+    UCRA_TRACE_END(apply, "flag_mapper.apply_into");
+    return UCRA_SUCCESS;
+}
+
+/* Convert text to type; 0 if it does not convert */
+static int ucra_typed_from_text(UCRA_ValueType type, const char* text, UCRA_TypedValue* out) {
+    out->type = type;
+    out->number = 0.0;
+    out->text = NULL;
+    if (type == UCRA_VALUE_STRING) {
+        out->text = text;
+        return 1;
+    }
+    if (type == UCRA_VALUE_BOOL) {
+        static const char* const truths[] = { "true", "yes", "on" };
+        static const char* const lies[] = { "false", "no", "off" };
+        for (int i = 0; i < 3; i++) {
+            if (strcmp(text, truths[i]) == 0) { out->number = 1.0; return 1; }
+            if (strcmp(text, lies[i]) == 0) return 1;
+        }
+    }
+    char* endptr;
+    double number = strtod(text, &endptr);
+    if (endptr == text || *endptr != '\0') return 0;
+    if (type == UCRA_VALUE_INT) {
+        number = floor(number + 0.5);
+    } else if (type == UCRA_VALUE_BOOL) {
+        number = number != 0.0;
+    } else if (type == UCRA_VALUE_ENUM) {
+        out->text = text; /* an enum given by number has no index in the rule */
+    }
+    out->number = number;
+    return 1;
+}
+
+UCRA_API UCRA_Result UCRA_CALL ucra_flag_mapper_apply_typed(const UCRA_FlagMapper* mapper,
+                                                          const UCRA_KeyValue* legacy_flags, uint32_t legacy_count,
+                                                          UCRA_TypedValue* out_values, uint32_t capacity,
+                                                          uint32_t* out_count) {
+    if (!mapper || !out_count) return UCRA_ERR_INVALID_ARGUMENT;
+    *out_count = 0;
+    if (capacity < mapper->rule_count || (!out_values && mapper->rule_count > 0)) {
+        return UCRA_ERR_INVALID_ARGUMENT;
+    }
+
+    /* Mappers with more distinct sources than fit on the stack search linearly */
+    UCRA_TRACE_BEGIN(apply);
+    const UCRA_FlagMapperIndex* index = mapper->index;
+    const char* stack_inputs[UCRA_MAPPER_STACK_SOURCES];
+    const char** inputs = NULL;
+    if (index && index->source_count <= UCRA_MAPPER_STACK_SOURCES) {
+        inputs = stack_inputs;
+        ucra_find_inputs(index, legacy_flags, legacy_count, inputs);
+    }
+
+    uint32_t count = 0;
+    for (uint32_t i = 0; i < mapper->rule_count; i++) {
+        const UCRA_FlagRule* rule = &mapper->rules[i];
+        const UCRA_RuleIndex* entry = index ? &index->rules[i] : NULL;
+        const char* input = ucra_rule_input(mapper, i, inputs, legacy_flags, legacy_count);
+        UCRA_TypedValue* out = &out_values[count];
+        out->key = rule->target_name;
+        int converted = 0;
+
+        if (input && rule->transform_kind == UCRA_TRANSFORM_SCALE) {
+            /* the scaled number as is, without the "%.6g" text of the string result */
+            char* endptr;
+            double val = strtod(input, &endptr);
+            if (endptr != input && *endptr == '\0') {
+                double span = entry ? entry->scale_span : rule->scale_max - rule->scale_min;
+                double number = rule->scale_min + span * val;
+                out->type = rule->value_type == UCRA_VALUE_INT || rule->value_type == UCRA_VALUE_BOOL
+                                ? rule->value_type : UCRA_VALUE_FLOAT;
+                out->number = out->type == UCRA_VALUE_INT ? floor(number + 0.5)
+                            : out->type == UCRA_VALUE_BOOL ? (double)(number != 0.0) : number;
+                out->text = NULL;
+                converted = 1;
+            }
+        } else if (rule->value_type == UCRA_VALUE_ENUM && rule->transform_kind == UCRA_TRANSFORM_MAP) {
+            /* a mapped input or a default that names one of the map's values */
+            int32_t found = input ? ucra_find_map_entry(rule, index, entry, input) : -1;
+            for (uint32_t m = 0; !input && rule->default_value && m < rule->map_count; m++) {
+                if (rule->map_values[m] && strcmp(rule->map_values[m], rule->default_value) == 0) {
+                    found = (int32_t)m;
+                    break;
+                }
+            }
+            if (found >= 0) {
+                out->type = UCRA_VALUE_ENUM;
+                out->number = found;
+                out->text = rule->map_values[found];
+                converted = out->text != NULL;
+            } else if (!input && rule->default_value) {
+                converted = ucra_typed_from_text(UCRA_VALUE_STRING, rule->default_value, out);
+            }
+        } else {
+            char number[UCRA_MAP_NUMBER_SIZE];
+            char message[UCRA_MAP_MESSAGE_SIZE];
+            const char* value;
+            const char* warning;
+            ucra_apply_transform(rule, index, entry, input, number, message, &value, &warning);
+            converted = value && value != number && ucra_typed_from_text(rule->value_type, value, out);
+        }
+        count += converted;
+    }
 
+    *out_count = count;
+    UCRA_TRACE_END(apply, "flag_mapper.apply_typed");
     return UCRA_SUCCESS;
 }
 
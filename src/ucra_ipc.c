@@ -0,0 +1,1006 @@
+/*
+ * UCRA IPC Engine Transport
+ * A client and an engine host share one memory block holding two inline PCM
+ * rings of 32-bit words: requests flow to the host, responses and PCM flow
+ * back. Each direction has a "data" and a "space" doorbell, process-shared
+ * condition variables that a side rings after writing or reading, so neither
+ * side spins. Messages are a word count followed by that many words:
+ *
+ *     CREATE  options                         -> status
+ *     INFO                                    -> status, string
+ *     QUERY   config                          -> status, frames, samples
+ *     RENDER  capacity, config                -> status, frames, channels, rate, samples, PCM
+ *     BLOCK   start, frame_count, config      -> status, samples, PCM
+ *     QUIT
+ *
+ * A config is its scalars, then its notes with lyrics and curves inline, its
+ * options and its typed options. PCM follows its header through the same
+ * ring, so a render longer than the ring is taken while it is still being
+ * written. Waits give up when the other process has exited, so a crashing
+ * host fails the call instead of hanging it.
+ */
+
+#include "ucra_ipc.h"
+#include "ucra_ring.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef _WIN32
+    #include <errno.h>
+    #include <fcntl.h>
+    #include <pthread.h>
+    #include <signal.h>
+    #include <spawn.h>
+    #include <stdio.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <sys/wait.h>
+    #include <time.h>
+    #include <unistd.h>
+
+extern char** environ;
+#endif
+
+#define UCRA_IPC_CHANNEL_ARG "--ucra-ipc"
+
+#ifndef _WIN32
+
+#define IPC_MAGIC 0x43504955u    /* "UIPC" */
+#define IPC_VERSION 1u
+#define IPC_REQUEST_WORDS (1u << 16)   /* 256 KiB of requests in flight */
+#define IPC_RESPONSE_WORDS (1u << 18)  /* 1 MiB of PCM in flight */
+#define IPC_POLL_MS 100                /* how often a waiting side checks on the other */
+#define IPC_HANDSHAKE_MS 10000         /* how long a new host has to answer */
+#define IPC_NO_STRING 0xffffffffu
+#define IPC_NO_CAPACITY UINT64_MAX
+
+enum {
+    IPC_OP_CREATE = 1,
+    IPC_OP_INFO,
+    IPC_OP_QUERY,
+    IPC_OP_RENDER,
+    IPC_OP_BLOCK,
+    IPC_OP_QUIT,
+    IPC_OP_CAPS     /* hosts that predate it answer UCRA_ERR_NOT_SUPPORTED */
+};
+
+/* ---------------------------------------------------------------------------
+ * Shared block
+ * ------------------------------------------------------------------------- */
+
+typedef struct IpcDoorbell {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    uint32_t rung;
+} IpcDoorbell;
+
+typedef struct IpcShared {
+    uint32_t magic;
+    uint32_t version;
+    size_t request_offset;  /* bytes from the block start to each ring */
+    size_t response_offset;
+    IpcDoorbell request_data, request_space;
+    IpcDoorbell response_data, response_space;
+} IpcShared;
+
+/* The other process, watched while waiting for it */
+typedef struct IpcPeer {
+    pid_t pid;
+    int is_child; /* the client reaps its host */
+    int exited;
+} IpcPeer;
+
+/* One side of a connection */
+typedef struct IpcChannel {
+    IpcShared* shared;
+    size_t size;
+    UCRA_Ring* request;
+    UCRA_Ring* response;
+    IpcPeer peer;
+    uint32_t* message;       /* last received message, grown as needed */
+    size_t message_capacity; /* in words */
+} IpcChannel;
+
+static size_t align_up(size_t size) {
+    return (size + 63) & ~(size_t)63;
+}
+
+static int doorbell_init(IpcDoorbell* bell) {
+    pthread_mutexattr_t mutex_attr;
+    pthread_condattr_t cond_attr;
+    int failed = pthread_mutexattr_init(&mutex_attr) != 0;
+    if (!failed) {
+        failed = pthread_mutexattr_setpshared(&mutex_attr, PTHREAD_PROCESS_SHARED) != 0 ||
+                 pthread_mutex_init(&bell->mutex, &mutex_attr) != 0;
+        pthread_mutexattr_destroy(&mutex_attr);
+    }
+    if (!failed && pthread_condattr_init(&cond_attr) == 0) {
+        failed = pthread_condattr_setpshared(&cond_attr, PTHREAD_PROCESS_SHARED) != 0 ||
+                 pthread_cond_init(&bell->cond, &cond_attr) != 0;
+        pthread_condattr_destroy(&cond_attr);
+    }
+    bell->rung = 0;
+    return failed ? -1 : 0;
+}
+
+static void doorbell_ring(IpcDoorbell* bell) {
+    pthread_mutex_lock(&bell->mutex);
+    bell->rung = 1;
+    pthread_cond_signal(&bell->cond);
+    pthread_mutex_unlock(&bell->mutex);
+}
+
+static int peer_alive(IpcPeer* peer) {
+    if (peer->exited) return 0;
+    if (peer->is_child) {
+        int status;
+        if (waitpid(peer->pid, &status, WNOHANG) == peer->pid) peer->exited = 1;
+    } else if (kill(peer->pid, 0) != 0 && errno == ESRCH) {
+        peer->exited = 1;
+    }
+    return !peer->exited;
+}
+
+/* Wait until bell is rung; 0 once it is, -1 if the peer exited or timeout_ms (0: none) passed */
+static int doorbell_wait(IpcDoorbell* bell, IpcPeer* peer, uint32_t timeout_ms) {
+    uint32_t waited_ms = 0;
+    pthread_mutex_lock(&bell->mutex);
+    while (!bell->rung) {
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_nsec += IPC_POLL_MS * 1000000L;
+        if (deadline.tv_nsec >= 1000000000L) {
+            deadline.tv_sec += 1;
+            deadline.tv_nsec -= 1000000000L;
+        }
+        if (pthread_cond_timedwait(&bell->cond, &bell->mutex, &deadline) == ETIMEDOUT) {
+            waited_ms += IPC_POLL_MS;
+            if (!peer_alive(peer) || (timeout_ms && waited_ms >= timeout_ms)) {
+                pthread_mutex_unlock(&bell->mutex);
+                return -1;
+            }
+        }
+    }
+    /* every ring before this one is answered by the caller looking at its ring again */
+    bell->rung = 0;
+    pthread_mutex_unlock(&bell->mutex);
+    return 0;
+}
+
+/* Write count words into ring, waiting for room; -1 if the peer is gone */
+static int ring_send(IpcChannel* channel, UCRA_Ring* ring, IpcDoorbell* data, IpcDoorbell* space,
+                     const void* words, uint64_t count) {
+    const float* next = (const float*)words;
+    while (count > 0) {
+        uint32_t chunk = count > ring->capacity ? ring->capacity : (uint32_t)count;
+        uint32_t written = ucra_ring_write(ring, next, chunk);
+        if (written > 0) {
+            next += written;
+            count -= written;
+            doorbell_ring(data);
+        } else if (doorbell_wait(space, &channel->peer, 0) != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/* Read count words from ring into out, waiting for them; -1 if the peer is gone */
+static int ring_receive(IpcChannel* channel, UCRA_Ring* ring, IpcDoorbell* data, IpcDoorbell* space,
+                        void* out, uint64_t count, uint32_t timeout_ms) {
+    float* next = (float*)out;
+    while (count > 0) {
+        uint32_t chunk = count > ring->capacity ? ring->capacity : (uint32_t)count;
+        uint32_t read = ucra_ring_read(ring, next, chunk);
+        if (read > 0) {
+            next += read;
+            count -= read;
+            doorbell_ring(space);
+        } else if (doorbell_wait(data, &channel->peer, timeout_ms) != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/* Receive one message into channel->message; returns its length in words, or -1 */
+static int64_t receive_message(IpcChannel* channel, UCRA_Ring* ring, IpcDoorbell* data,
+                               IpcDoorbell* space, uint32_t timeout_ms) {
+    uint32_t length = 0;
+    if (ring_receive(channel, ring, data, space, &length, 1, timeout_ms) != 0) return -1;
+    if (length > channel->message_capacity) {
+        uint32_t* grown = (uint32_t*)realloc(channel->message, (size_t)length * sizeof(uint32_t));
+        if (!grown) return -1;
+        channel->message = grown;
+        channel->message_capacity = length;
+    }
+    if (ring_receive(channel, ring, data, space, channel->message, length, timeout_ms) != 0) return -1;
+    return length;
+}
+
+/* ---------------------------------------------------------------------------
+ * Message encoding
+ * ------------------------------------------------------------------------- */
+
+/* Grows a message; word 0 is reserved for its length */
+typedef struct IpcWriter {
+    uint32_t* words;
+    size_t count;
+    size_t capacity;
+    int failed;
+} IpcWriter;
+
+static uint32_t* writer_reserve(IpcWriter* w, size_t words) {
+    if (w->failed) return NULL;
+    if (w->count + words > w->capacity) {
+        size_t capacity = w->capacity ? w->capacity * 2 : 256;
+        while (capacity < w->count + words) capacity *= 2;
+        uint32_t* grown = (uint32_t*)realloc(w->words, capacity * sizeof(uint32_t));
+        if (!grown) {
+            w->failed = 1;
+            return NULL;
+        }
+        w->words = grown;
+        w->capacity = capacity;
+    }
+    uint32_t* at = w->words + w->count;
+    w->count += words;
+    return at;
+}
+
+static void writer_begin(IpcWriter* w) {
+    w->count = 0;
+    w->failed = 0;
+    writer_reserve(w, 1);
+}
+
+static void put_u32(IpcWriter* w, uint32_t value) {
+    uint32_t* at = writer_reserve(w, 1);
+    if (at) *at = value;
+}
+
+static void put_bytes(IpcWriter* w, const void* bytes, size_t size) {
+    uint32_t* at = writer_reserve(w, (size + 3) / 4);
+    if (!at) return;
+    memcpy(at, bytes, size);
+    if (size % 4) memset((char*)at + size, 0, 4 - size % 4);
+}
+
+static void put_u64(IpcWriter* w, uint64_t value) { put_bytes(w, &value, sizeof(value)); }
+static void put_f64(IpcWriter* w, double value) { put_bytes(w, &value, sizeof(value)); }
+
+static void put_string(IpcWriter* w, const char* s) {
+    if (!s) {
+        put_u32(w, IPC_NO_STRING);
+        return;
+    }
+    size_t length = strlen(s);
+    put_u32(w, (uint32_t)length);
+    put_bytes(w, s, length + 1);
+}
+
+/* A curve as its length and two arrays; no curve is IPC_NO_STRING */
+static void put_curve(IpcWriter* w, const float* times, const float* values, uint32_t length, int present) {
+    if (!present) {
+        put_u32(w, IPC_NO_STRING);
+        return;
+    }
+    put_u32(w, length);
+    put_bytes(w, times, (size_t)length * sizeof(float));
+    put_bytes(w, values, (size_t)length * sizeof(float));
+}
+
+static void put_options(IpcWriter* w, const UCRA_KeyValue* options, uint32_t count) {
+    put_u32(w, options ? count : 0);
+    for (uint32_t i = 0; options && i < count; ++i) {
+        put_string(w, options[i].key);
+        put_string(w, options[i].value);
+    }
+}
+
+static void put_config(IpcWriter* w, const UCRA_RenderConfig* config) {
+    put_u32(w, config->sample_rate);
+    put_u32(w, config->channels);
+    put_u32(w, config->block_size);
+    put_u32(w, config->flags);
+    uint32_t note_count = config->notes ? config->note_count : 0;
+    put_u32(w, note_count);
+    for (uint32_t i = 0; i < note_count; ++i) {
+        const UCRA_NoteSegment* note = &config->notes[i];
+        put_f64(w, note->start_sec);
+        put_f64(w, note->duration_sec);
+        put_u32(w, (uint32_t)(int32_t)note->midi_note);
+        put_u32(w, note->velocity);
+        put_string(w, note->lyric);
+        const UCRA_F0Curve* f0 = note->f0_override;
+        const UCRA_EnvCurve* env = note->env_override;
+        put_curve(w, f0 ? f0->time_sec : NULL, f0 ? f0->f0_hz : NULL, f0 ? f0->length : 0, f0 != NULL);
+        put_curve(w, env ? env->time_sec : NULL, env ? env->value : NULL, env ? env->length : 0, env != NULL);
+    }
+    put_options(w, config->options, config->option_count);
+    /* typed options exist only in configs that say so */
+    uint32_t typed_count = (config->flags & UCRA_RENDER_TYPED_OPTIONS) && config->typed_options
+                               ? config->typed_option_count : 0;
+    put_u32(w, typed_count);
+    for (uint32_t i = 0; i < typed_count; ++i) {
+        put_string(w, config->typed_options[i].key);
+        put_u32(w, (uint32_t)config->typed_options[i].type);
+        put_f64(w, config->typed_options[i].number);
+        put_string(w, config->typed_options[i].text);
+    }
+}
+
+/* Walks a received message; any read past its end sets failed */
+typedef struct IpcReader {
+    const uint32_t* words;
+    size_t count;
+    size_t pos;
+    int failed;
+} IpcReader;
+
+static const void* get_bytes(IpcReader* r, size_t size) {
+    size_t words = (size + 3) / 4;
+    if (r->failed || words > r->count - r->pos) {
+        r->failed = 1;
+        return NULL;
+    }
+    const void* at = r->words + r->pos;
+    r->pos += words;
+    return at;
+}
+
+static uint32_t get_u32(IpcReader* r) {
+    const uint32_t* at = (const uint32_t*)get_bytes(r, 4);
+    return at ? *at : 0;
+}
+
+static uint64_t get_u64(IpcReader* r) {
+    uint64_t value = 0;
+    const void* at = get_bytes(r, sizeof(value));
+    if (at) memcpy(&value, at, sizeof(value));
+    return value;
+}
+
+static double get_f64(IpcReader* r) {
+    double value = 0.0;
+    const void* at = get_bytes(r, sizeof(value));
+    if (at) memcpy(&value, at, sizeof(value));
+    return value;
+}
+
+/* A string in place in the message, or NULL */
+static const char* get_string(IpcReader* r) {
+    uint32_t length = get_u32(r);
+    if (length == IPC_NO_STRING || r->failed) return NULL;
+    const char* s = (const char*)get_bytes(r, (size_t)length + 1);
+    if (s && s[length] != '\0') r->failed = 1;
+    return r->failed ? NULL : s;
+}
+
+/* ---------------------------------------------------------------------------
+ * Host
+ * ------------------------------------------------------------------------- */
+
+/* Config decoded in place, with the arrays a config points at */
+typedef struct IpcDecoded {
+    UCRA_RenderConfig config;
+    UCRA_NoteSegment* notes;
+    UCRA_F0Curve* f0;
+    UCRA_EnvCurve* env;
+    uint32_t note_capacity;
+    UCRA_KeyValue* options;
+    uint32_t option_capacity;
+    UCRA_TypedValue* typed;
+    uint32_t typed_capacity;
+} IpcDecoded;
+
+static int grow(void** array, uint32_t* capacity, uint32_t count, size_t item) {
+    if (count <= *capacity) return 0;
+    void* grown = realloc(*array, (size_t)count * item);
+    if (!grown) return -1;
+    *array = grown;
+    *capacity = count;
+    return 0;
+}
+
+static UCRA_Result get_options(IpcReader* r, UCRA_KeyValue** options, uint32_t* capacity, uint32_t* out_count) {
+    uint32_t count = get_u32(r);
+    if (r->failed || count > r->count) return UCRA_ERR_INVALID_ARGUMENT;
+    if (grow((void**)options, capacity, count, sizeof(UCRA_KeyValue)) != 0) return UCRA_ERR_OUT_OF_MEMORY;
+    for (uint32_t i = 0; i < count; ++i) {
+        (*options)[i].key = get_string(r);
+        (*options)[i].value = get_string(r);
+    }
+    *out_count = count;
+    return r->failed ? UCRA_ERR_INVALID_ARGUMENT : UCRA_SUCCESS;
+}
+
+static UCRA_Result get_config(IpcReader* r, IpcDecoded* d) {
+    UCRA_RenderConfig* config = &d->config;
+    memset(config, 0, sizeof(*config));
+    config->sample_rate = get_u32(r);
+    config->channels = get_u32(r);
+    config->block_size = get_u32(r);
+    config->flags = get_u32(r);
+    uint32_t note_count = get_u32(r);
+    if (r->failed || note_count > r->count) return UCRA_ERR_INVALID_ARGUMENT;
+
+    uint32_t capacity = d->note_capacity;
+    if (grow((void**)&d->notes, &capacity, note_count, sizeof(UCRA_NoteSegment)) != 0) return UCRA_ERR_OUT_OF_MEMORY;
+    capacity = d->note_capacity;
+    if (grow((void**)&d->f0, &capacity, note_count, sizeof(UCRA_F0Curve)) != 0) return UCRA_ERR_OUT_OF_MEMORY;
+    capacity = d->note_capacity;
+    if (grow((void**)&d->env, &capacity, note_count, sizeof(UCRA_EnvCurve)) != 0) return UCRA_ERR_OUT_OF_MEMORY;
+    d->note_capacity = capacity;
+
+    for (uint32_t i = 0; i < note_count && !r->failed; ++i) {
+        UCRA_NoteSegment* note = &d->notes[i];
+        note->start_sec = get_f64(r);
+        note->duration_sec = get_f64(r);
+        note->midi_note = (int16_t)(int32_t)get_u32(r);
+        note->velocity = (uint8_t)get_u32(r);
+        note->lyric = get_string(r);
+
+        uint32_t length = get_u32(r);
+        note->f0_override = NULL;
+        if (length != IPC_NO_STRING) {
+            d->f0[i].length = length;
+            d->f0[i].time_sec = (const float*)get_bytes(r, (size_t)length * sizeof(float));
+            d->f0[i].f0_hz = (const float*)get_bytes(r, (size_t)length * sizeof(float));
+            note->f0_override = &d->f0[i];
+        }
+        length = get_u32(r);
+        note->env_override = NULL;
+        if (length != IPC_NO_STRING) {
+            d->env[i].length = length;
+            d->env[i].time_sec = (const float*)get_bytes(r, (size_t)length * sizeof(float));
+            d->env[i].value = (const float*)get_bytes(r, (size_t)length * sizeof(float));
+            note->env_override = &d->env[i];
+        }
+    }
+    config->notes = d->notes;
+    config->note_count = note_count;
+
+    UCRA_Result result = get_options(r, &d->options, &d->option_capacity, &config->option_count);
+    if (result != UCRA_SUCCESS) return result;
+    config->options = d->options;
+
+    uint32_t typed_count = get_u32(r);
+    if (r->failed || typed_count > r->count) return UCRA_ERR_INVALID_ARGUMENT;
+    if (grow((void**)&d->typed, &d->typed_capacity, typed_count, sizeof(UCRA_TypedValue)) != 0) {
+        return UCRA_ERR_OUT_OF_MEMORY;
+    }
+    for (uint32_t i = 0; i < typed_count; ++i) {
+        d->typed[i].key = get_string(r);
+        d->typed[i].type = (UCRA_ValueType)get_u32(r);
+        d->typed[i].number = get_f64(r);
+        d->typed[i].text = get_string(r);
+    }
+    config->typed_options = d->typed;
+    config->typed_option_count = typed_count;
+    return r->failed ? UCRA_ERR_INVALID_ARGUMENT : UCRA_SUCCESS;
+}
+
+static uint64_t layout_samples(uint32_t flags, uint64_t frames, uint32_t channels) {
+    return UCRA_RENDER_LAYOUT(flags) == UCRA_RENDER_LAYOUT_MONO ? frames : frames * channels;
+}
+
+/* Finish w as a message and send it with the PCM that follows it */
+static int send_response(IpcChannel* channel, IpcWriter* w, const float* pcm, uint64_t samples) {
+    if (w->failed) return -1;
+    w->words[0] = (uint32_t)(w->count - 1);
+    if (ring_send(channel, channel->response, &channel->shared->response_data,
+                  &channel->shared->response_space, w->words, w->count) != 0) {
+        return -1;
+    }
+    if (samples == 0) return 0;
+    return ring_send(channel, channel->response, &channel->shared->response_data,
+                     &channel->shared->response_space, pcm, samples);
+}
+
+static const UCRA_EngineTable g_builtin_table = {
+    UCRA_ENGINE_ABI_VERSION, sizeof(UCRA_EngineTable),
+    ucra_engine_create, ucra_engine_destroy, ucra_render,
+    ucra_engine_getinfo, ucra_render_query_size, ucra_render_into, ucra_render_batch, ucra_render_block,
+    ucra_engine_get_capabilities
+};
+
+#define TABLE_HAS(table, member) \
+    ((table)->struct_size >= offsetof(UCRA_EngineTable, member) + sizeof((table)->member) && \
+     (table)->member != NULL)
+
+/* Serve requests until QUIT or the client exits */
+static UCRA_Result serve(IpcChannel* channel, const UCRA_EngineTable* table) {
+    IpcShared* shared = channel->shared;
+    IpcWriter w = { NULL, 0, 0, 0 };
+    IpcDecoded decoded;
+    memset(&decoded, 0, sizeof(decoded));
+    UCRA_KeyValue* create_options = NULL;
+    uint32_t create_capacity = 0;
+    float* pcm = NULL;
+    size_t pcm_capacity = 0;
+    UCRA_Handle engine = NULL;
+    UCRA_Result exit_result = UCRA_SUCCESS;
+
+    for (;;) {
+        int64_t length = receive_message(channel, channel->request, &shared->request_data,
+                                         &shared->request_space, 0);
+        if (length < 0) break; /* client is gone */
+        IpcReader r = { channel->message, (size_t)length, 0, 0 };
+        uint32_t op = get_u32(&r);
+        if (op == IPC_OP_QUIT) break;
+
+        writer_begin(&w);
+        UCRA_Result result = UCRA_ERR_INVALID_ARGUMENT;
+        const float* out = NULL;
+        uint64_t out_samples = 0;
+
+        if (op == IPC_OP_CREATE) {
+            uint32_t count = 0;
+            result = get_options(&r, &create_options, &create_capacity, &count);
+            if (result == UCRA_SUCCESS && !engine) {
+                result = table->engine_create(&engine, create_options, count);
+            }
+            put_u32(&w, (uint32_t)result);
+        } else if (!engine) {
+            put_u32(&w, (uint32_t)UCRA_ERR_INVALID_ARGUMENT);
+        } else if (op == IPC_OP_INFO) {
+            char info[512] = "";
+            result = TABLE_HAS(table, engine_getinfo) ? table->engine_getinfo(engine, info, sizeof(info))
+                                                     : UCRA_ERR_NOT_SUPPORTED;
+            put_u32(&w, (uint32_t)result);
+            put_string(&w, result == UCRA_SUCCESS ? info : NULL);
+        } else if (op == IPC_OP_CAPS) {
+            uint32_t caps = 0;
+            result = TABLE_HAS(table, engine_get_capabilities) ? table->engine_get_capabilities(engine, &caps)
+                                                              : UCRA_SUCCESS;
+            put_u32(&w, (uint32_t)result);
+            put_u32(&w, caps);
+        } else if (op == IPC_OP_QUERY) {
+            uint64_t frames = 0, samples = 0;
+            result = get_config(&r, &decoded);
+            if (result == UCRA_SUCCESS) {
+                result = TABLE_HAS(table, render_query_size)
+                             ? table->render_query_size(engine, &decoded.config, &frames, &samples)
+                             : UCRA_ERR_NOT_SUPPORTED;
+            }
+            put_u32(&w, (uint32_t)result);
+            put_u64(&w, frames);
+            put_u64(&w, samples);
+        } else if (op == IPC_OP_RENDER) {
+            uint64_t capacity = get_u64(&r);
+            UCRA_RenderResult rendered;
+            memset(&rendered, 0, sizeof(rendered));
+            result = get_config(&r, &decoded);
+            if (result == UCRA_SUCCESS) result = table->render(engine, &decoded.config, &rendered);
+            uint64_t samples = layout_samples(decoded.config.flags, rendered.frames, rendered.channels);
+            if (result == UCRA_SUCCESS && samples > capacity) {
+                result = UCRA_ERR_INVALID_ARGUMENT; /* the caller's buffer is too small */
+            }
+            if (result == UCRA_SUCCESS) {
+                out = rendered.pcm;
+                out_samples = samples;
+            }
+            put_u32(&w, (uint32_t)result);
+            put_u64(&w, rendered.frames);
+            put_u32(&w, rendered.channels);
+            put_u32(&w, rendered.sample_rate);
+            put_u64(&w, out_samples);
+        } else if (op == IPC_OP_BLOCK) {
+            uint64_t start_frame = get_u64(&r);
+            uint32_t frame_count = get_u32(&r);
+            result = get_config(&r, &decoded);
+            uint32_t channels = decoded.config.channels > 0 ? decoded.config.channels : 1;
+            uint64_t samples = layout_samples(decoded.config.flags, frame_count, channels);
+            if (result == UCRA_SUCCESS && !TABLE_HAS(table, render_block)) result = UCRA_ERR_NOT_SUPPORTED;
+            if (result == UCRA_SUCCESS && samples > pcm_capacity) {
+                float* grown = (float*)realloc(pcm, (size_t)samples * sizeof(float));
+                if (grown) {
+                    pcm = grown;
+                    pcm_capacity = (size_t)samples;
+                } else {
+                    result = UCRA_ERR_OUT_OF_MEMORY;
+                }
+            }
+            if (result == UCRA_SUCCESS) {
+                result = table->render_block(engine, &decoded.config, start_frame, frame_count, pcm);
+            }
+            if (result == UCRA_SUCCESS) {
+                out = pcm;
+                out_samples = samples;
+            }
+            put_u32(&w, (uint32_t)result);
+            put_u64(&w, out_samples);
+        } else {
+            put_u32(&w, (uint32_t)UCRA_ERR_NOT_SUPPORTED);
+        }
+
+        if (send_response(channel, &w, out, out_samples) != 0) {
+            exit_result = w.failed ? UCRA_ERR_OUT_OF_MEMORY : UCRA_SUCCESS;
+            break;
+        }
+    }
+
+    if (engine) table->engine_destroy(engine);
+    free(w.words);
+    free(decoded.notes);
+    free(decoded.f0);
+    free(decoded.env);
+    free(decoded.options);
+    free(decoded.typed);
+    free(create_options);
+    free(pcm);
+    return exit_result;
+}
+
+UCRA_Result UCRA_CALL ucra_ipc_serve(int argc, char** argv, const UCRA_EngineTable* table) {
+    const char* name = NULL;
+    for (int i = 1; argv && i + 1 < argc; ++i) {
+        if (strcmp(argv[i], UCRA_IPC_CHANNEL_ARG) == 0) name = argv[i + 1];
+    }
+    if (!name) return UCRA_ERR_INVALID_ARGUMENT;
+    if (!table) table = &g_builtin_table;
+    if (table->abi_version != UCRA_ENGINE_ABI_VERSION || !table->engine_create ||
+        !table->engine_destroy || !table->render) {
+        return UCRA_ERR_INVALID_ARGUMENT;
+    }
+
+    int fd = shm_open(name, O_RDWR, 0);
+    if (fd < 0) return UCRA_ERR_FILE_NOT_FOUND;
+    struct stat st;
+    void* block = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && (size_t)st.st_size >= sizeof(IpcShared)) {
+        block = mmap(NULL, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (block == MAP_FAILED) return UCRA_ERR_INVALID_ARGUMENT;
+
+    IpcChannel channel;
+    memset(&channel, 0, sizeof(channel));
+    channel.shared = (IpcShared*)block;
+    channel.size = (size_t)st.st_size;
+    UCRA_Result result = UCRA_ERR_INVALID_ARGUMENT;
+    if (channel.shared->magic == IPC_MAGIC && channel.shared->version == IPC_VERSION &&
+        channel.shared->response_offset < channel.size && channel.shared->request_offset < channel.size) {
+        channel.request = (UCRA_Ring*)(void*)((char*)block + channel.shared->request_offset);
+        channel.response = (UCRA_Ring*)(void*)((char*)block + channel.shared->response_offset);
+        channel.peer.pid = getppid();
+        result = serve(&channel, table);
+    }
+    free(channel.message);
+    munmap(block, channel.size);
+    return result;
+}
+
+/* ---------------------------------------------------------------------------
+ * Client
+ * ------------------------------------------------------------------------- */
+
+typedef struct IpcClient {
+    IpcChannel channel;
+    IpcWriter writer;
+    int broken;     /* the host exited; every call fails */
+    float* pcm;     /* PCM of the last ucra_render(), owned by the engine */
+    size_t pcm_capacity;
+} IpcClient;
+
+/* Send the request in c->writer and receive the response header into c->channel.message */
+static UCRA_Result client_call(IpcClient* c, IpcReader* response, uint32_t timeout_ms) {
+    if (c->broken) return UCRA_ERR_INTERNAL;
+    if (c->writer.failed) return UCRA_ERR_OUT_OF_MEMORY;
+    IpcChannel* channel = &c->channel;
+    IpcShared* shared = channel->shared;
+    c->writer.words[0] = (uint32_t)(c->writer.count - 1);
+    int64_t length = -1;
+    if (ring_send(channel, channel->request, &shared->request_data, &shared->request_space,
+                  c->writer.words, c->writer.count) == 0) {
+        length = receive_message(channel, channel->response, &shared->response_data,
+                                 &shared->response_space, timeout_ms);
+    }
+    if (length < 0) {
+        c->broken = 1;
+        return UCRA_ERR_INTERNAL;
+    }
+    response->words = channel->message;
+    response->count = (size_t)length;
+    response->pos = 0;
+    response->failed = 0;
+    return (UCRA_Result)get_u32(response);
+}
+
+/* Receive the PCM following a response */
+static UCRA_Result client_receive(IpcClient* c, float* out, uint64_t samples) {
+    IpcChannel* channel = &c->channel;
+    if (ring_receive(channel, channel->response, &channel->shared->response_data,
+                     &channel->shared->response_space, out, samples, 0) != 0) {
+        c->broken = 1;
+        return UCRA_ERR_INTERNAL;
+    }
+    return UCRA_SUCCESS;
+}
+
+static void client_free(IpcClient* c) {
+    if (c->channel.peer.pid > 0 && !c->channel.peer.exited) {
+        if (!c->broken) {
+            writer_begin(&c->writer);
+            put_u32(&c->writer, IPC_OP_QUIT);
+            if (!c->writer.failed) {
+                c->writer.words[0] = (uint32_t)(c->writer.count - 1);
+                ring_send(&c->channel, c->channel.request, &c->channel.shared->request_data,
+                          &c->channel.shared->request_space, c->writer.words, c->writer.count);
+            } else {
+                kill(c->channel.peer.pid, SIGTERM);
+            }
+        }
+        int status;
+        waitpid(c->channel.peer.pid, &status, 0);
+    }
+    if (c->channel.shared) munmap(c->channel.shared, c->channel.size);
+    free(c->channel.message);
+    free(c->writer.words);
+    free(c->pcm);
+    free(c);
+}
+
+static UCRA_Result UCRA_CALL ipc_create(UCRA_Handle* outEngine, const UCRA_KeyValue* options,
+                                        uint32_t option_count) {
+    /* connections are made by ucra_ipc_engine_create(), which knows the host */
+    (void)outEngine;
+    (void)options;
+    (void)option_count;
+    return UCRA_ERR_NOT_SUPPORTED;
+}
+
+static void UCRA_CALL ipc_destroy(UCRA_Handle engine) {
+    client_free((IpcClient*)(void*)engine);
+}
+
+static UCRA_Result UCRA_CALL ipc_getinfo(UCRA_Handle engine, char* outBuffer, size_t buffer_size) {
+    IpcClient* c = (IpcClient*)(void*)engine;
+    if (!outBuffer || buffer_size == 0) return UCRA_ERR_INVALID_ARGUMENT;
+    writer_begin(&c->writer);
+    put_u32(&c->writer, IPC_OP_INFO);
+    IpcReader response;
+    UCRA_Result result = client_call(c, &response, 0);
+    if (result != UCRA_SUCCESS) return result;
+    const char* info = get_string(&response);
+    if (!info) return UCRA_ERR_INTERNAL;
+    size_t length = strlen(info);
+    if (length + 1 > buffer_size) return UCRA_ERR_INVALID_ARGUMENT;
+    memcpy(outBuffer, info, length + 1);
+    return UCRA_SUCCESS;
+}
+
+static UCRA_Result UCRA_CALL ipc_get_capabilities(UCRA_Handle engine, uint32_t* out_caps) {
+    IpcClient* c = (IpcClient*)(void*)engine;
+    if (!out_caps) return UCRA_ERR_INVALID_ARGUMENT;
+    *out_caps = 0;
+    writer_begin(&c->writer);
+    put_u32(&c->writer, IPC_OP_CAPS);
+    IpcReader response;
+    UCRA_Result result = client_call(c, &response, 0);
+    uint32_t caps = get_u32(&response);
+    if (result == UCRA_ERR_NOT_SUPPORTED) return UCRA_SUCCESS; /* an older host: none claimed */
+    if (result != UCRA_SUCCESS) return result;
+    if (response.failed) return UCRA_ERR_INTERNAL;
+    *out_caps = caps;
+    return UCRA_SUCCESS;
+}
+
+static UCRA_Result UCRA_CALL ipc_query_size(UCRA_Handle engine, const UCRA_RenderConfig* config,
+                                            uint64_t* out_frames, uint64_t* out_samples) {
+    IpcClient* c = (IpcClient*)(void*)engine;
+    if (!config) return UCRA_ERR_INVALID_ARGUMENT;
+    writer_begin(&c->writer);
+    put_u32(&c->writer, IPC_OP_QUERY);
+    put_config(&c->writer, config);
+    IpcReader response;
+    UCRA_Result result = client_call(c, &response, 0);
+    uint64_t frames = get_u64(&response);
+    uint64_t samples = get_u64(&response);
+    if (result != UCRA_SUCCESS) return result;
+    if (out_frames) *out_frames = frames;
+    if (out_samples) *out_samples = samples;
+    return UCRA_SUCCESS;
+}
+
+/* RENDER into out (NULL: the engine's own buffer) holding capacity samples */
+static UCRA_Result client_render(IpcClient* c, const UCRA_RenderConfig* config, float* out,
+                                 uint64_t capacity, UCRA_RenderResult* outResult) {
+    if (!config || !outResult) return UCRA_ERR_INVALID_ARGUMENT;
+    memset(outResult, 0, sizeof(*outResult));
+    writer_begin(&c->writer);
+    put_u32(&c->writer, IPC_OP_RENDER);
+    put_u64(&c->writer, capacity);
+    put_config(&c->writer, config);
+    IpcReader response;
+    UCRA_Result result = client_call(c, &response, 0);
+    outResult->frames = get_u64(&response);
+    outResult->channels = get_u32(&response);
+    outResult->sample_rate = get_u32(&response);
+    uint64_t samples = get_u64(&response);
+    if (response.failed && result == UCRA_SUCCESS) result = UCRA_ERR_INTERNAL;
+    outResult->status = result;
+    if (result != UCRA_SUCCESS) return result;
+
+    if (!out) {
+        if (samples > c->pcm_capacity) {
+            float* grown = (float*)realloc(c->pcm, (size_t)samples * sizeof(float));
+            if (!grown) {
+                /* the PCM is already on its way and must be taken off the ring */
+                while (samples > 0 && result == UCRA_SUCCESS) {
+                    float sink[256];
+                    uint64_t n = samples < 256 ? samples : 256;
+                    result = client_receive(c, sink, n);
+                    samples -= n;
+                }
+                outResult->status = UCRA_ERR_OUT_OF_MEMORY;
+                return UCRA_ERR_OUT_OF_MEMORY;
+            }
+            c->pcm = grown;
+            c->pcm_capacity = (size_t)samples;
+        }
+        out = c->pcm;
+    }
+    result = client_receive(c, out, samples);
+    outResult->status = result;
+    outResult->pcm = result == UCRA_SUCCESS && samples > 0 ? out : NULL;
+    return result;
+}
+
+static UCRA_Result UCRA_CALL ipc_render(UCRA_Handle engine, const UCRA_RenderConfig* config,
+                                        UCRA_RenderResult* outResult) {
+    return client_render((IpcClient*)(void*)engine, config, NULL, IPC_NO_CAPACITY, outResult);
+}
+
+static UCRA_Result UCRA_CALL ipc_render_into(UCRA_Handle engine, const UCRA_RenderConfig* config,
+                                             float* out_pcm, uint64_t capacity_samples,
+                                             UCRA_RenderResult* outResult) {
+    if (!out_pcm) capacity_samples = 0;
+    return client_render((IpcClient*)(void*)engine, config, out_pcm, capacity_samples, outResult);
+}
+
+static UCRA_Result UCRA_CALL ipc_render_block(UCRA_Handle engine, const UCRA_RenderConfig* config,
+                                              uint64_t start_frame, uint32_t frame_count, float* out_pcm) {
+    IpcClient* c = (IpcClient*)(void*)engine;
+    if (!config || (frame_count > 0 && !out_pcm)) return UCRA_ERR_INVALID_ARGUMENT;
+    writer_begin(&c->writer);
+    put_u32(&c->writer, IPC_OP_BLOCK);
+    put_u64(&c->writer, start_frame);
+    put_u32(&c->writer, frame_count);
+    put_config(&c->writer, config);
+    IpcReader response;
+    UCRA_Result result = client_call(c, &response, 0);
+    uint64_t samples = get_u64(&response);
+    if (result != UCRA_SUCCESS) return result;
+    uint32_t channels = config->channels > 0 ? config->channels : 1;
+    if (response.failed || samples != layout_samples(config->flags, frame_count, channels)) {
+        c->broken = 1; /* the ring no longer lines up with the protocol */
+        return UCRA_ERR_INTERNAL;
+    }
+    return client_receive(c, out_pcm, samples);
+}
+
+static const UCRA_EngineTable g_client_table = {
+    UCRA_ENGINE_ABI_VERSION, sizeof(UCRA_EngineTable),
+    ipc_create, ipc_destroy, ipc_render,
+    ipc_getinfo, ipc_query_size, ipc_render_into,
+    NULL, /* batches would serialize on the one host anyway */
+    ipc_render_block,
+    ipc_get_capabilities
+};
+
+/* Create, size and map the shared block under a fresh name */
+static UCRA_Result create_block(IpcChannel* channel, char* name, size_t name_size) {
+    static volatile uint32_t counter;
+    size_t request_offset = align_up(sizeof(IpcShared));
+    size_t response_offset = request_offset + align_up(ucra_ring_inline_size(IPC_REQUEST_WORDS, 1));
+    size_t size = response_offset + ucra_ring_inline_size(IPC_RESPONSE_WORDS, 1);
+
+    int fd = -1;
+    for (int attempt = 0; attempt < 16 && fd < 0; ++attempt) {
+        snprintf(name, name_size, "/ucra-ipc-%ld-%u", (long)getpid(),
+                 (unsigned)__atomic_add_fetch(&counter, 1, __ATOMIC_RELAXED));
+        fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    }
+    if (fd < 0) return UCRA_ERR_INTERNAL;
+    void* block = MAP_FAILED;
+    if (ftruncate(fd, (off_t)size) == 0) {
+        block = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (block == MAP_FAILED) {
+        shm_unlink(name);
+        return UCRA_ERR_OUT_OF_MEMORY;
+    }
+
+    IpcShared* shared = (IpcShared*)block;
+    channel->shared = shared;
+    channel->size = size;
+    channel->request = (UCRA_Ring*)(void*)((char*)block + request_offset);
+    channel->response = (UCRA_Ring*)(void*)((char*)block + response_offset);
+    shared->request_offset = request_offset;
+    shared->response_offset = response_offset;
+    if (ucra_ring_init_inline(channel->request, IPC_REQUEST_WORDS, 1) != UCRA_SUCCESS ||
+        ucra_ring_init_inline(channel->response, IPC_RESPONSE_WORDS, 1) != UCRA_SUCCESS ||
+        doorbell_init(&shared->request_data) != 0 || doorbell_init(&shared->request_space) != 0 ||
+        doorbell_init(&shared->response_data) != 0 || doorbell_init(&shared->response_space) != 0) {
+        shm_unlink(name);
+        return UCRA_ERR_NOT_SUPPORTED;
+    }
+    shared->version = IPC_VERSION;
+    shared->magic = IPC_MAGIC;
+    return UCRA_SUCCESS;
+}
+
+UCRA_Result ucra_ipc_engine_create(const char* host_path,
+                                   const UCRA_KeyValue* options,
+                                   uint32_t option_count,
+                                   UCRA_Handle* out_inner,
+                                   const UCRA_EngineTable** out_table) {
+    if (!host_path || !out_inner || !out_table) return UCRA_ERR_INVALID_ARGUMENT;
+    if (access(host_path, X_OK) != 0) return UCRA_ERR_FILE_NOT_FOUND;
+    IpcClient* c = (IpcClient*)calloc(1, sizeof(IpcClient));
+    if (!c) return UCRA_ERR_OUT_OF_MEMORY;
+
+    char name[64];
+    UCRA_Result result = create_block(&c->channel, name, sizeof(name));
+    if (result != UCRA_SUCCESS) {
+        client_free(c);
+        return result;
+    }
+
+    char* argv[] = { (char*)host_path, (char*)UCRA_IPC_CHANNEL_ARG, name, NULL };
+    pid_t pid;
+    if (posix_spawn(&pid, host_path, NULL, NULL, argv, environ) != 0) {
+        shm_unlink(name);
+        client_free(c);
+        return UCRA_ERR_FILE_NOT_FOUND;
+    }
+    c->channel.peer.pid = pid;
+    c->channel.peer.is_child = 1;
+
+    /* The host answers CREATE once it has mapped the block, which can then lose its name */
+    writer_begin(&c->writer);
+    put_u32(&c->writer, IPC_OP_CREATE);
+    put_options(&c->writer, options, option_count);
+    IpcReader response;
+    result = client_call(c, &response, IPC_HANDSHAKE_MS);
+    shm_unlink(name);
+    if (c->broken) {
+        kill(pid, SIGKILL); /* whatever it is, it is not an engine host */
+        result = UCRA_ERR_NOT_SUPPORTED;
+    }
+    if (result != UCRA_SUCCESS) {
+        client_free(c);
+        return result;
+    }
+    *out_inner = (UCRA_Handle)(void*)c;
+    *out_table = &g_client_table;
+    return UCRA_SUCCESS;
+}
+
+#else /* _WIN32 */
+
+UCRA_Result UCRA_CALL ucra_ipc_serve(int argc, char** argv, const UCRA_EngineTable* table) {
+    (void)argc;
+    (void)argv;
+    (void)table;
+    return UCRA_ERR_NOT_SUPPORTED;
+}
+
+UCRA_Result ucra_ipc_engine_create(const char* host_path,
+                                   const UCRA_KeyValue* options,
+                                   uint32_t option_count,
+                                   UCRA_Handle* out_inner,
+                                   const UCRA_EngineTable** out_table) {
+    (void)host_path;
+    (void)options;
+    (void)option_count;
+    (void)out_inner;
+    (void)out_table;
+    return UCRA_ERR_NOT_SUPPORTED;
+}
+
+#endif
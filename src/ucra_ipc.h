@@ -0,0 +1,39 @@
+/*
+ * UCRA IPC Engine Client (internal)
+ * Engines of an "ipc" manifest entry run in a host process launched once per
+ * engine and kept until the engine is destroyed. Requests and PCM travel
+ * through two inline PCM rings in one shared memory block; see ucra_ipc.c
+ * for the protocol and ucra_ipc_serve() in ucra.h for the host side.
+ */
+#ifndef UCRA_IPC_H
+#define UCRA_IPC_H
+
+#include "ucra/ucra.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Launch host_path as an engine host and create its engine
+ *
+ * @param host_path Executable serving the protocol through ucra_ipc_serve()
+ * @param options Engine options, passed to the host's engine_create
+ * @param option_count Number of options
+ * @param out_inner Receives the connection, the handle out_table's functions take
+ * @param out_table Receives the table forwarding calls to the host
+ * @return UCRA_SUCCESS; UCRA_ERR_FILE_NOT_FOUND if host_path cannot be run;
+ *         UCRA_ERR_NOT_SUPPORTED if it does not answer as a host, or on
+ *         Windows; or the error of the host's engine_create
+ */
+UCRA_Result ucra_ipc_engine_create(const char* host_path,
+                                   const UCRA_KeyValue* options,
+                                   uint32_t option_count,
+                                   UCRA_Handle* out_inner,
+                                   const UCRA_EngineTable** out_table);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* UCRA_IPC_H */
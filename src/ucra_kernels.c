@@ -0,0 +1,755 @@
+/*
+ * UCRA DSP Kernels
+ * Scalar reference kernels plus SSE2/AVX2 (x86) and NEON (AArch64) variants,
+ * selected at runtime from the CPU features. The vector sample conversions
+ * read little-endian input as the host's own byte order.
+ */
+
+#include "ucra_kernels.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+    #define UCRA_KERNELS_X86 1
+    #include <emmintrin.h>
+    #include <immintrin.h>
+    #if defined(_MSC_VER)
+        #include <intrin.h>
+        #define UCRA_TARGET_AVX2
+    #else
+        #define UCRA_TARGET_AVX2 __attribute__((target("avx2")))
+    #endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+    #define UCRA_KERNELS_NEON 1
+    #include <arm_neon.h>
+#endif
+
+#define UCRA_TWO_PI 6.283185307179586476925286766559
+/* 2*pi split so that k * hi is exact for the k values seen after reduction */
+#define UCRA_TWO_PI_HI 6.28125f
+#define UCRA_TWO_PI_LO 1.9353071795864769253e-3f
+#define UCRA_INV_TWO_PI 0.15915494309189533577f
+#define UCRA_PI_F 3.14159265358979323846f
+#define UCRA_HALF_PI_F 1.57079632679489661923f
+
+/* odd Taylor coefficients of sin on [-pi/2, pi/2]; error stays below 1e-7 */
+#define UCRA_SIN_C3  -1.6666666666666666e-1f
+#define UCRA_SIN_C5   8.3333333333333333e-3f
+#define UCRA_SIN_C7  -1.9841269841269841e-4f
+#define UCRA_SIN_C9   2.7557319223985891e-6f
+#define UCRA_SIN_C11 -2.5052108385441719e-8f
+
+/* reduce a double phase to [0, 2*pi) */
+static double wrap_phase(double phase) {
+    return phase - floor(phase / UCRA_TWO_PI) * UCRA_TWO_PI;
+}
+
+/* polynomial sine matching the vector kernels, used for their tails */
+static float poly_sinf(float x) {
+    float k = floorf(x * UCRA_INV_TWO_PI + 0.5f);
+    x = (x - k * UCRA_TWO_PI_HI) - k * UCRA_TWO_PI_LO;
+    if (x > UCRA_HALF_PI_F) x = UCRA_PI_F - x;
+    else if (x < -UCRA_HALF_PI_F) x = -UCRA_PI_F - x;
+    float x2 = x * x;
+    float p = UCRA_SIN_C11;
+    p = p * x2 + UCRA_SIN_C9;
+    p = p * x2 + UCRA_SIN_C7;
+    p = p * x2 + UCRA_SIN_C5;
+    p = p * x2 + UCRA_SIN_C3;
+    p = p * x2 + 1.0f;
+    return p * x;
+}
+
+/* ------------------------------------------------------------------ */
+/* Scalar reference kernels                                            */
+/* ------------------------------------------------------------------ */
+
+static void scalar_sine_ramp_mac(float* out, uint32_t n, double phase, double inc, float amp) {
+    for (uint32_t i = 0; i < n; i++) {
+        out[i] += amp * (float)sin(phase + (double)i * inc);
+    }
+}
+
+static void scalar_sine_mac(float* out, const float* phase, const float* amp, uint32_t n) {
+    for (uint32_t i = 0; i < n; i++) {
+        out[i] += amp[i] * (float)sin((double)phase[i]);
+    }
+}
+
+static void scalar_gain_mac(float* dst, const float* src, uint32_t n, float gain) {
+    for (uint32_t i = 0; i < n; i++) {
+        dst[i] += src[i] * gain;
+    }
+}
+
+static void scalar_clip(float* buf, uint32_t n, float lo, float hi) {
+    for (uint32_t i = 0; i < n; i++) {
+        float v = buf[i];
+        buf[i] = v > hi ? hi : (v < lo ? lo : v);
+    }
+}
+
+static void scalar_fan_out(float* dst, const float* mono, uint32_t frames, uint32_t channels) {
+    if (channels == 1) {
+        memcpy(dst, mono, (size_t)frames * sizeof(float));
+        return;
+    }
+    for (uint32_t f = 0; f < frames; f++) {
+        for (uint32_t c = 0; c < channels; c++) {
+            dst[(size_t)f * channels + c] = mono[f];
+        }
+    }
+}
+
+static void scalar_quantize(int32_t* dst, const float* src, const float* dither, uint32_t n,
+                            float scale, float hi) {
+    const float lo = -hi - 1.0f;
+    for (uint32_t i = 0; i < n; i++) {
+        float v = src[i] * scale + (dither ? dither[i] : 0.0f);
+        v = v >= lo ? v : lo; /* also catches NaN */
+        v = v < hi ? v : hi;
+        dst[i] = (int32_t)lrintf(v);
+    }
+}
+
+static void scalar_pcm16_to_float(float* dst, const unsigned char* src, uint32_t n) {
+    for (uint32_t i = 0; i < n; i++, src += 2) {
+        dst[i] = (int16_t)(uint16_t)(src[0] | (src[1] << 8)) / 32768.0f;
+    }
+}
+
+static void scalar_pcm24_to_float(float* dst, const unsigned char* src, uint32_t n) {
+    for (uint32_t i = 0; i < n; i++, src += 3) {
+        int32_t v = (int32_t)((uint32_t)src[0] << 8 | (uint32_t)src[1] << 16 | (uint32_t)src[2] << 24) >> 8;
+        dst[i] = v / 8388608.0f;
+    }
+}
+
+static void scalar_downmix(float* dst, const float* src, uint32_t frames, uint32_t channels) {
+    if (channels == 1) {
+        memcpy(dst, src, (size_t)frames * sizeof(float));
+        return;
+    }
+    for (uint32_t f = 0; f < frames; f++, src += channels) {
+        float sum = 0.0f;
+        for (uint32_t c = 0; c < channels; c++) {
+            sum += src[c];
+        }
+        dst[f] = sum / channels;
+    }
+}
+
+static float scalar_dot(const float* a, const float* b, uint32_t n) {
+    float sum = 0.0f;
+    for (uint32_t i = 0; i < n; i++) {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+static const UCRA_Kernels g_scalar_kernels = {
+    "scalar",
+    scalar_sine_ramp_mac,
+    scalar_sine_mac,
+    scalar_gain_mac,
+    scalar_clip,
+    scalar_fan_out,
+    scalar_quantize,
+    scalar_pcm16_to_float,
+    scalar_pcm24_to_float,
+    scalar_downmix,
+    scalar_dot
+};
+
+/* ------------------------------------------------------------------ */
+/* SSE2 kernels                                                        */
+/* ------------------------------------------------------------------ */
+
+#ifdef UCRA_KERNELS_X86
+
+static __m128 sse2_sin_ps(__m128 x) {
+    const __m128 pi = _mm_set1_ps(UCRA_PI_F);
+    const __m128 half_pi = _mm_set1_ps(UCRA_HALF_PI_F);
+    const __m128 neg_half_pi = _mm_set1_ps(-UCRA_HALF_PI_F);
+
+    /* x -= round(x / 2pi) * 2pi, leaving x in [-pi, pi] */
+    __m128 k = _mm_cvtepi32_ps(_mm_cvtps_epi32(_mm_mul_ps(x, _mm_set1_ps(UCRA_INV_TWO_PI))));
+    x = _mm_sub_ps(x, _mm_mul_ps(k, _mm_set1_ps(UCRA_TWO_PI_HI)));
+    x = _mm_sub_ps(x, _mm_mul_ps(k, _mm_set1_ps(UCRA_TWO_PI_LO)));
+
+    /* fold into [-pi/2, pi/2] using sin(pi - x) == sin(x) */
+    __m128 hi = _mm_cmpgt_ps(x, half_pi);
+    __m128 lo = _mm_cmplt_ps(x, neg_half_pi);
+    __m128 folded_hi = _mm_sub_ps(pi, x);
+    __m128 folded_lo = _mm_sub_ps(_mm_sub_ps(_mm_setzero_ps(), pi), x);
+    __m128 keep = _mm_andnot_ps(_mm_or_ps(hi, lo), x);
+    x = _mm_or_ps(keep, _mm_or_ps(_mm_and_ps(hi, folded_hi), _mm_and_ps(lo, folded_lo)));
+
+    __m128 x2 = _mm_mul_ps(x, x);
+    __m128 p = _mm_set1_ps(UCRA_SIN_C11);
+    p = _mm_add_ps(_mm_mul_ps(p, x2), _mm_set1_ps(UCRA_SIN_C9));
+    p = _mm_add_ps(_mm_mul_ps(p, x2), _mm_set1_ps(UCRA_SIN_C7));
+    p = _mm_add_ps(_mm_mul_ps(p, x2), _mm_set1_ps(UCRA_SIN_C5));
+    p = _mm_add_ps(_mm_mul_ps(p, x2), _mm_set1_ps(UCRA_SIN_C3));
+    p = _mm_add_ps(_mm_mul_ps(p, x2), _mm_set1_ps(1.0f));
+    return _mm_mul_ps(p, x);
+}
+
+static void sse2_sine_ramp_mac(float* out, uint32_t n, double phase, double inc, float amp) {
+    const __m128 lanes = _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f);
+    const __m128 incf = _mm_set1_ps((float)inc);
+    const __m128 ampv = _mm_set1_ps(amp);
+    uint32_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        /* re-anchor every vector so float lanes never drift from the double phase */
+        float base = (float)wrap_phase(phase + (double)i * inc);
+        __m128 x = _mm_add_ps(_mm_set1_ps(base), _mm_mul_ps(lanes, incf));
+        __m128 acc = _mm_loadu_ps(out + i);
+        _mm_storeu_ps(out + i, _mm_add_ps(acc, _mm_mul_ps(ampv, sse2_sin_ps(x))));
+    }
+    for (; i < n; i++) {
+        out[i] += amp * poly_sinf((float)wrap_phase(phase + (double)i * inc));
+    }
+}
+
+static void sse2_sine_mac(float* out, const float* phase, const float* amp, uint32_t n) {
+    uint32_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 s = sse2_sin_ps(_mm_loadu_ps(phase + i));
+        __m128 acc = _mm_loadu_ps(out + i);
+        _mm_storeu_ps(out + i, _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(amp + i), s)));
+    }
+    for (; i < n; i++) {
+        out[i] += amp[i] * poly_sinf(phase[i]);
+    }
+}
+
+static void sse2_gain_mac(float* dst, const float* src, uint32_t n, float gain) {
+    const __m128 g = _mm_set1_ps(gain);
+    uint32_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 acc = _mm_loadu_ps(dst + i);
+        _mm_storeu_ps(dst + i, _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(src + i), g)));
+    }
+    for (; i < n; i++) {
+        dst[i] += src[i] * gain;
+    }
+}
+
+static void sse2_clip(float* buf, uint32_t n, float lo, float hi) {
+    const __m128 lov = _mm_set1_ps(lo);
+    const __m128 hiv = _mm_set1_ps(hi);
+    uint32_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 v = _mm_loadu_ps(buf + i);
+        _mm_storeu_ps(buf + i, _mm_max_ps(lov, _mm_min_ps(hiv, v)));
+    }
+    scalar_clip(buf + i, n - i, lo, hi);
+}
+
+static void sse2_fan_out(float* dst, const float* mono, uint32_t frames, uint32_t channels) {
+    if (channels != 2) {
+        scalar_fan_out(dst, mono, frames, channels);
+        return;
+    }
+    uint32_t f = 0;
+    for (; f + 4 <= frames; f += 4) {
+        __m128 m = _mm_loadu_ps(mono + f);
+        _mm_storeu_ps(dst + (size_t)f * 2, _mm_unpacklo_ps(m, m));
+        _mm_storeu_ps(dst + (size_t)f * 2 + 4, _mm_unpackhi_ps(m, m));
+    }
+    scalar_fan_out(dst + (size_t)f * 2, mono + f, frames - f, 2);
+}
+
+/* cvtps2dq rounds to nearest even, as lrintf does in the default rounding mode */
+static void sse2_quantize(int32_t* dst, const float* src, const float* dither, uint32_t n,
+                          float scale, float hi) {
+    const __m128 s = _mm_set1_ps(scale);
+    const __m128 lov = _mm_set1_ps(-hi - 1.0f);
+    const __m128 hiv = _mm_set1_ps(hi);
+    uint32_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 v = _mm_mul_ps(_mm_loadu_ps(src + i), s);
+        if (dither) v = _mm_add_ps(v, _mm_loadu_ps(dither + i));
+        v = _mm_min_ps(_mm_max_ps(v, lov), hiv); /* maxps returns its second operand for NaN */
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_cvtps_epi32(v));
+    }
+    scalar_quantize(dst + i, src + i, dither ? dither + i : NULL, n - i, scale, hi);
+}
+
+static void sse2_pcm16_to_float(float* dst, const unsigned char* src, uint32_t n) {
+    const __m128 k = _mm_set1_ps(1.0f / 32768.0f);
+    uint32_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m128i v = _mm_loadu_si128((const __m128i*)(src + (size_t)i * 2));
+        /* each sample into the top half of a 32-bit lane, then shifted down with its sign */
+        __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+        __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+        _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), k));
+        _mm_storeu_ps(dst + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), k));
+    }
+    scalar_pcm16_to_float(dst + i, src + (size_t)i * 2, n - i);
+}
+
+static void sse2_downmix(float* dst, const float* src, uint32_t frames, uint32_t channels) {
+    if (channels != 2) {
+        scalar_downmix(dst, src, frames, channels);
+        return;
+    }
+    const __m128 half = _mm_set1_ps(0.5f);
+    uint32_t f = 0;
+    for (; f + 4 <= frames; f += 4) {
+        __m128 a = _mm_loadu_ps(src + (size_t)f * 2);
+        __m128 b = _mm_loadu_ps(src + (size_t)f * 2 + 4);
+        __m128 left = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+        __m128 right = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+        _mm_storeu_ps(dst + f, _mm_mul_ps(_mm_add_ps(left, right), half));
+    }
+    scalar_downmix(dst + f, src + (size_t)f * 2, frames - f, 2);
+}
+
+static float sse2_dot(const float* a, const float* b, uint32_t n) {
+    __m128 acc0 = _mm_setzero_ps(), acc1 = _mm_setzero_ps();
+    uint32_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+        acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+    }
+    __m128 acc = _mm_add_ps(acc0, acc1);
+    acc = _mm_add_ps(acc, _mm_movehl_ps(acc, acc));
+    acc = _mm_add_ss(acc, _mm_shuffle_ps(acc, acc, 1));
+    return _mm_cvtss_f32(acc) + scalar_dot(a + i, b + i, n - i);
+}
+
+static const UCRA_Kernels g_sse2_kernels = {
+    "sse2",
+    sse2_sine_ramp_mac,
+    sse2_sine_mac,
+    sse2_gain_mac,
+    sse2_clip,
+    sse2_fan_out,
+    sse2_quantize,
+    sse2_pcm16_to_float,
+    scalar_pcm24_to_float, /* SSE2 has no byte shuffle worth the unpacking */
+    sse2_downmix,
+    sse2_dot
+};
+
+/* ------------------------------------------------------------------ */
+/* AVX2 kernels                                                        */
+/* ------------------------------------------------------------------ */
+
+UCRA_TARGET_AVX2
+static __m256 avx2_sin_ps(__m256 x) {
+    const __m256 pi = _mm256_set1_ps(UCRA_PI_F);
+    const __m256 neg_pi = _mm256_set1_ps(-UCRA_PI_F);
+    const __m256 half_pi = _mm256_set1_ps(UCRA_HALF_PI_F);
+    const __m256 neg_half_pi = _mm256_set1_ps(-UCRA_HALF_PI_F);
+
+    __m256 k = _mm256_round_ps(_mm256_mul_ps(x, _mm256_set1_ps(UCRA_INV_TWO_PI)),
+                               _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    x = _mm256_sub_ps(x, _mm256_mul_ps(k, _mm256_set1_ps(UCRA_TWO_PI_HI)));
+    x = _mm256_sub_ps(x, _mm256_mul_ps(k, _mm256_set1_ps(UCRA_TWO_PI_LO)));
+
+    __m256 hi = _mm256_cmp_ps(x, half_pi, _CMP_GT_OQ);
+    __m256 lo = _mm256_cmp_ps(x, neg_half_pi, _CMP_LT_OQ);
+    x = _mm256_blendv_ps(x, _mm256_sub_ps(pi, x), hi);
+    x = _mm256_blendv_ps(x, _mm256_sub_ps(neg_pi, x), lo);
+
+    __m256 x2 = _mm256_mul_ps(x, x);
+    __m256 p = _mm256_set1_ps(UCRA_SIN_C11);
+    p = _mm256_add_ps(_mm256_mul_ps(p, x2), _mm256_set1_ps(UCRA_SIN_C9));
+    p = _mm256_add_ps(_mm256_mul_ps(p, x2), _mm256_set1_ps(UCRA_SIN_C7));
+    p = _mm256_add_ps(_mm256_mul_ps(p, x2), _mm256_set1_ps(UCRA_SIN_C5));
+    p = _mm256_add_ps(_mm256_mul_ps(p, x2), _mm256_set1_ps(UCRA_SIN_C3));
+    p = _mm256_add_ps(_mm256_mul_ps(p, x2), _mm256_set1_ps(1.0f));
+    return _mm256_mul_ps(p, x);
+}
+
+UCRA_TARGET_AVX2
+static void avx2_sine_ramp_mac(float* out, uint32_t n, double phase, double inc, float amp) {
+    const __m256 lanes = _mm256_set_ps(7.0f, 6.0f, 5.0f, 4.0f, 3.0f, 2.0f, 1.0f, 0.0f);
+    const __m256 incf = _mm256_set1_ps((float)inc);
+    const __m256 ampv = _mm256_set1_ps(amp);
+    uint32_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        float base = (float)wrap_phase(phase + (double)i * inc);
+        __m256 x = _mm256_add_ps(_mm256_set1_ps(base), _mm256_mul_ps(lanes, incf));
+        __m256 acc = _mm256_loadu_ps(out + i);
+        _mm256_storeu_ps(out + i, _mm256_add_ps(acc, _mm256_mul_ps(ampv, avx2_sin_ps(x))));
+    }
+    for (; i < n; i++) {
+        out[i] += amp * poly_sinf((float)wrap_phase(phase + (double)i * inc));
+    }
+}
+
+UCRA_TARGET_AVX2
+static void avx2_sine_mac(float* out, const float* phase, const float* amp, uint32_t n) {
+    uint32_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 s = avx2_sin_ps(_mm256_loadu_ps(phase + i));
+        __m256 acc = _mm256_loadu_ps(out + i);
+        _mm256_storeu_ps(out + i, _mm256_add_ps(acc, _mm256_mul_ps(_mm256_loadu_ps(amp + i), s)));
+    }
+    for (; i < n; i++) {
+        out[i] += amp[i] * poly_sinf(phase[i]);
+    }
+}
+
+UCRA_TARGET_AVX2
+static void avx2_gain_mac(float* dst, const float* src, uint32_t n, float gain) {
+    const __m256 g = _mm256_set1_ps(gain);
+    uint32_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 acc = _mm256_loadu_ps(dst + i);
+        _mm256_storeu_ps(dst + i, _mm256_add_ps(acc, _mm256_mul_ps(_mm256_loadu_ps(src + i), g)));
+    }
+    for (; i < n; i++) {
+        dst[i] += src[i] * gain;
+    }
+}
+
+UCRA_TARGET_AVX2
+static void avx2_clip(float* buf, uint32_t n, float lo, float hi) {
+    const __m256 lov = _mm256_set1_ps(lo);
+    const __m256 hiv = _mm256_set1_ps(hi);
+    uint32_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 v = _mm256_loadu_ps(buf + i);
+        _mm256_storeu_ps(buf + i, _mm256_max_ps(lov, _mm256_min_ps(hiv, v)));
+    }
+    scalar_clip(buf + i, n - i, lo, hi);
+}
+
+UCRA_TARGET_AVX2
+static void avx2_fan_out(float* dst, const float* mono, uint32_t frames, uint32_t channels) {
+    if (channels != 2) {
+        scalar_fan_out(dst, mono, frames, channels);
+        return;
+    }
+    uint32_t f = 0;
+    for (; f + 8 <= frames; f += 8) {
+        __m256 m = _mm256_loadu_ps(mono + f);
+        __m256 lo = _mm256_unpacklo_ps(m, m); /* f0 f0 f1 f1 | f4 f4 f5 f5 */
+        __m256 hi = _mm256_unpackhi_ps(m, m); /* f2 f2 f3 f3 | f6 f6 f7 f7 */
+        _mm256_storeu_ps(dst + (size_t)f * 2, _mm256_permute2f128_ps(lo, hi, 0x20));
+        _mm256_storeu_ps(dst + (size_t)f * 2 + 8, _mm256_permute2f128_ps(lo, hi, 0x31));
+    }
+    scalar_fan_out(dst + (size_t)f * 2, mono + f, frames - f, 2);
+}
+
+UCRA_TARGET_AVX2
+static void avx2_quantize(int32_t* dst, const float* src, const float* dither, uint32_t n,
+                          float scale, float hi) {
+    const __m256 s = _mm256_set1_ps(scale);
+    const __m256 lov = _mm256_set1_ps(-hi - 1.0f);
+    const __m256 hiv = _mm256_set1_ps(hi);
+    uint32_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 v = _mm256_mul_ps(_mm256_loadu_ps(src + i), s);
+        if (dither) v = _mm256_add_ps(v, _mm256_loadu_ps(dither + i));
+        v = _mm256_min_ps(_mm256_max_ps(v, lov), hiv);
+        _mm256_storeu_si256((__m256i*)(dst + i), _mm256_cvtps_epi32(v));
+    }
+    scalar_quantize(dst + i, src + i, dither ? dither + i : NULL, n - i, scale, hi);
+}
+
+UCRA_TARGET_AVX2
+static void avx2_pcm16_to_float(float* dst, const unsigned char* src, uint32_t n) {
+    const __m256 k = _mm256_set1_ps(1.0f / 32768.0f);
+    uint32_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i v = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i*)(src + (size_t)i * 2)));
+        _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_cvtepi32_ps(v), k));
+    }
+    scalar_pcm16_to_float(dst + i, src + (size_t)i * 2, n - i);
+}
+
+UCRA_TARGET_AVX2
+static void avx2_pcm24_to_float(float* dst, const unsigned char* src, uint32_t n) {
+    const __m256 k = _mm256_set1_ps(1.0f / 8388608.0f);
+    /* bytes 0-11 to the low lane and 12-23 to the high one, then in each lane every sample
+     * into the top three bytes of a 32-bit slot */
+    const __m256i spread = _mm256_setr_epi32(0, 1, 2, 3, 3, 4, 5, 6);
+    const __m256i place = _mm256_setr_epi8(-1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11,
+                                           -1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11);
+    uint32_t i = 0;
+    /* each step loads 32 bytes for 24, so stop while 8 more bytes are still in src */
+    for (; i + 11 <= n; i += 8) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(src + (size_t)i * 3));
+        v = _mm256_shuffle_epi8(_mm256_permutevar8x32_epi32(v, spread), place);
+        _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_srai_epi32(v, 8)), k));
+    }
+    scalar_pcm24_to_float(dst + i, src + (size_t)i * 3, n - i);
+}
+
+UCRA_TARGET_AVX2
+static float avx2_dot(const float* a, const float* b, uint32_t n) {
+    __m256 acc0 = _mm256_setzero_ps(), acc1 = _mm256_setzero_ps();
+    uint32_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        acc0 = _mm256_add_ps(acc0, _mm256_mul_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+        acc1 = _mm256_add_ps(acc1, _mm256_mul_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8)));
+    }
+    __m256 acc8 = _mm256_add_ps(acc0, acc1);
+    __m128 acc = _mm_add_ps(_mm256_castps256_ps128(acc8), _mm256_extractf128_ps(acc8, 1));
+    acc = _mm_add_ps(acc, _mm_movehl_ps(acc, acc));
+    acc = _mm_add_ss(acc, _mm_shuffle_ps(acc, acc, 1));
+    return _mm_cvtss_f32(acc) + sse2_dot(a + i, b + i, n - i);
+}
+
+static const UCRA_Kernels g_avx2_kernels = {
+    "avx2",
+    avx2_sine_ramp_mac,
+    avx2_sine_mac,
+    avx2_gain_mac,
+    avx2_clip,
+    avx2_fan_out,
+    avx2_quantize,
+    avx2_pcm16_to_float,
+    avx2_pcm24_to_float,
+    sse2_downmix,
+    avx2_dot
+};
+
+static int cpu_has_avx2(void) {
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) return 0;
+    __cpuid(info, 1);
+    int osxsave = (info[2] >> 27) & 1;
+    int avx = (info[2] >> 28) & 1;
+    if (!osxsave || !avx) return 0;
+    if ((_xgetbv(0) & 0x6) != 0x6) return 0; /* OS saves XMM and YMM state */
+    __cpuidex(info, 7, 0);
+    return (info[1] >> 5) & 1;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif /* UCRA_KERNELS_X86 */
+
+/* ------------------------------------------------------------------ */
+/* NEON kernels                                                        */
+/* ------------------------------------------------------------------ */
+
+#ifdef UCRA_KERNELS_NEON
+
+static float32x4_t neon_sin_ps(float32x4_t x) {
+    const float32x4_t pi = vdupq_n_f32(UCRA_PI_F);
+    const float32x4_t neg_pi = vdupq_n_f32(-UCRA_PI_F);
+    const float32x4_t half_pi = vdupq_n_f32(UCRA_HALF_PI_F);
+    const float32x4_t neg_half_pi = vdupq_n_f32(-UCRA_HALF_PI_F);
+
+    float32x4_t k = vrndnq_f32(vmulq_n_f32(x, UCRA_INV_TWO_PI));
+    x = vsubq_f32(x, vmulq_n_f32(k, UCRA_TWO_PI_HI));
+    x = vsubq_f32(x, vmulq_n_f32(k, UCRA_TWO_PI_LO));
+
+    uint32x4_t hi = vcgtq_f32(x, half_pi);
+    uint32x4_t lo = vcltq_f32(x, neg_half_pi);
+    x = vbslq_f32(hi, vsubq_f32(pi, x), x);
+    x = vbslq_f32(lo, vsubq_f32(neg_pi, x), x);
+
+    float32x4_t x2 = vmulq_f32(x, x);
+    float32x4_t p = vdupq_n_f32(UCRA_SIN_C11);
+    p = vaddq_f32(vmulq_f32(p, x2), vdupq_n_f32(UCRA_SIN_C9));
+    p = vaddq_f32(vmulq_f32(p, x2), vdupq_n_f32(UCRA_SIN_C7));
+    p = vaddq_f32(vmulq_f32(p, x2), vdupq_n_f32(UCRA_SIN_C5));
+    p = vaddq_f32(vmulq_f32(p, x2), vdupq_n_f32(UCRA_SIN_C3));
+    p = vaddq_f32(vmulq_f32(p, x2), vdupq_n_f32(1.0f));
+    return vmulq_f32(p, x);
+}
+
+static void neon_sine_ramp_mac(float* out, uint32_t n, double phase, double inc, float amp) {
+    static const float lane_init[4] = { 0.0f, 1.0f, 2.0f, 3.0f };
+    const float32x4_t lanes = vld1q_f32(lane_init);
+    const float incf = (float)inc;
+    uint32_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        float base = (float)wrap_phase(phase + (double)i * inc);
+        float32x4_t x = vaddq_f32(vdupq_n_f32(base), vmulq_n_f32(lanes, incf));
+        float32x4_t acc = vld1q_f32(out + i);
+        vst1q_f32(out + i, vaddq_f32(acc, vmulq_n_f32(neon_sin_ps(x), amp)));
+    }
+    for (; i < n; i++) {
+        out[i] += amp * poly_sinf((float)wrap_phase(phase + (double)i * inc));
+    }
+}
+
+static void neon_sine_mac(float* out, const float* phase, const float* amp, uint32_t n) {
+    uint32_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        float32x4_t s = neon_sin_ps(vld1q_f32(phase + i));
+        float32x4_t acc = vld1q_f32(out + i);
+        vst1q_f32(out + i, vaddq_f32(acc, vmulq_f32(vld1q_f32(amp + i), s)));
+    }
+    for (; i < n; i++) {
+        out[i] += amp[i] * poly_sinf(phase[i]);
+    }
+}
+
+static void neon_gain_mac(float* dst, const float* src, uint32_t n, float gain) {
+    uint32_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        float32x4_t acc = vld1q_f32(dst + i);
+        vst1q_f32(dst + i, vaddq_f32(acc, vmulq_n_f32(vld1q_f32(src + i), gain)));
+    }
+    for (; i < n; i++) {
+        dst[i] += src[i] * gain;
+    }
+}
+
+static void neon_clip(float* buf, uint32_t n, float lo, float hi) {
+    const float32x4_t lov = vdupq_n_f32(lo);
+    const float32x4_t hiv = vdupq_n_f32(hi);
+    uint32_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        vst1q_f32(buf + i, vmaxq_f32(lov, vminq_f32(hiv, vld1q_f32(buf + i))));
+    }
+    scalar_clip(buf + i, n - i, lo, hi);
+}
+
+static void neon_fan_out(float* dst, const float* mono, uint32_t frames, uint32_t channels) {
+    if (channels != 2) {
+        scalar_fan_out(dst, mono, frames, channels);
+        return;
+    }
+    uint32_t f = 0;
+    for (; f + 4 <= frames; f += 4) {
+        float32x4_t m = vld1q_f32(mono + f);
+        float32x4x2_t pair = { { m, m } };
+        vst2q_f32(dst + (size_t)f * 2, pair);
+    }
+    scalar_fan_out(dst + (size_t)f * 2, mono + f, frames - f, 2);
+}
+
+static void neon_quantize(int32_t* dst, const float* src, const float* dither, uint32_t n,
+                          float scale, float hi) {
+    const float32x4_t lov = vdupq_n_f32(-hi - 1.0f);
+    const float32x4_t hiv = vdupq_n_f32(hi);
+    uint32_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        float32x4_t v = vmulq_n_f32(vld1q_f32(src + i), scale);
+        if (dither) v = vaddq_f32(v, vld1q_f32(dither + i));
+        v = vbslq_f32(vcgeq_f32(v, lov), v, lov); /* NaN fails the compare */
+        vst1q_s32(dst + i, vcvtnq_s32_f32(vminq_f32(v, hiv)));
+    }
+    scalar_quantize(dst + i, src + i, dither ? dither + i : NULL, n - i, scale, hi);
+}
+
+static void neon_pcm16_to_float(float* dst, const unsigned char* src, uint32_t n) {
+    const float k = 1.0f / 32768.0f;
+    uint32_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        int16x8_t v = vreinterpretq_s16_u8(vld1q_u8(src + (size_t)i * 2));
+        vst1q_f32(dst + i, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(v))), k));
+        vst1q_f32(dst + i + 4, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(v))), k));
+    }
+    scalar_pcm16_to_float(dst + i, src + (size_t)i * 2, n - i);
+}
+
+static void neon_pcm24_to_float(float* dst, const unsigned char* src, uint32_t n) {
+    const float k = 1.0f / 8388608.0f;
+    uint32_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        uint8x8x3_t b = vld3_u8(src + (size_t)i * 3); /* the three bytes of 8 samples, deinterleaved */
+        uint16x8_t low = vorrq_u16(vmovl_u8(b.val[0]), vshll_n_u8(b.val[1], 8));
+        int16x8_t top = vmovl_s8(vreinterpret_s8_u8(b.val[2]));
+        int32x4_t lo = vorrq_s32(vshlq_n_s32(vmovl_s16(vget_low_s16(top)), 16),
+                                 vreinterpretq_s32_u32(vmovl_u16(vget_low_u16(low))));
+        int32x4_t hi = vorrq_s32(vshlq_n_s32(vmovl_s16(vget_high_s16(top)), 16),
+                                 vreinterpretq_s32_u32(vmovl_u16(vget_high_u16(low))));
+        vst1q_f32(dst + i, vmulq_n_f32(vcvtq_f32_s32(lo), k));
+        vst1q_f32(dst + i + 4, vmulq_n_f32(vcvtq_f32_s32(hi), k));
+    }
+    scalar_pcm24_to_float(dst + i, src + (size_t)i * 3, n - i);
+}
+
+static void neon_downmix(float* dst, const float* src, uint32_t frames, uint32_t channels) {
+    if (channels != 2) {
+        scalar_downmix(dst, src, frames, channels);
+        return;
+    }
+    uint32_t f = 0;
+    for (; f + 4 <= frames; f += 4) {
+        float32x4x2_t pair = vld2q_f32(src + (size_t)f * 2);
+        vst1q_f32(dst + f, vmulq_n_f32(vaddq_f32(pair.val[0], pair.val[1]), 0.5f));
+    }
+    scalar_downmix(dst + f, src + (size_t)f * 2, frames - f, 2);
+}
+
+static float neon_dot(const float* a, const float* b, uint32_t n) {
+    float32x4_t acc0 = vdupq_n_f32(0.0f), acc1 = vdupq_n_f32(0.0f);
+    uint32_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        acc0 = vmlaq_f32(acc0, vld1q_f32(a + i), vld1q_f32(b + i));
+        acc1 = vmlaq_f32(acc1, vld1q_f32(a + i + 4), vld1q_f32(b + i + 4));
+    }
+    return vaddvq_f32(vaddq_f32(acc0, acc1)) + scalar_dot(a + i, b + i, n - i);
+}
+
+static const UCRA_Kernels g_neon_kernels = {
+    "neon",
+    neon_sine_ramp_mac,
+    neon_sine_mac,
+    neon_gain_mac,
+    neon_clip,
+    neon_fan_out,
+    neon_quantize,
+    neon_pcm16_to_float,
+    neon_pcm24_to_float,
+    neon_downmix,
+    neon_dot
+};
+
+#endif /* UCRA_KERNELS_NEON */
+
+/* ------------------------------------------------------------------ */
+/* Dispatch                                                            */
+/* ------------------------------------------------------------------ */
+
+const UCRA_Kernels* ucra_kernels_by_name(const char* name) {
+    if (!name) return NULL;
+    if (strcmp(name, "scalar") == 0) return &g_scalar_kernels;
+#ifdef UCRA_KERNELS_X86
+    if (strcmp(name, "sse2") == 0) return &g_sse2_kernels; /* baseline on all supported x86 targets */
+    if (strcmp(name, "avx2") == 0) return cpu_has_avx2() ? &g_avx2_kernels : NULL;
+#endif
+#ifdef UCRA_KERNELS_NEON
+    if (strcmp(name, "neon") == 0) return &g_neon_kernels;
+#endif
+    return NULL;
+}
+
+static const UCRA_Kernels* detect_kernels(void) {
+    const UCRA_Kernels* forced = ucra_kernels_by_name(getenv("UCRA_SIMD"));
+    if (forced) return forced;
+#ifdef UCRA_KERNELS_X86
+    if (cpu_has_avx2()) return &g_avx2_kernels;
+    return &g_sse2_kernels;
+#elif defined(UCRA_KERNELS_NEON)
+    return &g_neon_kernels;
+#else
+    return &g_scalar_kernels;
+#endif
+}
+
+const UCRA_Kernels* ucra_kernels(void) {
+    /* detection is idempotent, so a racing first call just stores the same pointer */
+    static const UCRA_Kernels* volatile selected = NULL;
+    const UCRA_Kernels* k = selected;
+    if (!k) {
+        k = detect_kernels();
+        selected = k;
+    }
+    return k;
+}
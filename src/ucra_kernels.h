@@ -0,0 +1,76 @@
+/*
+ * UCRA DSP Kernels (internal)
+ * Vectorized oscillator, mixing, output, sample conversion and filter kernels
+ * shared by the renderers, the WAV writer, the WAV reader and the resampler.
+ * The best implementation for the running CPU is picked once at first use.
+ */
+#ifndef UCRA_KERNELS_H
+#define UCRA_KERNELS_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Kernel dispatch table
+ *
+ * All kernels accumulate or write float PCM. Phases are in radians; kernels reduce
+ * them internally, so callers only need to keep accumulators bounded.
+ */
+typedef struct UCRA_Kernels {
+    const char* name; /**< "scalar", "sse2", "avx2" or "neon" */
+
+    /** out[i] += amp * sin(phase + i * inc) for i in [0, n) */
+    void (*sine_ramp_mac)(float* out, uint32_t n, double phase, double inc, float amp);
+
+    /** out[i] += amp[i] * sin(phase[i]) for i in [0, n) */
+    void (*sine_mac)(float* out, const float* phase, const float* amp, uint32_t n);
+
+    /** dst[i] += src[i] * gain for i in [0, n) */
+    void (*gain_mac)(float* dst, const float* src, uint32_t n, float gain);
+
+    /** clamp buf[i] to [lo, hi] for i in [0, n) */
+    void (*clip)(float* buf, uint32_t n, float lo, float hi);
+
+    /** interleave a mono signal into every channel: dst[f * channels + c] = mono[f] */
+    void (*fan_out)(float* dst, const float* mono, uint32_t frames, uint32_t channels);
+
+    /** dst[i] = round(src[i] * scale + dither[i]) clamped to [-hi - 1, hi], NaN to -hi - 1;
+     *  dither may be NULL */
+    void (*quantize)(int32_t* dst, const float* src, const float* dither, uint32_t n, float scale, float hi);
+
+    /** dst[i] = signed 16-bit little-endian sample i of src / 32768 for i in [0, n) */
+    void (*pcm16_to_float)(float* dst, const unsigned char* src, uint32_t n);
+
+    /** dst[i] = signed 24-bit little-endian sample i of src / 8388608 for i in [0, n) */
+    void (*pcm24_to_float)(float* dst, const unsigned char* src, uint32_t n);
+
+    /** average interleaved channels: dst[f] = (src[f * channels] + ... + src[f * channels + channels - 1]) / channels;
+     *  dst must not overlap src */
+    void (*downmix)(float* dst, const float* src, uint32_t frames, uint32_t channels);
+
+    /** sum of a[i] * b[i] for i in [0, n); the summation order differs between variants */
+    float (*dot)(const float* a, const float* b, uint32_t n);
+} UCRA_Kernels;
+
+/**
+ * @brief Get the kernel table for the running CPU
+ *
+ * The choice can be forced with the UCRA_SIMD environment variable
+ * ("scalar", "sse2", "avx2", "neon"); unsupported names fall back to auto-detection.
+ */
+const UCRA_Kernels* ucra_kernels(void);
+
+/**
+ * @brief Get a specific kernel table by name
+ * @return NULL if the named variant is not compiled in or not supported by this CPU
+ */
+const UCRA_Kernels* ucra_kernels_by_name(const char* name);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* UCRA_KERNELS_H */
@@ -4,37 +4,37 @@
  */
 
 #include "ucra/ucra.h"
+#include "ucra_file.h"
+#include "ucra_manifest_compiled.h"
+#include "ucra_threads.h"
+#include "ucra_trace.h"
 #include "cJSON.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
-/* Internal manifest structure with memory management info */
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <sys/stat.h>
+#endif
+
+/* Internal manifest structure. It heads a single block that also holds every
+ * array and string the manifest points to (or, for a compiled manifest, the
+ * arrays of pointers into the mapped file), so freeing it is one free(). */
 typedef struct UCRA_ManifestInternal {
     UCRA_Manifest public_manifest;
 
-    /* Memory management */
-    char* allocated_strings;
-    size_t allocated_strings_size;
-    uint32_t* allocated_rates;
-    uint32_t* allocated_channels;
-    UCRA_ManifestFlag* allocated_flags;
-    float* allocated_ranges;
-    char** allocated_enum_values;
-    size_t allocated_enum_values_count;
-} UCRA_ManifestInternal;
+    /* Hash index over the flag keys (see build_flag_index), in the same block */
+    const uint32_t* flag_index;
+    uint32_t flag_index_mask;
 
-/* Helper function to duplicate a string */
-static char* ucra_strdup(const char* src) {
-    if (!src) return NULL;
+    /* References to a registry manifest (see ucra_manifest_acquire), 0 for a private one */
+    uint32_t refs;
 
-    size_t len = strlen(src);
-    char* dst = malloc(len + 1);
-    if (dst) {
-        memcpy(dst, src, len + 1);
-    }
-    return dst;
-}
+    /* Compiled manifest the strings and arrays point into, if any */
+    UCRA_FileMap map;
+} UCRA_ManifestInternal;
 
 /* Schema validation functions */
 static int ucra_validate_entry_type(const char* type) {
@@ -230,138 +230,518 @@ static UCRA_Result ucra_read_file(const char* filepath, char** out_content, size
     return UCRA_SUCCESS;
 }
 
-/* Parse a JSON array of integers */
-static UCRA_Result ucra_parse_int_array(cJSON* array, uint32_t** out_values, uint32_t* out_count) {
-    if (!cJSON_IsArray(array)) {
-        return UCRA_ERR_INVALID_MANIFEST;
+/* Slots of the flag index: a power of two at least twice the flag count, 0 without flags */
+static uint32_t flag_index_slots(uint32_t flags_count) {
+    if (flags_count == 0) return 0;
+    uint32_t slots = 4;
+    while (slots < flags_count * 2) slots *= 2;
+    return slots;
+}
+
+static uint32_t flag_key_hash(const char* key) {
+    return (uint32_t)ucra_fnv1a(UCRA_FNV_OFFSET, key, strlen(key));
+}
+
+/* Open-addressed index from key to flag; a slot holds the flag's position + 1, 0 when empty.
+ * A repeated key keeps its first flag, as a scan of the array would find. */
+static void build_flag_index(UCRA_ManifestInternal* manifest, uint32_t* slots, uint32_t slot_count) {
+    const UCRA_Manifest* m = &manifest->public_manifest;
+    manifest->flag_index = slot_count ? slots : NULL;
+    manifest->flag_index_mask = slot_count ? slot_count - 1 : 0;
+    for (uint32_t i = 0; i < m->flags_count; ++i) {
+        uint32_t slot = flag_key_hash(m->flags[i].key) & manifest->flag_index_mask;
+        while (slots[slot] && strcmp(m->flags[slots[slot] - 1].key, m->flags[i].key) != 0) {
+            slot = (slot + 1) & manifest->flag_index_mask;
+        }
+        if (!slots[slot]) slots[slot] = i + 1;
     }
+}
 
-    int count = cJSON_GetArraySize(array);
-    if (count <= 0) {
-        *out_values = NULL;
-        *out_count = 0;
-        return UCRA_SUCCESS;
+/* Sizes of the parts of a parsed manifest, from a first pass over the validated JSON */
+typedef struct UCRA_ManifestLayout {
+    uint32_t flags;
+    uint32_t values;   /* enum values of all flags */
+    uint32_t rates;
+    uint32_t channels;
+    uint32_t ranges;
+    size_t strings;    /* bytes, terminators included */
+} UCRA_ManifestLayout;
+
+/* Text of a flag default: strings as given, numbers with six decimals, booleans as true/false */
+static const char* default_text(cJSON* default_val, char* buffer, size_t size) {
+    if (cJSON_IsString(default_val)) return default_val->valuestring;
+    if (cJSON_IsNumber(default_val)) {
+        snprintf(buffer, size, "%.6f", default_val->valuedouble);
+        return buffer;
     }
+    if (cJSON_IsBool(default_val)) return cJSON_IsTrue(default_val) ? "true" : "false";
+    return NULL;
+}
 
-    uint32_t* values = malloc(count * sizeof(uint32_t));
-    if (!values) {
-        return UCRA_ERR_OUT_OF_MEMORY;
+static size_t text_size(const char* text) {
+    return text ? strlen(text) + 1 : 0;
+}
+
+static size_t json_string_size(cJSON* item) {
+    return cJSON_IsString(item) ? strlen(item->valuestring) + 1 : 0;
+}
+
+static int has_range(cJSON* flag) {
+    cJSON* range = cJSON_GetObjectItem(flag, "range");
+    return range && cJSON_IsArray(range) && cJSON_GetArraySize(range) == 2 &&
+           cJSON_IsNumber(cJSON_GetArrayItem(range, 0)) && cJSON_IsNumber(cJSON_GetArrayItem(range, 1));
+}
+
+static void measure_manifest(cJSON* json, UCRA_ManifestLayout* layout) {
+    memset(layout, 0, sizeof(*layout));
+    static const char* const root_strings[] = { "name", "version", "vendor", "license" };
+    for (size_t i = 0; i < sizeof(root_strings) / sizeof(root_strings[0]); ++i) {
+        layout->strings += json_string_size(cJSON_GetObjectItem(json, root_strings[i]));
     }
+    cJSON* entry = cJSON_GetObjectItem(json, "entry");
+    layout->strings += json_string_size(cJSON_GetObjectItem(entry, "type")) +
+                       json_string_size(cJSON_GetObjectItem(entry, "path")) +
+                       json_string_size(cJSON_GetObjectItem(entry, "symbol"));
+    cJSON* audio = cJSON_GetObjectItem(json, "audio");
+    layout->rates = (uint32_t)cJSON_GetArraySize(cJSON_GetObjectItem(audio, "rates"));
+    layout->channels = (uint32_t)cJSON_GetArraySize(cJSON_GetObjectItem(audio, "channels"));
 
-    for (int i = 0; i < count; i++) {
-        cJSON* item = cJSON_GetArrayItem(array, i);
-        if (!cJSON_IsNumber(item) || item->valueint < 0) {
-            free(values);
-            return UCRA_ERR_INVALID_MANIFEST;
+    cJSON* flags = cJSON_GetObjectItem(json, "flags");
+    if (!cJSON_IsArray(flags)) return;
+    cJSON* flag;
+    cJSON_ArrayForEach(flag, flags) {
+        char buffer[32];
+        layout->flags++;
+        layout->strings += json_string_size(cJSON_GetObjectItem(flag, "key")) +
+                           json_string_size(cJSON_GetObjectItem(flag, "type")) +
+                           json_string_size(cJSON_GetObjectItem(flag, "desc")) +
+                           text_size(default_text(cJSON_GetObjectItem(flag, "default"), buffer, sizeof(buffer)));
+        layout->ranges += has_range(flag);
+        cJSON* values = cJSON_GetObjectItem(flag, "values");
+        if (cJSON_IsArray(values)) {
+            cJSON* value;
+            cJSON_ArrayForEach(value, values) {
+                if (cJSON_IsString(value)) {
+                    layout->values++;
+                    layout->strings += json_string_size(value);
+                }
+            }
         }
-        values[i] = (uint32_t)item->valueint;
     }
+}
 
-    *out_values = values;
-    *out_count = (uint32_t)count;
-    return UCRA_SUCCESS;
+static size_t align_up(size_t size, size_t align) {
+    return (size + align - 1) / align * align;
 }
 
-/* Parse flags array */
-static UCRA_Result ucra_parse_flags(cJSON* flags_array, UCRA_ManifestInternal* manifest) {
-    if (!cJSON_IsArray(flags_array)) {
-        manifest->public_manifest.flags = NULL;
-        manifest->public_manifest.flags_count = 0;
-        return UCRA_SUCCESS;
+/* Copy text to the arena's string area */
+static const char* arena_string(char** cursor, const char* text) {
+    if (!text) return NULL;
+    size_t size = strlen(text) + 1;
+    char* copy = *cursor;
+    memcpy(copy, text, size);
+    *cursor += size;
+    return copy;
+}
+
+static const char* arena_json_string(char** cursor, cJSON* item) {
+    return cJSON_IsString(item) ? arena_string(cursor, item->valuestring) : NULL;
+}
+
+/* Validated JSON -> one block holding the manifest, its arrays and its strings */
+static UCRA_ManifestInternal* build_manifest(cJSON* json) {
+    UCRA_ManifestLayout layout;
+    measure_manifest(json, &layout);
+
+    size_t flags_at = align_up(sizeof(UCRA_ManifestInternal), sizeof(void*));
+    size_t values_at = flags_at + layout.flags * sizeof(UCRA_ManifestFlag);
+    size_t rates_at = values_at + layout.values * sizeof(const char*);
+    size_t channels_at = rates_at + layout.rates * sizeof(uint32_t);
+    size_t index_at = channels_at + layout.channels * sizeof(uint32_t);
+    uint32_t index_slots = flag_index_slots(layout.flags);
+    size_t ranges_at = index_at + (size_t)index_slots * sizeof(uint32_t);
+    size_t strings_at = ranges_at + (size_t)layout.ranges * 2 * sizeof(float);
+    char* arena = calloc(1, strings_at + layout.strings);
+    if (!arena) return NULL;
+
+    UCRA_ManifestInternal* manifest = (UCRA_ManifestInternal*)arena;
+    UCRA_ManifestFlag* flags = (UCRA_ManifestFlag*)(arena + flags_at);
+    const char** values = (const char**)(arena + values_at);
+    uint32_t* rates = (uint32_t*)(arena + rates_at);
+    uint32_t* channels = (uint32_t*)(arena + channels_at);
+    float* ranges = (float*)(arena + ranges_at);
+    char* strings = arena + strings_at;
+
+    UCRA_Manifest* m = &manifest->public_manifest;
+    m->name = arena_json_string(&strings, cJSON_GetObjectItem(json, "name"));
+    m->version = arena_json_string(&strings, cJSON_GetObjectItem(json, "version"));
+    m->vendor = arena_json_string(&strings, cJSON_GetObjectItem(json, "vendor"));
+    m->license = arena_json_string(&strings, cJSON_GetObjectItem(json, "license"));
+
+    cJSON* entry = cJSON_GetObjectItem(json, "entry");
+    m->entry.type = arena_json_string(&strings, cJSON_GetObjectItem(entry, "type"));
+    m->entry.path = arena_json_string(&strings, cJSON_GetObjectItem(entry, "path"));
+    m->entry.symbol = arena_json_string(&strings, cJSON_GetObjectItem(entry, "symbol"));
+
+    /* rates and channels were range-checked by validation */
+    cJSON* audio = cJSON_GetObjectItem(json, "audio");
+    cJSON* item;
+    uint32_t index = 0;
+    cJSON_ArrayForEach(item, cJSON_GetObjectItem(audio, "rates")) {
+        rates[index++] = (uint32_t)item->valueint;
+    }
+    index = 0;
+    cJSON_ArrayForEach(item, cJSON_GetObjectItem(audio, "channels")) {
+        channels[index++] = (uint32_t)item->valueint;
+    }
+    m->audio.rates = layout.rates ? rates : NULL;
+    m->audio.rates_count = layout.rates;
+    m->audio.channels = layout.channels ? channels : NULL;
+    m->audio.channels_count = layout.channels;
+    m->audio.streaming = cJSON_IsTrue(cJSON_GetObjectItem(audio, "streaming"));
+
+    index = 0;
+    cJSON* flag;
+    cJSON_ArrayForEach(flag, cJSON_GetObjectItem(json, "flags")) {
+        UCRA_ManifestFlag* out = &flags[index++];
+        char buffer[32];
+        out->key = arena_json_string(&strings, cJSON_GetObjectItem(flag, "key"));
+        out->type = arena_json_string(&strings, cJSON_GetObjectItem(flag, "type"));
+        out->desc = arena_json_string(&strings, cJSON_GetObjectItem(flag, "desc"));
+        out->default_val = arena_string(&strings, default_text(cJSON_GetObjectItem(flag, "default"),
+                                                               buffer, sizeof(buffer)));
+        if (has_range(flag)) {
+            cJSON* range = cJSON_GetObjectItem(flag, "range");
+            ranges[0] = (float)cJSON_GetArrayItem(range, 0)->valuedouble;
+            ranges[1] = (float)cJSON_GetArrayItem(range, 1)->valuedouble;
+            out->range = ranges;
+            ranges += 2;
+        }
+        cJSON* flag_values = cJSON_GetObjectItem(flag, "values");
+        if (cJSON_IsArray(flag_values)) {
+            const char** first = values;
+            cJSON* value;
+            cJSON_ArrayForEach(value, flag_values) {
+                if (cJSON_IsString(value)) *values++ = arena_string(&strings, value->valuestring);
+            }
+            out->values_count = (uint32_t)(values - first);
+            out->values = out->values_count ? first : NULL;
+        }
     }
+    m->flags = layout.flags ? flags : NULL;
+    m->flags_count = layout.flags;
+    build_flag_index(manifest, (uint32_t*)(arena + index_at), index_slots);
+    return manifest;
+}
 
-    int count = cJSON_GetArraySize(flags_array);
-    if (count <= 0) {
-        manifest->public_manifest.flags = NULL;
-        manifest->public_manifest.flags_count = 0;
-        return UCRA_SUCCESS;
+/* Parse and validate JSON manifest text */
+static UCRA_Result parse_manifest_json(const char* json_content, UCRA_Manifest** outManifest) {
+    /* Parse JSON */
+    cJSON* json = cJSON_Parse(json_content);
+
+    if (!json) {
+        return UCRA_ERR_INVALID_JSON;
+    }
+
+    /* Validate schema compliance, including the flags array if present */
+    UCRA_Result result = ucra_validate_required_fields(json);
+    if (result == UCRA_SUCCESS) {
+        result = ucra_validate_flags_array(cJSON_GetObjectItem(json, "flags"));
+    }
+    if (result != UCRA_SUCCESS) {
+        cJSON_Delete(json);
+        return result;
     }
 
-    UCRA_ManifestFlag* flags = calloc(count, sizeof(UCRA_ManifestFlag));
-    if (!flags) {
+    UCRA_ManifestInternal* manifest = build_manifest(json);
+    cJSON_Delete(json);
+    if (!manifest) {
         return UCRA_ERR_OUT_OF_MEMORY;
     }
+    *outManifest = &manifest->public_manifest;
+    return UCRA_SUCCESS;
+}
 
-    for (int i = 0; i < count; i++) {
-        cJSON* flag = cJSON_GetArrayItem(flags_array, i);
-        if (!cJSON_IsObject(flag)) {
-            free(flags);
-            return UCRA_ERR_INVALID_MANIFEST;
-        }
+/* ---------------------------------------------------------------------------
+ * Compiled manifests
+ * ------------------------------------------------------------------------- */
+
+#define COMPILED_MAGIC "UCRAMAN"
+#define COMPILED_NONE 0xFFFFFFFFu /* string offset of an absent string */
+
+/* On-disk header, native byte order; the sections follow at the given offsets */
+typedef struct UCRA_CompiledHeader {
+    char magic[8];          /* COMPILED_MAGIC, NUL padded */
+    uint32_t version;       /* UCRA_MANIFEST_COMPILED_VERSION */
+    uint32_t header_size;   /* sizeof(UCRA_CompiledHeader), also marks the byte order */
+    uint64_t source_hash;   /* FNV-1a of the JSON text */
+    uint64_t source_size;
+    uint32_t file_size;
+    uint32_t streaming;
+    uint32_t name, version_string, vendor, license;  /* string offsets */
+    uint32_t entry_type, entry_path, entry_symbol;
+    uint32_t rates_offset, rates_count;              /* uint32_t[] */
+    uint32_t channels_offset, channels_count;        /* uint32_t[] */
+    uint32_t flags_offset, flags_count;              /* UCRA_CompiledFlag[] */
+    uint32_t values_offset, values_count;            /* uint32_t[] string offsets of all enum values */
+    uint32_t strings_offset, strings_size;           /* NUL-terminated strings */
+    uint32_t reserved;
+} UCRA_CompiledHeader;
+
+typedef struct UCRA_CompiledFlag {
+    uint32_t key, type, desc, default_val; /* string offsets */
+    uint32_t values_first, values_count;   /* slice of the values section */
+    uint32_t has_range;
+    float range[2];
+    uint32_t reserved;
+} UCRA_CompiledFlag;
+
+UCRA_Result ucra_manifest_compiled_path(const char* manifest_path, char* out, size_t out_size) {
+    if (!manifest_path || !out) return UCRA_ERR_INVALID_ARGUMENT;
+    size_t len = strlen(manifest_path);
+    /* drop a .json extension, then append the suffix */
+    if (len >= 5 && strcmp(manifest_path + len - 5, ".json") == 0) {
+        len -= 5;
+    }
+    if (len + sizeof(UCRA_MANIFEST_COMPILED_SUFFIX) > out_size) return UCRA_ERR_INVALID_ARGUMENT;
+    memcpy(out, manifest_path, len);
+    memcpy(out + len, UCRA_MANIFEST_COMPILED_SUFFIX, sizeof(UCRA_MANIFEST_COMPILED_SUFFIX));
+    return UCRA_SUCCESS;
+}
 
-        /* Parse required fields */
-        cJSON* key = cJSON_GetObjectItem(flag, "key");
-        cJSON* type = cJSON_GetObjectItem(flag, "type");
-        cJSON* desc = cJSON_GetObjectItem(flag, "desc");
+static char* compiled_path_for(const char* manifest_path) {
+    size_t size = strlen(manifest_path) + sizeof(UCRA_MANIFEST_COMPILED_SUFFIX);
+    char* path = malloc(size);
+    if (path) ucra_manifest_compiled_path(manifest_path, path, size);
+    return path;
+}
 
-        if (!cJSON_IsString(key) || !cJSON_IsString(type) || !cJSON_IsString(desc)) {
-            free(flags);
-            return UCRA_ERR_INVALID_MANIFEST;
-        }
+/* Image under construction: sizes are computed first, then every section is filled in place */
+typedef struct UCRA_CompiledWriter {
+    char* image;
+    uint32_t strings_offset;
+    uint32_t strings_used;
+} UCRA_CompiledWriter;
 
-        flags[i].key = ucra_strdup(key->valuestring);
-        flags[i].type = ucra_strdup(type->valuestring);
-        flags[i].desc = ucra_strdup(desc->valuestring);
-
-        /* Parse optional default value */
-        cJSON* default_val = cJSON_GetObjectItem(flag, "default");
-        if (default_val) {
-            if (cJSON_IsString(default_val)) {
-                flags[i].default_val = ucra_strdup(default_val->valuestring);
-            } else if (cJSON_IsNumber(default_val)) {
-                char buffer[32];
-                snprintf(buffer, sizeof(buffer), "%.6f", default_val->valuedouble);
-                flags[i].default_val = ucra_strdup(buffer);
-            } else if (cJSON_IsBool(default_val)) {
-                flags[i].default_val = ucra_strdup(cJSON_IsTrue(default_val) ? "true" : "false");
-            }
-        }
+static uint32_t string_size(const char* s) {
+    return s ? (uint32_t)strlen(s) + 1 : 0;
+}
 
-        /* Parse range for numeric types */
-        cJSON* range = cJSON_GetObjectItem(flag, "range");
-        if (range && cJSON_IsArray(range) && cJSON_GetArraySize(range) == 2) {
-            float* range_values = malloc(2 * sizeof(float));
-            if (range_values) {
-                cJSON* min_val = cJSON_GetArrayItem(range, 0);
-                cJSON* max_val = cJSON_GetArrayItem(range, 1);
-                if (cJSON_IsNumber(min_val) && cJSON_IsNumber(max_val)) {
-                    range_values[0] = (float)min_val->valuedouble;
-                    range_values[1] = (float)max_val->valuedouble;
-                    flags[i].range = range_values;
-                } else {
-                    free(range_values);
-                }
-            }
+static uint32_t put_string(UCRA_CompiledWriter* w, const char* s) {
+    if (!s) return COMPILED_NONE;
+    uint32_t offset = w->strings_used;
+    uint32_t size = string_size(s);
+    memcpy(w->image + w->strings_offset + offset, s, size);
+    w->strings_used += size;
+    return offset;
+}
+
+static UCRA_Result write_compiled(const UCRA_Manifest* m, uint64_t source_hash, uint64_t source_size,
+                                  const char* path) {
+    uint64_t strings = string_size(m->name) + string_size(m->version) + string_size(m->vendor) +
+                       string_size(m->license) + string_size(m->entry.type) + string_size(m->entry.path) +
+                       string_size(m->entry.symbol);
+    uint64_t values = 0;
+    for (uint32_t i = 0; i < m->flags_count; ++i) {
+        const UCRA_ManifestFlag* flag = &m->flags[i];
+        strings += string_size(flag->key) + string_size(flag->type) + string_size(flag->desc) +
+                   string_size(flag->default_val);
+        for (uint32_t j = 0; j < flag->values_count; ++j) {
+            strings += string_size(flag->values[j]);
         }
+        values += flag->values_count;
+    }
 
-        /* Parse values for enum type */
-        cJSON* values = cJSON_GetObjectItem(flag, "values");
-        if (values && cJSON_IsArray(values)) {
-            int values_count = cJSON_GetArraySize(values);
-            if (values_count > 0) {
-                char** enum_values = malloc(values_count * sizeof(char*));
-                if (enum_values) {
-                    int valid_count = 0;
-                    for (int j = 0; j < values_count; j++) {
-                        cJSON* value = cJSON_GetArrayItem(values, j);
-                        if (cJSON_IsString(value)) {
-                            enum_values[valid_count++] = ucra_strdup(value->valuestring);
-                        }
-                    }
-                    if (valid_count > 0) {
-                        flags[i].values = (const char**)enum_values;
-                        flags[i].values_count = valid_count;
-                    } else {
-                        free(enum_values);
-                    }
-                }
-            }
+    UCRA_CompiledHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, COMPILED_MAGIC, sizeof(COMPILED_MAGIC));
+    header.version = UCRA_MANIFEST_COMPILED_VERSION;
+    header.header_size = sizeof(header);
+    header.source_hash = source_hash;
+    header.source_size = source_size;
+    header.streaming = (uint32_t)m->audio.streaming;
+    uint64_t offset = sizeof(header);
+    header.rates_offset = (uint32_t)offset;
+    header.rates_count = m->audio.rates_count;
+    offset += (uint64_t)m->audio.rates_count * sizeof(uint32_t);
+    header.channels_offset = (uint32_t)offset;
+    header.channels_count = m->audio.channels_count;
+    offset += (uint64_t)m->audio.channels_count * sizeof(uint32_t);
+    header.flags_offset = (uint32_t)offset;
+    header.flags_count = m->flags_count;
+    offset += (uint64_t)m->flags_count * sizeof(UCRA_CompiledFlag);
+    header.values_offset = (uint32_t)offset;
+    header.values_count = (uint32_t)values;
+    offset += values * sizeof(uint32_t);
+    header.strings_offset = (uint32_t)offset;
+    header.strings_size = (uint32_t)strings;
+    offset += strings;
+    if (offset > UINT32_MAX) return UCRA_ERR_INVALID_ARGUMENT;
+    header.file_size = (uint32_t)offset;
+
+    UCRA_CompiledWriter w = { calloc(1, (size_t)offset), header.strings_offset, 0 };
+    if (!w.image) return UCRA_ERR_OUT_OF_MEMORY;
+
+    header.name = put_string(&w, m->name);
+    header.version_string = put_string(&w, m->version);
+    header.vendor = put_string(&w, m->vendor);
+    header.license = put_string(&w, m->license);
+    header.entry_type = put_string(&w, m->entry.type);
+    header.entry_path = put_string(&w, m->entry.path);
+    header.entry_symbol = put_string(&w, m->entry.symbol);
+    if (m->audio.rates_count) {
+        memcpy(w.image + header.rates_offset, m->audio.rates, m->audio.rates_count * sizeof(uint32_t));
+    }
+    if (m->audio.channels_count) {
+        memcpy(w.image + header.channels_offset, m->audio.channels, m->audio.channels_count * sizeof(uint32_t));
+    }
+    UCRA_CompiledFlag* records = (UCRA_CompiledFlag*)(w.image + header.flags_offset);
+    uint32_t* value_offsets = (uint32_t*)(w.image + header.values_offset);
+    uint32_t next_value = 0;
+    for (uint32_t i = 0; i < m->flags_count; ++i) {
+        const UCRA_ManifestFlag* flag = &m->flags[i];
+        UCRA_CompiledFlag* record = &records[i];
+        record->key = put_string(&w, flag->key);
+        record->type = put_string(&w, flag->type);
+        record->desc = put_string(&w, flag->desc);
+        record->default_val = put_string(&w, flag->default_val);
+        record->values_first = next_value;
+        record->values_count = flag->values_count;
+        for (uint32_t j = 0; j < flag->values_count; ++j) {
+            value_offsets[next_value++] = put_string(&w, flag->values[j]);
         }
+        if (flag->range) {
+            record->has_range = 1;
+            record->range[0] = flag->range[0];
+            record->range[1] = flag->range[1];
+        }
+    }
+    memcpy(w.image, &header, sizeof(header));
+
+    size_t path_len = strlen(path);
+    char* temp_path = malloc(path_len + 5);
+    if (!temp_path) {
+        free(w.image);
+        return UCRA_ERR_OUT_OF_MEMORY;
+    }
+    memcpy(temp_path, path, path_len);
+    memcpy(temp_path + path_len, ".tmp", 5);
+
+    FILE* file = fopen(temp_path, "wb");
+    int ok = file != NULL;
+    if (file) {
+        ok = fwrite(w.image, 1, header.file_size, file) == header.file_size;
+        ok = fclose(file) == 0 && ok;
+    }
+    free(w.image);
+    UCRA_Result result = ok ? ucra_file_replace(temp_path, path) : UCRA_ERR_INTERNAL;
+    if (!ok) remove(temp_path);
+    free(temp_path);
+    return result;
+}
+
+/* A string offset is valid when it is absent or starts inside the NUL-terminated table */
+static int string_valid(const UCRA_CompiledHeader* h, uint32_t offset) {
+    return offset == COMPILED_NONE || offset < h->strings_size;
+}
+
+static int section_valid(const UCRA_CompiledHeader* h, uint32_t offset, uint32_t count, size_t item) {
+    return offset >= sizeof(*h) && offset % sizeof(uint32_t) == 0 &&
+           (uint64_t)offset + (uint64_t)count * item <= h->file_size;
+}
+
+static const char* compiled_string(const UCRA_CompiledHeader* h, const char* base, uint32_t offset) {
+    return offset == COMPILED_NONE ? NULL : base + h->strings_offset + offset;
+}
+
+/* Map a compiled manifest and expose it in place, if it matches the JSON it was compiled from */
+static UCRA_Result open_compiled(const char* path, uint64_t source_hash, uint64_t source_size,
+                                 UCRA_Manifest** outManifest) {
+    UCRA_FileMap map;
+    UCRA_Result result = ucra_file_map(path, &map);
+    if (result != UCRA_SUCCESS) return result;
+
+    const char* base = (const char*)map.data;
+    UCRA_CompiledHeader h;
+    int valid = map.size >= sizeof(h);
+    if (valid) {
+        memcpy(&h, base, sizeof(h));
+        valid = memcmp(h.magic, COMPILED_MAGIC, sizeof(COMPILED_MAGIC)) == 0 &&
+                h.version == UCRA_MANIFEST_COMPILED_VERSION && h.header_size == sizeof(h) &&
+                h.source_hash == source_hash && h.source_size == source_size &&
+                h.file_size == map.size &&
+                section_valid(&h, h.rates_offset, h.rates_count, sizeof(uint32_t)) &&
+                section_valid(&h, h.channels_offset, h.channels_count, sizeof(uint32_t)) &&
+                section_valid(&h, h.flags_offset, h.flags_count, sizeof(UCRA_CompiledFlag)) &&
+                section_valid(&h, h.values_offset, h.values_count, sizeof(uint32_t)) &&
+                (uint64_t)h.strings_offset + h.strings_size == h.file_size &&
+                (h.strings_size == 0 || base[h.file_size - 1] == '\0') &&
+                string_valid(&h, h.name) && string_valid(&h, h.version_string) &&
+                string_valid(&h, h.vendor) && string_valid(&h, h.license) &&
+                string_valid(&h, h.entry_type) && string_valid(&h, h.entry_path) &&
+                string_valid(&h, h.entry_symbol);
+    }
+    const UCRA_CompiledFlag* records = valid ? (const UCRA_CompiledFlag*)(base + h.flags_offset) : NULL;
+    const uint32_t* value_offsets = valid ? (const uint32_t*)(base + h.values_offset) : NULL;
+    for (uint32_t i = 0; valid && i < h.flags_count; ++i) {
+        const UCRA_CompiledFlag* r = &records[i];
+        valid = r->key != COMPILED_NONE && string_valid(&h, r->key) && string_valid(&h, r->type) && string_valid(&h, r->desc) &&
+                string_valid(&h, r->default_val) &&
+                (uint64_t)r->values_first + r->values_count <= h.values_count;
+    }
+    for (uint32_t i = 0; valid && i < h.values_count; ++i) {
+        valid = value_offsets[i] != COMPILED_NONE && string_valid(&h, value_offsets[i]);
+    }
+    if (!valid) {
+        ucra_file_unmap(&map);
+        return UCRA_ERR_INTERNAL;
+    }
+
+    /* one block for the structure, the flag array, the enum value pointers and the flag index;
+     * the rest stays mapped */
+    uint32_t index_slots = flag_index_slots(h.flags_count);
+    size_t size = sizeof(UCRA_ManifestInternal) + (size_t)h.flags_count * sizeof(UCRA_ManifestFlag) +
+                  (size_t)h.values_count * sizeof(const char*) + (size_t)index_slots * sizeof(uint32_t);
+    UCRA_ManifestInternal* manifest = calloc(1, size);
+    if (!manifest) {
+        ucra_file_unmap(&map);
+        return UCRA_ERR_OUT_OF_MEMORY;
+    }
+    UCRA_ManifestFlag* flags = (UCRA_ManifestFlag*)(manifest + 1);
+    const char** values = (const char**)(flags + h.flags_count);
+    manifest->map = map;
+
+    UCRA_Manifest* m = &manifest->public_manifest;
+    m->name = compiled_string(&h, base, h.name);
+    m->version = compiled_string(&h, base, h.version_string);
+    m->vendor = compiled_string(&h, base, h.vendor);
+    m->license = compiled_string(&h, base, h.license);
+    m->entry.type = compiled_string(&h, base, h.entry_type);
+    m->entry.path = compiled_string(&h, base, h.entry_path);
+    m->entry.symbol = compiled_string(&h, base, h.entry_symbol);
+    m->audio.rates = h.rates_count ? (const uint32_t*)(base + h.rates_offset) : NULL;
+    m->audio.rates_count = h.rates_count;
+    m->audio.channels = h.channels_count ? (const uint32_t*)(base + h.channels_offset) : NULL;
+    m->audio.channels_count = h.channels_count;
+    m->audio.streaming = (int)h.streaming;
+    for (uint32_t i = 0; i < h.values_count; ++i) {
+        values[i] = compiled_string(&h, base, value_offsets[i]);
+    }
+    for (uint32_t i = 0; i < h.flags_count; ++i) {
+        const UCRA_CompiledFlag* r = &records[i];
+        flags[i].key = compiled_string(&h, base, r->key);
+        flags[i].type = compiled_string(&h, base, r->type);
+        flags[i].desc = compiled_string(&h, base, r->desc);
+        flags[i].default_val = compiled_string(&h, base, r->default_val);
+        flags[i].range = r->has_range ? r->range : NULL;
+        flags[i].values = r->values_count ? values + r->values_first : NULL;
+        flags[i].values_count = r->values_count;
     }
+    m->flags = h.flags_count ? flags : NULL;
+    m->flags_count = h.flags_count;
+    build_flag_index(manifest, (uint32_t*)(values + h.values_count), index_slots);
 
-    manifest->allocated_flags = flags;
-    manifest->public_manifest.flags = flags;
-    manifest->public_manifest.flags_count = (uint32_t)count;
+    *outManifest = m;
     return UCRA_SUCCESS;
 }
 
@@ -373,6 +753,7 @@ UCRA_Result ucra_manifest_load(const char* manifest_path, UCRA_Manifest** outMan
     *outManifest = NULL;
 
     /* Read file content */
+    UCRA_TRACE_BEGIN(load);
     char* json_content = NULL;
     size_t content_size = 0;
     UCRA_Result result = ucra_read_file(manifest_path, &json_content, &content_size);
@@ -380,155 +761,268 @@ UCRA_Result ucra_manifest_load(const char* manifest_path, UCRA_Manifest** outMan
         return result;
     }
 
-    /* Parse JSON */
-    cJSON* json = cJSON_Parse(json_content);
+    /* A compiled manifest made from exactly this text replaces parsing it */
+    uint64_t source_hash = ucra_fnv1a(UCRA_FNV_OFFSET, json_content, content_size);
+    char* compiled_path = compiled_path_for(manifest_path);
+    if (compiled_path && open_compiled(compiled_path, source_hash, content_size, outManifest) == UCRA_SUCCESS) {
+        free(compiled_path);
+        free(json_content);
+        UCRA_TRACE_END(load, "manifest.load");
+        return UCRA_SUCCESS;
+    }
+    free(compiled_path);
+
+    result = parse_manifest_json(json_content, outManifest);
     free(json_content);
+    UCRA_TRACE_END(load, "manifest.load");
+    return result;
+}
 
-    if (!json) {
-        return UCRA_ERR_INVALID_JSON;
+UCRA_Result ucra_manifest_compile(const char* manifest_path, const char* compiled_path) {
+    if (!manifest_path) {
+        return UCRA_ERR_INVALID_ARGUMENT;
     }
 
-    /* Validate schema compliance */
-    result = ucra_validate_required_fields(json);
+    char* json_content = NULL;
+    size_t content_size = 0;
+    UCRA_Result result = ucra_read_file(manifest_path, &json_content, &content_size);
     if (result != UCRA_SUCCESS) {
-        cJSON_Delete(json);
         return result;
     }
 
-    /* Validate flags array if present */
-    cJSON* flags = cJSON_GetObjectItem(json, "flags");
-    result = ucra_validate_flags_array(flags);
-    if (result != UCRA_SUCCESS) {
-        cJSON_Delete(json);
-        return result;
+    UCRA_Manifest* manifest = NULL;
+    result = parse_manifest_json(json_content, &manifest);
+    if (result == UCRA_SUCCESS) {
+        char* default_path = compiled_path ? NULL : compiled_path_for(manifest_path);
+        const char* path = compiled_path ? compiled_path : default_path;
+        result = path ? write_compiled(manifest, ucra_fnv1a(UCRA_FNV_OFFSET, json_content, content_size),
+                                       content_size, path)
+                      : UCRA_ERR_OUT_OF_MEMORY;
+        free(default_path);
+        ucra_manifest_free(manifest);
     }
+    free(json_content);
+    return result;
+}
 
-    /* Allocate internal manifest structure */
-    UCRA_ManifestInternal* manifest = calloc(1, sizeof(UCRA_ManifestInternal));
-    if (!manifest) {
-        cJSON_Delete(json);
-        return UCRA_ERR_OUT_OF_MEMORY;
-    }
+int ucra_manifest_is_compiled(const UCRA_Manifest* manifest) {
+    return manifest && ((const UCRA_ManifestInternal*)manifest)->map.data != NULL;
+}
 
-    /* Parse basic string fields */
-    cJSON* item;
+const UCRA_ManifestFlag* ucra_manifest_find_flag(const UCRA_Manifest* manifest, const char* key) {
+    if (!manifest || !key) return NULL;
 
-    item = cJSON_GetObjectItem(json, "name");
-    if (cJSON_IsString(item)) {
-        manifest->public_manifest.name = ucra_strdup(item->valuestring);
+    const UCRA_ManifestInternal* internal = (const UCRA_ManifestInternal*)manifest;
+    if (!internal->flag_index) return NULL;
+    uint32_t slot = flag_key_hash(key) & internal->flag_index_mask;
+    while (internal->flag_index[slot]) {
+        const UCRA_ManifestFlag* flag = &manifest->flags[internal->flag_index[slot] - 1];
+        if (strcmp(flag->key, key) == 0) return flag;
+        slot = (slot + 1) & internal->flag_index_mask;
     }
+    return NULL;
+}
 
-    item = cJSON_GetObjectItem(json, "version");
-    if (cJSON_IsString(item)) {
-        manifest->public_manifest.version = ucra_strdup(item->valuestring);
-    }
+static void free_manifest_internal(UCRA_ManifestInternal* internal);
+
+void ucra_manifest_free(UCRA_Manifest* manifest) {
+    if (!manifest) return;
 
-    item = cJSON_GetObjectItem(json, "vendor");
-    if (cJSON_IsString(item)) {
-        manifest->public_manifest.vendor = ucra_strdup(item->valuestring);
+    UCRA_ManifestInternal* internal = (UCRA_ManifestInternal*)manifest;
+    if (internal->refs > 0) {
+        ucra_manifest_release(manifest); /* shared: only drop the caller's reference */
+        return;
     }
+    free_manifest_internal(internal);
+}
+
+static void free_manifest_internal(UCRA_ManifestInternal* internal) {
+    ucra_file_unmap(&internal->map);
+    free(internal);
+}
+
+/* ---------------------------------------------------------------------------
+ * Shared manifest registry
+ * ------------------------------------------------------------------------- */
+
+#define MANIFEST_REGISTRY_BUCKETS 64
+
+/* What identifies one version of a file: rewriting or replacing it changes at least one field */
+typedef struct UCRA_ManifestFileId {
+    int64_t mtime_sec;
+    int64_t mtime_nsec;
+    int64_t size;
+    uint64_t inode;
+} UCRA_ManifestFileId;
+
+typedef struct UCRA_ManifestRegistryEntry {
+    char* path;                      /* canonical path, the registry key */
+    UCRA_ManifestFileId id;          /* file version the manifest was parsed from */
+    UCRA_ManifestInternal* manifest; /* holds one reference for the registry */
+    struct UCRA_ManifestRegistryEntry* next;
+} UCRA_ManifestRegistryEntry;
+
+static UCRA_Once g_registry_once = UCRA_ONCE_INIT;
+static UCRA_Mutex g_registry_mutex;
+static UCRA_ManifestRegistryEntry* g_registry[MANIFEST_REGISTRY_BUCKETS];
+
+static void registry_init(void) {
+    ucra_mutex_init(&g_registry_mutex);
+}
 
-    item = cJSON_GetObjectItem(json, "license");
-    if (cJSON_IsString(item)) {
-        manifest->public_manifest.license = ucra_strdup(item->valuestring);
+static uint32_t registry_bucket(const char* path) {
+    uint32_t hash = 2166136261u; /* 32-bit FNV-1a */
+    for (const unsigned char* p = (const unsigned char*)path; *p; ++p) {
+        hash = (hash ^ *p) * 16777619u;
     }
+    return hash % MANIFEST_REGISTRY_BUCKETS;
+}
 
-    /* Parse entry object */
-    cJSON* entry = cJSON_GetObjectItem(json, "entry");
-    if (cJSON_IsObject(entry)) {
-        item = cJSON_GetObjectItem(entry, "type");
-        if (cJSON_IsString(item)) {
-            manifest->public_manifest.entry.type = ucra_strdup(item->valuestring);
-        }
+/* malloc'd absolute path with links resolved, NULL if the file does not exist */
+static char* canonical_path(const char* path) {
+#ifdef _WIN32
+    return _fullpath(NULL, path, 0);
+#else
+    return realpath(path, NULL);
+#endif
+}
 
-        item = cJSON_GetObjectItem(entry, "path");
-        if (cJSON_IsString(item)) {
-            manifest->public_manifest.entry.path = ucra_strdup(item->valuestring);
-        }
+static int file_id(const char* path, UCRA_ManifestFileId* out) {
+    memset(out, 0, sizeof(*out));
+#ifdef _WIN32
+    WIN32_FILE_ATTRIBUTE_DATA data;
+    if (!GetFileAttributesExA(path, GetFileExInfoStandard, &data)) return 0;
+    uint64_t ticks = ((uint64_t)data.ftLastWriteTime.dwHighDateTime << 32) | data.ftLastWriteTime.dwLowDateTime;
+    out->mtime_sec = (int64_t)(ticks / 10000000u);
+    out->mtime_nsec = (int64_t)(ticks % 10000000u) * 100;
+    out->size = (int64_t)(((uint64_t)data.nFileSizeHigh << 32) | data.nFileSizeLow);
+#else
+    struct stat st;
+    if (stat(path, &st) != 0) return 0;
+    out->mtime_sec = (int64_t)st.st_mtime;
+#if defined(__APPLE__)
+    out->mtime_nsec = (int64_t)st.st_mtimespec.tv_nsec;
+#elif defined(__linux__)
+    out->mtime_nsec = (int64_t)st.st_mtim.tv_nsec;
+#endif
+    out->size = (int64_t)st.st_size;
+    out->inode = (uint64_t)st.st_ino;
+#endif
+    return 1;
+}
 
-        item = cJSON_GetObjectItem(entry, "symbol");
-        if (cJSON_IsString(item)) {
-            manifest->public_manifest.entry.symbol = ucra_strdup(item->valuestring);
-        }
+static int file_id_equal(const UCRA_ManifestFileId* a, const UCRA_ManifestFileId* b) {
+    return a->mtime_sec == b->mtime_sec && a->mtime_nsec == b->mtime_nsec &&
+           a->size == b->size && a->inode == b->inode;
+}
+
+/* Drop one reference; the registry mutex must be held */
+static void release_locked(UCRA_ManifestInternal* manifest) {
+    if (--manifest->refs == 0) {
+        free_manifest_internal(manifest);
     }
+}
 
-    /* Parse audio object */
-    cJSON* audio = cJSON_GetObjectItem(json, "audio");
-    if (cJSON_IsObject(audio)) {
-        /* Parse rates array */
-        cJSON* rates = cJSON_GetObjectItem(audio, "rates");
-        result = ucra_parse_int_array(rates, &manifest->allocated_rates, &manifest->public_manifest.audio.rates_count);
-        if (result == UCRA_SUCCESS) {
-            manifest->public_manifest.audio.rates = manifest->allocated_rates;
-        }
+static UCRA_ManifestRegistryEntry* find_entry(uint32_t bucket, const char* path) {
+    for (UCRA_ManifestRegistryEntry* entry = g_registry[bucket]; entry; entry = entry->next) {
+        if (strcmp(entry->path, path) == 0) return entry;
+    }
+    return NULL;
+}
 
-        /* Parse channels array */
-        cJSON* channels = cJSON_GetObjectItem(audio, "channels");
-        result = ucra_parse_int_array(channels, &manifest->allocated_channels, &manifest->public_manifest.audio.channels_count);
-        if (result == UCRA_SUCCESS) {
-            manifest->public_manifest.audio.channels = manifest->allocated_channels;
-        }
+UCRA_Result ucra_manifest_acquire(const char* manifest_path, const UCRA_Manifest** outManifest) {
+    if (!manifest_path || !outManifest) {
+        return UCRA_ERR_INVALID_ARGUMENT;
+    }
+    *outManifest = NULL;
+    ucra_once(&g_registry_once, registry_init);
 
-        /* Parse streaming flag */
-        item = cJSON_GetObjectItem(audio, "streaming");
-        if (cJSON_IsBool(item)) {
-            manifest->public_manifest.audio.streaming = cJSON_IsTrue(item);
-        }
+    char* path = canonical_path(manifest_path);
+    UCRA_ManifestFileId id;
+    if (!path || !file_id(path, &id)) {
+        free(path);
+        return UCRA_ERR_FILE_NOT_FOUND;
+    }
+    uint32_t bucket = registry_bucket(path);
+
+    ucra_mutex_lock(&g_registry_mutex);
+    UCRA_ManifestRegistryEntry* entry = find_entry(bucket, path);
+    if (entry && file_id_equal(&entry->id, &id)) {
+        entry->manifest->refs++;
+        *outManifest = &entry->manifest->public_manifest;
+        ucra_mutex_unlock(&g_registry_mutex);
+        free(path);
+        return UCRA_SUCCESS;
     }
+    ucra_mutex_unlock(&g_registry_mutex);
 
-    /* Parse flags array */
-    cJSON* flags_obj = cJSON_GetObjectItem(json, "flags");
-    if (flags_obj) {
-        result = ucra_parse_flags(flags_obj, manifest);
-        if (result != UCRA_SUCCESS) {
-            cJSON_Delete(json);
-            ucra_manifest_free((UCRA_Manifest*)manifest);
-            return result;
+    /* Parse outside the lock; the file was identified first, so if it changes
+     * meanwhile the entry just looks stale to the next caller */
+    UCRA_Manifest* loaded = NULL;
+    UCRA_Result result = ucra_manifest_load(path, &loaded);
+    if (result != UCRA_SUCCESS) {
+        free(path);
+        return result;
+    }
+    UCRA_ManifestInternal* manifest = (UCRA_ManifestInternal*)loaded;
+
+    ucra_mutex_lock(&g_registry_mutex);
+    entry = find_entry(bucket, path);
+    if (entry && file_id_equal(&entry->id, &id)) {
+        /* another caller loaded the same version first */
+        free_manifest_internal(manifest);
+        free(path);
+    } else if (entry) {
+        /* the file changed: current holders keep the old version until they release it */
+        release_locked(entry->manifest);
+        entry->id = id;
+        entry->manifest = manifest;
+        manifest->refs = 1;
+        free(path);
+    } else {
+        entry = calloc(1, sizeof(UCRA_ManifestRegistryEntry));
+        if (!entry) {
+            ucra_mutex_unlock(&g_registry_mutex);
+            free_manifest_internal(manifest);
+            free(path);
+            return UCRA_ERR_OUT_OF_MEMORY;
         }
+        entry->path = path;
+        entry->id = id;
+        entry->manifest = manifest;
+        manifest->refs = 1;
+        entry->next = g_registry[bucket];
+        g_registry[bucket] = entry;
     }
-
-    cJSON_Delete(json);
-    *outManifest = (UCRA_Manifest*)manifest;
+    entry->manifest->refs++;
+    *outManifest = &entry->manifest->public_manifest;
+    ucra_mutex_unlock(&g_registry_mutex);
     return UCRA_SUCCESS;
 }
 
-void ucra_manifest_free(UCRA_Manifest* manifest) {
+void ucra_manifest_release(const UCRA_Manifest* manifest) {
     if (!manifest) return;
 
     UCRA_ManifestInternal* internal = (UCRA_ManifestInternal*)manifest;
+    ucra_mutex_lock(&g_registry_mutex); /* initialized by the acquire that returned manifest */
+    release_locked(internal);
+    ucra_mutex_unlock(&g_registry_mutex);
+}
 
-    /* Free string fields */
-    free((void*)internal->public_manifest.name);
-    free((void*)internal->public_manifest.version);
-    free((void*)internal->public_manifest.vendor);
-    free((void*)internal->public_manifest.license);
-    free((void*)internal->public_manifest.entry.type);
-    free((void*)internal->public_manifest.entry.path);
-    free((void*)internal->public_manifest.entry.symbol);
-
-    /* Free audio arrays */
-    free(internal->allocated_rates);
-    free(internal->allocated_channels);
-
-    /* Free flags */
-    if (internal->allocated_flags) {
-        for (uint32_t i = 0; i < internal->public_manifest.flags_count; i++) {
-            free((void*)internal->allocated_flags[i].key);
-            free((void*)internal->allocated_flags[i].type);
-            free((void*)internal->allocated_flags[i].desc);
-            free((void*)internal->allocated_flags[i].default_val);
-            free((void*)internal->allocated_flags[i].range);
-
-            if (internal->allocated_flags[i].values) {
-                for (uint32_t j = 0; j < internal->allocated_flags[i].values_count; j++) {
-                    free((void*)internal->allocated_flags[i].values[j]);
-                }
-                free((void*)internal->allocated_flags[i].values);
-            }
+void ucra_manifest_registry_clear(void) {
+    ucra_once(&g_registry_once, registry_init);
+
+    ucra_mutex_lock(&g_registry_mutex);
+    for (uint32_t b = 0; b < MANIFEST_REGISTRY_BUCKETS; ++b) {
+        UCRA_ManifestRegistryEntry* entry = g_registry[b];
+        while (entry) {
+            UCRA_ManifestRegistryEntry* next = entry->next;
+            release_locked(entry->manifest);
+            free(entry->path);
+            free(entry);
+            entry = next;
         }
-        free(internal->allocated_flags);
+        g_registry[b] = NULL;
     }
-
-    /* Free the manifest structure itself */
-    free(internal);
+    ucra_mutex_unlock(&g_registry_mutex);
 }
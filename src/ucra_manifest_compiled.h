@@ -0,0 +1,52 @@
+/*
+ * UCRA Compiled Manifests (internal)
+ * A binary form of resampler.json that ucra_manifest_load() maps instead of
+ * parsing the JSON. It holds a versioned header, the audio arrays, fixed-size
+ * flag records and a string table, and records a hash of the JSON text it was
+ * compiled from, so an edited manifest is parsed again rather than served stale.
+ *
+ * "dir/resampler.json" is compiled to "dir/resampler_json.ucra". The file is in
+ * native byte order; one built on another architecture is ignored.
+ */
+#ifndef UCRA_MANIFEST_COMPILED_H
+#define UCRA_MANIFEST_COMPILED_H
+
+#include "ucra/ucra.h"
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Bumped whenever the file layout or the meaning of its fields changes */
+#define UCRA_MANIFEST_COMPILED_VERSION 1
+
+#define UCRA_MANIFEST_COMPILED_SUFFIX "_json.ucra"
+
+/**
+ * @brief Compiled file path for a manifest: "dir/resampler.json" -> "dir/resampler_json.ucra"
+ * @return UCRA_SUCCESS, or UCRA_ERR_INVALID_ARGUMENT if out is too small
+ */
+UCRA_Result ucra_manifest_compiled_path(const char* manifest_path, char* out, size_t out_size);
+
+/**
+ * @brief Parse a JSON manifest and write its compiled form
+ *
+ * The file is replaced atomically, so a concurrent loader sees either the old
+ * or the new one.
+ *
+ * @param manifest_path JSON manifest
+ * @param compiled_path Output file, or NULL for the path ucra_manifest_load() looks at
+ * @return UCRA_SUCCESS, or the ucra_manifest_load() error for an invalid manifest
+ */
+UCRA_Result ucra_manifest_compile(const char* manifest_path, const char* compiled_path);
+
+/** Whether a loaded manifest is served from a compiled file */
+int ucra_manifest_is_compiled(const UCRA_Manifest* manifest);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* UCRA_MANIFEST_COMPILED_H */
@@ -0,0 +1,257 @@
+/*
+ * UCRA Mixer Implementation
+ * Sums several streams (tracks) into one output. Every read pulls the next
+ * piece of all tracks in parallel on a shared worker pool, then applies each
+ * track's gain and pan on the calling thread.
+ */
+
+#include "ucra/ucra.h"
+#include "ucra_options.h"
+#include "ucra_threads.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#ifndef M_PI
+    #define M_PI 3.14159265358979323846
+#endif
+
+/* Mixer option selecting the number of track render threads (0 = one per CPU) */
+#define UCRA_RENDER_THREADS_OPTION "render_threads"
+
+/* Frames each track renders per pool run, in blocks */
+#define MIXER_CHUNK_BLOCKS 4
+
+typedef struct UCRA_MixerTrack {
+    UCRA_StreamHandle stream;
+    volatile uint32_t gain_bits;  /* float bits, so a control thread can change them mid-read */
+    volatile uint32_t pan_bits;
+    float* scratch;               /* this track's mono frames of the current chunk */
+    uint32_t frames;              /* frames the track delivered for the current chunk */
+    int finished;                 /* the track's callback ended it */
+} UCRA_MixerTrack;
+
+typedef struct UCRA_MixerState_ {
+    uint32_t sample_rate;
+    uint32_t channels;
+    uint32_t block_size;
+    uint32_t chunk_frames;        /* scratch size per track */
+
+    UCRA_MixerTrack* tracks;
+    uint32_t track_count;
+    uint32_t track_capacity;
+
+    UCRA_ThreadPool* pool;
+    uint32_t pool_threads;        /* 0 = one per CPU */
+    uint32_t pull_frames;         /* frames every track is asked for in the current run */
+} UCRA_MixerState;
+
+static uint32_t float_bits(float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+static float bits_float(uint32_t bits) {
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+UCRA_Result ucra_mixer_create(UCRA_MixerHandle* out_mixer, const UCRA_RenderConfig* config) {
+    if (!out_mixer || !config) {
+        return UCRA_ERR_INVALID_ARGUMENT;
+    }
+    *out_mixer = NULL;
+    if (config->sample_rate == 0 || config->block_size == 0 ||
+        (config->channels != 1 && config->channels != 2)) {
+        return UCRA_ERR_INVALID_ARGUMENT;
+    }
+
+    UCRA_MixerState* mixer = calloc(1, sizeof(UCRA_MixerState));
+    if (!mixer) {
+        return UCRA_ERR_OUT_OF_MEMORY;
+    }
+    mixer->sample_rate = config->sample_rate;
+    mixer->channels = config->channels;
+    mixer->block_size = config->block_size;
+    mixer->chunk_frames = config->block_size * MIXER_CHUNK_BLOCKS;
+
+    for (uint32_t i = 0; config->options && i < config->option_count; ++i) {
+        const char* key = config->options[i].key;
+        const char* value = config->options[i].value;
+        if (key && value && strcmp(key, UCRA_RENDER_THREADS_OPTION) == 0) {
+            long n = strtol(value, NULL, 10);
+            mixer->pool_threads = n > 0 ? (uint32_t)n : (n == 0 ? 0 : 1);
+        }
+    }
+
+    *out_mixer = (UCRA_MixerHandle)mixer;
+    return UCRA_SUCCESS;
+}
+
+void ucra_mixer_destroy(UCRA_MixerHandle handle) {
+    if (!handle) return;
+
+    UCRA_MixerState* mixer = (UCRA_MixerState*)handle;
+    if (mixer->pool) {
+        ucra_pool_destroy(mixer->pool);
+    }
+    for (uint32_t t = 0; t < mixer->track_count; ++t) {
+        ucra_stream_close(mixer->tracks[t].stream);
+        free(mixer->tracks[t].scratch);
+    }
+    free(mixer->tracks);
+    free(mixer);
+}
+
+UCRA_Result ucra_mixer_add_track(UCRA_MixerHandle handle,
+                                 UCRA_Handle engine,
+                                 const UCRA_RenderConfig* config,
+                                 UCRA_PullPCM callback,
+                                 void* user_data,
+                                 uint32_t* out_track) {
+    UCRA_MixerState* mixer = (UCRA_MixerState*)handle;
+    if (!mixer || !callback) {
+        return UCRA_ERR_INVALID_ARGUMENT;
+    }
+
+    if (mixer->track_count == mixer->track_capacity) {
+        uint32_t capacity = mixer->track_capacity ? mixer->track_capacity * 2 : 4;
+        UCRA_MixerTrack* tracks = realloc(mixer->tracks, capacity * sizeof(UCRA_MixerTrack));
+        if (!tracks) {
+            return UCRA_ERR_OUT_OF_MEMORY;
+        }
+        mixer->tracks = tracks;
+        mixer->track_capacity = capacity;
+    }
+
+    /* Tracks are mono streams in the mixer's format; options such as the buffering ones pass through */
+    UCRA_RenderConfig track_config;
+    memset(&track_config, 0, sizeof(track_config));
+    if (config) {
+        ucra_config_copy(&track_config, config);
+    }
+    track_config.sample_rate = mixer->sample_rate;
+    track_config.channels = 1;
+    track_config.block_size = mixer->block_size;
+    track_config.flags &= ~UCRA_RENDER_LAYOUT_MASK;
+
+    UCRA_MixerTrack* track = &mixer->tracks[mixer->track_count];
+    memset(track, 0, sizeof(*track));
+    track->scratch = malloc((size_t)mixer->chunk_frames * sizeof(float));
+    if (!track->scratch) {
+        return UCRA_ERR_OUT_OF_MEMORY;
+    }
+    UCRA_Result result = ucra_stream_open_engine(&track->stream, engine, &track_config, callback, user_data);
+    if (result != UCRA_SUCCESS) {
+        free(track->scratch);
+        return result;
+    }
+    track->gain_bits = float_bits(1.0f);
+    track->pan_bits = float_bits(0.0f);
+
+    if (out_track) *out_track = mixer->track_count;
+    mixer->track_count++;
+    return UCRA_SUCCESS;
+}
+
+UCRA_Result ucra_mixer_set_track(UCRA_MixerHandle handle, uint32_t track, float gain, float pan) {
+    UCRA_MixerState* mixer = (UCRA_MixerState*)handle;
+    if (!mixer || track >= mixer->track_count || !(pan >= -1.0f && pan <= 1.0f)) {
+        return UCRA_ERR_INVALID_ARGUMENT;
+    }
+    ucra_atomic_store_release(&mixer->tracks[track].gain_bits, float_bits(gain));
+    ucra_atomic_store_release(&mixer->tracks[track].pan_bits, float_bits(pan));
+    return UCRA_SUCCESS;
+}
+
+UCRA_Result ucra_mixer_get_track_stream(UCRA_MixerHandle handle, uint32_t track, UCRA_StreamHandle* out_stream) {
+    UCRA_MixerState* mixer = (UCRA_MixerState*)handle;
+    if (!mixer || !out_stream || track >= mixer->track_count) {
+        return UCRA_ERR_INVALID_ARGUMENT;
+    }
+    *out_stream = mixer->tracks[track].stream;
+    return UCRA_SUCCESS;
+}
+
+/* Pool job: read the next pull_frames frames of one track into its scratch */
+static void pull_track_job(void* ctx, uint32_t job, uint32_t worker) {
+    (void)worker;
+    UCRA_MixerState* mixer = (UCRA_MixerState*)ctx;
+    UCRA_MixerTrack* track = &mixer->tracks[job];
+    track->frames = 0;
+    if (track->finished) return;
+    if (ucra_stream_read(track->stream, track->scratch, mixer->pull_frames, &track->frames) != UCRA_SUCCESS) {
+        track->finished = 1; /* the frames read before the callback ended it still count */
+    }
+}
+
+static UCRA_Result ensure_pool(UCRA_MixerState* mixer) {
+    if (mixer->pool || mixer->track_count < 2) return UCRA_SUCCESS;
+    uint32_t threads = mixer->pool_threads ? mixer->pool_threads : ucra_cpu_count();
+    if (threads > mixer->track_count) threads = mixer->track_count;
+    if (threads < 2) return UCRA_SUCCESS; /* tracks are pulled on the calling thread */
+    return ucra_pool_create(threads, &mixer->pool);
+}
+
+UCRA_Result ucra_mixer_read(UCRA_MixerHandle handle,
+                            float* out_buffer,
+                            uint32_t frame_count,
+                            uint32_t* out_frames_read) {
+    UCRA_MixerState* mixer = (UCRA_MixerState*)handle;
+    if (!mixer || !out_buffer || !out_frames_read) {
+        return UCRA_ERR_INVALID_ARGUMENT;
+    }
+    *out_frames_read = 0;
+
+    UCRA_Result pool_result = ensure_pool(mixer);
+    if (pool_result != UCRA_SUCCESS) {
+        return pool_result;
+    }
+
+    uint32_t channels = mixer->channels;
+    uint32_t produced = 0;
+    while (produced < frame_count) {
+        mixer->pull_frames = frame_count - produced < mixer->chunk_frames ? frame_count - produced
+                                                                          : mixer->chunk_frames;
+        ucra_pool_run(mixer->pool, mixer->track_count, pull_track_job, mixer);
+
+        /* The chunk is as long as the longest track read; shorter tracks are silent past their end */
+        uint32_t frames = 0;
+        for (uint32_t t = 0; t < mixer->track_count; ++t) {
+            if (mixer->tracks[t].frames > frames) frames = mixer->tracks[t].frames;
+        }
+        if (frames == 0) {
+            break; /* no track had anything to deliver */
+        }
+
+        float* out = out_buffer + (size_t)produced * channels;
+        memset(out, 0, (size_t)frames * channels * sizeof(float));
+        for (uint32_t t = 0; t < mixer->track_count; ++t) {
+            const UCRA_MixerTrack* track = &mixer->tracks[t];
+            float gain = bits_float(ucra_atomic_load_acquire(&track->gain_bits));
+            if (channels == 1) {
+                for (uint32_t n = 0; n < track->frames; ++n) {
+                    out[n] += gain * track->scratch[n];
+                }
+                continue;
+            }
+            /* constant-power pan: equal gains of gain / sqrt(2) at the centre */
+            double angle = (bits_float(ucra_atomic_load_acquire(&track->pan_bits)) + 1.0) * M_PI / 4.0;
+            float left = (float)(gain * cos(angle));
+            float right = (float)(gain * sin(angle));
+            for (uint32_t n = 0; n < track->frames; ++n) {
+                out[2 * n] += left * track->scratch[n];
+                out[2 * n + 1] += right * track->scratch[n];
+            }
+        }
+        produced += frames;
+        if (frames < mixer->pull_frames) {
+            break; /* short read: no track could render more right now */
+        }
+    }
+
+    *out_frames_read = produced;
+    return UCRA_SUCCESS;
+}
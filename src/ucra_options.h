@@ -0,0 +1,51 @@
+/*
+ * UCRA Render Options (internal)
+ * Lookup of typed render options, which the engines consult before the
+ * string options of the same key.
+ */
+#ifndef UCRA_OPTIONS_H
+#define UCRA_OPTIONS_H
+
+#include "ucra/ucra.h"
+
+#include <stddef.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Copy a caller's config
+ *
+ * Reads the typed option fields only when UCRA_RENDER_TYPED_OPTIONS says they
+ * exist, and clears them otherwise, so a config laid out by an older header
+ * is never read past its end.
+ */
+static inline void ucra_config_copy(UCRA_RenderConfig* dst, const UCRA_RenderConfig* src) {
+    if (src->flags & UCRA_RENDER_TYPED_OPTIONS) {
+        *dst = *src;
+        return;
+    }
+    memcpy(dst, src, offsetof(UCRA_RenderConfig, typed_options));
+    dst->typed_options = NULL;
+    dst->typed_option_count = 0;
+}
+
+/** Last typed option named key, or NULL; none without UCRA_RENDER_TYPED_OPTIONS in config->flags */
+static inline const UCRA_TypedValue* ucra_typed_option(const UCRA_RenderConfig* config, const char* key) {
+    const UCRA_TypedValue* found = NULL;
+    if (!config || !(config->flags & UCRA_RENDER_TYPED_OPTIONS) || !config->typed_options) return NULL;
+    for (uint32_t i = 0; i < config->typed_option_count; ++i) {
+        if (config->typed_options[i].key && strcmp(config->typed_options[i].key, key) == 0) {
+            found = &config->typed_options[i];
+        }
+    }
+    return found;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* UCRA_OPTIONS_H */
@@ -0,0 +1,411 @@
+/*
+ * UCRA Render Cache
+ * Stores render output in a directory, one file per render named by a 128-bit
+ * key hashed from the whole request. Hits are memory-mapped; the least
+ * recently used files (oldest modification time, refreshed on every hit) are
+ * removed once the directory grows past its bound.
+ */
+
+#include "ucra/ucra.h"
+#include "ucra_file.h"
+#include "ucra_threads.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define RENDER_CACHE_MAGIC "UCRAPCM"
+#define RENDER_CACHE_VERSION 1u
+#define RENDER_CACHE_SUFFIX ".ucrapcm"
+#define RENDER_CACHE_NAME_LENGTH (32 + sizeof(RENDER_CACHE_SUFFIX) - 1)
+
+/* Seed of the second key hash, so the two halves are independent */
+#define RENDER_CACHE_SEED2 (UCRA_FNV_OFFSET ^ 0x9e3779b97f4a7c15ull)
+
+/* On-disk header; frames * channels floats follow (frames for the mono layout) */
+typedef struct RenderCacheHeader {
+    char magic[8];          /* RENDER_CACHE_MAGIC, NUL padded */
+    uint32_t version;       /* RENDER_CACHE_VERSION */
+    uint32_t header_size;   /* sizeof(RenderCacheHeader), also marks the byte order */
+    uint64_t key[2];
+    uint64_t frames;
+    uint32_t channels;
+    uint32_t sample_rate;
+    uint32_t layout;
+    uint32_t reserved;
+} RenderCacheHeader;
+
+typedef struct UCRA_RenderCache_ {
+    char* directory;
+    uint64_t max_bytes;     /* 0 = unbounded */
+    uint64_t total_bytes;   /* entries on disk, as last counted plus what this handle stored since */
+    UCRA_FileMap hit;       /* mapping behind the last hit's PCM */
+    uint32_t temp_counter;
+} UCRA_RenderCache;
+
+typedef struct KeyHash {
+    uint64_t h[2];
+} KeyHash;
+
+typedef struct CacheEntry {
+    char name[RENDER_CACHE_NAME_LENGTH + 1];
+    uint64_t size;
+    int64_t mtime;
+} CacheEntry;
+
+typedef struct EntryList {
+    const UCRA_RenderCache* cache;
+    CacheEntry* entries;
+    uint32_t count;
+    uint32_t capacity;
+    uint64_t total;
+    int failed;
+} EntryList;
+
+static void key_feed(KeyHash* key, const void* bytes, size_t size) {
+    key->h[0] = ucra_fnv1a(key->h[0], bytes, size);
+    key->h[1] = ucra_fnv1a(key->h[1], bytes, size);
+}
+
+/* A tag byte tells NULL from "", and the NUL ends the string so neighbours cannot run together */
+static void key_feed_string(KeyHash* key, const char* text) {
+    unsigned char present = text != NULL;
+    key_feed(key, &present, 1);
+    if (text) key_feed(key, text, strlen(text) + 1);
+}
+
+static void key_feed_curve(KeyHash* key, const float* time_sec, const float* value, uint32_t length) {
+    key_feed(key, &length, sizeof(length));
+    if (length == 0) return;
+    key_feed(key, time_sec, (size_t)length * sizeof(float));
+    key_feed(key, value, (size_t)length * sizeof(float));
+}
+
+/* Stable insertion sort of order[] by keys[order[i]]; equal keys keep their order, since the
+ * first or last one may win, and option lists are short */
+static void sort_by_key(uint32_t* order, const char** keys, uint32_t count) {
+    for (uint32_t i = 0; i < count; ++i) order[i] = i;
+    for (uint32_t i = 1; i < count; ++i) {
+        uint32_t value = order[i];
+        uint32_t j = i;
+        while (j > 0 && strcmp(keys[order[j - 1]], keys[value]) > 0) {
+            order[j] = order[j - 1];
+            --j;
+        }
+        order[j] = value;
+    }
+}
+
+static UCRA_Result compute_key(const UCRA_Manifest* manifest, const UCRA_RenderConfig* config, uint64_t out_key[2]) {
+    KeyHash key = { { UCRA_FNV_OFFSET, RENDER_CACHE_SEED2 } };
+    uint32_t version = RENDER_CACHE_VERSION;
+    key_feed(&key, &version, sizeof(version));
+    key_feed_string(&key, manifest ? manifest->name : NULL);
+    key_feed_string(&key, manifest ? manifest->version : NULL);
+
+    uint32_t format[4] = { config->sample_rate, config->channels, config->block_size, config->flags };
+    key_feed(&key, format, sizeof(format));
+
+    key_feed(&key, &config->note_count, sizeof(config->note_count));
+    for (uint32_t i = 0; i < config->note_count; ++i) {
+        const UCRA_NoteSegment* note = &config->notes[i];
+        key_feed(&key, &note->start_sec, sizeof(note->start_sec));
+        key_feed(&key, &note->duration_sec, sizeof(note->duration_sec));
+        key_feed(&key, &note->midi_note, sizeof(note->midi_note));
+        key_feed(&key, &note->velocity, sizeof(note->velocity));
+        key_feed_string(&key, note->lyric);
+        const UCRA_F0Curve* f0 = note->f0_override;
+        const UCRA_EnvCurve* env = note->env_override;
+        key_feed_curve(&key, f0 ? f0->time_sec : NULL, f0 ? f0->f0_hz : NULL, f0 ? f0->length : 0);
+        key_feed_curve(&key, env ? env->time_sec : NULL, env ? env->value : NULL, env ? env->length : 0);
+    }
+
+    uint32_t typed_count = (config->flags & UCRA_RENDER_TYPED_OPTIONS) && config->typed_options
+                               ? config->typed_option_count : 0;
+    uint32_t option_count = config->options ? config->option_count : 0;
+    uint32_t largest = option_count > typed_count ? option_count : typed_count;
+    uint32_t* order = malloc((largest ? largest : 1) * sizeof(uint32_t));
+    const char** keys = malloc((largest ? largest : 1) * sizeof(const char*));
+    if (!order || !keys) {
+        free(order);
+        free(keys);
+        return UCRA_ERR_OUT_OF_MEMORY;
+    }
+
+    /* Options are hashed sorted by key, so their order does not matter */
+    for (uint32_t i = 0; i < option_count; ++i) {
+        keys[i] = config->options[i].key ? config->options[i].key : "";
+    }
+    sort_by_key(order, keys, option_count);
+    key_feed(&key, &option_count, sizeof(option_count));
+    for (uint32_t i = 0; i < option_count; ++i) {
+        key_feed_string(&key, config->options[order[i]].key);
+        key_feed_string(&key, config->options[order[i]].value);
+    }
+
+    for (uint32_t i = 0; i < typed_count; ++i) {
+        keys[i] = config->typed_options[i].key ? config->typed_options[i].key : "";
+    }
+    sort_by_key(order, keys, typed_count);
+    key_feed(&key, &typed_count, sizeof(typed_count));
+    for (uint32_t i = 0; i < typed_count; ++i) {
+        const UCRA_TypedValue* value = &config->typed_options[order[i]];
+        uint32_t type = (uint32_t)value->type;
+        key_feed_string(&key, value->key);
+        key_feed(&key, &type, sizeof(type));
+        key_feed(&key, &value->number, sizeof(value->number));
+        key_feed_string(&key, value->text);
+    }
+    free(keys);
+    free(order);
+
+    out_key[0] = key.h[0];
+    out_key[1] = key.h[1];
+    return UCRA_SUCCESS;
+}
+
+/* directory/name in a new allocation */
+static char* entry_path(const UCRA_RenderCache* cache, const char* name) {
+    size_t dir_length = strlen(cache->directory);
+    int add_sep = dir_length > 0 && cache->directory[dir_length - 1] != '/' && cache->directory[dir_length - 1] != '\\';
+    size_t size = dir_length + add_sep + strlen(name) + 1;
+    char* path = malloc(size);
+    if (path) snprintf(path, size, "%s%s%s", cache->directory, add_sep ? "/" : "", name);
+    return path;
+}
+
+static void key_name(const uint64_t key[2], char* out) {
+    snprintf(out, RENDER_CACHE_NAME_LENGTH + 1, "%016llx%016llx" RENDER_CACHE_SUFFIX,
+             (unsigned long long)key[0], (unsigned long long)key[1]);
+}
+
+static int is_entry_name(const char* name) {
+    size_t length = strlen(name);
+    return length == RENDER_CACHE_NAME_LENGTH &&
+           strcmp(name + length - (sizeof(RENDER_CACHE_SUFFIX) - 1), RENDER_CACHE_SUFFIX) == 0;
+}
+
+static int collect_entry(void* ctx, const char* name, int is_directory) {
+    EntryList* list = (EntryList*)ctx;
+    if (is_directory || !is_entry_name(name)) return 0;
+    if (list->count == list->capacity) {
+        uint32_t capacity = list->capacity ? list->capacity * 2 : 64;
+        CacheEntry* entries = realloc(list->entries, capacity * sizeof(CacheEntry));
+        if (!entries) {
+            list->failed = 1;
+            return 1;
+        }
+        list->entries = entries;
+        list->capacity = capacity;
+    }
+    CacheEntry* entry = &list->entries[list->count];
+    char* path = entry_path(list->cache, name);
+    if (!path) {
+        list->failed = 1;
+        return 1;
+    }
+    /* an entry another process removed meanwhile is skipped */
+    if (ucra_file_info(path, &entry->size, &entry->mtime) == UCRA_SUCCESS) {
+        memcpy(entry->name, name, RENDER_CACHE_NAME_LENGTH + 1);
+        list->total += entry->size;
+        list->count++;
+    }
+    free(path);
+    return 0;
+}
+
+static UCRA_Result list_entries(const UCRA_RenderCache* cache, EntryList* list) {
+    memset(list, 0, sizeof(*list));
+    list->cache = cache;
+    UCRA_Result result = ucra_dir_list(cache->directory, collect_entry, list);
+    if (result == UCRA_SUCCESS && list->failed) result = UCRA_ERR_OUT_OF_MEMORY;
+    if (result != UCRA_SUCCESS) free(list->entries);
+    return result;
+}
+
+static int compare_age(const void* a, const void* b) {
+    const CacheEntry* ea = (const CacheEntry*)a;
+    const CacheEntry* eb = (const CacheEntry*)b;
+    if (ea->mtime != eb->mtime) return ea->mtime < eb->mtime ? -1 : 1;
+    return strcmp(ea->name, eb->name);
+}
+
+/* Remove the least recently used entries, except keep, until the directory fits max_bytes */
+static void evict(UCRA_RenderCache* cache, const char* keep) {
+    EntryList list;
+    if (list_entries(cache, &list) != UCRA_SUCCESS) return;
+    cache->total_bytes = list.total;
+    qsort(list.entries, list.count, sizeof(CacheEntry), compare_age);
+    for (uint32_t i = 0; i < list.count && cache->total_bytes > cache->max_bytes; ++i) {
+        if (strcmp(list.entries[i].name, keep) == 0) continue;
+        char* path = entry_path(cache, list.entries[i].name);
+        /* a file that cannot be removed (or already was) no longer counts either way */
+        if (path) remove(path);
+        free(path);
+        cache->total_bytes -= list.entries[i].size;
+    }
+    free(list.entries);
+}
+
+static uint64_t payload_samples(uint64_t frames, uint32_t channels, uint32_t layout) {
+    return layout == UCRA_RENDER_LAYOUT_MONO ? frames : frames * channels;
+}
+
+/* Map the entry for key into cache->hit and fill result from it */
+static int load_entry(UCRA_RenderCache* cache, const char* path, const uint64_t key[2],
+                      UCRA_RenderResult* result) {
+    if (ucra_file_map(path, &cache->hit) != UCRA_SUCCESS) return 0;
+    RenderCacheHeader header;
+    int valid = cache->hit.size >= sizeof(header);
+    if (valid) {
+        memcpy(&header, cache->hit.data, sizeof(header));
+        uint64_t samples = payload_samples(header.frames, header.channels, header.layout);
+        valid = memcmp(header.magic, RENDER_CACHE_MAGIC, sizeof(RENDER_CACHE_MAGIC)) == 0 &&
+                header.version == RENDER_CACHE_VERSION &&
+                header.header_size == sizeof(header) &&
+                header.key[0] == key[0] && header.key[1] == key[1] &&
+                samples <= (SIZE_MAX - sizeof(header)) / sizeof(float) &&
+                cache->hit.size == sizeof(header) + samples * sizeof(float);
+    }
+    if (!valid) {
+        ucra_file_unmap(&cache->hit);
+        return 0;
+    }
+    memset(result, 0, sizeof(*result));
+    result->pcm = (const float*)((const char*)cache->hit.data + sizeof(header));
+    result->frames = header.frames;
+    result->channels = header.channels;
+    result->sample_rate = header.sample_rate;
+    result->status = UCRA_SUCCESS;
+    return 1;
+}
+
+/* Write result to path through a temporary file; returns the bytes stored, 0 if it was not */
+static uint64_t store_entry(UCRA_RenderCache* cache, const char* path, const uint64_t key[2],
+                            uint32_t layout, const UCRA_RenderResult* result) {
+    RenderCacheHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, RENDER_CACHE_MAGIC, sizeof(RENDER_CACHE_MAGIC));
+    header.version = RENDER_CACHE_VERSION;
+    header.header_size = sizeof(header);
+    header.key[0] = key[0];
+    header.key[1] = key[1];
+    header.frames = result->frames;
+    header.channels = result->channels;
+    header.sample_rate = result->sample_rate;
+    header.layout = layout;
+
+    uint64_t samples = payload_samples(result->frames, result->channels, layout);
+    uint64_t bytes = sizeof(header) + samples * sizeof(float);
+    if ((samples > 0 && !result->pcm) || (cache->max_bytes && bytes > cache->max_bytes)) {
+        return 0; /* an entry that alone exceeds the bound would only evict everything else */
+    }
+
+    /* Unique per process (time), handle (address) and call (counter), so concurrent writers never share one */
+    size_t path_length = strlen(path);
+    char* temp_path = malloc(path_length + 64);
+    if (!temp_path) return 0;
+    snprintf(temp_path, path_length + 64, "%s.%llx.%llx.%x.tmp", path,
+             (unsigned long long)ucra_time_ns(), (unsigned long long)(uintptr_t)cache,
+             cache->temp_counter++);
+
+    FILE* file = fopen(temp_path, "wb");
+    if (!file) {
+        free(temp_path);
+        return 0;
+    }
+    int ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+             fwrite(result->pcm, sizeof(float), (size_t)samples, file) == samples;
+    ok = fclose(file) == 0 && ok;
+    if (!ok) remove(temp_path);
+    ok = ok && ucra_file_replace(temp_path, path) == UCRA_SUCCESS;
+    free(temp_path);
+    return ok ? bytes : 0;
+}
+
+UCRA_Result ucra_render_cache_open(UCRA_RenderCacheHandle* out_cache, const char* directory, uint64_t max_bytes) {
+    if (!out_cache || !directory || !directory[0]) {
+        return UCRA_ERR_INVALID_ARGUMENT;
+    }
+    *out_cache = NULL;
+    UCRA_Result result = ucra_dir_create(directory);
+    if (result != UCRA_SUCCESS) {
+        return result;
+    }
+
+    UCRA_RenderCache* cache = calloc(1, sizeof(UCRA_RenderCache));
+    size_t size = strlen(directory) + 1;
+    char* copy = malloc(size);
+    if (!cache || !copy) {
+        free(cache);
+        free(copy);
+        return UCRA_ERR_OUT_OF_MEMORY;
+    }
+    memcpy(copy, directory, size);
+    cache->directory = copy;
+    cache->max_bytes = max_bytes;
+
+    EntryList list;
+    result = list_entries(cache, &list);
+    if (result != UCRA_SUCCESS) {
+        ucra_render_cache_close((UCRA_RenderCacheHandle)cache);
+        return result;
+    }
+    cache->total_bytes = list.total;
+    free(list.entries);
+
+    *out_cache = (UCRA_RenderCacheHandle)cache;
+    return UCRA_SUCCESS;
+}
+
+UCRA_Result ucra_render_cached(UCRA_RenderCacheHandle handle,
+                               UCRA_Handle engine,
+                               const UCRA_Manifest* manifest,
+                               const UCRA_RenderConfig* config,
+                               UCRA_RenderResult* outResult,
+                               int* out_hit) {
+    UCRA_RenderCache* cache = (UCRA_RenderCache*)handle;
+    if (out_hit) *out_hit = 0;
+    if (!cache || !engine || !config || !outResult || (config->note_count > 0 && !config->notes)) {
+        return UCRA_ERR_INVALID_ARGUMENT;
+    }
+    ucra_file_unmap(&cache->hit); /* the previous hit's PCM is released */
+
+    uint64_t key[2];
+    UCRA_Result result = compute_key(manifest, config, key);
+    if (result != UCRA_SUCCESS) {
+        return result;
+    }
+    char name[RENDER_CACHE_NAME_LENGTH + 1];
+    key_name(key, name);
+    char* path = entry_path(cache, name);
+    if (!path) {
+        return UCRA_ERR_OUT_OF_MEMORY;
+    }
+
+    if (load_entry(cache, path, key, outResult)) {
+        ucra_file_touch(path); /* now the most recently used */
+        free(path);
+        if (out_hit) *out_hit = 1;
+        return UCRA_SUCCESS;
+    }
+
+    result = ucra_render(engine, config, outResult);
+    if (result == UCRA_SUCCESS) {
+        uint64_t stored = store_entry(cache, path, key, UCRA_RENDER_LAYOUT(config->flags), outResult);
+        cache->total_bytes += stored;
+        if (stored && cache->max_bytes && cache->total_bytes > cache->max_bytes) {
+            evict(cache, name);
+        }
+    }
+    free(path);
+    return result;
+}
+
+void ucra_render_cache_close(UCRA_RenderCacheHandle handle) {
+    if (!handle) return;
+
+    UCRA_RenderCache* cache = (UCRA_RenderCache*)handle;
+    ucra_file_unmap(&cache->hit);
+    free(cache->directory);
+    free(cache);
+}
@@ -0,0 +1,558 @@
+/*
+ * UCRA Render Session
+ * Keeps a deep copy of the last rendered config and its output. Notes are
+ * matched between renders by a hash of their content, so a note that moved
+ * within the array but did not change keeps its audio; the spans of the
+ * notes left over on either side are rendered again with ucra_render_block()
+ * and written over the kept output. That only reproduces a full render on an
+ * engine reporting UCRA_ENGINE_CAP_NOTE_LOCAL; on any other, a render whose
+ * notes are not the kept ones in the same order is a full one.
+ */
+
+#include "ucra/ucra.h"
+#include "ucra_file.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+/* Frames rendered per block call; planar output goes through a scratch of this size */
+#define SESSION_BLOCK_FRAMES 16384u
+
+/* Distinct seed so a note hash never equals a render cache key part */
+#define SESSION_SEED (UCRA_FNV_OFFSET ^ 0x5e5510f0ull)
+
+/* A note by content, for matching old notes to new ones */
+typedef struct SessionNote {
+    uint64_t hash;
+    uint32_t index;
+} SessionNote;
+
+typedef struct UCRA_RenderSession_ {
+    UCRA_Handle engine;
+    double margin_sec;
+    int note_local;             /* the engine reports UCRA_ENGINE_CAP_NOTE_LOCAL */
+    int valid;                  /* config and pcm below belong together */
+
+    /* the last rendered config, with everything it points at in arena */
+    UCRA_RenderConfig config;
+    char* arena;
+    SessionNote* order;         /* its notes sorted by hash */
+
+    float* pcm;
+    size_t pcm_capacity;        /* in samples */
+    uint64_t frames;
+    uint32_t channels;
+    uint32_t sample_rate;
+
+    SessionNote* incoming;      /* the notes of the render in progress */
+    uint32_t incoming_capacity;
+    UCRA_FrameRange* dirty;
+    uint32_t dirty_count;
+    uint32_t dirty_capacity;
+    float* scratch;             /* SESSION_BLOCK_FRAMES planar frames */
+    size_t scratch_capacity;
+} UCRA_RenderSession;
+
+static int grow_array(void** array, uint32_t* capacity, uint32_t count, size_t item) {
+    if (count <= *capacity) return 0;
+    uint32_t grown = *capacity ? *capacity : 16;
+    while (grown < count) grown = grown > UINT32_MAX / 2 ? count : grown * 2;
+    void* resized = realloc(*array, (size_t)grown * item);
+    if (!resized) return -1;
+    *array = resized;
+    *capacity = grown;
+    return 0;
+}
+
+/* ---------------------------------------------------------------------------
+ * Note content
+ * ------------------------------------------------------------------------- */
+
+static uint64_t hash_string(uint64_t h, const char* text) {
+    unsigned char present = text != NULL;
+    h = ucra_fnv1a(h, &present, 1);
+    return text ? ucra_fnv1a(h, text, strlen(text) + 1) : h;
+}
+
+static uint64_t hash_curve(uint64_t h, const float* time_sec, const float* value, uint32_t length, int present) {
+    unsigned char tag = (unsigned char)present;
+    h = ucra_fnv1a(h, &tag, 1);
+    if (!present) return h;
+    h = ucra_fnv1a(h, &length, sizeof(length));
+    if (length == 0) return h;
+    h = ucra_fnv1a(h, time_sec, (size_t)length * sizeof(float));
+    return ucra_fnv1a(h, value, (size_t)length * sizeof(float));
+}
+
+static uint64_t hash_note(const UCRA_NoteSegment* note) {
+    uint64_t h = SESSION_SEED;
+    h = ucra_fnv1a(h, &note->start_sec, sizeof(note->start_sec));
+    h = ucra_fnv1a(h, &note->duration_sec, sizeof(note->duration_sec));
+    h = ucra_fnv1a(h, &note->midi_note, sizeof(note->midi_note));
+    h = ucra_fnv1a(h, &note->velocity, sizeof(note->velocity));
+    h = hash_string(h, note->lyric);
+    const UCRA_F0Curve* f0 = note->f0_override;
+    const UCRA_EnvCurve* env = note->env_override;
+    h = hash_curve(h, f0 ? f0->time_sec : NULL, f0 ? f0->f0_hz : NULL, f0 ? f0->length : 0, f0 != NULL);
+    return hash_curve(h, env ? env->time_sec : NULL, env ? env->value : NULL, env ? env->length : 0, env != NULL);
+}
+
+static int strings_equal(const char* a, const char* b) {
+    return a == b || (a && b && strcmp(a, b) == 0);
+}
+
+static int curves_equal(const float* at, const float* av, uint32_t alen, int apresent,
+                        const float* bt, const float* bv, uint32_t blen, int bpresent) {
+    if (apresent != bpresent) return 0;
+    if (!apresent) return 1;
+    size_t size = (size_t)alen * sizeof(float);
+    return alen == blen && (alen == 0 || (memcmp(at, bt, size) == 0 && memcmp(av, bv, size) == 0));
+}
+
+static int note_same(const UCRA_NoteSegment* a, const UCRA_NoteSegment* b) {
+    const UCRA_F0Curve *af = a->f0_override, *bf = b->f0_override;
+    const UCRA_EnvCurve *ae = a->env_override, *be = b->env_override;
+    return a->start_sec == b->start_sec && a->duration_sec == b->duration_sec &&
+           a->midi_note == b->midi_note && a->velocity == b->velocity &&
+           strings_equal(a->lyric, b->lyric) &&
+           curves_equal(af ? af->time_sec : NULL, af ? af->f0_hz : NULL, af ? af->length : 0, af != NULL,
+                        bf ? bf->time_sec : NULL, bf ? bf->f0_hz : NULL, bf ? bf->length : 0, bf != NULL) &&
+           curves_equal(ae ? ae->time_sec : NULL, ae ? ae->value : NULL, ae ? ae->length : 0, ae != NULL,
+                        be ? be->time_sec : NULL, be ? be->value : NULL, be ? be->length : 0, be != NULL);
+}
+
+static int compare_session_notes(const void* a, const void* b) {
+    const SessionNote* na = (const SessionNote*)a;
+    const SessionNote* nb = (const SessionNote*)b;
+    if (na->hash != nb->hash) return na->hash < nb->hash ? -1 : 1;
+    return (na->index > nb->index) - (na->index < nb->index);
+}
+
+/* Everything but the notes that shapes the output */
+static int settings_equal(const UCRA_RenderConfig* a, const UCRA_RenderConfig* b) {
+    if (a->sample_rate != b->sample_rate || a->channels != b->channels || a->block_size != b->block_size ||
+        a->flags != b->flags) {
+        return 0;
+    }
+    uint32_t a_options = a->options ? a->option_count : 0;
+    uint32_t b_options = b->options ? b->option_count : 0;
+    if (a_options != b_options) return 0;
+    for (uint32_t i = 0; i < a_options; ++i) {
+        if (!strings_equal(a->options[i].key, b->options[i].key) ||
+            !strings_equal(a->options[i].value, b->options[i].value)) {
+            return 0;
+        }
+    }
+    if (!(a->flags & UCRA_RENDER_TYPED_OPTIONS)) return 1;
+    uint32_t a_typed = a->typed_options ? a->typed_option_count : 0;
+    uint32_t b_typed = b->typed_options ? b->typed_option_count : 0;
+    if (a_typed != b_typed) return 0;
+    for (uint32_t i = 0; i < a_typed; ++i) {
+        const UCRA_TypedValue* x = &a->typed_options[i];
+        const UCRA_TypedValue* y = &b->typed_options[i];
+        if (!strings_equal(x->key, y->key) || x->type != y->type || x->number != y->number ||
+            !strings_equal(x->text, y->text)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/* ---------------------------------------------------------------------------
+ * Kept config
+ * ------------------------------------------------------------------------- */
+
+/* Lays out a deep copy in one block: a sizing pass with base NULL, then a copying one */
+typedef struct ArenaCursor {
+    char* base;
+    size_t used;
+} ArenaCursor;
+
+static void* arena_take(ArenaCursor* arena, size_t size) {
+    size_t at = (arena->used + 7) & ~(size_t)7;
+    arena->used = at + size;
+    return arena->base ? arena->base + at : NULL;
+}
+
+static const char* arena_string(ArenaCursor* arena, const char* text) {
+    if (!text) return NULL;
+    size_t size = strlen(text) + 1;
+    char* copy = (char*)arena_take(arena, size);
+    if (copy) memcpy(copy, text, size);
+    return copy;
+}
+
+static const float* arena_floats(ArenaCursor* arena, const float* values, uint32_t count) {
+    float* copy = (float*)arena_take(arena, (size_t)count * sizeof(float));
+    if (copy && count) memcpy(copy, values, (size_t)count * sizeof(float));
+    return copy;
+}
+
+/* Copy config into arena->base (or only size it); returns the copy's config */
+static UCRA_RenderConfig copy_config(ArenaCursor* arena, const UCRA_RenderConfig* config) {
+    UCRA_RenderConfig copy = *config;
+    uint32_t note_count = config->notes ? config->note_count : 0;
+    UCRA_NoteSegment* notes = (UCRA_NoteSegment*)arena_take(arena, (size_t)note_count * sizeof(UCRA_NoteSegment));
+    for (uint32_t i = 0; i < note_count; ++i) {
+        const UCRA_NoteSegment* note = &config->notes[i];
+        const UCRA_F0Curve* f0 = note->f0_override;
+        const UCRA_EnvCurve* env = note->env_override;
+        UCRA_F0Curve* f0_copy = f0 ? (UCRA_F0Curve*)arena_take(arena, sizeof(UCRA_F0Curve)) : NULL;
+        UCRA_EnvCurve* env_copy = env ? (UCRA_EnvCurve*)arena_take(arena, sizeof(UCRA_EnvCurve)) : NULL;
+        const char* lyric = arena_string(arena, note->lyric);
+        const float* f0_time = f0 ? arena_floats(arena, f0->time_sec, f0->length) : NULL;
+        const float* f0_hz = f0 ? arena_floats(arena, f0->f0_hz, f0->length) : NULL;
+        const float* env_time = env ? arena_floats(arena, env->time_sec, env->length) : NULL;
+        const float* env_value = env ? arena_floats(arena, env->value, env->length) : NULL;
+        if (!arena->base) continue;
+        notes[i] = *note;
+        notes[i].lyric = lyric;
+        if (f0) {
+            f0_copy->time_sec = f0_time;
+            f0_copy->f0_hz = f0_hz;
+            f0_copy->length = f0->length;
+        }
+        if (env) {
+            env_copy->time_sec = env_time;
+            env_copy->value = env_value;
+            env_copy->length = env->length;
+        }
+        notes[i].f0_override = f0_copy;
+        notes[i].env_override = env_copy;
+    }
+    copy.notes = notes;
+    copy.note_count = note_count;
+
+    uint32_t option_count = config->options ? config->option_count : 0;
+    UCRA_KeyValue* options = (UCRA_KeyValue*)arena_take(arena, (size_t)option_count * sizeof(UCRA_KeyValue));
+    for (uint32_t i = 0; i < option_count; ++i) {
+        const char* key = arena_string(arena, config->options[i].key);
+        const char* value = arena_string(arena, config->options[i].value);
+        if (arena->base) {
+            options[i].key = key;
+            options[i].value = value;
+        }
+    }
+    copy.options = options;
+    copy.option_count = option_count;
+
+    uint32_t typed_count = (config->flags & UCRA_RENDER_TYPED_OPTIONS) && config->typed_options
+                               ? config->typed_option_count : 0;
+    UCRA_TypedValue* typed = (UCRA_TypedValue*)arena_take(arena, (size_t)typed_count * sizeof(UCRA_TypedValue));
+    for (uint32_t i = 0; i < typed_count; ++i) {
+        const char* key = arena_string(arena, config->typed_options[i].key);
+        const char* text = arena_string(arena, config->typed_options[i].text);
+        if (arena->base) {
+            typed[i] = config->typed_options[i];
+            typed[i].key = key;
+            typed[i].text = text;
+        }
+    }
+    copy.typed_options = typed;
+    copy.typed_option_count = typed_count;
+    return copy;
+}
+
+/* Keep config and the sorted hashes in session->incoming as the last render */
+static UCRA_Result keep_config(UCRA_RenderSession* session, const UCRA_RenderConfig* config) {
+    ArenaCursor sizing = { NULL, 0 };
+    copy_config(&sizing, config);
+    uint32_t note_count = config->notes ? config->note_count : 0;
+    ArenaCursor arena = { (char*)malloc(sizing.used + 8), 0 };
+    SessionNote* order = (SessionNote*)malloc(((size_t)note_count + 1) * sizeof(SessionNote));
+    if (!arena.base || !order) {
+        free(arena.base);
+        free(order);
+        return UCRA_ERR_OUT_OF_MEMORY;
+    }
+    session->config = copy_config(&arena, config);
+    if (note_count) memcpy(order, session->incoming, (size_t)note_count * sizeof(SessionNote));
+    free(session->arena);
+    free(session->order);
+    session->arena = arena.base;
+    session->order = order;
+    return UCRA_SUCCESS;
+}
+
+/* ---------------------------------------------------------------------------
+ * Rendering
+ * ------------------------------------------------------------------------- */
+
+static UCRA_Result add_dirty(UCRA_RenderSession* session, uint64_t start, uint64_t end) {
+    if (end > session->frames) end = session->frames;
+    if (start >= end) return UCRA_SUCCESS;
+    if (grow_array((void**)&session->dirty, &session->dirty_capacity, session->dirty_count + 1,
+                   sizeof(UCRA_FrameRange)) != 0) {
+        return UCRA_ERR_OUT_OF_MEMORY;
+    }
+    UCRA_FrameRange range = { start, end - start };
+    session->dirty[session->dirty_count++] = range;
+    return UCRA_SUCCESS;
+}
+
+/* Frames a note can have changed, one frame wider on each side for rounding */
+static UCRA_Result add_note(UCRA_RenderSession* session, const UCRA_NoteSegment* note) {
+    double sr = (double)session->sample_rate;
+    double begin = (note->start_sec - session->margin_sec) * sr - 1.0;
+    double end = (note->start_sec + note->duration_sec + session->margin_sec) * sr + 1.0;
+    if (!(end > 0.0)) return UCRA_SUCCESS; /* also NaN */
+    uint64_t first = begin > 0.0 ? (uint64_t)floor(begin) : 0;
+    uint64_t last = end < (double)session->frames ? (uint64_t)ceil(end) : session->frames;
+    return add_dirty(session, first, last);
+}
+
+static int compare_ranges(const void* a, const void* b) {
+    const UCRA_FrameRange* ra = (const UCRA_FrameRange*)a;
+    const UCRA_FrameRange* rb = (const UCRA_FrameRange*)b;
+    return (ra->start > rb->start) - (ra->start < rb->start);
+}
+
+/* Sort the dirty ranges and join the ones that touch */
+static void merge_dirty(UCRA_RenderSession* session) {
+    if (session->dirty_count < 2) return;
+    qsort(session->dirty, session->dirty_count, sizeof(UCRA_FrameRange), compare_ranges);
+    uint32_t kept = 0;
+    for (uint32_t i = 1; i < session->dirty_count; ++i) {
+        UCRA_FrameRange* last = &session->dirty[kept];
+        const UCRA_FrameRange* next = &session->dirty[i];
+        if (next->start <= last->start + last->frames) {
+            uint64_t end = next->start + next->frames;
+            if (end > last->start + last->frames) last->frames = end - last->start;
+        } else {
+            session->dirty[++kept] = *next;
+        }
+    }
+    session->dirty_count = kept + 1;
+}
+
+/* Dirty ranges of the notes without an identical note on the other side */
+static UCRA_Result diff_notes(UCRA_RenderSession* session, const UCRA_RenderConfig* config, uint32_t note_count) {
+    const SessionNote* old_notes = session->order;
+    const SessionNote* new_notes = session->incoming;
+    uint32_t old_count = session->config.note_count;
+    uint32_t i = 0, j = 0;
+    UCRA_Result result = UCRA_SUCCESS;
+    while (result == UCRA_SUCCESS && (i < old_count || j < note_count)) {
+        if (j == note_count || (i < old_count && old_notes[i].hash < new_notes[j].hash)) {
+            result = add_note(session, &session->config.notes[old_notes[i++].index]);
+        } else if (i == old_count || new_notes[j].hash < old_notes[i].hash) {
+            result = add_note(session, &config->notes[new_notes[j++].index]);
+        } else {
+            const UCRA_NoteSegment* old_note = &session->config.notes[old_notes[i++].index];
+            const UCRA_NoteSegment* new_note = &config->notes[new_notes[j++].index];
+            if (!note_same(old_note, new_note)) {
+                /* a hash collision: both may differ */
+                result = add_note(session, old_note);
+                if (result == UCRA_SUCCESS) result = add_note(session, new_note);
+            }
+        }
+    }
+    return result;
+}
+
+static UCRA_Result reserve_pcm(UCRA_RenderSession* session, uint64_t samples) {
+    if (samples > SIZE_MAX / sizeof(float)) return UCRA_ERR_OUT_OF_MEMORY;
+    if (samples <= session->pcm_capacity) return UCRA_SUCCESS;
+    float* pcm = (float*)realloc(session->pcm, (size_t)samples * sizeof(float));
+    if (!pcm) return UCRA_ERR_OUT_OF_MEMORY;
+    session->pcm = pcm;
+    session->pcm_capacity = (size_t)samples;
+    return UCRA_SUCCESS;
+}
+
+static UCRA_Result render_all(UCRA_RenderSession* session, const UCRA_RenderConfig* config) {
+    uint64_t frames = 0, samples = 0;
+    UCRA_RenderResult rendered;
+    memset(&rendered, 0, sizeof(rendered));
+    UCRA_Result result = ucra_render_query_size(session->engine, config, &frames, &samples);
+    if (result == UCRA_SUCCESS) {
+        result = reserve_pcm(session, samples);
+        if (result == UCRA_SUCCESS) {
+            result = ucra_render_into(session->engine, config, session->pcm, samples, &rendered);
+        }
+    }
+    if (result == UCRA_ERR_NOT_SUPPORTED) {
+        /* an engine that cannot size a render or render into a buffer: copy its own output */
+        result = ucra_render(session->engine, config, &rendered);
+        samples = UCRA_RENDER_LAYOUT(config->flags) == UCRA_RENDER_LAYOUT_MONO
+                      ? rendered.frames : rendered.frames * rendered.channels;
+        if (result == UCRA_SUCCESS) result = reserve_pcm(session, samples);
+        if (result == UCRA_SUCCESS && samples > 0) {
+            memcpy(session->pcm, rendered.pcm, (size_t)samples * sizeof(float));
+        }
+    }
+    if (result != UCRA_SUCCESS) return result;
+    session->frames = rendered.frames;
+    session->channels = rendered.channels;
+    session->sample_rate = rendered.sample_rate;
+    session->dirty_count = 0;
+    return add_dirty(session, 0, session->frames);
+}
+
+/* Render the dirty ranges of config over the kept output, now frames long */
+static UCRA_Result render_dirty(UCRA_RenderSession* session, const UCRA_RenderConfig* config) {
+    uint32_t layout = UCRA_RENDER_LAYOUT(config->flags);
+    uint32_t channels = session->channels;
+    uint32_t stride = layout == UCRA_RENDER_LAYOUT_INTERLEAVED ? channels : 1;
+    if (layout == UCRA_RENDER_LAYOUT_PLANAR) {
+        size_t needed = (size_t)SESSION_BLOCK_FRAMES * channels;
+        if (needed > session->scratch_capacity) {
+            float* scratch = (float*)realloc(session->scratch, needed * sizeof(float));
+            if (!scratch) return UCRA_ERR_OUT_OF_MEMORY;
+            session->scratch = scratch;
+            session->scratch_capacity = needed;
+        }
+    }
+    for (uint32_t r = 0; r < session->dirty_count; ++r) {
+        uint64_t frame = session->dirty[r].start;
+        uint64_t end = frame + session->dirty[r].frames;
+        while (frame < end) {
+            uint32_t n = end - frame < SESSION_BLOCK_FRAMES ? (uint32_t)(end - frame) : SESSION_BLOCK_FRAMES;
+            if (layout != UCRA_RENDER_LAYOUT_PLANAR) {
+                /* interleaved and mono frames are contiguous, so the block lands in place */
+                UCRA_Result result = ucra_render_block(session->engine, config, frame, n,
+                                                       session->pcm + (size_t)frame * stride);
+                if (result != UCRA_SUCCESS) return result;
+            } else {
+                UCRA_Result result = ucra_render_block(session->engine, config, frame, n, session->scratch);
+                if (result != UCRA_SUCCESS) return result;
+                for (uint32_t c = 0; c < channels; ++c) {
+                    memcpy(session->pcm + (size_t)c * session->frames + frame, session->scratch + (size_t)c * n,
+                           (size_t)n * sizeof(float));
+                }
+            }
+            frame += n;
+        }
+    }
+    return UCRA_SUCCESS;
+}
+
+/* Re-render what changed; UCRA_ERR_NOT_SUPPORTED if only a full render will do */
+/* Whether config's notes are the kept ones at the same indices */
+static int notes_in_place(const UCRA_RenderSession* session, const UCRA_RenderConfig* config,
+                          uint32_t note_count) {
+    if (note_count != session->config.note_count) return 0;
+    for (uint32_t i = 0; i < note_count; ++i) {
+        if (!note_same(&session->config.notes[i], &config->notes[i])) return 0;
+    }
+    return 1;
+}
+
+static UCRA_Result render_changes(UCRA_RenderSession* session, const UCRA_RenderConfig* config,
+                                  uint32_t note_count) {
+    if (!session->note_local) {
+        /* an edit, or notes in another order, can change frames outside those notes */
+        if (!notes_in_place(session, config, note_count)) return UCRA_ERR_NOT_SUPPORTED;
+        session->dirty_count = 0;
+        return UCRA_SUCCESS;
+    }
+    uint64_t frames = 0, samples = 0;
+    UCRA_Result result = ucra_render_query_size(session->engine, config, &frames, &samples);
+    if (result != UCRA_SUCCESS) return result;
+    uint32_t layout = UCRA_RENDER_LAYOUT(config->flags);
+    if (layout == UCRA_RENDER_LAYOUT_PLANAR && frames != session->frames) {
+        return UCRA_ERR_NOT_SUPPORTED; /* every plane would move */
+    }
+
+    uint64_t kept_frames = session->frames;
+    result = reserve_pcm(session, samples);
+    if (result != UCRA_SUCCESS) return result;
+    session->frames = frames;
+    session->dirty_count = 0;
+    result = diff_notes(session, config, note_count);
+    if (result == UCRA_SUCCESS && frames > kept_frames) result = add_dirty(session, kept_frames, frames);
+    if (result != UCRA_SUCCESS) return result;
+    merge_dirty(session);
+    return render_dirty(session, config);
+}
+
+UCRA_Result ucra_render_session_create(UCRA_RenderSessionHandle* out_session, UCRA_Handle engine,
+                                       double margin_sec) {
+    if (out_session) *out_session = NULL;
+    if (!out_session || !engine || !(margin_sec >= 0.0)) {
+        return UCRA_ERR_INVALID_ARGUMENT;
+    }
+    UCRA_RenderSession* session = (UCRA_RenderSession*)calloc(1, sizeof(UCRA_RenderSession));
+    if (!session) {
+        return UCRA_ERR_OUT_OF_MEMORY;
+    }
+    uint32_t caps = 0;
+    session->engine = engine;
+    session->margin_sec = margin_sec;
+    session->note_local = ucra_engine_get_capabilities(engine, &caps) == UCRA_SUCCESS &&
+                          (caps & UCRA_ENGINE_CAP_NOTE_LOCAL);
+    *out_session = session;
+    return UCRA_SUCCESS;
+}
+
+UCRA_Result ucra_render_session_render(UCRA_RenderSessionHandle session, const UCRA_RenderConfig* config,
+                                       UCRA_RenderResult* outResult) {
+    if (outResult) memset(outResult, 0, sizeof(*outResult));
+    if (!session || !config || !outResult || (config->note_count > 0 && !config->notes)) {
+        if (outResult) outResult->status = UCRA_ERR_INVALID_ARGUMENT;
+        return UCRA_ERR_INVALID_ARGUMENT;
+    }
+
+    uint32_t note_count = config->notes ? config->note_count : 0;
+    /* one spare entry keeps the copy in keep_config() valid for an empty list */
+    if (grow_array((void**)&session->incoming, &session->incoming_capacity, note_count + 1,
+                   sizeof(SessionNote)) != 0) {
+        outResult->status = UCRA_ERR_OUT_OF_MEMORY;
+        return UCRA_ERR_OUT_OF_MEMORY;
+    }
+    for (uint32_t i = 0; i < note_count; ++i) {
+        session->incoming[i].hash = hash_note(&config->notes[i]);
+        session->incoming[i].index = i;
+    }
+    qsort(session->incoming, note_count, sizeof(SessionNote), compare_session_notes);
+
+    UCRA_Result result = UCRA_ERR_NOT_SUPPORTED;
+    if (session->valid && settings_equal(&session->config, config)) {
+        result = render_changes(session, config, note_count);
+    }
+    session->valid = 0;
+    if (result == UCRA_ERR_NOT_SUPPORTED) {
+        result = render_all(session, config);
+    }
+    if (result == UCRA_SUCCESS) {
+        result = keep_config(session, config);
+    }
+    if (result != UCRA_SUCCESS) {
+        session->dirty_count = 0;
+        outResult->status = result;
+        return result;
+    }
+    session->valid = 1;
+
+    outResult->pcm = session->frames > 0 ? session->pcm : NULL;
+    outResult->frames = session->frames;
+    outResult->channels = session->channels;
+    outResult->sample_rate = session->sample_rate;
+    outResult->status = UCRA_SUCCESS;
+    return UCRA_SUCCESS;
+}
+
+UCRA_Result ucra_render_session_dirty(UCRA_RenderSessionHandle session, const UCRA_FrameRange** out_ranges,
+                                      uint32_t* out_count) {
+    if (!session || !out_ranges || !out_count) {
+        return UCRA_ERR_INVALID_ARGUMENT;
+    }
+    *out_ranges = session->dirty;
+    *out_count = session->dirty_count;
+    return UCRA_SUCCESS;
+}
+
+void ucra_render_session_invalidate(UCRA_RenderSessionHandle session) {
+    if (session) session->valid = 0;
+}
+
+void ucra_render_session_destroy(UCRA_RenderSessionHandle session) {
+    if (!session) return;
+    free(session->arena);
+    free(session->order);
+    free(session->pcm);
+    free(session->incoming);
+    free(session->dirty);
+    free(session->scratch);
+    free(session);
+}
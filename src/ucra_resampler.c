@@ -0,0 +1,309 @@
+/*
+ * UCRA Resampler
+ * Polyphase windowed-sinc sample-rate conversion. For in_rate:out_rate
+ * reduced to down:up, output frame j sits at input position j * down / up:
+ * its integer part picks the input window and its remainder one of up
+ * precomputed filter phases, so every output sample is one dot product of a
+ * phase with a window of planar history. Phase tables are shared by every
+ * resampler of a ratio and kept for the life of the process.
+ */
+
+#include "ucra/ucra.h"
+#include "ucra_kernels.h"
+#include "ucra_threads.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+/* Taps per phase when not decimating; decimation scales them by down / up */
+#define RESAMPLER_BASE_TAPS 64u
+/* Passband edge as a share of the lower rate's Nyquist band; the 64-tap
+ * transition band ends just short of Nyquist, about 80 dB down */
+#define RESAMPLER_CUTOFF 0.9
+#define RESAMPLER_KAISER_BETA 8.0
+/* Input frames taken into the history per step */
+#define RESAMPLER_CHUNK 2048u
+
+/* Filter phases of one ratio, row p for output positions p / up past an input frame */
+typedef struct UCRA_ResamplerTable {
+    uint32_t up;
+    uint32_t down;
+    uint32_t taps;
+    float* coeffs; /* up rows of taps */
+    struct UCRA_ResamplerTable* next;
+} UCRA_ResamplerTable;
+
+typedef struct UCRA_Resampler_ {
+    const UCRA_ResamplerTable* table;
+    const UCRA_Kernels* kernels;
+    uint32_t channels;
+    uint32_t behind;   /* taps before an output's input frame */
+    uint32_t ahead;    /* taps after it: the latency */
+
+    float* history;    /* channels planes of capacity frames */
+    uint32_t capacity;
+    int64_t base;      /* input frame in history[0] of each plane */
+    uint32_t count;    /* frames held */
+
+    int64_t frame;     /* input frame of the next output */
+    uint32_t phase;    /* and its phase */
+    uint64_t in_total; /* input frames taken since the last reset */
+    uint64_t out_total;
+    int draining;
+} UCRA_Resampler;
+
+static UCRA_Once g_tables_once = UCRA_ONCE_INIT;
+static UCRA_Mutex g_tables_mutex;
+static UCRA_ResamplerTable* g_tables;
+
+static void tables_init(void) {
+    ucra_mutex_init(&g_tables_mutex);
+}
+
+static uint32_t gcd(uint32_t a, uint32_t b) {
+    while (b) {
+        uint32_t t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+/* Zeroth-order modified Bessel function of the first kind, by its power series */
+static double bessel_i0(double x) {
+    double sum = 1.0, term = 1.0, half = x * 0.5;
+    for (int k = 1; k < 50 && term > sum * 1e-17; k++) {
+        term *= (half / k) * (half / k);
+        sum += term;
+    }
+    return sum;
+}
+
+static uint32_t table_taps(uint32_t up, uint32_t down) {
+    if (up == down) return 1;
+    if (down <= up) return RESAMPLER_BASE_TAPS;
+    /* a lower cutoff needs a proportionally longer filter, kept even */
+    uint64_t taps = ((uint64_t)RESAMPLER_BASE_TAPS * down + up - 1) / up;
+    return (uint32_t)((taps + 1) & ~(uint64_t)1);
+}
+
+static UCRA_ResamplerTable* build_table(uint32_t up, uint32_t down) {
+    UCRA_ResamplerTable* table = (UCRA_ResamplerTable*)calloc(1, sizeof(UCRA_ResamplerTable));
+    if (!table) return NULL;
+    uint32_t taps = table_taps(up, down);
+    table->coeffs = (float*)malloc((size_t)up * taps * sizeof(float));
+    if (!table->coeffs) {
+        free(table);
+        return NULL;
+    }
+    table->up = up;
+    table->down = down;
+    table->taps = taps;
+    if (taps == 1) {
+        table->coeffs[0] = 1.0f;
+        return table;
+    }
+
+    /* cutoff in cycles per input frame, below the Nyquist band of the lower rate */
+    double cutoff = 0.5 * RESAMPLER_CUTOFF * (down > up ? (double)up / down : 1.0);
+    double half_span = taps * 0.5;
+    double window_norm = bessel_i0(RESAMPLER_KAISER_BETA);
+    uint32_t behind = taps / 2 - 1;
+    for (uint32_t p = 0; p < up; p++) {
+        float* row = table->coeffs + (size_t)p * taps;
+        double sum = 0.0;
+        for (uint32_t i = 0; i < taps; i++) {
+            /* distance from tap i's input frame to the output position */
+            double d = (double)p / up + behind - i;
+            double x = 2.0 * cutoff * d;
+            double sinc = fabs(x) < 1e-12 ? 1.0 : sin(M_PI * x) / (M_PI * x);
+            double r = d / half_span;
+            double window = fabs(r) >= 1.0 ? 0.0 : bessel_i0(RESAMPLER_KAISER_BETA * sqrt(1.0 - r * r)) / window_norm;
+            double h = 2.0 * cutoff * sinc * window;
+            row[i] = (float)h;
+            sum += h;
+        }
+        /* unity DC gain in every phase, so a constant stays exactly flat */
+        for (uint32_t i = 0; i < taps; i++) row[i] = (float)(row[i] / sum);
+    }
+    return table;
+}
+
+/* The shared table of up:down, built on first use; NULL without memory */
+static const UCRA_ResamplerTable* acquire_table(uint32_t up, uint32_t down) {
+    ucra_once(&g_tables_once, tables_init);
+    ucra_mutex_lock(&g_tables_mutex);
+    UCRA_ResamplerTable* table = g_tables;
+    while (table && (table->up != up || table->down != down)) table = table->next;
+    if (!table) {
+        table = build_table(up, down);
+        if (table) {
+            table->next = g_tables;
+            g_tables = table;
+        }
+    }
+    ucra_mutex_unlock(&g_tables_mutex);
+    return table;
+}
+
+void ucra_resampler_reset(UCRA_ResamplerHandle resampler) {
+    if (!resampler) return;
+    /* the frames before the first input are silence */
+    resampler->base = -(int64_t)resampler->behind;
+    resampler->count = resampler->behind;
+    memset(resampler->history, 0, (size_t)resampler->capacity * resampler->channels * sizeof(float));
+    resampler->frame = 0;
+    resampler->phase = 0;
+    resampler->in_total = 0;
+    resampler->out_total = 0;
+    resampler->draining = 0;
+}
+
+UCRA_Result ucra_resampler_create(UCRA_ResamplerHandle* out_resampler, uint32_t in_rate, uint32_t out_rate,
+                                  uint32_t channels) {
+    if (out_resampler) *out_resampler = NULL;
+    if (!out_resampler || in_rate == 0 || out_rate == 0 || channels == 0 || channels > 0xFFFFu) {
+        return UCRA_ERR_INVALID_ARGUMENT;
+    }
+    uint32_t divisor = gcd(in_rate, out_rate);
+    uint32_t up = out_rate / divisor;
+    uint32_t down = in_rate / divisor;
+    /* the decimation cap keeps table_taps() and the history capacity within 32 bits */
+    if (up > UCRA_RESAMPLER_MAX_PHASES || down > (uint64_t)up * UCRA_RESAMPLER_MAX_DECIMATION) {
+        return UCRA_ERR_NOT_SUPPORTED;
+    }
+    const UCRA_ResamplerTable* table = acquire_table(up, down);
+    if (!table) {
+        return UCRA_ERR_OUT_OF_MEMORY;
+    }
+
+    UCRA_Resampler* resampler = (UCRA_Resampler*)calloc(1, sizeof(UCRA_Resampler));
+    if (!resampler) {
+        return UCRA_ERR_OUT_OF_MEMORY;
+    }
+    resampler->table = table;
+    resampler->kernels = ucra_kernels();
+    resampler->channels = channels;
+    resampler->ahead = table->taps / 2;
+    resampler->behind = table->taps - 1 - resampler->ahead;
+    resampler->capacity = table->taps + RESAMPLER_CHUNK;
+    resampler->history = (float*)malloc((size_t)resampler->capacity * channels * sizeof(float));
+    if (!resampler->history) {
+        free(resampler);
+        return UCRA_ERR_OUT_OF_MEMORY;
+    }
+    ucra_resampler_reset(resampler);
+    *out_resampler = resampler;
+    return UCRA_SUCCESS;
+}
+
+void ucra_resampler_destroy(UCRA_ResamplerHandle resampler) {
+    if (!resampler) return;
+    free(resampler->history);
+    free(resampler);
+}
+
+uint32_t ucra_resampler_latency(UCRA_ResamplerHandle resampler) {
+    return resampler ? resampler->ahead : 0;
+}
+
+uint64_t ucra_resampler_output_frames(UCRA_ResamplerHandle resampler, uint64_t in_frames) {
+    if (!resampler) return 0;
+    /* output frames whose position falls before the end of the input */
+    uint64_t up = resampler->table->up, down = resampler->table->down;
+    return in_frames / down * up + (in_frames % down * up + down - 1) / down;
+}
+
+/* Emit outputs while their windows are held, up to limit of them; returns how many */
+static uint32_t emit(UCRA_Resampler* r, float* out, uint32_t limit) {
+    const UCRA_ResamplerTable* table = r->table;
+    const uint32_t taps = table->taps, channels = r->channels;
+    uint32_t written = 0;
+    while (written < limit && r->frame + r->ahead < r->base + (int64_t)r->count) {
+        const float* row = table->coeffs + (size_t)r->phase * taps;
+        size_t start = (size_t)(r->frame - r->behind - r->base);
+        float* frame_out = out + (size_t)written * channels;
+        for (uint32_t c = 0; c < channels; c++) {
+            frame_out[c] = r->kernels->dot(row, r->history + (size_t)c * r->capacity + start, taps);
+        }
+        written++;
+        r->phase += table->down;
+        r->frame += r->phase / table->up;
+        r->phase %= table->up;
+    }
+    r->out_total += written;
+    return written;
+}
+
+/* Take up to frames frames into the history (in NULL: silence); returns how many fit */
+static uint32_t take(UCRA_Resampler* r, const float* in, uint32_t frames) {
+    const uint32_t channels = r->channels;
+    if (r->count == r->capacity) {
+        /* drop what no later output reads */
+        uint32_t unused = (uint32_t)(r->frame - r->behind - r->base);
+        for (uint32_t c = 0; c < channels; c++) {
+            float* plane = r->history + (size_t)c * r->capacity;
+            memmove(plane, plane + unused, (size_t)(r->count - unused) * sizeof(float));
+        }
+        r->base += unused;
+        r->count -= unused;
+    }
+    uint32_t space = r->capacity - r->count;
+    if (frames > space) frames = space;
+    for (uint32_t c = 0; c < channels; c++) {
+        float* plane = r->history + (size_t)c * r->capacity + r->count;
+        if (!in) {
+            memset(plane, 0, (size_t)frames * sizeof(float));
+        } else if (channels == 1) {
+            memcpy(plane, in, (size_t)frames * sizeof(float));
+        } else {
+            for (uint32_t f = 0; f < frames; f++) plane[f] = in[(size_t)f * channels + c];
+        }
+    }
+    r->count += frames;
+    return frames;
+}
+
+UCRA_Result ucra_resampler_process(UCRA_ResamplerHandle resampler, const float* in, uint32_t in_frames,
+                                   uint32_t* in_used, float* out, uint32_t out_capacity, uint32_t* out_frames) {
+    if (in_used) *in_used = 0;
+    if (out_frames) *out_frames = 0;
+    if (!resampler || !out_frames || (in_frames > 0 && !in) || (out_capacity > 0 && !out) ||
+        resampler->draining) {
+        return UCRA_ERR_INVALID_ARGUMENT;
+    }
+    uint32_t used = 0, written = 0;
+    for (;;) {
+        written += emit(resampler, out + (size_t)written * resampler->channels, out_capacity - written);
+        if (written == out_capacity || used == in_frames) break;
+        used += take(resampler, in + (size_t)used * resampler->channels, in_frames - used);
+    }
+    resampler->in_total += used;
+    if (in_used) *in_used = used;
+    *out_frames = written;
+    return UCRA_SUCCESS;
+}
+
+UCRA_Result ucra_resampler_drain(UCRA_ResamplerHandle resampler, float* out, uint32_t out_capacity,
+                                 uint32_t* out_frames) {
+    if (out_frames) *out_frames = 0;
+    if (!resampler || !out_frames || (out_capacity > 0 && !out)) {
+        return UCRA_ERR_INVALID_ARGUMENT;
+    }
+    resampler->draining = 1;
+    uint64_t remaining = ucra_resampler_output_frames(resampler, resampler->in_total) - resampler->out_total;
+    uint32_t limit = remaining < out_capacity ? (uint32_t)remaining : out_capacity;
+    uint32_t written = 0;
+    for (;;) {
+        written += emit(resampler, out + (size_t)written * resampler->channels, limit - written);
+        if (written == limit) break;
+        take(resampler, NULL, resampler->ahead + 1); /* the silence after the input */
+    }
+    *out_frames = written;
+    return UCRA_SUCCESS;
+}
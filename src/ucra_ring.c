@@ -0,0 +1,147 @@
+/*
+ * UCRA PCM Ring
+ * Indices run freely and wrap at 2^32; their difference is the fill level, so
+ * a full ring and an empty one are told apart without a spare slot.
+ */
+
+#include "ucra_ring.h"
+#include "ucra_threads.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/* Largest capacity whose free-running index difference stays unambiguous */
+#define UCRA_RING_MAX_FRAMES 0x80000000u
+
+UCRA_Result ucra_ring_init(UCRA_Ring* ring, uint32_t min_frames, uint32_t channels) {
+    if (!ring || min_frames == 0 || min_frames > UCRA_RING_MAX_FRAMES || channels == 0) {
+        return UCRA_ERR_INVALID_ARGUMENT;
+    }
+    uint32_t capacity = 1;
+    while (capacity < min_frames) {
+        capacity <<= 1;
+    }
+
+    memset(ring, 0, sizeof(*ring));
+    ring->data = calloc((size_t)capacity * channels, sizeof(float));
+    if (!ring->data) {
+        return UCRA_ERR_OUT_OF_MEMORY;
+    }
+    ring->capacity = capacity;
+    ring->mask = capacity - 1;
+    ring->channels = channels;
+    return UCRA_SUCCESS;
+}
+
+void ucra_ring_free(UCRA_Ring* ring) {
+    if (!ring) return;
+    free(ring->data);
+    ring->data = NULL;
+}
+
+size_t ucra_ring_inline_size(uint32_t capacity, uint32_t channels) {
+    return sizeof(UCRA_Ring) + (size_t)capacity * channels * sizeof(float);
+}
+
+UCRA_Result ucra_ring_init_inline(UCRA_Ring* ring, uint32_t capacity, uint32_t channels) {
+    if (!ring || capacity == 0 || (capacity & (capacity - 1)) != 0 ||
+        capacity > UCRA_RING_MAX_FRAMES || channels == 0) {
+        return UCRA_ERR_INVALID_ARGUMENT;
+    }
+    memset(ring, 0, ucra_ring_inline_size(capacity, channels));
+    ring->capacity = capacity;
+    ring->mask = capacity - 1;
+    ring->channels = channels;
+    return UCRA_SUCCESS;
+}
+
+/* Where the samples are; an inline ring finds them after itself in any mapping */
+static float* ring_data(const UCRA_Ring* ring) {
+    return ring->data ? ring->data : (float*)(void*)(ring + 1);
+}
+
+uint32_t ucra_ring_readable(const UCRA_Ring* ring) {
+    return ucra_atomic_load_acquire(&ring->write_index) - ucra_atomic_load_acquire(&ring->read_index);
+}
+
+uint32_t ucra_ring_writable(const UCRA_Ring* ring) {
+    return ring->capacity - ucra_ring_readable(ring);
+}
+
+uint32_t ucra_ring_write_regions(UCRA_Ring* ring, uint32_t frames,
+                                 float** first, uint32_t* first_frames,
+                                 float** second, uint32_t* second_frames) {
+    uint32_t write_index = ring->write_index; /* only this side stores it */
+    uint32_t space = ring->capacity - (write_index - ucra_atomic_load_acquire(&ring->read_index));
+    if (frames > space) {
+        frames = space;
+    }
+
+    uint32_t start = write_index & ring->mask;
+    uint32_t head = ring->capacity - start;
+    if (head > frames) {
+        head = frames;
+    }
+    *first = ring_data(ring) + (size_t)start * ring->channels;
+    *first_frames = head;
+    *second = ring_data(ring);
+    *second_frames = frames - head;
+    return frames;
+}
+
+void ucra_ring_commit_write(UCRA_Ring* ring, uint32_t frames) {
+    ucra_atomic_store_release(&ring->write_index, ring->write_index + frames);
+}
+
+uint32_t ucra_ring_write(UCRA_Ring* ring, const float* frames_in, uint32_t frames) {
+    float* first;
+    float* second;
+    uint32_t first_frames, second_frames;
+    frames = ucra_ring_write_regions(ring, frames, &first, &first_frames, &second, &second_frames);
+
+    size_t frame_floats = ring->channels;
+    memcpy(first, frames_in, first_frames * frame_floats * sizeof(float));
+    memcpy(second, frames_in + first_frames * frame_floats, second_frames * frame_floats * sizeof(float));
+
+    ucra_ring_commit_write(ring, frames);
+    return frames;
+}
+
+uint32_t ucra_ring_read_regions(const UCRA_Ring* ring, uint32_t frames,
+                                const float** first, uint32_t* first_frames,
+                                const float** second, uint32_t* second_frames) {
+    uint32_t read_index = ring->read_index; /* only this side stores it */
+    uint32_t available = ucra_atomic_load_acquire(&ring->write_index) - read_index;
+    if (frames > available) {
+        frames = available;
+    }
+
+    uint32_t start = read_index & ring->mask;
+    uint32_t head = ring->capacity - start;
+    if (head > frames) {
+        head = frames;
+    }
+    *first = ring_data(ring) + (size_t)start * ring->channels;
+    *first_frames = head;
+    *second = ring_data(ring);
+    *second_frames = frames - head;
+    return frames;
+}
+
+void ucra_ring_commit_read(UCRA_Ring* ring, uint32_t frames) {
+    ucra_atomic_store_release(&ring->read_index, ring->read_index + frames);
+}
+
+uint32_t ucra_ring_read(UCRA_Ring* ring, float* frames_out, uint32_t frames) {
+    const float* first;
+    const float* second;
+    uint32_t first_frames, second_frames;
+    frames = ucra_ring_read_regions(ring, frames, &first, &first_frames, &second, &second_frames);
+
+    size_t frame_floats = ring->channels;
+    memcpy(frames_out, first, first_frames * frame_floats * sizeof(float));
+    memcpy(frames_out + first_frames * frame_floats, second, second_frames * frame_floats * sizeof(float));
+
+    ucra_ring_commit_read(ring, frames);
+    return frames;
+}
@@ -0,0 +1,93 @@
+/*
+ * UCRA PCM Ring (internal)
+ * Wait-free single-producer/single-consumer ring of interleaved float frames.
+ * One thread writes and one thread reads, without locks: each side owns one
+ * index and publishes it with a release store. Capacity is a power of two so
+ * positions wrap with a mask.
+ */
+#ifndef UCRA_RING_H
+#define UCRA_RING_H
+
+#include "ucra/ucra.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct UCRA_Ring {
+    float* data;                   /**< NULL for an inline ring: the samples follow the struct */
+    uint32_t capacity;             /**< Frames; a power of two */
+    uint32_t mask;                 /**< capacity - 1 */
+    uint32_t channels;
+    volatile uint32_t write_index; /**< Frames ever written; owned by the producer */
+    volatile uint32_t read_index;  /**< Frames ever read; owned by the consumer */
+} UCRA_Ring;
+
+/**
+ * @brief Allocate a silent ring holding at least min_frames frames
+ * @return UCRA_SUCCESS, UCRA_ERR_INVALID_ARGUMENT, or UCRA_ERR_OUT_OF_MEMORY
+ */
+UCRA_Result ucra_ring_init(UCRA_Ring* ring, uint32_t min_frames, uint32_t channels);
+void ucra_ring_free(UCRA_Ring* ring);
+
+/** Bytes an inline ring of capacity frames (a power of two) takes, samples included */
+size_t ucra_ring_inline_size(uint32_t capacity, uint32_t channels);
+
+/**
+ * @brief Set up a silent ring in ucra_ring_inline_size() bytes at ring, with the samples after it
+ *
+ * The ring holds no pointer, so it may live in memory shared between
+ * processes and mapped at different addresses; each side uses it in place.
+ * There is nothing to free.
+ *
+ * @return UCRA_SUCCESS, or UCRA_ERR_INVALID_ARGUMENT unless capacity is a power of two
+ */
+UCRA_Result ucra_ring_init_inline(UCRA_Ring* ring, uint32_t capacity, uint32_t channels);
+
+/** Frames the consumer can read now; safe from either side */
+uint32_t ucra_ring_readable(const UCRA_Ring* ring);
+
+/** Frames the producer can write now; safe from either side */
+uint32_t ucra_ring_writable(const UCRA_Ring* ring);
+
+/** Producer: append up to frames frames; returns the number written */
+uint32_t ucra_ring_write(UCRA_Ring* ring, const float* frames_in, uint32_t frames);
+
+/**
+ * @brief Producer: free space for up to frames frames, as at most two contiguous regions
+ *
+ * Lets the producer render in place. Nothing is visible to the consumer until
+ * ucra_ring_commit_write(). Returns first_frames + second_frames.
+ */
+uint32_t ucra_ring_write_regions(UCRA_Ring* ring, uint32_t frames,
+                                 float** first, uint32_t* first_frames,
+                                 float** second, uint32_t* second_frames);
+
+/** Producer: publish frames frames filled through ucra_ring_write_regions() */
+void ucra_ring_commit_write(UCRA_Ring* ring, uint32_t frames);
+
+/** Consumer: take up to frames frames; returns the number read */
+uint32_t ucra_ring_read(UCRA_Ring* ring, float* frames_out, uint32_t frames);
+
+/**
+ * @brief Consumer: up to frames readable frames, as at most two contiguous regions
+ *
+ * Lets the consumer use frames in place. They stay in the ring, and the
+ * producer does not overwrite them, until ucra_ring_commit_read(). Returns
+ * first_frames + second_frames.
+ */
+uint32_t ucra_ring_read_regions(const UCRA_Ring* ring, uint32_t frames,
+                                const float** first, uint32_t* first_frames,
+                                const float** second, uint32_t* second_frames);
+
+/** Consumer: release frames frames obtained through ucra_ring_read_regions() */
+void ucra_ring_commit_read(UCRA_Ring* ring, uint32_t frames);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* UCRA_RING_H */
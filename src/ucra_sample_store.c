@@ -0,0 +1,345 @@
+/*
+ * UCRA Sample Store
+ * One mutex guards two hash tables: mapped files by path, and decoded regions
+ * by (file, first frame, frames). Regions are decoded outside the lock; when
+ * two threads miss the same region at once, the second to finish uses the
+ * first one's copy. Regions sit on a list from most to least recently used,
+ * and the least recently used ones no view holds are freed past the budget.
+ */
+
+#include "ucra_sample_store.h"
+#include "ucra_file.h"
+#include "ucra_threads.h"
+#include "ucra_wav.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define FILE_BUCKETS 256
+#define SEGMENT_BUCKETS 4096
+
+typedef struct SampleFile {
+    struct SampleFile* next;    /* bucket chain */
+    char* path;
+    uint64_t path_hash;
+    uint64_t size;              /* identity of the mapped version */
+    int64_t mtime;
+    UCRA_WavMap wav;
+    uint32_t refs;              /* the table, regions decoded from it, and calls reading it */
+    int listed;                 /* in the table; 0 once a newer version replaced it */
+} SampleFile;
+
+struct UCRA_SampleSegment {
+    struct UCRA_SampleSegment* next;  /* bucket chain */
+    struct UCRA_SampleSegment* newer; /* use order, while cached */
+    struct UCRA_SampleSegment* older;
+    SampleFile* file;
+    uint32_t first;
+    uint32_t frames;
+    float* samples;
+    uint32_t refs;                    /* views */
+    int cached;                       /* in the table and the use order */
+};
+
+static UCRA_Once g_store_once = UCRA_ONCE_INIT;
+static UCRA_Mutex g_store_mutex;
+static SampleFile* g_files[FILE_BUCKETS];
+static UCRA_SampleSegment* g_segments[SEGMENT_BUCKETS];
+static UCRA_SampleSegment* g_newest;
+static UCRA_SampleSegment* g_oldest;
+static uint64_t g_budget;
+static UCRA_SampleStoreStats g_stats;
+
+static void store_init(void) {
+    ucra_mutex_init(&g_store_mutex);
+    g_budget = UCRA_SAMPLE_STORE_DEFAULT_BYTES;
+}
+
+/* The helpers below run with g_store_mutex held */
+
+static void file_release(SampleFile* file) {
+    if (--file->refs > 0) return;
+    ucra_wav_unmap(&file->wav);
+    free(file->path);
+    free(file);
+}
+
+static UCRA_SampleSegment** segment_bucket(const SampleFile* file, uint32_t first, uint32_t frames) {
+    uint64_t h = ucra_fnv1a(UCRA_FNV_OFFSET, &file, sizeof(file));
+    h = ucra_fnv1a(h, &first, sizeof(first));
+    h = ucra_fnv1a(h, &frames, sizeof(frames));
+    return &g_segments[h % SEGMENT_BUCKETS];
+}
+
+static UCRA_SampleSegment* find_segment(const SampleFile* file, uint32_t first, uint32_t frames) {
+    UCRA_SampleSegment* segment = *segment_bucket(file, first, frames);
+    while (segment && (segment->file != file || segment->first != first || segment->frames != frames)) {
+        segment = segment->next;
+    }
+    return segment;
+}
+
+static void order_unlink(UCRA_SampleSegment* segment) {
+    if (segment->newer) segment->newer->older = segment->older;
+    else g_newest = segment->older;
+    if (segment->older) segment->older->newer = segment->newer;
+    else g_oldest = segment->newer;
+    segment->newer = segment->older = NULL;
+}
+
+static void order_push(UCRA_SampleSegment* segment) {
+    segment->older = g_newest;
+    segment->newer = NULL;
+    if (g_newest) g_newest->newer = segment;
+    else g_oldest = segment;
+    g_newest = segment;
+}
+
+static void segment_free(UCRA_SampleSegment* segment) {
+    file_release(segment->file);
+    free(segment->samples);
+    free(segment);
+}
+
+/* Take segment out of the cache; it is freed now, or when its last view is released */
+static void segment_unlist(UCRA_SampleSegment* segment) {
+    UCRA_SampleSegment** link = segment_bucket(segment->file, segment->first, segment->frames);
+    while (*link != segment) link = &(*link)->next;
+    *link = segment->next;
+    order_unlink(segment);
+    segment->cached = 0;
+    g_stats.bytes -= (uint64_t)segment->frames * sizeof(float);
+    if (segment->refs == 0) segment_free(segment);
+}
+
+/* Free the least recently used regions no view holds until the cache fits the budget */
+static void evict(void) {
+    UCRA_SampleSegment* segment = g_oldest;
+    while (segment && g_stats.bytes > g_budget) {
+        UCRA_SampleSegment* newer = segment->newer;
+        if (segment->refs == 0) segment_unlist(segment);
+        segment = newer;
+    }
+}
+
+/* Take file out of the table with its cached regions; views keep what they hold */
+static void file_unlist(SampleFile* file) {
+    SampleFile** link = &g_files[file->path_hash % FILE_BUCKETS];
+    while (*link != file) link = &(*link)->next;
+    *link = file->next;
+    file->listed = 0;
+    g_stats.files--;
+    UCRA_SampleSegment* segment = g_oldest;
+    while (segment) {
+        UCRA_SampleSegment* newer = segment->newer;
+        if (segment->file == file) segment_unlist(segment);
+        segment = newer;
+    }
+    file_release(file);
+}
+
+/* The current version of path, mapped on first use, with a reference for the caller */
+static UCRA_Result file_acquire(const char* path, SampleFile** out_file) {
+    *out_file = NULL;
+    uint64_t size = 0;
+    int64_t mtime = 0;
+    UCRA_Result result = ucra_file_info(path, &size, &mtime);
+    if (result != UCRA_SUCCESS) {
+        return result;
+    }
+    uint64_t hash = ucra_fnv1a(UCRA_FNV_OFFSET, path, strlen(path));
+
+    ucra_once(&g_store_once, store_init);
+    ucra_mutex_lock(&g_store_mutex);
+    SampleFile* file = g_files[hash % FILE_BUCKETS];
+    while (file && (file->path_hash != hash || strcmp(file->path, path) != 0)) file = file->next;
+    if (file && (file->size != size || file->mtime != mtime)) {
+        file_unlist(file); /* edited since it was mapped */
+        file = NULL;
+    }
+    if (!file) {
+        file = (SampleFile*)calloc(1, sizeof(SampleFile));
+        size_t length = strlen(path) + 1;
+        if (file) file->path = (char*)malloc(length);
+        result = file && file->path ? ucra_wav_map(path, &file->wav) : UCRA_ERR_OUT_OF_MEMORY;
+        if (result != UCRA_SUCCESS) {
+            if (file) free(file->path);
+            free(file);
+            ucra_mutex_unlock(&g_store_mutex);
+            return result;
+        }
+        memcpy(file->path, path, length);
+        file->path_hash = hash;
+        file->size = size;
+        file->mtime = mtime;
+        file->refs = 1;
+        file->listed = 1;
+        file->next = g_files[hash % FILE_BUCKETS];
+        g_files[hash % FILE_BUCKETS] = file;
+        g_stats.files++;
+    }
+    file->refs++;
+    ucra_mutex_unlock(&g_store_mutex);
+    *out_file = file;
+    return UCRA_SUCCESS;
+}
+
+static void file_done(SampleFile* file) {
+    ucra_mutex_lock(&g_store_mutex);
+    file_release(file);
+    ucra_mutex_unlock(&g_store_mutex);
+}
+
+UCRA_Result ucra_sample_info(const char* path, uint32_t* out_frames, uint32_t* out_sample_rate) {
+    if (!path || !out_frames || !out_sample_rate) {
+        return UCRA_ERR_INVALID_ARGUMENT;
+    }
+    SampleFile* file = NULL;
+    UCRA_Result result = file_acquire(path, &file);
+    if (result != UCRA_SUCCESS) {
+        return result;
+    }
+    *out_frames = file->wav.frames;
+    *out_sample_rate = file->wav.sample_rate;
+    file_done(file);
+    return UCRA_SUCCESS;
+}
+
+UCRA_Result ucra_sample_get(const char* path, uint32_t first, uint32_t count, UCRA_SampleView* out_view) {
+    if (out_view) memset(out_view, 0, sizeof(*out_view));
+    if (!path || !out_view) {
+        return UCRA_ERR_INVALID_ARGUMENT;
+    }
+    SampleFile* file = NULL;
+    UCRA_Result result = file_acquire(path, &file);
+    if (result != UCRA_SUCCESS) {
+        return result;
+    }
+    uint32_t total = file->wav.frames;
+    if (first > total) first = total;
+    if (count > total - first) count = total - first;
+    out_view->sample_rate = file->wav.sample_rate;
+    if (count == 0) {
+        file_done(file);
+        return UCRA_SUCCESS;
+    }
+
+    ucra_mutex_lock(&g_store_mutex);
+    UCRA_SampleSegment* segment = find_segment(file, first, count);
+    if (segment) {
+        g_stats.hits++;
+    } else {
+        g_stats.misses++;
+        ucra_mutex_unlock(&g_store_mutex);
+
+        /* the file reference keeps the mapping alive while the region is decoded */
+        float* samples = (float*)malloc((size_t)count * sizeof(float));
+        if (samples) ucra_wav_read_region(&file->wav, first, count, samples);
+
+        ucra_mutex_lock(&g_store_mutex);
+        segment = find_segment(file, first, count); /* decoded by another thread meanwhile? */
+        if (!segment) {
+            segment = samples ? (UCRA_SampleSegment*)calloc(1, sizeof(UCRA_SampleSegment)) : NULL;
+            if (!segment) {
+                free(samples);
+                file_release(file);
+                ucra_mutex_unlock(&g_store_mutex);
+                return UCRA_ERR_OUT_OF_MEMORY;
+            }
+            segment->file = file; /* takes over the file reference */
+            segment->first = first;
+            segment->frames = count;
+            segment->samples = samples;
+            segment->refs = 1;
+            uint64_t bytes = (uint64_t)count * sizeof(float);
+            if (file->listed && bytes <= g_budget) {
+                /* a region larger than the whole budget is only lent to this view */
+                UCRA_SampleSegment** bucket = segment_bucket(file, first, count);
+                segment->next = *bucket;
+                *bucket = segment;
+                order_push(segment);
+                segment->cached = 1;
+                g_stats.bytes += bytes;
+                evict();
+            }
+            ucra_mutex_unlock(&g_store_mutex);
+            out_view->samples = segment->samples;
+            out_view->frames = segment->frames;
+            out_view->segment = segment;
+            return UCRA_SUCCESS;
+        }
+        free(samples);
+    }
+    segment->refs++;
+    order_unlink(segment);
+    order_push(segment);
+    file_release(file);
+    ucra_mutex_unlock(&g_store_mutex);
+    out_view->samples = segment->samples;
+    out_view->frames = segment->frames;
+    out_view->segment = segment;
+    return UCRA_SUCCESS;
+}
+
+void ucra_sample_release(UCRA_SampleView* view) {
+    if (!view || !view->segment) {
+        if (view) memset(view, 0, sizeof(*view));
+        return;
+    }
+    UCRA_SampleSegment* segment = view->segment;
+    memset(view, 0, sizeof(*view));
+    ucra_mutex_lock(&g_store_mutex);
+    if (--segment->refs == 0) {
+        if (segment->cached) evict(); /* the budget may have shrunk while it was held */
+        else segment_free(segment);
+    }
+    ucra_mutex_unlock(&g_store_mutex);
+}
+
+void ucra_sample_prefetch(const char* path) {
+    SampleFile* file = NULL;
+    if (!path || file_acquire(path, &file) != UCRA_SUCCESS) {
+        return;
+    }
+    const UCRA_WavMap* wav = &file->wav;
+    size_t offset = (size_t)(wav->data - (const unsigned char*)wav->map.data);
+    size_t frame_bytes = (size_t)wav->channels * (wav->bits / 8);
+    ucra_file_prefetch(&wav->map, offset, (size_t)wav->frames * frame_bytes);
+    file_done(file);
+}
+
+void ucra_sample_store_set_budget(uint64_t max_bytes) {
+    ucra_once(&g_store_once, store_init);
+    ucra_mutex_lock(&g_store_mutex);
+    g_budget = max_bytes;
+    evict();
+    ucra_mutex_unlock(&g_store_mutex);
+}
+
+void ucra_sample_store_clear(void) {
+    ucra_once(&g_store_once, store_init);
+    ucra_mutex_lock(&g_store_mutex);
+    UCRA_SampleSegment* segment = g_oldest;
+    while (segment) {
+        UCRA_SampleSegment* newer = segment->newer;
+        if (segment->refs == 0) segment_unlist(segment);
+        segment = newer;
+    }
+    for (uint32_t b = 0; b < FILE_BUCKETS; b++) {
+        SampleFile* file = g_files[b];
+        while (file) {
+            SampleFile* next = file->next;
+            if (file->refs == 1) file_unlist(file); /* only the table's reference is left */
+            file = next;
+        }
+    }
+    ucra_mutex_unlock(&g_store_mutex);
+}
+
+void ucra_sample_store_stats(UCRA_SampleStoreStats* out_stats) {
+    if (!out_stats) return;
+    ucra_once(&g_store_once, store_init);
+    ucra_mutex_lock(&g_store_mutex);
+    *out_stats = g_stats;
+    ucra_mutex_unlock(&g_store_mutex);
+}
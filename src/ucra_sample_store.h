@@ -0,0 +1,88 @@
+/*
+ * UCRA Sample Store (internal)
+ * Process-wide store of voicebank recordings shared by every render thread.
+ * A WAV is memory-mapped on first use and stays mapped; the regions notes ask
+ * for are decoded to mono float once and kept in a least-recently-used cache
+ * bounded in bytes, so notes drawing on the same recordings read RAM, not disk.
+ *
+ * Views are read-only and point into the cache itself. A view keeps its
+ * region alive until it is released, even past eviction. A file whose size or
+ * modification time changed is mapped and decoded afresh.
+ */
+#ifndef UCRA_SAMPLE_STORE_H
+#define UCRA_SAMPLE_STORE_H
+
+#include "ucra/ucra.h"
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Bytes of decoded samples the store keeps unless ucra_sample_store_set_budget() says otherwise */
+#define UCRA_SAMPLE_STORE_DEFAULT_BYTES (256ull << 20)
+
+/** Frames to the end of the file, for ucra_sample_get() */
+#define UCRA_SAMPLE_TO_END UINT32_MAX
+
+typedef struct UCRA_SampleSegment UCRA_SampleSegment;
+
+/** A decoded region of a recording */
+typedef struct UCRA_SampleView {
+    const float* samples;        /**< frames mono samples in [-1, 1]; NULL if frames is 0 */
+    uint32_t frames;
+    uint32_t sample_rate;
+    UCRA_SampleSegment* segment; /**< the cache entry holding samples */
+} UCRA_SampleView;
+
+/** Counters of the store since the process started */
+typedef struct UCRA_SampleStoreStats {
+    uint64_t hits;      /**< regions served from the cache */
+    uint64_t misses;    /**< regions that had to be decoded */
+    uint64_t bytes;     /**< decoded bytes the cache holds now */
+    uint32_t files;     /**< recordings mapped now */
+} UCRA_SampleStoreStats;
+
+/**
+ * @brief Frames and sample rate of a recording, mapping it on first use
+ * @return UCRA_SUCCESS, UCRA_ERR_INVALID_ARGUMENT, or the error of ucra_wav_map()
+ */
+UCRA_Result ucra_sample_info(const char* path, uint32_t* out_frames, uint32_t* out_sample_rate);
+
+/**
+ * @brief View count frames of path from frame first on, decoded on a miss
+ *
+ * The region is clipped to the file, so it may be shorter than count or
+ * empty. Safe to call from any thread. Release the view with
+ * ucra_sample_release().
+ *
+ * @return UCRA_SUCCESS, UCRA_ERR_INVALID_ARGUMENT, UCRA_ERR_OUT_OF_MEMORY, or
+ *         the error of ucra_wav_map()
+ */
+UCRA_Result ucra_sample_get(const char* path, uint32_t first, uint32_t count, UCRA_SampleView* out_view);
+
+/** Give a view back; a zeroed or already released view is ignored */
+void ucra_sample_release(UCRA_SampleView* view);
+
+/**
+ * @brief Map path and have the OS start reading it in the background
+ *
+ * For a note that will be rendered soon; any error is left to the
+ * ucra_sample_get() that follows.
+ */
+void ucra_sample_prefetch(const char* path);
+
+/** Keep at most max_bytes of decoded samples (0 keeps none beyond the views held) */
+void ucra_sample_store_set_budget(uint64_t max_bytes);
+
+/** Drop every region no view holds and unmap every file none of them came from */
+void ucra_sample_store_clear(void);
+
+void ucra_sample_store_stats(UCRA_SampleStoreStats* out_stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* UCRA_SAMPLE_STORE_H */
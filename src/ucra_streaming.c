@@ -4,147 +4,426 @@
  */
 
 #include "ucra/ucra.h"
+#include "ucra_kernels.h"
+#include "ucra_options.h"
+#include "ucra_ring.h"
+#include "ucra_threads.h"
+#include "ucra_trace.h"
+#ifdef UCRA_HAS_WORLD
+#include "ucra_world_stream.h"
+#endif
 #include <stdlib.h>
 #include <string.h>
-#include <errno.h>
 #include <math.h>
 
-/* Platform-specific threading includes */
-#ifdef _WIN32
-    #include <windows.h>
-    #include <process.h>
-    typedef HANDLE pthread_t;
-    typedef CRITICAL_SECTION pthread_mutex_t;
-    typedef CONDITION_VARIABLE pthread_cond_t;
-    #define PTHREAD_MUTEX_INITIALIZER {}
-    #define PTHREAD_COND_INITIALIZER CONDITION_VARIABLE_INIT
-
-    /* Define M_PI if not available on Windows */
-    #ifndef M_PI
-        #define M_PI 3.14159265358979323846
-    #endif
-#else
-    #include <pthread.h>
+/* Define M_PI if not available on Windows */
+#ifndef M_PI
+    #define M_PI 3.14159265358979323846
 #endif
 
+/* Render-time histogram: four log-spaced buckets per power of two nanoseconds */
+#define UCRA_STREAM_HISTOGRAM_BUCKETS 160
+
+/*
+ * Performance counters. Each field has a single writer, the refill side or the
+ * reading side, which updates it with untorn stores so ucra_stream_get_stats()
+ * can sample it from any thread without locking.
+ */
+typedef struct UCRA_StreamCounters {
+    /* refill side */
+    volatile uint64_t frames_produced;
+    volatile uint64_t callback_count;
+    volatile uint64_t callback_ns;
+    volatile uint64_t blocks_rendered;
+    volatile uint64_t render_ns_total;
+    volatile uint64_t render_ns_min;
+    volatile uint64_t render_ns_max;
+    volatile uint64_t render_histogram[UCRA_STREAM_HISTOGRAM_BUCKETS];
+
+    /* reading side */
+    volatile uint64_t reads;
+    volatile uint64_t underruns;
+    volatile uint64_t fill_min;
+    volatile uint64_t fill_max;
+} UCRA_StreamCounters;
+
 /* Internal stream state structure */
 typedef struct UCRA_StreamState {
     /* Configuration */
     UCRA_RenderConfig config;
     UCRA_PullPCM callback;
     void* user_data;
-
-    /* Ring buffer for PCM data */
-    float* buffer;
-    uint32_t buffer_size_frames;  /* Total buffer size in frames */
-    uint32_t write_pos;           /* Current write position (frames) */
-    uint32_t read_pos;            /* Current read position (frames) */
-    uint32_t available_frames;    /* Number of frames available to read */
-
-    /* Thread synchronization */
-    pthread_mutex_t mutex;
-    pthread_cond_t data_available; /* Signaled when data is available */
+    UCRA_Handle engine;           /* Renders the stream block by block when set */
+    UCRA_RenderConfig pull_config; /* Last configuration the callback provided */
+
+    /* Lock-free ring of rendered PCM; the refill side is its only producer */
+    UCRA_Ring ring;
+    uint32_t low_watermark;       /* Refill once fewer frames than this are buffered */
+    uint32_t high_watermark;      /* Render-ahead fills up to this many frames */
+
+    /* Render-ahead producer; when running, it is the only caller of refill_stream_buffer */
+    int render_ahead;
+    UCRA_Thread producer;
+    uint32_t poll_us;                 /* Producer sleep between watermark checks */
+    volatile uint32_t stop_producer;
+    volatile uint32_t producer_done;  /* Set once the callback ended the stream */
+    volatile uint32_t producer_status; /* UCRA_Result that ended it */
+
+    /* Frames exposed by the last ucra_stream_acquire() and not yet released */
+    uint32_t acquired;
+
+    UCRA_StreamCounters counters;
+
+    /* Scratch sized at open for the largest refill, so rendering never allocates */
+    float* mono_scratch;
+
+    /* Note index of the mock renderer: the notes ordered by start, a cursor at
+     * the first one not yet started and the ones sounding at the stream position.
+     * Rebuilt when the callback provides a new configuration. */
+    uint32_t* note_order;
+    uint32_t* active_notes;
+    uint32_t note_capacity;       /* Entries in both arrays; grows only for a longer note list */
+    uint32_t note_count;          /* Notes in note_order */
+    uint32_t note_cursor;
+    uint32_t active_count;
+    int note_index_stale;
 
     /* State flags */
     int is_initialized;
     int is_closed;
 
-    /* Audio generation state (for mock rendering) */
-    double phase;                 /* Current phase for oscillator */
     uint64_t total_frames_generated; /* Total frames generated */
+
+#ifdef UCRA_HAS_WORLD
+    /* WORLD builds synthesize the stream block by block instead of the mock oscillator */
+    UCRA_WorldStream* world;
+#endif
 } UCRA_StreamState;
 
 /* Forward declarations */
 static UCRA_Result refill_stream_buffer(UCRA_StreamState* state);
+static void producer_main(void* arg);
 
 /* Default buffer size: 4096 frames (about 93ms at 44.1kHz) */
 #define DEFAULT_BUFFER_SIZE_FRAMES 4096
 
-/* Simple sine wave generator for testing/demo purposes */
-static void generate_sine_wave(float* buffer, uint32_t frames, uint32_t channels,
-                                uint32_t sample_rate, double* phase, float frequency) {
-    const double phase_increment = 2.0 * M_PI * frequency / sample_rate;
+/* Most blocks rendered per callback invocation */
+#define MAX_REFILL_BLOCKS 4
+
+/* Stream options read from the config passed to ucra_stream_open(); all in frames
+ * except the render-ahead switch */
+#define UCRA_STREAM_BUFFER_FRAMES_OPTION "stream_buffer_frames"
+#define UCRA_STREAM_PREFILL_FRAMES_OPTION "stream_prefill_frames"
+#define UCRA_STREAM_LOW_WATERMARK_OPTION "stream_low_watermark"
+#define UCRA_STREAM_HIGH_WATERMARK_OPTION "stream_high_watermark"
+#define UCRA_STREAM_RENDER_AHEAD_OPTION "stream_render_ahead"
+
+typedef struct UCRA_StreamOptions {
+    uint32_t buffer_frames;
+    uint32_t prefill_frames;
+    uint32_t low_watermark;
+    uint32_t high_watermark;
+    int render_ahead;
+} UCRA_StreamOptions;
+
+/* Missing or unparsable values keep their defaults; watermarks are clamped to the ring later */
+static void parse_stream_options(const UCRA_RenderConfig* config, UCRA_StreamOptions* out) {
+    uint32_t min_buffer_size = config->block_size * 4;
+    out->buffer_frames = (min_buffer_size > DEFAULT_BUFFER_SIZE_FRAMES) ?
+                         min_buffer_size : DEFAULT_BUFFER_SIZE_FRAMES;
+    out->prefill_frames = UINT32_MAX; /* as much as fits */
+    out->low_watermark = config->block_size * 2;
+    out->high_watermark = UINT32_MAX;
+    out->render_ahead = 0;
+
+    for (uint32_t i = 0; config->options && i < config->option_count; ++i) {
+        const char* key = config->options[i].key;
+        const char* value = config->options[i].value;
+        if (!key || !value) continue;
+        if (strcmp(key, UCRA_STREAM_RENDER_AHEAD_OPTION) == 0) {
+            out->render_ahead = strcmp(value, "1") == 0 || strcmp(value, "true") == 0;
+            continue;
+        }
+        char* end = NULL;
+        unsigned long n = strtoul(value, &end, 10);
+        if (end == value || n > UINT32_MAX) continue;
+        if (strcmp(key, UCRA_STREAM_BUFFER_FRAMES_OPTION) == 0 && n >= config->block_size) {
+            out->buffer_frames = (uint32_t)n;
+        } else if (strcmp(key, UCRA_STREAM_PREFILL_FRAMES_OPTION) == 0) {
+            out->prefill_frames = (uint32_t)n;
+        } else if (strcmp(key, UCRA_STREAM_LOW_WATERMARK_OPTION) == 0) {
+            out->low_watermark = (uint32_t)n;
+        } else if (strcmp(key, UCRA_STREAM_HIGH_WATERMARK_OPTION) == 0) {
+            out->high_watermark = (uint32_t)n;
+        }
+    }
+}
 
-    for (uint32_t frame = 0; frame < frames; frame++) {
-        float sample = (float)(sin(*phase) * 0.1); /* Low volume to prevent ear damage */
+/* Note bounds in frames on the stream timeline, rounded to the nearest frame */
+static int64_t note_start_frame(const UCRA_NoteSegment* note, uint32_t sample_rate) {
+    return (int64_t)floor(note->start_sec * sample_rate + 0.5);
+}
 
-        for (uint32_t ch = 0; ch < channels; ch++) {
-            buffer[frame * channels + ch] = sample;
-        }
+static int64_t note_end_frame(const UCRA_NoteSegment* note, uint32_t sample_rate) {
+    return (int64_t)floor((note->start_sec + note->duration_sec) * sample_rate + 0.5);
+}
 
-        *phase += phase_increment;
-        if (*phase >= 2.0 * M_PI) {
-            *phase -= 2.0 * M_PI;
+/* In-place heap sort of note indices by start time; never allocates */
+static void sift_down(uint32_t* order, const UCRA_NoteSegment* notes, uint32_t root, uint32_t count) {
+    for (;;) {
+        uint32_t child = 2 * root + 1;
+        if (child >= count) return;
+        if (child + 1 < count && notes[order[child + 1]].start_sec > notes[order[child]].start_sec) {
+            child++;
         }
+        if (notes[order[child]].start_sec <= notes[order[root]].start_sec) return;
+        uint32_t tmp = order[root];
+        order[root] = order[child];
+        order[child] = tmp;
+        root = child;
     }
 }
 
-/* Render audio based on note segments from the callback */
-static UCRA_Result render_audio_from_notes(UCRA_StreamState* state,
-                                           const UCRA_RenderConfig* render_config,
-                                           float* output_buffer,
-                                           uint32_t frames_to_render) {
-    /* Clear output buffer first */
-    memset(output_buffer, 0, frames_to_render * state->config.channels * sizeof(float));
+static void sort_notes_by_start(uint32_t* order, const UCRA_NoteSegment* notes, uint32_t count) {
+    int sorted = 1;
+    for (uint32_t i = 1; i < count && sorted; ++i) {
+        sorted = notes[order[i - 1]].start_sec <= notes[order[i]].start_sec;
+    }
+    if (sorted) return; /* hosts usually deliver notes in time order */
 
-    /* If no notes provided, generate silence */
-    if (!render_config->notes || render_config->note_count == 0) {
-        return UCRA_SUCCESS;
+    for (uint32_t i = count / 2; i-- > 0;) {
+        sift_down(order, notes, i, count);
     }
+    for (uint32_t end = count; end-- > 1;) {
+        uint32_t tmp = order[0];
+        order[0] = order[end];
+        order[end] = tmp;
+        sift_down(order, notes, 0, end);
+    }
+}
 
-    /* Simple implementation: render each note as a sine wave and mix them */
-    for (uint32_t note_idx = 0; note_idx < render_config->note_count; note_idx++) {
-        const UCRA_NoteSegment* note = &render_config->notes[note_idx];
+/* Position in the first count entries of a start-sorted order of the first note
+ * starting at or after frame */
+static uint32_t first_note_from(const uint32_t* order, const UCRA_NoteSegment* notes, uint32_t count,
+                                int64_t frame, uint32_t sample_rate) {
+    uint32_t low = 0, high = count;
+    while (low < high) {
+        uint32_t mid = low + (high - low) / 2;
+        if (note_start_frame(&notes[order[mid]], sample_rate) < frame) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
 
-        /* Skip notes that are not active in the current time range */
-        double current_time = (double)state->total_frames_generated / state->config.sample_rate;
-        double block_duration = (double)frames_to_render / state->config.sample_rate;
+/* Index a new note list and seek it to the stream position. This is the only
+ * step that looks at every note; it runs once per configuration change, and
+ * allocates only when the list is longer than any before. */
+static UCRA_Result rebuild_note_index(UCRA_StreamState* state, const UCRA_RenderConfig* render_config) {
+    uint32_t count = render_config->notes ? render_config->note_count : 0;
+    if (count > state->note_capacity) {
+        uint32_t* order = realloc(state->note_order, (size_t)count * sizeof(uint32_t));
+        if (!order) return UCRA_ERR_OUT_OF_MEMORY;
+        state->note_order = order;
+        uint32_t* active = realloc(state->active_notes, (size_t)count * sizeof(uint32_t));
+        if (!active) return UCRA_ERR_OUT_OF_MEMORY;
+        state->active_notes = active;
+        state->note_capacity = count;
+    }
 
-        if (current_time >= note->start_sec + note->duration_sec ||
-            current_time + block_duration <= note->start_sec) {
-            continue; /* Note is not active in this time range */
+    const UCRA_NoteSegment* notes = render_config->notes;
+    uint32_t sample_rate = state->config.sample_rate;
+    int64_t position = (int64_t)state->total_frames_generated;
+    int64_t longest = 0;
+    for (uint32_t i = 0; i < count; ++i) {
+        state->note_order[i] = i;
+        int64_t length = note_end_frame(&notes[i], sample_rate) - note_start_frame(&notes[i], sample_rate);
+        if (length > longest) longest = length;
+    }
+    sort_notes_by_start(state->note_order, notes, count);
+    state->note_count = count;
+
+    /* the cursor waits at the first note starting at or after the position */
+    state->note_cursor = first_note_from(state->note_order, notes, count, position, sample_rate);
+
+    /* of the notes before it, only those starting within the longest note's length can
+     * still sound at the position */
+    state->active_count = 0;
+    for (uint32_t i = first_note_from(state->note_order, notes, state->note_cursor,
+                                      position - longest, sample_rate);
+         i < state->note_cursor; ++i) {
+        uint32_t index = state->note_order[i];
+        if (note_end_frame(&notes[index], sample_rate) > position) {
+            state->active_notes[state->active_count++] = index;
         }
+    }
+    state->note_index_stale = 0;
+    return UCRA_SUCCESS;
+}
 
-        /* Calculate frequency from MIDI note */
-        float frequency = 440.0f; /* Default A4 */
-        if (note->midi_note >= 0) {
-            frequency = 440.0f * powf(2.0f, (note->midi_note - 69) / 12.0f);
+/* Render audio based on note segments from the callback into the two ring
+ * regions returned by ucra_ring_write_regions(); the second may be empty */
+static UCRA_Result render_audio_from_notes(UCRA_StreamState* state,
+                                           const UCRA_RenderConfig* render_config,
+                                           float* first, uint32_t first_frames,
+                                           float* second, uint32_t second_frames) {
+    uint32_t channels = state->config.channels;
+    uint32_t frames_to_render = first_frames + second_frames;
+
+    if (state->engine) {
+        /* the engine continues its render where the stream left off, in the stream's format */
+        UCRA_RenderConfig block_config = *render_config;
+        block_config.sample_rate = state->config.sample_rate;
+        block_config.channels = channels;
+        block_config.flags &= ~(UCRA_RENDER_LAYOUT_MASK | UCRA_RENDER_NOTES_EDITED);
+        UCRA_Result result = ucra_render_block(state->engine, &block_config, state->total_frames_generated,
+                                               first_frames, first);
+        if (result == UCRA_SUCCESS && second_frames > 0) {
+            result = ucra_render_block(state->engine, &block_config,
+                                       state->total_frames_generated + first_frames, second_frames, second);
+        }
+        return result;
+    }
+
+#ifdef UCRA_HAS_WORLD
+    if (state->world) {
+        UCRA_Result result = ucra_world_stream_render(state->world, render_config, first, first_frames);
+        if (result == UCRA_SUCCESS && second_frames > 0) {
+            result = ucra_world_stream_render(state->world, render_config, second, second_frames);
         }
+        return result;
+    }
+#endif
+
+    if (state->note_index_stale) {
+        UCRA_Result index_result = rebuild_note_index(state, render_config);
+        if (index_result != UCRA_SUCCESS) {
+            return index_result;
+        }
+    }
 
-        /* Generate sine wave for this note */
-        float* temp_buffer = malloc(frames_to_render * state->config.channels * sizeof(float));
-        if (temp_buffer) {
-            double temp_phase = state->phase; /* Use a temporary phase for mixing */
-            generate_sine_wave(temp_buffer, frames_to_render, state->config.channels,
-                              state->config.sample_rate, &temp_phase, frequency);
-
-            /* Mix into output buffer with velocity scaling */
-            float volume = note->velocity / 127.0f * 0.3f; /* Scale velocity to reasonable volume */
-            for (uint32_t i = 0; i < frames_to_render * state->config.channels; i++) {
-                output_buffer[i] += temp_buffer[i] * volume;
+    /* Notes starting in this block join the sounding ones */
+    const UCRA_NoteSegment* notes = render_config->notes;
+    uint32_t sample_rate = state->config.sample_rate;
+    int64_t block_start = (int64_t)state->total_frames_generated;
+    int64_t block_end = block_start + frames_to_render;
+    while (state->note_cursor < state->note_count &&
+           note_start_frame(&notes[state->note_order[state->note_cursor]], sample_rate) < block_end) {
+        state->active_notes[state->active_count++] = state->note_order[state->note_cursor++];
+    }
+
+    /* If no notes are sounding, generate silence */
+    if (state->active_count == 0) {
+        memset(first, 0, (size_t)first_frames * channels * sizeof(float));
+        memset(second, 0, (size_t)second_frames * channels * sizeof(float));
+        return UCRA_SUCCESS;
+    }
+
+    /* Mix the sounding notes into the preallocated mono scratch, then fan it out.
+     * Each note covers exactly its own frames of the block, with its phase taken
+     * from its start so it stays continuous across blocks. */
+    float* mono = state->mono_scratch;
+    memset(mono, 0, frames_to_render * sizeof(float));
+
+    const UCRA_Kernels* k = ucra_kernels();
+    uint32_t kept = 0;
+    for (uint32_t i = 0; i < state->active_count; i++) {
+        uint32_t index = state->active_notes[i];
+        const UCRA_NoteSegment* note = &notes[index];
+        int64_t start = note_start_frame(note, sample_rate);
+        int64_t end = note_end_frame(note, sample_rate);
+        int64_t from = start > block_start ? start : block_start;
+        int64_t to = end < block_end ? end : block_end;
+
+        if (to > from) {
+            /* Calculate frequency from MIDI note */
+            double frequency = 440.0; /* Default A4 */
+            if (note->midi_note >= 0) {
+                frequency = 440.0 * pow(2.0, (note->midi_note - 69) / 12.0);
             }
+            double inc = 2.0 * M_PI * frequency / sample_rate;
 
-            free(temp_buffer);
+            /* Low oscillator level to prevent ear damage, scaled by velocity */
+            float volume = note->velocity / 127.0f * 0.3f;
+            k->sine_ramp_mac(mono + (from - block_start), (uint32_t)(to - from),
+                             inc * (double)(from - start), inc, 0.1f * volume);
+        }
+        if (end > block_end) {
+            state->active_notes[kept++] = index; /* still sounding after this block */
         }
     }
+    state->active_count = kept;
+
+    k->fan_out(first, mono, first_frames, channels);
+    k->fan_out(second, mono + first_frames, second_frames, channels);
 
     return UCRA_SUCCESS;
 }
 
-/* Helper function to calculate available space in ring buffer */
-static inline uint32_t get_available_space_frames(UCRA_StreamState* state) {
-    return state->buffer_size_frames - state->available_frames;
+/* Single-writer counter updates; see UCRA_StreamCounters */
+static void counter_add(volatile uint64_t* counter, uint64_t value) {
+    ucra_atomic_store_u64(counter, ucra_atomic_load_u64(counter) + value);
+}
+
+static void counter_min(volatile uint64_t* counter, uint64_t value) {
+    if (value < ucra_atomic_load_u64(counter)) ucra_atomic_store_u64(counter, value);
+}
+
+static void counter_max(volatile uint64_t* counter, uint64_t value) {
+    if (value > ucra_atomic_load_u64(counter)) ucra_atomic_store_u64(counter, value);
 }
 
-/* Helper function to advance ring buffer position */
-static inline uint32_t advance_position(uint32_t pos, uint32_t frames, uint32_t buffer_size) {
-    return (pos + frames) % buffer_size;
+/* Histogram bucket of a duration: exact below 4 ns, then 4 buckets per octave */
+static uint32_t histogram_bucket(uint64_t ns) {
+    if (ns < 4) return (uint32_t)ns;
+    uint32_t octave = 2;
+    while ((ns >> (octave + 1)) != 0) octave++;
+    uint32_t bucket = 4 * (octave - 1) + (uint32_t)((ns >> (octave - 2)) & 3);
+    return bucket < UCRA_STREAM_HISTOGRAM_BUCKETS ? bucket : UCRA_STREAM_HISTOGRAM_BUCKETS - 1;
+}
+
+/* Largest duration that falls into bucket */
+static uint64_t histogram_bucket_limit(uint32_t bucket) {
+    if (bucket < 4) return bucket;
+    uint32_t octave = bucket / 4 + 1;
+    uint64_t step = (uint64_t)1 << (octave - 2);
+    return (4 + bucket % 4) * step + step - 1;
+}
+
+/* Reader-side bookkeeping for one read or acquire */
+static void count_read(UCRA_StreamState* state, uint32_t fill, uint32_t requested, uint32_t delivered) {
+    UCRA_StreamCounters* c = &state->counters;
+    counter_add(&c->reads, 1);
+    if (delivered < requested) counter_add(&c->underruns, 1);
+    counter_min(&c->fill_min, fill);
+    counter_max(&c->fill_max, fill);
+}
+
+static void free_stream_state(UCRA_StreamState* state) {
+#ifdef UCRA_HAS_WORLD
+    ucra_world_stream_destroy(state->world);
+#endif
+    free(state->mono_scratch);
+    free(state->note_order);
+    free(state->active_notes);
+    ucra_ring_free(&state->ring);
+    free(state);
 }
 
 UCRA_Result ucra_stream_open(UCRA_StreamHandle* out_stream,
                              const UCRA_RenderConfig* config,
                              UCRA_PullPCM callback,
                              void* user_data) {
+    return ucra_stream_open_engine(out_stream, NULL, config, callback, user_data);
+}
+
+UCRA_Result ucra_stream_open_engine(UCRA_StreamHandle* out_stream,
+                                    UCRA_Handle engine,
+                                    const UCRA_RenderConfig* config,
+                                    UCRA_PullPCM callback,
+                                    void* user_data) {
     if (!out_stream || !config || !callback) {
         return UCRA_ERR_INVALID_ARGUMENT;
     }
@@ -161,65 +440,71 @@ UCRA_Result ucra_stream_open(UCRA_StreamHandle* out_stream,
     }
 
     /* Copy configuration */
-    memcpy(&state->config, config, sizeof(UCRA_RenderConfig));
+    ucra_config_copy(&state->config, config);
+    state->pull_config = state->config;
     state->callback = callback;
     state->user_data = user_data;
-
-    /* Allocate ring buffer - ensure it's at least 4x the block size for good buffering */
-    uint32_t min_buffer_size = config->block_size * 4;
-    state->buffer_size_frames = (min_buffer_size > DEFAULT_BUFFER_SIZE_FRAMES) ?
-                                min_buffer_size : DEFAULT_BUFFER_SIZE_FRAMES;
-
-    size_t buffer_size_bytes = state->buffer_size_frames * config->channels * sizeof(float);
-    state->buffer = malloc(buffer_size_bytes);
-    if (!state->buffer) {
+    state->engine = engine;
+
+    /* Allocate ring buffer - by default at least 4x the block size for good buffering;
+     * the ring rounds the size up to a power of two */
+    UCRA_StreamOptions options;
+    parse_stream_options(config, &options);
+    UCRA_Result ring_result = ucra_ring_init(&state->ring, options.buffer_frames, config->channels);
+    if (ring_result != UCRA_SUCCESS) {
         free(state);
+        return ring_result;
+    }
+    state->mono_scratch = malloc((size_t)config->block_size * MAX_REFILL_BLOCKS * sizeof(float));
+    if (!state->mono_scratch) {
+        free_stream_state(state);
         return UCRA_ERR_OUT_OF_MEMORY;
     }
 
-    /* Initialize buffer to silence */
-    memset(state->buffer, 0, buffer_size_bytes);
-
-    /* Initialize ring buffer state */
-    state->write_pos = 0;
-    state->read_pos = 0;
-    state->available_frames = 0;
+    /* The producer keeps at least a block of headroom, so the high watermark is reachable */
+    state->high_watermark = options.high_watermark < state->ring.capacity ?
+                            options.high_watermark : state->ring.capacity;
+    state->low_watermark = options.low_watermark < state->high_watermark ?
+                           options.low_watermark : state->high_watermark;
+    state->render_ahead = options.render_ahead;
+    /* Poll at half a block, which the low watermark should comfortably cover */
+    state->poll_us = (uint32_t)((uint64_t)config->block_size * 500000u / config->sample_rate);
+    if (state->poll_us < 500) state->poll_us = 500;
 
     /* Initialize audio generation state */
-    state->phase = 0.0;
     state->total_frames_generated = 0;
-
-    /* Initialize mutex and condition variable */
-    int result = pthread_mutex_init(&state->mutex, NULL);
-    if (result != 0) {
-        free(state->buffer);
-        free(state);
-        return UCRA_ERR_INTERNAL;
+    state->note_index_stale = 1;
+
+#ifdef UCRA_HAS_WORLD
+    if (!engine) {
+        UCRA_Result world_result = ucra_world_stream_create(config->sample_rate, config->block_size,
+                                                            &state->world);
+        if (world_result != UCRA_SUCCESS) {
+            free_stream_state(state);
+            return world_result;
+        }
     }
+#endif
 
-    result = pthread_cond_init(&state->data_available, NULL);
-    if (result != 0) {
-        pthread_mutex_destroy(&state->mutex);
-        free(state->buffer);
-        free(state);
-        return UCRA_ERR_INTERNAL;
-    }
+    state->counters.render_ns_min = UINT64_MAX;
+    state->counters.fill_min = UINT64_MAX;
 
     state->is_initialized = 1;
     state->is_closed = 0;
 
     /* Pre-fill buffer with initial data to reduce latency */
-    pthread_mutex_lock(&state->mutex);
-    for (int i = 0; i < 3; i++) { /* Fill 3 blocks initially */
+    while (ucra_ring_readable(&state->ring) < options.prefill_frames &&
+           ucra_ring_writable(&state->ring) >= state->config.block_size) {
         UCRA_Result prefill_result = refill_stream_buffer(state);
         if (prefill_result != UCRA_SUCCESS) {
             break; /* Stop if callback fails, but don't fail the open */
         }
-        if (get_available_space_frames(state) < state->config.block_size) {
-            break; /* Buffer is getting full */
-        }
     }
-    pthread_mutex_unlock(&state->mutex);
+
+    if (state->render_ahead && ucra_thread_create(&state->producer, producer_main, state) != 0) {
+        free_stream_state(state);
+        return UCRA_ERR_INTERNAL;
+    }
 
     *out_stream = (UCRA_StreamHandle)state;
     return UCRA_SUCCESS;
@@ -229,36 +514,24 @@ void ucra_stream_close(UCRA_StreamHandle stream) {
     if (!stream) return;
 
     UCRA_StreamState* state = (UCRA_StreamState*)stream;
-
-    /* Lock mutex to ensure thread safety */
-    pthread_mutex_lock(&state->mutex);
-
-    /* Mark as closed */
+    if (state->render_ahead) {
+        ucra_atomic_store_release(&state->stop_producer, 1);
+        ucra_thread_join(state->producer);
+    }
     state->is_closed = 1;
-
-    /* Wake up any waiting readers */
-    pthread_cond_broadcast(&state->data_available);
-
-    pthread_mutex_unlock(&state->mutex);
-
-    /* Cleanup resources */
-    pthread_cond_destroy(&state->data_available);
-    pthread_mutex_destroy(&state->mutex);
-
-    free(state->buffer);
-    free(state);
+    free_stream_state(state);
 }
 
 /* Private function to refill the stream buffer by calling the user callback */
 static UCRA_Result refill_stream_buffer(UCRA_StreamState* state) {
-    /* This function should be called with the mutex locked */
+    /* Producer side of the ring: must only run on one thread at a time */
 
     if (state->is_closed) {
         return UCRA_ERR_INTERNAL;
     }
 
     /* Check if we have space for at least one block */
-    uint32_t available_space = get_available_space_frames(state);
+    uint32_t available_space = ucra_ring_writable(&state->ring);
     if (available_space < state->config.block_size) {
         /* Buffer is full, nothing to do */
         return UCRA_SUCCESS;
@@ -267,10 +540,27 @@ static UCRA_Result refill_stream_buffer(UCRA_StreamState* state) {
     /* Prepare render config for callback */
     UCRA_RenderConfig render_config = state->config;
 
-    /* Call user callback to get next render configuration */
+    /* Call user callback to get next render configuration; an unchanged one is
+     * not rebuilt, the stream keeps the previous configuration */
+    UCRA_TRACE_BEGIN(pull);
+    uint64_t callback_start = ucra_time_ns();
     UCRA_Result callback_result = state->callback(state->user_data, &render_config);
-    if (callback_result != UCRA_SUCCESS) {
+    uint64_t render_start = ucra_time_ns();
+    UCRA_TRACE_END(pull, "stream.pull");
+    counter_add(&state->counters.callback_count, 1);
+    counter_add(&state->counters.callback_ns, render_start - callback_start);
+    if (callback_result == UCRA_STREAM_UNCHANGED) {
+        render_config = state->pull_config;
+    } else if (callback_result != UCRA_SUCCESS) {
         return callback_result;
+    } else {
+        /* the same notes again are only re-indexed when the callback says it edited them */
+        if (render_config.notes != state->pull_config.notes ||
+            render_config.note_count != state->pull_config.note_count ||
+            (render_config.flags & UCRA_RENDER_NOTES_EDITED)) {
+            state->note_index_stale = 1;
+        }
+        state->pull_config = render_config;
     }
 
     /* Fill buffer more aggressively - render multiple blocks if space available */
@@ -278,75 +568,70 @@ static UCRA_Result refill_stream_buffer(UCRA_StreamState* state) {
     if (blocks_to_render == 0) {
         blocks_to_render = 1; /* Always render at least one block if we have any space */
     }
-    /* Limit to reasonable number to avoid long blocking */
-    if (blocks_to_render > 4) {
-        blocks_to_render = 4;
+    /* Limit to reasonable number to avoid long blocking; the scratch is sized for this */
+    if (blocks_to_render > MAX_REFILL_BLOCKS) {
+        blocks_to_render = MAX_REFILL_BLOCKS;
     }
 
     uint32_t frames_to_write = blocks_to_render * state->config.block_size;
-    uint32_t channels = state->config.channels;
 
-    /* Ensure we don't overflow the buffer */
-    if (frames_to_write > available_space) {
-        frames_to_write = available_space;
-    }
-
-    /* Allocate temporary buffer for rendering */
-    float* temp_buffer = malloc(frames_to_write * channels * sizeof(float));
-    if (!temp_buffer) {
-        return UCRA_ERR_OUT_OF_MEMORY;
-    }
+    /* Render straight into the ring; the space was checked above and only this side shrinks it */
+    float* first;
+    float* second;
+    uint32_t first_frames, second_frames;
+    frames_to_write = ucra_ring_write_regions(&state->ring, frames_to_write,
+                                              &first, &first_frames, &second, &second_frames);
 
     /* Render audio using the provided configuration */
+    UCRA_TRACE_BEGIN(refill);
     UCRA_Result render_result = render_audio_from_notes(state, &render_config,
-                                                        temp_buffer, frames_to_write);
+                                                        first, first_frames, second, second_frames);
+    UCRA_TRACE_END(refill, "stream.refill");
     if (render_result != UCRA_SUCCESS) {
-        free(temp_buffer);
         return render_result;
     }
 
-    /* Copy rendered data to ring buffer, handling wraparound */
-    uint32_t frames_copied = 0;
-    while (frames_copied < frames_to_write) {
-        uint32_t frames_until_wrap = state->buffer_size_frames - state->write_pos;
-        uint32_t frames_to_copy = frames_to_write - frames_copied;
-
-        if (frames_to_copy > frames_until_wrap) {
-            frames_to_copy = frames_until_wrap;
-        }
-
-        /* Copy data */
-        size_t src_offset = frames_copied * channels;
-        size_t dst_offset = state->write_pos * channels;
-        size_t samples_to_copy = frames_to_copy * channels;
-
-        memcpy(state->buffer + dst_offset, temp_buffer + src_offset,
-               samples_to_copy * sizeof(float));
-
-        /* Update positions */
-        state->write_pos = advance_position(state->write_pos, frames_to_copy, state->buffer_size_frames);
-        frames_copied += frames_to_copy;
-    }
-
-    /* Update buffer state */
-    state->available_frames += frames_to_write;
+    ucra_ring_commit_write(&state->ring, frames_to_write);
     state->total_frames_generated += frames_to_write;
 
-    /* Update phase for continuous audio generation */
-    double phase_increment = 2.0 * M_PI * 440.0 / state->config.sample_rate; /* A4 frequency for now */
-    state->phase += phase_increment * frames_to_write;
-    if (state->phase >= 2.0 * M_PI) {
-        state->phase = fmod(state->phase, 2.0 * M_PI);
-    }
-
-    free(temp_buffer);
-
-    /* Signal that data is available */
-    pthread_cond_signal(&state->data_available);
+    /* Render cost per block, spread evenly over the blocks of this refill */
+    UCRA_StreamCounters* c = &state->counters;
+    uint32_t blocks = (frames_to_write + state->config.block_size - 1) / state->config.block_size;
+    uint64_t render_ns = ucra_time_ns() - render_start;
+    uint64_t block_ns = render_ns / (blocks > 0 ? blocks : 1);
+    counter_add(&c->frames_produced, frames_to_write);
+    counter_add(&c->blocks_rendered, blocks);
+    counter_add(&c->render_ns_total, render_ns);
+    counter_min(&c->render_ns_min, block_ns);
+    counter_max(&c->render_ns_max, block_ns);
+    counter_add(&c->render_histogram[histogram_bucket(block_ns)], blocks);
 
     return UCRA_SUCCESS;
 }
 
+/* Render-ahead thread: tops the ring up to the high watermark whenever it drops
+ * below the low one. It polls rather than waits on a signal so that the reader
+ * never has to touch a lock. */
+static void producer_main(void* arg) {
+    UCRA_StreamState* state = (UCRA_StreamState*)arg;
+    while (!ucra_atomic_load_acquire(&state->stop_producer)) {
+        if (ucra_ring_readable(&state->ring) < state->low_watermark) {
+            while (ucra_ring_readable(&state->ring) < state->high_watermark &&
+                   ucra_ring_writable(&state->ring) >= state->config.block_size &&
+                   !ucra_atomic_load_acquire(&state->stop_producer)) {
+                UCRA_Result result = refill_stream_buffer(state);
+                if (result != UCRA_SUCCESS) {
+                    /* the callback ended the stream; the reader drains what is left */
+                    state->producer_status = (uint32_t)result;
+                    ucra_atomic_store_release(&state->producer_done, 1);
+                    return;
+                }
+            }
+        }
+        ucra_sleep_us(state->poll_us);
+    }
+}
+
 UCRA_Result ucra_stream_read(UCRA_StreamHandle stream,
                              float* out_buffer,
                              uint32_t frame_count,
@@ -362,139 +647,152 @@ UCRA_Result ucra_stream_read(UCRA_StreamHandle stream,
         return UCRA_ERR_INTERNAL;
     }
 
-    pthread_mutex_lock(&state->mutex);
-
     uint32_t frames_copied = 0;
     uint32_t channels = state->config.channels;
+    uint32_t fill = ucra_ring_readable(&state->ring);
+    state->acquired = 0; /* a read consumes any acquired frames */
+
+    /* With render-ahead the reader only copies; an underrun is a short read */
+    if (state->render_ahead) {
+        frames_copied = ucra_ring_read(&state->ring, out_buffer, frame_count);
+        *out_frames_read = frames_copied;
+        count_read(state, fill, frame_count, frames_copied);
+        if (frames_copied == 0 && ucra_atomic_load_acquire(&state->producer_done) &&
+            ucra_ring_readable(&state->ring) == 0) {
+            return (UCRA_Result)state->producer_status;
+        }
+        return UCRA_SUCCESS;
+    }
 
+    /* Reads never wait: the refill below is the ring's only producer, and what
+     * cannot be rendered now is reported as a short read */
     while (frames_copied < frame_count && !state->is_closed) {
         /* If buffer is running low, try to refill it proactively */
-        if (state->available_frames < state->config.block_size * 2) {
+        if (ucra_ring_readable(&state->ring) < state->low_watermark) {
             UCRA_Result refill_result = refill_stream_buffer(state);
             if (refill_result != UCRA_SUCCESS) {
-                pthread_mutex_unlock(&state->mutex);
+                *out_frames_read = frames_copied;
+                count_read(state, fill, frame_count, frames_copied);
                 return refill_result;
             }
         }
 
-        /* If no data available at all, wait for it but with timeout */
-        if (state->available_frames == 0 && !state->is_closed) {
-            /* Try one more refill attempt before waiting */
-            UCRA_Result refill_result = refill_stream_buffer(state);
-            if (refill_result == UCRA_SUCCESS && state->available_frames > 0) {
-                /* Successfully refilled, continue */
-                continue;
-            }
-
-            /* If still no data, break instead of waiting indefinitely */
-            break;
-        }
-
-        /* Copy available data */
-        uint32_t frames_to_copy = frame_count - frames_copied;
-        if (frames_to_copy > state->available_frames) {
-            frames_to_copy = state->available_frames;
-        }
-
-        /* Handle ring buffer wraparound */
-        uint32_t frames_until_wrap = state->buffer_size_frames - state->read_pos;
-        if (frames_to_copy > frames_until_wrap) {
-            frames_to_copy = frames_until_wrap;
+        uint32_t frames_read = ucra_ring_read(&state->ring, out_buffer + (size_t)frames_copied * channels,
+                                              frame_count - frames_copied);
+        if (frames_read == 0) {
+            break; /* Nothing could be rendered */
         }
-
-        /* Copy the data */
-        size_t samples_to_copy = frames_to_copy * channels;
-        size_t src_offset = state->read_pos * channels;
-        size_t dst_offset = frames_copied * channels;
-
-        memcpy(out_buffer + dst_offset, state->buffer + src_offset,
-               samples_to_copy * sizeof(float));
-
-        /* Update buffer state */
-        state->read_pos = advance_position(state->read_pos, frames_to_copy, state->buffer_size_frames);
-        state->available_frames -= frames_to_copy;
-        frames_copied += frames_to_copy;
+        frames_copied += frames_read;
     }
 
-    pthread_mutex_unlock(&state->mutex);
-
     *out_frames_read = frames_copied;
+    count_read(state, fill, frame_count, frames_copied);
     return UCRA_SUCCESS;
 }
 
-#ifdef _WIN32
-/* Windows pthread compatibility layer */
-static int pthread_mutex_init(pthread_mutex_t* mutex, void* attr) {
-    (void)attr;
-    InitializeCriticalSection(mutex);
-    return 0;
-}
-
-static int pthread_mutex_destroy(pthread_mutex_t* mutex) {
-    DeleteCriticalSection(mutex);
-    return 0;
-}
-
-static int pthread_mutex_lock(pthread_mutex_t* mutex) {
-    EnterCriticalSection(mutex);
-    return 0;
-}
-
-static int pthread_mutex_unlock(pthread_mutex_t* mutex) {
-    LeaveCriticalSection(mutex);
-    return 0;
-}
+UCRA_Result ucra_stream_acquire(UCRA_StreamHandle stream,
+                                uint32_t max_frames,
+                                const float** out_first,
+                                uint32_t* out_first_frames,
+                                const float** out_second,
+                                uint32_t* out_second_frames) {
+    if (!stream || !out_first || !out_first_frames || !out_second || !out_second_frames) {
+        return UCRA_ERR_INVALID_ARGUMENT;
+    }
 
-static int pthread_cond_init(pthread_cond_t* cond, void* attr) {
-    (void)attr;
-    InitializeConditionVariable(cond);
-    return 0;
-}
+    UCRA_StreamState* state = (UCRA_StreamState*)stream;
+    *out_first = *out_second = NULL;
+    *out_first_frames = *out_second_frames = 0;
 
-static int pthread_cond_destroy(pthread_cond_t* cond) {
-    (void)cond; /* No cleanup needed for Windows condition variables */
-    return 0;
-}
+    if (!state->is_initialized || state->is_closed) {
+        return UCRA_ERR_INTERNAL;
+    }
 
-static int pthread_cond_signal(pthread_cond_t* cond) {
-    WakeConditionVariable(cond);
-    return 0;
-}
+    uint32_t fill = ucra_ring_readable(&state->ring);
+    if (state->render_ahead) {
+        /* producer_done is published after its last frame, so check the ring again after it */
+        if (ucra_ring_readable(&state->ring) == 0 && ucra_atomic_load_acquire(&state->producer_done) &&
+            ucra_ring_readable(&state->ring) == 0) {
+            return (UCRA_Result)state->producer_status;
+        }
+    } else {
+        /* Same as a read: render what fits now, never wait; the buffered frames
+         * are handed out even when the callback just ended the stream */
+        while (ucra_ring_readable(&state->ring) < max_frames &&
+               ucra_ring_writable(&state->ring) >= state->config.block_size) {
+            UCRA_Result refill_result = refill_stream_buffer(state);
+            if (refill_result != UCRA_SUCCESS) {
+                if (ucra_ring_readable(&state->ring) == 0) {
+                    count_read(state, fill, max_frames, 0);
+                    return refill_result;
+                }
+                break;
+            }
+        }
+    }
 
-static int pthread_cond_broadcast(pthread_cond_t* cond) {
-    WakeAllConditionVariable(cond);
-    return 0;
+    state->acquired = ucra_ring_read_regions(&state->ring, max_frames, out_first, out_first_frames,
+                                             out_second, out_second_frames);
+    if (*out_second_frames == 0) *out_second = NULL;
+    if (*out_first_frames == 0) *out_first = NULL;
+    count_read(state, fill, max_frames, state->acquired);
+    return UCRA_SUCCESS;
 }
 
-static int pthread_cond_wait(pthread_cond_t* cond, pthread_mutex_t* mutex) {
-    SleepConditionVariableCS(cond, mutex, INFINITE);
-    return 0;
-}
+UCRA_Result ucra_stream_release(UCRA_StreamHandle stream, uint32_t frame_count) {
+    if (!stream) {
+        return UCRA_ERR_INVALID_ARGUMENT;
+    }
 
-static unsigned int __stdcall thread_proc_wrapper(void* arg) {
-    void* (*start_routine)(void*) = ((void**)arg)[0];
-    void* thread_arg = ((void**)arg)[1];
-    free(arg);
-    start_routine(thread_arg);
-    return 0;
+    UCRA_StreamState* state = (UCRA_StreamState*)stream;
+    if (frame_count > state->acquired) {
+        return UCRA_ERR_INVALID_ARGUMENT;
+    }
+    ucra_ring_commit_read(&state->ring, frame_count);
+    state->acquired = 0;
+    return UCRA_SUCCESS;
 }
 
-static int pthread_create(pthread_t* thread, void* attr, void* (*start_routine)(void*), void* arg) {
-    (void)attr;
-    void** wrapper_args = malloc(2 * sizeof(void*));
-    if (!wrapper_args) return ENOMEM;
-
-    wrapper_args[0] = (void*)start_routine;
-    wrapper_args[1] = arg;
-
-    *thread = (HANDLE)_beginthreadex(NULL, 0, thread_proc_wrapper, wrapper_args, 0, NULL);
-    return *thread ? 0 : EAGAIN;
-}
+UCRA_Result ucra_stream_get_stats(UCRA_StreamHandle stream, UCRA_StreamStats* out_stats) {
+    if (!stream || !out_stats) {
+        return UCRA_ERR_INVALID_ARGUMENT;
+    }
 
-static int pthread_join(pthread_t thread, void** retval) {
-    (void)retval;
-    WaitForSingleObject(thread, INFINITE);
-    CloseHandle(thread);
-    return 0;
+    const UCRA_StreamCounters* c = &((UCRA_StreamState*)stream)->counters;
+    memset(out_stats, 0, sizeof(*out_stats));
+    out_stats->frames_produced = ucra_atomic_load_u64(&c->frames_produced);
+    out_stats->reads = ucra_atomic_load_u64(&c->reads);
+    out_stats->underruns = ucra_atomic_load_u64(&c->underruns);
+    if (out_stats->reads > 0) {
+        out_stats->fill_min = (uint32_t)ucra_atomic_load_u64(&c->fill_min);
+        out_stats->fill_max = (uint32_t)ucra_atomic_load_u64(&c->fill_max);
+    }
+    out_stats->callback_count = ucra_atomic_load_u64(&c->callback_count);
+    out_stats->callback_ns = ucra_atomic_load_u64(&c->callback_ns);
+
+    /* The fields are sampled one by one, so while rendering goes on they may be a block apart */
+    uint64_t histogram[UCRA_STREAM_HISTOGRAM_BUCKETS];
+    uint64_t timed = 0;
+    for (uint32_t i = 0; i < UCRA_STREAM_HISTOGRAM_BUCKETS; ++i) {
+        histogram[i] = ucra_atomic_load_u64(&c->render_histogram[i]);
+        timed += histogram[i];
+    }
+    out_stats->blocks_rendered = ucra_atomic_load_u64(&c->blocks_rendered);
+    if (timed > 0) {
+        out_stats->render_ns_min = ucra_atomic_load_u64(&c->render_ns_min);
+        out_stats->render_ns_max = ucra_atomic_load_u64(&c->render_ns_max);
+        out_stats->render_ns_avg = ucra_atomic_load_u64(&c->render_ns_total) / timed;
+
+        /* p99 is the upper edge of the bucket holding the 99th percentile, capped by the max */
+        uint64_t rank = timed - timed / 100, seen = 0;
+        for (uint32_t i = 0; i < UCRA_STREAM_HISTOGRAM_BUCKETS; ++i) {
+            seen += histogram[i];
+            if (seen >= rank) {
+                uint64_t limit = histogram_bucket_limit(i);
+                out_stats->render_ns_p99 = limit < out_stats->render_ns_max ? limit : out_stats->render_ns_max;
+                break;
+            }
+        }
+    }
+    return UCRA_SUCCESS;
 }
-#endif
@@ -0,0 +1,379 @@
+/*
+ * UCRA Threading
+ * Portable threading primitives and a work-stealing fork/join worker pool.
+ */
+
+#include "ucra_threads.h"
+
+#include <stdlib.h>
+
+#ifdef _WIN32
+    #include <process.h>
+#else
+    #include <sched.h>
+    #include <time.h>
+    #include <unistd.h>
+#endif
+
+/* ---------------------------------------------------------------------------
+ * Primitives
+ * ------------------------------------------------------------------------- */
+
+#ifdef _WIN32
+
+int ucra_mutex_init(UCRA_Mutex* mutex) { InitializeCriticalSection(mutex); return 0; }
+void ucra_mutex_destroy(UCRA_Mutex* mutex) { DeleteCriticalSection(mutex); }
+void ucra_mutex_lock(UCRA_Mutex* mutex) { EnterCriticalSection(mutex); }
+void ucra_mutex_unlock(UCRA_Mutex* mutex) { LeaveCriticalSection(mutex); }
+
+int ucra_cond_init(UCRA_Cond* cond) { InitializeConditionVariable(cond); return 0; }
+void ucra_cond_destroy(UCRA_Cond* cond) { (void)cond; /* nothing to release */ }
+void ucra_cond_wait(UCRA_Cond* cond, UCRA_Mutex* mutex) { SleepConditionVariableCS(cond, mutex, INFINITE); }
+void ucra_cond_signal(UCRA_Cond* cond) { WakeConditionVariable(cond); }
+void ucra_cond_broadcast(UCRA_Cond* cond) { WakeAllConditionVariable(cond); }
+
+typedef struct UCRA_OnceFn {
+    void (*fn)(void);
+} UCRA_OnceFn;
+
+static BOOL CALLBACK once_trampoline(PINIT_ONCE once, PVOID param, PVOID* context) {
+    (void)once;
+    (void)context;
+    ((UCRA_OnceFn*)param)->fn();
+    return TRUE;
+}
+
+void ucra_once(UCRA_Once* once, void (*fn)(void)) {
+    UCRA_OnceFn call = { fn };
+    InitOnceExecuteOnce(once, once_trampoline, &call, NULL);
+}
+
+typedef struct UCRA_ThreadStart {
+    void (*fn)(void*);
+    void* arg;
+} UCRA_ThreadStart;
+
+static unsigned int __stdcall thread_trampoline(void* arg) {
+    UCRA_ThreadStart start = *(UCRA_ThreadStart*)arg;
+    free(arg);
+    start.fn(start.arg);
+    return 0;
+}
+
+int ucra_thread_create(UCRA_Thread* thread, void (*fn)(void*), void* arg) {
+    UCRA_ThreadStart* start = (UCRA_ThreadStart*)malloc(sizeof(UCRA_ThreadStart));
+    if (!start) return -1;
+    start->fn = fn;
+    start->arg = arg;
+    *thread = (HANDLE)_beginthreadex(NULL, 0, thread_trampoline, start, 0, NULL);
+    if (!*thread) {
+        free(start);
+        return -1;
+    }
+    return 0;
+}
+
+void ucra_thread_join(UCRA_Thread thread) {
+    WaitForSingleObject(thread, INFINITE);
+    CloseHandle(thread);
+}
+
+void ucra_thread_yield(void) { SwitchToThread(); }
+
+void ucra_sleep_us(uint32_t microseconds) { Sleep((microseconds + 999) / 1000); }
+
+uint64_t ucra_time_ns(void) {
+    LARGE_INTEGER frequency, counter;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    return (uint64_t)((double)counter.QuadPart * 1e9 / (double)frequency.QuadPart);
+}
+
+uint32_t ucra_cpu_count(void) {
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors > 0 ? (uint32_t)info.dwNumberOfProcessors : 1;
+}
+
+#else /* pthreads */
+
+int ucra_mutex_init(UCRA_Mutex* mutex) { return pthread_mutex_init(mutex, NULL); }
+void ucra_mutex_destroy(UCRA_Mutex* mutex) { pthread_mutex_destroy(mutex); }
+void ucra_mutex_lock(UCRA_Mutex* mutex) { pthread_mutex_lock(mutex); }
+void ucra_mutex_unlock(UCRA_Mutex* mutex) { pthread_mutex_unlock(mutex); }
+
+int ucra_cond_init(UCRA_Cond* cond) { return pthread_cond_init(cond, NULL); }
+void ucra_cond_destroy(UCRA_Cond* cond) { pthread_cond_destroy(cond); }
+void ucra_cond_wait(UCRA_Cond* cond, UCRA_Mutex* mutex) { pthread_cond_wait(cond, mutex); }
+void ucra_cond_signal(UCRA_Cond* cond) { pthread_cond_signal(cond); }
+void ucra_cond_broadcast(UCRA_Cond* cond) { pthread_cond_broadcast(cond); }
+
+void ucra_once(UCRA_Once* once, void (*fn)(void)) { pthread_once(once, fn); }
+
+typedef struct UCRA_ThreadStart {
+    void (*fn)(void*);
+    void* arg;
+} UCRA_ThreadStart;
+
+static void* thread_trampoline(void* arg) {
+    UCRA_ThreadStart start = *(UCRA_ThreadStart*)arg;
+    free(arg);
+    start.fn(start.arg);
+    return NULL;
+}
+
+int ucra_thread_create(UCRA_Thread* thread, void (*fn)(void*), void* arg) {
+    UCRA_ThreadStart* start = (UCRA_ThreadStart*)malloc(sizeof(UCRA_ThreadStart));
+    if (!start) return -1;
+    start->fn = fn;
+    start->arg = arg;
+    if (pthread_create(thread, NULL, thread_trampoline, start) != 0) {
+        free(start);
+        return -1;
+    }
+    return 0;
+}
+
+void ucra_thread_join(UCRA_Thread thread) {
+    pthread_join(thread, NULL);
+}
+
+void ucra_thread_yield(void) { sched_yield(); }
+
+void ucra_sleep_us(uint32_t microseconds) {
+    struct timespec ts;
+    ts.tv_sec = microseconds / 1000000u;
+    ts.tv_nsec = (long)(microseconds % 1000000u) * 1000L;
+    nanosleep(&ts, NULL);
+}
+
+uint64_t ucra_time_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+uint32_t ucra_cpu_count(void) {
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (uint32_t)n : 1;
+}
+
+#endif
+
+/* ---------------------------------------------------------------------------
+ * Worker pool
+ * ------------------------------------------------------------------------- */
+
+/* Jobs are handed out as index ranges. Each worker pops from the front of its own
+ * range and, once that is empty, steals the back half of another worker's range. */
+typedef struct UCRA_PoolQueue {
+    UCRA_Mutex lock;
+    uint32_t begin;
+    uint32_t end;
+} UCRA_PoolQueue;
+
+typedef struct UCRA_PoolWorker {
+    struct UCRA_ThreadPool* pool;
+    uint32_t index;
+    UCRA_Thread thread;
+} UCRA_PoolWorker;
+
+struct UCRA_ThreadPool {
+    uint32_t size;              /* workers including the caller */
+    UCRA_PoolWorker* workers;   /* size - 1 background workers */
+    uint32_t started;           /* background workers actually running */
+    UCRA_PoolQueue* queues;     /* one per worker slot, index 0 is the caller */
+    uint32_t queue_count;
+
+    UCRA_Mutex mutex;
+    UCRA_Cond work_ready;
+    UCRA_Cond work_done;
+    uint64_t generation;        /* bumped for every ucra_pool_run() */
+    int shutdown;
+
+    /* current run; set under mutex before the generation changes */
+    UCRA_JobFn fn;
+    void* ctx;
+    uint32_t pending_workers;   /* background workers not yet done with this run */
+};
+
+static int queue_pop(UCRA_PoolQueue* q, uint32_t* job) {
+    int found = 0;
+    ucra_mutex_lock(&q->lock);
+    if (q->begin < q->end) {
+        *job = q->begin++;
+        found = 1;
+    }
+    ucra_mutex_unlock(&q->lock);
+    return found;
+}
+
+/* move the back half of some other worker's range into our own queue */
+static int queue_steal(UCRA_ThreadPool* pool, uint32_t worker) {
+    for (uint32_t n = 1; n < pool->size; ++n) {
+        UCRA_PoolQueue* victim = &pool->queues[(worker + n) % pool->size];
+        uint32_t begin = 0, end = 0;
+        ucra_mutex_lock(&victim->lock);
+        if (victim->begin < victim->end) {
+            uint32_t remaining = victim->end - victim->begin;
+            begin = victim->end - (remaining + 1) / 2;
+            end = victim->end;
+            victim->end = begin;
+        }
+        ucra_mutex_unlock(&victim->lock);
+        if (begin < end) {
+            UCRA_PoolQueue* own = &pool->queues[worker];
+            ucra_mutex_lock(&own->lock);
+            own->begin = begin;
+            own->end = end;
+            ucra_mutex_unlock(&own->lock);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/* run jobs of the current run until no worker has any left; jobs never spawn
+ * jobs, so an empty sweep over all queues means the run is fully claimed */
+static void pool_drain(UCRA_ThreadPool* pool, uint32_t worker) {
+    uint32_t job;
+    for (;;) {
+        while (queue_pop(&pool->queues[worker], &job)) {
+            pool->fn(pool->ctx, job, worker);
+        }
+        if (!queue_steal(pool, worker)) return;
+    }
+}
+
+static void pool_worker_main(void* arg) {
+    UCRA_PoolWorker* self = (UCRA_PoolWorker*)arg;
+    UCRA_ThreadPool* pool = self->pool;
+    uint64_t seen = 0;
+
+    ucra_mutex_lock(&pool->mutex);
+    for (;;) {
+        while (!pool->shutdown && pool->generation == seen) {
+            ucra_cond_wait(&pool->work_ready, &pool->mutex);
+        }
+        if (pool->shutdown) break;
+        seen = pool->generation;
+        ucra_mutex_unlock(&pool->mutex);
+
+        pool_drain(pool, self->index);
+
+        ucra_mutex_lock(&pool->mutex);
+        if (--pool->pending_workers == 0) ucra_cond_signal(&pool->work_done);
+    }
+    ucra_mutex_unlock(&pool->mutex);
+}
+
+UCRA_Result ucra_pool_create(uint32_t worker_count, UCRA_ThreadPool** out_pool) {
+    if (!out_pool) return UCRA_ERR_INVALID_ARGUMENT;
+    *out_pool = NULL;
+    if (worker_count == 0) worker_count = ucra_cpu_count();
+
+    UCRA_ThreadPool* pool = (UCRA_ThreadPool*)calloc(1, sizeof(UCRA_ThreadPool));
+    if (!pool) return UCRA_ERR_OUT_OF_MEMORY;
+    if (worker_count > 1) {
+        pool->workers = (UCRA_PoolWorker*)calloc(worker_count - 1, sizeof(UCRA_PoolWorker));
+        if (!pool->workers) {
+            free(pool);
+            return UCRA_ERR_OUT_OF_MEMORY;
+        }
+    }
+    pool->queues = (UCRA_PoolQueue*)calloc(worker_count, sizeof(UCRA_PoolQueue));
+    if (!pool->queues) {
+        free(pool->workers);
+        free(pool);
+        return UCRA_ERR_OUT_OF_MEMORY;
+    }
+    for (; pool->queue_count < worker_count; ++pool->queue_count) {
+        if (ucra_mutex_init(&pool->queues[pool->queue_count].lock) != 0) break;
+    }
+    if (pool->queue_count < worker_count || ucra_mutex_init(&pool->mutex) != 0) {
+        for (uint32_t i = 0; i < pool->queue_count; ++i) ucra_mutex_destroy(&pool->queues[i].lock);
+        free(pool->queues);
+        free(pool->workers);
+        free(pool);
+        return UCRA_ERR_INTERNAL;
+    }
+    if (ucra_cond_init(&pool->work_ready) != 0 || ucra_cond_init(&pool->work_done) != 0) {
+        ucra_mutex_destroy(&pool->mutex);
+        for (uint32_t i = 0; i < pool->queue_count; ++i) ucra_mutex_destroy(&pool->queues[i].lock);
+        free(pool->queues);
+        free(pool->workers);
+        free(pool);
+        return UCRA_ERR_INTERNAL;
+    }
+
+    /* if some threads fail to start, run with the ones we have */
+    pool->size = 1;
+    for (uint32_t i = 0; i + 1 < worker_count; ++i) {
+        UCRA_PoolWorker* w = &pool->workers[i];
+        w->pool = pool;
+        w->index = i + 1;
+        if (ucra_thread_create(&w->thread, pool_worker_main, w) != 0) break;
+        pool->started++;
+        pool->size++;
+    }
+
+    *out_pool = pool;
+    return UCRA_SUCCESS;
+}
+
+void ucra_pool_destroy(UCRA_ThreadPool* pool) {
+    if (!pool) return;
+    ucra_mutex_lock(&pool->mutex);
+    pool->shutdown = 1;
+    ucra_cond_broadcast(&pool->work_ready);
+    ucra_mutex_unlock(&pool->mutex);
+    for (uint32_t i = 0; i < pool->started; ++i) {
+        ucra_thread_join(pool->workers[i].thread);
+    }
+    ucra_cond_destroy(&pool->work_done);
+    ucra_cond_destroy(&pool->work_ready);
+    ucra_mutex_destroy(&pool->mutex);
+    for (uint32_t i = 0; i < pool->queue_count; ++i) ucra_mutex_destroy(&pool->queues[i].lock);
+    free(pool->queues);
+    free(pool->workers);
+    free(pool);
+}
+
+uint32_t ucra_pool_size(const UCRA_ThreadPool* pool) {
+    return pool ? pool->size : 1;
+}
+
+void ucra_pool_run(UCRA_ThreadPool* pool, uint32_t job_count, UCRA_JobFn fn, void* ctx) {
+    if (job_count == 0) return;
+    if (!pool || pool->started == 0 || job_count == 1) {
+        for (uint32_t job = 0; job < job_count; ++job) fn(ctx, job, 0);
+        return;
+    }
+
+    /* contiguous slices per worker keep neighbouring jobs on one core; stealing
+     * rebalances when job costs differ */
+    for (uint32_t w = 0; w < pool->size; ++w) {
+        UCRA_PoolQueue* q = &pool->queues[w];
+        ucra_mutex_lock(&q->lock);
+        q->begin = (uint32_t)((uint64_t)job_count * w / pool->size);
+        q->end = (uint32_t)((uint64_t)job_count * (w + 1) / pool->size);
+        ucra_mutex_unlock(&q->lock);
+    }
+
+    ucra_mutex_lock(&pool->mutex);
+    pool->fn = fn;
+    pool->ctx = ctx;
+    pool->pending_workers = pool->started;
+    pool->generation++;
+    ucra_cond_broadcast(&pool->work_ready);
+    ucra_mutex_unlock(&pool->mutex);
+
+    /* the caller works too, then waits for the stragglers */
+    pool_drain(pool, 0);
+
+    ucra_mutex_lock(&pool->mutex);
+    while (pool->pending_workers > 0) {
+        ucra_cond_wait(&pool->work_done, &pool->mutex);
+    }
+    ucra_mutex_unlock(&pool->mutex);
+}
@@ -0,0 +1,138 @@
+/*
+ * UCRA Threading (internal)
+ * Portable mutex/condition/thread wrappers and the worker pool used to spread
+ * render work across cores. Backed by pthreads, or Win32 primitives on Windows.
+ */
+#ifndef UCRA_THREADS_H
+#define UCRA_THREADS_H
+
+#include "ucra/ucra.h"
+
+#include <stdint.h>
+
+#ifdef _WIN32
+    #include <windows.h>
+    typedef CRITICAL_SECTION UCRA_Mutex;
+    typedef CONDITION_VARIABLE UCRA_Cond;
+    typedef HANDLE UCRA_Thread;
+    typedef INIT_ONCE UCRA_Once;
+    #define UCRA_ONCE_INIT INIT_ONCE_STATIC_INIT
+#else
+    #include <pthread.h>
+    typedef pthread_mutex_t UCRA_Mutex;
+    typedef pthread_cond_t UCRA_Cond;
+    typedef pthread_t UCRA_Thread;
+    typedef pthread_once_t UCRA_Once;
+    #define UCRA_ONCE_INIT PTHREAD_ONCE_INIT
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int ucra_mutex_init(UCRA_Mutex* mutex);
+void ucra_mutex_destroy(UCRA_Mutex* mutex);
+void ucra_mutex_lock(UCRA_Mutex* mutex);
+void ucra_mutex_unlock(UCRA_Mutex* mutex);
+
+int ucra_cond_init(UCRA_Cond* cond);
+void ucra_cond_destroy(UCRA_Cond* cond);
+void ucra_cond_wait(UCRA_Cond* cond, UCRA_Mutex* mutex);
+void ucra_cond_signal(UCRA_Cond* cond);
+void ucra_cond_broadcast(UCRA_Cond* cond);
+
+/** Run fn exactly once per once (initialized with UCRA_ONCE_INIT), even when called concurrently */
+void ucra_once(UCRA_Once* once, void (*fn)(void));
+
+/** Start a thread running fn(arg); returns 0 on success */
+int ucra_thread_create(UCRA_Thread* thread, void (*fn)(void*), void* arg);
+void ucra_thread_join(UCRA_Thread thread);
+
+/** Give up the rest of the time slice; for polling loops */
+void ucra_thread_yield(void);
+
+/** Sleep for about the given time (millisecond granularity on Windows) */
+void ucra_sleep_us(uint32_t microseconds);
+
+/** Number of online CPUs (at least 1) */
+uint32_t ucra_cpu_count(void);
+
+/** Monotonic clock in nanoseconds, for measuring intervals */
+uint64_t ucra_time_ns(void);
+
+/*
+ * Acquire load / release store of a 32-bit value shared between threads. A
+ * release store publishes every write made before it to the thread that
+ * acquire-loads the stored value.
+ */
+static inline uint32_t ucra_atomic_load_acquire(const volatile uint32_t* p) {
+#ifdef _MSC_VER
+    return (uint32_t)InterlockedCompareExchange((volatile LONG*)p, 0, 0);
+#else
+    return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+#endif
+}
+
+static inline void ucra_atomic_store_release(volatile uint32_t* p, uint32_t value) {
+#ifdef _MSC_VER
+    InterlockedExchange((volatile LONG*)p, (LONG)value);
+#else
+    __atomic_store_n(p, value, __ATOMIC_RELEASE);
+#endif
+}
+
+/*
+ * Untorn load / store of a 64-bit counter without ordering: for statistics with
+ * a single writer that other threads may read at any time.
+ */
+static inline uint64_t ucra_atomic_load_u64(const volatile uint64_t* p) {
+#ifdef _MSC_VER
+    return (uint64_t)InterlockedCompareExchange64((volatile LONGLONG*)p, 0, 0);
+#else
+    return __atomic_load_n(p, __ATOMIC_RELAXED);
+#endif
+}
+
+static inline void ucra_atomic_store_u64(volatile uint64_t* p, uint64_t value) {
+#ifdef _MSC_VER
+    InterlockedExchange64((volatile LONGLONG*)p, (LONGLONG)value);
+#else
+    __atomic_store_n(p, value, __ATOMIC_RELAXED);
+#endif
+}
+
+/**
+ * @brief Job callback run by the pool
+ * @param ctx Context passed to ucra_pool_run()
+ * @param job Job index in [0, job_count)
+ * @param worker Index of the executing worker in [0, ucra_pool_size()); stable for
+ *               the duration of the call, so it can select per-worker scratch
+ */
+typedef void (*UCRA_JobFn)(void* ctx, uint32_t job, uint32_t worker);
+
+typedef struct UCRA_ThreadPool UCRA_ThreadPool;
+
+/**
+ * @brief Create a pool of worker_count workers
+ *
+ * The thread calling ucra_pool_run() acts as worker 0, so worker_count - 1
+ * threads are started. worker_count 0 means one worker per CPU.
+ */
+UCRA_Result ucra_pool_create(uint32_t worker_count, UCRA_ThreadPool** out_pool);
+void ucra_pool_destroy(UCRA_ThreadPool* pool);
+
+/** Number of workers, including the calling thread */
+uint32_t ucra_pool_size(const UCRA_ThreadPool* pool);
+
+/**
+ * @brief Run fn for every job index and wait until all have finished
+ *
+ * Not reentrant: one ucra_pool_run() at a time per pool.
+ */
+void ucra_pool_run(UCRA_ThreadPool* pool, uint32_t job_count, UCRA_JobFn fn, void* ctx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* UCRA_THREADS_H */
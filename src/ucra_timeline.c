@@ -0,0 +1,261 @@
+/*
+ * UCRA Timeline
+ * The in-process wavtool stage: rendered notes are placed at their start less
+ * their preutterance, crossfaded with the audio under their overlap, shaped
+ * by their envelope points and take over from everything mixed after that.
+ * A stream timeline keeps only the audio from the latest note's start on and
+ * hands everything before it to the sink.
+ */
+
+#include "ucra/ucra.h"
+#include "ucra_curve.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+/* Frames mixed per envelope block and handed to a sink per call */
+#define TIMELINE_BLOCK 1024u
+#define TIMELINE_SINK_CHUNK (1u << 20)
+
+/* Positions beyond this many seconds are rejected before they overflow a frame count */
+#define TIMELINE_MAX_SEC 1e9
+
+typedef struct UCRA_Timeline_ {
+    uint32_t sample_rate;
+    uint32_t channels;
+    UCRA_TimelineSink sink;     /* NULL for a caller buffer */
+    void* user_data;
+
+    float* window;              /* the caller buffer, or the unfinished audio of a stream */
+    uint64_t capacity;          /* frames window holds */
+    uint64_t base;              /* timeline frame of window[0]; 0 for a buffer */
+    uint64_t length;            /* frames of window holding audio */
+
+    int64_t last_begin;         /* first frame of the previous note's PCM */
+    int has_notes;
+    int finished;
+    UCRA_Result status;         /* first sink failure; sticky */
+} UCRA_Timeline;
+
+static UCRA_Result create_timeline(UCRA_TimelineHandle* out_timeline, uint32_t sample_rate, uint32_t channels,
+                                   UCRA_Timeline** out) {
+    if (out_timeline) *out_timeline = NULL;
+    if (!out_timeline || sample_rate == 0 || channels == 0) {
+        return UCRA_ERR_INVALID_ARGUMENT;
+    }
+    UCRA_Timeline* timeline = calloc(1, sizeof(UCRA_Timeline));
+    if (!timeline) {
+        return UCRA_ERR_OUT_OF_MEMORY;
+    }
+    timeline->sample_rate = sample_rate;
+    timeline->channels = channels;
+    *out = timeline;
+    return UCRA_SUCCESS;
+}
+
+UCRA_Result ucra_timeline_create_buffer(UCRA_TimelineHandle* out_timeline, uint32_t sample_rate,
+                                        uint32_t channels, float* buffer, uint64_t frame_capacity) {
+    if (!buffer || frame_capacity == 0 || frame_capacity > SIZE_MAX / sizeof(float) / (channels ? channels : 1)) {
+        if (out_timeline) *out_timeline = NULL;
+        return UCRA_ERR_INVALID_ARGUMENT;
+    }
+    UCRA_Timeline* timeline = NULL;
+    UCRA_Result result = create_timeline(out_timeline, sample_rate, channels, &timeline);
+    if (result != UCRA_SUCCESS) {
+        return result;
+    }
+    timeline->window = buffer;
+    timeline->capacity = frame_capacity;
+    memset(buffer, 0, (size_t)frame_capacity * channels * sizeof(float));
+    *out_timeline = timeline;
+    return UCRA_SUCCESS;
+}
+
+UCRA_Result ucra_timeline_create_stream(UCRA_TimelineHandle* out_timeline, uint32_t sample_rate,
+                                        uint32_t channels, UCRA_TimelineSink sink, void* user_data) {
+    if (!sink || channels > 0xFFFFu) {
+        if (out_timeline) *out_timeline = NULL;
+        return UCRA_ERR_INVALID_ARGUMENT;
+    }
+    UCRA_Timeline* timeline = NULL;
+    UCRA_Result result = create_timeline(out_timeline, sample_rate, channels, &timeline);
+    if (result != UCRA_SUCCESS) {
+        return result;
+    }
+    timeline->sink = sink;
+    timeline->user_data = user_data;
+    timeline->capacity = TIMELINE_BLOCK;
+    timeline->window = malloc((size_t)timeline->capacity * channels * sizeof(float));
+    if (!timeline->window) {
+        free(timeline);
+        return UCRA_ERR_OUT_OF_MEMORY;
+    }
+    *out_timeline = timeline;
+    return UCRA_SUCCESS;
+}
+
+/* Hand frames of pcm to the sink in pieces it can take */
+static void emit(UCRA_Timeline* timeline, const float* pcm, uint64_t frames) {
+    while (frames > 0 && timeline->status == UCRA_SUCCESS) {
+        uint32_t n = frames < TIMELINE_SINK_CHUNK ? (uint32_t)frames : TIMELINE_SINK_CHUNK;
+        timeline->status = timeline->sink(timeline->user_data, pcm, n);
+        pcm += (size_t)n * timeline->channels;
+        frames -= n;
+    }
+}
+
+/* Hand a stream's audio before frame place to the sink, with silence for any gap */
+static void advance_stream(UCRA_Timeline* timeline, uint64_t place) {
+    uint32_t channels = timeline->channels;
+    uint64_t done = place - timeline->base;
+    uint64_t ready = done < timeline->length ? done : timeline->length;
+    emit(timeline, timeline->window, ready);
+    memmove(timeline->window, timeline->window + (size_t)ready * channels,
+            (size_t)(timeline->length - ready) * channels * sizeof(float));
+    timeline->length -= ready;
+
+    uint64_t gap = done - ready; /* only when the window is empty */
+    if (gap > 0) {
+        uint64_t zeros = gap < timeline->capacity ? gap : timeline->capacity;
+        memset(timeline->window, 0, (size_t)zeros * channels * sizeof(float));
+        while (gap > 0) {
+            uint64_t n = gap < zeros ? gap : zeros;
+            emit(timeline, timeline->window, n);
+            gap -= n;
+        }
+    }
+    timeline->base = place;
+}
+
+static UCRA_Result reserve_stream(UCRA_Timeline* timeline, uint64_t frames) {
+    if (frames <= timeline->capacity) {
+        return UCRA_SUCCESS;
+    }
+    uint64_t capacity = timeline->capacity * 2 > frames ? timeline->capacity * 2 : frames;
+    if (capacity > SIZE_MAX / sizeof(float) / timeline->channels) {
+        return UCRA_ERR_OUT_OF_MEMORY;
+    }
+    float* window = realloc(timeline->window, (size_t)capacity * timeline->channels * sizeof(float));
+    if (!window) {
+        return UCRA_ERR_OUT_OF_MEMORY;
+    }
+    timeline->window = window;
+    timeline->capacity = capacity;
+    return UCRA_SUCCESS;
+}
+
+/* Mix frames of the note's PCM from frame skip on into the window at frame at */
+static void mix_note(UCRA_Timeline* timeline, const UCRA_TimelineNote* note, uint64_t at, uint64_t skip,
+                     uint64_t frames) {
+    uint32_t channels = timeline->channels;
+    double rate = (double)timeline->sample_rate;
+    uint64_t overlap = (uint64_t)llround(note->overlap_sec * rate);
+    UCRA_CurveCursor cursor;
+    ucra_curve_cursor_env(&cursor, note->envelope);
+    int shaped = ucra_curve_valid(&cursor);
+    double gains[TIMELINE_BLOCK];
+
+    for (uint64_t done = 0; done < frames; done += TIMELINE_BLOCK) {
+        uint32_t n = frames - done < TIMELINE_BLOCK ? (uint32_t)(frames - done) : TIMELINE_BLOCK;
+        uint64_t first = skip + done; /* frame of the note's PCM */
+        if (shaped) {
+            ucra_curve_sample_block(&cursor, UCRA_CURVE_LINEAR, (double)first / rate, 1.0 / rate, n, gains);
+        }
+        const float* in = note->pcm + (size_t)first * channels;
+        float* out = timeline->window + (size_t)(at + done) * channels;
+        for (uint32_t i = 0; i < n; i++, in += channels, out += channels) {
+            uint64_t frame = first + i;
+            float gain = shaped ? (float)gains[i] : 1.0f;
+            /* under the overlap the audio already there fades out as the note fades in; after it,
+             * the note replaces that audio */
+            float keep = 0.0f;
+            if (frame < overlap) {
+                float fade = (float)((double)frame / (double)overlap);
+                gain *= fade;
+                keep = 1.0f - fade;
+            }
+            if (at + done + i >= timeline->length) keep = 0.0f;
+            for (uint32_t c = 0; c < channels; c++) {
+                out[c] = (keep != 0.0f ? out[c] * keep : 0.0f) + in[c] * gain;
+            }
+        }
+    }
+}
+
+UCRA_Result ucra_timeline_add(UCRA_TimelineHandle timeline, const UCRA_TimelineNote* note) {
+    if (!timeline || !note || timeline->finished || (note->frames > 0 && !note->pcm) ||
+        !isfinite(note->start_sec) || !isfinite(note->preutter_sec) || !isfinite(note->overlap_sec) ||
+        note->overlap_sec < 0.0 || fabs(note->start_sec - note->preutter_sec) > TIMELINE_MAX_SEC ||
+        note->overlap_sec > TIMELINE_MAX_SEC) {
+        return UCRA_ERR_INVALID_ARGUMENT;
+    }
+    if (timeline->status != UCRA_SUCCESS) {
+        return timeline->status;
+    }
+    int64_t begin = llround((note->start_sec - note->preutter_sec) * timeline->sample_rate);
+    if (timeline->has_notes && begin < timeline->last_begin) {
+        return UCRA_ERR_INVALID_ARGUMENT;
+    }
+    timeline->last_begin = begin;
+    timeline->has_notes = 1;
+
+    uint64_t skip = begin < 0 ? (uint64_t)(-begin) : 0;
+    if (skip >= note->frames) {
+        return UCRA_SUCCESS;
+    }
+    uint64_t place = begin < 0 ? 0 : (uint64_t)begin;
+    uint64_t frames = note->frames - skip;
+
+    if (timeline->sink) {
+        advance_stream(timeline, place);
+        UCRA_Result result = timeline->status;
+        if (result == UCRA_SUCCESS) {
+            result = reserve_stream(timeline, frames);
+        }
+        if (result != UCRA_SUCCESS) {
+            return result;
+        }
+    } else {
+        if (place >= timeline->capacity) {
+            return UCRA_SUCCESS;
+        }
+        if (frames > timeline->capacity - place) {
+            frames = timeline->capacity - place;
+        }
+    }
+
+    uint64_t at = place - timeline->base;
+    mix_note(timeline, note, at, skip, frames);
+    if (!timeline->sink && at + frames < timeline->length) {
+        /* a buffer keeps what the note took over from, so clear it */
+        memset(timeline->window + (size_t)(at + frames) * timeline->channels, 0,
+               (size_t)(timeline->length - at - frames) * timeline->channels * sizeof(float));
+    }
+    timeline->length = at + frames;
+    return UCRA_SUCCESS;
+}
+
+UCRA_Result ucra_timeline_finish(UCRA_TimelineHandle timeline, uint64_t* out_frames) {
+    if (out_frames) *out_frames = 0;
+    if (!timeline) {
+        return UCRA_ERR_INVALID_ARGUMENT;
+    }
+    if (timeline->sink && !timeline->finished) {
+        emit(timeline, timeline->window, timeline->length);
+        timeline->base += timeline->length;
+        timeline->length = 0;
+    }
+    timeline->finished = 1;
+    if (out_frames) *out_frames = timeline->base + timeline->length;
+    return timeline->status;
+}
+
+void ucra_timeline_destroy(UCRA_TimelineHandle timeline) {
+    if (!timeline) {
+        return;
+    }
+    if (timeline->sink) {
+        free(timeline->window);
+    }
+    free(timeline);
+}
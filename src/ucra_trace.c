@@ -0,0 +1,220 @@
+/*
+ * UCRA Tracing
+ * Each recording thread owns a single-producer ring of events; drains are the
+ * only consumers and run one at a time. A thread takes the registry lock once,
+ * to claim a ring; a ring outlives its thread and is handed to the next new
+ * thread, so the number of rings follows the peak number of traced threads.
+ */
+
+#include "ucra_trace.h"
+#include "ucra_threads.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifdef UCRA_TRACING
+
+/* Events per thread between drains; a power of two */
+#define UCRA_TRACE_RING_EVENTS 8192u
+
+typedef struct UCRA_TraceRing {
+    struct UCRA_TraceRing* next;  /* immutable once the ring is published */
+    uint32_t thread_id;
+    int owned;                    /* guarded by registry_mutex */
+    volatile uint32_t head;       /* written by the owning thread */
+    volatile uint32_t tail;       /* written by the drain */
+    volatile uint64_t dropped;    /* written by the owning thread */
+    uint64_t dropped_reported;    /* guarded by drain_mutex */
+    UCRA_TraceEvent events[UCRA_TRACE_RING_EVENTS];
+} UCRA_TraceRing;
+
+volatile uint32_t ucra_trace_active = 0;
+
+static UCRA_Once trace_once = UCRA_ONCE_INIT;
+static UCRA_Mutex registry_mutex;
+static UCRA_Mutex drain_mutex;
+static UCRA_TraceRing* volatile rings = NULL;
+static uint32_t ring_count = 0;
+
+/* Hand a ring back when its thread exits */
+static void release_ring(void* ring) {
+    if (!ring) return;
+    ucra_mutex_lock(&registry_mutex);
+    ((UCRA_TraceRing*)ring)->owned = 0;
+    ucra_mutex_unlock(&registry_mutex);
+}
+
+#ifdef _WIN32
+static DWORD ring_key = FLS_OUT_OF_INDEXES;
+
+static VOID WINAPI release_ring_fls(PVOID ring) { release_ring(ring); }
+static void key_init(void) { ring_key = FlsAlloc(release_ring_fls); }
+static UCRA_TraceRing* key_get(void) {
+    return ring_key == FLS_OUT_OF_INDEXES ? NULL : (UCRA_TraceRing*)FlsGetValue(ring_key);
+}
+static int key_set(UCRA_TraceRing* ring) {
+    return ring_key != FLS_OUT_OF_INDEXES && FlsSetValue(ring_key, ring);
+}
+#else
+static pthread_key_t ring_key;
+static int ring_key_valid = 0;
+
+static void key_init(void) { ring_key_valid = pthread_key_create(&ring_key, release_ring) == 0; }
+static UCRA_TraceRing* key_get(void) {
+    return ring_key_valid ? (UCRA_TraceRing*)pthread_getspecific(ring_key) : NULL;
+}
+static int key_set(UCRA_TraceRing* ring) {
+    return ring_key_valid && pthread_setspecific(ring_key, ring) == 0;
+}
+#endif
+
+static void trace_init(void) {
+    ucra_mutex_init(&registry_mutex);
+    ucra_mutex_init(&drain_mutex);
+    key_init();
+}
+
+/* The calling thread's ring, claimed on first use; NULL if none can be had */
+static UCRA_TraceRing* thread_ring(void) {
+    UCRA_TraceRing* ring = key_get();
+    if (ring) return ring;
+
+    ucra_mutex_lock(&registry_mutex);
+    for (ring = rings; ring && ring->owned; ring = ring->next) {}
+    if (!ring) {
+        ring = (UCRA_TraceRing*)calloc(1, sizeof(UCRA_TraceRing));
+        if (ring) {
+            ring->thread_id = ring_count++;
+            ring->next = rings;
+            rings = ring;
+        }
+    }
+    if (ring) {
+        ring->owned = 1;
+        if (!key_set(ring)) {
+            ring->owned = 0;
+            ring = NULL;
+        }
+    }
+    ucra_mutex_unlock(&registry_mutex);
+    return ring;
+}
+
+uint64_t ucra_trace_now(void) {
+    uint64_t now = ucra_time_ns();
+    return now ? now : 1;
+}
+
+void ucra_trace_end(const char* name, uint64_t start_ns) {
+    if (!start_ns) return;
+    uint64_t end_ns = ucra_time_ns();
+    ucra_once(&trace_once, trace_init);
+    UCRA_TraceRing* ring = thread_ring();
+    if (!ring) return;
+
+    uint32_t head = ring->head;
+    if (head - ucra_atomic_load_acquire(&ring->tail) >= UCRA_TRACE_RING_EVENTS) {
+        ucra_atomic_store_u64(&ring->dropped, ring->dropped + 1);
+        return;
+    }
+    UCRA_TraceEvent* event = &ring->events[head & (UCRA_TRACE_RING_EVENTS - 1)];
+    event->name = name;
+    event->start_ns = start_ns;
+    event->duration_ns = end_ns - start_ns;
+    event->thread_id = ring->thread_id;
+    ucra_atomic_store_release(&ring->head, head + 1);
+}
+
+UCRA_Result ucra_trace_enable(int enabled) {
+    ucra_once(&trace_once, trace_init);
+    ucra_atomic_store_release(&ucra_trace_active, enabled ? 1u : 0u);
+    return UCRA_SUCCESS;
+}
+
+UCRA_Result ucra_trace_drain(UCRA_TraceCallback callback, void* user_data, uint64_t* out_dropped) {
+    if (!callback) return UCRA_ERR_INVALID_ARGUMENT;
+    ucra_once(&trace_once, trace_init);
+
+    ucra_mutex_lock(&registry_mutex);
+    UCRA_TraceRing* first = rings;
+    ucra_mutex_unlock(&registry_mutex);
+
+    uint64_t dropped = 0;
+    ucra_mutex_lock(&drain_mutex);
+    for (UCRA_TraceRing* ring = first; ring; ring = ring->next) {
+        uint32_t tail = ring->tail;
+        uint32_t head = ucra_atomic_load_acquire(&ring->head);
+        while (tail != head) {
+            /* up to the end of the array, then the wrapped rest */
+            uint32_t slot = tail & (UCRA_TRACE_RING_EVENTS - 1);
+            uint32_t count = head - tail;
+            if (count > UCRA_TRACE_RING_EVENTS - slot) count = UCRA_TRACE_RING_EVENTS - slot;
+            callback(user_data, &ring->events[slot], count);
+            tail += count;
+        }
+        ucra_atomic_store_release(&ring->tail, tail);
+
+        uint64_t ring_dropped = ucra_atomic_load_u64(&ring->dropped);
+        dropped += ring_dropped - ring->dropped_reported;
+        ring->dropped_reported = ring_dropped;
+    }
+    ucra_mutex_unlock(&drain_mutex);
+
+    if (out_dropped) *out_dropped = dropped;
+    return UCRA_SUCCESS;
+}
+
+typedef struct UCRA_ChromeWriter {
+    FILE* file;
+    uint64_t written;
+} UCRA_ChromeWriter;
+
+static void UCRA_CALL write_chrome_events(void* user_data, const UCRA_TraceEvent* events, uint32_t count) {
+    UCRA_ChromeWriter* writer = (UCRA_ChromeWriter*)user_data;
+    for (uint32_t i = 0; i < count; i++) {
+        /* timestamps in microseconds; names are static identifiers, so need no escaping */
+        fprintf(writer->file,
+                "%s\n{\"name\":\"%s\",\"cat\":\"ucra\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u}",
+                writer->written ? "," : "", events[i].name, events[i].start_ns / 1000.0,
+                events[i].duration_ns / 1000.0, events[i].thread_id);
+        writer->written++;
+    }
+}
+
+UCRA_Result ucra_trace_write_chrome(const char* path) {
+    if (!path) return UCRA_ERR_INVALID_ARGUMENT;
+    FILE* file = fopen(path, "w");
+    if (!file) return UCRA_ERR_FILE_NOT_FOUND;
+
+    UCRA_ChromeWriter writer = { file, 0 };
+    uint64_t dropped = 0;
+    fputs("{\"traceEvents\":[", file);
+    UCRA_Result result = ucra_trace_drain(write_chrome_events, &writer, &dropped);
+    fprintf(file, "\n],\"displayTimeUnit\":\"ms\",\"otherData\":{\"dropped_events\":%llu}}\n",
+            (unsigned long long)dropped);
+    if (fclose(file) != 0 && result == UCRA_SUCCESS) {
+        result = UCRA_ERR_FILE_NOT_FOUND;
+    }
+    return result;
+}
+
+#else /* !UCRA_TRACING */
+
+UCRA_Result ucra_trace_enable(int enabled) {
+    (void)enabled;
+    return UCRA_ERR_NOT_SUPPORTED;
+}
+
+UCRA_Result ucra_trace_drain(UCRA_TraceCallback callback, void* user_data, uint64_t* out_dropped) {
+    (void)callback;
+    (void)user_data;
+    if (out_dropped) *out_dropped = 0;
+    return UCRA_ERR_NOT_SUPPORTED;
+}
+
+UCRA_Result ucra_trace_write_chrome(const char* path) {
+    (void)path;
+    return UCRA_ERR_NOT_SUPPORTED;
+}
+
+#endif
@@ -0,0 +1,53 @@
+/*
+ * UCRA Tracing (internal)
+ * Hooks that time the stages of a render into per-thread buffers; see the
+ * Tracing API in ucra.h for reading them. Unless the library is built with
+ * UCRA_TRACING the hooks expand to nothing.
+ *
+ *     UCRA_TRACE_BEGIN(fill);
+ *     fill_frame_spectra(...);
+ *     UCRA_TRACE_END(fill, "world.spectral_fill");
+ *
+ * A span left by an early return is simply not recorded.
+ */
+#ifndef UCRA_TRACE_H
+#define UCRA_TRACE_H
+
+#include "ucra/ucra.h"
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef UCRA_TRACING
+
+/** Nonzero while events are recorded; set by ucra_trace_enable() */
+extern volatile uint32_t ucra_trace_active;
+
+uint64_t ucra_trace_now(void);
+
+/** Record a span of name (a static string) that began at start_ns; 0 means tracing was off */
+void ucra_trace_end(const char* name, uint64_t start_ns);
+
+static inline uint64_t ucra_trace_begin(void) {
+    return ucra_trace_active ? ucra_trace_now() : 0;
+}
+
+#define UCRA_TRACE_BEGIN(span) const uint64_t span##_trace_start = ucra_trace_begin()
+#define UCRA_TRACE_END(span, name) \
+    do { if (span##_trace_start) ucra_trace_end((name), span##_trace_start); } while (0)
+
+#else
+
+#define UCRA_TRACE_BEGIN(span) ((void)0)
+#define UCRA_TRACE_END(span, name) ((void)0)
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* UCRA_TRACE_H */
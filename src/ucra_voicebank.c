@@ -0,0 +1,264 @@
+/*
+ * UCRA Voicebank Discovery
+ * Lists voicebank roots and loads their manifests on a worker pool. Both steps
+ * wait on the file system rather than the CPU, so the pool is sized by the
+ * caller's I/O concurrency instead of the CPU count.
+ */
+
+#include "ucra/ucra.h"
+#include "ucra_file.h"
+#include "ucra_threads.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define VOICEBANK_DEFAULT_IO_THREADS 8
+
+typedef struct UCRA_VoicebankSet_ {
+    UCRA_VoicebankEntry* entries;
+    uint32_t count;
+} UCRA_VoicebankSet;
+
+/* What listing one root found */
+typedef struct RootScan {
+    const char* root;
+    UCRA_VoicebankEntry self;  /* the root's own manifest; status UCRA_ERR_FILE_NOT_FOUND if none */
+    char** names;              /* subdirectories, when the root is not a voicebank itself */
+    uint32_t name_count;
+    uint32_t name_capacity;
+    UCRA_Result status;        /* listing the root */
+} RootScan;
+
+typedef struct DiscoverJob {
+    RootScan* scans;
+    UCRA_VoicebankEntry* entries;
+    const uint32_t* pending;   /* entries still to load */
+} DiscoverJob;
+
+/* Fill entry's paths for directory dir/name (name may be NULL) in one allocation */
+static UCRA_Result set_entry_paths(UCRA_VoicebankEntry* entry, const char* dir, const char* name) {
+    size_t dir_length = strlen(dir);
+    int add_sep = dir_length > 0 && dir[dir_length - 1] != '/' && dir[dir_length - 1] != '\\';
+    size_t directory_size = dir_length + (name ? add_sep + strlen(name) : 0) + 1;
+    size_t manifest_size = directory_size + 1 + strlen(UCRA_VOICEBANK_MANIFEST);
+    char* block = malloc(directory_size + manifest_size);
+    if (!block) {
+        return UCRA_ERR_OUT_OF_MEMORY;
+    }
+    if (name) {
+        snprintf(block, directory_size, "%s%s%s", dir, add_sep ? "/" : "", name);
+        add_sep = 1;
+    } else {
+        memcpy(block, dir, directory_size);
+    }
+    /* copied, not formatted from block: snprintf must not read the allocation it writes */
+    char* manifest = block + directory_size;
+    memcpy(manifest, block, directory_size - 1);
+    snprintf(manifest + directory_size - 1, manifest_size - (directory_size - 1), "%s%s",
+             add_sep ? "/" : "", UCRA_VOICEBANK_MANIFEST);
+    entry->directory = block;
+    entry->manifest_path = manifest;
+    return UCRA_SUCCESS;
+}
+
+static void load_entry(UCRA_VoicebankEntry* entry) {
+    entry->status = ucra_manifest_acquire(entry->manifest_path, &entry->manifest);
+}
+
+static int collect_subdirectory(void* ctx, const char* name, int is_directory) {
+    RootScan* scan = (RootScan*)ctx;
+    if (!is_directory) return 0;
+    if (scan->name_count == scan->name_capacity) {
+        uint32_t capacity = scan->name_capacity ? scan->name_capacity * 2 : 16;
+        char** names = realloc(scan->names, capacity * sizeof(char*));
+        if (!names) {
+            scan->status = UCRA_ERR_OUT_OF_MEMORY;
+            return 1;
+        }
+        scan->names = names;
+        scan->name_capacity = capacity;
+    }
+    size_t size = strlen(name) + 1;
+    char* copy = malloc(size);
+    if (!copy) {
+        scan->status = UCRA_ERR_OUT_OF_MEMORY;
+        return 1;
+    }
+    memcpy(copy, name, size);
+    scan->names[scan->name_count++] = copy;
+    return 0;
+}
+
+static int compare_names(const void* a, const void* b) {
+    return strcmp(*(const char* const*)a, *(const char* const*)b);
+}
+
+/* Pool job: load a root's own manifest, or list its subdirectories if it has none */
+static void scan_root_job(void* ctx, uint32_t job, uint32_t worker) {
+    (void)worker;
+    RootScan* scan = &((DiscoverJob*)ctx)->scans[job];
+    scan->status = set_entry_paths(&scan->self, scan->root, NULL);
+    if (scan->status != UCRA_SUCCESS) return;
+    load_entry(&scan->self);
+    if (scan->self.status != UCRA_ERR_FILE_NOT_FOUND) return;
+
+    UCRA_Result listed = ucra_dir_list(scan->root, collect_subdirectory, scan);
+    if (listed != UCRA_SUCCESS) {
+        scan->status = listed;
+        return;
+    }
+    if (scan->status == UCRA_SUCCESS && scan->name_count > 1) {
+        qsort(scan->names, scan->name_count, sizeof(char*), compare_names);
+    }
+}
+
+static void load_entry_job(void* ctx, uint32_t job, uint32_t worker) {
+    (void)worker;
+    DiscoverJob* discover = (DiscoverJob*)ctx;
+    load_entry(&discover->entries[discover->pending[job]]);
+}
+
+/* (Re)create pool with min(limit, jobs) workers unless it already has that many; NULL runs inline */
+static void size_pool(UCRA_ThreadPool** pool, uint32_t limit, uint32_t jobs) {
+    uint32_t wanted = jobs < limit ? jobs : limit;
+    if (wanted < 2 || (*pool && ucra_pool_size(*pool) >= wanted)) return;
+    if (*pool) {
+        ucra_pool_destroy(*pool);
+        *pool = NULL;
+    }
+    if (ucra_pool_create(wanted, pool) != UCRA_SUCCESS) {
+        *pool = NULL; /* the jobs still run, on the calling thread */
+    }
+}
+
+static void free_scans(RootScan* scans, uint32_t count) {
+    for (uint32_t r = 0; r < count; ++r) {
+        for (uint32_t i = 0; i < scans[r].name_count; ++i) {
+            free(scans[r].names[i]);
+        }
+        free(scans[r].names);
+    }
+    free(scans);
+}
+
+UCRA_Result ucra_voicebank_discover(UCRA_VoicebankSetHandle* out_set,
+                                    const char* const* roots,
+                                    uint32_t root_count,
+                                    uint32_t io_threads) {
+    if (!out_set) {
+        return UCRA_ERR_INVALID_ARGUMENT;
+    }
+    *out_set = NULL;
+    if (root_count > 0 && !roots) {
+        return UCRA_ERR_INVALID_ARGUMENT;
+    }
+    for (uint32_t r = 0; r < root_count; ++r) {
+        if (!roots[r]) return UCRA_ERR_INVALID_ARGUMENT;
+    }
+    if (io_threads == 0) {
+        io_threads = VOICEBANK_DEFAULT_IO_THREADS;
+    }
+
+    UCRA_VoicebankSet* set = calloc(1, sizeof(UCRA_VoicebankSet));
+    RootScan* scans = calloc(root_count ? root_count : 1, sizeof(RootScan));
+    if (!set || !scans) {
+        free(set);
+        free(scans);
+        return UCRA_ERR_OUT_OF_MEMORY;
+    }
+    for (uint32_t r = 0; r < root_count; ++r) {
+        scans[r].root = roots[r];
+    }
+
+    /* First every root: its own manifest, or else its subdirectories */
+    UCRA_ThreadPool* pool = NULL;
+    DiscoverJob job = { scans, NULL, NULL };
+    size_pool(&pool, io_threads, root_count);
+    ucra_pool_run(pool, root_count, scan_root_job, &job);
+
+    /* One entry per voicebank root, unreadable root and candidate subdirectory, in root order */
+    uint32_t capacity = 0;
+    for (uint32_t r = 0; r < root_count; ++r) {
+        int listed = scans[r].status == UCRA_SUCCESS && scans[r].self.status == UCRA_ERR_FILE_NOT_FOUND;
+        capacity += listed ? scans[r].name_count : 1;
+    }
+    set->entries = calloc(capacity ? capacity : 1, sizeof(UCRA_VoicebankEntry));
+    uint32_t* pending = malloc((capacity ? capacity : 1) * sizeof(uint32_t));
+    UCRA_Result result = set->entries && pending ? UCRA_SUCCESS : UCRA_ERR_OUT_OF_MEMORY;
+    uint32_t pending_count = 0;
+    for (uint32_t r = 0; r < root_count; ++r) {
+        RootScan* scan = &scans[r];
+        UCRA_VoicebankEntry* entry = result == UCRA_SUCCESS ? &set->entries[set->count] : NULL;
+        if (entry && scan->status != UCRA_SUCCESS) {
+            result = set_entry_paths(entry, scan->root, NULL);
+            entry->status = scan->status;
+            set->count += result == UCRA_SUCCESS;
+        } else if (entry && scan->self.status != UCRA_ERR_FILE_NOT_FOUND) {
+            *entry = scan->self;
+            scan->self.manifest = NULL; /* owned by the set now */
+            scan->self.directory = NULL;
+            set->count++;
+        } else {
+            for (uint32_t i = 0; result == UCRA_SUCCESS && i < scan->name_count; ++i) {
+                result = set_entry_paths(&set->entries[set->count], scan->root, scan->names[i]);
+                if (result == UCRA_SUCCESS) pending[pending_count++] = set->count++;
+            }
+        }
+        ucra_manifest_release(scan->self.manifest);
+        free((void*)scan->self.directory);
+    }
+    free_scans(scans, root_count);
+
+    /* Then every candidate subdirectory's manifest */
+    if (result == UCRA_SUCCESS) {
+        job.entries = set->entries;
+        job.pending = pending;
+        size_pool(&pool, io_threads, pending_count);
+        ucra_pool_run(pool, pending_count, load_entry_job, &job);
+    }
+    ucra_pool_destroy(pool);
+
+    /* Subdirectories without a manifest are not voicebanks */
+    uint32_t kept = 0;
+    for (uint32_t i = 0, p = 0; i < set->count; ++i) {
+        int candidate = p < pending_count && pending[p] == i;
+        p += candidate;
+        if (candidate && set->entries[i].status == UCRA_ERR_FILE_NOT_FOUND) {
+            free((void*)set->entries[i].directory);
+        } else {
+            set->entries[kept++] = set->entries[i];
+        }
+    }
+    set->count = kept;
+    free(pending);
+
+    if (result != UCRA_SUCCESS) {
+        ucra_voicebank_destroy((UCRA_VoicebankSetHandle)set);
+        return result;
+    }
+    *out_set = (UCRA_VoicebankSetHandle)set;
+    return UCRA_SUCCESS;
+}
+
+uint32_t ucra_voicebank_count(UCRA_VoicebankSetHandle handle) {
+    const UCRA_VoicebankSet* set = (const UCRA_VoicebankSet*)handle;
+    return set ? set->count : 0;
+}
+
+const UCRA_VoicebankEntry* ucra_voicebank_entry(UCRA_VoicebankSetHandle handle, uint32_t index) {
+    const UCRA_VoicebankSet* set = (const UCRA_VoicebankSet*)handle;
+    if (!set || index >= set->count) return NULL;
+    return &set->entries[index];
+}
+
+void ucra_voicebank_destroy(UCRA_VoicebankSetHandle handle) {
+    if (!handle) return;
+
+    UCRA_VoicebankSet* set = (UCRA_VoicebankSet*)handle;
+    for (uint32_t i = 0; i < set->count; ++i) {
+        ucra_manifest_release(set->entries[i].manifest);
+        free((void*)set->entries[i].directory); /* also holds manifest_path */
+    }
+    free(set->entries);
+    free(set);
+}
@@ -0,0 +1,212 @@
+/*
+ * UCRA WAV Reading
+ * Chunk-walking RIFF/WAVE (and RF64) reader over a memory-mapped file. Samples
+ * are converted to float straight from the mapping in blocks, with the
+ * vectorized kernels for 16/24-bit PCM and the stereo downmix.
+ */
+
+#include "ucra_wav.h"
+#include "ucra_kernels.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define WAV_FORMAT_PCM 1
+#define WAV_FORMAT_FLOAT 3
+#define WAV_FORMAT_EXTENSIBLE 0xFFFE
+
+/* Samples converted per step before the channels are averaged */
+#define WAV_DECODE_BLOCK 4096u
+
+static uint32_t read_le32(const unsigned char* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint64_t read_le64(const unsigned char* p) {
+    return (uint64_t)read_le32(p) | ((uint64_t)read_le32(p + 4) << 32);
+}
+
+static uint16_t read_le16(const unsigned char* p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+/* one sample of the given encoding as float, for the encodings without a kernel */
+static float decode_sample(const unsigned char* p, uint16_t format, uint16_t bits) {
+    if (format == WAV_FORMAT_FLOAT) {
+        float value;
+        uint32_t raw = read_le32(p);
+        memcpy(&value, &raw, sizeof(value));
+        return value;
+    }
+    switch (bits) {
+        case 8: return ((int)p[0] - 128) / 128.0f;
+        case 16: return (int16_t)read_le16(p) / 32768.0f;
+        case 24: {
+            int32_t v = (int32_t)((uint32_t)p[0] << 8 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 24) >> 8;
+            return v / 8388608.0f;
+        }
+        default: return (float)((int32_t)read_le32(p) / 2147483648.0);
+    }
+}
+
+UCRA_Result ucra_wav_map(const char* path, UCRA_WavMap* out_wav) {
+    if (!path || !out_wav) {
+        return UCRA_ERR_INVALID_ARGUMENT;
+    }
+    memset(out_wav, 0, sizeof(*out_wav));
+
+    UCRA_FileMap map;
+    UCRA_Result result = ucra_file_map(path, &map);
+    if (result != UCRA_SUCCESS) {
+        return result;
+    }
+    const unsigned char* bytes = (const unsigned char*)map.data;
+    /* RF64 keeps its real sizes in a ds64 chunk, which comes before the data chunk */
+    if (map.size < 12 || (memcmp(bytes, "RIFF", 4) != 0 && memcmp(bytes, "RF64", 4) != 0) ||
+        memcmp(bytes + 8, "WAVE", 4) != 0) {
+        ucra_file_unmap(&map);
+        return UCRA_ERR_INTERNAL;
+    }
+
+    /* only the chunk headers are touched here; sample pages load when a region is read */
+    uint16_t format = 0, channels = 0, bits = 0;
+    uint32_t sample_rate = 0;
+    uint64_t rf64_data_size = UINT64_MAX;
+    size_t pos = 12;
+    result = UCRA_ERR_INTERNAL;
+    while (pos + 8 <= map.size) {
+        const unsigned char* header = bytes + pos;
+        uint32_t size = read_le32(header + 4);
+        size_t body = pos + 8;
+        size_t available = map.size - body;
+        if (memcmp(header, "ds64", 4) == 0) {
+            if (size < 16 || size > available) break;
+            rf64_data_size = read_le64(bytes + body + 8);
+        } else if (memcmp(header, "fmt ", 4) == 0) {
+            uint32_t take = size < 40 ? size : 40;
+            if (take < 16 || take > available) break;
+            const unsigned char* fmt = bytes + body;
+            format = read_le16(fmt);
+            channels = read_le16(fmt + 2);
+            sample_rate = read_le32(fmt + 4);
+            bits = read_le16(fmt + 14);
+            if (format == WAV_FORMAT_EXTENSIBLE && take >= 26) {
+                format = read_le16(fmt + 24); /* sub-format GUID starts with the format tag */
+            }
+        } else if (memcmp(header, "data", 4) == 0) {
+            int pcm_ok = format == WAV_FORMAT_PCM && (bits == 8 || bits == 16 || bits == 24 || bits == 32);
+            int float_ok = format == WAV_FORMAT_FLOAT && bits == 32;
+            if (channels == 0 || sample_rate == 0 || (!pcm_ok && !float_ok)) {
+                result = UCRA_ERR_NOT_SUPPORTED;
+                break;
+            }
+            /* a truncated data chunk keeps the frames that are present */
+            uint32_t frame_bytes = (uint32_t)channels * (bits / 8);
+            uint64_t chunk_size = size == 0xFFFFFFFFu && memcmp(bytes, "RF64", 4) == 0 ? rf64_data_size : size;
+            size_t data_size = chunk_size < available ? (size_t)chunk_size : available;
+            out_wav->map = map;
+            out_wav->data = bytes + body;
+            size_t frames = data_size / frame_bytes;
+            out_wav->frames = frames < UINT32_MAX ? (uint32_t)frames : UINT32_MAX;
+            out_wav->sample_rate = sample_rate;
+            out_wav->channels = channels;
+            out_wav->format = format;
+            out_wav->bits = bits;
+            return UCRA_SUCCESS;
+        }
+        pos = body + (size_t)size + (size & 1);
+    }
+
+    ucra_file_unmap(&map);
+    return result;
+}
+
+void ucra_wav_unmap(UCRA_WavMap* wav) {
+    if (!wav) return;
+    ucra_file_unmap(&wav->map);
+    memset(wav, 0, sizeof(*wav));
+}
+
+static int host_is_little_endian(void) {
+    const uint16_t one = 1;
+    return *(const unsigned char*)&one == 1;
+}
+
+/* Convert n samples of the mapped encoding to float */
+static void decode_samples(const UCRA_WavMap* wav, const UCRA_Kernels* kernels, const unsigned char* p,
+                           uint32_t n, float* out) {
+    if (wav->format == WAV_FORMAT_PCM && wav->bits == 16) {
+        kernels->pcm16_to_float(out, p, n);
+    } else if (wav->format == WAV_FORMAT_PCM && wav->bits == 24) {
+        kernels->pcm24_to_float(out, p, n);
+    } else if (wav->format == WAV_FORMAT_FLOAT && host_is_little_endian()) {
+        memcpy(out, p, (size_t)n * sizeof(float));
+    } else {
+        uint32_t sample_bytes = wav->bits / 8;
+        for (uint32_t i = 0; i < n; ++i, p += sample_bytes) {
+            out[i] = decode_sample(p, wav->format, wav->bits);
+        }
+    }
+}
+
+uint32_t ucra_wav_read_region(const UCRA_WavMap* wav, uint32_t first, uint32_t count, float* out) {
+    if (!wav || !wav->data || !out || first >= wav->frames) {
+        return 0;
+    }
+    if (count > wav->frames - first) {
+        count = wav->frames - first;
+    }
+    const UCRA_Kernels* kernels = ucra_kernels();
+    uint32_t channels = wav->channels;
+    uint32_t frame_bytes = channels * (wav->bits / 8);
+    const unsigned char* p = wav->data + (size_t)first * frame_bytes;
+    if (channels == 1) {
+        decode_samples(wav, kernels, p, count, out);
+        return count;
+    }
+
+    float block[WAV_DECODE_BLOCK];
+    uint32_t step = WAV_DECODE_BLOCK / channels;
+    if (step == 0) {
+        /* more channels than a block holds; average sample by sample */
+        for (uint32_t n = 0; n < count; ++n, p += frame_bytes) {
+            float sum = 0.0f;
+            for (uint32_t ch = 0; ch < channels; ++ch) {
+                sum += decode_sample(p + ch * (wav->bits / 8), wav->format, wav->bits);
+            }
+            out[n] = sum / channels;
+        }
+        return count;
+    }
+    for (uint32_t done = 0; done < count; done += step) {
+        uint32_t frames = count - done < step ? count - done : step;
+        decode_samples(wav, kernels, p + (size_t)done * frame_bytes, frames * channels, block);
+        kernels->downmix(out + done, block, frames, channels);
+    }
+    return count;
+}
+
+UCRA_Result ucra_wav_read_mono(const char* path, float** out_samples,
+                               uint32_t* out_length, uint32_t* out_sample_rate) {
+    if (!path || !out_samples || !out_length || !out_sample_rate) {
+        return UCRA_ERR_INVALID_ARGUMENT;
+    }
+    *out_samples = NULL;
+    *out_length = 0;
+
+    UCRA_WavMap wav;
+    UCRA_Result result = ucra_wav_map(path, &wav);
+    if (result != UCRA_SUCCESS) {
+        return result;
+    }
+    float* samples = malloc(((size_t)wav.frames + 1) * sizeof(float));
+    if (!samples) {
+        ucra_wav_unmap(&wav);
+        return UCRA_ERR_OUT_OF_MEMORY;
+    }
+    *out_samples = samples;
+    *out_length = ucra_wav_read_region(&wav, 0, wav.frames, samples);
+    *out_sample_rate = wav.sample_rate;
+    ucra_wav_unmap(&wav);
+    return UCRA_SUCCESS;
+}
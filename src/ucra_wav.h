@@ -0,0 +1,63 @@
+/*
+ * UCRA WAV Reading (internal)
+ * RIFF/WAVE and RF64 reader shared by the engine, the resampler and the
+ * tools: PCM 8/16/24/32-bit and IEEE float (plain or WAVE_FORMAT_EXTENSIBLE),
+ * downmixed to mono float. Files are memory-mapped, so reading a region of a
+ * long recording only pages in that region.
+ */
+#ifndef UCRA_WAV_H
+#define UCRA_WAV_H
+
+#include "ucra/ucra.h"
+#include "ucra_file.h"
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** A mapped WAV file whose data chunk has been located */
+typedef struct UCRA_WavMap {
+    UCRA_FileMap map;
+    const unsigned char* data; /**< first frame of the data chunk */
+    uint32_t frames;           /**< frames present in the file */
+    uint32_t sample_rate;
+    uint16_t channels;
+    uint16_t format;           /**< 1 = PCM, 3 = IEEE float */
+    uint16_t bits;
+} UCRA_WavMap;
+
+/**
+ * @brief Map a WAV file and locate its format and data chunks
+ * @return UCRA_SUCCESS, UCRA_ERR_FILE_NOT_FOUND, UCRA_ERR_NOT_SUPPORTED for
+ *         unsupported encodings, UCRA_ERR_INTERNAL for malformed files
+ */
+UCRA_Result ucra_wav_map(const char* path, UCRA_WavMap* out_wav);
+
+/** Release a mapping; a zeroed or already released map is ignored */
+void ucra_wav_unmap(UCRA_WavMap* wav);
+
+/**
+ * @brief Decode count frames from frame first on as mono float samples in [-1, 1]
+ * @return Frames written to out, fewer than count at the end of the file
+ */
+uint32_t ucra_wav_read_region(const UCRA_WavMap* wav, uint32_t first, uint32_t count, float* out);
+
+/**
+ * @brief Load a WAV file as mono float samples in [-1, 1]
+ * @param path File to read
+ * @param out_samples Receives a malloc'd array of out_length samples; free() it
+ * @param out_length Number of frames
+ * @param out_sample_rate Sample rate in Hz
+ * @return UCRA_SUCCESS, UCRA_ERR_FILE_NOT_FOUND, UCRA_ERR_NOT_SUPPORTED for
+ *         unsupported encodings, UCRA_ERR_INTERNAL for malformed files
+ */
+UCRA_Result ucra_wav_read_mono(const char* path, float** out_samples,
+                               uint32_t* out_length, uint32_t* out_sample_rate);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* UCRA_WAV_H */
@@ -0,0 +1,304 @@
+/*
+ * UCRA WAV Writer
+ * Incremental RIFF/WAVE writer: blocks are converted into one large buffer
+ * that goes to the file in single unbuffered writes, and the sizes in the
+ * header are filled in on close. Integer formats are quantized with the
+ * vectorized kernels; 16-bit output gets TPDF dither from a per-writer
+ * generator, so the same input gives the same file. With UCRA_WAV_RF64 a JUNK
+ * chunk keeps room for the ds64 chunk an RF64 file needs once it passes 4 GB.
+ */
+
+#include "ucra/ucra.h"
+#include "ucra_kernels.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define WAV_FORMAT_PCM 1
+#define WAV_FORMAT_FLOAT 3
+
+/* Bytes collected before each write to the file */
+#define WAV_WRITER_BUFFER_BYTES (1u << 20)
+/* Samples quantized per kernel call */
+#define WAV_WRITER_CHUNK 4096u
+
+#define WAV_PLAIN_HEADER_BYTES 44u  /* RIFF, fmt and data headers */
+#define WAV_RF64_HEADER_BYTES 80u   /* plus a 36-byte JUNK (later ds64) chunk after RIFF */
+#define WAV_DS64_BODY_BYTES 28u
+#define WAV_RIFF_LIMIT 0xFFFFFFFFull
+
+#define WAV_DITHER_SEED 0x2545F491u
+
+typedef struct UCRA_WavWriter_ {
+    FILE* file;
+    uint32_t sample_rate;
+    uint32_t channels;
+    UCRA_SampleFormat format;
+    uint32_t flags;
+    uint32_t sample_bytes;
+    uint32_t header_bytes;
+    uint64_t frames;
+    uint64_t data_bytes;
+    UCRA_Result status;         /* first failure; sticky */
+
+    unsigned char* buffer;      /* WAV_WRITER_BUFFER_BYTES */
+    size_t used;
+    int32_t* quantized;         /* WAV_WRITER_CHUNK samples, integer formats only */
+    float* dither;              /* WAV_WRITER_CHUNK samples, 16-bit output with dither only */
+    uint32_t random;            /* xorshift32 state of the dither */
+} UCRA_WavWriter;
+
+static void put_le16(unsigned char* p, uint16_t v) {
+    p[0] = (unsigned char)v;
+    p[1] = (unsigned char)(v >> 8);
+}
+
+static void put_le32(unsigned char* p, uint32_t v) {
+    put_le16(p, (uint16_t)v);
+    put_le16(p + 2, (uint16_t)(v >> 16));
+}
+
+static void put_le64(unsigned char* p, uint64_t v) {
+    put_le32(p, (uint32_t)v);
+    put_le32(p + 4, (uint32_t)(v >> 32));
+}
+
+/* The header as it stands for data_bytes of samples; sizes past the RIFF limit go to ds64 */
+static size_t build_header(const UCRA_WavWriter* writer, unsigned char* out) {
+    uint64_t pad = writer->data_bytes & 1;
+    uint64_t riff_size = writer->header_bytes - 8 + writer->data_bytes + pad;
+    int rf64 = riff_size > WAV_RIFF_LIMIT;
+    unsigned char* p = out;
+
+    memcpy(p, rf64 ? "RF64" : "RIFF", 4);
+    put_le32(p + 4, rf64 ? (uint32_t)WAV_RIFF_LIMIT : (uint32_t)riff_size);
+    memcpy(p + 8, "WAVE", 4);
+    p += 12;
+
+    if (writer->header_bytes == WAV_RF64_HEADER_BYTES) {
+        memset(p, 0, 8 + WAV_DS64_BODY_BYTES);
+        memcpy(p, rf64 ? "ds64" : "JUNK", 4);
+        put_le32(p + 4, WAV_DS64_BODY_BYTES);
+        if (rf64) {
+            put_le64(p + 8, riff_size);
+            put_le64(p + 16, writer->data_bytes);
+            put_le64(p + 24, writer->frames);
+            /* no table entries follow */
+        }
+        p += 8 + WAV_DS64_BODY_BYTES;
+    }
+
+    uint32_t block_align = writer->channels * writer->sample_bytes;
+    memcpy(p, "fmt ", 4);
+    put_le32(p + 4, 16);
+    put_le16(p + 8, writer->format == UCRA_SAMPLE_FLOAT32 ? WAV_FORMAT_FLOAT : WAV_FORMAT_PCM);
+    put_le16(p + 10, (uint16_t)writer->channels);
+    put_le32(p + 12, writer->sample_rate);
+    put_le32(p + 16, writer->sample_rate * block_align);
+    put_le16(p + 20, (uint16_t)block_align);
+    put_le16(p + 22, (uint16_t)(writer->sample_bytes * 8));
+    p += 24;
+
+    memcpy(p, "data", 4);
+    put_le32(p + 4, rf64 ? (uint32_t)WAV_RIFF_LIMIT : (uint32_t)writer->data_bytes);
+    return (size_t)(p + 8 - out);
+}
+
+static void flush_buffer(UCRA_WavWriter* writer) {
+    if (writer->used > 0 && writer->status == UCRA_SUCCESS &&
+        fwrite(writer->buffer, 1, writer->used, writer->file) != writer->used) {
+        writer->status = UCRA_ERR_INTERNAL;
+    }
+    writer->used = 0;
+}
+
+static void append_bytes(UCRA_WavWriter* writer, const void* bytes, size_t size) {
+    if (writer->used + size > WAV_WRITER_BUFFER_BYTES) {
+        flush_buffer(writer);
+    }
+    if (size >= WAV_WRITER_BUFFER_BYTES) {
+        /* a block at least as large as the buffer goes straight to the file */
+        if (writer->status == UCRA_SUCCESS && fwrite(bytes, 1, size, writer->file) != size) {
+            writer->status = UCRA_ERR_INTERNAL;
+        }
+        return;
+    }
+    memcpy(writer->buffer + writer->used, bytes, size);
+    writer->used += size;
+}
+
+/* Triangular noise in (-1, 1) LSB: the sum of two uniform values */
+static void fill_dither(UCRA_WavWriter* writer, uint32_t n) {
+    uint32_t x = writer->random;
+    for (uint32_t i = 0; i < n; i++) {
+        x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+        float a = (float)(x >> 8) * (1.0f / 16777216.0f);
+        x ^= x << 13; x ^= x >> 17; x ^= x << 5;
+        float b = (float)(x >> 8) * (1.0f / 16777216.0f);
+        writer->dither[i] = a + b - 1.0f;
+    }
+    writer->random = x;
+}
+
+/* Quantize samples into the buffer as little-endian 16- or 24-bit integers */
+static void append_quantized(UCRA_WavWriter* writer, const float* pcm, uint64_t samples) {
+    const UCRA_Kernels* kernels = ucra_kernels();
+    int pcm24 = writer->format == UCRA_SAMPLE_PCM24;
+    float scale = pcm24 ? 8388608.0f : 32768.0f;
+    while (samples > 0 && writer->status == UCRA_SUCCESS) {
+        uint32_t n = samples < WAV_WRITER_CHUNK ? (uint32_t)samples : WAV_WRITER_CHUNK;
+        if (writer->dither) fill_dither(writer, n);
+        kernels->quantize(writer->quantized, pcm, writer->dither, n, scale, scale - 1.0f);
+
+        if (writer->used + (size_t)n * writer->sample_bytes > WAV_WRITER_BUFFER_BYTES) {
+            flush_buffer(writer);
+        }
+        unsigned char* out = writer->buffer + writer->used;
+        if (pcm24) {
+            for (uint32_t i = 0; i < n; i++) {
+                uint32_t v = (uint32_t)writer->quantized[i];
+                out[3 * i] = (unsigned char)v;
+                out[3 * i + 1] = (unsigned char)(v >> 8);
+                out[3 * i + 2] = (unsigned char)(v >> 16);
+            }
+        } else {
+            for (uint32_t i = 0; i < n; i++) {
+                put_le16(out + 2 * i, (uint16_t)writer->quantized[i]);
+            }
+        }
+        writer->used += (size_t)n * writer->sample_bytes;
+        pcm += n;
+        samples -= n;
+    }
+}
+
+static void free_writer(UCRA_WavWriter* writer) {
+    free(writer->buffer);
+    free(writer->quantized);
+    free(writer->dither);
+    free(writer);
+}
+
+UCRA_Result ucra_wav_writer_open(UCRA_WavWriterHandle* out_writer,
+                                 const char* path,
+                                 uint32_t sample_rate,
+                                 uint32_t channels,
+                                 UCRA_SampleFormat format,
+                                 uint32_t flags) {
+    if (!out_writer) {
+        return UCRA_ERR_INVALID_ARGUMENT;
+    }
+    *out_writer = NULL;
+    uint32_t sample_bytes = format == UCRA_SAMPLE_FLOAT32 ? 4 : format == UCRA_SAMPLE_PCM16 ? 2
+                          : format == UCRA_SAMPLE_PCM24 ? 3 : 0;
+    /* block align is 16 bits and the byte rate 32 bits */
+    if (!path || sample_rate == 0 || channels == 0 || sample_bytes == 0 ||
+        channels > 0xFFFFu || channels * sample_bytes > 0xFFFFu || (uint64_t)sample_rate * channels * sample_bytes > 0xFFFFFFFFull) {
+        return UCRA_ERR_INVALID_ARGUMENT;
+    }
+
+    UCRA_WavWriter* writer = calloc(1, sizeof(UCRA_WavWriter));
+    if (!writer) {
+        return UCRA_ERR_OUT_OF_MEMORY;
+    }
+    writer->sample_rate = sample_rate;
+    writer->channels = channels;
+    writer->format = format;
+    writer->flags = flags;
+    writer->sample_bytes = sample_bytes;
+    writer->header_bytes = (flags & UCRA_WAV_RF64) ? WAV_RF64_HEADER_BYTES : WAV_PLAIN_HEADER_BYTES;
+    writer->random = WAV_DITHER_SEED;
+    writer->buffer = malloc(WAV_WRITER_BUFFER_BYTES);
+    int ok = writer->buffer != NULL;
+    if (format != UCRA_SAMPLE_FLOAT32) {
+        writer->quantized = malloc(WAV_WRITER_CHUNK * sizeof(int32_t));
+        ok = ok && writer->quantized;
+        /* at 24 bits the dither would be below the precision of the float sums it is added to */
+        if (format == UCRA_SAMPLE_PCM16 && !(flags & UCRA_WAV_NO_DITHER)) {
+            writer->dither = malloc(WAV_WRITER_CHUNK * sizeof(float));
+            ok = ok && writer->dither;
+        }
+    }
+    if (!ok) {
+        free_writer(writer);
+        return UCRA_ERR_OUT_OF_MEMORY;
+    }
+
+    writer->file = fopen(path, "wb");
+    if (!writer->file) {
+        free_writer(writer);
+        return UCRA_ERR_FILE_NOT_FOUND;
+    }
+    setvbuf(writer->file, NULL, _IONBF, 0); /* the writer buffers itself */
+
+    /* a placeholder with empty sizes until close */
+    unsigned char header[WAV_RF64_HEADER_BYTES];
+    append_bytes(writer, header, build_header(writer, header));
+
+    *out_writer = (UCRA_WavWriterHandle)writer;
+    return UCRA_SUCCESS;
+}
+
+UCRA_Result ucra_wav_writer_write(UCRA_WavWriterHandle handle, const float* pcm, uint64_t frames) {
+    UCRA_WavWriter* writer = (UCRA_WavWriter*)handle;
+    if (!writer || (frames > 0 && !pcm)) {
+        return UCRA_ERR_INVALID_ARGUMENT;
+    }
+    if (writer->status != UCRA_SUCCESS || frames == 0) {
+        return writer->status;
+    }
+
+    uint64_t frame_bytes = (uint64_t)writer->channels * writer->sample_bytes;
+    if (frames > (UINT64_MAX / 2 - writer->data_bytes) / frame_bytes ||
+        frames > SIZE_MAX / sizeof(float) / writer->channels) {
+        return UCRA_ERR_INVALID_ARGUMENT;
+    }
+    uint64_t samples = frames * writer->channels;
+    uint64_t bytes = frames * frame_bytes;
+    uint64_t riff_size = writer->header_bytes - 8 + writer->data_bytes + bytes + 1;
+    if (!(writer->flags & UCRA_WAV_RF64) && riff_size > WAV_RIFF_LIMIT) {
+        writer->status = UCRA_ERR_NOT_SUPPORTED;
+        return writer->status;
+    }
+
+    if (writer->format == UCRA_SAMPLE_FLOAT32) {
+        append_bytes(writer, pcm, (size_t)bytes); /* little-endian hosts, as the format */
+    } else {
+        append_quantized(writer, pcm, samples);
+    }
+    writer->frames += frames;
+    writer->data_bytes += bytes;
+    return writer->status;
+}
+
+uint64_t ucra_wav_writer_frames(UCRA_WavWriterHandle handle) {
+    const UCRA_WavWriter* writer = (const UCRA_WavWriter*)handle;
+    return writer ? writer->frames : 0;
+}
+
+UCRA_Result ucra_wav_writer_close(UCRA_WavWriterHandle handle) {
+    UCRA_WavWriter* writer = (UCRA_WavWriter*)handle;
+    if (!writer) {
+        return UCRA_ERR_INVALID_ARGUMENT;
+    }
+
+    if (writer->data_bytes & 1) {
+        unsigned char pad = 0; /* chunks are word aligned */
+        append_bytes(writer, &pad, 1);
+    }
+    flush_buffer(writer);
+    if (writer->status == UCRA_SUCCESS) {
+        unsigned char header[WAV_RF64_HEADER_BYTES];
+        size_t size = build_header(writer, header);
+        if (fseek(writer->file, 0, SEEK_SET) != 0 || fwrite(header, 1, size, writer->file) != size) {
+            writer->status = UCRA_ERR_INTERNAL;
+        }
+    }
+    if (fclose(writer->file) != 0 && writer->status == UCRA_SUCCESS) {
+        writer->status = UCRA_ERR_INTERNAL;
+    }
+
+    UCRA_Result result = writer->status;
+    free_writer(writer);
+    return result;
+}
@@ -0,0 +1,38 @@
+/*
+ * UCRA WORLD Sample Analysis (internal)
+ * Full WORLD analysis of a recorded sample for the analysis cache, and the F0
+ * step alone for the tools. Only available when UCRA_HAS_WORLD is defined.
+ */
+#ifndef UCRA_WORLD_ANALYSIS_H
+#define UCRA_WORLD_ANALYSIS_H
+
+#include "ucra_analysis.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief UCRA_AnalyzeFn running Harvest or DIO + StoneMask, CheapTrick and D4C
+ *
+ * ctx is the const UCRA_AnalysisOptions* to analyze with. Reentrant, so
+ * samples can be analyzed on several threads at once.
+ */
+UCRA_Result ucra_world_analyze(void* ctx, const float* samples, uint32_t length,
+                               uint32_t sample_rate, UCRA_AnalysisData* out);
+
+/**
+ * @brief Estimate only the F0 track of samples, as ucra_world_analyze() does
+ * @param out_f0 Receives a malloc'd array with one value per options->frame_period
+ *        milliseconds from time 0, 0 for unvoiced frames; free() it
+ * @param out_frames Number of values in out_f0
+ * @return UCRA_SUCCESS, UCRA_ERR_INVALID_ARGUMENT or UCRA_ERR_OUT_OF_MEMORY
+ */
+UCRA_Result ucra_world_estimate_f0(const UCRA_AnalysisOptions* options, const float* samples, uint32_t length,
+                                   uint32_t sample_rate, float** out_f0, uint32_t* out_frames);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* UCRA_WORLD_ANALYSIS_H */
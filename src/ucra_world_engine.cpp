@@ -4,6 +4,18 @@
  */
 
 #include "ucra/ucra.h"
+#include "ucra_analysis.h"
+#include "ucra_curve.h"
+#include "ucra_engine_loader.h"
+#include "ucra_options.h"
+#include "ucra_threads.h"
+#include "ucra_trace.h"
+#include "ucra_world_analysis.h"
+#include "ucra_world_stream.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
 #include <cstdlib>
 #include <cstring>
 #include <cmath>
@@ -26,8 +38,75 @@ extern "C" {
 
 #ifdef UCRA_HAS_WORLD
 
-/* Internal WORLD engine state */
+/* Alignment of the spectrogram/aperiodicity arena and of each of its rows, in bytes */
+#define UCRA_WORLD_ARENA_ALIGN 64
+
+/*
+ * Backing store for the frame_count x (fft_size/2+1) spectrogram and aperiodicity
+ * matrices: one aligned block plus row pointers in the double** form Synthesis()
+ * takes. Grows only when a render needs more, so steady-state renders allocate nothing.
+ */
+typedef struct UCRA_WorldArena {
+    void* block;         /* raw allocation, freed with free() */
+    double* data;        /* block rounded up to UCRA_WORLD_ARENA_ALIGN */
+    size_t capacity;     /* doubles available from data */
+    double** rows;       /* spectrogram rows, then aperiodicity rows */
+    size_t row_capacity;
+} UCRA_WorldArena;
+
+/* Harmonic envelope templates kept per worker, and the F0 step they are quantized to */
+#define UCRA_WORLD_ENV_CACHE_SLOTS 64
+#define UCRA_WORLD_ENV_F0_STEP 0.0625
+
+/*
+ * Direct-mapped cache of voiced-frame spectral envelopes keyed by quantized F0.
+ * Templates depend on the sample rate and FFT size too, so a change of either
+ * empties the cache. Memory is bounded at UCRA_WORLD_ENV_CACHE_SLOTS rows.
+ */
+typedef struct UCRA_EnvelopeCache {
+    double* templates;   /* UCRA_WORLD_ENV_CACHE_SLOTS rows of bins doubles */
+    int bins;            /* row length templates was allocated for */
+    double sample_rate;
+    int fft_size;
+    int64_t keys[UCRA_WORLD_ENV_CACHE_SLOTS]; /* quantized F0 per slot, -1 when empty */
+    uint64_t hits;
+    uint64_t misses;
+} UCRA_EnvelopeCache;
+
+/* Per-thread synthesis state; every buffer only grows */
+typedef struct UCRA_WorldScratch {
+    UCRA_WorldArena arena;
+    UCRA_EnvelopeCache envelopes;
+    double* f0;             /* per-frame F0 handed to Synthesis() */
+    size_t f0_capacity;
+    double* audio;          /* Synthesis() output before float conversion */
+    size_t audio_capacity;
+} UCRA_WorldScratch;
+
+/* Sample rates whose CheapTrick settings an engine keeps */
+#define UCRA_WORLD_RATE_CACHE 4
+
+/* CheapTrick settings derived for one sample rate */
+typedef struct UCRA_WorldRate {
+    double sample_rate;  /* 0 for an empty entry */
+    int fft_size;
+    CheapTrickOption cheaptrick_option;
+} UCRA_WorldRate;
+
+/* Engine option selecting the batch worker count (0 = one per CPU) */
+#define UCRA_RENDER_THREADS_OPTION "render_threads"
+
+/* Engine option selecting the analysis frames per synthesis window (0 = the whole render at once) */
+#define UCRA_WORLD_CHUNK_OPTION "synthesis_chunk_frames"
+#define UCRA_WORLD_CHUNK_MAX (1 << 20)
+
+/*
+ * Internal WORLD engine state. Every handle owns its options and scratch, so
+ * separate handles can render concurrently on separate threads; a single
+ * handle must not be used from two threads at once.
+ */
 typedef struct UCRA_WorldEngine {
+    uint32_t kind; /* UCRA_ENGINE_KIND_BUILTIN; see ucra_engine_loader.h */
     double sample_rate;
     int fft_size;
     double frame_period; /* Frame period in milliseconds */
@@ -49,10 +128,51 @@ typedef struct UCRA_WorldEngine {
     size_t last_pcm_size;
     UCRA_KeyValue* last_metadata;
     size_t last_metadata_count;
+
+    /* ucra_render_batch() outputs, one arena shared by all jobs */
+    float* batch_pcm;
+    size_t batch_pcm_size;
+    size_t* batch_offsets;
+    uint32_t batch_offsets_capacity;
+
+    /* Settings for recently used sample rates, so alternating rates skip re-initialization */
+    UCRA_WorldRate rates[UCRA_WORLD_RATE_CACHE];
+    uint32_t next_rate; /* entry replaced on the next miss */
+
+    /* Workers for ucra_render_batch() and chunked renders, started on first use */
+    uint32_t pool_threads;
+    UCRA_ThreadPool* pool;
+
+    /* Long renders synthesize in windows of this many analysis frames; 0 for one pass */
+    int chunk_frames;
+
+    /* Voicebank samples, analyzed by WORLD once and cached next to the WAVs */
+    char* voicebank;
+    UCRA_AnalysisStore* analysis;
+    UCRA_AnalysisOptions analysis_options; /* context of ucra_world_analyze() */
+
+    /* Synthesis scratch: [0] serves ucra_render()/ucra_render_into(), batches use one per worker */
+    UCRA_WorldScratch* scratch;
+    uint32_t scratch_count;
+
+    /* Envelope cache counters reported in the result metadata */
+    UCRA_KeyValue cache_metadata[2];
+    char cache_metadata_values[2][24];
+
+    /* ucra_render_block(): a realtime synthesizer positioned at block_next_frame */
+    UCRA_WorldStream* block_stream;
+    uint64_t block_next_frame;
 } UCRA_WorldEngine;
 
-/* Global engine instance (for simplicity - in production might want multiple) */
-static UCRA_WorldEngine* g_world_engine = nullptr;
+/* Analysis/synthesis settings a single render runs with */
+typedef struct UCRA_WorldParams {
+    double sample_rate;
+    double frame_period;
+    int fft_size;
+    int chunk_frames;             /* analysis frames per synthesis window, 0 for one pass */
+    UCRA_AnalysisStore* analysis; /* voicebank sample analyses, or nullptr */
+    const char* voicebank;        /* directory holding "<lyric>.wav" samples */
+} UCRA_WorldParams;
 
 /* Helper function to convert MIDI note to frequency */
 static double midi_note_to_frequency(int16_t midi_note) {
@@ -62,21 +182,17 @@ static double midi_note_to_frequency(int16_t midi_note) {
     return 440.0 * std::pow(2.0, (midi_note - 69) / 12.0);
 }
 
-/* Convert UCRA note segments to WORLD-compatible F0 and time arrays */
-static void prepare_world_f0_data(const UCRA_NoteSegment* notes, uint32_t note_count,
-                                  double sample_rate, double frame_period_ms,
-                                  double total_duration_sec,
-                                  std::vector<double>& f0_array,
-                                  std::vector<double>& time_array) {
-    /* Calculate number of frames */
-    int frame_count = static_cast<int>(1000.0 * total_duration_sec / frame_period_ms) + 1;
-
-    f0_array.resize(frame_count, 0.0);
-    time_array.resize(frame_count);
+/* Number of WORLD analysis frames covering total_duration_sec */
+static int compute_frame_count(double total_duration_sec, double frame_period_ms) {
+    return static_cast<int>(1000.0 * total_duration_sec / frame_period_ms) + 1;
+}
 
-    /* Fill time array */
+/* Convert UCRA note segments to a WORLD-compatible F0 array of frame_count frames */
+static void prepare_world_f0_data(const UCRA_NoteSegment* notes, uint32_t note_count,
+                                  double frame_period_ms, int frame_count,
+                                  UCRA_CurveInterp interp, double* f0_array) {
     for (int i = 0; i < frame_count; i++) {
-        time_array[i] = i * frame_period_ms / 1000.0;
+        f0_array[i] = 0.0;
     }
 
     /* Fill F0 array based on note segments */
@@ -96,29 +212,148 @@ static void prepare_world_f0_data(const UCRA_NoteSegment* notes, uint32_t note_c
         end_frame = std::max(0, std::min(end_frame, frame_count - 1));
 
         /* Fill F0 for this note */
-        for (int frame = start_frame; frame <= end_frame; frame++) {
-            if (note->f0_override && note->f0_override->length > 0) {
-                /* Use F0 override if available */
-                double relative_time = time_array[frame] - note->start_sec;
-                /* Simple linear interpolation for F0 override */
+        if (note->f0_override && note->f0_override->length > 0) {
+            /* Use F0 override if available; frames advance monotonically through the curve */
+            UCRA_CurveCursor cursor;
+            ucra_curve_cursor_f0(&cursor, note->f0_override);
+            if (!ucra_curve_valid(&cursor)) continue;
+            for (int frame = start_frame; frame <= end_frame; frame++) {
+                double relative_time = frame * frame_period_ms / 1000.0 - note->start_sec;
                 if (relative_time >= 0 && relative_time <= note->duration_sec) {
-                    /* Find closest point in F0 curve */
-                    uint32_t curve_idx = 0;
-                    for (uint32_t i = 0; i < note->f0_override->length - 1; i++) {
-                        if (note->f0_override->time_sec[i] <= relative_time) {
-                            curve_idx = i;
-                        }
-                    }
-                    f0_array[frame] = note->f0_override->f0_hz[curve_idx];
+                    f0_array[frame] = ucra_curve_sample(&cursor, interp, relative_time);
                 }
-            } else {
-                /* Use MIDI note frequency */
+            }
+        } else {
+            /* Use MIDI note frequency */
+            for (int frame = start_frame; frame <= end_frame; frame++) {
                 f0_array[frame] = note_f0;
             }
         }
     }
 }
 
+/* Harvest, or DIO refined by StoneMask, over x; temporal_positions and f0 are sized to the frame count */
+static void estimate_f0(const UCRA_AnalysisOptions* options, const std::vector<double>& x, int fs,
+                        std::vector<double>& temporal_positions, std::vector<double>& f0) {
+    int x_length = static_cast<int>(x.size());
+    double frame_period = options->frame_period;
+    bool use_dio = options->f0_method == UCRA_ANALYSIS_F0_DIO;
+    int f0_length = use_dio ? GetSamplesForDIO(fs, x_length, frame_period)
+                            : GetSamplesForHarvest(fs, x_length, frame_period);
+    temporal_positions.assign(f0_length, 0.0);
+    f0.assign(f0_length, 0.0);
+    if (use_dio) {
+        DioOption dio_option;
+        InitializeDioOption(&dio_option);
+        dio_option.frame_period = frame_period;
+        dio_option.f0_floor = options->f0_floor;
+        dio_option.f0_ceil = options->f0_ceil;
+        std::vector<double> raw_f0(f0_length);
+        Dio(x.data(), x_length, fs, &dio_option, temporal_positions.data(), raw_f0.data());
+        StoneMask(x.data(), x_length, fs, temporal_positions.data(), raw_f0.data(), f0_length, f0.data());
+    } else {
+        HarvestOption harvest_option;
+        InitializeHarvestOption(&harvest_option);
+        harvest_option.frame_period = frame_period;
+        harvest_option.f0_floor = options->f0_floor;
+        harvest_option.f0_ceil = options->f0_ceil;
+        Harvest(x.data(), x_length, fs, &harvest_option, temporal_positions.data(), f0.data());
+    }
+}
+
+UCRA_Result ucra_world_estimate_f0(const UCRA_AnalysisOptions* options, const float* samples, uint32_t length,
+                                   uint32_t sample_rate, float** out_f0, uint32_t* out_frames) {
+    if (out_f0) *out_f0 = nullptr;
+    if (out_frames) *out_frames = 0;
+    if (!options || !samples || !out_f0 || !out_frames || length == 0 || sample_rate == 0) {
+        return UCRA_ERR_INVALID_ARGUMENT;
+    }
+    try {
+        std::vector<double> x(samples, samples + length);
+        std::vector<double> temporal_positions, f0;
+        estimate_f0(options, x, static_cast<int>(sample_rate), temporal_positions, f0);
+        float* f0_out = static_cast<float*>(malloc((f0.size() + 1) * sizeof(float)));
+        if (!f0_out) {
+            return UCRA_ERR_OUT_OF_MEMORY;
+        }
+        for (size_t i = 0; i < f0.size(); i++) {
+            f0_out[i] = static_cast<float>(f0[i]);
+        }
+        *out_f0 = f0_out;
+        *out_frames = static_cast<uint32_t>(f0.size());
+    } catch (...) {
+        return UCRA_ERR_OUT_OF_MEMORY;
+    }
+    return UCRA_SUCCESS;
+}
+
+UCRA_Result ucra_world_analyze(void* ctx, const float* samples, uint32_t length,
+                               uint32_t sample_rate, UCRA_AnalysisData* out) {
+    const UCRA_AnalysisOptions* options = static_cast<const UCRA_AnalysisOptions*>(ctx);
+    if (!options || !samples || !out || length == 0 || sample_rate == 0) {
+        return UCRA_ERR_INVALID_ARGUMENT;
+    }
+    int fs = static_cast<int>(sample_rate);
+    int x_length = static_cast<int>(length);
+    double frame_period = options->frame_period;
+
+    try {
+        std::vector<double> x(samples, samples + length);
+        std::vector<double> temporal_positions, f0;
+        estimate_f0(options, x, fs, temporal_positions, f0);
+        int f0_length = static_cast<int>(f0.size());
+
+        CheapTrickOption cheaptrick_option;
+        InitializeCheapTrickOption(fs, &cheaptrick_option);
+        int fft_size = GetFFTSizeForCheapTrick(fs, &cheaptrick_option);
+        int bins = fft_size / 2 + 1;
+        D4COption d4c_option;
+        InitializeD4COption(&d4c_option);
+
+        std::vector<double> spectrogram_data(static_cast<size_t>(f0_length) * bins);
+        std::vector<double> aperiodicity_data(static_cast<size_t>(f0_length) * bins);
+        std::vector<double*> spectrogram(f0_length), aperiodicity(f0_length);
+        for (int i = 0; i < f0_length; i++) {
+            spectrogram[i] = spectrogram_data.data() + static_cast<size_t>(i) * bins;
+            aperiodicity[i] = aperiodicity_data.data() + static_cast<size_t>(i) * bins;
+        }
+        CheapTrick(x.data(), x_length, fs, temporal_positions.data(), f0.data(), f0_length,
+                   &cheaptrick_option, spectrogram.data());
+        D4C(x.data(), x_length, fs, temporal_positions.data(), f0.data(), f0_length, fft_size,
+            &d4c_option, aperiodicity.data());
+
+        size_t cells = static_cast<size_t>(f0_length) * bins;
+        float* f0_out = static_cast<float*>(malloc(f0_length * sizeof(float)));
+        float* sp_out = static_cast<float*>(malloc(cells * sizeof(float)));
+        float* ap_out = static_cast<float*>(malloc(cells * sizeof(float)));
+        if (!f0_out || !sp_out || !ap_out) {
+            free(f0_out);
+            free(sp_out);
+            free(ap_out);
+            return UCRA_ERR_OUT_OF_MEMORY;
+        }
+        for (int i = 0; i < f0_length; i++) {
+            f0_out[i] = static_cast<float>(f0[i]);
+        }
+        for (size_t i = 0; i < cells; i++) {
+            sp_out[i] = static_cast<float>(spectrogram_data[i]);
+            ap_out[i] = static_cast<float>(aperiodicity_data[i]);
+        }
+
+        out->sample_rate = sample_rate;
+        out->frame_period = frame_period;
+        out->frame_count = static_cast<uint32_t>(f0_length);
+        out->bins = static_cast<uint32_t>(bins);
+        out->f0 = f0_out;
+        out->spectrogram = sp_out;
+        out->aperiodicity = ap_out;
+    } catch (...) {
+        /* the store and the tool call this from worker threads */
+        return UCRA_ERR_OUT_OF_MEMORY;
+    }
+    return UCRA_SUCCESS;
+}
+
 UCRA_Result ucra_engine_create(UCRA_Handle* outEngine,
                                const UCRA_KeyValue* options,
                                uint32_t option_count) {
@@ -126,41 +361,34 @@ UCRA_Result ucra_engine_create(UCRA_Handle* outEngine,
         return UCRA_ERR_INVALID_ARGUMENT;
     }
 
-    /* For simplicity, create a single global engine instance */
-    if (g_world_engine != nullptr) {
-        *outEngine = reinterpret_cast<UCRA_Handle>(g_world_engine);
-        return UCRA_SUCCESS;
-    }
+    *outEngine = nullptr;
 
-    /* Allocate engine state */
-    g_world_engine = static_cast<UCRA_WorldEngine*>(malloc(sizeof(UCRA_WorldEngine)));
-    if (!g_world_engine) {
+    /* Allocate engine state; each call gets an independent instance */
+    UCRA_WorldEngine* world_engine = static_cast<UCRA_WorldEngine*>(calloc(1, sizeof(UCRA_WorldEngine)));
+    if (!world_engine) {
         return UCRA_ERR_OUT_OF_MEMORY;
     }
 
     /* Initialize with default parameters */
-    g_world_engine->sample_rate = 44100.0;
-    g_world_engine->frame_period = 5.0; /* 5ms frame period */
+    world_engine->sample_rate = 44100.0;
+    world_engine->frame_period = 5.0; /* 5ms frame period */
 
     /* Initialize WORLD analysis options */
-    InitializeDioOption(&g_world_engine->dio_option);
-    InitializeHarvestOption(&g_world_engine->harvest_option);
-    InitializeCheapTrickOption(static_cast<int>(g_world_engine->sample_rate), &g_world_engine->cheaptrick_option);
-    InitializeD4COption(&g_world_engine->d4c_option);
+    InitializeDioOption(&world_engine->dio_option);
+    InitializeHarvestOption(&world_engine->harvest_option);
+    InitializeCheapTrickOption(static_cast<int>(world_engine->sample_rate), &world_engine->cheaptrick_option);
+    InitializeD4COption(&world_engine->d4c_option);
 
     /* Get FFT size from CheapTrick option */
-    g_world_engine->fft_size = GetFFTSizeForCheapTrick(static_cast<int>(g_world_engine->sample_rate), &g_world_engine->cheaptrick_option);
-    g_world_engine->synthesis_frame_period = static_cast<int>(g_world_engine->frame_period);
+    world_engine->fft_size = GetFFTSizeForCheapTrick(static_cast<int>(world_engine->sample_rate), &world_engine->cheaptrick_option);
+    world_engine->synthesis_frame_period = static_cast<int>(world_engine->frame_period);
 
     /* Set frame period for DIO and Harvest options */
-    g_world_engine->dio_option.frame_period = g_world_engine->frame_period;
-    g_world_engine->harvest_option.frame_period = g_world_engine->frame_period;
+    world_engine->dio_option.frame_period = world_engine->frame_period;
+    world_engine->harvest_option.frame_period = world_engine->frame_period;
 
-    /* Initialize memory for results */
-    g_world_engine->last_pcm = nullptr;
-    g_world_engine->last_pcm_size = 0;
-    g_world_engine->last_metadata = nullptr;
-    g_world_engine->last_metadata_count = 0;
+    /* Result buffers and the batch pool start empty (calloc) and grow on demand */
+    world_engine->pool_threads = ucra_cpu_count();
 
     /* Process options if provided */
     for (uint32_t i = 0; i < option_count; i++) {
@@ -171,33 +399,67 @@ UCRA_Result ucra_engine_create(UCRA_Handle* outEngine,
             if (strcmp(key, "sample_rate") == 0) {
                 double sr = atof(value);
                 if (sr > 0) {
-                    g_world_engine->sample_rate = sr;
-                    InitializeCheapTrickOption(static_cast<int>(sr), &g_world_engine->cheaptrick_option);
-                    g_world_engine->fft_size = GetFFTSizeForCheapTrick(static_cast<int>(sr), &g_world_engine->cheaptrick_option);
+                    world_engine->sample_rate = sr;
+                    InitializeCheapTrickOption(static_cast<int>(sr), &world_engine->cheaptrick_option);
+                    world_engine->fft_size = GetFFTSizeForCheapTrick(static_cast<int>(sr), &world_engine->cheaptrick_option);
                 }
             } else if (strcmp(key, "frame_period") == 0) {
                 double fp = atof(value);
                 if (fp > 0) {
-                    g_world_engine->frame_period = fp;
-                    g_world_engine->synthesis_frame_period = static_cast<int>(fp);
-                    g_world_engine->dio_option.frame_period = fp;
-                    g_world_engine->harvest_option.frame_period = fp;
+                    world_engine->frame_period = fp;
+                    world_engine->synthesis_frame_period = static_cast<int>(fp);
+                    world_engine->dio_option.frame_period = fp;
+                    world_engine->harvest_option.frame_period = fp;
+                }
+            } else if (strcmp(key, UCRA_RENDER_THREADS_OPTION) == 0) {
+                long n = strtol(value, nullptr, 10);
+                world_engine->pool_threads = n > 0 ? static_cast<uint32_t>(n) : (n == 0 ? ucra_cpu_count() : 1);
+            } else if (strcmp(key, UCRA_WORLD_CHUNK_OPTION) == 0) {
+                long n = strtol(value, nullptr, 10);
+                world_engine->chunk_frames = n > 0 ? static_cast<int>(std::min<long>(n, UCRA_WORLD_CHUNK_MAX)) : 0;
+            } else if (strcmp(key, "voicebank") == 0 && !world_engine->voicebank) {
+                world_engine->voicebank = static_cast<char*>(malloc(strlen(value) + 1));
+                if (!world_engine->voicebank) {
+                    ucra_engine_destroy(reinterpret_cast<UCRA_Handle>(world_engine));
+                    return UCRA_ERR_OUT_OF_MEMORY;
                 }
+                strcpy(world_engine->voicebank, value);
+            } else if (strcmp(key, "f0_estimator") == 0) {
+                world_engine->analysis_options.f0_method =
+                    strcmp(value, "dio") == 0 ? UCRA_ANALYSIS_F0_DIO : UCRA_ANALYSIS_F0_HARVEST;
             }
         }
     }
 
+    /* Analysis settings follow the synthesis frame period, so sample frames line up */
+    if (world_engine->voicebank) {
+        world_engine->analysis_options.frame_period = world_engine->frame_period;
+        world_engine->analysis_options.f0_floor = UCRA_ANALYSIS_DEFAULT_F0_FLOOR;
+        world_engine->analysis_options.f0_ceil = UCRA_ANALYSIS_DEFAULT_F0_CEIL;
+        UCRA_Result result = ucra_analysis_store_create(&world_engine->analysis_options, ucra_world_analyze,
+                                                        &world_engine->analysis_options, &world_engine->analysis);
+        if (result != UCRA_SUCCESS) {
+            ucra_engine_destroy(reinterpret_cast<UCRA_Handle>(world_engine));
+            return result;
+        }
+    }
+
     /* Prepare engine info string */
-    snprintf(g_world_engine->engine_info, sizeof(g_world_engine->engine_info),
+    snprintf(world_engine->engine_info, sizeof(world_engine->engine_info),
              "WORLD Vocoder Engine v1.0 (sample_rate=%.1f, frame_period=%.1f)",
-             g_world_engine->sample_rate, g_world_engine->frame_period);
+             world_engine->sample_rate, world_engine->frame_period);
 
-    *outEngine = reinterpret_cast<UCRA_Handle>(g_world_engine);
+    *outEngine = reinterpret_cast<UCRA_Handle>(world_engine);
     return UCRA_SUCCESS;
 }
 
 void ucra_engine_destroy(UCRA_Handle engine) {
-    if (!engine || engine != reinterpret_cast<UCRA_Handle>(g_world_engine)) {
+    const UCRA_LoadedEngine* loaded = ucra_loaded_engine(engine);
+    if (loaded) {
+        ucra_loaded_engine_destroy(loaded);
+        return;
+    }
+    if (!engine) {
         return;
     }
 
@@ -214,14 +476,36 @@ void ucra_engine_destroy(UCRA_Handle engine) {
         world_engine->last_metadata = nullptr;
     }
 
+    free(world_engine->batch_pcm);
+    free(world_engine->batch_offsets);
+    for (uint32_t i = 0; i < world_engine->scratch_count; i++) {
+        free(world_engine->scratch[i].arena.block);
+        free(world_engine->scratch[i].arena.rows);
+        free(world_engine->scratch[i].envelopes.templates);
+        free(world_engine->scratch[i].f0);
+        free(world_engine->scratch[i].audio);
+    }
+    free(world_engine->scratch);
+    if (world_engine->pool) {
+        ucra_pool_destroy(world_engine->pool);
+    }
+    ucra_world_stream_destroy(world_engine->block_stream);
+    ucra_analysis_store_destroy(world_engine->analysis);
+    free(world_engine->voicebank);
+
     /* Free engine state */
     free(world_engine);
-    g_world_engine = nullptr;
 }
 
 UCRA_Result ucra_engine_getinfo(UCRA_Handle engine,
                                 char* outBuffer,
                                 size_t buffer_size) {
+    const UCRA_LoadedEngine* loaded = ucra_loaded_engine(engine);
+    if (loaded) {
+        return UCRA_ENGINE_TABLE_HAS(loaded->table, engine_getinfo)
+                   ? loaded->table->engine_getinfo(loaded->inner, outBuffer, buffer_size)
+                   : UCRA_ERR_NOT_SUPPORTED;
+    }
     if (!engine || !outBuffer || buffer_size == 0) {
         return UCRA_ERR_INVALID_ARGUMENT;
     }
@@ -237,23 +521,209 @@ UCRA_Result ucra_engine_getinfo(UCRA_Handle engine,
     return UCRA_SUCCESS;
 }
 
-UCRA_Result ucra_render(UCRA_Handle engine,
-                        const UCRA_RenderConfig* config,
-                        UCRA_RenderResult* outResult) {
-    if (!engine || !config || !outResult) {
-        return UCRA_ERR_INVALID_ARGUMENT;
+/* CheapTrick settings for sample_rate, or nullptr if the engine has not seen the rate recently */
+static const UCRA_WorldRate* find_rate(const UCRA_WorldEngine* world_engine, double sample_rate) {
+    for (int i = 0; i < UCRA_WORLD_RATE_CACHE; i++) {
+        if (world_engine->rates[i].sample_rate == sample_rate) {
+            return &world_engine->rates[i];
+        }
     }
+    return nullptr;
+}
 
-    UCRA_WorldEngine* world_engine = reinterpret_cast<UCRA_WorldEngine*>(engine);
+static void init_rate(UCRA_WorldRate* rate, double sample_rate) {
+    rate->sample_rate = sample_rate;
+    InitializeCheapTrickOption(static_cast<int>(sample_rate), &rate->cheaptrick_option);
+    rate->fft_size = GetFFTSizeForCheapTrick(static_cast<int>(sample_rate), &rate->cheaptrick_option);
+}
 
-    /* Update engine parameters from config */
+/* Look up sample_rate, deriving and remembering its settings on a miss */
+static const UCRA_WorldRate* acquire_rate(UCRA_WorldEngine* world_engine, double sample_rate) {
+    const UCRA_WorldRate* found = find_rate(world_engine, sample_rate);
+    if (found) {
+        return found;
+    }
+    UCRA_WorldRate* rate = &world_engine->rates[world_engine->next_rate];
+    world_engine->next_rate = (world_engine->next_rate + 1) % UCRA_WORLD_RATE_CACHE;
+    init_rate(rate, sample_rate);
+    return rate;
+}
+
+/* Adopt the config sample rate, taking the CheapTrick FFT size from the rate cache */
+static void update_sample_rate(UCRA_WorldEngine* world_engine, const UCRA_RenderConfig* config) {
     if (config->sample_rate > 0 && config->sample_rate != world_engine->sample_rate) {
-        world_engine->sample_rate = config->sample_rate;
-        InitializeCheapTrickOption(static_cast<int>(config->sample_rate), &world_engine->cheaptrick_option);
-        world_engine->fft_size = GetFFTSizeForCheapTrick(static_cast<int>(config->sample_rate), &world_engine->cheaptrick_option);
+        const UCRA_WorldRate* rate = acquire_rate(world_engine, config->sample_rate);
+        world_engine->sample_rate = rate->sample_rate;
+        world_engine->cheaptrick_option = rate->cheaptrick_option;
+        world_engine->fft_size = rate->fft_size;
+    }
+}
+
+/*
+ * Settings for a render of config: the engine defaults, with the config sample rate if set.
+ * Read-only, so batch workers can call it; rates missing from the cache are derived locally.
+ */
+static UCRA_WorldParams resolve_params(const UCRA_WorldEngine* world_engine, const UCRA_RenderConfig* config) {
+    UCRA_WorldParams params;
+    params.sample_rate = world_engine->sample_rate;
+    params.frame_period = world_engine->frame_period;
+    params.fft_size = world_engine->fft_size;
+    params.chunk_frames = world_engine->chunk_frames;
+    params.analysis = world_engine->analysis;
+    params.voicebank = world_engine->voicebank;
+    if (config->sample_rate > 0 && config->sample_rate != world_engine->sample_rate) {
+        const UCRA_WorldRate* rate = find_rate(world_engine, config->sample_rate);
+        UCRA_WorldRate local;
+        if (!rate) {
+            init_rate(&local, config->sample_rate);
+            rate = &local;
+        }
+        params.sample_rate = rate->sample_rate;
+        params.fft_size = rate->fft_size;
+    }
+    return params;
+}
+
+/* Grow a scratch buffer to hold at least count doubles */
+static bool reserve_doubles(double** buffer, size_t* capacity, size_t count) {
+    if (count <= *capacity) {
+        return true;
+    }
+    double* grown = static_cast<double*>(realloc(*buffer, count * sizeof(double)));
+    if (!grown) {
+        return false;
+    }
+    *buffer = grown;
+    *capacity = count;
+    return true;
+}
+
+/*
+ * Lay out frame_count rows of bins doubles for each matrix, growing the arena if needed.
+ * Every row starts on a UCRA_WORLD_ARENA_ALIGN boundary.
+ */
+static bool arena_reserve(UCRA_WorldArena* arena, int frame_count, int bins,
+                          double*** out_spectrogram, double*** out_aperiodicity) {
+    const size_t align_doubles = UCRA_WORLD_ARENA_ALIGN / sizeof(double);
+    size_t stride = (static_cast<size_t>(bins) + align_doubles - 1) / align_doubles * align_doubles;
+    size_t row_count = 2 * static_cast<size_t>(frame_count);
+    size_t needed = row_count * stride;
+
+    if (needed > arena->capacity) {
+        void* block = malloc(needed * sizeof(double) + UCRA_WORLD_ARENA_ALIGN - 1);
+        if (!block) {
+            return false;
+        }
+        free(arena->block);
+        uintptr_t address = reinterpret_cast<uintptr_t>(block);
+        address = (address + UCRA_WORLD_ARENA_ALIGN - 1) & ~static_cast<uintptr_t>(UCRA_WORLD_ARENA_ALIGN - 1);
+        arena->block = block;
+        arena->data = reinterpret_cast<double*>(address);
+        arena->capacity = needed;
+    }
+    if (row_count > arena->row_capacity) {
+        double** rows = static_cast<double**>(realloc(arena->rows, row_count * sizeof(double*)));
+        if (!rows) {
+            return false;
+        }
+        arena->rows = rows;
+        arena->row_capacity = row_count;
+    }
+
+    for (size_t i = 0; i < row_count; i++) {
+        arena->rows[i] = arena->data + i * stride;
+    }
+    *out_spectrogram = arena->rows;
+    *out_aperiodicity = arena->rows + frame_count;
+    return true;
+}
+
+/* Make sure at least count scratch slots exist; new ones start empty */
+static bool ensure_scratch(UCRA_WorldEngine* world_engine, uint32_t count) {
+    if (count <= world_engine->scratch_count) {
+        return true;
+    }
+    UCRA_WorldScratch* scratch = static_cast<UCRA_WorldScratch*>(
+        realloc(world_engine->scratch, count * sizeof(UCRA_WorldScratch)));
+    if (!scratch) {
+        return false;
+    }
+    memset(scratch + world_engine->scratch_count, 0, (count - world_engine->scratch_count) * sizeof(UCRA_WorldScratch));
+    world_engine->scratch = scratch;
+    world_engine->scratch_count = count;
+    return true;
+}
+
+/* Harmonic model envelope for one voiced frame at the given fundamental */
+static void compute_envelope(const UCRA_WorldParams* params, double fundamental, double* row) {
+    for (int j = 0; j < params->fft_size / 2 + 1; j++) {
+        double freq = static_cast<double>(j) * params->sample_rate / params->fft_size;
+        double harmonic_num = freq / fundamental;
+
+        /* Simple harmonic model, amplitude decreasing with harmonic number; -60dB elsewhere */
+        if (freq > 0 && harmonic_num >= 1.0 && harmonic_num <= 20.0) {
+            row[j] = -20.0 * log10(harmonic_num + 1.0);
+        } else {
+            row[j] = -60.0;
+        }
+    }
+}
+
+/*
+ * Envelope template for f0, computed at the quantized F0 on a miss.
+ * Returns nullptr only if the template storage cannot be allocated.
+ */
+static const double* envelope_lookup(UCRA_EnvelopeCache* cache, const UCRA_WorldParams* params, double f0) {
+    int bins = params->fft_size / 2 + 1;
+    if (!cache->templates || cache->bins < bins) {
+        double* templates = static_cast<double*>(
+            realloc(cache->templates, static_cast<size_t>(UCRA_WORLD_ENV_CACHE_SLOTS) * bins * sizeof(double)));
+        if (!templates) {
+            return nullptr;
+        }
+        cache->templates = templates;
+        cache->bins = bins;
+        cache->fft_size = 0; /* force a flush below */
+    }
+    if (cache->fft_size != params->fft_size || cache->sample_rate != params->sample_rate) {
+        for (int i = 0; i < UCRA_WORLD_ENV_CACHE_SLOTS; i++) {
+            cache->keys[i] = -1;
+        }
+        cache->fft_size = params->fft_size;
+        cache->sample_rate = params->sample_rate;
     }
 
-    /* Calculate total duration from notes */
+    int64_t key = std::max<int64_t>(1, static_cast<int64_t>(std::llround(f0 / UCRA_WORLD_ENV_F0_STEP)));
+    uint32_t slot = static_cast<uint32_t>((static_cast<uint64_t>(key) * 0x9E3779B97F4A7C15ull) >> 58);
+    double* row = cache->templates + static_cast<size_t>(slot) * cache->bins;
+    if (cache->keys[slot] == key) {
+        cache->hits++;
+        return row;
+    }
+
+    cache->misses++;
+    compute_envelope(params, static_cast<double>(key) * UCRA_WORLD_ENV_F0_STEP, row);
+    cache->keys[slot] = key;
+    return row;
+}
+
+/*
+ * The pool a chunked render fills its windows on, started on first use. nullptr, to fill
+ * them on the calling thread, without chunking, with one render thread, or when the
+ * workers cannot be set up.
+ */
+static UCRA_ThreadPool* chunk_pool(UCRA_WorldEngine* world_engine) {
+    if (world_engine->chunk_frames <= 0 || world_engine->pool_threads < 2) {
+        return nullptr;
+    }
+    if (!world_engine->pool && ucra_pool_create(world_engine->pool_threads, &world_engine->pool) != UCRA_SUCCESS) {
+        return nullptr;
+    }
+    return ensure_scratch(world_engine, ucra_pool_size(world_engine->pool)) ? world_engine->pool : nullptr;
+}
+
+/* Calculate total duration from notes */
+static double compute_total_duration(const UCRA_RenderConfig* config) {
     double total_duration = 0.0;
     for (uint32_t i = 0; i < config->note_count; i++) {
         double note_end = config->notes[i].start_sec + config->notes[i].duration_sec;
@@ -261,163 +731,851 @@ UCRA_Result ucra_render(UCRA_Handle engine,
             total_duration = note_end;
         }
     }
+    return total_duration;
+}
 
+/* Number of output frames a render of config produces at the given sample rate */
+static int compute_output_length(const UCRA_RenderConfig* config, double sample_rate) {
+    double total_duration = compute_total_duration(config);
     if (total_duration <= 0.0) {
-        /* No notes to render - return silence */
-        outResult->pcm = nullptr;
-        outResult->frames = 0;
-        outResult->channels = config->channels;
-        outResult->sample_rate = static_cast<uint32_t>(world_engine->sample_rate);
-        outResult->metadata = nullptr;
-        outResult->metadata_count = 0;
-        outResult->status = UCRA_SUCCESS;
-        return UCRA_SUCCESS;
+        return 0;
     }
+    return static_cast<int>(total_duration * sample_rate);
+}
 
-    /* Prepare F0 data for WORLD */
-    std::vector<double> f0_array, time_array;
-    prepare_world_f0_data(config->notes, config->note_count,
-                          world_engine->sample_rate, world_engine->frame_period,
-                          total_duration, f0_array, time_array);
+/* Float samples an output takes in the layout selected by config->flags */
+static size_t layout_samples(const UCRA_RenderConfig* config, int output_length) {
+    size_t frames = static_cast<size_t>(output_length);
+    return UCRA_RENDER_LAYOUT(config->flags) == UCRA_RENDER_LAYOUT_MONO ? frames : frames * config->channels;
+}
+
+static bool layout_valid(const UCRA_RenderConfig* config) {
+    return UCRA_RENDER_LAYOUT(config->flags) <= UCRA_RENDER_LAYOUT_MONO;
+}
+
+static void fill_result(UCRA_RenderResult* outResult, const float* pcm, int output_length,
+                        uint32_t channels, double sample_rate) {
+    outResult->pcm = output_length > 0 ? pcm : nullptr;
+    outResult->frames = static_cast<uint64_t>(output_length);
+    outResult->channels = channels;
+    outResult->sample_rate = static_cast<uint32_t>(sample_rate);
+    outResult->metadata = nullptr;
+    outResult->metadata_count = 0;
+    outResult->status = UCRA_SUCCESS;
+}
+
+/*
+ * Spectral envelope and aperiodicity for frame_count frames of f0.
+ * Stands in for CheapTrick/D4C analysis with a simple spectral model.
+ */
+static bool fill_frame_spectra(const UCRA_WorldParams* params, UCRA_EnvelopeCache* cache,
+                               const double* f0, int frame_count,
+                               double** spectrogram, double** aperiodicity) {
+    int bins = params->fft_size / 2 + 1;
+    for (int i = 0; i < frame_count; i++) {
+        if (f0[i] > 0.0) {
+            /* Voiced frames copy the harmonic template for their (quantized) F0 */
+            const double* envelope = envelope_lookup(cache, params, f0[i]);
+            if (!envelope) {
+                return false;
+            }
+            memcpy(spectrogram[i], envelope, bins * sizeof(double));
 
-    int frame_count = static_cast<int>(f0_array.size());
+            /* Set aperiodicity for voiced frames */
+            for (int j = 0; j < bins; j++) {
+                aperiodicity[i][j] = 0.1; /* Slightly aperiodic */
+            }
+        } else {
+            /* Unvoiced frame - set high aperiodicity */
+            for (int j = 0; j < bins; j++) {
+                spectrogram[i][j] = -40.0; /* Noise spectrum */
+                aperiodicity[i][j] = 0.9;  /* Highly aperiodic */
+            }
+        }
+    }
+    return true;
+}
+
+/*
+ * Replace the modelled spectra of voiced frames with those of the voicebank sample
+ * named by each note's lyric. The rows hold analysis frames [first_frame,
+ * first_frame + frame_count) of the timeline. Samples analyzed at another FFT size
+ * or frame period than this render are skipped; the note keeps the modelled spectrum.
+ */
+static void apply_sample_spectra(const UCRA_WorldParams* params, const UCRA_RenderConfig* config,
+                                 int64_t first_frame, const double* f0, int frame_count,
+                                 double** spectrogram, double** aperiodicity) {
+    if (!params->analysis || !config->notes) {
+        return;
+    }
+    int bins = params->fft_size / 2 + 1;
+    for (uint32_t note_idx = 0; note_idx < config->note_count; note_idx++) {
+        const UCRA_NoteSegment* note = &config->notes[note_idx];
+        if (!note->lyric || !note->lyric[0]) continue;
+
+        /* Same frame coverage as prepare_world_f0_data(); long notes hold the last sample frame */
+        int64_t start_frame = std::max<int64_t>(0, static_cast<int64_t>(note->start_sec * 1000.0 / params->frame_period));
+        int64_t end_frame = static_cast<int64_t>((note->start_sec + note->duration_sec) * 1000.0 / params->frame_period);
+        int64_t first = std::max(start_frame, first_frame);
+        int64_t last = std::min(end_frame, first_frame + frame_count - 1);
+        if (first > last) continue; /* outside these rows: skip the lookup */
+
+        char wav_path[1024];
+        int written = snprintf(wav_path, sizeof(wav_path), "%s/%s.wav", params->voicebank, note->lyric);
+        if (written < 0 || written >= static_cast<int>(sizeof(wav_path))) continue;
+        const UCRA_AnalysisData* sample = nullptr;
+        if (ucra_analysis_store_get(params->analysis, wav_path, &sample) != UCRA_SUCCESS ||
+            sample->frame_count == 0 || sample->bins != static_cast<uint32_t>(bins) ||
+            sample->frame_period != params->frame_period) {
+            continue;
+        }
+        for (int64_t frame = first; frame <= last; frame++) {
+            int row = static_cast<int>(frame - first_frame);
+            if (f0[row] <= 0.0) continue;
+            uint32_t k = static_cast<uint32_t>(std::min<int64_t>(frame - start_frame, sample->frame_count - 1));
+            const float* sp = sample->spectrogram + static_cast<size_t>(k) * bins;
+            const float* ap = sample->aperiodicity + static_cast<size_t>(k) * bins;
+            for (int j = 0; j < bins; j++) {
+                spectrogram[row][j] = sp[j];
+                aperiodicity[row][j] = ap[j];
+            }
+        }
+    }
+}
+
+/* Report the engine's cumulative envelope cache hits and misses as result metadata */
+static void attach_cache_metadata(UCRA_WorldEngine* world_engine, UCRA_RenderResult* outResult) {
+    uint64_t hits = 0, misses = 0;
+    for (uint32_t i = 0; i < world_engine->scratch_count; i++) {
+        hits += world_engine->scratch[i].envelopes.hits;
+        misses += world_engine->scratch[i].envelopes.misses;
+    }
+    snprintf(world_engine->cache_metadata_values[0], sizeof(world_engine->cache_metadata_values[0]),
+             "%llu", static_cast<unsigned long long>(hits));
+    snprintf(world_engine->cache_metadata_values[1], sizeof(world_engine->cache_metadata_values[1]),
+             "%llu", static_cast<unsigned long long>(misses));
+    world_engine->cache_metadata[0].key = "envelope_cache_hits";
+    world_engine->cache_metadata[0].value = world_engine->cache_metadata_values[0];
+    world_engine->cache_metadata[1].key = "envelope_cache_misses";
+    world_engine->cache_metadata[1].value = world_engine->cache_metadata_values[1];
+    outResult->metadata = world_engine->cache_metadata;
+    outResult->metadata_count = 2;
+}
+
+static UCRA_Result synthesize_chunked(const UCRA_WorldParams* params, UCRA_WorldScratch* scratch,
+                                      UCRA_ThreadPool* pool, const UCRA_RenderConfig* config,
+                                      int output_length, float* dst);
+
+/*
+ * Run the WORLD pipeline for config and write float PCM in the requested layout into dst.
+ * Renders longer than params->chunk_frames go through synthesize_chunked(), which fills
+ * windows on pool if given; scratch then holds one slot per pool worker.
+ * Only reads params and config, so concurrent calls with distinct scratch are safe.
+ */
+static UCRA_Result synthesize_into(const UCRA_WorldParams* params, UCRA_WorldScratch* scratch,
+                                   UCRA_ThreadPool* pool, const UCRA_RenderConfig* config,
+                                   int output_length, float* dst) {
+    int frame_count = compute_frame_count(compute_total_duration(config), params->frame_period);
     if (frame_count <= 0) {
-        outResult->status = UCRA_ERR_INTERNAL;
         return UCRA_ERR_INTERNAL;
     }
+    if (params->chunk_frames > 0 && frame_count > params->chunk_frames) {
+        return synthesize_chunked(params, scratch, pool, config, output_length, dst);
+    }
+    if (!reserve_doubles(&scratch->f0, &scratch->f0_capacity, static_cast<size_t>(frame_count)) ||
+        !reserve_doubles(&scratch->audio, &scratch->audio_capacity, static_cast<size_t>(output_length))) {
+        return UCRA_ERR_OUT_OF_MEMORY;
+    }
+    double* f0_array = scratch->f0;
+    double* synthesized_audio = scratch->audio;
 
-    /* Allocate arrays for spectral envelope and aperiodicity */
+    /* Prepare F0 data for WORLD */
+    UCRA_TRACE_BEGIN(f0);
+    prepare_world_f0_data(config->notes, config->note_count, params->frame_period, frame_count,
+                          ucra_curve_interp_from_config(config),
+                          f0_array);
+    UCRA_TRACE_END(f0, "world.f0_prepare");
+
+    /* Spectral envelope and aperiodicity rows come from the reusable arena */
     double** spectrogram = nullptr;
     double** aperiodicity = nullptr;
+    if (!arena_reserve(&scratch->arena, frame_count, params->fft_size / 2 + 1, &spectrogram, &aperiodicity)) {
+        return UCRA_ERR_OUT_OF_MEMORY;
+    }
 
     try {
-        /* Allocate 2D arrays for WORLD */
-        spectrogram = new double*[frame_count];
-        aperiodicity = new double*[frame_count];
-
-        for (int i = 0; i < frame_count; i++) {
-            spectrogram[i] = new double[world_engine->fft_size / 2 + 1];
-            aperiodicity[i] = new double[world_engine->fft_size / 2 + 1];
-
-            /* Initialize with default values */
-            for (int j = 0; j < world_engine->fft_size / 2 + 1; j++) {
-                spectrogram[i][j] = -60.0; /* -60dB default */
-                aperiodicity[i][j] = 0.0;  /* Voiced by default */
-            }
+        UCRA_TRACE_BEGIN(spectra);
+        if (!fill_frame_spectra(params, &scratch->envelopes, f0_array, frame_count,
+                                spectrogram, aperiodicity)) {
+            return UCRA_ERR_OUT_OF_MEMORY;
         }
+        apply_sample_spectra(params, config, 0, f0_array, frame_count, spectrogram, aperiodicity);
+        UCRA_TRACE_END(spectra, "world.spectral_fill");
 
-        /* Perform CheapTrick analysis (spectral envelope) */
-        /* For synthesis, we'll use a simple spectral model */
-        for (int i = 0; i < frame_count; i++) {
-            if (f0_array[i] > 0.0) {
-                /* Generate harmonic spectrum for voiced frames */
-                double fundamental = f0_array[i];
-                for (int j = 0; j < world_engine->fft_size / 2 + 1; j++) {
-                    double freq = static_cast<double>(j) * world_engine->sample_rate / world_engine->fft_size;
-
-                    /* Simple harmonic model */
-                    if (freq > 0) {
-                        double harmonic_num = freq / fundamental;
-                        if (harmonic_num >= 1.0 && harmonic_num <= 20.0) {
-                            /* Calculate harmonic amplitude (decreasing with harmonic number) */
-                            double amplitude = -20.0 * log10(harmonic_num + 1.0);
-                            spectrogram[i][j] = amplitude;
-                        }
-                    }
-                }
-
-                /* Set aperiodicity for voiced frames */
-                for (int j = 0; j < world_engine->fft_size / 2 + 1; j++) {
-                    aperiodicity[i][j] = 0.1; /* Slightly aperiodic */
-                }
-            } else {
-                /* Unvoiced frame - set high aperiodicity */
-                for (int j = 0; j < world_engine->fft_size / 2 + 1; j++) {
-                    spectrogram[i][j] = -40.0; /* Noise spectrum */
-                    aperiodicity[i][j] = 0.9;  /* Highly aperiodic */
+        /* Synthesize audio using WORLD */
+        UCRA_TRACE_BEGIN(synthesis);
+        Synthesis(f0_array, frame_count, spectrogram, aperiodicity,
+                  params->fft_size, params->frame_period,
+                  static_cast<int>(params->sample_rate), output_length,
+                  synthesized_audio);
+        UCRA_TRACE_END(synthesis, "world.synthesis");
+
+        /* Convert to float in the requested layout */
+        UCRA_TRACE_BEGIN(fan_out);
+        uint32_t layout = UCRA_RENDER_LAYOUT(config->flags);
+        uint32_t planes = layout == UCRA_RENDER_LAYOUT_PLANAR ? config->channels : 1;
+        if (layout == UCRA_RENDER_LAYOUT_INTERLEAVED) {
+            /* Duplicate for multiple channels */
+            for (int sample = 0; sample < output_length; sample++) {
+                float sample_value = static_cast<float>(synthesized_audio[sample]);
+                for (uint32_t ch = 0; ch < config->channels; ch++) {
+                    dst[static_cast<size_t>(sample) * config->channels + ch] = sample_value;
                 }
             }
+        } else {
+            /* Planar copies one plane per channel; mono leaves the expansion to the consumer */
+            for (int sample = 0; sample < output_length; sample++) {
+                dst[sample] = static_cast<float>(synthesized_audio[sample]);
+            }
+            for (uint32_t ch = 1; ch < planes; ch++) {
+                memcpy(dst + static_cast<size_t>(ch) * output_length, dst, output_length * sizeof(float));
+            }
         }
+        UCRA_TRACE_END(fan_out, "world.fan_out");
+    } catch (...) {
+        /* Exception occurred - the scratch stays with the engine, just report the error */
+        return UCRA_ERR_INTERNAL;
+    }
 
-        /* Synthesize audio using WORLD */
-        int output_length = static_cast<int>(total_duration * world_engine->sample_rate);
-        std::vector<double> synthesized_audio(output_length);
+    return UCRA_SUCCESS;
+}
+
+UCRA_Result ucra_render(UCRA_Handle engine,
+                        const UCRA_RenderConfig* config,
+                        UCRA_RenderResult* outResult) {
+    const UCRA_LoadedEngine* loaded = ucra_loaded_engine(engine);
+    if (loaded) return loaded->table->render(loaded->inner, config, outResult);
+    if (!engine || !config || !outResult) {
+        return UCRA_ERR_INVALID_ARGUMENT;
+    }
+    if (!layout_valid(config)) {
+        outResult->status = UCRA_ERR_INVALID_ARGUMENT;
+        return UCRA_ERR_INVALID_ARGUMENT;
+    }
 
-        Synthesis(f0_array.data(), frame_count, spectrogram, aperiodicity,
-                  world_engine->fft_size, world_engine->frame_period,
-                  static_cast<int>(world_engine->sample_rate), output_length,
-                  synthesized_audio.data());
+    UCRA_WorldEngine* world_engine = reinterpret_cast<UCRA_WorldEngine*>(engine);
 
-        /* Convert to float and store in engine */
-        size_t total_samples = output_length * config->channels;
+    /* Update engine parameters from config */
+    update_sample_rate(world_engine, config);
 
-        /* Free previous results */
-        if (world_engine->last_pcm) {
-            free(world_engine->last_pcm);
+    int output_length = compute_output_length(config, world_engine->sample_rate);
+    if (output_length <= 0) {
+        /* No notes to render - return silence */
+        fill_result(outResult, nullptr, 0, config->channels, world_engine->sample_rate);
+        return UCRA_SUCCESS;
+    }
+
+    /* Engine-owned buffer only grows, so repeated renders reuse it */
+    size_t total_samples = layout_samples(config, output_length);
+    if (total_samples > world_engine->last_pcm_size) {
+        float* pcm = static_cast<float*>(realloc(world_engine->last_pcm, total_samples * sizeof(float)));
+        if (!pcm) {
+            outResult->status = UCRA_ERR_OUT_OF_MEMORY;
+            return UCRA_ERR_OUT_OF_MEMORY;
         }
+        world_engine->last_pcm = pcm;
+        world_engine->last_pcm_size = total_samples;
+    }
 
-        world_engine->last_pcm = static_cast<float*>(malloc(total_samples * sizeof(float)));
-        if (!world_engine->last_pcm) {
-            /* Cleanup and return error */
-            for (int i = 0; i < frame_count; i++) {
-                delete[] spectrogram[i];
-                delete[] aperiodicity[i];
-            }
-            delete[] spectrogram;
-            delete[] aperiodicity;
+    if (!ensure_scratch(world_engine, 1)) {
+        outResult->status = UCRA_ERR_OUT_OF_MEMORY;
+        return UCRA_ERR_OUT_OF_MEMORY;
+    }
+    UCRA_WorldParams params = resolve_params(world_engine, config);
+    UCRA_ThreadPool* pool = chunk_pool(world_engine); /* may grow the scratch array */
+    UCRA_TRACE_BEGIN(render);
+    UCRA_Result result = synthesize_into(&params, world_engine->scratch, pool, config, output_length,
+                                         world_engine->last_pcm);
+    UCRA_TRACE_END(render, "world.render");
+    if (result != UCRA_SUCCESS) {
+        outResult->status = result;
+        return result;
+    }
+
+    fill_result(outResult, world_engine->last_pcm, output_length, config->channels, world_engine->sample_rate);
+    attach_cache_metadata(world_engine, outResult);
+    return UCRA_SUCCESS;
+}
+
+UCRA_Result ucra_render_query_size(UCRA_Handle engine,
+                                   const UCRA_RenderConfig* config,
+                                   uint64_t* out_frames,
+                                   uint64_t* out_samples) {
+    const UCRA_LoadedEngine* loaded = ucra_loaded_engine(engine);
+    if (loaded) {
+        return UCRA_ENGINE_TABLE_HAS(loaded->table, render_query_size)
+                   ? loaded->table->render_query_size(loaded->inner, config, out_frames, out_samples)
+                   : UCRA_ERR_NOT_SUPPORTED;
+    }
+    if (!engine || !config || !layout_valid(config)) {
+        return UCRA_ERR_INVALID_ARGUMENT;
+    }
+
+    UCRA_WorldEngine* world_engine = reinterpret_cast<UCRA_WorldEngine*>(engine);
+    double sample_rate = config->sample_rate > 0 ? config->sample_rate : world_engine->sample_rate;
+    uint64_t frames = static_cast<uint64_t>(compute_output_length(config, sample_rate));
+
+    if (out_frames) *out_frames = frames;
+    if (out_samples) *out_samples = layout_samples(config, static_cast<int>(frames));
+    return UCRA_SUCCESS;
+}
 
+UCRA_Result ucra_render_into(UCRA_Handle engine,
+                             const UCRA_RenderConfig* config,
+                             float* out_pcm,
+                             uint64_t capacity_samples,
+                             UCRA_RenderResult* outResult) {
+    const UCRA_LoadedEngine* loaded = ucra_loaded_engine(engine);
+    if (loaded) {
+        return UCRA_ENGINE_TABLE_HAS(loaded->table, render_into)
+                   ? loaded->table->render_into(loaded->inner, config, out_pcm, capacity_samples, outResult)
+                   : UCRA_ERR_NOT_SUPPORTED;
+    }
+    if (!engine || !config || !outResult) {
+        return UCRA_ERR_INVALID_ARGUMENT;
+    }
+    if (!layout_valid(config)) {
+        outResult->status = UCRA_ERR_INVALID_ARGUMENT;
+        return UCRA_ERR_INVALID_ARGUMENT;
+    }
+
+    UCRA_WorldEngine* world_engine = reinterpret_cast<UCRA_WorldEngine*>(engine);
+    update_sample_rate(world_engine, config);
+
+    int output_length = compute_output_length(config, world_engine->sample_rate);
+    uint64_t required = layout_samples(config, output_length);
+    if (output_length > 0 && (!out_pcm || capacity_samples < required)) {
+        /* Report the required size so the caller can retry with a larger buffer */
+        fill_result(outResult, nullptr, output_length, config->channels, world_engine->sample_rate);
+        outResult->status = UCRA_ERR_INVALID_ARGUMENT;
+        return UCRA_ERR_INVALID_ARGUMENT;
+    }
+
+    if (output_length > 0) {
+        if (!ensure_scratch(world_engine, 1)) {
             outResult->status = UCRA_ERR_OUT_OF_MEMORY;
             return UCRA_ERR_OUT_OF_MEMORY;
         }
+        UCRA_WorldParams params = resolve_params(world_engine, config);
+        UCRA_ThreadPool* pool = chunk_pool(world_engine); /* may grow the scratch array */
+        UCRA_TRACE_BEGIN(render);
+        UCRA_Result result = synthesize_into(&params, world_engine->scratch, pool, config, output_length, out_pcm);
+        UCRA_TRACE_END(render, "world.render");
+        if (result != UCRA_SUCCESS) {
+            outResult->status = result;
+            return result;
+        }
+    }
 
-        world_engine->last_pcm_size = total_samples;
+    fill_result(outResult, out_pcm, output_length, config->channels, world_engine->sample_rate);
+    attach_cache_metadata(world_engine, outResult);
+    return UCRA_SUCCESS;
+}
+
+/* Shared state of a ucra_render_batch() call */
+typedef struct UCRA_WorldBatch {
+    const UCRA_WorldEngine* world_engine;
+    const UCRA_RenderConfig* configs;
+    UCRA_RenderResult* results;
+} UCRA_WorldBatch;
+
+static void world_batch_job(void* ctx, uint32_t job, uint32_t worker) {
+    const UCRA_WorldBatch* batch = static_cast<const UCRA_WorldBatch*>(ctx);
+    const UCRA_WorldEngine* world_engine = batch->world_engine;
+    UCRA_RenderResult* out = &batch->results[job];
+    if (out->status != UCRA_SUCCESS || out->frames == 0) {
+        return; /* rejected while planning, or silent */
+    }
 
-        /* Convert to interleaved float and duplicate for multiple channels */
-        for (int sample = 0; sample < output_length; sample++) {
-            float sample_value = static_cast<float>(synthesized_audio[sample]);
-            for (uint32_t ch = 0; ch < config->channels; ch++) {
-                world_engine->last_pcm[sample * config->channels + ch] = sample_value;
+    const UCRA_RenderConfig* config = &batch->configs[job];
+    UCRA_WorldParams params = resolve_params(world_engine, config);
+    float* dst = world_engine->batch_pcm + world_engine->batch_offsets[job];
+    UCRA_Result result;
+    UCRA_TRACE_BEGIN(render);
+    try {
+        /* the pool is busy with the batch, so windows of a chunked job fill in order */
+        result = synthesize_into(&params, &world_engine->scratch[worker], nullptr, config,
+                                 static_cast<int>(out->frames), dst);
+    } catch (...) {
+        /* never let an exception unwind through a pool thread */
+        result = UCRA_ERR_OUT_OF_MEMORY;
+    }
+    UCRA_TRACE_END(render, "world.render");
+    if (result == UCRA_SUCCESS) {
+        out->pcm = dst;
+    } else {
+        out->status = result;
+    }
+}
+
+UCRA_Result ucra_render_batch(UCRA_Handle engine,
+                              const UCRA_RenderConfig* configs,
+                              UCRA_RenderResult* results,
+                              uint32_t count) {
+    const UCRA_LoadedEngine* loaded = ucra_loaded_engine(engine);
+    if (loaded) {
+        return UCRA_ENGINE_TABLE_HAS(loaded->table, render_batch)
+                   ? loaded->table->render_batch(loaded->inner, configs, results, count)
+                   : UCRA_ERR_NOT_SUPPORTED;
+    }
+    if (!engine || (count > 0 && (!configs || !results))) {
+        return UCRA_ERR_INVALID_ARGUMENT;
+    }
+
+    UCRA_WorldEngine* world_engine = reinterpret_cast<UCRA_WorldEngine*>(engine);
+    if (count > 0 && !world_engine->pool) {
+        UCRA_Result result = ucra_pool_create(world_engine->pool_threads, &world_engine->pool);
+        if (result != UCRA_SUCCESS) {
+            return result;
+        }
+    }
+    if (count > 0 && !ensure_scratch(world_engine, ucra_pool_size(world_engine->pool))) {
+        return UCRA_ERR_OUT_OF_MEMORY;
+    }
+    if (count > world_engine->batch_offsets_capacity) {
+        size_t* grown = static_cast<size_t*>(realloc(world_engine->batch_offsets, count * sizeof(size_t)));
+        if (!grown) {
+            return UCRA_ERR_OUT_OF_MEMORY;
+        }
+        world_engine->batch_offsets = grown;
+        world_engine->batch_offsets_capacity = count;
+    }
+    size_t* offsets = world_engine->batch_offsets;
+
+    /* Size every job first so all outputs share one arena */
+    size_t total_samples = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        const UCRA_RenderConfig* config = &configs[i];
+        double sample_rate = config->sample_rate > 0 ? config->sample_rate : world_engine->sample_rate;
+        offsets[i] = total_samples;
+        if ((config->note_count > 0 && !config->notes) || !layout_valid(config)) {
+            fill_result(&results[i], nullptr, 0, config->channels, sample_rate);
+            results[i].status = UCRA_ERR_INVALID_ARGUMENT;
+            continue;
+        }
+        if (sample_rate != world_engine->sample_rate) {
+            acquire_rate(world_engine, sample_rate); /* warm the cache the workers read */
+        }
+        int output_length = compute_output_length(config, sample_rate);
+        fill_result(&results[i], nullptr, output_length, config->channels, sample_rate);
+        total_samples += layout_samples(config, output_length);
+    }
+
+    if (total_samples > world_engine->batch_pcm_size) {
+        float* pcm = static_cast<float*>(realloc(world_engine->batch_pcm, total_samples * sizeof(float)));
+        if (!pcm) {
+            for (uint32_t i = 0; i < count; i++) {
+                results[i].status = UCRA_ERR_OUT_OF_MEMORY;
             }
+            return UCRA_ERR_OUT_OF_MEMORY;
         }
+        world_engine->batch_pcm = pcm;
+        world_engine->batch_pcm_size = total_samples;
+    }
+
+    /* Jobs only read the engine settings, so they synthesize in parallel */
+    UCRA_WorldBatch batch;
+    batch.world_engine = world_engine;
+    batch.configs = configs;
+    batch.results = results;
+    if (count > 0) {
+        ucra_pool_run(world_engine->pool, count, world_batch_job, &batch);
+    }
 
-        /* Fill output result */
-        outResult->pcm = world_engine->last_pcm;
-        outResult->frames = output_length;
-        outResult->channels = config->channels;
-        outResult->sample_rate = static_cast<uint32_t>(world_engine->sample_rate);
-        outResult->metadata = nullptr;
-        outResult->metadata_count = 0;
-        outResult->status = UCRA_SUCCESS;
+    UCRA_Result first_error = UCRA_SUCCESS;
+    for (uint32_t i = 0; i < count && first_error == UCRA_SUCCESS; i++) {
+        first_error = results[i].status;
+    }
+    return first_error;
+}
 
-        /* Cleanup WORLD arrays */
-        for (int i = 0; i < frame_count; i++) {
-            delete[] spectrogram[i];
-            delete[] aperiodicity[i];
+/*
+ * Streaming synthesis on WORLD's realtime synthesizer. Parameters are generated
+ * chunk by chunk just ahead of the output, so latency stays at about one chunk
+ * plus one synthesizer buffer regardless of the phrase length.
+ */
+
+/* Parameter chunks queued in the synthesizer at most */
+#define UCRA_WORLD_STREAM_QUEUE 8
+
+struct UCRA_WorldStream {
+    WorldSynthesizer synth;
+    UCRA_WorldParams params;
+    int chunk_frames;   /* analysis frames per AddParameters() call */
+    int queue;          /* chunks the synthesizer holds at most */
+
+    /*
+     * Chunk k lives in slot k % (2 * queue). The synthesizer holds at most queue
+     * chunks, all before next_chunk, so filling up to queue chunks from
+     * next_chunk on never overwrites parameters it still references.
+     */
+    double* f0;
+    UCRA_WorldArena arena;
+    double** spectrogram;
+    double** aperiodicity;
+    UCRA_EnvelopeCache envelopes;
+
+    /* With a pool, chunks are filled queue at a time, worker w using workers[w].envelopes */
+    UCRA_ThreadPool* pool;
+    UCRA_WorldScratch* workers;
+
+    int64_t next_chunk;   /* index of the next chunk to hand to the synthesizer */
+    int64_t filled_end;   /* chunks [next_chunk, filled_end) are filled but not yet added */
+    int buffer_pos;       /* read position in synth.buffer; buffer_size when drained */
+};
+
+/* F0 for analysis frames [first_frame, first_frame + n) on the absolute timeline */
+static void fill_stream_f0(const UCRA_RenderConfig* config, double frame_period_ms,
+                           int64_t first_frame, int n, double* f0) {
+    for (int i = 0; i < n; i++) {
+        f0[i] = 0.0;
+    }
+    if (!config->notes) {
+        return;
+    }
+
+    UCRA_CurveInterp interp = ucra_curve_interp_from_config(config);
+    int64_t last_frame = first_frame + n - 1;
+    for (uint32_t note_idx = 0; note_idx < config->note_count; note_idx++) {
+        const UCRA_NoteSegment* note = &config->notes[note_idx];
+        if (note->midi_note < 0) continue; /* Skip non-pitched notes */
+
+        /* Same frame coverage as an offline render */
+        int64_t start_frame = static_cast<int64_t>(note->start_sec * 1000.0 / frame_period_ms);
+        int64_t end_frame = static_cast<int64_t>((note->start_sec + note->duration_sec) * 1000.0 / frame_period_ms);
+        start_frame = std::max(start_frame, first_frame);
+        end_frame = std::min(end_frame, last_frame);
+        if (start_frame > end_frame) continue;
+
+        UCRA_CurveCursor cursor;
+        ucra_curve_cursor_f0(&cursor, note->f0_override);
+        double note_f0 = midi_note_to_frequency(note->midi_note);
+        for (int64_t frame = start_frame; frame <= end_frame; frame++) {
+            double* out = &f0[frame - first_frame];
+            if (!ucra_curve_valid(&cursor)) {
+                *out = note_f0;
+                continue;
+            }
+            double relative_time = frame * frame_period_ms / 1000.0 - note->start_sec;
+            if (relative_time >= 0 && relative_time <= note->duration_sec) {
+                *out = ucra_curve_sample(&cursor, interp, relative_time);
+            }
         }
-        delete[] spectrogram;
-        delete[] aperiodicity;
+    }
+}
+
+/* Parameters of chunk into its slot, on the timeline of config */
+static bool fill_stream_chunk(UCRA_WorldStream* stream, UCRA_EnvelopeCache* envelopes,
+                              const UCRA_RenderConfig* config, int64_t chunk) {
+    int slot = static_cast<int>(chunk % (2 * stream->queue)) * stream->chunk_frames;
+    int64_t first_frame = chunk * stream->chunk_frames;
+    fill_stream_f0(config, stream->params.frame_period, first_frame, stream->chunk_frames, stream->f0 + slot);
+    if (!fill_frame_spectra(&stream->params, envelopes, stream->f0 + slot, stream->chunk_frames,
+                            stream->spectrogram + slot, stream->aperiodicity + slot)) {
+        return false;
+    }
+    apply_sample_spectra(&stream->params, config, first_frame, stream->f0 + slot, stream->chunk_frames,
+                         stream->spectrogram + slot, stream->aperiodicity + slot);
+    return true;
+}
 
+/* Chunks filled by one ucra_pool_run() */
+typedef struct UCRA_WorldChunkJobs {
+    UCRA_WorldStream* stream;
+    const UCRA_RenderConfig* config;
+    int64_t first_chunk;
+    std::atomic<bool> failed;
+} UCRA_WorldChunkJobs;
+
+static void world_chunk_job(void* ctx, uint32_t job, uint32_t worker) {
+    UCRA_WorldChunkJobs* jobs = static_cast<UCRA_WorldChunkJobs*>(ctx);
+    if (!fill_stream_chunk(jobs->stream, &jobs->stream->workers[worker].envelopes, jobs->config,
+                           jobs->first_chunk + job)) {
+        jobs->failed = true;
+    }
+}
+
+/* Fill the chunks from next_chunk on: one, or queue of them in parallel with a pool */
+static UCRA_Result fill_stream_chunks(UCRA_WorldStream* stream, const UCRA_RenderConfig* config) {
+    if (!stream->pool) {
+        if (!fill_stream_chunk(stream, &stream->envelopes, config, stream->next_chunk)) {
+            return UCRA_ERR_OUT_OF_MEMORY;
+        }
+        stream->filled_end = stream->next_chunk + 1;
         return UCRA_SUCCESS;
+    }
+    UCRA_WorldChunkJobs jobs;
+    jobs.stream = stream;
+    jobs.config = config;
+    jobs.first_chunk = stream->next_chunk;
+    jobs.failed = false;
+    ucra_pool_run(stream->pool, static_cast<uint32_t>(stream->queue), world_chunk_job, &jobs);
+    if (jobs.failed) {
+        return UCRA_ERR_OUT_OF_MEMORY;
+    }
+    stream->filled_end = stream->next_chunk + stream->queue;
+    return UCRA_SUCCESS;
+}
 
-    } catch (...) {
-        /* Exception occurred - cleanup and return error */
-        if (spectrogram) {
-            for (int i = 0; i < frame_count; i++) {
-                delete[] spectrogram[i];
+/*
+ * Stream synthesizing with params; an engine-owned stream shares the engine's voicebank.
+ * Chunks cover chunk_frames analysis frames, or one block of output if 0.
+ */
+static UCRA_Result world_stream_create(const UCRA_WorldParams* params, uint32_t block_size,
+                                       int chunk_frames, int queue, UCRA_WorldStream** out_stream) {
+    *out_stream = nullptr;
+
+    UCRA_WorldStream* stream = static_cast<UCRA_WorldStream*>(calloc(1, sizeof(UCRA_WorldStream)));
+    if (!stream) {
+        return UCRA_ERR_OUT_OF_MEMORY;
+    }
+    stream->params = *params;
+    int sample_rate = static_cast<int>(params->sample_rate);
+
+    /* By default enough analysis frames per chunk to cover one output block */
+    double samples_per_frame = sample_rate * stream->params.frame_period / 1000.0;
+    stream->chunk_frames = chunk_frames > 0 ? chunk_frames
+                           : std::max(1, static_cast<int>(std::ceil(block_size / samples_per_frame)));
+    stream->queue = queue;
+
+    int slot_frames = 2 * queue * stream->chunk_frames;
+    stream->f0 = static_cast<double*>(calloc(slot_frames, sizeof(double)));
+    if (!stream->f0 ||
+        !arena_reserve(&stream->arena, slot_frames, stream->params.fft_size / 2 + 1,
+                       &stream->spectrogram, &stream->aperiodicity)) {
+        ucra_world_stream_destroy(stream);
+        return UCRA_ERR_OUT_OF_MEMORY;
+    }
+
+    InitializeSynthesizer(sample_rate, stream->params.frame_period,
+                          stream->params.fft_size, static_cast<int>(block_size),
+                          queue, &stream->synth);
+    stream->buffer_pos = stream->synth.buffer_size;
+
+    *out_stream = stream;
+    return UCRA_SUCCESS;
+}
+
+UCRA_Result ucra_world_stream_create(uint32_t sample_rate, uint32_t block_size,
+                                     UCRA_WorldStream** out_stream) {
+    if (!out_stream || sample_rate == 0 || block_size == 0) {
+        return UCRA_ERR_INVALID_ARGUMENT;
+    }
+    *out_stream = nullptr;
+
+    CheapTrickOption cheaptrick_option;
+    InitializeCheapTrickOption(static_cast<int>(sample_rate), &cheaptrick_option);
+    UCRA_WorldParams params;
+    params.sample_rate = sample_rate;
+    params.frame_period = 5.0; /* engine default */
+    params.fft_size = GetFFTSizeForCheapTrick(static_cast<int>(sample_rate), &cheaptrick_option);
+    params.chunk_frames = 0;
+    params.analysis = nullptr;
+    params.voicebank = nullptr;
+    return world_stream_create(&params, block_size, 0, UCRA_WORLD_STREAM_QUEUE, out_stream);
+}
+
+UCRA_Result ucra_world_stream_render(UCRA_WorldStream* stream, const UCRA_RenderConfig* config,
+                                     float* out, uint32_t frames) {
+    if (!stream || !config || !out) {
+        return UCRA_ERR_INVALID_ARGUMENT;
+    }
+
+    uint32_t channels = config->channels;
+    uint32_t produced = 0;
+    int refused = 0;
+    while (produced < frames) {
+        /* Drain the synthesizer's current buffer first */
+        if (stream->buffer_pos < stream->synth.buffer_size) {
+            uint32_t n = std::min<uint32_t>(frames - produced,
+                                            static_cast<uint32_t>(stream->synth.buffer_size - stream->buffer_pos));
+            const double* src = stream->synth.buffer + stream->buffer_pos;
+            for (uint32_t i = 0; i < n; i++) {
+                float sample_value = static_cast<float>(src[i]);
+                for (uint32_t ch = 0; ch < channels; ch++) {
+                    out[static_cast<size_t>(produced + i) * channels + ch] = sample_value;
+                }
             }
-            delete[] spectrogram;
+            stream->buffer_pos += static_cast<int>(n);
+            produced += n;
+            continue;
+        }
+        if (Synthesis2(&stream->synth) == 1) {
+            stream->buffer_pos = 0;
+            continue;
         }
 
-        if (aperiodicity) {
-            for (int i = 0; i < frame_count; i++) {
-                delete[] aperiodicity[i];
+        /* Starved: queue the next chunk of parameters from the latest notes */
+        if (stream->filled_end <= stream->next_chunk) {
+            UCRA_TRACE_BEGIN(chunk);
+            UCRA_Result result = fill_stream_chunks(stream, config);
+            UCRA_TRACE_END(chunk, "world.stream_chunk");
+            if (result != UCRA_SUCCESS) {
+                return result;
             }
-            delete[] aperiodicity;
+        }
+        int slot = static_cast<int>(stream->next_chunk % (2 * stream->queue)) * stream->chunk_frames;
+        if (AddParameters(stream->f0 + slot, stream->chunk_frames, stream->spectrogram + slot,
+                          stream->aperiodicity + slot, &stream->synth) == 1) {
+            stream->next_chunk++;
+            refused = 0;
+            continue;
         }
 
-        outResult->status = UCRA_ERR_INTERNAL;
-        return UCRA_ERR_INTERNAL;
+        /* Queue full yet nothing to synthesize: the synthesizer is stuck, restart it */
+        if (refused++ > 0 || !IsLocked(&stream->synth)) {
+            return UCRA_ERR_INTERNAL;
+        }
+        RefreshSynthesizer(&stream->synth);
     }
+    return UCRA_SUCCESS;
+}
+
+void ucra_world_stream_destroy(UCRA_WorldStream* stream) {
+    if (!stream) {
+        return;
+    }
+    if (stream->synth.buffer) {
+        DestroySynthesizer(&stream->synth);
+    }
+    free(stream->f0);
+    free(stream->arena.block);
+    free(stream->arena.rows);
+    free(stream->envelopes.templates);
+    free(stream);
+}
+
+/*
+ * synthesize_into() in windows of params->chunk_frames analysis frames on the realtime
+ * synthesizer, which carries the pulse phase and overlap from window to window. Output
+ * goes straight to dst as float, so besides dst the render holds 2 * queue windows of
+ * parameters whatever its length. With a pool, queue windows are filled at a time in
+ * parallel; the synthesis itself runs in order.
+ */
+static UCRA_Result synthesize_chunked(const UCRA_WorldParams* params, UCRA_WorldScratch* scratch,
+                                      UCRA_ThreadPool* pool, const UCRA_RenderConfig* config,
+                                      int output_length, float* dst) {
+    double samples_per_frame = params->sample_rate * params->frame_period / 1000.0;
+    uint32_t block_size = static_cast<uint32_t>(std::max(1.0, std::floor(params->chunk_frames * samples_per_frame)));
+    int queue = UCRA_WORLD_STREAM_QUEUE;
+    if (pool) {
+        queue = std::max(queue, static_cast<int>(ucra_pool_size(pool)));
+    }
+
+    UCRA_WorldStream* stream = nullptr;
+    UCRA_Result result = world_stream_create(params, block_size, params->chunk_frames, queue, &stream);
+    if (result != UCRA_SUCCESS) {
+        return result;
+    }
+    stream->pool = pool;
+    stream->workers = scratch;
+
+    /* mono and planar output synthesize one plane */
+    uint32_t layout = UCRA_RENDER_LAYOUT(config->flags);
+    UCRA_RenderConfig mono_config;
+    ucra_config_copy(&mono_config, config);
+    mono_config.channels = layout == UCRA_RENDER_LAYOUT_INTERLEAVED ? config->channels : 1;
+    UCRA_TRACE_BEGIN(synthesis);
+    try {
+        result = ucra_world_stream_render(stream, &mono_config, dst, static_cast<uint32_t>(output_length));
+    } catch (...) {
+        result = UCRA_ERR_INTERNAL;
+    }
+    UCRA_TRACE_END(synthesis, "world.chunked_synthesis");
+    ucra_world_stream_destroy(stream);
+    if (result == UCRA_SUCCESS && layout == UCRA_RENDER_LAYOUT_PLANAR) {
+        for (uint32_t ch = 1; ch < config->channels; ch++) {
+            memcpy(dst + static_cast<size_t>(ch) * output_length, dst, output_length * sizeof(float));
+        }
+    }
+    return result;
+}
+
+/* Synthesizer block size of engine-owned streams when the config does not name one */
+#define UCRA_WORLD_BLOCK_SIZE 512
+
+UCRA_Result ucra_render_block(UCRA_Handle engine,
+                              const UCRA_RenderConfig* config,
+                              uint64_t start_frame,
+                              uint32_t frame_count,
+                              float* out_pcm) {
+    const UCRA_LoadedEngine* loaded = ucra_loaded_engine(engine);
+    if (loaded) {
+        return UCRA_ENGINE_TABLE_HAS(loaded->table, render_block)
+                   ? loaded->table->render_block(loaded->inner, config, start_frame, frame_count, out_pcm)
+                   : UCRA_ERR_NOT_SUPPORTED;
+    }
+    if (!engine || !config || (frame_count > 0 && !out_pcm) || !layout_valid(config) ||
+        (config->note_count > 0 && !config->notes)) {
+        return UCRA_ERR_INVALID_ARGUMENT;
+    }
+
+    UCRA_WorldEngine* world_engine = reinterpret_cast<UCRA_WorldEngine*>(engine);
+    UCRA_WorldParams params = resolve_params(world_engine, config);
+
+    /* the realtime synthesizer only runs forward: a rate change or a backward seek restarts it */
+    UCRA_WorldStream* stream = world_engine->block_stream;
+    if (!stream || stream->params.sample_rate != params.sample_rate ||
+        start_frame < world_engine->block_next_frame) {
+        ucra_world_stream_destroy(stream);
+        world_engine->block_stream = nullptr;
+        uint32_t block_size = config->block_size > 0 ? config->block_size : UCRA_WORLD_BLOCK_SIZE;
+        UCRA_Result result = world_stream_create(&params, block_size, 0, UCRA_WORLD_STREAM_QUEUE,
+                                                 &world_engine->block_stream);
+        if (result != UCRA_SUCCESS) {
+            return result;
+        }
+        stream = world_engine->block_stream;
+        world_engine->block_next_frame = 0;
+    }
+
+    /* synthesize and drop the frames up to start_frame; nothing past the render is synthesized */
+    uint64_t output_length = static_cast<uint64_t>(std::max(0, compute_output_length(config, params.sample_rate)));
+    uint64_t skip_to = std::min(start_frame, output_length);
+    UCRA_RenderConfig mono_config;
+    ucra_config_copy(&mono_config, config);
+    mono_config.channels = 1;
+    float discard[UCRA_WORLD_BLOCK_SIZE];
+    while (world_engine->block_next_frame < skip_to) {
+        uint32_t n = static_cast<uint32_t>(std::min<uint64_t>(skip_to - world_engine->block_next_frame,
+                                                              UCRA_WORLD_BLOCK_SIZE));
+        UCRA_Result result = ucra_world_stream_render(stream, &mono_config, discard, n);
+        if (result != UCRA_SUCCESS) {
+            return result;
+        }
+        world_engine->block_next_frame += n;
+    }
+
+    /* mono and planar output synthesize one plane; frames past the render are silence */
+    uint32_t layout = UCRA_RENDER_LAYOUT(config->flags);
+    uint32_t channels = std::max<uint32_t>(config->channels, 1);
+    uint32_t stride = layout == UCRA_RENDER_LAYOUT_INTERLEAVED ? channels : 1;
+    uint32_t audible = start_frame >= output_length ? 0
+                       : static_cast<uint32_t>(std::min<uint64_t>(output_length - start_frame, frame_count));
+    mono_config.channels = stride;
+    UCRA_Result result = ucra_world_stream_render(stream, &mono_config, out_pcm, audible);
+    if (result != UCRA_SUCCESS) {
+        return result;
+    }
+    memset(out_pcm + static_cast<size_t>(audible) * stride, 0,
+           static_cast<size_t>(frame_count - audible) * stride * sizeof(float));
+    if (layout == UCRA_RENDER_LAYOUT_PLANAR) {
+        for (uint32_t ch = 1; ch < channels; ch++) {
+            memcpy(out_pcm + static_cast<size_t>(ch) * frame_count, out_pcm, frame_count * sizeof(float));
+        }
+    }
+    world_engine->block_next_frame += audible;
+    return UCRA_SUCCESS;
 }
 
 #else /* !UCRA_HAS_WORLD */
@@ -438,14 +1596,21 @@ UCRA_Result ucra_engine_create(UCRA_Handle* outEngine,
 }
 
 void ucra_engine_destroy(UCRA_Handle engine) {
-    (void)engine;
+    const UCRA_LoadedEngine* loaded = ucra_loaded_engine(engine);
+    if (loaded) {
+        ucra_loaded_engine_destroy(loaded);
+    }
 }
 
 UCRA_Result ucra_engine_getinfo(UCRA_Handle engine,
                                 char* outBuffer,
                                 size_t buffer_size) {
-    (void)engine;
-
+    const UCRA_LoadedEngine* loaded = ucra_loaded_engine(engine);
+    if (loaded) {
+        return UCRA_ENGINE_TABLE_HAS(loaded->table, engine_getinfo)
+                   ? loaded->table->engine_getinfo(loaded->inner, outBuffer, buffer_size)
+                   : UCRA_ERR_NOT_SUPPORTED;
+    }
     if (!outBuffer || buffer_size == 0) {
         return UCRA_ERR_INVALID_ARGUMENT;
     }
@@ -462,9 +1627,40 @@ UCRA_Result ucra_engine_getinfo(UCRA_Handle engine,
 UCRA_Result ucra_render(UCRA_Handle engine,
                         const UCRA_RenderConfig* config,
                         UCRA_RenderResult* outResult) {
-    (void)engine;
-    (void)config;
+    const UCRA_LoadedEngine* loaded = ucra_loaded_engine(engine);
+    if (loaded) return loaded->table->render(loaded->inner, config, outResult);
+    if (!outResult) {
+        return UCRA_ERR_INVALID_ARGUMENT;
+    }
 
+    outResult->status = UCRA_ERR_NOT_SUPPORTED;
+    return UCRA_ERR_NOT_SUPPORTED;
+}
+
+UCRA_Result ucra_render_query_size(UCRA_Handle engine,
+                                   const UCRA_RenderConfig* config,
+                                   uint64_t* out_frames,
+                                   uint64_t* out_samples) {
+    const UCRA_LoadedEngine* loaded = ucra_loaded_engine(engine);
+    if (loaded) {
+        return UCRA_ENGINE_TABLE_HAS(loaded->table, render_query_size)
+                   ? loaded->table->render_query_size(loaded->inner, config, out_frames, out_samples)
+                   : UCRA_ERR_NOT_SUPPORTED;
+    }
+    return UCRA_ERR_NOT_SUPPORTED;
+}
+
+UCRA_Result ucra_render_into(UCRA_Handle engine,
+                             const UCRA_RenderConfig* config,
+                             float* out_pcm,
+                             uint64_t capacity_samples,
+                             UCRA_RenderResult* outResult) {
+    const UCRA_LoadedEngine* loaded = ucra_loaded_engine(engine);
+    if (loaded) {
+        return UCRA_ENGINE_TABLE_HAS(loaded->table, render_into)
+                   ? loaded->table->render_into(loaded->inner, config, out_pcm, capacity_samples, outResult)
+                   : UCRA_ERR_NOT_SUPPORTED;
+    }
     if (!outResult) {
         return UCRA_ERR_INVALID_ARGUMENT;
     }
@@ -473,6 +1669,56 @@ UCRA_Result ucra_render(UCRA_Handle engine,
     return UCRA_ERR_NOT_SUPPORTED;
 }
 
+UCRA_Result ucra_render_batch(UCRA_Handle engine,
+                              const UCRA_RenderConfig* configs,
+                              UCRA_RenderResult* results,
+                              uint32_t count) {
+    const UCRA_LoadedEngine* loaded = ucra_loaded_engine(engine);
+    if (loaded) {
+        return UCRA_ENGINE_TABLE_HAS(loaded->table, render_batch)
+                   ? loaded->table->render_batch(loaded->inner, configs, results, count)
+                   : UCRA_ERR_NOT_SUPPORTED;
+    }
+    if (count > 0 && !results) {
+        return UCRA_ERR_INVALID_ARGUMENT;
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+        results[i].status = UCRA_ERR_NOT_SUPPORTED;
+    }
+    return UCRA_ERR_NOT_SUPPORTED;
+}
+
+UCRA_Result ucra_render_block(UCRA_Handle engine,
+                              const UCRA_RenderConfig* config,
+                              uint64_t start_frame,
+                              uint32_t frame_count,
+                              float* out_pcm) {
+    const UCRA_LoadedEngine* loaded = ucra_loaded_engine(engine);
+    if (loaded) {
+        return UCRA_ENGINE_TABLE_HAS(loaded->table, render_block)
+                   ? loaded->table->render_block(loaded->inner, config, start_frame, frame_count, out_pcm)
+                   : UCRA_ERR_NOT_SUPPORTED;
+    }
+    return UCRA_ERR_NOT_SUPPORTED;
+}
+
 #endif /* UCRA_HAS_WORLD */
 
+UCRA_Result ucra_engine_get_capabilities(UCRA_Handle engine, uint32_t* out_caps) {
+    if (!engine || !out_caps) {
+        return UCRA_ERR_INVALID_ARGUMENT;
+    }
+    const UCRA_LoadedEngine* loaded = ucra_loaded_engine(engine);
+    *out_caps = 0;
+    if (loaded) {
+        return UCRA_ENGINE_TABLE_HAS(loaded->table, engine_get_capabilities)
+                   ? loaded->table->engine_get_capabilities(loaded->inner, out_caps)
+                   : UCRA_SUCCESS;
+    }
+    /* WORLD's pulse phase runs along the whole timeline, and blocks use the realtime
+     * synthesizer where renders use the offline one: no note-local output */
+    return UCRA_SUCCESS;
+}
+
 } /* extern "C" */
@@ -0,0 +1,42 @@
+/*
+ * UCRA WORLD Streaming (internal)
+ * Block-incremental WORLD synthesis behind the stream API, built on WORLD's
+ * realtime synthesizer. Only available when UCRA_HAS_WORLD is defined.
+ */
+#ifndef UCRA_WORLD_STREAM_H
+#define UCRA_WORLD_STREAM_H
+
+#include "ucra/ucra.h"
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct UCRA_WorldStream UCRA_WorldStream;
+
+/**
+ * @brief Create a WORLD synthesizer emitting block_size frames per step
+ * @return UCRA_SUCCESS, UCRA_ERR_INVALID_ARGUMENT or UCRA_ERR_OUT_OF_MEMORY
+ */
+UCRA_Result ucra_world_stream_create(uint32_t sample_rate, uint32_t block_size,
+                                     UCRA_WorldStream** out_stream);
+
+/**
+ * @brief Synthesize the next frames of the stream timeline
+ *
+ * Parameters are derived from config->notes (absolute times) just before they
+ * are needed, so each call should pass the most recent notes. Writes
+ * frames * config->channels interleaved samples to out.
+ */
+UCRA_Result ucra_world_stream_render(UCRA_WorldStream* stream, const UCRA_RenderConfig* config,
+                                     float* out, uint32_t frames);
+
+void ucra_world_stream_destroy(UCRA_WorldStream* stream);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* UCRA_WORLD_STREAM_H */
@@ -0,0 +1,234 @@
+/*
+ * Test for the UCRA analysis cache
+ * Checks the WAV reader, the cache file round trip and that the store only
+ * analyzes a sample again when the WAV or the options change
+ */
+
+#include "ucra_analysis.h"
+#include "ucra_wav.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <math.h>
+
+#define TEST_WAV "test_analysis_sample.wav"
+
+static void put_le32(FILE* file, uint32_t v) {
+    unsigned char b[4] = { (unsigned char)v, (unsigned char)(v >> 8), (unsigned char)(v >> 16), (unsigned char)(v >> 24) };
+    fwrite(b, 1, 4, file);
+}
+
+static void put_le16(FILE* file, uint16_t v) {
+    unsigned char b[2] = { (unsigned char)v, (unsigned char)(v >> 8) };
+    fwrite(b, 1, 2, file);
+}
+
+/* 16-bit stereo WAV with a LIST chunk before the data, left = right = ramp * amp */
+static void write_test_wav(const char* path, uint32_t frames, int16_t amp) {
+    FILE* file = fopen(path, "wb");
+    assert(file != NULL);
+    uint32_t data_size = frames * 4;
+    fwrite("RIFF", 1, 4, file);
+    put_le32(file, 4 + (8 + 16) + (8 + 4) + (8 + data_size));
+    fwrite("WAVE", 1, 4, file);
+    fwrite("fmt ", 1, 4, file);
+    put_le32(file, 16);
+    put_le16(file, 1);
+    put_le16(file, 2);
+    put_le32(file, 8000);
+    put_le32(file, 8000 * 4);
+    put_le16(file, 4);
+    put_le16(file, 16);
+    fwrite("LIST", 1, 4, file);
+    put_le32(file, 4);
+    fwrite("INFO", 1, 4, file);
+    fwrite("data", 1, 4, file);
+    put_le32(file, data_size);
+    for (uint32_t n = 0; n < frames; n++) {
+        int16_t v = (int16_t)((int32_t)amp * (int32_t)(n % 8) / 8);
+        put_le16(file, (uint16_t)v);
+        put_le16(file, (uint16_t)v);
+    }
+    fclose(file);
+}
+
+/* 24-bit stereo RF64 in WAVE_FORMAT_EXTENSIBLE, with a chunk after the data that is not audio */
+static void write_rf64_wav(const char* path, uint32_t frames) {
+    FILE* file = fopen(path, "wb");
+    assert(file != NULL);
+    uint32_t data_size = frames * 6;
+    fwrite("RF64", 1, 4, file);
+    put_le32(file, 0xFFFFFFFFu);
+    fwrite("WAVE", 1, 4, file);
+    fwrite("ds64", 1, 4, file);
+    put_le32(file, 28);
+    put_le32(file, 0); put_le32(file, 0); /* RIFF size, not read */
+    put_le32(file, data_size); put_le32(file, 0);
+    put_le32(file, frames); put_le32(file, 0);
+    put_le32(file, 0);
+    fwrite("fmt ", 1, 4, file);
+    put_le32(file, 40);
+    put_le16(file, 0xFFFE);
+    put_le16(file, 2);
+    put_le32(file, 8000);
+    put_le32(file, 8000 * 6);
+    put_le16(file, 6);
+    put_le16(file, 24);
+    put_le16(file, 22);
+    put_le16(file, 24);
+    put_le32(file, 3);
+    put_le16(file, 1); /* sub-format: PCM */
+    for (int i = 0; i < 14; i++) fputc(0, file);
+    fwrite("data", 1, 4, file);
+    put_le32(file, 0xFFFFFFFFu);
+    for (uint32_t n = 0; n < frames; n++) {
+        int32_t left = (int32_t)(n * 1000) - 4194304, right = left / 2;
+        unsigned char b[6] = { (unsigned char)left, (unsigned char)(left >> 8), (unsigned char)(left >> 16),
+                               (unsigned char)right, (unsigned char)(right >> 8), (unsigned char)(right >> 16) };
+        fwrite(b, 1, 6, file);
+    }
+    fwrite("junk", 1, 4, file);
+    put_le32(file, 4);
+    put_le32(file, 0x7F7F7F7F);
+    fclose(file);
+}
+
+static int analyze_calls = 0;
+
+/* fake analyzer: one frame per 80 samples holding the frame's mean level */
+static UCRA_Result fake_analyze(void* ctx, const float* samples, uint32_t length,
+                                uint32_t sample_rate, UCRA_AnalysisData* out) {
+    (void)ctx;
+    analyze_calls++;
+    uint32_t frames = length / 80, bins = 5;
+    float* f0 = malloc(frames * sizeof(float));
+    float* sp = malloc(frames * bins * sizeof(float));
+    float* ap = malloc(frames * bins * sizeof(float));
+    assert(f0 && sp && ap);
+    for (uint32_t i = 0; i < frames; i++) {
+        f0[i] = 100.0f + (float)i;
+        for (uint32_t j = 0; j < bins; j++) {
+            sp[i * bins + j] = samples[i * 80 + j];
+            ap[i * bins + j] = 0.5f;
+        }
+    }
+    out->sample_rate = sample_rate;
+    out->frame_period = 10.0;
+    out->frame_count = frames;
+    out->bins = bins;
+    out->f0 = f0;
+    out->spectrogram = sp;
+    out->aperiodicity = ap;
+    return UCRA_SUCCESS;
+}
+
+static void test_wav_reader() {
+    printf("Testing WAV reader...\n");
+    write_test_wav(TEST_WAV, 800, 16384);
+
+    float* samples = NULL;
+    uint32_t length = 0, rate = 0;
+    assert(ucra_wav_read_mono(TEST_WAV, &samples, &length, &rate) == UCRA_SUCCESS);
+    assert(length == 800 && rate == 8000);
+    assert(fabsf(samples[4] - 0.25f) < 1e-6f);
+    free(samples);
+
+    /* a region of the mapped file decodes like the same frames of the whole read */
+    UCRA_WavMap wav;
+    float region[16];
+    assert(ucra_wav_map(TEST_WAV, &wav) == UCRA_SUCCESS);
+    assert(wav.frames == 800 && wav.sample_rate == 8000 && wav.channels == 2 && wav.bits == 16);
+    assert(ucra_wav_read_region(&wav, 795, 16, region) == 5);
+    assert(fabsf(region[0] - 0.1875f) < 1e-6f && fabsf(region[4] - 0.4375f) < 1e-6f);
+    assert(ucra_wav_read_region(&wav, 800, 16, region) == 0);
+    ucra_wav_unmap(&wav);
+    ucra_wav_unmap(&wav);
+
+    /* RF64 takes the data size from ds64, so the chunk after the data is not read as frames */
+    write_rf64_wav(TEST_WAV, 1001);
+    assert(ucra_wav_map(TEST_WAV, &wav) == UCRA_SUCCESS);
+    assert(wav.frames == 1001 && wav.channels == 2 && wav.bits == 24 && wav.format == 1);
+    float* mono = malloc(1001 * sizeof(float));
+    assert(mono && ucra_wav_read_region(&wav, 0, 1001, mono) == 1001);
+    for (uint32_t n = 0; n < 1001; n++) {
+        int32_t left = (int32_t)(n * 1000) - 4194304;
+        assert(fabsf(mono[n] - 0.75f * left / 8388608.0f) < 1e-6f);
+    }
+    ucra_wav_unmap(&wav);
+    free(mono);
+    remove(TEST_WAV);
+
+    assert(ucra_wav_read_mono("does_not_exist.wav", &samples, &length, &rate) == UCRA_ERR_FILE_NOT_FOUND);
+    assert(ucra_wav_map("does_not_exist.wav", &wav) == UCRA_ERR_FILE_NOT_FOUND);
+    printf("✓ WAV reader test passed\n");
+}
+
+static void test_cache_path() {
+    printf("Testing cache file naming...\n");
+    char path[64];
+    assert(ucra_analysis_cache_path("vb/a.wav", path, sizeof(path)) == UCRA_SUCCESS);
+    assert(strcmp(path, "vb/a_wav.ucra") == 0);
+    assert(ucra_analysis_cache_path("vb/a.wav", path, 8) == UCRA_ERR_INVALID_ARGUMENT);
+    printf("✓ Cache file naming test passed\n");
+}
+
+static void test_store() {
+    printf("Testing analysis store...\n");
+    char cache_path[64];
+    ucra_analysis_cache_path(TEST_WAV, cache_path, sizeof(cache_path));
+    remove(cache_path);
+    write_test_wav(TEST_WAV, 800, 16384);
+
+    UCRA_AnalysisOptions options = { 10.0, 71.0, 800.0, 0 };
+    UCRA_AnalysisStore* store = NULL;
+    assert(ucra_analysis_store_create(&options, fake_analyze, NULL, &store) == UCRA_SUCCESS);
+
+    /* the first use analyzes and writes the cache file; repeats are served from the store */
+    analyze_calls = 0;
+    const UCRA_AnalysisData* data = NULL;
+    assert(ucra_analysis_store_get(store, TEST_WAV, &data) == UCRA_SUCCESS);
+    assert(data->frame_count == 10 && data->bins == 5 && data->sample_rate == 8000);
+    assert(data->f0[3] == 103.0f && fabsf(data->spectrogram[1 * 5 + 4] - 0.25f) < 1e-6f);
+    const UCRA_AnalysisData* again = NULL;
+    assert(ucra_analysis_store_get(store, TEST_WAV, &again) == UCRA_SUCCESS && again == data);
+    assert(analyze_calls == 1 && ucra_analysis_store_analyzed(store) == 1);
+
+    /* missing samples fail the same way every time */
+    assert(ucra_analysis_store_get(store, "missing.wav", &again) == UCRA_ERR_FILE_NOT_FOUND);
+    assert(ucra_analysis_store_get(store, "missing.wav", &again) == UCRA_ERR_FILE_NOT_FOUND);
+    ucra_analysis_store_destroy(store);
+
+    /* a new store loads the file instead of analyzing */
+    assert(ucra_analysis_store_create(&options, fake_analyze, NULL, &store) == UCRA_SUCCESS);
+    assert(ucra_analysis_store_get(store, TEST_WAV, &data) == UCRA_SUCCESS);
+    assert(analyze_calls == 1 && data->f0[9] == 109.0f);
+    ucra_analysis_store_destroy(store);
+
+    /* changed options or a changed WAV make the file stale */
+    UCRA_AnalysisOptions other = options;
+    other.frame_period = 5.0;
+    assert(ucra_analysis_store_create(&other, fake_analyze, NULL, &store) == UCRA_SUCCESS);
+    assert(ucra_analysis_store_get(store, TEST_WAV, &data) == UCRA_SUCCESS);
+    assert(analyze_calls == 2);
+    ucra_analysis_store_destroy(store);
+
+    write_test_wav(TEST_WAV, 800, 8192);
+    assert(ucra_analysis_store_create(&other, fake_analyze, NULL, &store) == UCRA_SUCCESS);
+    assert(ucra_analysis_store_get(store, TEST_WAV, &data) == UCRA_SUCCESS);
+    assert(analyze_calls == 3 && fabsf(data->spectrogram[1 * 5 + 4] - 0.125f) < 1e-6f);
+    ucra_analysis_store_destroy(store);
+
+    remove(cache_path);
+    remove(TEST_WAV);
+    printf("✓ Analysis store test passed\n");
+}
+
+int main() {
+    printf("=== UCRA Analysis Cache Tests ===\n");
+    test_wav_reader();
+    test_cache_path();
+    test_store();
+    printf("All analysis cache tests passed!\n");
+    return 0;
+}
@@ -0,0 +1,136 @@
+/*
+ * Test for the UCRA curve evaluation module
+ * Checks the step/linear/cubic kernels and that cursors agree with fresh seeks
+ */
+
+#include "ucra_curve.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <math.h>
+
+static double sample_fresh(const UCRA_F0Curve* curve, UCRA_CurveInterp interp, double t) {
+    UCRA_CurveCursor cursor;
+    ucra_curve_cursor_f0(&cursor, curve);
+    ucra_curve_seek(&cursor, t);
+    return ucra_curve_sample(&cursor, interp, t);
+}
+
+static void test_interpolation_kernels() {
+    printf("Testing curve interpolation kernels...\n");
+
+    float times[] = { 0.0f, 0.1f, 0.2f, 0.3f };
+    float f0s[] = { 200.0f, 300.0f, 400.0f, 500.0f };
+    UCRA_F0Curve curve = { times, f0s, 4 };
+
+    /* step holds the last point at or before t, including the final point */
+    assert(sample_fresh(&curve, UCRA_CURVE_STEP, -1.0) == 200.0);
+    assert(sample_fresh(&curve, UCRA_CURVE_STEP, 0.15) == 300.0);
+    assert(sample_fresh(&curve, UCRA_CURVE_STEP, 0.35) == 500.0);
+
+    /* linear data is reproduced exactly by both linear and cubic */
+    assert(fabs(sample_fresh(&curve, UCRA_CURVE_LINEAR, 0.15) - 350.0) < 1e-3);
+    assert(fabs(sample_fresh(&curve, UCRA_CURVE_CUBIC, 0.15) - 350.0) < 1e-3);
+    assert(fabs(sample_fresh(&curve, UCRA_CURVE_CUBIC, 0.05) - 250.0) < 1e-3);
+
+    /* cubic passes through the points */
+    float bent[] = { 200.0f, 320.0f, 250.0f, 500.0f };
+    UCRA_F0Curve bent_curve = { times, bent, 4 };
+    for (int i = 0; i < 4; i++) {
+        assert(fabs(sample_fresh(&bent_curve, UCRA_CURVE_CUBIC, times[i]) - bent[i]) < 1e-3);
+    }
+
+    /* F0 never interpolates into or out of an unvoiced point */
+    float gaps[] = { 200.0f, 0.0f, 400.0f, 500.0f };
+    UCRA_F0Curve gap_curve = { times, gaps, 4 };
+    assert(sample_fresh(&gap_curve, UCRA_CURVE_LINEAR, 0.05) == 200.0);
+    assert(sample_fresh(&gap_curve, UCRA_CURVE_CUBIC, 0.15) == 0.0);
+
+    printf("✓ Curve interpolation kernels test passed\n");
+}
+
+static void test_cursor_matches_seek() {
+    printf("Testing curve cursors against seeks...\n");
+
+    /* dense 5 ms curve, as exported by editors */
+    enum { POINTS = 2000 };
+    float* times = malloc(POINTS * sizeof(float));
+    float* f0s = malloc(POINTS * sizeof(float));
+    assert(times && f0s);
+    for (int i = 0; i < POINTS; i++) {
+        times[i] = (float)(i * 0.005);
+        f0s[i] = (float)(220.0 + 30.0 * sin(i * 0.05));
+    }
+    UCRA_F0Curve curve = { times, f0s, POINTS };
+
+    UCRA_CurveInterp modes[] = { UCRA_CURVE_STEP, UCRA_CURVE_LINEAR, UCRA_CURVE_CUBIC };
+    for (int m = 0; m < 3; m++) {
+        UCRA_CurveCursor cursor;
+        ucra_curve_cursor_f0(&cursor, &curve);
+
+        /* block sampling walks forward through the whole curve */
+        enum { BLOCK = 256 };
+        double out[BLOCK];
+        double dt = 1.0 / 44100.0;
+        for (int b = 0; b < 40; b++) {
+            double t0 = b * BLOCK * dt;
+            ucra_curve_sample_block(&cursor, modes[m], t0, dt, BLOCK, out);
+            for (int i = 0; i < BLOCK; i += 17) {
+                assert(out[i] == sample_fresh(&curve, modes[m], t0 + i * dt));
+            }
+        }
+
+        /* jumps in either direction land on the same values */
+        double jumps[] = { 9.0, 0.5, 3.2, 3.2001, 0.0 };
+        for (int j = 0; j < 5; j++) {
+            assert(ucra_curve_sample(&cursor, modes[m], jumps[j]) ==
+                   sample_fresh(&curve, modes[m], jumps[j]));
+        }
+    }
+
+    free(times);
+    free(f0s);
+    printf("✓ Curve cursor test passed\n");
+}
+
+static void test_interp_options() {
+    printf("Testing curve interpolation option parsing...\n");
+
+    UCRA_KeyValue options[] = { { "other", "x" }, { UCRA_CURVE_INTERP_OPTION, "cubic" } };
+    assert(ucra_curve_interp_from_options(options, 2) == UCRA_CURVE_CUBIC);
+    assert(ucra_curve_interp_from_options(options, 1) == UCRA_CURVE_STEP);
+    assert(ucra_curve_interp_from_options(NULL, 0) == UCRA_CURVE_STEP);
+
+    UCRA_CurveInterp interp;
+    assert(ucra_curve_parse_interp("linear", &interp) == UCRA_SUCCESS && interp == UCRA_CURVE_LINEAR);
+    assert(ucra_curve_parse_interp("spline", &interp) == UCRA_ERR_INVALID_ARGUMENT);
+
+    /* a typed option wins over the string one, but only when the config says it has them */
+    UCRA_TypedValue typed[] = { { UCRA_CURVE_INTERP_OPTION, UCRA_VALUE_INT, UCRA_CURVE_LINEAR, NULL } };
+    UCRA_RenderConfig config = { 44100, 1, 256, 0, NULL, 0, options, 2, typed, 1 };
+    assert(ucra_curve_interp_from_config(&config) == UCRA_CURVE_CUBIC);
+    config.flags = UCRA_RENDER_TYPED_OPTIONS;
+    assert(ucra_curve_interp_from_config(&config) == UCRA_CURVE_LINEAR);
+    typed[0].type = UCRA_VALUE_ENUM;
+    typed[0].text = "cubic";
+    assert(ucra_curve_interp_from_config(&config) == UCRA_CURVE_CUBIC);
+    typed[0].type = UCRA_VALUE_STRING;
+    typed[0].text = "spline";
+    assert(ucra_curve_interp_from_config(&config) == UCRA_CURVE_STEP);
+    config.typed_option_count = 0;
+    assert(ucra_curve_interp_from_config(&config) == UCRA_CURVE_CUBIC);
+    assert(ucra_curve_interp_from_config(NULL) == UCRA_CURVE_STEP);
+
+    printf("✓ Curve option test passed\n");
+}
+
+int main() {
+    printf("Running UCRA curve tests...\n\n");
+
+    test_interpolation_kernels();
+    test_cursor_matches_seek();
+    test_interp_options();
+
+    printf("\n✓ All curve tests passed!\n");
+    return 0;
+}
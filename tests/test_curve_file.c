@@ -0,0 +1,187 @@
+/*
+ * Test for the UCRA F0 curve files
+ * Checks the text parser against strtod, the lines it skips, the binary
+ * format round trip and the rejection of malformed files
+ */
+
+#include "ucra/ucra.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <math.h>
+
+#define TEXT_FILE "curve_file_test.txt"
+#define BINARY_FILE "curve_file_test.ucf0"
+
+static void write_file(const char* path, const void* bytes, size_t size) {
+    FILE* file = fopen(path, "wb");
+    assert(file != NULL);
+    assert(fwrite(bytes, 1, size, file) == size);
+    fclose(file);
+}
+
+static void test_text_lines() {
+    printf("Testing text curve lines...\n");
+    const char* text =
+        "\xEF\xBB\xBF# time f0\n"
+        "0 220\n"
+        "\n"
+        "  0.005\t221.5   trailing words\r\n"
+        "not a point\n"
+        "   # indented comment\n"
+        "1e-2 +2.225e2\n"
+        "-0.5 -0\n"
+        "7\n"
+        ".25 3.\n"
+        "0.03 230"; /* no final newline */
+    write_file(TEXT_FILE, text, strlen(text));
+
+    UCRA_F0FileHandle file = NULL;
+    UCRA_F0Curve curve;
+    assert(ucra_f0_curve_open(&file, TEXT_FILE, &curve) == UCRA_SUCCESS && file != NULL);
+    float expected_time[6] = { 0.0f, 0.005f, 0.01f, -0.5f, 0.25f, 0.03f };
+    float expected_f0[6] = { 220.0f, 221.5f, 222.5f, -0.0f, 3.0f, 230.0f };
+    assert(curve.length == 6);
+    for (uint32_t i = 0; i < 6; i++) {
+        assert(curve.time_sec[i] == expected_time[i]);
+        assert(curve.f0_hz[i] == expected_f0[i]);
+    }
+    ucra_f0_curve_close(file);
+    remove(TEXT_FILE);
+    printf("✓ Text line test passed\n");
+}
+
+static void test_text_numbers() {
+    printf("Testing the number scanner against strtod...\n");
+    enum { POINTS = 20000 };
+    char* text = malloc(POINTS * 64);
+    assert(text != NULL);
+    size_t used = 0;
+    srand(1234);
+    for (int i = 0; i < POINTS; i++) {
+        double time = i * 0.005 + rand() / (double)RAND_MAX * 1e-4;
+        double f0 = rand() / (double)RAND_MAX * 1000.0;
+        const char* format = i % 3 == 0 ? "%.6f %.3f\n" : i % 3 == 1 ? "%.9g %.9g\n" : "%.12g %.4e\n";
+        used += (size_t)sprintf(text + used, format, time, f0);
+    }
+    write_file(TEXT_FILE, text, used);
+
+    UCRA_F0FileHandle file = NULL;
+    UCRA_F0Curve curve;
+    assert(ucra_f0_curve_open(&file, TEXT_FILE, &curve) == UCRA_SUCCESS);
+    assert(curve.length == POINTS);
+    /* up to 15 significant digits, strtod's double rounded to float is what the scanner must give */
+    char* p = text;
+    for (uint32_t i = 0; i < curve.length; i++) {
+        float time = (float)strtod(p, &p);
+        float f0 = (float)strtod(p, &p);
+        assert(curve.time_sec[i] == time);
+        assert(curve.f0_hz[i] == f0);
+    }
+    ucra_f0_curve_close(file);
+
+    /* exponents past the exact powers of ten only need to land close */
+    const char* extreme = "1.5e-30 12345678901234567890123\n";
+    write_file(TEXT_FILE, extreme, strlen(extreme));
+    assert(ucra_f0_curve_open(&file, TEXT_FILE, &curve) == UCRA_SUCCESS && curve.length == 1);
+    assert(fabsf(curve.time_sec[0] / 1.5e-30f - 1.0f) < 1e-6f);
+    assert(fabsf(curve.f0_hz[0] / 1.2345679e22f - 1.0f) < 1e-6f);
+    ucra_f0_curve_close(file);
+
+    free(text);
+    remove(TEXT_FILE);
+    printf("✓ Number scanner test passed\n");
+}
+
+static void test_binary_round_trip() {
+    printf("Testing the binary curve format...\n");
+    enum { POINTS = 1000 };
+    static float time_sec[POINTS], f0_hz[POINTS];
+    for (int i = 0; i < POINTS; i++) {
+        time_sec[i] = i * 0.005f;
+        f0_hz[i] = 220.0f + (float)sin(i * 0.05) * 10.0f;
+    }
+    UCRA_F0Curve source = { time_sec, f0_hz, POINTS };
+    assert(ucra_f0_curve_save(BINARY_FILE, &source) == UCRA_SUCCESS);
+
+    FILE* raw = fopen(BINARY_FILE, "rb");
+    assert(raw != NULL);
+    unsigned char header[16];
+    assert(fread(header, 1, 16, raw) == 16);
+    fseek(raw, 0, SEEK_END);
+    assert(ftell(raw) == 16 + POINTS * 8);
+    fclose(raw);
+    assert(memcmp(header, "UCF0", 4) == 0 && header[4] == 1 && header[8] == (POINTS & 0xFF));
+
+    UCRA_F0FileHandle file = NULL;
+    UCRA_F0Curve curve;
+    assert(ucra_f0_curve_open(&file, BINARY_FILE, &curve) == UCRA_SUCCESS);
+    assert(curve.length == POINTS);
+    assert(memcmp(curve.time_sec, time_sec, sizeof(time_sec)) == 0);
+    assert(memcmp(curve.f0_hz, f0_hz, sizeof(f0_hz)) == 0);
+
+    f0_hz[0] = 1.0f;
+    source.length = 1;
+#ifndef _WIN32
+    /* saving over a file that is still open leaves the open curve intact */
+    assert(ucra_f0_curve_save(BINARY_FILE, &source) == UCRA_SUCCESS);
+    assert(curve.f0_hz[0] != 1.0f && curve.f0_hz[POINTS - 1] == f0_hz[POINTS - 1]);
+    ucra_f0_curve_close(file);
+#else
+    ucra_f0_curve_close(file); /* an open file cannot be replaced */
+    assert(ucra_f0_curve_save(BINARY_FILE, &source) == UCRA_SUCCESS);
+#endif
+    assert(ucra_f0_curve_open(&file, BINARY_FILE, &curve) == UCRA_SUCCESS);
+    assert(curve.length == 1 && curve.f0_hz[0] == 1.0f);
+    ucra_f0_curve_close(file);
+
+    remove(BINARY_FILE);
+    printf("✓ Binary round trip test passed\n");
+}
+
+static void test_invalid_files() {
+    printf("Testing invalid curve files...\n");
+    UCRA_F0FileHandle file = NULL;
+    UCRA_F0Curve curve;
+    assert(ucra_f0_curve_open(NULL, TEXT_FILE, &curve) == UCRA_ERR_INVALID_ARGUMENT);
+    assert(ucra_f0_curve_open(&file, NULL, &curve) == UCRA_ERR_INVALID_ARGUMENT);
+    assert(ucra_f0_curve_open(&file, TEXT_FILE, NULL) == UCRA_ERR_INVALID_ARGUMENT);
+    assert(ucra_f0_curve_open(&file, "curve_file_missing.txt", &curve) == UCRA_ERR_FILE_NOT_FOUND);
+    assert(file == NULL);
+
+    write_file(TEXT_FILE, "", 0);
+    assert(ucra_f0_curve_open(&file, TEXT_FILE, &curve) == UCRA_ERR_INVALID_ARGUMENT);
+    const char* comments = "# nothing\n\n- .\n";
+    write_file(TEXT_FILE, comments, strlen(comments));
+    assert(ucra_f0_curve_open(&file, TEXT_FILE, &curve) == UCRA_ERR_INVALID_ARGUMENT);
+
+    /* a binary header whose count does not match the size, and an unknown version */
+    unsigned char binary[24] = { 'U', 'C', 'F', '0', 1, 0, 0, 0, 2, 0, 0, 0 };
+    write_file(BINARY_FILE, binary, sizeof(binary));
+    assert(ucra_f0_curve_open(&file, BINARY_FILE, &curve) == UCRA_ERR_INVALID_ARGUMENT);
+    binary[4] = 2;
+    binary[8] = 1;
+    write_file(BINARY_FILE, binary, sizeof(binary));
+    assert(ucra_f0_curve_open(&file, BINARY_FILE, &curve) == UCRA_ERR_INVALID_ARGUMENT);
+    assert(file == NULL);
+
+    UCRA_F0Curve empty = { NULL, NULL, 0 };
+    assert(ucra_f0_curve_save(BINARY_FILE, &empty) == UCRA_ERR_INVALID_ARGUMENT);
+    assert(ucra_f0_curve_save(NULL, &curve) == UCRA_ERR_INVALID_ARGUMENT);
+    ucra_f0_curve_close(NULL);
+
+    remove(TEXT_FILE);
+    remove(BINARY_FILE);
+    printf("✓ Invalid file test passed\n");
+}
+
+int main() {
+    printf("=== UCRA F0 Curve File Tests ===\n");
+    test_text_lines();
+    test_text_numbers();
+    test_binary_round_trip();
+    test_invalid_files();
+    printf("All F0 curve file tests passed!\n");
+    return 0;
+}
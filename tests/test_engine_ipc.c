@@ -0,0 +1,189 @@
+/*
+ * Test for engines served by a host process
+ * An "ipc" manifest entry renders, sizes, reports and streams through the
+ * ordinary API exactly as the engine does in-process, renders longer than
+ * the shared rings arrive whole, and a crashing host fails its engine's calls
+ * without taking this process down.
+ */
+
+#include "ucra/ucra.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+/* Set by CMake to ucra_engine_host and test_engine_ipc_host */
+#ifndef UCRA_TEST_ENGINE_HOST
+#error "UCRA_TEST_ENGINE_HOST must name the engine host executable"
+#endif
+
+static UCRA_Manifest make_manifest(const char* path) {
+    UCRA_Manifest manifest;
+    memset(&manifest, 0, sizeof(manifest));
+    manifest.name = "IPC Test";
+    manifest.version = "1.0";
+    manifest.entry.type = "ipc";
+    manifest.entry.path = path;
+    return manifest;
+}
+
+static UCRA_RenderConfig make_config(const UCRA_NoteSegment* notes, uint32_t count, uint32_t channels) {
+    UCRA_RenderConfig config;
+    memset(&config, 0, sizeof(config));
+    config.sample_rate = 44100;
+    config.channels = channels;
+    config.block_size = 512;
+    config.notes = notes;
+    config.note_count = count;
+    return config;
+}
+
+static UCRA_Result UCRA_CALL keep_config(void* user_data, UCRA_RenderConfig* out_config) {
+    (void)user_data;
+    (void)out_config;
+    return UCRA_STREAM_UNCHANGED;
+}
+
+static void test_matches_in_process(void) {
+    printf("Testing renders through a host process...\n");
+    UCRA_Manifest manifest = make_manifest(UCRA_TEST_ENGINE_HOST);
+    UCRA_Handle remote = NULL, local = NULL;
+    assert(ucra_engine_create_from_manifest(&remote, &manifest, NULL, NULL, 0) == UCRA_SUCCESS);
+    assert(ucra_engine_create(&local, NULL, 0) == UCRA_SUCCESS);
+
+    /* the host serves the same engine this process builds in */
+    char info[128], local_info[128];
+    assert(ucra_engine_getinfo(remote, info, sizeof(info)) == UCRA_SUCCESS);
+    assert(ucra_engine_getinfo(local, local_info, sizeof(local_info)) == UCRA_SUCCESS);
+    assert(strcmp(info, local_info) == 0);
+#ifndef UCRA_HAS_WORLD
+    assert(strstr(info, "Reference Engine") != NULL);
+#endif
+    uint32_t caps = 0, local_caps = 0;
+    assert(ucra_engine_get_capabilities(remote, &caps) == UCRA_SUCCESS);
+    assert(ucra_engine_get_capabilities(local, &local_caps) == UCRA_SUCCESS);
+    assert(caps == local_caps);
+
+    /* 3 s of stereo is far more than the response ring holds; curves and lyrics go along */
+    static const float f0_time[] = { 0.0f, 0.5f, 1.0f };
+    static const float f0_hz[] = { 440.0f, 466.2f, 440.0f };
+    static const float env_time[] = { 0.0f, 1.0f };
+    static const float env_value[] = { 1.0f, 0.25f };
+    UCRA_F0Curve f0 = { f0_time, f0_hz, 3 };
+    UCRA_EnvCurve env = { env_time, env_value, 2 };
+    UCRA_NoteSegment notes[] = {
+        { 0.0, 1.0, 69, 100, "a", &f0, &env },
+        { 1.0, 1.0, 72, 80, NULL, NULL, NULL },
+        { 2.0, 1.0, 64, 120, "ka", NULL, &env }
+    };
+    UCRA_RenderConfig config = make_config(notes, 3, 2);
+
+    UCRA_RenderResult expected, result;
+    assert(ucra_render(local, &config, &expected) == UCRA_SUCCESS);
+    assert(ucra_render(remote, &config, &result) == UCRA_SUCCESS);
+    assert(result.status == UCRA_SUCCESS && result.frames == expected.frames && result.frames == 3 * 44100);
+    assert(result.channels == 2 && result.sample_rate == 44100);
+    assert(memcmp(result.pcm, expected.pcm, (size_t)result.frames * 2 * sizeof(float)) == 0);
+
+    uint64_t frames = 0, samples = 0;
+    assert(ucra_render_query_size(remote, &config, &frames, &samples) == UCRA_SUCCESS);
+    assert(frames == expected.frames && samples == frames * 2);
+
+    /* render_into receives straight into the caller's buffer, and refuses a short one */
+    float* pcm = malloc((size_t)samples * sizeof(float));
+    assert(pcm != NULL);
+    assert(ucra_render_into(remote, &config, pcm, samples, &result) == UCRA_SUCCESS);
+    assert(result.pcm == pcm && memcmp(pcm, expected.pcm, (size_t)samples * sizeof(float)) == 0);
+    assert(ucra_render_into(remote, &config, pcm, samples - 1, &result) == UCRA_ERR_INVALID_ARGUMENT);
+
+    /* the engine is still in step after the refused render */
+    config.flags = UCRA_RENDER_LAYOUT_MONO;
+    assert(ucra_render(local, &config, &expected) == UCRA_SUCCESS);
+    assert(ucra_render(remote, &config, &result) == UCRA_SUCCESS);
+    assert(memcmp(result.pcm, expected.pcm, (size_t)result.frames * sizeof(float)) == 0);
+    config.flags = 0;
+    free(pcm);
+
+    /* engine-backed streams render block by block in the host */
+    UCRA_StreamHandle remote_stream = NULL, local_stream = NULL;
+    UCRA_KeyValue stream_options[] = { { "stream_render_ahead", "0" } };
+    config.options = stream_options;
+    config.option_count = 1;
+    assert(ucra_stream_open_engine(&remote_stream, remote, &config, keep_config, NULL) == UCRA_SUCCESS);
+    assert(ucra_stream_open_engine(&local_stream, local, &config, keep_config, NULL) == UCRA_SUCCESS);
+    float remote_block[700 * 2], local_block[700 * 2];
+    for (int i = 0; i < 5; i++) {
+        uint32_t remote_got = 0, local_got = 0;
+        assert(ucra_stream_read(remote_stream, remote_block, 700, &remote_got) == UCRA_SUCCESS);
+        assert(ucra_stream_read(local_stream, local_block, 700, &local_got) == UCRA_SUCCESS);
+        assert(remote_got == local_got && remote_got > 0);
+        assert(memcmp(remote_block, local_block, (size_t)remote_got * 2 * sizeof(float)) == 0);
+    }
+    ucra_stream_close(remote_stream);
+    ucra_stream_close(local_stream);
+
+    ucra_engine_destroy(remote);
+    ucra_engine_destroy(local);
+    printf("✓ Host process render test passed\n");
+}
+
+static void test_crashing_host(void) {
+    printf("Testing a host that crashes...\n");
+    UCRA_Manifest manifest = make_manifest(UCRA_TEST_IPC_HOST);
+    UCRA_KeyValue options[] = { { "voice", "test" } };
+    UCRA_Handle engine = NULL;
+    assert(ucra_engine_create_from_manifest(&engine, &manifest, NULL, options, 1) == UCRA_SUCCESS);
+
+    char info[128];
+    assert(ucra_engine_getinfo(engine, info, sizeof(info)) == UCRA_SUCCESS);
+    assert(strcmp(info, "IPC Test Host voice=test") == 0);
+
+    UCRA_NoteSegment notes[13];
+    for (int i = 0; i < 13; i++) {
+        UCRA_NoteSegment note = { i * 0.05, 0.05, (int16_t)(60 + i), 100, NULL, NULL, NULL };
+        notes[i] = note;
+    }
+    UCRA_RenderConfig config = make_config(notes, 12, 1);
+    UCRA_RenderResult result;
+    assert(ucra_render(engine, &config, &result) == UCRA_SUCCESS);
+
+    /* what the host does not serve is not supported, without breaking it */
+    assert(ucra_render_batch(engine, &config, &result, 1) == UCRA_ERR_NOT_SUPPORTED);
+
+    config.note_count = 13;
+    assert(ucra_render(engine, &config, &result) == UCRA_ERR_INTERNAL);
+    assert(result.status == UCRA_ERR_INTERNAL);
+    config.note_count = 12;
+    assert(ucra_render(engine, &config, &result) == UCRA_ERR_INTERNAL);
+    assert(ucra_engine_getinfo(engine, info, sizeof(info)) == UCRA_ERR_INTERNAL);
+    ucra_engine_destroy(engine);
+    printf("✓ Crashing host test passed\n");
+}
+
+static void test_unusable_hosts(void) {
+    printf("Testing unusable host executables...\n");
+    UCRA_Handle engine = (UCRA_Handle)(void*)&engine;
+    UCRA_Manifest manifest = make_manifest("no_such_host");
+    assert(ucra_engine_create_from_manifest(&engine, &manifest, NULL, NULL, 0) == UCRA_ERR_FILE_NOT_FOUND);
+    assert(engine == NULL);
+
+    /* an executable that exits without serving */
+    manifest = make_manifest("/bin/true");
+    assert(ucra_engine_create_from_manifest(&engine, &manifest, NULL, NULL, 0) == UCRA_ERR_NOT_SUPPORTED);
+
+    /* a host run without a channel refuses to start */
+    char* argv[] = { "host", NULL };
+    assert(ucra_ipc_serve(1, argv, NULL) == UCRA_ERR_INVALID_ARGUMENT);
+    char* missing[] = { "host", "--ucra-ipc", "/ucra-ipc-no-such-channel", NULL };
+    assert(ucra_ipc_serve(3, missing, NULL) == UCRA_ERR_FILE_NOT_FOUND);
+    printf("✓ Unusable host test passed\n");
+}
+
+int main() {
+    printf("=== UCRA IPC Engine Tests ===\n");
+    test_matches_in_process();
+    test_crashing_host();
+    test_unusable_hosts();
+    printf("All IPC engine tests passed!\n");
+    return 0;
+}
@@ -0,0 +1,49 @@
+/*
+ * Engine host for the IPC engine test
+ * Serves the built-in engine, reports the options it was created with through
+ * getinfo, and crashes on a render of 13 notes so the client can be seen to
+ * survive its host.
+ */
+
+#include "ucra/ucra.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static char g_info[256] = "IPC Test Host";
+
+static UCRA_Result UCRA_CALL host_create(UCRA_Handle* outEngine, const UCRA_KeyValue* options,
+                                         uint32_t option_count) {
+    for (uint32_t i = 0; options && i < option_count; i++) {
+        size_t used = strlen(g_info);
+        snprintf(g_info + used, sizeof(g_info) - used, " %s=%s", options[i].key, options[i].value);
+    }
+    return ucra_engine_create(outEngine, options, option_count);
+}
+
+static UCRA_Result UCRA_CALL host_getinfo(UCRA_Handle engine, char* outBuffer, size_t buffer_size) {
+    (void)engine;
+    if (strlen(g_info) + 1 > buffer_size) return UCRA_ERR_INVALID_ARGUMENT;
+    memcpy(outBuffer, g_info, strlen(g_info) + 1);
+    return UCRA_SUCCESS;
+}
+
+static UCRA_Result UCRA_CALL host_render(UCRA_Handle engine, const UCRA_RenderConfig* config,
+                                         UCRA_RenderResult* outResult) {
+    if (config->note_count == 13) abort();
+    return ucra_render(engine, config, outResult);
+}
+
+int main(int argc, char** argv) {
+    UCRA_EngineTable table;
+    memset(&table, 0, sizeof(table));
+    table.abi_version = UCRA_ENGINE_ABI_VERSION;
+    table.struct_size = sizeof(table);
+    table.engine_create = host_create;
+    table.engine_destroy = ucra_engine_destroy;
+    table.render = host_render;
+    table.engine_getinfo = host_getinfo;
+    table.render_query_size = ucra_render_query_size;
+    table.render_block = ucra_render_block;
+    return ucra_ipc_serve(argc, argv, &table) == UCRA_SUCCESS ? 0 : 1;
+}
@@ -0,0 +1,158 @@
+/*
+ * Test for the engine loader
+ * An engine library named by a "dll" manifest entry is opened once, its
+ * engines render, stream and report through the ordinary API next to the
+ * built-in engine, and unusable entries fail with the documented codes.
+ */
+
+#include "ucra/ucra.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+/* Set by CMake to the test_engine_plugin module */
+#ifndef UCRA_TEST_PLUGIN_DIR
+#error "UCRA_TEST_PLUGIN_DIR must name the directory of the test engine library"
+#endif
+
+static UCRA_Manifest make_manifest(const char* type, const char* path, const char* symbol) {
+    UCRA_Manifest manifest;
+    memset(&manifest, 0, sizeof(manifest));
+    manifest.name = "Loader Test";
+    manifest.version = "1.0";
+    manifest.entry.type = type;
+    manifest.entry.path = path;
+    manifest.entry.symbol = symbol;
+    return manifest;
+}
+
+static UCRA_RenderConfig make_config(const UCRA_NoteSegment* notes, uint32_t count, uint32_t channels) {
+    UCRA_RenderConfig config;
+    memset(&config, 0, sizeof(config));
+    config.sample_rate = 44100;
+    config.channels = channels;
+    config.block_size = 512;
+    config.notes = notes;
+    config.note_count = count;
+    return config;
+}
+
+static UCRA_Result UCRA_CALL keep_config(void* user_data, UCRA_RenderConfig* out_config) {
+    (void)user_data;
+    (void)out_config;
+    return UCRA_STREAM_UNCHANGED;
+}
+
+static void test_load_and_render(void) {
+    printf("Testing engines loaded from a manifest...\n");
+    UCRA_Manifest manifest = make_manifest("dll", UCRA_TEST_PLUGIN_FILE, "test_plugin_entry");
+    UCRA_KeyValue options[] = { { "level", "0.5" } };
+
+    UCRA_Handle loaded = NULL, second = NULL, builtin = NULL;
+    assert(ucra_engine_create_from_manifest(&loaded, &manifest, UCRA_TEST_PLUGIN_DIR, options, 1) == UCRA_SUCCESS);
+    assert(ucra_engine_create_from_manifest(&second, &manifest, UCRA_TEST_PLUGIN_DIR, NULL, 0) == UCRA_SUCCESS);
+    assert(ucra_engine_create(&builtin, NULL, 0) == UCRA_SUCCESS);
+
+    /* the library was resolved once for both engines */
+    char info[128];
+    assert(ucra_engine_getinfo(loaded, info, sizeof(info)) == UCRA_SUCCESS);
+    assert(strcmp(info, "UCRA Test Plugin (entry calls: 1)") == 0);
+    assert(ucra_engine_getinfo(builtin, info, sizeof(info)) == UCRA_SUCCESS);
+    assert(strstr(info, "Test Plugin") == NULL);
+#ifndef UCRA_HAS_WORLD
+    assert(strstr(info, "Reference Engine") != NULL);
+#endif
+    /* a table without engine_get_capabilities claims none */
+    uint32_t caps = UCRA_ENGINE_CAP_NOTE_LOCAL;
+    assert(ucra_engine_get_capabilities(loaded, &caps) == UCRA_SUCCESS && caps == 0);
+
+    UCRA_NoteSegment notes[] = { { 0.0, 0.1, 69, 100, "a", NULL, NULL } };
+    UCRA_RenderConfig config = make_config(notes, 1, 2);
+    UCRA_RenderResult result;
+    assert(ucra_render(loaded, &config, &result) == UCRA_SUCCESS);
+    assert(result.frames == 4410 && result.channels == 2);
+    for (uint64_t i = 0; i < result.frames * 2; i++) assert(result.pcm[i] == 0.5f);
+    assert(ucra_render(second, &config, &result) == UCRA_SUCCESS);
+    assert(result.pcm[0] == 0.25f && result.pcm[4410 * 2 - 1] == 0.25f);
+
+    /* the built-in engine in the same process still renders its own audio (a sine, without WORLD) */
+    UCRA_RenderResult sine;
+    assert(ucra_render(builtin, &config, &sine) == UCRA_SUCCESS);
+    assert(sine.frames == 4410 && sine.pcm[200] != 0.25f);
+#ifndef UCRA_HAS_WORLD
+    assert(sine.pcm[0] == 0.0f);
+#endif
+
+    uint64_t frames = 0, samples = 0;
+    assert(ucra_render_query_size(loaded, &config, &frames, &samples) == UCRA_SUCCESS);
+    assert(frames == 4410 && samples == 4410 * 2);
+    float* pcm = malloc((size_t)samples * sizeof(float));
+    assert(pcm != NULL);
+    assert(ucra_render_into(loaded, &config, pcm, samples, &result) == UCRA_SUCCESS);
+    assert(result.pcm == pcm && pcm[samples - 1] == 0.5f);
+    free(pcm);
+
+    /* what the library leaves out is not supported */
+    UCRA_RenderResult batch[1];
+    assert(ucra_render_batch(loaded, &config, batch, 1) == UCRA_ERR_NOT_SUPPORTED);
+
+    /* engine-backed streams render through the library block by block */
+    UCRA_StreamHandle stream = NULL;
+    UCRA_KeyValue stream_options[] = { { "stream_render_ahead", "0" } };
+    UCRA_RenderConfig stream_config = config;
+    stream_config.options = stream_options;
+    stream_config.option_count = 1;
+    assert(ucra_stream_open_engine(&stream, loaded, &stream_config, keep_config, NULL) == UCRA_SUCCESS);
+    float block[700 * 2];
+    uint32_t got = 0;
+    assert(ucra_stream_read(stream, block, 700, &got) == UCRA_SUCCESS && got > 0);
+    for (uint32_t i = 0; i < got * 2; i++) assert(block[i] == 0.5f);
+    ucra_stream_close(stream);
+
+    ucra_engine_destroy(second);
+    ucra_engine_destroy(builtin);
+
+    /* an absolute path needs no base directory, and reuses the cached table */
+    ucra_engine_destroy(loaded);
+    char path[1024];
+    snprintf(path, sizeof(path), "%s/%s", UCRA_TEST_PLUGIN_DIR, UCRA_TEST_PLUGIN_FILE);
+    manifest.entry.path = path;
+    assert(ucra_engine_create_from_manifest(&loaded, &manifest, NULL, NULL, 0) == UCRA_SUCCESS);
+    assert(ucra_engine_getinfo(loaded, info, sizeof(info)) == UCRA_SUCCESS);
+    assert(strcmp(info, "UCRA Test Plugin (entry calls: 1)") == 0);
+    ucra_engine_destroy(loaded);
+    printf("✓ Load and render test passed\n");
+}
+
+static void test_unusable_entries(void) {
+    printf("Testing unusable manifest entries...\n");
+    UCRA_Handle engine = (UCRA_Handle)(void*)&engine;
+    UCRA_Manifest manifest = make_manifest("cli", "resampler", NULL);
+    assert(ucra_engine_create_from_manifest(&engine, &manifest, NULL, NULL, 0) == UCRA_ERR_NOT_SUPPORTED);
+    assert(engine == NULL);
+
+    manifest = make_manifest("dll", "no_such_engine.so", NULL);
+    assert(ucra_engine_create_from_manifest(&engine, &manifest, UCRA_TEST_PLUGIN_DIR, NULL, 0) == UCRA_ERR_FILE_NOT_FOUND);
+
+    /* no "ucra_entry" in the library */
+    manifest = make_manifest("dll", UCRA_TEST_PLUGIN_FILE, NULL);
+    assert(ucra_engine_create_from_manifest(&engine, &manifest, UCRA_TEST_PLUGIN_DIR, NULL, 0) == UCRA_ERR_NOT_SUPPORTED);
+
+    manifest = make_manifest("dll", UCRA_TEST_PLUGIN_FILE, "test_plugin_future_entry");
+    assert(ucra_engine_create_from_manifest(&engine, &manifest, UCRA_TEST_PLUGIN_DIR, NULL, 0) == UCRA_ERR_NOT_SUPPORTED);
+
+    manifest = make_manifest("dll", "", NULL);
+    assert(ucra_engine_create_from_manifest(&engine, &manifest, NULL, NULL, 0) == UCRA_ERR_INVALID_MANIFEST);
+    assert(ucra_engine_create_from_manifest(NULL, &manifest, NULL, NULL, 0) == UCRA_ERR_INVALID_ARGUMENT);
+    assert(ucra_engine_create_from_manifest(&engine, NULL, NULL, NULL, 0) == UCRA_ERR_INVALID_ARGUMENT);
+    printf("✓ Unusable entry test passed\n");
+}
+
+int main() {
+    printf("=== UCRA Engine Loader Tests ===\n");
+    test_load_and_render();
+    test_unusable_entries();
+    printf("All engine loader tests passed!\n");
+    return 0;
+}
@@ -0,0 +1,133 @@
+/*
+ * Engine library for the engine loader test
+ * Renders every note frame at a constant level (option "level", default 0.25)
+ * and counts how often its entry is resolved. Its functions are static, as a
+ * loadable engine's should be; only the entry symbols are exported.
+ */
+
+#include "ucra/ucra.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#if defined(_WIN32)
+    #define PLUGIN_EXPORT __declspec(dllexport)
+#else
+    #define PLUGIN_EXPORT __attribute__((visibility("default")))
+#endif
+
+typedef struct PluginEngine {
+    float level;
+    float* pcm;
+    size_t pcm_size;
+} PluginEngine;
+
+static int g_entry_calls;
+
+static UCRA_Result UCRA_CALL plugin_create(UCRA_Handle* outEngine, const UCRA_KeyValue* options,
+                                           uint32_t option_count) {
+    PluginEngine* engine = (PluginEngine*)calloc(1, sizeof(PluginEngine));
+    if (!engine) return UCRA_ERR_OUT_OF_MEMORY;
+    engine->level = 0.25f;
+    for (uint32_t i = 0; options && i < option_count; i++) {
+        if (strcmp(options[i].key, "level") == 0) engine->level = (float)atof(options[i].value);
+    }
+    *outEngine = (UCRA_Handle)(void*)engine;
+    return UCRA_SUCCESS;
+}
+
+static void UCRA_CALL plugin_destroy(UCRA_Handle handle) {
+    PluginEngine* engine = (PluginEngine*)(void*)handle;
+    free(engine->pcm);
+    free(engine);
+}
+
+static UCRA_Result UCRA_CALL plugin_getinfo(UCRA_Handle handle, char* outBuffer, size_t buffer_size) {
+    (void)handle;
+    snprintf(outBuffer, buffer_size, "UCRA Test Plugin (entry calls: %d)", g_entry_calls);
+    return UCRA_SUCCESS;
+}
+
+static uint64_t render_frames(const UCRA_RenderConfig* config) {
+    double end = 0.0;
+    for (uint32_t i = 0; i < config->note_count; i++) {
+        double note_end = config->notes[i].start_sec + config->notes[i].duration_sec;
+        if (note_end > end) end = note_end;
+    }
+    return (uint64_t)(end * config->sample_rate + 0.5);
+}
+
+static UCRA_Result UCRA_CALL plugin_query_size(UCRA_Handle handle, const UCRA_RenderConfig* config,
+                                               uint64_t* out_frames, uint64_t* out_samples) {
+    (void)handle;
+    uint64_t frames = render_frames(config);
+    if (out_frames) *out_frames = frames;
+    if (out_samples) *out_samples = frames * config->channels;
+    return UCRA_SUCCESS;
+}
+
+static UCRA_Result UCRA_CALL plugin_render_into(UCRA_Handle handle, const UCRA_RenderConfig* config,
+                                                float* out_pcm, uint64_t capacity_samples,
+                                                UCRA_RenderResult* outResult) {
+    PluginEngine* engine = (PluginEngine*)(void*)handle;
+    uint64_t frames = render_frames(config);
+    uint64_t samples = frames * config->channels;
+    memset(outResult, 0, sizeof(*outResult));
+    if (capacity_samples < samples) return UCRA_ERR_INVALID_ARGUMENT;
+    for (uint64_t i = 0; i < samples; i++) out_pcm[i] = engine->level;
+    outResult->pcm = out_pcm;
+    outResult->frames = frames;
+    outResult->channels = config->channels;
+    outResult->sample_rate = config->sample_rate;
+    return UCRA_SUCCESS;
+}
+
+static UCRA_Result UCRA_CALL plugin_render(UCRA_Handle handle, const UCRA_RenderConfig* config,
+                                           UCRA_RenderResult* outResult) {
+    PluginEngine* engine = (PluginEngine*)(void*)handle;
+    size_t samples = (size_t)(render_frames(config) * config->channels);
+    if (samples > engine->pcm_size) {
+        float* pcm = (float*)realloc(engine->pcm, samples * sizeof(float));
+        if (!pcm) return UCRA_ERR_OUT_OF_MEMORY;
+        engine->pcm = pcm;
+        engine->pcm_size = samples;
+    }
+    return plugin_render_into(handle, config, engine->pcm, engine->pcm_size, outResult);
+}
+
+static UCRA_Result UCRA_CALL plugin_render_block(UCRA_Handle handle, const UCRA_RenderConfig* config,
+                                                 uint64_t start_frame, uint32_t frame_count, float* out_pcm) {
+    PluginEngine* engine = (PluginEngine*)(void*)handle;
+    uint64_t frames = render_frames(config);
+    for (uint32_t n = 0; n < frame_count; n++) {
+        float value = start_frame + n < frames ? engine->level : 0.0f;
+        for (uint32_t c = 0; c < config->channels; c++) out_pcm[(size_t)n * config->channels + c] = value;
+    }
+    return UCRA_SUCCESS;
+}
+
+static const UCRA_EngineTable g_table = {
+    UCRA_ENGINE_ABI_VERSION, sizeof(UCRA_EngineTable),
+    plugin_create, plugin_destroy, plugin_render,
+    plugin_getinfo, plugin_query_size, plugin_render_into,
+    NULL, /* no batches */
+    plugin_render_block,
+    NULL /* no capabilities: its level spans the whole render */
+};
+
+/* A table from a future ABI this host does not understand */
+static const UCRA_EngineTable g_future_table = {
+    UCRA_ENGINE_ABI_VERSION + 1, sizeof(UCRA_EngineTable),
+    plugin_create, plugin_destroy, plugin_render,
+    NULL, NULL, NULL, NULL, NULL, NULL
+};
+
+PLUGIN_EXPORT const UCRA_EngineTable* UCRA_CALL test_plugin_entry(uint32_t host_abi_version) {
+    g_entry_calls++;
+    return host_abi_version == UCRA_ENGINE_ABI_VERSION ? &g_table : NULL;
+}
+
+PLUGIN_EXPORT const UCRA_EngineTable* UCRA_CALL test_plugin_future_entry(uint32_t host_abi_version) {
+    (void)host_abi_version;
+    return &g_future_table;
+}
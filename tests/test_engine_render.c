@@ -0,0 +1,476 @@
+/*
+ * Test for the UCRA reference engine renderer
+ * Checks note scheduling, oscillator phase and determinism of ucra_render
+ */
+
+#include "ucra/ucra.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <math.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+static UCRA_RenderConfig make_config(const UCRA_NoteSegment* notes, uint32_t note_count) {
+    UCRA_RenderConfig config = {
+        .sample_rate = 44100,
+        .channels = 1,
+        .block_size = 512,
+        .flags = 0,
+        .notes = notes,
+        .note_count = note_count,
+        .options = NULL,
+        .option_count = 0
+    };
+    return config;
+}
+
+/* Render config on an engine created with options and return a heap copy of the PCM */
+static float* render_copy_with(const UCRA_RenderConfig* config, const UCRA_KeyValue* options,
+                               uint32_t option_count, uint64_t* out_frames) {
+    UCRA_Handle engine = NULL;
+    assert(ucra_engine_create(&engine, options, option_count) == UCRA_SUCCESS);
+
+    UCRA_RenderResult result;
+    assert(ucra_render(engine, config, &result) == UCRA_SUCCESS);
+    assert(result.status == UCRA_SUCCESS);
+
+    size_t samples = (size_t)result.frames * result.channels;
+    float* copy = malloc(samples * sizeof(float));
+    assert(copy != NULL);
+    memcpy(copy, result.pcm, samples * sizeof(float));
+    *out_frames = result.frames;
+
+    ucra_engine_destroy(engine);
+    return copy;
+}
+
+static float* render_copy(const UCRA_RenderConfig* config, uint64_t* out_frames) {
+    return render_copy_with(config, NULL, 0, out_frames);
+}
+
+/* A single held note is a plain sine starting at zero phase */
+static void test_single_note_waveform() {
+    printf("Testing single note waveform...\n");
+
+    UCRA_NoteSegment note = { 0.0, 0.5, 69, 127, "a", NULL, NULL };
+    UCRA_RenderConfig config = make_config(&note, 1);
+
+    uint64_t frames = 0;
+    float* pcm = render_copy(&config, &frames);
+    assert(frames == 22050);
+
+    for (uint64_t n = 0; n < frames; n++) {
+        double expected = 0.2 * sin(2.0 * M_PI * 440.0 * (double)n / 44100.0);
+        assert(fabs(pcm[n] - expected) < 1e-4);
+    }
+
+    free(pcm);
+    printf("✓ Single note waveform test passed\n");
+}
+
+/* Notes only sound between their start and end */
+static void test_note_boundaries() {
+    printf("Testing note boundaries...\n");
+
+    UCRA_NoteSegment notes[] = {
+        { 0.25, 0.25, 60, 100, "a", NULL, NULL },
+        { 0.75, 0.25, 64, 100, "i", NULL, NULL }
+    };
+    UCRA_RenderConfig config = make_config(notes, 2);
+
+    uint64_t frames = 0;
+    float* pcm = render_copy(&config, &frames);
+    assert(frames == 44100);
+
+    /* silence before the first note and in the gap between notes */
+    for (uint64_t n = 0; n < 11025; n++) assert(pcm[n] == 0.0f);
+    for (uint64_t n = 22051; n < 33075; n++) assert(pcm[n] == 0.0f);
+
+    /* both notes produce signal */
+    float peak_a = 0.0f, peak_b = 0.0f;
+    for (uint64_t n = 11025; n <= 22050; n++) peak_a = fmaxf(peak_a, fabsf(pcm[n]));
+    for (uint64_t n = 33075; n < frames; n++) peak_b = fmaxf(peak_b, fabsf(pcm[n]));
+    assert(peak_a > 0.1f && peak_b > 0.1f);
+
+    free(pcm);
+    printf("✓ Note boundaries test passed\n");
+}
+
+/* Output does not depend on the order notes are passed in */
+static void test_unsorted_notes_deterministic() {
+    printf("Testing unsorted note input...\n");
+
+    enum { NOTE_COUNT = 64 };
+    UCRA_NoteSegment sorted[NOTE_COUNT];
+    UCRA_NoteSegment shuffled[NOTE_COUNT];
+    for (int i = 0; i < NOTE_COUNT; i++) {
+        UCRA_NoteSegment n = { i * 0.05, 0.2, (int16_t)(48 + i % 24), 90, "la", NULL, NULL };
+        sorted[i] = n;
+    }
+    for (int i = 0; i < NOTE_COUNT; i++) {
+        shuffled[i] = sorted[(i * 37) % NOTE_COUNT];
+    }
+
+    UCRA_RenderConfig config_sorted = make_config(sorted, NOTE_COUNT);
+    UCRA_RenderConfig config_shuffled = make_config(shuffled, NOTE_COUNT);
+
+    uint64_t frames_a = 0, frames_b = 0;
+    float* a = render_copy(&config_sorted, &frames_a);
+    float* b = render_copy(&config_shuffled, &frames_b);
+    assert(frames_a == frames_b);
+    assert(memcmp(a, b, (size_t)frames_a * sizeof(float)) == 0);
+
+    free(a);
+    free(b);
+    printf("✓ Unsorted note input test passed\n");
+}
+
+/* Phase stays continuous when the F0 curve jumps */
+static void test_phase_continuity() {
+    printf("Testing phase continuity across F0 changes...\n");
+
+    float times[] = { 0.0f, 0.1f, 0.2f, 0.3f };
+    float f0s[] = { 220.0f, 330.0f, 247.0f, 440.0f };
+    UCRA_F0Curve curve = { times, f0s, 4 };
+    UCRA_NoteSegment note = { 0.0, 0.4, 57, 127, "a", &curve, NULL };
+    UCRA_RenderConfig config = make_config(&note, 1);
+
+    uint64_t frames = 0;
+    float* pcm = render_copy(&config, &frames);
+
+    /* a continuous sine never moves further per sample than amp * 2*pi*f/sr */
+    double max_step = 0.2 * 2.0 * M_PI * 440.0 / 44100.0 * 1.01;
+    for (uint64_t n = 1; n < frames; n++) {
+        assert(fabs((double)pcm[n] - (double)pcm[n - 1]) <= max_step);
+    }
+
+    free(pcm);
+    printf("✓ Phase continuity test passed\n");
+}
+
+/* ucra_render_into writes the same PCM as ucra_render into a caller buffer */
+static void test_render_into() {
+    printf("Testing render into caller buffer...\n");
+
+    UCRA_NoteSegment notes[2] = {
+        { 0.0, 0.3, 60, 100, "a", NULL, NULL },
+        { 0.2, 0.3, 67, 100, "i", NULL, NULL }
+    };
+    UCRA_RenderConfig config = make_config(notes, 2);
+    config.channels = 2;
+
+    uint64_t ref_frames = 0;
+    float* ref = render_copy(&config, &ref_frames);
+
+    UCRA_Handle engine = NULL;
+    assert(ucra_engine_create(&engine, NULL, 0) == UCRA_SUCCESS);
+
+    uint64_t frames = 0, samples = 0;
+    assert(ucra_render_query_size(engine, &config, &frames, &samples) == UCRA_SUCCESS);
+    assert(frames == ref_frames);
+    assert(samples == frames * 2);
+
+    /* an undersized buffer is rejected and reports the required size */
+    float* pcm = malloc((size_t)samples * sizeof(float));
+    assert(pcm != NULL);
+    UCRA_RenderResult result;
+    assert(ucra_render_into(engine, &config, pcm, samples - 1, &result) == UCRA_ERR_INVALID_ARGUMENT);
+    assert(result.frames == frames && result.channels == 2);
+    assert(ucra_render_into(engine, &config, NULL, 0, &result) == UCRA_ERR_INVALID_ARGUMENT);
+
+    assert(ucra_render_into(engine, &config, pcm, samples, &result) == UCRA_SUCCESS);
+    assert(result.status == UCRA_SUCCESS);
+    assert(result.pcm == pcm);
+    assert(result.frames == frames);
+    assert(memcmp(pcm, ref, (size_t)samples * sizeof(float)) == 0);
+
+    ucra_engine_destroy(engine);
+    free(pcm);
+    free(ref);
+    printf("✓ Render into caller buffer test passed\n");
+}
+
+/* Chunked multi-threaded rendering matches the single-threaded output bit for bit */
+static void test_threaded_render_identical() {
+    printf("Testing multi-threaded render determinism...\n");
+
+    /* dense 5 ms pitch curves on long overlapping notes cross many chunk boundaries */
+    enum { NOTES = 24, POINTS = 800 };
+    static float times[POINTS], f0s[POINTS], env_times[4], env_values[4];
+    for (int i = 0; i < POINTS; i++) {
+        times[i] = (float)(i * 0.005);
+        f0s[i] = (i % 97 == 0) ? 0.0f : (float)(220.0 + 40.0 * sin(i * 0.03));
+    }
+    for (int i = 0; i < 4; i++) {
+        env_times[i] = (float)i;
+        env_values[i] = 1.0f - 0.2f * (float)i;
+    }
+    UCRA_F0Curve curve = { times, f0s, POINTS };
+    UCRA_EnvCurve env = { env_times, env_values, 4 };
+
+    UCRA_NoteSegment notes[NOTES];
+    for (int i = 0; i < NOTES; i++) {
+        UCRA_NoteSegment n = { 0.37 * i, 1.0 + 0.31 * (i % 5), (int16_t)(55 + i % 12), 100, "a",
+                               (i % 3 == 0) ? &curve : NULL, (i % 4 == 1) ? &env : NULL };
+        notes[i] = n;
+    }
+    UCRA_RenderConfig config = make_config(notes, NOTES);
+    config.channels = 2;
+
+    const char* thread_counts[] = { "2", "4", "0" };
+    UCRA_KeyValue serial_option = { "render_threads", "1" };
+
+    const char* modes[] = { "step", "cubic" };
+    for (int m = 0; m < 2; m++) {
+        UCRA_KeyValue render_option = { "curve_interpolation", modes[m] };
+        config.options = &render_option;
+        config.option_count = 1;
+        uint64_t ref_frames = 0;
+        float* ref = render_copy_with(&config, &serial_option, 1, &ref_frames);
+
+        for (int t = 0; t < 3; t++) {
+            UCRA_KeyValue option = { "render_threads", thread_counts[t] };
+            uint64_t frames = 0;
+            float* pcm = render_copy_with(&config, &option, 1, &frames);
+            assert(frames == ref_frames);
+            assert(memcmp(pcm, ref, (size_t)frames * 2 * sizeof(float)) == 0);
+            free(pcm);
+        }
+        free(ref);
+    }
+
+    printf("✓ Multi-threaded render determinism test passed\n");
+}
+
+/* ucra_render_batch matches rendering each config on its own and reports per-job status */
+static void test_render_batch() {
+    printf("Testing batch rendering...\n");
+
+    enum { JOBS = 97 };
+    static float times[] = { 0.0f, 0.05f, 0.1f };
+    static float f0s[] = { 300.0f, 0.0f, 350.0f };
+    static UCRA_F0Curve curve = { times, f0s, 3 };
+    static UCRA_NoteSegment notes[JOBS][2];
+    UCRA_RenderConfig configs[JOBS];
+    for (int i = 0; i < JOBS; i++) {
+        UCRA_NoteSegment a = { 0.0, 0.05 + 0.01 * (i % 13), (int16_t)(48 + i % 24), 90, "a",
+                               (i % 4 == 0) ? &curve : NULL, NULL };
+        UCRA_NoteSegment b = { 0.02 * (i % 5), 0.1, (int16_t)(60 + i % 7), 60, "i", NULL, NULL };
+        notes[i][0] = a;
+        notes[i][1] = b;
+        configs[i] = make_config(notes[i], (i % 3) ? 2 : 1);
+        configs[i].channels = 1 + i % 2;
+        configs[i].sample_rate = (i % 2) ? 44100 : 22050;
+    }
+    /* an invalid job fails on its own */
+    configs[40].notes = NULL;
+
+    UCRA_KeyValue option = { "render_threads", "4" };
+    UCRA_Handle engine = NULL;
+    assert(ucra_engine_create(&engine, &option, 1) == UCRA_SUCCESS);
+
+    UCRA_RenderResult results[JOBS];
+    for (int round = 0; round < 2; round++) {
+        assert(ucra_render_batch(engine, configs, results, JOBS) == UCRA_ERR_INVALID_ARGUMENT);
+
+        for (int i = 0; i < JOBS; i++) {
+            if (i == 40) {
+                assert(results[i].status == UCRA_ERR_INVALID_ARGUMENT);
+                assert(results[i].pcm == NULL);
+                continue;
+            }
+            assert(results[i].status == UCRA_SUCCESS);
+            assert(results[i].sample_rate == configs[i].sample_rate);
+            assert(results[i].channels == configs[i].channels);
+
+            uint64_t frames = 0;
+            float* ref = render_copy(&configs[i], &frames);
+            assert(results[i].frames == frames);
+            assert(memcmp(results[i].pcm, ref, (size_t)frames * results[i].channels * sizeof(float)) == 0);
+            free(ref);
+        }
+    }
+
+    assert(ucra_render_batch(engine, NULL, NULL, 0) == UCRA_SUCCESS);
+    assert(ucra_render_batch(engine, NULL, results, 1) == UCRA_ERR_INVALID_ARGUMENT);
+
+    ucra_engine_destroy(engine);
+    printf("✓ Batch rendering test passed\n");
+}
+
+/* Planar and mono-source layouts carry the same signal as interleaved output */
+static void test_output_layouts() {
+    printf("Testing output layouts...\n");
+
+    UCRA_NoteSegment notes[2] = {
+        { 0.0, 0.2, 64, 100, "a", NULL, NULL },
+        { 0.1, 0.2, 71, 100, "i", NULL, NULL }
+    };
+    UCRA_RenderConfig config = make_config(notes, 2);
+    config.channels = 3;
+
+    uint64_t frames = 0;
+    float* interleaved = render_copy(&config, &frames);
+
+    UCRA_Handle engine = NULL;
+    assert(ucra_engine_create(&engine, NULL, 0) == UCRA_SUCCESS);
+
+    uint64_t samples = 0;
+    config.flags = UCRA_RENDER_LAYOUT_PLANAR;
+    assert(ucra_render_query_size(engine, &config, NULL, &samples) == UCRA_SUCCESS);
+    assert(samples == frames * 3);
+    UCRA_RenderResult result;
+    assert(ucra_render(engine, &config, &result) == UCRA_SUCCESS);
+    assert(result.frames == frames && result.channels == 3);
+    for (uint64_t n = 0; n < frames; n++) {
+        for (uint32_t ch = 0; ch < 3; ch++) {
+            assert(result.pcm[ch * frames + n] == interleaved[n * 3 + ch]);
+        }
+    }
+
+    /* mono source: one plane, the result still reports the logical channel count */
+    config.flags = UCRA_RENDER_LAYOUT_MONO;
+    assert(ucra_render_query_size(engine, &config, NULL, &samples) == UCRA_SUCCESS);
+    assert(samples == frames);
+    float* mono = malloc((size_t)frames * sizeof(float));
+    assert(mono != NULL);
+    assert(ucra_render_into(engine, &config, mono, samples, &result) == UCRA_SUCCESS);
+    assert(result.channels == 3);
+    for (uint64_t n = 0; n < frames; n++) {
+        assert(mono[n] == interleaved[n * 3]);
+    }
+
+    config.flags = UCRA_RENDER_LAYOUT_MASK;
+    assert(ucra_render(engine, &config, &result) == UCRA_ERR_INVALID_ARGUMENT);
+
+    ucra_engine_destroy(engine);
+    free(mono);
+    free(interleaved);
+    printf("✓ Output layouts test passed\n");
+}
+
+/* Stream callback serving one fixed note list */
+static UCRA_Result song_callback(void* user_data, UCRA_RenderConfig* out_config) {
+    const UCRA_RenderConfig* song = (const UCRA_RenderConfig*)user_data;
+    out_config->notes = song->notes;
+    out_config->note_count = song->note_count;
+    out_config->options = song->options;
+    out_config->option_count = song->option_count;
+    return UCRA_SUCCESS;
+}
+
+/* Blocks rendered with carried state, and streams backed by the engine, match ucra_render */
+static void test_render_block() {
+    printf("Testing block rendering...\n");
+
+    /* curve voices spanning several re-anchoring chunks, plus fixed-pitch notes */
+    enum { POINTS = 200 };
+    static float times[POINTS], f0s[POINTS];
+    for (int i = 0; i < POINTS; i++) {
+        times[i] = (float)(i * 0.01);
+        f0s[i] = (float)(260.0 + 50.0 * sin(i * 0.1));
+    }
+    UCRA_F0Curve curve = { times, f0s, POINTS };
+    UCRA_NoteSegment notes[4] = {
+        { 0.0, 1.8, 60, 100, "a", &curve, NULL },
+        { 0.3, 0.4, 67, 80, "i", NULL, NULL },
+        { 0.9, 1.0, 64, 90, "u", &curve, NULL },
+        { 1.5, 0.1, 72, 70, "e", NULL, NULL }
+    };
+    UCRA_KeyValue interp = { "curve_interpolation", "cubic" };
+    UCRA_RenderConfig config = make_config(notes, 4);
+    config.channels = 2;
+    config.options = &interp;
+    config.option_count = 1;
+
+    uint64_t frames = 0;
+    float* ref = render_copy(&config, &frames);
+    assert(frames > 4 * 16384);
+
+    UCRA_Handle engine = NULL;
+    assert(ucra_engine_create(&engine, NULL, 0) == UCRA_SUCCESS);
+
+    /* odd block sizes in sequence, running past the end into silence */
+    uint64_t padded = frames + 1000;
+    float* pcm = malloc((size_t)padded * 2 * sizeof(float));
+    assert(pcm != NULL);
+    const uint32_t sizes[] = { 1, 255, 257, 1000, 4099, 17 };
+    uint64_t pos = 0;
+    for (int i = 0; pos < padded; i++) {
+        uint32_t n = sizes[i % 6];
+        if (n > padded - pos) n = (uint32_t)(padded - pos);
+        assert(ucra_render_block(engine, &config, pos, n, pcm + pos * 2) == UCRA_SUCCESS);
+        pos += n;
+    }
+    assert(memcmp(pcm, ref, (size_t)frames * 2 * sizeof(float)) == 0);
+    for (uint64_t n = frames * 2; n < padded * 2; n++) assert(pcm[n] == 0.0f);
+
+    /* a seek restarts the sweep, and ucra_render in between leaves it alone */
+    float block[3000 * 2];
+    assert(ucra_render_block(engine, &config, 50000, 3000, block) == UCRA_SUCCESS);
+    assert(memcmp(block, ref + 50000 * 2, sizeof(block)) == 0);
+    UCRA_RenderResult result;
+    assert(ucra_render(engine, &config, &result) == UCRA_SUCCESS);
+    assert(ucra_render_block(engine, &config, 53000, 3000, block) == UCRA_SUCCESS);
+    assert(memcmp(block, ref + 53000 * 2, sizeof(block)) == 0);
+    assert(ucra_render_block(engine, &config, 777, 3000, block) == UCRA_SUCCESS);
+    assert(memcmp(block, ref + 777 * 2, sizeof(block)) == 0);
+
+    /* planar blocks are planar over the block */
+    config.flags = UCRA_RENDER_LAYOUT_PLANAR;
+    assert(ucra_render_block(engine, &config, 20000, 3000, block) == UCRA_SUCCESS);
+    for (uint32_t n = 0; n < 3000; n++) {
+        assert(block[n] == ref[(20000 + n) * 2] && block[3000 + n] == ref[(20000 + n) * 2 + 1]);
+    }
+    config.flags = 0;
+    assert(ucra_render_block(NULL, &config, 0, 1, block) == UCRA_ERR_INVALID_ARGUMENT);
+    assert(ucra_render_block(engine, &config, 0, 1, NULL) == UCRA_ERR_INVALID_ARGUMENT);
+
+    /* an engine-backed stream plays the offline render */
+    const char* modes[] = { "0", "1" };
+    for (int m = 0; m < 2; m++) {
+        UCRA_KeyValue stream_options[2] = { interp, { "stream_render_ahead", modes[m] } };
+        UCRA_RenderConfig stream_config = config;
+        stream_config.notes = NULL;
+        stream_config.note_count = 0;
+        stream_config.options = stream_options;
+        stream_config.option_count = 2;
+        UCRA_StreamHandle stream = NULL;
+        assert(ucra_stream_open_engine(&stream, engine, &stream_config, song_callback, &config) == UCRA_SUCCESS);
+
+        pos = 0;
+        while (pos < frames) {
+            uint32_t got = 0;
+            assert(ucra_stream_read(stream, pcm + pos * 2, 700, &got) == UCRA_SUCCESS);
+            pos += got;
+        }
+        ucra_stream_close(stream);
+        assert(memcmp(pcm, ref, (size_t)frames * 2 * sizeof(float)) == 0);
+    }
+
+    ucra_engine_destroy(engine);
+    free(pcm);
+    free(ref);
+    printf("✓ Block rendering test passed\n");
+}
+
+int main() {
+    printf("=== UCRA Reference Engine Render Tests ===\n\n");
+
+    test_single_note_waveform();
+    test_note_boundaries();
+    test_unsorted_notes_deterministic();
+    test_phase_continuity();
+    test_render_into();
+    test_threaded_render_identical();
+    test_render_batch();
+    test_output_layouts();
+    test_render_block();
+
+    printf("\n=== All engine render tests passed! ===\n");
+    return 0;
+}
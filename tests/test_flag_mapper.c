@@ -3,6 +3,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <assert.h>
+#include <math.h>
 
 static void test_parse_legacy_flags(void) {
     printf("Testing ucra_parse_legacy_flags...\n");
@@ -106,6 +107,208 @@ static void test_flag_mapper_apply(void) {
     printf("✓ ucra_flag_mapper_apply tests completed\n");
 }
 
+/* Mapping exercising shared sources, a missing source with a default and a map table */
+static const char* INDEX_MAPPING =
+    "{ \"engine\": \"indexed\", \"version\": \"1.0\", \"rules\": [\n"
+    "  { \"source\": {\"name\": \"g\"}, \"target\": {\"name\": \"gender\"},\n"
+    "    \"transform\": {\"kind\": \"scale\", \"scale\": [-1.0, 1.0]} },\n"
+    "  { \"source\": {\"name\": \"g\"}, \"target\": {\"name\": \"gender_raw\"} },\n"
+    "  { \"source\": {\"name\": \"B\"}, \"target\": {\"name\": \"breath\", \"default\": 0.25} },\n"
+    "  { \"source\": {\"name\": \"mode\"}, \"target\": {\"name\": \"articulation\"},\n"
+    "    \"transform\": {\"kind\": \"map\", \"map\": {\"0\": \"legato\", \"1\": \"staccato\", \"2\": \"accent\",\n"
+    "                                        \"3\": \"tenuto\", \"4\": \"marcato\"}} },\n"
+    "  { \"source\": {\"name\": \"e\"}, \"target\": {\"name\": \"engine\"},\n"
+    "    \"transform\": {\"kind\": \"constant\", \"value\": \"world\"} }\n"
+    "] }\n";
+
+static void assert_same_result(const UCRA_FlagMapResult* a, const UCRA_FlagMapResult* b) {
+    assert(a->flag_count == b->flag_count && a->warning_count == b->warning_count);
+    for (uint32_t i = 0; i < a->flag_count; i++) {
+        assert(strcmp(a->flags[i].key, b->flags[i].key) == 0);
+        assert(strcmp(a->flags[i].value, b->flags[i].value) == 0);
+    }
+    for (uint32_t i = 0; i < a->warning_count; i++) {
+        assert(strcmp(a->warnings[i], b->warnings[i]) == 0);
+    }
+}
+
+static UCRA_FlagMapper* load_mapping_text(const char* text) {
+    const char* path = "test_index_mapping.json";
+    FILE* file = fopen(path, "w");
+    assert(file != NULL);
+    fputs(text, file);
+    fclose(file);
+
+    UCRA_FlagMapper* mapper = NULL;
+    assert(ucra_flag_mapper_load(path, &mapper) == UCRA_SUCCESS);
+    remove(path);
+    return mapper;
+}
+
+static UCRA_FlagMapper* load_index_mapping(void) {
+    return load_mapping_text(INDEX_MAPPING);
+}
+
+static void test_flag_mapper_index(void) {
+    printf("Testing compiled flag mapper...\n");
+
+    UCRA_FlagMapper* mapper = load_index_mapping();
+    assert(mapper->rule_count == 5 && mapper->index != NULL);
+
+    /* the first "g" wins; "x" matches no rule and "4" is found in the map */
+    UCRA_KeyValue legacy[] = { {"x", "1"}, {"g", "0.5"}, {"mode", "4"}, {"g", "0.9"}, {"e", "?"} };
+    UCRA_FlagMapResult indexed, linear;
+    assert(ucra_flag_mapper_apply(mapper, legacy, 5, &indexed) == UCRA_SUCCESS);
+    assert(indexed.flag_count == 5 && indexed.warning_count == 0);
+    assert(strcmp(indexed.flags[0].key, "gender") == 0 && strcmp(indexed.flags[0].value, "0") == 0);
+    assert(strcmp(indexed.flags[1].value, "0.5") == 0);
+    assert(strcmp(indexed.flags[2].key, "breath") == 0 && strcmp(indexed.flags[2].value, "0.25") == 0);
+    assert(strcmp(indexed.flags[3].value, "marcato") == 0);
+    assert(strcmp(indexed.flags[4].value, "world") == 0);
+
+    /* the uncompiled mapper gives the same result by linear search */
+    UCRA_FlagMapperIndex* index = mapper->index;
+    mapper->index = NULL;
+    assert(ucra_flag_mapper_apply(mapper, legacy, 5, &linear) == UCRA_SUCCESS);
+    mapper->index = index;
+    assert_same_result(&indexed, &linear);
+    ucra_flag_map_result_free(&indexed);
+    ucra_flag_map_result_free(&linear);
+
+    /* unknown map keys warn the same way on both paths */
+    UCRA_KeyValue unknown[] = { {"mode", "9"} };
+    assert(ucra_flag_mapper_apply(mapper, unknown, 1, &indexed) == UCRA_SUCCESS);
+    assert(indexed.flag_count == 1 && indexed.warning_count == 1);
+    mapper->index = NULL;
+    assert(ucra_flag_mapper_apply(mapper, unknown, 1, &linear) == UCRA_SUCCESS);
+    mapper->index = index;
+    assert_same_result(&indexed, &linear);
+    ucra_flag_map_result_free(&indexed);
+    ucra_flag_map_result_free(&linear);
+
+    /* recompiling after editing a rule picks up the new source name */
+    free(mapper->rules[2].source_name);
+    mapper->rules[2].source_name = malloc(3);
+    strcpy(mapper->rules[2].source_name, "Br");
+    assert(ucra_flag_mapper_compile(mapper) == UCRA_SUCCESS && mapper->index != NULL);
+    UCRA_KeyValue breath[] = { {"Br", "0.75"} };
+    assert(ucra_flag_mapper_apply(mapper, breath, 1, &indexed) == UCRA_SUCCESS);
+    assert(indexed.flag_count == 1 && strcmp(indexed.flags[0].value, "0.75") == 0);
+    ucra_flag_map_result_free(&indexed);
+
+    assert(ucra_flag_mapper_compile(NULL) == UCRA_ERR_INVALID_ARGUMENT);
+    ucra_flag_mapper_free(mapper);
+    printf("✓ Compiled flag mapper tests passed\n");
+}
+
+static void test_flag_mapper_apply_into(void) {
+    printf("Testing ucra_flag_mapper_apply_into...\n");
+
+    UCRA_FlagMapper* mapper = load_index_mapping();
+    size_t size = ucra_flag_mapper_arena_size(mapper);
+    assert(size > 0 && ucra_flag_mapper_arena_size(NULL) == 0);
+    char* arena = malloc(size + 1);
+    assert(arena != NULL);
+
+    UCRA_KeyValue legacy[] = { {"g", "0.5"}, {"mode", "2"}, {"e", "?"} };
+    UCRA_KeyValue unknown[] = { {"mode", "9"}, {"g", "half"} };
+    const UCRA_KeyValue* inputs[] = { legacy, unknown };
+    uint32_t counts[] = { 3, 2 };
+
+    /* both paths, with a misaligned arena, match the allocating apply */
+    for (int compiled = 1; compiled >= 0; compiled--) {
+        UCRA_FlagMapperIndex* index = mapper->index;
+        if (!compiled) mapper->index = NULL;
+        for (int k = 0; k < 2; k++) {
+            UCRA_FlagMapResult heap, into;
+            assert(ucra_flag_mapper_apply(mapper, inputs[k], counts[k], &heap) == UCRA_SUCCESS);
+            assert(ucra_flag_mapper_apply_into(mapper, inputs[k], counts[k], arena + 1, size, &into) == UCRA_SUCCESS);
+            assert_same_result(&heap, &into);
+            ucra_flag_map_result_free(&heap);
+        }
+        mapper->index = index;
+    }
+
+    /* keys and unformatted values point into the mapper and the legacy flags */
+    UCRA_FlagMapResult result;
+    assert(ucra_flag_mapper_apply_into(mapper, legacy, 3, arena, size, &result) == UCRA_SUCCESS);
+    assert(result.flag_count == 5);
+    assert(result.flags[0].key == mapper->rules[0].target_name);
+    assert(result.flags[1].value == legacy[0].value);
+    assert(result.flags[3].value == mapper->rules[3].map_values[2]);
+    assert(result.flags[4].value == mapper->rules[4].constant_value);
+    assert((char*)result.flags >= arena && (char*)result.flags < arena + size);
+
+    /* a missing or short arena is rejected */
+    assert(ucra_flag_mapper_apply_into(mapper, legacy, 3, arena, size - 1, &result) == UCRA_ERR_INVALID_ARGUMENT);
+    assert(result.flag_count == 0 && result.flags == NULL);
+    assert(ucra_flag_mapper_apply_into(mapper, legacy, 3, NULL, size, &result) == UCRA_ERR_INVALID_ARGUMENT);
+
+    free(arena);
+    ucra_flag_mapper_free(mapper);
+    printf("✓ ucra_flag_mapper_apply_into tests passed\n");
+}
+
+static const char* TYPED_MAPPING =
+    "{ \"engine\": \"typed\", \"version\": \"1.0\", \"rules\": [\n"
+    "  { \"source\": {\"name\": \"g\"}, \"target\": {\"name\": \"gender\"},\n"
+    "    \"transform\": {\"kind\": \"scale\", \"scale\": [-1.0, 1.0]} },\n"
+    "  { \"source\": {\"name\": \"v\"}, \"target\": {\"name\": \"velocity\", \"type\": \"int\"},\n"
+    "    \"transform\": {\"kind\": \"scale\", \"scale\": [0, 127]} },\n"
+    "  { \"source\": {\"name\": \"B\", \"type\": \"number\"}, \"target\": {\"name\": \"breath\", \"default\": 0.25} },\n"
+    "  { \"source\": {\"name\": \"n\"}, \"target\": {\"name\": \"noise\", \"type\": \"bool\"} },\n"
+    "  { \"source\": {\"name\": \"mode\"}, \"target\": {\"name\": \"articulation\", \"default\": \"accent\"},\n"
+    "    \"transform\": {\"kind\": \"map\", \"map\": {\"0\": \"legato\", \"1\": \"staccato\", \"2\": \"accent\"}} },\n"
+    "  { \"source\": {\"name\": \"e\"}, \"target\": {\"name\": \"engine\"},\n"
+    "    \"transform\": {\"kind\": \"constant\", \"value\": \"world\"} }\n"
+    "] }\n";
+
+static void test_flag_mapper_apply_typed(void) {
+    printf("Testing ucra_flag_mapper_apply_typed...\n");
+
+    UCRA_FlagMapper* mapper = load_mapping_text(TYPED_MAPPING);
+    assert(mapper->rule_count == 6);
+    assert(mapper->rules[0].value_type == UCRA_VALUE_FLOAT && mapper->rules[1].value_type == UCRA_VALUE_INT);
+    assert(mapper->rules[2].value_type == UCRA_VALUE_FLOAT && mapper->rules[3].value_type == UCRA_VALUE_BOOL);
+    assert(mapper->rules[4].value_type == UCRA_VALUE_ENUM && mapper->rules[5].value_type == UCRA_VALUE_STRING);
+
+    UCRA_KeyValue legacy[] = { {"g", "0.3333333"}, {"v", "0.5"}, {"n", "on"}, {"mode", "1"}, {"e", "?"} };
+    UCRA_TypedValue values[6];
+    uint32_t count = 0;
+    for (int compiled = 1; compiled >= 0; compiled--) {
+        UCRA_FlagMapperIndex* index = mapper->index;
+        if (!compiled) mapper->index = NULL;
+        assert(ucra_flag_mapper_apply_typed(mapper, legacy, 5, values, 6, &count) == UCRA_SUCCESS);
+        assert(count == 6);
+        /* the scaled value is not rounded to the string result's 6 digits */
+        assert(strcmp(values[0].key, "gender") == 0 && values[0].type == UCRA_VALUE_FLOAT);
+        assert(fabs(values[0].number - (-1.0 + 2.0 * 0.3333333)) < 1e-12 && values[0].text == NULL);
+        assert(values[1].type == UCRA_VALUE_INT && values[1].number == 64.0);
+        assert(values[2].type == UCRA_VALUE_FLOAT && values[2].number == 0.25);
+        assert(values[3].type == UCRA_VALUE_BOOL && values[3].number == 1.0);
+        assert(values[4].type == UCRA_VALUE_ENUM && values[4].number == 1.0);
+        assert(values[4].text == mapper->rules[4].map_values[1]);
+        assert(values[5].type == UCRA_VALUE_STRING && strcmp(values[5].text, "world") == 0);
+        mapper->index = index;
+    }
+
+    /* defaults that name a map value are enums; inputs that do not convert are skipped */
+    UCRA_KeyValue bad[] = { {"g", "half"}, {"n", "maybe"}, {"B", "1e"}, {"mode", "7"}, {"e", "?"} };
+    assert(ucra_flag_mapper_apply_typed(mapper, bad, 5, values, 6, &count) == UCRA_SUCCESS);
+    assert(count == 1 && strcmp(values[0].key, "engine") == 0);
+    assert(ucra_flag_mapper_apply_typed(mapper, NULL, 0, values, 6, &count) == UCRA_SUCCESS);
+    assert(count == 2);
+    assert(strcmp(values[0].key, "breath") == 0);
+    assert(values[1].type == UCRA_VALUE_ENUM && values[1].number == 2.0 && strcmp(values[1].text, "accent") == 0);
+
+    assert(ucra_flag_mapper_apply_typed(mapper, legacy, 5, values, 5, &count) == UCRA_ERR_INVALID_ARGUMENT);
+    assert(count == 0);
+    assert(ucra_flag_mapper_apply_typed(NULL, legacy, 5, values, 6, &count) == UCRA_ERR_INVALID_ARGUMENT);
+
+    ucra_flag_mapper_free(mapper);
+    printf("✓ ucra_flag_mapper_apply_typed tests passed\n");
+}
+
 int main(void) {
     printf("UCRA Flag Mapper Test Suite\n");
     printf("==========================\n\n");
@@ -113,6 +316,9 @@ int main(void) {
     test_parse_legacy_flags();
     test_flag_mapper_load();
     test_flag_mapper_apply();
+    test_flag_mapper_index();
+    test_flag_mapper_apply_into();
+    test_flag_mapper_apply_typed();
 
     printf("\n✓ All flag mapper tests completed\n");
     return 0;
@@ -0,0 +1,177 @@
+/*
+ * Test for the UCRA DSP kernels
+ * Every compiled-in SIMD variant must match the scalar reference
+ */
+
+#include "ucra_kernels.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <math.h>
+
+#define TEST_LEN 1027 /* odd length exercises the vector tails */
+
+static const char* variant_names[] = { "scalar", "sse2", "avx2", "neon" };
+
+static void test_sine_kernels(const UCRA_Kernels* ref, const UCRA_Kernels* k) {
+    float expected[TEST_LEN], actual[TEST_LEN];
+    float phase[TEST_LEN], amp[TEST_LEN];
+
+    /* ramp form, including increments near Nyquist and large start phases */
+    double incs[] = { 0.0627, 1.3, 3.1 };
+    for (size_t t = 0; t < sizeof(incs) / sizeof(incs[0]); t++) {
+        memset(expected, 0, sizeof(expected));
+        memset(actual, 0, sizeof(actual));
+        ref->sine_ramp_mac(expected, TEST_LEN, 5.9, incs[t], 0.5f);
+        k->sine_ramp_mac(actual, TEST_LEN, 5.9, incs[t], 0.5f);
+        for (int i = 0; i < TEST_LEN; i++) {
+            assert(fabsf(expected[i] - actual[i]) < 1e-5f);
+        }
+    }
+
+    /* per-sample phase and amplitude form */
+    for (int i = 0; i < TEST_LEN; i++) {
+        phase[i] = (float)(i * 0.37 - 40.0);
+        amp[i] = (float)(i % 7) / 7.0f;
+    }
+    memset(expected, 0, sizeof(expected));
+    memset(actual, 0, sizeof(actual));
+    ref->sine_mac(expected, phase, amp, TEST_LEN);
+    k->sine_mac(actual, phase, amp, TEST_LEN);
+    for (int i = 0; i < TEST_LEN; i++) {
+        assert(fabsf(expected[i] - actual[i]) < 1e-5f);
+    }
+}
+
+static void test_mix_kernels(const UCRA_Kernels* ref, const UCRA_Kernels* k) {
+    float src[TEST_LEN], expected[TEST_LEN], actual[TEST_LEN];
+    for (int i = 0; i < TEST_LEN; i++) {
+        src[i] = (float)sin(i * 0.1) * 3.0f;
+        expected[i] = actual[i] = (float)(i % 5) * 0.1f;
+    }
+
+    ref->gain_mac(expected, src, TEST_LEN, 0.25f);
+    k->gain_mac(actual, src, TEST_LEN, 0.25f);
+    assert(memcmp(expected, actual, sizeof(expected)) == 0);
+
+    ref->clip(expected, TEST_LEN, -1.0f, 1.0f);
+    k->clip(actual, TEST_LEN, -1.0f, 1.0f);
+    assert(memcmp(expected, actual, sizeof(expected)) == 0);
+    for (int i = 0; i < TEST_LEN; i++) {
+        assert(actual[i] >= -1.0f && actual[i] <= 1.0f);
+    }
+
+    /* filter taps: every length up to a few vectors, then the full odd length */
+    for (uint32_t n = 0; n <= TEST_LEN; n = n < 40 ? n + 1 : TEST_LEN) {
+        double magnitude = 0.0;
+        for (uint32_t i = 0; i < n; i++) magnitude += fabs((double)src[i] * expected[i]);
+        float dot = k->dot(src, expected, n);
+        assert(fabs(ref->dot(src, expected, n) - dot) <= 1e-6 * (1.0 + magnitude) * 4);
+        if (n == TEST_LEN) break;
+    }
+
+    for (uint32_t channels = 1; channels <= 3; channels++) {
+        float* out_ref = malloc(TEST_LEN * channels * sizeof(float));
+        float* out = malloc(TEST_LEN * channels * sizeof(float));
+        assert(out_ref && out);
+        ref->fan_out(out_ref, src, TEST_LEN, channels);
+        k->fan_out(out, src, TEST_LEN, channels);
+        assert(memcmp(out_ref, out, TEST_LEN * channels * sizeof(float)) == 0);
+        for (int i = 0; i < TEST_LEN; i++) {
+            assert(out[i * channels + channels - 1] == src[i]);
+        }
+        free(out_ref);
+        free(out);
+    }
+}
+
+static void test_quantize_kernel(const UCRA_Kernels* ref, const UCRA_Kernels* k) {
+    float src[TEST_LEN], dither[TEST_LEN];
+    int32_t expected[TEST_LEN], actual[TEST_LEN];
+    for (int i = 0; i < TEST_LEN; i++) {
+        src[i] = (float)sin(i * 0.05) * 1.2f; /* overshoots both ends */
+        dither[i] = (float)((i * 37) % 200 - 100) / 100.0f;
+    }
+    src[3] = NAN;
+    src[5] = 0.5f / 32768.0f; /* ties round to even */
+
+    ref->quantize(expected, src, NULL, TEST_LEN, 32768.0f, 32767.0f);
+    k->quantize(actual, src, NULL, TEST_LEN, 32768.0f, 32767.0f);
+    assert(memcmp(expected, actual, sizeof(expected)) == 0);
+    assert(actual[3] == -32768 && actual[5] == 0);
+    for (int i = 0; i < TEST_LEN; i++) {
+        assert(actual[i] >= -32768 && actual[i] <= 32767);
+    }
+
+    ref->quantize(expected, src, dither, TEST_LEN, 8388608.0f, 8388607.0f);
+    k->quantize(actual, src, dither, TEST_LEN, 8388608.0f, 8388607.0f);
+    assert(memcmp(expected, actual, sizeof(expected)) == 0);
+    for (int i = 0; i < TEST_LEN; i++) {
+        assert(actual[i] >= -8388608 && actual[i] <= 8388607);
+    }
+}
+
+static void test_convert_kernels(const UCRA_Kernels* ref, const UCRA_Kernels* k) {
+    unsigned char bytes[TEST_LEN * 3];
+    float expected[TEST_LEN], actual[TEST_LEN];
+    for (int i = 0; i < TEST_LEN * 3; i++) {
+        bytes[i] = (unsigned char)(i * 151 + (i >> 3));
+    }
+
+    ref->pcm16_to_float(expected, bytes, TEST_LEN);
+    k->pcm16_to_float(actual, bytes, TEST_LEN);
+    assert(memcmp(expected, actual, sizeof(expected)) == 0);
+    for (int i = 0; i < TEST_LEN; i++) {
+        assert(actual[i] * 32768.0f == (float)(int16_t)(bytes[2 * i] | (bytes[2 * i + 1] << 8)));
+    }
+
+    ref->pcm24_to_float(expected, bytes, TEST_LEN);
+    k->pcm24_to_float(actual, bytes, TEST_LEN);
+    assert(memcmp(expected, actual, sizeof(expected)) == 0);
+    for (int i = 0; i < TEST_LEN; i++) {
+        assert(actual[i] >= -1.0f && actual[i] < 1.0f);
+    }
+
+    float interleaved[TEST_LEN * 3];
+    for (int i = 0; i < TEST_LEN * 3; i++) {
+        interleaved[i] = (float)sin(i * 0.3);
+    }
+    for (uint32_t channels = 1; channels <= 3; channels++) {
+        uint32_t frames = TEST_LEN * 3 / channels;
+        float* out_ref = malloc(frames * sizeof(float));
+        float* out = malloc(frames * sizeof(float));
+        assert(out_ref && out);
+        ref->downmix(out_ref, interleaved, frames, channels);
+        k->downmix(out, interleaved, frames, channels);
+        assert(memcmp(out_ref, out, frames * sizeof(float)) == 0);
+        assert(out[1] == (channels == 2 ? (interleaved[2] + interleaved[3]) / 2 : out[1]));
+        free(out_ref);
+        free(out);
+    }
+}
+
+int main() {
+    printf("=== UCRA DSP Kernel Tests ===\n\n");
+
+    const UCRA_Kernels* ref = ucra_kernels_by_name("scalar");
+    assert(ref != NULL);
+    assert(ucra_kernels() != NULL);
+    printf("Selected kernels: %s\n", ucra_kernels()->name);
+
+    for (size_t i = 0; i < sizeof(variant_names) / sizeof(variant_names[0]); i++) {
+        const UCRA_Kernels* k = ucra_kernels_by_name(variant_names[i]);
+        if (!k) {
+            printf("- %s not available on this CPU\n", variant_names[i]);
+            continue;
+        }
+        test_sine_kernels(ref, k);
+        test_mix_kernels(ref, k);
+        test_quantize_kernel(ref, k);
+        test_convert_kernels(ref, k);
+        printf("✓ %s kernels match scalar reference\n", k->name);
+    }
+
+    printf("\n=== All kernel tests passed! ===\n");
+    return 0;
+}
@@ -0,0 +1,118 @@
+/*
+ * Test for compiled manifests
+ * Checks that a compiled manifest loads with the same contents and flag index
+ * as its JSON, and that a stale, corrupt or missing compiled file falls back to the JSON
+ */
+
+#include "ucra_manifest_compiled.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#define TEST_JSON "test_compiled_manifest.json"
+
+static void write_json(const char* vendor) {
+    FILE* file = fopen(TEST_JSON, "w");
+    assert(file != NULL);
+    fprintf(file,
+            "{ \"name\": \"Compiled\", \"version\": \"2.1\", \"vendor\": \"%s\",\n"
+            "  \"entry\": { \"type\": \"dll\", \"path\": \"./libc.so\", \"symbol\": \"ucra_entry\" },\n"
+            "  \"audio\": { \"rates\": [44100, 48000, 96000], \"channels\": [1, 2], \"streaming\": true },\n"
+            "  \"flags\": [\n"
+            "    { \"key\": \"g\", \"type\": \"float\", \"desc\": \"gender\", \"range\": [-12, 12], \"default\": 0.5 },\n"
+            "    { \"key\": \"algo\", \"type\": \"enum\", \"desc\": \"algorithm\", \"values\": [\"WORLD\", \"LLSM\"] },\n"
+            "    { \"key\": \"v\", \"type\": \"enum\", \"desc\": \"voice\", \"values\": [\"soft\"] },\n"
+            "    { \"key\": \"dbg\", \"type\": \"bool\", \"desc\": \"debug\" }\n"
+            "  ] }\n", vendor);
+    fclose(file);
+}
+
+static int same_string(const char* a, const char* b) {
+    return (a == NULL && b == NULL) || (a && b && strcmp(a, b) == 0);
+}
+
+static void assert_same(const UCRA_Manifest* a, const UCRA_Manifest* b) {
+    assert(same_string(a->name, b->name) && same_string(a->version, b->version));
+    assert(same_string(a->vendor, b->vendor) && same_string(a->license, b->license));
+    assert(same_string(a->entry.type, b->entry.type) && same_string(a->entry.path, b->entry.path));
+    assert(same_string(a->entry.symbol, b->entry.symbol));
+    assert(a->audio.rates_count == b->audio.rates_count && a->audio.channels_count == b->audio.channels_count);
+    assert(memcmp(a->audio.rates, b->audio.rates, a->audio.rates_count * sizeof(uint32_t)) == 0);
+    assert(memcmp(a->audio.channels, b->audio.channels, a->audio.channels_count * sizeof(uint32_t)) == 0);
+    assert(a->audio.streaming == b->audio.streaming);
+    assert(a->flags_count == b->flags_count);
+    for (uint32_t i = 0; i < a->flags_count; i++) {
+        const UCRA_ManifestFlag* x = &a->flags[i];
+        const UCRA_ManifestFlag* y = &b->flags[i];
+        assert(same_string(x->key, y->key) && same_string(x->type, y->type) && same_string(x->desc, y->desc));
+        assert(ucra_manifest_find_flag(a, x->key) == x && ucra_manifest_find_flag(b, y->key) == y);
+        assert(same_string(x->default_val, y->default_val));
+        assert((x->range == NULL) == (y->range == NULL));
+        assert(!x->range || (x->range[0] == y->range[0] && x->range[1] == y->range[1]));
+        assert(x->values_count == y->values_count);
+        for (uint32_t j = 0; j < x->values_count; j++) {
+            assert(same_string(x->values[j], y->values[j]));
+        }
+    }
+}
+
+static void test_compiled_round_trip() {
+    printf("Testing compiled manifest round trip...\n");
+    char compiled[64];
+    assert(ucra_manifest_compiled_path(TEST_JSON, compiled, sizeof(compiled)) == UCRA_SUCCESS);
+    assert(strcmp(compiled, "test_compiled_manifest_json.ucra") == 0);
+    remove(compiled);
+    write_json("Vendor");
+
+    UCRA_Manifest* parsed = NULL;
+    assert(ucra_manifest_load(TEST_JSON, &parsed) == UCRA_SUCCESS && !ucra_manifest_is_compiled(parsed));
+
+    assert(ucra_manifest_compile(TEST_JSON, NULL) == UCRA_SUCCESS);
+    UCRA_Manifest* mapped = NULL;
+    assert(ucra_manifest_load(TEST_JSON, &mapped) == UCRA_SUCCESS && ucra_manifest_is_compiled(mapped));
+    assert_same(parsed, mapped);
+    assert(strcmp(mapped->flags[1].values[1], "LLSM") == 0 && mapped->flags[2].values_count == 1);
+    assert(ucra_manifest_find_flag(mapped, "al") == NULL && ucra_manifest_find_flag(parsed, "") == NULL);
+    assert(ucra_manifest_find_flag(parsed, NULL) == NULL && ucra_manifest_find_flag(NULL, "g") == NULL);
+    ucra_manifest_free(mapped);
+    ucra_manifest_free(parsed);
+
+    /* editing the JSON makes the compiled file stale */
+    write_json("Other vendor");
+    assert(ucra_manifest_load(TEST_JSON, &mapped) == UCRA_SUCCESS);
+    assert(!ucra_manifest_is_compiled(mapped) && strcmp(mapped->vendor, "Other vendor") == 0);
+    ucra_manifest_free(mapped);
+
+    /* a truncated compiled file is ignored */
+    assert(ucra_manifest_compile(TEST_JSON, NULL) == UCRA_SUCCESS);
+    FILE* file = fopen(compiled, "rb");
+    assert(file != NULL);
+    char bytes[4096];
+    size_t size = fread(bytes, 1, sizeof(bytes), file);
+    fclose(file);
+    file = fopen(compiled, "wb");
+    fwrite(bytes, 1, size - 3, file);
+    fclose(file);
+    assert(ucra_manifest_load(TEST_JSON, &mapped) == UCRA_SUCCESS);
+    assert(!ucra_manifest_is_compiled(mapped) && strcmp(mapped->vendor, "Other vendor") == 0);
+    ucra_manifest_free(mapped);
+
+    /* invalid manifests are not compiled */
+    assert(ucra_manifest_compile("missing.json", NULL) == UCRA_ERR_FILE_NOT_FOUND);
+    file = fopen(TEST_JSON, "w");
+    fputs("{ \"name\": 1 }", file);
+    fclose(file);
+    assert(ucra_manifest_compile(TEST_JSON, NULL) == UCRA_ERR_INVALID_MANIFEST);
+
+    remove(compiled);
+    remove(TEST_JSON);
+    printf("✓ Compiled manifest test passed\n");
+}
+
+int main() {
+    printf("=== UCRA Compiled Manifest Tests ===\n");
+    test_compiled_round_trip();
+    printf("All compiled manifest tests passed!\n");
+    return 0;
+}
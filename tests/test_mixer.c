@@ -0,0 +1,218 @@
+/*
+ * Test for the UCRA Mixer API
+ * Checks that the mixed output equals the tracks' own streams with gain and
+ * pan applied, that ended tracks go silent and that arguments are validated
+ */
+
+#include "ucra/ucra.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <math.h>
+
+#define FRAMES 3000
+
+typedef struct {
+    UCRA_NoteSegment* notes;
+    uint32_t note_count;
+    int calls;
+    int fail_after; /* 0 = never end the track */
+} TrackData;
+
+static UCRA_Result track_pull(void* user_data, UCRA_RenderConfig* out_config) {
+    TrackData* data = (TrackData*)user_data;
+    data->calls++;
+    if (data->fail_after > 0 && data->calls > data->fail_after) {
+        return UCRA_ERR_INTERNAL;
+    }
+    out_config->notes = data->notes;
+    out_config->note_count = data->note_count;
+    return UCRA_SUCCESS;
+}
+
+/* Frames a mono stream delivers for one track on its own */
+static uint32_t render_alone(TrackData* data, float* out) {
+    UCRA_RenderConfig config = {
+        .sample_rate = 44100,
+        .channels = 1,
+        .block_size = 256,
+        .flags = 0,
+        .notes = NULL,
+        .note_count = 0,
+        .options = NULL,
+        .option_count = 0
+    };
+    UCRA_StreamHandle stream = NULL;
+    data->calls = 0;
+    assert(ucra_stream_open(&stream, &config, track_pull, data) == UCRA_SUCCESS);
+    uint32_t total = 0, got = 0;
+    while (total < FRAMES) {
+        ucra_stream_read(stream, out + total, FRAMES - total, &got);
+        if (got == 0) break;
+        total += got;
+    }
+    ucra_stream_close(stream);
+    data->calls = 0;
+    return total;
+}
+
+static void test_mix_matches_tracks() {
+    printf("Testing mixed output against separate streams...\n");
+
+    UCRA_NoteSegment notes_a[1] = { { 0.0, 1.0, 60, 100, "a", NULL, NULL } };
+    UCRA_NoteSegment notes_b[2] = {
+        { 0.01, 0.5, 67, 80, "i", NULL, NULL },
+        { 0.03, 0.5, 72, 90, "u", NULL, NULL }
+    };
+    TrackData a = { notes_a, 1, 0, 0 };
+    TrackData b = { notes_b, 2, 0, 0 };
+
+    static float ref_a[FRAMES], ref_b[FRAMES], mixed[FRAMES * 2];
+    assert(render_alone(&a, ref_a) == FRAMES);
+    assert(render_alone(&b, ref_b) == FRAMES);
+
+    /* two render threads, so the tracks are pulled on the pool even on one CPU */
+    UCRA_KeyValue options[1] = { { "render_threads", "2" } };
+    UCRA_RenderConfig config = {
+        .sample_rate = 44100,
+        .channels = 2,
+        .block_size = 256,
+        .flags = 0,
+        .notes = NULL,
+        .note_count = 0,
+        .options = options,
+        .option_count = 1
+    };
+    UCRA_MixerHandle mixer = NULL;
+    assert(ucra_mixer_create(&mixer, &config) == UCRA_SUCCESS);
+    uint32_t track_a = 99, track_b = 99;
+    assert(ucra_mixer_add_track(mixer, NULL, NULL, track_pull, &a, &track_a) == UCRA_SUCCESS);
+    assert(ucra_mixer_add_track(mixer, NULL, NULL, track_pull, &b, &track_b) == UCRA_SUCCESS);
+    assert(track_a == 0 && track_b == 1);
+    assert(ucra_mixer_set_track(mixer, track_a, 0.5f, -1.0f) == UCRA_SUCCESS);
+    assert(ucra_mixer_set_track(mixer, track_b, 2.0f, 0.0f) == UCRA_SUCCESS);
+
+    /* odd read sizes cross the mixer's internal chunks */
+    uint32_t total = 0, got = 0;
+    while (total < FRAMES) {
+        uint32_t want = FRAMES - total < 777 ? FRAMES - total : 777;
+        assert(ucra_mixer_read(mixer, mixed + (size_t)total * 2, want, &got) == UCRA_SUCCESS);
+        assert(got == want);
+        total += got;
+    }
+
+    float centre = 2.0f * (float)cos(M_PI / 4.0);
+    float max_err = 0.0f;
+    for (uint32_t n = 0; n < FRAMES; n++) {
+        float left = 0.5f * ref_a[n] + centre * ref_b[n];
+        float right = centre * ref_b[n]; /* track a is hard left */
+        max_err = fmaxf(max_err, fabsf(mixed[2 * n] - left));
+        max_err = fmaxf(max_err, fabsf(mixed[2 * n + 1] - right));
+    }
+    assert(max_err < 1e-5f);
+
+    UCRA_StreamHandle stream = NULL;
+    UCRA_StreamStats stats;
+    assert(ucra_mixer_get_track_stream(mixer, track_b, &stream) == UCRA_SUCCESS && stream != NULL);
+    assert(ucra_stream_get_stats(stream, &stats) == UCRA_SUCCESS);
+    assert(stats.frames_produced >= FRAMES);
+
+    ucra_mixer_destroy(mixer);
+    printf("✓ Mixed output test passed\n");
+}
+
+static void test_track_end() {
+    printf("Testing tracks that end...\n");
+
+    UCRA_NoteSegment notes[1] = { { 0.0, 1.0, 64, 100, "a", NULL, NULL } };
+    TrackData long_track = { notes, 1, 0, 0 };
+    TrackData short_track = { notes, 1, 0, 2 }; /* the callback ends it on its third call */
+
+    static float ref[FRAMES], short_ref[FRAMES], mixed[FRAMES];
+    assert(render_alone(&long_track, ref) == FRAMES);
+    uint32_t short_frames = render_alone(&short_track, short_ref);
+    assert(short_frames > 0 && short_frames < FRAMES);
+
+    UCRA_RenderConfig config = {
+        .sample_rate = 44100,
+        .channels = 1,
+        .block_size = 256,
+        .flags = 0,
+        .notes = NULL,
+        .note_count = 0,
+        .options = NULL,
+        .option_count = 0
+    };
+    UCRA_MixerHandle mixer = NULL;
+    assert(ucra_mixer_create(&mixer, &config) == UCRA_SUCCESS);
+    assert(ucra_mixer_add_track(mixer, NULL, NULL, track_pull, &long_track, NULL) == UCRA_SUCCESS);
+    assert(ucra_mixer_add_track(mixer, NULL, NULL, track_pull, &short_track, NULL) == UCRA_SUCCESS);
+
+    uint32_t got = 0;
+    assert(ucra_mixer_read(mixer, mixed, FRAMES, &got) == UCRA_SUCCESS);
+    assert(got == FRAMES);
+    /* both tracks play the same notes until the short one ends */
+    for (uint32_t n = 0; n < short_frames; n++) {
+        assert(fabsf(mixed[n] - 2.0f * ref[n]) < 1e-5f);
+    }
+    for (uint32_t n = short_frames; n < FRAMES; n++) {
+        assert(fabsf(mixed[n] - ref[n]) < 1e-5f);
+    }
+    ucra_mixer_destroy(mixer);
+
+    /* a mixer whose only track ended has nothing left to deliver */
+    short_track.calls = 0;
+    assert(ucra_mixer_create(&mixer, &config) == UCRA_SUCCESS);
+    assert(ucra_mixer_add_track(mixer, NULL, NULL, track_pull, &short_track, NULL) == UCRA_SUCCESS);
+    assert(ucra_mixer_read(mixer, mixed, FRAMES, &got) == UCRA_SUCCESS && got == short_frames);
+    assert(ucra_mixer_read(mixer, mixed, FRAMES, &got) == UCRA_SUCCESS && got == 0);
+    ucra_mixer_destroy(mixer);
+    printf("✓ Track end test passed\n");
+}
+
+static void test_invalid_arguments() {
+    printf("Testing invalid mixer arguments...\n");
+
+    UCRA_RenderConfig config = {
+        .sample_rate = 44100,
+        .channels = 6,
+        .block_size = 256,
+        .flags = 0,
+        .notes = NULL,
+        .note_count = 0,
+        .options = NULL,
+        .option_count = 0
+    };
+    UCRA_MixerHandle mixer = NULL;
+    assert(ucra_mixer_create(&mixer, &config) == UCRA_ERR_INVALID_ARGUMENT && mixer == NULL);
+    config.channels = 2;
+    assert(ucra_mixer_create(NULL, &config) == UCRA_ERR_INVALID_ARGUMENT);
+    assert(ucra_mixer_create(&mixer, &config) == UCRA_SUCCESS);
+
+    TrackData data = { NULL, 0, 0, 0 };
+    float buffer[64];
+    uint32_t got = 7;
+    assert(ucra_mixer_add_track(mixer, NULL, NULL, NULL, &data, NULL) == UCRA_ERR_INVALID_ARGUMENT);
+    assert(ucra_mixer_set_track(mixer, 0, 1.0f, 0.0f) == UCRA_ERR_INVALID_ARGUMENT);
+    assert(ucra_mixer_read(mixer, buffer, 32, &got) == UCRA_SUCCESS && got == 0);
+
+    assert(ucra_mixer_add_track(mixer, NULL, NULL, track_pull, &data, NULL) == UCRA_SUCCESS);
+    assert(ucra_mixer_set_track(mixer, 0, 1.0f, 1.5f) == UCRA_ERR_INVALID_ARGUMENT);
+    assert(ucra_mixer_set_track(mixer, 0, 1.0f, NAN) == UCRA_ERR_INVALID_ARGUMENT);
+    assert(ucra_mixer_read(NULL, buffer, 32, &got) == UCRA_ERR_INVALID_ARGUMENT);
+    assert(ucra_mixer_read(mixer, buffer, 32, &got) == UCRA_SUCCESS && got == 32);
+
+    ucra_mixer_destroy(mixer);
+    ucra_mixer_destroy(NULL);
+    printf("✓ Invalid argument test passed\n");
+}
+
+int main() {
+    printf("=== UCRA Mixer Tests ===\n");
+    test_mix_matches_tracks();
+    test_track_end();
+    test_invalid_arguments();
+    printf("All mixer tests passed!\n");
+    return 0;
+}
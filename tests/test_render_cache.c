@@ -0,0 +1,238 @@
+/*
+ * Test for the UCRA render cache
+ * Checks that repeated renders hit with identical PCM, which request changes
+ * miss, and that the least recently used entries are evicted at the bound
+ */
+
+#include "ucra/ucra.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#ifdef _WIN32
+    #include <windows.h>
+    #include <direct.h>
+    #define remove_dir(path) _rmdir(path)
+    #define pause_ms(ms) Sleep(ms)
+#else
+    #include <dirent.h>
+    #include <unistd.h>
+    #define remove_dir(path) rmdir(path)
+    #define pause_ms(ms) usleep((ms) * 1000)
+#endif
+
+#define CACHE_DIR "render_cache_test_dir"
+
+static void remove_cache_dir() {
+    char path[512];
+#ifdef _WIN32
+    WIN32_FIND_DATAA data;
+    HANDLE find = FindFirstFileA(CACHE_DIR "\\*", &data);
+    if (find != INVALID_HANDLE_VALUE) {
+        do {
+            snprintf(path, sizeof(path), CACHE_DIR "/%s", data.cFileName);
+            remove(path);
+        } while (FindNextFileA(find, &data));
+        FindClose(find);
+    }
+#else
+    DIR* dir = opendir(CACHE_DIR);
+    if (dir) {
+        struct dirent* entry;
+        while ((entry = readdir(dir)) != NULL) {
+            snprintf(path, sizeof(path), CACHE_DIR "/%s", entry->d_name);
+            remove(path);
+        }
+        closedir(dir);
+    }
+#endif
+    remove_dir(CACHE_DIR);
+}
+
+/* Render through the cache; returns whether it hit and copies the PCM into copy */
+static int render(UCRA_RenderCacheHandle cache, UCRA_Handle engine, const UCRA_Manifest* manifest,
+                  const UCRA_RenderConfig* config, float* copy, uint64_t* frames) {
+    UCRA_RenderResult result;
+    int hit = -1;
+    assert(ucra_render_cached(cache, engine, manifest, config, &result, &hit) == UCRA_SUCCESS);
+    assert(hit == 0 || hit == 1);
+    assert(result.status == UCRA_SUCCESS && result.pcm != NULL);
+    assert(result.sample_rate == config->sample_rate && result.channels == config->channels);
+    if (copy) memcpy(copy, result.pcm, (size_t)result.frames * result.channels * sizeof(float));
+    if (frames) *frames = result.frames;
+    return hit;
+}
+
+static void test_hits_and_misses() {
+    printf("Testing cache hits and misses...\n");
+    remove_cache_dir();
+
+    UCRA_Handle engine = NULL;
+    assert(ucra_engine_create(&engine, NULL, 0) == UCRA_SUCCESS);
+    UCRA_RenderCacheHandle cache = NULL;
+    assert(ucra_render_cache_open(&cache, CACHE_DIR, 0) == UCRA_SUCCESS && cache != NULL);
+
+    float f0_time[3] = { 0.0f, 0.1f, 0.2f };
+    float f0_hz[3] = { 220.0f, 233.0f, 247.0f };
+    UCRA_F0Curve f0 = { f0_time, f0_hz, 3 };
+    UCRA_NoteSegment notes[2] = {
+        { 0.0, 0.2, 57, 100, "a", &f0, NULL },
+        { 0.1, 0.2, 64, 90, "i", NULL, NULL }
+    };
+    UCRA_KeyValue options[2] = { { "curve_interp", "linear" }, { "g", "3" } };
+    UCRA_RenderConfig config = {
+        .sample_rate = 22050,
+        .channels = 2,
+        .block_size = 256,
+        .flags = 0,
+        .notes = notes,
+        .note_count = 2,
+        .options = options,
+        .option_count = 2
+    };
+
+    static float first[22050 * 2], second[22050 * 2];
+    uint64_t first_frames = 0, second_frames = 0;
+    assert(render(cache, engine, NULL, &config, first, &first_frames) == 0);
+    assert(first_frames > 0);
+    assert(render(cache, engine, NULL, &config, second, &second_frames) == 1);
+    assert(second_frames == first_frames);
+    assert(memcmp(first, second, (size_t)first_frames * 2 * sizeof(float)) == 0);
+
+    /* a new handle on the same directory finds the stored entry */
+    ucra_render_cache_close(cache);
+    assert(ucra_render_cache_open(&cache, CACHE_DIR, 0) == UCRA_SUCCESS);
+    assert(render(cache, engine, NULL, &config, second, NULL) == 1);
+    assert(memcmp(first, second, (size_t)first_frames * 2 * sizeof(float)) == 0);
+
+    /* the order of options is not part of the request */
+    UCRA_KeyValue swapped[2] = { { "g", "3" }, { "curve_interp", "linear" } };
+    config.options = swapped;
+    assert(render(cache, engine, NULL, &config, NULL, NULL) == 1);
+
+    /* everything else is */
+    swapped[0].value = "4";
+    assert(render(cache, engine, NULL, &config, NULL, NULL) == 0);
+    config.options = options;
+    f0_hz[1] = 234.0f;
+    assert(render(cache, engine, NULL, &config, NULL, NULL) == 0);
+    notes[1].lyric = NULL;
+    assert(render(cache, engine, NULL, &config, NULL, NULL) == 0);
+    config.flags = UCRA_RENDER_LAYOUT_PLANAR;
+    assert(render(cache, engine, NULL, &config, NULL, NULL) == 0);
+    assert(render(cache, engine, NULL, &config, NULL, NULL) == 1);
+
+    UCRA_Manifest manifest;
+    memset(&manifest, 0, sizeof(manifest));
+    manifest.name = "engine";
+    manifest.version = "1.0";
+    assert(render(cache, engine, &manifest, &config, NULL, NULL) == 0);
+    assert(render(cache, engine, &manifest, &config, NULL, NULL) == 1);
+    manifest.version = "1.1";
+    assert(render(cache, engine, &manifest, &config, NULL, NULL) == 0);
+
+    ucra_render_cache_close(cache);
+    ucra_engine_destroy(engine);
+    remove_cache_dir();
+    printf("✓ Hit and miss test passed\n");
+}
+
+static void test_eviction() {
+    printf("Testing least recently used eviction...\n");
+    remove_cache_dir();
+
+    UCRA_Handle engine = NULL;
+    assert(ucra_engine_create(&engine, NULL, 0) == UCRA_SUCCESS);
+    /* each entry holds 800 floats (3.2 kB), so two fit */
+    UCRA_RenderCacheHandle cache = NULL;
+    assert(ucra_render_cache_open(&cache, CACHE_DIR, 8000) == UCRA_SUCCESS);
+
+    UCRA_NoteSegment a = { 0.0, 0.1, 60, 100, "a", NULL, NULL };
+    UCRA_NoteSegment b = { 0.0, 0.1, 62, 100, "a", NULL, NULL };
+    UCRA_NoteSegment c = { 0.0, 0.1, 64, 100, "a", NULL, NULL };
+    UCRA_RenderConfig config_a = {
+        .sample_rate = 8000,
+        .channels = 1,
+        .block_size = 256,
+        .flags = 0,
+        .notes = &a,
+        .note_count = 1,
+        .options = NULL,
+        .option_count = 0
+    };
+    UCRA_RenderConfig config_b = config_a;
+    UCRA_RenderConfig config_c = config_a;
+    config_b.notes = &b;
+    config_c.notes = &c;
+
+    /* pauses keep the entries' modification times apart on coarse file system clocks */
+    assert(render(cache, engine, NULL, &config_a, NULL, NULL) == 0);
+    pause_ms(30);
+    assert(render(cache, engine, NULL, &config_b, NULL, NULL) == 0);
+    pause_ms(30);
+    assert(render(cache, engine, NULL, &config_a, NULL, NULL) == 1); /* a is now the newer one */
+    pause_ms(30);
+    assert(render(cache, engine, NULL, &config_c, NULL, NULL) == 0); /* evicts b */
+
+    assert(render(cache, engine, NULL, &config_c, NULL, NULL) == 1);
+    assert(render(cache, engine, NULL, &config_a, NULL, NULL) == 1);
+    assert(render(cache, engine, NULL, &config_b, NULL, NULL) == 0);
+
+    /* an entry larger than the whole bound is rendered but not stored */
+    UCRA_NoteSegment long_note = { 0.0, 1.0, 60, 100, "a", NULL, NULL };
+    UCRA_RenderConfig config_long = config_a;
+    config_long.notes = &long_note;
+    assert(render(cache, engine, NULL, &config_long, NULL, NULL) == 0);
+    assert(render(cache, engine, NULL, &config_long, NULL, NULL) == 0);
+
+    ucra_render_cache_close(cache);
+    ucra_engine_destroy(engine);
+    remove_cache_dir();
+    printf("✓ Eviction test passed\n");
+}
+
+static void test_invalid_arguments() {
+    printf("Testing invalid cache arguments...\n");
+    UCRA_RenderCacheHandle cache = NULL;
+    assert(ucra_render_cache_open(NULL, CACHE_DIR, 0) == UCRA_ERR_INVALID_ARGUMENT);
+    assert(ucra_render_cache_open(&cache, NULL, 0) == UCRA_ERR_INVALID_ARGUMENT && cache == NULL);
+    assert(ucra_render_cache_open(&cache, "render_cache_missing/sub", 0) == UCRA_ERR_FILE_NOT_FOUND);
+
+    UCRA_Handle engine = NULL;
+    assert(ucra_engine_create(&engine, NULL, 0) == UCRA_SUCCESS);
+    assert(ucra_render_cache_open(&cache, CACHE_DIR, 0) == UCRA_SUCCESS);
+    UCRA_RenderConfig config = {
+        .sample_rate = 8000,
+        .channels = 1,
+        .block_size = 256,
+        .flags = 0,
+        .notes = NULL,
+        .note_count = 0,
+        .options = NULL,
+        .option_count = 0
+    };
+    UCRA_RenderResult result;
+    int hit = 7;
+    assert(ucra_render_cached(NULL, engine, NULL, &config, &result, &hit) == UCRA_ERR_INVALID_ARGUMENT);
+    assert(hit == 0);
+    assert(ucra_render_cached(cache, NULL, NULL, &config, &result, NULL) == UCRA_ERR_INVALID_ARGUMENT);
+    assert(ucra_render_cached(cache, engine, NULL, NULL, &result, NULL) == UCRA_ERR_INVALID_ARGUMENT);
+    config.note_count = 1;
+    assert(ucra_render_cached(cache, engine, NULL, &config, &result, NULL) == UCRA_ERR_INVALID_ARGUMENT);
+
+    ucra_render_cache_close(cache);
+    ucra_render_cache_close(NULL);
+    ucra_engine_destroy(engine);
+    remove_cache_dir();
+    printf("✓ Invalid argument test passed\n");
+}
+
+int main() {
+    printf("=== UCRA Render Cache Tests ===\n");
+    test_hits_and_misses();
+    test_eviction();
+    test_invalid_arguments();
+    printf("All render cache tests passed!\n");
+    return 0;
+}
@@ -0,0 +1,278 @@
+/*
+ * Test for UCRA render sessions
+ * Checks that after each kind of edit a session's output matches a fresh
+ * render bit for bit, that only the edited notes' frames are rendered again on
+ * a note-local engine and everything on any other, that setting changes and
+ * invalidation render everything, and the rejected calls
+ */
+
+#include "ucra/ucra.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <math.h>
+
+#define RATE 44100
+#define NOTES 24
+
+static UCRA_NoteSegment g_notes[NOTES];
+static float g_times[50], g_f0s[50];
+static UCRA_F0Curve g_curve = { g_times, g_f0s, 50 };
+static int g_note_local;
+
+static void make_song(void) {
+    for (int i = 0; i < 50; i++) {
+        g_times[i] = (float)(i * 0.01);
+        g_f0s[i] = (float)(300.0 + 40.0 * sin(i * 0.2));
+    }
+    for (int i = 0; i < NOTES; i++) {
+        UCRA_NoteSegment note = { i * 0.25, 0.25, (int16_t)(60 + i % 12), 100, "a", NULL, NULL };
+        if (i % 5 == 0) note.f0_override = &g_curve;
+        g_notes[i] = note;
+    }
+}
+
+static UCRA_RenderConfig make_config(UCRA_NoteSegment* notes, uint32_t count) {
+    UCRA_RenderConfig config;
+    memset(&config, 0, sizeof(config));
+    config.sample_rate = RATE;
+    config.channels = 2;
+    config.block_size = 512;
+    config.notes = notes;
+    config.note_count = count;
+    return config;
+}
+
+/* The session's output is a fresh engine's ucra_render of config */
+static void check_matches(const UCRA_RenderConfig* config, const UCRA_RenderResult* result) {
+    UCRA_Handle engine = NULL;
+    assert(ucra_engine_create(&engine, NULL, 0) == UCRA_SUCCESS);
+    UCRA_RenderResult fresh;
+    assert(ucra_render(engine, config, &fresh) == UCRA_SUCCESS);
+    assert(result->frames == fresh.frames);
+    assert(result->channels == fresh.channels && result->sample_rate == fresh.sample_rate);
+    uint64_t samples = UCRA_RENDER_LAYOUT(config->flags) == UCRA_RENDER_LAYOUT_MONO
+                           ? fresh.frames : fresh.frames * fresh.channels;
+    assert(memcmp(result->pcm, fresh.pcm, (size_t)samples * sizeof(float)) == 0);
+    ucra_engine_destroy(engine);
+}
+
+static uint64_t dirty_frames(UCRA_RenderSessionHandle session, uint32_t* out_count) {
+    const UCRA_FrameRange* ranges = NULL;
+    uint32_t count = 0;
+    assert(ucra_render_session_dirty(session, &ranges, &count) == UCRA_SUCCESS);
+    uint64_t total = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        if (i > 0) assert(ranges[i].start > ranges[i - 1].start + ranges[i - 1].frames);
+        total += ranges[i].frames;
+    }
+    if (out_count) *out_count = count;
+    return total;
+}
+
+/* An edit renders a part under bound, or all frames of a non-local engine */
+static int partial(uint64_t rendered, uint64_t frames, uint64_t bound) {
+    return g_note_local ? rendered > 0 && rendered < bound : rendered == frames;
+}
+
+static void test_edits(uint32_t layout) {
+    printf("Testing edits with layout %u...\n", layout);
+    UCRA_NoteSegment notes[NOTES + 1];
+    memcpy(notes, g_notes, sizeof(g_notes));
+    UCRA_RenderConfig config = make_config(notes, NOTES);
+    config.flags = layout;
+
+    UCRA_Handle engine = NULL;
+    assert(ucra_engine_create(&engine, NULL, 0) == UCRA_SUCCESS);
+    UCRA_RenderSessionHandle session = NULL;
+    assert(ucra_render_session_create(&session, engine, 0.0) == UCRA_SUCCESS);
+
+    UCRA_RenderResult result;
+    assert(ucra_render_session_render(session, &config, &result) == UCRA_SUCCESS);
+    check_matches(&config, &result);
+    uint32_t count = 0;
+    uint64_t total = result.frames;
+    assert(dirty_frames(session, &count) == total && count == 1);
+
+    /* nothing changed: nothing rendered */
+    assert(ucra_render_session_render(session, &config, &result) == UCRA_SUCCESS);
+    assert(dirty_frames(session, &count) == 0 && count == 0);
+    check_matches(&config, &result);
+
+    /* a pitch edit in place re-renders about that note */
+    notes[10].midi_note = 75;
+    assert(ucra_render_session_render(session, &config, &result) == UCRA_SUCCESS);
+    check_matches(&config, &result);
+    uint64_t rendered = dirty_frames(session, &count);
+    assert(count == 1 && partial(rendered, total, total / 8));
+
+    /* notes swapped within the array are the same notes, to a note-local engine */
+    UCRA_NoteSegment swap = notes[3];
+    notes[3] = notes[17];
+    notes[17] = swap;
+    assert(ucra_render_session_render(session, &config, &result) == UCRA_SUCCESS);
+    assert(dirty_frames(session, &count) == (g_note_local ? 0 : total));
+    check_matches(&config, &result);
+
+    /* a move renders both the old and the new place */
+    notes[5].start_sec += 1.0;
+    notes[5].duration_sec = 0.1;
+    assert(ucra_render_session_render(session, &config, &result) == UCRA_SUCCESS);
+    check_matches(&config, &result);
+    assert(partial(dirty_frames(session, &count), total, total / 4));
+
+    /* an edited curve counts as an edited note */
+    float times[50], f0s[50];
+    memcpy(times, g_times, sizeof(times));
+    memcpy(f0s, g_f0s, sizeof(f0s));
+    UCRA_F0Curve curve = { times, f0s, 50 };
+    notes[20].f0_override = &curve;
+    assert(ucra_render_session_render(session, &config, &result) == UCRA_SUCCESS);
+    assert(dirty_frames(session, &count) == 0); /* equal contents */
+    f0s[7] = 500.0f;
+    assert(ucra_render_session_render(session, &config, &result) == UCRA_SUCCESS);
+    check_matches(&config, &result);
+    assert(partial(dirty_frames(session, &count), total, total) && count == 1);
+
+    if (layout != UCRA_RENDER_LAYOUT_PLANAR) {
+        /* a note past the end grows the output */
+        UCRA_NoteSegment added = { NOTES * 0.25 + 0.5, 0.3, 69, 90, "o", NULL, NULL };
+        notes[NOTES] = added;
+        config.note_count = NOTES + 1;
+        assert(ucra_render_session_render(session, &config, &result) == UCRA_SUCCESS);
+        check_matches(&config, &result);
+        assert(result.frames > total);
+        assert(partial(dirty_frames(session, &count), result.frames, total / 4));
+
+        /* and removing it shrinks it back */
+        config.note_count = NOTES;
+        assert(ucra_render_session_render(session, &config, &result) == UCRA_SUCCESS);
+        check_matches(&config, &result);
+        assert(result.frames == total);
+    }
+
+    /* an option changes everything */
+    UCRA_KeyValue interp = { "curve_interpolation", "cubic" };
+    config.options = &interp;
+    config.option_count = 1;
+    assert(ucra_render_session_render(session, &config, &result) == UCRA_SUCCESS);
+    check_matches(&config, &result);
+    assert(dirty_frames(session, &count) == result.frames && count == 1);
+
+    /* as does invalidation */
+    ucra_render_session_invalidate(session);
+    assert(ucra_render_session_render(session, &config, &result) == UCRA_SUCCESS);
+    assert(dirty_frames(session, &count) == result.frames);
+
+    ucra_render_session_destroy(session);
+    ucra_engine_destroy(engine);
+    printf("✓ Edits with layout %u test passed\n", layout);
+}
+
+/* A margin widens each range by about that much on both sides */
+static void test_margin(void) {
+    printf("Testing margin...\n");
+    UCRA_NoteSegment notes[NOTES];
+    memcpy(notes, g_notes, sizeof(g_notes));
+    UCRA_RenderConfig config = make_config(notes, NOTES);
+
+    UCRA_Handle engine = NULL;
+    assert(ucra_engine_create(&engine, NULL, 0) == UCRA_SUCCESS);
+    UCRA_RenderSessionHandle session = NULL;
+    assert(ucra_render_session_create(&session, engine, 0.05) == UCRA_SUCCESS);
+    UCRA_RenderResult result;
+    assert(ucra_render_session_render(session, &config, &result) == UCRA_SUCCESS);
+
+    notes[8].velocity = 60;
+    assert(ucra_render_session_render(session, &config, &result) == UCRA_SUCCESS);
+    check_matches(&config, &result);
+    const UCRA_FrameRange* ranges = NULL;
+    uint32_t count = 0;
+    assert(ucra_render_session_dirty(session, &ranges, &count) == UCRA_SUCCESS && count == 1);
+    if (!g_note_local) {
+        assert(ranges[0].start == 0 && ranges[0].frames == result.frames);
+        ucra_render_session_destroy(session);
+        ucra_engine_destroy(engine);
+        printf("✓ Margin test passed (engine is not note-local)\n");
+        return;
+    }
+    uint64_t note_start = (uint64_t)(8 * 0.25 * RATE);
+    uint64_t note_frames = (uint64_t)(0.25 * RATE);
+    uint64_t margin = (uint64_t)(0.05 * RATE);
+    assert(ranges[0].start <= note_start - margin && ranges[0].start >= note_start - margin - 2);
+    assert(ranges[0].frames >= note_frames + 2 * margin && ranges[0].frames <= note_frames + 2 * margin + 4);
+
+    ucra_render_session_destroy(session);
+    ucra_engine_destroy(engine);
+    printf("✓ Margin test passed\n");
+}
+
+static void test_errors(void) {
+    printf("Testing rejected calls...\n");
+    UCRA_Handle engine = NULL;
+    assert(ucra_engine_create(&engine, NULL, 0) == UCRA_SUCCESS);
+    UCRA_RenderSessionHandle session = NULL;
+    assert(ucra_render_session_create(NULL, engine, 0.0) == UCRA_ERR_INVALID_ARGUMENT);
+    assert(ucra_render_session_create(&session, NULL, 0.0) == UCRA_ERR_INVALID_ARGUMENT);
+    assert(ucra_render_session_create(&session, engine, -1.0) == UCRA_ERR_INVALID_ARGUMENT);
+    assert(ucra_render_session_create(&session, engine, NAN) == UCRA_ERR_INVALID_ARGUMENT);
+    assert(session == NULL);
+    assert(ucra_render_session_create(&session, engine, 0.0) == UCRA_SUCCESS);
+
+    UCRA_RenderConfig config = make_config(g_notes, NOTES);
+    UCRA_RenderResult result;
+    assert(ucra_render_session_render(NULL, &config, &result) == UCRA_ERR_INVALID_ARGUMENT);
+    assert(ucra_render_session_render(session, NULL, &result) == UCRA_ERR_INVALID_ARGUMENT);
+    assert(ucra_render_session_render(session, &config, NULL) == UCRA_ERR_INVALID_ARGUMENT);
+    config.notes = NULL;
+    assert(ucra_render_session_render(session, &config, &result) == UCRA_ERR_INVALID_ARGUMENT);
+    assert(result.status == UCRA_ERR_INVALID_ARGUMENT);
+
+    /* an engine error leaves nothing kept, so the next render is a full one */
+    config = make_config(g_notes, NOTES);
+    assert(ucra_render_session_render(session, &config, &result) == UCRA_SUCCESS);
+    config.flags = UCRA_RENDER_LAYOUT_MASK; /* no such layout */
+    assert(ucra_render_session_render(session, &config, &result) == UCRA_ERR_INVALID_ARGUMENT);
+    config.flags = 0;
+    assert(ucra_render_session_render(session, &config, &result) == UCRA_SUCCESS);
+    assert(dirty_frames(session, NULL) == result.frames);
+
+    const UCRA_FrameRange* ranges = NULL;
+    uint32_t count = 0;
+    assert(ucra_render_session_dirty(NULL, &ranges, &count) == UCRA_ERR_INVALID_ARGUMENT);
+    assert(ucra_render_session_dirty(session, NULL, &count) == UCRA_ERR_INVALID_ARGUMENT);
+    ucra_render_session_invalidate(NULL);
+    ucra_render_session_destroy(NULL);
+    ucra_render_session_destroy(session);
+    ucra_engine_destroy(engine);
+    printf("✓ Rejected calls test passed\n");
+}
+
+int main() {
+    printf("=== UCRA Render Session Tests ===\n\n");
+    make_song();
+
+    UCRA_Handle engine = NULL;
+    uint32_t caps = 0;
+    assert(ucra_engine_create(&engine, NULL, 0) == UCRA_SUCCESS);
+    assert(ucra_engine_get_capabilities(engine, &caps) == UCRA_SUCCESS);
+    assert(ucra_engine_get_capabilities(engine, NULL) == UCRA_ERR_INVALID_ARGUMENT);
+    assert(ucra_engine_get_capabilities(NULL, &caps) == UCRA_ERR_INVALID_ARGUMENT);
+    ucra_engine_destroy(engine);
+    g_note_local = (caps & UCRA_ENGINE_CAP_NOTE_LOCAL) != 0;
+#ifdef UCRA_HAS_WORLD
+    assert(!g_note_local);
+#else
+    assert(g_note_local);
+#endif
+
+    test_edits(UCRA_RENDER_LAYOUT_INTERLEAVED);
+    test_edits(UCRA_RENDER_LAYOUT_PLANAR);
+    test_edits(UCRA_RENDER_LAYOUT_MONO);
+    test_margin();
+    test_errors();
+
+    printf("\n=== All render session tests passed! ===\n");
+    return 0;
+}
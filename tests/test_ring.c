@@ -0,0 +1,153 @@
+/*
+ * Test for the UCRA PCM ring
+ * Checks power-of-two sizing, wraparound, index wrap at 2^32, inline rings
+ * and that a producer and a consumer thread see every frame once and in order
+ */
+
+#include "ucra_ring.h"
+#include "ucra_threads.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#define STRESS_FRAMES 200000u
+
+static void test_sizing_and_wrap() {
+    printf("Testing ring sizing and wraparound...\n");
+    UCRA_Ring ring;
+    assert(ucra_ring_init(&ring, 0, 2) == UCRA_ERR_INVALID_ARGUMENT);
+    assert(ucra_ring_init(&ring, 5, 2) == UCRA_SUCCESS);
+    assert(ring.capacity == 8 && ucra_ring_writable(&ring) == 8 && ucra_ring_readable(&ring) == 0);
+
+    /* stereo frames n carry (n, -n); writes past the capacity are cut short */
+    float in[20], out[20];
+    for (int n = 0; n < 10; n++) {
+        in[2 * n] = (float)n;
+        in[2 * n + 1] = (float)-n;
+    }
+    assert(ucra_ring_write(&ring, in, 6) == 6);
+    assert(ucra_ring_read(&ring, out, 4) == 4 && out[6] == 3.0f && out[7] == -3.0f);
+    assert(ucra_ring_write(&ring, in, 10) == 6); /* 2 left + 6 free */
+    assert(ucra_ring_readable(&ring) == 8 && ucra_ring_writable(&ring) == 0);
+
+    /* the read crosses the end of the storage */
+    assert(ucra_ring_read(&ring, out, 10) == 8);
+    assert(out[0] == 4.0f && out[2] == 5.0f);
+    for (int n = 0; n < 6; n++) {
+        assert(out[4 + 2 * n] == (float)n && out[5 + 2 * n] == (float)-n);
+    }
+    assert(ucra_ring_read(&ring, out, 1) == 0);
+    ucra_ring_free(&ring);
+
+    /* free-running indices keep working across 2^32 */
+    assert(ucra_ring_init(&ring, 4, 1) == UCRA_SUCCESS);
+    ring.write_index = ring.read_index = 0xFFFFFFFEu;
+    assert(ucra_ring_write(&ring, in, 4) == 4 && ucra_ring_readable(&ring) == 4);
+    assert(ucra_ring_read(&ring, out, 4) == 4 && out[0] == in[0] && out[3] == in[3]);
+    assert(ucra_ring_readable(&ring) == 0 && ucra_ring_writable(&ring) == 4);
+    ucra_ring_free(&ring);
+    printf("✓ Ring sizing and wraparound test passed\n");
+}
+
+static void test_read_regions() {
+    printf("Testing in-place reads...\n");
+    UCRA_Ring ring;
+    assert(ucra_ring_init(&ring, 8, 1) == UCRA_SUCCESS);
+    float in[8] = { 0, 1, 2, 3, 4, 5, 6, 7 }, out[8];
+    assert(ucra_ring_write(&ring, in, 6) == 6 && ucra_ring_read(&ring, out, 5) == 5);
+    assert(ucra_ring_write(&ring, in, 6) == 6); /* frames 5, 0..5 wrap the storage */
+
+    const float* first;
+    const float* second;
+    uint32_t first_frames, second_frames;
+    assert(ucra_ring_read_regions(&ring, 100, &first, &first_frames, &second, &second_frames) == 7);
+    assert(first_frames == 3 && second_frames == 4);
+    assert(first[0] == 5.0f && first[1] == 0.0f && second[0] == 2.0f && second[3] == 5.0f);
+
+    /* regions stay put until committed and keep the writer off them */
+    assert(ucra_ring_writable(&ring) == 1);
+    ucra_ring_commit_read(&ring, 2);
+    assert(ucra_ring_readable(&ring) == 5 && ucra_ring_writable(&ring) == 3);
+    assert(ucra_ring_read_regions(&ring, 2, &first, &first_frames, &second, &second_frames) == 2);
+    assert(first_frames == 1 && second_frames == 1 && first[0] == 1.0f && second[0] == 2.0f);
+    ucra_ring_free(&ring);
+    printf("✓ In-place read test passed\n");
+}
+
+static void test_inline() {
+    printf("Testing inline rings...\n");
+    UCRA_Ring ring;
+    assert(ucra_ring_init_inline(&ring, 6, 1) == UCRA_ERR_INVALID_ARGUMENT);
+    size_t size = ucra_ring_inline_size(8, 2);
+    assert(size == sizeof(UCRA_Ring) + 8 * 2 * sizeof(float));
+
+    /* the samples follow the struct, so a byte copy of the block is the same ring */
+    UCRA_Ring* original = malloc(size);
+    UCRA_Ring* copy = malloc(size);
+    assert(original && copy);
+    assert(ucra_ring_init_inline(original, 8, 2) == UCRA_SUCCESS);
+    assert(original->data == NULL && ucra_ring_writable(original) == 8);
+    float in[12] = { 0, -0.0f, 1, -1, 2, -2, 3, -3, 4, -4, 5, -5 }, out[16];
+    float junk[12];
+    assert(ucra_ring_write(original, in, 6) == 6 && ucra_ring_read(original, junk, 4) == 4);
+    assert(ucra_ring_write(original, in, 6) == 6); /* wraps the storage */
+    memcpy(copy, original, size);
+    memset(original, 0xff, size);
+    assert(ucra_ring_readable(copy) == 8);
+    assert(ucra_ring_read(copy, out, 8) == 8);
+    assert(out[0] == 4.0f && out[3] == -5.0f);
+    for (int n = 0; n < 6; n++) assert(out[4 + 2 * n] == (float)n);
+    free(original);
+    free(copy);
+    printf("✓ Inline ring test passed\n");
+}
+
+static void producer_main(void* arg) {
+    UCRA_Ring* ring = (UCRA_Ring*)arg;
+    float block[7];
+    uint32_t next = 0;
+    while (next < STRESS_FRAMES) {
+        uint32_t count = 0;
+        while (count < 7 && next + count < STRESS_FRAMES) {
+            block[count] = (float)(next + count);
+            count++;
+        }
+        uint32_t written = ucra_ring_write(ring, block, count);
+        if (written == 0) ucra_thread_yield();
+        next += written;
+    }
+}
+
+static void test_threads() {
+    printf("Testing ring across threads...\n");
+    UCRA_Ring ring;
+    assert(ucra_ring_init(&ring, 64, 1) == UCRA_SUCCESS);
+
+    UCRA_Thread producer;
+    assert(ucra_thread_create(&producer, producer_main, &ring) == 0);
+    float out[13];
+    uint32_t expected = 0;
+    while (expected < STRESS_FRAMES) {
+        uint32_t got = ucra_ring_read(&ring, out, 13);
+        if (got == 0) ucra_thread_yield();
+        for (uint32_t i = 0; i < got; i++) {
+            assert(out[i] == (float)expected);
+            expected++;
+        }
+    }
+    ucra_thread_join(producer);
+    assert(ucra_ring_readable(&ring) == 0);
+    ucra_ring_free(&ring);
+    printf("✓ Ring thread test passed\n");
+}
+
+int main() {
+    printf("=== UCRA Ring Tests ===\n");
+    test_sizing_and_wrap();
+    test_read_regions();
+    test_inline();
+    test_threads();
+    printf("All ring tests passed!\n");
+    return 0;
+}
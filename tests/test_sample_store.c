@@ -0,0 +1,203 @@
+/*
+ * Test for the UCRA sample store
+ * Checks that regions are decoded once and shared, clipping, the byte budget
+ * and views outliving eviction, that an edited file is read afresh, and many
+ * threads reading the same recordings at once
+ */
+
+#include "ucra/ucra.h"
+#include "ucra_sample_store.h"
+#include "ucra_threads.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#define RATE 8000
+#define FILES 3
+
+static const char* g_paths[FILES] = { "sample_store_a.wav", "sample_store_b.wav", "sample_store_c.wav" };
+
+/* Sample n of file k, exact in float32 */
+static float sample_value(int k, uint32_t n) {
+    return (float)((int)(n % 1000) - 500) / 1024.0f + (float)k / 8.0f;
+}
+
+static void write_wav(const char* path, int k, uint32_t frames) {
+    float* pcm = malloc(frames * sizeof(float));
+    assert(pcm != NULL);
+    for (uint32_t n = 0; n < frames; n++) pcm[n] = sample_value(k, n);
+    UCRA_WavWriterHandle writer = NULL;
+    assert(ucra_wav_writer_open(&writer, path, RATE, 1, UCRA_SAMPLE_FLOAT32, 0) == UCRA_SUCCESS);
+    assert(ucra_wav_writer_write(writer, pcm, frames) == UCRA_SUCCESS);
+    assert(ucra_wav_writer_close(writer) == UCRA_SUCCESS);
+    free(pcm);
+}
+
+static void check_view(const UCRA_SampleView* view, int k, uint32_t first, uint32_t frames) {
+    assert(view->frames == frames && view->sample_rate == RATE);
+    for (uint32_t n = 0; n < frames; n++) assert(view->samples[n] == sample_value(k, first + n));
+}
+
+static void test_shared_regions() {
+    printf("Testing shared regions...\n");
+    UCRA_SampleStoreStats before, after;
+    ucra_sample_store_stats(&before);
+
+    uint32_t frames = 0, rate = 0;
+    assert(ucra_sample_info(g_paths[0], &frames, &rate) == UCRA_SUCCESS);
+    assert(frames == 20000 && rate == RATE);
+
+    UCRA_SampleView a, b;
+    assert(ucra_sample_get(g_paths[0], 1000, 4000, &a) == UCRA_SUCCESS);
+    check_view(&a, 0, 1000, 4000);
+    assert(ucra_sample_get(g_paths[0], 1000, 4000, &b) == UCRA_SUCCESS);
+    assert(b.samples == a.samples); /* the same decoded copy */
+    ucra_sample_release(&a);
+    ucra_sample_release(&b);
+    assert(a.segment == NULL && b.samples == NULL);
+    ucra_sample_release(&a); /* released twice: ignored */
+
+    /* still cached once no view holds it */
+    assert(ucra_sample_get(g_paths[0], 1000, 4000, &a) == UCRA_SUCCESS);
+    check_view(&a, 0, 1000, 4000);
+    ucra_sample_release(&a);
+    ucra_sample_store_stats(&after);
+    assert(after.misses == before.misses + 1 && after.hits == before.hits + 2);
+
+    /* regions are clipped to the file */
+    assert(ucra_sample_get(g_paths[0], 19000, UCRA_SAMPLE_TO_END, &a) == UCRA_SUCCESS);
+    check_view(&a, 0, 19000, 1000);
+    ucra_sample_release(&a);
+    assert(ucra_sample_get(g_paths[0], 30000, 10, &a) == UCRA_SUCCESS);
+    assert(a.frames == 0 && a.samples == NULL && a.sample_rate == RATE);
+    ucra_sample_release(&a);
+
+    ucra_sample_prefetch(g_paths[1]);
+    ucra_sample_prefetch("sample_store_missing.wav");
+    assert(ucra_sample_get("sample_store_missing.wav", 0, 10, &a) == UCRA_ERR_FILE_NOT_FOUND);
+    assert(ucra_sample_get(NULL, 0, 10, &a) == UCRA_ERR_INVALID_ARGUMENT);
+    assert(ucra_sample_get(g_paths[0], 0, 10, NULL) == UCRA_ERR_INVALID_ARGUMENT);
+    assert(ucra_sample_info(g_paths[0], NULL, &rate) == UCRA_ERR_INVALID_ARGUMENT);
+    printf("✓ Shared regions test passed\n");
+}
+
+static void test_budget() {
+    printf("Testing the byte budget...\n");
+    ucra_sample_store_clear();
+    UCRA_SampleStoreStats stats;
+    ucra_sample_store_stats(&stats);
+    assert(stats.bytes == 0 && stats.files == 0);
+
+    /* room for two 1000-frame regions */
+    ucra_sample_store_set_budget(2 * 1000 * sizeof(float));
+    UCRA_SampleView view;
+    for (uint32_t r = 0; r < 3; r++) {
+        assert(ucra_sample_get(g_paths[1], r * 1000, 1000, &view) == UCRA_SUCCESS);
+        ucra_sample_release(&view);
+    }
+    ucra_sample_store_stats(&stats);
+    assert(stats.bytes == 2 * 1000 * sizeof(float));
+
+    /* the oldest went, the two newest stay */
+    UCRA_SampleStoreStats now;
+    assert(ucra_sample_get(g_paths[1], 2000, 1000, &view) == UCRA_SUCCESS);
+    ucra_sample_release(&view);
+    assert(ucra_sample_get(g_paths[1], 0, 1000, &view) == UCRA_SUCCESS);
+    ucra_sample_release(&view);
+    ucra_sample_store_stats(&now);
+    assert(now.hits == stats.hits + 1 && now.misses == stats.misses + 1);
+
+    /* a held view outlives eviction, and a region over the whole budget is only lent */
+    assert(ucra_sample_get(g_paths[1], 5000, 1000, &view) == UCRA_SUCCESS);
+    ucra_sample_store_set_budget(0);
+    ucra_sample_store_stats(&stats);
+    assert(stats.bytes == 1000 * sizeof(float));
+    check_view(&view, 1, 5000, 1000);
+    ucra_sample_release(&view);
+    ucra_sample_store_stats(&stats);
+    assert(stats.bytes == 0);
+    ucra_sample_store_set_budget(4000);
+    assert(ucra_sample_get(g_paths[1], 0, 5000, &view) == UCRA_SUCCESS);
+    check_view(&view, 1, 0, 5000);
+    ucra_sample_store_stats(&stats);
+    assert(stats.bytes == 0);
+    ucra_sample_release(&view);
+
+    ucra_sample_store_set_budget(UCRA_SAMPLE_STORE_DEFAULT_BYTES);
+    printf("✓ Byte budget test passed\n");
+}
+
+static void test_edited_file() {
+    printf("Testing an edited file...\n");
+    UCRA_SampleView old_view, new_view;
+    assert(ucra_sample_get(g_paths[2], 0, 3000, &old_view) == UCRA_SUCCESS);
+    check_view(&old_view, 2, 0, 3000);
+
+    /* another length, so the change shows whatever the file system's time resolution */
+    write_wav(g_paths[2], 0, 12000);
+    uint32_t frames = 0, rate = 0;
+    assert(ucra_sample_info(g_paths[2], &frames, &rate) == UCRA_SUCCESS && frames == 12000);
+    assert(ucra_sample_get(g_paths[2], 0, 3000, &new_view) == UCRA_SUCCESS);
+    check_view(&new_view, 0, 0, 3000);
+    check_view(&old_view, 2, 0, 3000); /* the old view keeps its copy */
+    ucra_sample_release(&old_view);
+    ucra_sample_release(&new_view);
+
+    write_wav(g_paths[2], 2, 20000);
+    printf("✓ Edited file test passed\n");
+}
+
+#define THREADS 8
+#define ROUNDS 300
+
+static void reader_thread(void* arg) {
+    uint32_t seed = (uint32_t)(uintptr_t)arg * 2654435761u + 1;
+    for (int i = 0; i < ROUNDS; i++) {
+        seed = seed * 1103515245u + 12345u;
+        int k = (int)((seed >> 16) % FILES);
+        uint32_t first = ((seed >> 8) % 8) * 2000;
+        UCRA_SampleView view;
+        assert(ucra_sample_get(g_paths[k], first, 1500, &view) == UCRA_SUCCESS);
+        check_view(&view, k, first, 1500);
+        ucra_sample_release(&view);
+    }
+}
+
+static void test_threads() {
+    printf("Testing concurrent readers...\n");
+    ucra_sample_store_clear();
+    /* a tight budget keeps eviction running while views are held */
+    ucra_sample_store_set_budget(6 * 1500 * sizeof(float));
+    UCRA_SampleStoreStats before, after;
+    ucra_sample_store_stats(&before);
+
+    UCRA_Thread threads[THREADS];
+    for (uintptr_t t = 0; t < THREADS; t++) {
+        assert(ucra_thread_create(&threads[t], reader_thread, (void*)t) == 0);
+    }
+    for (int t = 0; t < THREADS; t++) ucra_thread_join(threads[t]);
+
+    ucra_sample_store_stats(&after);
+    assert(after.hits + after.misses == before.hits + before.misses + THREADS * ROUNDS);
+    assert(after.bytes <= 6 * 1500 * sizeof(float));
+    ucra_sample_store_set_budget(UCRA_SAMPLE_STORE_DEFAULT_BYTES);
+    ucra_sample_store_clear();
+    ucra_sample_store_stats(&after);
+    assert(after.bytes == 0 && after.files == 0);
+    printf("✓ Concurrent readers test passed\n");
+}
+
+int main() {
+    printf("=== UCRA Sample Store Tests ===\n\n");
+    for (int k = 0; k < FILES; k++) write_wav(g_paths[k], k, 20000);
+
+    test_shared_regions();
+    test_budget();
+    test_edited_file();
+    test_threads();
+
+    for (int k = 0; k < FILES; k++) remove(g_paths[k]);
+    printf("\n=== All sample store tests passed! ===\n");
+    return 0;
+}
@@ -0,0 +1,109 @@
+/*
+ * Test for UCRA Streaming API - Allocation-Free Steady State
+ * Counts heap allocations made by ucra_stream_read once the stream is open,
+ * with both synchronous refill and render-ahead
+ */
+
+#include "ucra/ucra.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+
+#ifdef __GLIBC__
+/* The test binary's allocator wrappers take the place of libc's for the whole
+ * process, including the statically linked library */
+extern void* __libc_malloc(size_t size);
+extern void* __libc_calloc(size_t count, size_t size);
+extern void* __libc_realloc(void* ptr, size_t size);
+
+static volatile int counting = 0;
+static volatile unsigned long allocations = 0;
+
+void* malloc(size_t size) {
+    if (counting) allocations++;
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size) {
+    if (counting) allocations++;
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* ptr, size_t size) {
+    if (counting) allocations++;
+    return __libc_realloc(ptr, size);
+}
+
+static UCRA_NoteSegment test_notes[] = {
+    { 0.0, 2.0, 69, 100, "a", NULL, NULL },
+    { 0.5, 1.0, 76, 80, "e", NULL, NULL }
+};
+
+static UCRA_Result pull_notes(void* user_data, UCRA_RenderConfig* out_config) {
+    (void)user_data;
+    out_config->notes = test_notes;
+    out_config->note_count = 2;
+    return UCRA_SUCCESS;
+}
+
+static void run_reads(const UCRA_KeyValue* options, uint32_t option_count, const char* label) {
+    printf("Testing allocation-free reads (%s)...\n", label);
+
+    UCRA_RenderConfig config = {
+        .sample_rate = 44100,
+        .channels = 2,
+        .block_size = 256,
+        .flags = 0,
+        .notes = NULL,
+        .note_count = 0,
+        .options = options,
+        .option_count = option_count
+    };
+
+    UCRA_StreamHandle stream = NULL;
+    UCRA_Result result = ucra_stream_open(&stream, &config, pull_notes, NULL);
+    assert(result == UCRA_SUCCESS);
+
+    /* odd read sizes make refills and copies cross the ring's wrap point; every
+     * other block is borrowed in place instead of copied */
+    float buffer[333 * 2];
+    uint64_t total = 0;
+    allocations = 0;
+    counting = 1;
+    for (int i = 0; i < 2000 && total < 44100 * 2; i++) {
+        uint32_t frames_read = 0;
+        if (i % 2) {
+            const float* first;
+            const float* second;
+            uint32_t first_frames, second_frames;
+            result = ucra_stream_acquire(stream, 333, &first, &first_frames, &second, &second_frames);
+            assert(result == UCRA_SUCCESS);
+            frames_read = first_frames + second_frames;
+            assert(ucra_stream_release(stream, frames_read) == UCRA_SUCCESS);
+        } else {
+            result = ucra_stream_read(stream, buffer, 333, &frames_read);
+            assert(result == UCRA_SUCCESS);
+        }
+        total += frames_read;
+    }
+    counting = 0;
+    assert(allocations == 0);
+
+    ucra_stream_close(stream);
+    printf("✓ Allocation-free reads (%s) test passed\n", label);
+}
+#endif
+
+int main() {
+    printf("=== UCRA Streaming API Allocation Tests ===\n\n");
+#ifdef __GLIBC__
+    run_reads(NULL, 0, "synchronous refill");
+
+    UCRA_KeyValue render_ahead[] = { { "stream_render_ahead", "1" } };
+    run_reads(render_ahead, 1, "render-ahead");
+#else
+    printf("Skipped: allocation counting needs glibc\n");
+#endif
+    printf("\n=== All streaming allocation tests passed! ===\n");
+    return 0;
+}
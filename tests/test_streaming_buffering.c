@@ -4,6 +4,7 @@
  */
 
 #include "ucra/ucra.h"
+#include "ucra_threads.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -233,6 +234,134 @@ static void test_multiple_reads() {
     printf("✓ Multiple read operations test passed\n");
 }
 
+/* Test the render-ahead producer thread and the buffering options */
+static void test_render_ahead() {
+    printf("Testing render-ahead producer...\n");
+
+    UCRA_KeyValue options[] = {
+        { "stream_render_ahead", "1" },
+        { "stream_buffer_frames", "2048" },
+        { "stream_prefill_frames", "0" },
+        { "stream_low_watermark", "1024" },
+        { "stream_high_watermark", "2048" }
+    };
+    UCRA_RenderConfig config = {
+        .sample_rate = 44100,
+        .channels = 2,
+        .block_size = 256,
+        .flags = 0,
+        .notes = NULL,
+        .note_count = 0,
+        .options = options,
+        .option_count = 5
+    };
+
+    TestCallbackData test_data = {
+        .call_count = 0,
+        .notes = NULL,
+        .note_count = 0,
+        .should_fail = 0
+    };
+
+    /* the producer fills the ring without any read; the reader only ever copies */
+    UCRA_StreamHandle stream = NULL;
+    UCRA_Result result = ucra_stream_open(&stream, &config, test_pull_pcm_silence, &test_data);
+    assert(result == UCRA_SUCCESS);
+
+    float buffer[300 * 2];
+    uint32_t total = 0;
+    for (int attempt = 0; attempt < 20000 && total < 44100; attempt++) {
+        uint32_t frames_read = 0;
+        result = ucra_stream_read(stream, buffer, 300, &frames_read);
+        assert(result == UCRA_SUCCESS);
+        assert(frames_read <= 300);
+        total += frames_read;
+        if (frames_read < 300) {
+            ucra_sleep_us(1000); /* underrun: give the producer time */
+        }
+    }
+    assert(total >= 44100);
+    ucra_stream_close(stream);
+    assert(test_data.call_count > 0);
+
+    /* once the callback ends the stream, reads drain the ring and then report its status */
+    test_data.should_fail = 1;
+    test_data.call_count = 0;
+    result = ucra_stream_open(&stream, &config, test_pull_pcm_with_notes, &test_data);
+    assert(result == UCRA_SUCCESS);
+    result = UCRA_SUCCESS;
+    for (int attempt = 0; attempt < 1000 && result == UCRA_SUCCESS; attempt++) {
+        uint32_t frames_read = 0;
+        result = ucra_stream_read(stream, buffer, 300, &frames_read);
+        if (result == UCRA_SUCCESS) {
+            ucra_sleep_us(1000);
+        } else {
+            assert(frames_read == 0);
+        }
+    }
+    assert(result == UCRA_ERR_INTERNAL);
+    ucra_stream_close(stream);
+
+    printf("✓ Render-ahead producer test passed\n");
+}
+
+/* Test the stream performance counters */
+static void test_stream_stats() {
+    printf("Testing stream statistics...\n");
+
+    UCRA_NoteSegment notes[1] = { { 0.0, 5.0, 69, 100, "a", NULL, NULL } };
+    TestCallbackData test_data = { 0, notes, 1, 0 };
+    UCRA_RenderConfig config = {
+        .sample_rate = 44100,
+        .channels = 2,
+        .block_size = 256,
+        .flags = 0,
+        .notes = NULL,
+        .note_count = 0,
+        .options = NULL,
+        .option_count = 0
+    };
+
+    UCRA_StreamHandle stream = NULL;
+    assert(ucra_stream_open(&stream, &config, test_pull_pcm_with_notes, &test_data) == UCRA_SUCCESS);
+
+    UCRA_StreamStats stats;
+    assert(ucra_stream_get_stats(stream, &stats) == UCRA_SUCCESS);
+    assert(stats.reads == 0 && stats.fill_min == 0 && stats.fill_max == 0);
+    assert(stats.frames_produced > 0 && stats.callback_count == (uint64_t)test_data.call_count);
+
+    float buffer[1000 * 2];
+    uint64_t total_read = 0;
+    for (int i = 0; i < 50; i++) {
+        uint32_t frames_read = 0;
+        assert(ucra_stream_read(stream, buffer, 1000, &frames_read) == UCRA_SUCCESS);
+        total_read += frames_read;
+    }
+
+    assert(ucra_stream_get_stats(stream, &stats) == UCRA_SUCCESS);
+    assert(stats.reads == 50 && stats.underruns == 0);
+    assert(stats.frames_produced >= total_read);
+    assert(stats.blocks_rendered * 256 == stats.frames_produced);
+    assert(stats.callback_count == (uint64_t)test_data.call_count);
+    assert(stats.fill_min <= stats.fill_max && stats.fill_max <= 4096);
+    assert(stats.render_ns_min <= stats.render_ns_avg && stats.render_ns_avg <= stats.render_ns_max);
+    assert(stats.render_ns_min <= stats.render_ns_p99 && stats.render_ns_p99 <= stats.render_ns_max);
+
+    /* once the callback fails, the drained ring shows up as underruns */
+    test_data.should_fail = 1;
+    for (int i = 0; i < 10; i++) {
+        uint32_t frames_read = 0;
+        (void)ucra_stream_read(stream, buffer, 1000, &frames_read);
+    }
+    assert(ucra_stream_get_stats(stream, &stats) == UCRA_SUCCESS);
+    assert(stats.reads == 60 && stats.underruns > 0 && stats.fill_min < 1000);
+
+    assert(ucra_stream_get_stats(NULL, &stats) == UCRA_ERR_INVALID_ARGUMENT);
+    assert(ucra_stream_get_stats(stream, NULL) == UCRA_ERR_INVALID_ARGUMENT);
+    ucra_stream_close(stream);
+    printf("✓ Stream statistics test passed\n");
+}
+
 int main() {
     printf("=== UCRA Streaming API Buffering Tests ===\n\n");
 
@@ -240,6 +369,8 @@ int main() {
     test_buffering_with_notes();
     test_callback_error_handling();
     test_multiple_reads();
+    test_render_ahead();
+    test_stream_stats();
 
     printf("\n=== All buffering tests passed! ===\n");
     return 0;
@@ -302,6 +302,268 @@ static void test_zero_frame_read() {
     printf("✓ Zero-frame read test passed\n");
 }
 
+/* Callback that provides its notes once and then reports them unchanged */
+static UCRA_Result unchanged_pull_pcm(void* user_data, UCRA_RenderConfig* out_config) {
+    TestReadCallbackData* test_data = (TestReadCallbackData*)user_data;
+    if (test_data->call_count++ > 0) {
+        out_config->notes = NULL; /* ignored with UCRA_STREAM_UNCHANGED */
+        out_config->note_count = 0;
+        return UCRA_STREAM_UNCHANGED;
+    }
+    out_config->notes = test_data->notes;
+    out_config->note_count = test_data->note_count;
+    return UCRA_SUCCESS;
+}
+
+/* Mock callback that re-sends its notes flagged as edited in place */
+static UCRA_Result edited_pull_pcm(void* user_data, UCRA_RenderConfig* out_config) {
+    UCRA_Result result = test_read_pull_pcm(user_data, out_config);
+    out_config->flags |= UCRA_RENDER_NOTES_EDITED;
+    return result;
+}
+
+/* Test that an unchanged callback keeps rendering the previous configuration */
+static void test_unchanged_callback() {
+    printf("Testing unchanged pull callback...\n");
+
+    UCRA_RenderConfig config = {
+        .sample_rate = 44100,
+        .channels = 2,
+        .block_size = 256,
+        .flags = 0,
+        .notes = NULL,
+        .note_count = 0,
+        .options = NULL,
+        .option_count = 0
+    };
+    UCRA_NoteSegment notes[2] = {
+        { 0.0, 1.0, 60, 100, "a", NULL, NULL },
+        { 0.05, 1.0, 67, 100, "i", NULL, NULL }
+    };
+    TestReadCallbackData full = { 0, notes, 2, 0 };
+    TestReadCallbackData once = { 0, notes, 2, 0 };
+
+    UCRA_StreamHandle expected_stream = NULL, stream = NULL;
+    assert(ucra_stream_open(&expected_stream, &config, test_read_pull_pcm, &full) == UCRA_SUCCESS);
+    assert(ucra_stream_open(&stream, &config, unchanged_pull_pcm, &once) == UCRA_SUCCESS);
+
+    float expected[1024 * 2], buffer[1024 * 2];
+    for (int i = 0; i < 20; i++) {
+        uint32_t expected_read = 0, frames_read = 0;
+        assert(ucra_stream_read(expected_stream, expected, 1024, &expected_read) == UCRA_SUCCESS);
+        assert(ucra_stream_read(stream, buffer, 1024, &frames_read) == UCRA_SUCCESS);
+        assert(frames_read == expected_read);
+        assert(memcmp(buffer, expected, frames_read * 2 * sizeof(float)) == 0);
+    }
+    assert(once.call_count > 1);
+
+    ucra_stream_close(expected_stream);
+    ucra_stream_close(stream);
+    printf("✓ Unchanged pull callback test passed\n");
+}
+
+/* Test that acquired regions carry the frames a read would copy */
+static void test_acquire_release() {
+    printf("Testing in-place acquire/release...\n");
+
+    UCRA_RenderConfig config = {
+        .sample_rate = 44100,
+        .channels = 2,
+        .block_size = 256,
+        .flags = 0,
+        .notes = NULL,
+        .note_count = 0,
+        .options = NULL,
+        .option_count = 0
+    };
+    UCRA_NoteSegment notes[1] = { { 0.0, 2.0, 64, 100, "a", NULL, NULL } };
+    TestReadCallbackData copy_data = { 0, notes, 1, 0 };
+    TestReadCallbackData borrow_data = { 0, notes, 1, 0 };
+
+    UCRA_StreamHandle copied = NULL, borrowed = NULL;
+    assert(ucra_stream_open(&copied, &config, test_read_pull_pcm, &copy_data) == UCRA_SUCCESS);
+    assert(ucra_stream_open(&borrowed, &config, test_read_pull_pcm, &borrow_data) == UCRA_SUCCESS);
+
+    const float* first;
+    const float* second;
+    uint32_t first_frames, second_frames;
+    int wrapped = 0;
+    float expected[700 * 2];
+    for (int i = 0; i < 60; i++) {
+        assert(ucra_stream_acquire(borrowed, 700, &first, &first_frames, &second, &second_frames) == UCRA_SUCCESS);
+        uint32_t frames = first_frames + second_frames;
+        assert(frames > 0 && frames <= 700);
+        assert((second == NULL) == (second_frames == 0));
+        wrapped |= second_frames > 0;
+
+        /* release part of the block; the rest comes back first on the next acquire */
+        uint32_t used = i % 3 == 0 ? frames / 2 : frames;
+        uint32_t expected_read = 0;
+        assert(ucra_stream_read(copied, expected, used, &expected_read) == UCRA_SUCCESS);
+        assert(expected_read == used);
+        uint32_t head = used < first_frames ? used : first_frames;
+        assert(memcmp(first, expected, head * 2 * sizeof(float)) == 0);
+        if (used > head) {
+            assert(memcmp(second, expected + head * 2, (used - head) * 2 * sizeof(float)) == 0);
+        }
+
+        assert(ucra_stream_release(borrowed, frames + 1) == UCRA_ERR_INVALID_ARGUMENT);
+        assert(ucra_stream_release(borrowed, used) == UCRA_SUCCESS);
+    }
+    assert(wrapped);
+
+    ucra_stream_close(copied);
+    ucra_stream_close(borrowed);
+    printf("✓ In-place acquire/release test passed\n");
+}
+
+/* Test that a long, unsorted song renders every note at its own frames */
+#define SONG_NOTES 1500
+#define SONG_FRAMES 88200
+
+static void test_note_index() {
+    printf("Testing note lookup over a long unsorted song...\n");
+
+    UCRA_RenderConfig config = {
+        .sample_rate = 44100,
+        .channels = 1,
+        .block_size = 256,
+        .flags = 0,
+        .notes = NULL,
+        .note_count = 0,
+        .options = NULL,
+        .option_count = 0
+    };
+
+    /* notes every 10 ms at off-frame times, a few held for a long time, in shuffled order */
+    static UCRA_NoteSegment notes[SONG_NOTES];
+    for (uint32_t i = 0; i < SONG_NOTES; i++) {
+        double duration = i % 97 == 0 ? 1.5 : 0.0137 + (i % 5) * 0.004;
+        UCRA_NoteSegment note = { i * 0.01 + 0.00123, duration, (int16_t)(48 + i % 24), 100, "a", NULL, NULL };
+        notes[i] = note;
+    }
+    uint32_t seed = 12345;
+    for (uint32_t i = SONG_NOTES - 1; i > 0; i--) {
+        seed = seed * 1103515245u + 12345u;
+        uint32_t j = (seed >> 8) % (i + 1);
+        UCRA_NoteSegment tmp = notes[i];
+        notes[i] = notes[j];
+        notes[j] = tmp;
+    }
+
+    static float expected[SONG_FRAMES], buffer[SONG_FRAMES];
+    memset(expected, 0, sizeof(expected));
+#ifndef UCRA_HAS_WORLD
+    for (uint32_t i = 0; i < SONG_NOTES; i++) {
+        int64_t start = (int64_t)floor(notes[i].start_sec * 44100 + 0.5);
+        int64_t end = (int64_t)floor((notes[i].start_sec + notes[i].duration_sec) * 44100 + 0.5);
+        double inc = 2.0 * M_PI * 440.0 * pow(2.0, (notes[i].midi_note - 69) / 12.0) / 44100;
+        for (int64_t n = start; n < end && n < SONG_FRAMES; n++) {
+            expected[n] += (float)(0.1 * (100 / 127.0 * 0.3) * sin(inc * (double)(n - start)));
+        }
+    }
+#endif
+
+    /* a callback that re-sends the notes, one that reports them unchanged (both indexed once)
+     * and one that flags them edited, re-indexed and sought to the position on every refill */
+    UCRA_PullPCM callbacks[3] = { test_read_pull_pcm, unchanged_pull_pcm, edited_pull_pcm };
+    for (int pass = 0; pass < 3; pass++) {
+        TestReadCallbackData data = { 0, notes, SONG_NOTES, 0 };
+        UCRA_StreamHandle stream = NULL;
+        assert(ucra_stream_open(&stream, &config, callbacks[pass], &data) == UCRA_SUCCESS);
+        uint32_t total = 0;
+        while (total < SONG_FRAMES) {
+            uint32_t frames_read = 0;
+            assert(ucra_stream_read(stream, buffer + total, SONG_FRAMES - total, &frames_read) == UCRA_SUCCESS);
+            assert(frames_read > 0);
+            total += frames_read;
+        }
+        ucra_stream_close(stream);
+#ifdef UCRA_HAS_WORLD
+        /* WORLD synthesizes the stream, so each callback must give what the first one did */
+        if (pass == 0) memcpy(expected, buffer, sizeof(buffer));
+#endif
+
+        float max_err = 0.0f;
+        for (uint32_t n = 0; n < SONG_FRAMES; n++) {
+            max_err = fmaxf(max_err, fabsf(buffer[n] - expected[n]));
+        }
+        assert(max_err < 1e-5f);
+    }
+
+#ifndef UCRA_HAS_WORLD
+    /* nothing sounds before the first note's exact frame */
+    assert(floor(0.00123 * 44100 + 0.5) == 54);
+    for (uint32_t n = 0; n < 54; n++) {
+        assert(buffer[n] == 0.0f);
+    }
+    assert(buffer[55] != 0.0f);
+#endif
+    printf("✓ Note lookup test passed\n");
+}
+
+/* Read frame_count frames of stream into out, editing notes in place once edit_at frames are read */
+static void read_editing(UCRA_StreamHandle stream, float* out, uint32_t frame_count,
+                         UCRA_NoteSegment* notes, uint32_t edit_at) {
+    uint32_t total = 0;
+    while (total < frame_count) {
+        if (notes && total >= edit_at) {
+            /* swap the notes' times: the first now starts after the second */
+            double start = notes[0].start_sec;
+            notes[0].start_sec = notes[1].start_sec;
+            notes[1].start_sec = start;
+            notes = NULL;
+        }
+        uint32_t want = frame_count - total < 512 ? frame_count - total : 512;
+        uint32_t frames_read = 0;
+        assert(ucra_stream_read(stream, out + total, want, &frames_read) == UCRA_SUCCESS);
+        assert(frames_read > 0);
+        total += frames_read;
+    }
+}
+
+/* Test that notes moved in place, flagged as edited, play at their new times */
+#define EDIT_FRAMES 110250
+
+static void test_edited_notes() {
+    printf("Testing notes edited in place...\n");
+
+    UCRA_RenderConfig config = {
+        .sample_rate = 44100,
+        .channels = 1,
+        .block_size = 256,
+        .flags = 0,
+        .notes = NULL,
+        .note_count = 0,
+        .options = NULL,
+        .option_count = 0
+    };
+    UCRA_NoteSegment notes[2] = {
+        { 1.0, 0.5, 60, 100, "a", NULL, NULL },
+        { 2.0, 0.5, 67, 100, "i", NULL, NULL },
+    };
+    UCRA_NoteSegment moved[2] = { notes[0], notes[1] };
+    moved[0].start_sec = 2.0;
+    moved[1].start_sec = 1.0;
+
+    static float edited[EDIT_FRAMES], expected[EDIT_FRAMES];
+    /* the same array and count on every pull, edited half a second in, well before either note */
+    TestReadCallbackData data = { 0, notes, 2, 0 };
+    UCRA_StreamHandle stream = NULL;
+    assert(ucra_stream_open(&stream, &config, edited_pull_pcm, &data) == UCRA_SUCCESS);
+    read_editing(stream, edited, EDIT_FRAMES, notes, 22050);
+    ucra_stream_close(stream);
+
+    TestReadCallbackData fresh = { 0, moved, 2, 0 };
+    assert(ucra_stream_open(&stream, &config, test_read_pull_pcm, &fresh) == UCRA_SUCCESS);
+    read_editing(stream, expected, EDIT_FRAMES, NULL, 0);
+    ucra_stream_close(stream);
+
+    assert(memcmp(edited, expected, sizeof(edited)) == 0);
+    assert(edited[44100 + 100] != 0.0f); /* the second note now sounds from one second */
+    printf("✓ Edited notes test passed\n");
+}
+
 int main() {
     printf("=== UCRA Streaming API Read Function Tests ===\n\n");
 
@@ -311,6 +573,10 @@ int main() {
     test_read_from_closed_stream();
     test_continuous_reading();
     test_zero_frame_read();
+    test_unchanged_callback();
+    test_acquire_release();
+    test_note_index();
+    test_edited_notes();
 
     printf("\n=== All read function tests passed! ===\n");
     return 0;
@@ -212,6 +212,51 @@ static int test_null_arguments() {
     return 1;
 }
 
+/* Write a minimal manifest named name */
+static int write_manifest(const char* path, const char* name) {
+    FILE* file = fopen(path, "w");
+    if (!file) return 0;
+    fprintf(file,
+            "{ \"name\": \"%s\", \"version\": \"1.0\", \"entry\": { \"type\": \"cli\", \"path\": \"./r\" },\n"
+            "  \"audio\": { \"rates\": [44100], \"channels\": [1] } }\n", name);
+    fclose(file);
+    return 1;
+}
+
+/* Test that the registry shares one parse per file version */
+static int test_manifest_registry() {
+    const char* path = "registry_manifest.json";
+    if (!write_manifest(path, "first")) return 0;
+
+    const UCRA_Manifest* a = NULL;
+    const UCRA_Manifest* b = NULL;
+    const UCRA_Manifest* c = NULL;
+    int ok = ucra_manifest_acquire(path, &a) == UCRA_SUCCESS &&
+             ucra_manifest_acquire("./registry_manifest.json", &b) == UCRA_SUCCESS &&
+             a == b && strcmp(a->name, "first") == 0;
+
+    /* a changed file is parsed again, while holders keep the version they have */
+    ok = ok && write_manifest(path, "second version");
+    ok = ok && ucra_manifest_acquire(path, &c) == UCRA_SUCCESS &&
+         c != a && strcmp(c->name, "second version") == 0 && strcmp(a->name, "first") == 0;
+    ucra_manifest_release(a);
+    ucra_manifest_release(b);
+
+    /* clearing drops the registry's copy but not the caller's */
+    ucra_manifest_registry_clear();
+    ok = ok && strcmp(c->name, "second version") == 0;
+    ucra_manifest_release(c);
+
+    const UCRA_Manifest* missing = NULL;
+    ok = ok && ucra_manifest_acquire("non_existent.json", &missing) == UCRA_ERR_FILE_NOT_FOUND && !missing;
+    ok = ok && ucra_manifest_acquire("data/broken_manifest.json", &missing) == UCRA_ERR_INVALID_JSON;
+    ok = ok && ucra_manifest_acquire(NULL, &missing) == UCRA_ERR_INVALID_ARGUMENT;
+    ucra_manifest_release(NULL);
+
+    remove(path);
+    return ok;
+}
+
 int main(int argc, char* argv[]) {
     printf("UCRA Manifest Parser Test Suite\n");
     printf("===============================\n\n");
@@ -225,6 +270,7 @@ int main(int argc, char* argv[]) {
     TEST(invalid_sample_rate);
     TEST(enum_no_values);
     TEST(null_arguments);
+    TEST(manifest_registry);
 
     printf("\n===============================\n");
     printf("Test Results: %d/%d passed\n", passed_count, test_count);
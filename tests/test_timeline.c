@@ -0,0 +1,207 @@
+/*
+ * Test for the UCRA timeline
+ * Checks note placement with preutterance, the crossfade over the overlap,
+ * envelope points, that a stream gives the same audio as a buffer, and the
+ * rejected calls
+ */
+
+#include "ucra/ucra.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <math.h>
+
+/* 1 kHz, so one frame is one millisecond */
+#define RATE 1000
+
+static int close_to(float a, float b) {
+    return fabsf(a - b) < 1e-5f;
+}
+
+static void fill(float* pcm, uint32_t frames, float value) {
+    for (uint32_t i = 0; i < frames; i++) pcm[i] = value;
+}
+
+static void test_placement_and_crossfade() {
+    printf("Testing placement and crossfade...\n");
+    float a[100], b[100], out[300];
+    fill(a, 100, 1.0f);
+    fill(b, 100, 2.0f);
+
+    UCRA_TimelineHandle timeline = NULL;
+    out[299] = 5.0f;
+    assert(ucra_timeline_create_buffer(&timeline, RATE, 1, out, 300) == UCRA_SUCCESS);
+    assert(out[299] == 0.0f); /* cleared */
+
+    /* a at 0; b's downbeat at 80 ms with a 20 ms preutterance, so it begins at 60, fading in over 20 */
+    UCRA_TimelineNote note = { a, 100, 0.0, 0.0, 0.0, NULL };
+    assert(ucra_timeline_add(timeline, &note) == UCRA_SUCCESS);
+    UCRA_TimelineNote next = { b, 100, 0.080, 0.020, 0.020, NULL };
+    assert(ucra_timeline_add(timeline, &next) == UCRA_SUCCESS);
+    uint64_t frames = 0;
+    assert(ucra_timeline_finish(timeline, &frames) == UCRA_SUCCESS);
+    assert(frames == 160);
+
+    for (int i = 0; i < 60; i++) assert(out[i] == 1.0f);
+    for (int i = 60; i < 80; i++) {
+        float fade = (i - 60) / 20.0f;
+        assert(close_to(out[i], 1.0f - fade + 2.0f * fade));
+    }
+    /* after the overlap b replaces the rest of a */
+    for (int i = 80; i < 160; i++) assert(out[i] == 2.0f);
+    for (int i = 160; i < 300; i++) assert(out[i] == 0.0f);
+    assert(ucra_timeline_add(timeline, &note) == UCRA_ERR_INVALID_ARGUMENT); /* finished */
+    ucra_timeline_destroy(timeline);
+    printf("✓ Placement and crossfade test passed\n");
+}
+
+static void test_envelope_and_clipping() {
+    printf("Testing envelope points and the buffer's ends...\n");
+    float pcm[200], out[150];
+    for (int i = 0; i < 100; i++) {
+        pcm[2 * i] = 1.0f;
+        pcm[2 * i + 1] = -1.0f;
+    }
+    /* silent until 10 ms, up to full at 20, down to half at 90 and held after */
+    float env_time[3] = { 0.010f, 0.020f, 0.090f };
+    float env_value[3] = { 0.0f, 1.0f, 0.5f };
+    UCRA_EnvCurve env = { env_time, env_value, 3 };
+
+    UCRA_TimelineHandle timeline = NULL;
+    assert(ucra_timeline_create_buffer(&timeline, RATE, 2, out, 75) == UCRA_SUCCESS);
+    /* starts 10 ms before 0, so the first 10 frames are dropped; ends past the buffer */
+    UCRA_TimelineNote note = { pcm, 100, 0.0, 0.010, 0.0, &env };
+    assert(ucra_timeline_add(timeline, &note) == UCRA_SUCCESS);
+    uint64_t frames = 0;
+    assert(ucra_timeline_finish(timeline, &frames) == UCRA_SUCCESS && frames == 75);
+    for (int i = 0; i < 75; i++) {
+        int t = i + 10; /* ms from the note's start */
+        float gain = t <= 20 ? (t - 10) / 10.0f : 1.0f - 0.5f * (t - 20) / 70.0f;
+        assert(close_to(out[2 * i], gain) && close_to(out[2 * i + 1], -gain));
+    }
+    ucra_timeline_destroy(timeline);
+    printf("✓ Envelope test passed\n");
+}
+
+typedef struct Collected {
+    float* pcm;
+    uint64_t frames;
+    uint64_t capacity;
+    uint32_t calls;
+    uint32_t fail_after; /* 0 for never */
+} Collected;
+
+static UCRA_Result UCRA_CALL collect(void* user_data, const float* pcm, uint32_t frames) {
+    Collected* collected = (Collected*)user_data;
+    if (collected->fail_after && collected->calls >= collected->fail_after) {
+        return UCRA_ERR_INTERNAL;
+    }
+    collected->calls++;
+    assert(frames > 0 && collected->frames + frames <= collected->capacity);
+    memcpy(collected->pcm + collected->frames * 2, pcm, (size_t)frames * 2 * sizeof(float));
+    collected->frames += frames;
+    return UCRA_SUCCESS;
+}
+
+static void test_stream_matches_buffer() {
+    printf("Testing that a stream matches a buffer...\n");
+    enum { NOTES = 40, CAPACITY = 1 << 17 };
+    static float pcm[NOTES][2 * 3000];
+    static float buffer[2 * CAPACITY], streamed[2 * CAPACITY];
+    UCRA_TimelineNote notes[NOTES];
+    float env_time[2] = { 0.0f, 0.5f };
+    float env_value[2] = { 0.2f, 1.0f };
+    UCRA_EnvCurve env = { env_time, env_value, 2 };
+
+    srand(99);
+    double start = 0.0;
+    for (int n = 0; n < NOTES; n++) {
+        uint64_t frames = 500 + (uint64_t)(rand() % 2500);
+        for (uint64_t i = 0; i < frames * 2; i++) pcm[n][i] = (float)sin(n + i * 0.01);
+        double preutter = (rand() % 100) / 1000.0;
+        double overlap = (rand() % 2) ? preutter : 0.0;
+        /* sometimes a rest, and the first note begins before 0 */
+        UCRA_TimelineNote note = { pcm[n], frames, start, n == 0 ? 0.030 : preutter, overlap,
+                                   n % 3 == 0 ? &env : NULL };
+        notes[n] = note;
+        start += (frames - 100) / (double)RATE + (n % 7 == 0 ? 0.4 : 0.0);
+    }
+
+    UCRA_TimelineHandle timeline = NULL;
+    assert(ucra_timeline_create_buffer(&timeline, RATE, 2, buffer, CAPACITY) == UCRA_SUCCESS);
+    for (int n = 0; n < NOTES; n++) assert(ucra_timeline_add(timeline, &notes[n]) == UCRA_SUCCESS);
+    uint64_t buffer_frames = 0;
+    assert(ucra_timeline_finish(timeline, &buffer_frames) == UCRA_SUCCESS);
+    ucra_timeline_destroy(timeline);
+
+    Collected collected = { streamed, 0, CAPACITY, 0, 0 };
+    assert(ucra_timeline_create_stream(&timeline, RATE, 2, collect, &collected) == UCRA_SUCCESS);
+    for (int n = 0; n < NOTES; n++) assert(ucra_timeline_add(timeline, &notes[n]) == UCRA_SUCCESS);
+    uint64_t stream_frames = 0;
+    assert(ucra_timeline_finish(timeline, &stream_frames) == UCRA_SUCCESS);
+    assert(ucra_timeline_finish(timeline, NULL) == UCRA_SUCCESS); /* nothing more to hand on */
+    ucra_timeline_destroy(timeline);
+
+    assert(buffer_frames == stream_frames && collected.frames == stream_frames);
+    assert(collected.calls > NOTES / 2); /* handed on as it went, not at the end */
+    assert(memcmp(buffer, streamed, (size_t)stream_frames * 2 * sizeof(float)) == 0);
+    printf("✓ Stream test passed\n");
+}
+
+static void test_invalid_calls() {
+    printf("Testing invalid timeline calls...\n");
+    float pcm[64] = {0}, out[64];
+    UCRA_TimelineHandle timeline = NULL;
+    assert(ucra_timeline_create_buffer(NULL, RATE, 1, out, 64) == UCRA_ERR_INVALID_ARGUMENT);
+    assert(ucra_timeline_create_buffer(&timeline, 0, 1, out, 64) == UCRA_ERR_INVALID_ARGUMENT);
+    assert(ucra_timeline_create_buffer(&timeline, RATE, 0, out, 64) == UCRA_ERR_INVALID_ARGUMENT);
+    assert(ucra_timeline_create_buffer(&timeline, RATE, 1, NULL, 64) == UCRA_ERR_INVALID_ARGUMENT);
+    assert(ucra_timeline_create_stream(&timeline, RATE, 1, NULL, NULL) == UCRA_ERR_INVALID_ARGUMENT);
+    assert(timeline == NULL);
+
+    assert(ucra_timeline_create_buffer(&timeline, RATE, 1, out, 64) == UCRA_SUCCESS);
+    UCRA_TimelineNote note = { pcm, 64, 0.020, 0.0, 0.0, NULL };
+    assert(ucra_timeline_add(timeline, NULL) == UCRA_ERR_INVALID_ARGUMENT);
+    assert(ucra_timeline_add(NULL, &note) == UCRA_ERR_INVALID_ARGUMENT);
+    assert(ucra_timeline_add(timeline, &note) == UCRA_SUCCESS);
+    note.start_sec = 0.030;
+    note.preutter_sec = 0.020; /* begins before the previous note */
+    assert(ucra_timeline_add(timeline, &note) == UCRA_ERR_INVALID_ARGUMENT);
+    note.preutter_sec = 0.0;
+    note.overlap_sec = -1.0;
+    assert(ucra_timeline_add(timeline, &note) == UCRA_ERR_INVALID_ARGUMENT);
+    note.overlap_sec = NAN;
+    assert(ucra_timeline_add(timeline, &note) == UCRA_ERR_INVALID_ARGUMENT);
+    note.overlap_sec = 0.0;
+    note.pcm = NULL;
+    assert(ucra_timeline_add(timeline, &note) == UCRA_ERR_INVALID_ARGUMENT);
+    ucra_timeline_destroy(timeline);
+
+    /* a sink's failure sticks */
+    static float sink_pcm[2 * 4096];
+    Collected collected = { sink_pcm, 0, 4096, 0, 2 };
+    assert(ucra_timeline_create_stream(&timeline, RATE, 2, collect, &collected) == UCRA_SUCCESS);
+    float stereo[128] = {0};
+    UCRA_TimelineNote first = { stereo, 64, 0.0, 0.0, 0.0, NULL };
+    UCRA_TimelineNote second = { stereo, 64, 0.1, 0.0, 0.0, NULL };
+    UCRA_TimelineNote third = { stereo, 64, 0.2, 0.0, 0.0, NULL };
+    assert(ucra_timeline_add(timeline, &first) == UCRA_SUCCESS);
+    assert(ucra_timeline_add(timeline, &second) == UCRA_SUCCESS); /* hands on the first note and the rest after it */
+    assert(ucra_timeline_add(timeline, &third) == UCRA_ERR_INTERNAL);
+    assert(ucra_timeline_finish(timeline, NULL) == UCRA_ERR_INTERNAL);
+    ucra_timeline_destroy(timeline);
+    assert(ucra_timeline_finish(NULL, NULL) == UCRA_ERR_INVALID_ARGUMENT);
+    ucra_timeline_destroy(NULL);
+    printf("✓ Invalid call test passed\n");
+}
+
+int main() {
+    printf("=== UCRA Timeline Tests ===\n");
+    test_placement_and_crossfade();
+    test_envelope_and_clipping();
+    test_stream_matches_buffer();
+    test_invalid_calls();
+    printf("All timeline tests passed!\n");
+    return 0;
+}
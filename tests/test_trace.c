@@ -0,0 +1,185 @@
+/*
+ * Test for the UCRA tracing hooks
+ * With UCRA_TRACING: spans of a render, a manifest load and a flag mapping
+ * are recorded, worker threads get their own ids, disabled tracing records
+ * nothing, a full buffer drops and counts events, and the Chrome export is
+ * well formed. Without it: the API reports UCRA_ERR_NOT_SUPPORTED.
+ */
+
+#include "ucra/ucra.h"
+#include "ucra/ucra_flag_mapper.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#ifdef UCRA_TRACING
+
+#define MAX_EVENTS 20000
+
+typedef struct Collected {
+    UCRA_TraceEvent events[MAX_EVENTS];
+    uint32_t count;
+} Collected;
+
+static Collected collected;
+
+static void UCRA_CALL collect(void* user_data, const UCRA_TraceEvent* events, uint32_t count) {
+    Collected* c = (Collected*)user_data;
+    for (uint32_t i = 0; i < count && c->count < MAX_EVENTS; i++) {
+        c->events[c->count++] = events[i];
+    }
+}
+
+static uint32_t drain(uint64_t* dropped) {
+    collected.count = 0;
+    assert(ucra_trace_drain(collect, &collected, dropped) == UCRA_SUCCESS);
+    return collected.count;
+}
+
+static const UCRA_TraceEvent* find_event(const char* name) {
+    for (uint32_t i = 0; i < collected.count; i++) {
+        if (strcmp(collected.events[i].name, name) == 0) return &collected.events[i];
+    }
+    return NULL;
+}
+
+static void write_text(const char* path, const char* text) {
+    FILE* file = fopen(path, "w");
+    assert(file != NULL);
+    fputs(text, file);
+    fclose(file);
+}
+
+static void render_long(void) {
+    UCRA_KeyValue options[] = { { "render_threads", "4" } };
+    UCRA_Handle engine = NULL;
+    assert(ucra_engine_create(&engine, options, 1) == UCRA_SUCCESS);
+    UCRA_NoteSegment notes[] = { { 0.0, 3.0, 69, 100, "a", NULL, NULL } };
+    UCRA_RenderConfig config;
+    memset(&config, 0, sizeof(config));
+    config.sample_rate = 44100;
+    config.channels = 2;
+    config.block_size = 512;
+    config.notes = notes;
+    config.note_count = 1;
+    UCRA_RenderResult result;
+    assert(ucra_render(engine, &config, &result) == UCRA_SUCCESS);
+    ucra_engine_destroy(engine);
+}
+
+static void test_spans(void) {
+    printf("Testing recorded spans...\n");
+    uint64_t dropped = 0;
+    assert(ucra_trace_enable(1) == UCRA_SUCCESS);
+    drain(NULL); /* start empty */
+
+    render_long();
+    write_text("test_trace_manifest.json",
+               "{\"name\":\"Trace\",\"version\":\"1.0\",\"entry\":{\"type\":\"dll\",\"path\":\"x.dll\","
+               "\"symbol\":\"ucra_entry\"},\"audio\":{\"rates\":[44100],\"channels\":[1],\"streaming\":false}}");
+    UCRA_Manifest* manifest = NULL;
+    assert(ucra_manifest_load("test_trace_manifest.json", &manifest) == UCRA_SUCCESS);
+    ucra_manifest_free(manifest);
+    remove("test_trace_manifest.json");
+
+    write_text("test_trace_mapping.json",
+               "{\"engine\":\"t\",\"version\":\"1.0\",\"rules\":[{\"source\":{\"name\":\"g\",\"type\":\"number\"},"
+               "\"target\":{\"name\":\"gender\"},\"transform\":{\"kind\":\"scale\",\"scale\":[-1.0,1.0]}}]}");
+    UCRA_FlagMapper* mapper = NULL;
+    assert(ucra_flag_mapper_load("test_trace_mapping.json", &mapper) == UCRA_SUCCESS);
+    remove("test_trace_mapping.json");
+    UCRA_KeyValue legacy[] = { { "g", "0.5" } };
+    UCRA_FlagMapResult mapped;
+    assert(ucra_flag_mapper_apply(mapper, legacy, 1, &mapped) == UCRA_SUCCESS);
+    ucra_flag_map_result_free(&mapped);
+
+    assert(drain(&dropped) > 0 && dropped == 0);
+    const UCRA_TraceEvent* render = find_event("engine.render");
+    const UCRA_TraceEvent* synthesis = find_event("engine.synthesis");
+    assert(render && synthesis && find_event("manifest.load") && find_event("flag_mapper.apply"));
+    /* synthesis runs inside the render, on the same thread */
+    assert(synthesis->thread_id == render->thread_id);
+    assert(synthesis->start_ns >= render->start_ns &&
+           synthesis->start_ns + synthesis->duration_ns <= render->start_ns + render->duration_ns);
+
+    /* the chunks of the render were spread over the workers */
+    uint32_t chunks = 0, other_threads = 0;
+    for (uint32_t i = 0; i < collected.count; i++) {
+        if (strcmp(collected.events[i].name, "engine.chunk") != 0) continue;
+        chunks++;
+        other_threads += collected.events[i].thread_id != render->thread_id;
+    }
+    assert(chunks == (3 * 44100 + 16383) / 16384);
+    (void)other_threads; /* on one CPU every chunk may still run on the caller */
+
+    /* drained events are gone */
+    assert(drain(NULL) == 0);
+
+    /* nothing is recorded while disabled */
+    assert(ucra_trace_enable(0) == UCRA_SUCCESS);
+    assert(ucra_flag_mapper_apply(mapper, legacy, 1, &mapped) == UCRA_SUCCESS);
+    ucra_flag_map_result_free(&mapped);
+    assert(drain(NULL) == 0);
+
+    /* a full buffer drops the newest events and counts them */
+    assert(ucra_trace_enable(1) == UCRA_SUCCESS);
+    for (int i = 0; i < 10000; i++) {
+        UCRA_FlagMapResult into;
+        char arena[1024];
+        assert(ucra_flag_mapper_apply_into(mapper, legacy, 1, arena, sizeof(arena), &into) == UCRA_SUCCESS);
+    }
+    uint32_t kept = drain(&dropped);
+    assert(kept > 0 && dropped > 0 && kept + dropped == 10000);
+    assert(drain(&dropped) == 0 && dropped == 0);
+    ucra_flag_mapper_free(mapper);
+    printf("✓ Span test passed\n");
+}
+
+static void test_chrome_export(void) {
+    printf("Testing Chrome trace export...\n");
+    render_long();
+    assert(ucra_trace_write_chrome("test_trace.json") == UCRA_SUCCESS);
+    assert(ucra_trace_enable(0) == UCRA_SUCCESS);
+
+    FILE* file = fopen("test_trace.json", "r");
+    assert(file != NULL);
+    static char text[1 << 16];
+    size_t length = fread(text, 1, sizeof(text) - 1, file);
+    fclose(file);
+    remove("test_trace.json");
+    text[length] = '\0';
+    assert(strncmp(text, "{\"traceEvents\":[", 16) == 0);
+    assert(strstr(text, "\"name\":\"engine.render\",\"cat\":\"ucra\",\"ph\":\"X\"") != NULL);
+    assert(strstr(text, "\"dropped_events\":0}}") != NULL);
+    assert(drain(NULL) == 0); /* the export drained them */
+
+    assert(ucra_trace_write_chrome("no_such_directory/test_trace.json") == UCRA_ERR_FILE_NOT_FOUND);
+    assert(ucra_trace_drain(NULL, NULL, NULL) == UCRA_ERR_INVALID_ARGUMENT);
+    printf("✓ Chrome export test passed\n");
+}
+
+#else
+
+static void test_compiled_out(void) {
+    printf("Testing the API without UCRA_TRACING...\n");
+    uint64_t dropped = 5;
+    assert(ucra_trace_enable(1) == UCRA_ERR_NOT_SUPPORTED);
+    assert(ucra_trace_drain(NULL, NULL, &dropped) == UCRA_ERR_NOT_SUPPORTED && dropped == 0);
+    assert(ucra_trace_write_chrome("test_trace.json") == UCRA_ERR_NOT_SUPPORTED);
+    printf("✓ Compiled-out test passed\n");
+}
+
+#endif
+
+int main() {
+    printf("=== UCRA Tracing Tests ===\n");
+#ifdef UCRA_TRACING
+    test_spans();
+    test_chrome_export();
+#else
+    test_compiled_out();
+#endif
+    printf("All tracing tests passed!\n");
+    return 0;
+}
@@ -0,0 +1,140 @@
+/*
+ * Test for UCRA voicebank discovery
+ * Checks which directories are found as voicebanks, the entry order, and that
+ * broken manifests and unreadable roots are reported per entry
+ */
+
+#include "ucra/ucra.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#ifdef _WIN32
+    #include <direct.h>
+    #define make_dir(path) _mkdir(path)
+    #define remove_dir(path) _rmdir(path)
+#else
+    #include <sys/stat.h>
+    #include <unistd.h>
+    #define make_dir(path) mkdir(path, 0755)
+    #define remove_dir(path) rmdir(path)
+#endif
+
+static void write_file(const char* path, const char* text) {
+    FILE* file = fopen(path, "w");
+    assert(file != NULL);
+    fputs(text, file);
+    fclose(file);
+}
+
+static void write_manifest(const char* path, const char* name) {
+    char text[512];
+    snprintf(text, sizeof(text),
+             "{ \"name\": \"%s\", \"version\": \"1.0\", \"entry\": { \"type\": \"cli\", \"path\": \"./r\" },\n"
+             "  \"audio\": { \"rates\": [44100], \"channels\": [1] } }\n", name);
+    write_file(path, text);
+}
+
+/* vb_library: three voicebanks (one broken), a folder and a file that are not;
+ * vb_single: a voicebank root with a subfolder that must not be scanned */
+static void make_tree() {
+    make_dir("vb_library");
+    make_dir("vb_library/b_bank");
+    make_dir("vb_library/a_bank");
+    make_dir("vb_library/c_broken");
+    make_dir("vb_library/not_a_bank");
+    make_dir("vb_single");
+    make_dir("vb_single/pitch");
+    write_manifest("vb_library/b_bank/resampler.json", "B");
+    write_manifest("vb_library/a_bank/resampler.json", "A");
+    write_file("vb_library/c_broken/resampler.json", "{ \"name\": ");
+    write_file("vb_library/readme.txt", "not a voicebank");
+    write_manifest("vb_single/resampler.json", "Single");
+    write_manifest("vb_single/pitch/resampler.json", "Pitch");
+}
+
+static void remove_tree() {
+    remove("vb_library/b_bank/resampler.json");
+    remove("vb_library/a_bank/resampler.json");
+    remove("vb_library/c_broken/resampler.json");
+    remove("vb_library/readme.txt");
+    remove("vb_single/resampler.json");
+    remove("vb_single/pitch/resampler.json");
+    remove_dir("vb_library/b_bank");
+    remove_dir("vb_library/a_bank");
+    remove_dir("vb_library/c_broken");
+    remove_dir("vb_library/not_a_bank");
+    remove_dir("vb_library");
+    remove_dir("vb_single/pitch");
+    remove_dir("vb_single");
+}
+
+static void test_discover() {
+    printf("Testing voicebank discovery...\n");
+    make_tree();
+
+    const char* roots[] = { "vb_library", "vb_missing", "vb_single/", "vb_library" };
+    UCRA_VoicebankSetHandle set = NULL;
+    assert(ucra_voicebank_discover(&set, roots, 4, 3) == UCRA_SUCCESS && set != NULL);
+    assert(ucra_voicebank_count(set) == 8);
+
+    const UCRA_VoicebankEntry* e = ucra_voicebank_entry(set, 0);
+    assert(strcmp(e->directory, "vb_library/a_bank") == 0);
+    assert(strcmp(e->manifest_path, "vb_library/a_bank/resampler.json") == 0);
+    assert(e->status == UCRA_SUCCESS && strcmp(e->manifest->name, "A") == 0);
+    e = ucra_voicebank_entry(set, 1);
+    assert(e->status == UCRA_SUCCESS && strcmp(e->manifest->name, "B") == 0);
+    e = ucra_voicebank_entry(set, 2);
+    assert(strcmp(e->directory, "vb_library/c_broken") == 0);
+    assert(e->status == UCRA_ERR_INVALID_JSON && e->manifest == NULL);
+
+    /* an unreadable root is an entry of its own */
+    e = ucra_voicebank_entry(set, 3);
+    assert(strcmp(e->directory, "vb_missing") == 0 && e->status == UCRA_ERR_FILE_NOT_FOUND);
+
+    /* a root that is a voicebank is not scanned further */
+    e = ucra_voicebank_entry(set, 4);
+    assert(strcmp(e->directory, "vb_single/") == 0);
+    assert(strcmp(e->manifest_path, "vb_single/resampler.json") == 0);
+    assert(e->status == UCRA_SUCCESS && strcmp(e->manifest->name, "Single") == 0);
+
+    /* the same voicebank found twice shares one manifest */
+    e = ucra_voicebank_entry(set, 5);
+    assert(strcmp(e->directory, "vb_library/a_bank") == 0);
+    assert(e->manifest == ucra_voicebank_entry(set, 0)->manifest);
+    assert(ucra_voicebank_entry(set, 8) == NULL);
+    ucra_voicebank_destroy(set);
+
+    /* the same result with everything on the calling thread */
+    assert(ucra_voicebank_discover(&set, roots, 1, 1) == UCRA_SUCCESS);
+    assert(ucra_voicebank_count(set) == 3);
+    ucra_voicebank_destroy(set);
+
+    remove_tree();
+    ucra_manifest_registry_clear();
+    printf("✓ Voicebank discovery test passed\n");
+}
+
+static void test_invalid_arguments() {
+    printf("Testing invalid discovery arguments...\n");
+    const char* roots[] = { "vb_library", NULL };
+    UCRA_VoicebankSetHandle set = NULL;
+    assert(ucra_voicebank_discover(NULL, roots, 1, 0) == UCRA_ERR_INVALID_ARGUMENT);
+    assert(ucra_voicebank_discover(&set, NULL, 1, 0) == UCRA_ERR_INVALID_ARGUMENT && set == NULL);
+    assert(ucra_voicebank_discover(&set, roots, 2, 0) == UCRA_ERR_INVALID_ARGUMENT);
+
+    assert(ucra_voicebank_discover(&set, NULL, 0, 0) == UCRA_SUCCESS && ucra_voicebank_count(set) == 0);
+    ucra_voicebank_destroy(set);
+    assert(ucra_voicebank_count(NULL) == 0 && ucra_voicebank_entry(NULL, 0) == NULL);
+    ucra_voicebank_destroy(NULL);
+    printf("✓ Invalid argument test passed\n");
+}
+
+int main() {
+    printf("=== UCRA Voicebank Discovery Tests ===\n");
+    test_discover();
+    test_invalid_arguments();
+    printf("All voicebank discovery tests passed!\n");
+    return 0;
+}
@@ -0,0 +1,220 @@
+/*
+ * Test for the UCRA WAV writer
+ * Checks the header layouts, that float blocks of any size arrive unchanged,
+ * integer rounding, clipping and dither, and argument validation
+ */
+
+#include "ucra/ucra.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <math.h>
+
+#define TEST_WAV "wav_writer_test.wav"
+
+static unsigned char* read_all(const char* path, size_t* out_size) {
+    FILE* file = fopen(path, "rb");
+    assert(file != NULL);
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    unsigned char* bytes = malloc(size > 0 ? (size_t)size : 1);
+    assert(bytes != NULL);
+    assert(fread(bytes, 1, (size_t)size, file) == (size_t)size);
+    fclose(file);
+    *out_size = (size_t)size;
+    return bytes;
+}
+
+static uint32_t le32(const unsigned char* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint16_t le16(const unsigned char* p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static int32_t le24(const unsigned char* p) {
+    return (int32_t)((uint32_t)p[0] << 8 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 24) >> 8;
+}
+
+/* Check the fmt and data headers at offset and return the data offset */
+static size_t check_header(const unsigned char* bytes, size_t offset, uint16_t tag, uint16_t channels,
+                           uint32_t rate, uint16_t bits, uint32_t data_size) {
+    assert(memcmp(bytes + offset, "fmt ", 4) == 0 && le32(bytes + offset + 4) == 16);
+    assert(le16(bytes + offset + 8) == tag && le16(bytes + offset + 10) == channels);
+    assert(le32(bytes + offset + 12) == rate);
+    assert(le32(bytes + offset + 16) == rate * channels * (bits / 8));
+    assert(le16(bytes + offset + 20) == channels * (bits / 8) && le16(bytes + offset + 22) == bits);
+    assert(memcmp(bytes + offset + 24, "data", 4) == 0 && le32(bytes + offset + 28) == data_size);
+    return offset + 32;
+}
+
+static void test_float_blocks() {
+    printf("Testing float output in blocks...\n");
+    /* more than the writer's buffer, fed in odd sizes and one block larger than the buffer */
+    const uint64_t frames = 400000;
+    float* pcm = malloc(frames * 2 * sizeof(float));
+    assert(pcm != NULL);
+    for (uint64_t i = 0; i < frames * 2; i++) {
+        pcm[i] = (float)sin(i * 0.001) * 1.5f;
+    }
+
+    UCRA_WavWriterHandle writer = NULL;
+    assert(ucra_wav_writer_open(&writer, TEST_WAV, 48000, 2, UCRA_SAMPLE_FLOAT32, 0) == UCRA_SUCCESS);
+    uint64_t done = 0;
+    uint64_t sizes[] = { 1, 777, 200000, 3 };
+    for (int i = 0; done < frames; i = (i + 1) % 4) {
+        uint64_t n = frames - done < sizes[i] ? frames - done : sizes[i];
+        assert(ucra_wav_writer_write(writer, pcm + done * 2, n) == UCRA_SUCCESS);
+        done += n;
+        assert(ucra_wav_writer_frames(writer) == done);
+    }
+    assert(ucra_wav_writer_write(writer, NULL, 0) == UCRA_SUCCESS);
+    assert(ucra_wav_writer_close(writer) == UCRA_SUCCESS);
+
+    size_t size = 0;
+    unsigned char* bytes = read_all(TEST_WAV, &size);
+    uint32_t data_size = (uint32_t)(frames * 2 * sizeof(float));
+    assert(size == 44 + data_size);
+    assert(memcmp(bytes, "RIFF", 4) == 0 && le32(bytes + 4) == 36 + data_size);
+    assert(memcmp(bytes + 8, "WAVE", 4) == 0);
+    size_t data = check_header(bytes, 12, 3, 2, 48000, 32, data_size);
+    assert(memcmp(bytes + data, pcm, data_size) == 0);
+
+    free(bytes);
+    free(pcm);
+    remove(TEST_WAV);
+    printf("✓ Float block test passed\n");
+}
+
+static void test_pcm16_rounding() {
+    printf("Testing 16-bit rounding and clipping...\n");
+    float pcm[6] = { 0.0f, 0.5f, -0.5f, 1.5f, -1.5f, 100.4f / 32768.0f };
+    UCRA_WavWriterHandle writer = NULL;
+    assert(ucra_wav_writer_open(&writer, TEST_WAV, 44100, 1, UCRA_SAMPLE_PCM16, UCRA_WAV_NO_DITHER) == UCRA_SUCCESS);
+    assert(ucra_wav_writer_write(writer, pcm, 6) == UCRA_SUCCESS);
+    assert(ucra_wav_writer_close(writer) == UCRA_SUCCESS);
+
+    size_t size = 0;
+    unsigned char* bytes = read_all(TEST_WAV, &size);
+    assert(size == 44 + 12);
+    size_t data = check_header(bytes, 12, 1, 1, 44100, 16, 12);
+    int16_t expected[6] = { 0, 16384, -16384, 32767, -32768, 100 };
+    for (int i = 0; i < 6; i++) {
+        assert((int16_t)le16(bytes + data + 2 * i) == expected[i]);
+    }
+    free(bytes);
+    remove(TEST_WAV);
+    printf("✓ 16-bit test passed\n");
+}
+
+static void test_dither() {
+    printf("Testing dithered 16-bit and rounded 24-bit output...\n");
+    enum { FRAMES = 9001 }; /* odd, so 24-bit mono data needs a pad byte */
+    static float pcm[FRAMES];
+    for (int i = 0; i < FRAMES; i++) {
+        pcm[i] = (float)sin(i * 0.01) * 0.8f;
+    }
+
+    unsigned char* files[2];
+    size_t size = 0;
+    for (int run = 0; run < 2; run++) {
+        UCRA_WavWriterHandle writer = NULL;
+        assert(ucra_wav_writer_open(&writer, TEST_WAV, 22050, 1, UCRA_SAMPLE_PCM16, 0) == UCRA_SUCCESS);
+        assert(ucra_wav_writer_write(writer, pcm, 5000) == UCRA_SUCCESS);
+        assert(ucra_wav_writer_write(writer, pcm + 5000, FRAMES - 5000) == UCRA_SUCCESS);
+        assert(ucra_wav_writer_close(writer) == UCRA_SUCCESS);
+        files[run] = read_all(TEST_WAV, &size);
+    }
+    /* the dither comes from the writer itself, so the output is reproducible */
+    assert(size == 44 + FRAMES * 2);
+    assert(memcmp(files[0], files[1], size) == 0);
+    size_t data = check_header(files[0], 12, 1, 1, 22050, 16, FRAMES * 2);
+    int changed = 0;
+    for (int i = 0; i < FRAMES; i++) {
+        int32_t value = (int16_t)le16(files[0] + data + 2 * i);
+        int32_t rounded = (int32_t)lrintf(pcm[i] * 32768.0f);
+        assert(abs(value - rounded) <= 1);
+        changed += value != rounded;
+    }
+    assert(changed > FRAMES / 4);
+    free(files[0]);
+    free(files[1]);
+
+    UCRA_WavWriterHandle writer = NULL;
+    assert(ucra_wav_writer_open(&writer, TEST_WAV, 22050, 1, UCRA_SAMPLE_PCM24, 0) == UCRA_SUCCESS);
+    assert(ucra_wav_writer_write(writer, pcm, FRAMES) == UCRA_SUCCESS);
+    assert(ucra_wav_writer_close(writer) == UCRA_SUCCESS);
+    unsigned char* bytes = read_all(TEST_WAV, &size);
+    uint32_t data_size = FRAMES * 3;
+    assert(size == 44 + data_size + 1);
+    assert(le32(bytes + 4) == 36 + data_size + 1);
+    data = check_header(bytes, 12, 1, 1, 22050, 24, data_size);
+    for (int i = 0; i < FRAMES; i++) {
+        assert(le24(bytes + data + 3 * i) == (int32_t)lrintf(pcm[i] * 8388608.0f));
+    }
+    free(bytes);
+    remove(TEST_WAV);
+    printf("✓ Dither test passed\n");
+}
+
+static void test_rf64_reservation() {
+    printf("Testing the RF64 reservation...\n");
+    float pcm[4] = { 0.1f, -0.1f, 0.2f, -0.2f };
+    UCRA_WavWriterHandle writer = NULL;
+    assert(ucra_wav_writer_open(&writer, TEST_WAV, 96000, 2, UCRA_SAMPLE_FLOAT32, UCRA_WAV_RF64) == UCRA_SUCCESS);
+    assert(ucra_wav_writer_write(writer, pcm, 2) == UCRA_SUCCESS);
+    assert(ucra_wav_writer_close(writer) == UCRA_SUCCESS);
+
+    /* a file that stayed small is plain RIFF with the space kept in a JUNK chunk */
+    size_t size = 0;
+    unsigned char* bytes = read_all(TEST_WAV, &size);
+    assert(size == 80 + sizeof(pcm));
+    assert(memcmp(bytes, "RIFF", 4) == 0 && le32(bytes + 4) == 72 + sizeof(pcm));
+    assert(memcmp(bytes + 12, "JUNK", 4) == 0 && le32(bytes + 16) == 28);
+    size_t data = check_header(bytes, 48, 3, 2, 96000, 32, sizeof(pcm));
+    assert(memcmp(bytes + data, pcm, sizeof(pcm)) == 0);
+    free(bytes);
+    remove(TEST_WAV);
+    printf("✓ RF64 reservation test passed\n");
+}
+
+static void test_invalid_arguments() {
+    printf("Testing invalid writer arguments...\n");
+    UCRA_WavWriterHandle writer = NULL;
+    assert(ucra_wav_writer_open(NULL, TEST_WAV, 44100, 1, UCRA_SAMPLE_PCM16, 0) == UCRA_ERR_INVALID_ARGUMENT);
+    assert(ucra_wav_writer_open(&writer, NULL, 44100, 1, UCRA_SAMPLE_PCM16, 0) == UCRA_ERR_INVALID_ARGUMENT);
+    assert(ucra_wav_writer_open(&writer, TEST_WAV, 0, 1, UCRA_SAMPLE_PCM16, 0) == UCRA_ERR_INVALID_ARGUMENT);
+    assert(ucra_wav_writer_open(&writer, TEST_WAV, 44100, 0, UCRA_SAMPLE_PCM16, 0) == UCRA_ERR_INVALID_ARGUMENT);
+    assert(ucra_wav_writer_open(&writer, TEST_WAV, 44100, 1, (UCRA_SampleFormat)7, 0) == UCRA_ERR_INVALID_ARGUMENT);
+    assert(writer == NULL);
+    assert(ucra_wav_writer_open(&writer, "wav_writer_missing/out.wav", 44100, 1, UCRA_SAMPLE_PCM16, 0) ==
+           UCRA_ERR_FILE_NOT_FOUND);
+
+    assert(ucra_wav_writer_open(&writer, TEST_WAV, 44100, 1, UCRA_SAMPLE_PCM16, 0) == UCRA_SUCCESS);
+    assert(ucra_wav_writer_write(writer, NULL, 4) == UCRA_ERR_INVALID_ARGUMENT);
+    assert(ucra_wav_writer_write(NULL, NULL, 0) == UCRA_ERR_INVALID_ARGUMENT);
+    assert(ucra_wav_writer_close(writer) == UCRA_SUCCESS); /* an empty file is still valid */
+
+    size_t size = 0;
+    unsigned char* bytes = read_all(TEST_WAV, &size);
+    assert(size == 44 && le32(bytes + 40) == 0);
+    free(bytes);
+    remove(TEST_WAV);
+    assert(ucra_wav_writer_frames(NULL) == 0);
+    assert(ucra_wav_writer_close(NULL) == UCRA_ERR_INVALID_ARGUMENT);
+    printf("✓ Invalid argument test passed\n");
+}
+
+int main() {
+    printf("=== UCRA WAV Writer Tests ===\n");
+    test_float_blocks();
+    test_pcm16_rounding();
+    test_dither();
+    test_rf64_reservation();
+    test_invalid_arguments();
+    printf("All WAV writer tests passed!\n");
+    return 0;
+}
@@ -0,0 +1,205 @@
+/*
+ * Smoke test for the WORLD engine (built with UCRA_ENABLE_WORLD)
+ * Runs the offline, render-into, batch, block, chunked and streaming paths on
+ * a short phrase and checks each produces the expected length of finite,
+ * audible PCM. Paths that synthesize differently are compared by level only.
+ */
+
+#include "ucra/ucra.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <math.h>
+
+#define RATE 44100
+#define NOTES 4
+
+static UCRA_NoteSegment g_notes[NOTES] = {
+    { 0.0, 0.5, 60, 100, "a", NULL, NULL },
+    { 0.5, 0.5, 64, 100, "i", NULL, NULL },
+    { 1.0, 0.5, 67, 100, "u", NULL, NULL },
+    { 1.5, 1.0, 72, 100, "e", NULL, NULL },
+};
+
+static UCRA_RenderConfig make_config(void) {
+    UCRA_RenderConfig config;
+    memset(&config, 0, sizeof(config));
+    config.sample_rate = RATE;
+    config.channels = 1;
+    config.block_size = 512;
+    config.notes = g_notes;
+    config.note_count = NOTES;
+    return config;
+}
+
+/* An engine, chunking synthesis if chunk_frames is set, filling chunks on threads if that is */
+static UCRA_Handle make_engine(const char* chunk_frames, const char* threads) {
+    UCRA_KeyValue options[3] = { { "sample_rate", "44100" }, { "synthesis_chunk_frames", chunk_frames },
+                                 { "render_threads", threads } };
+    UCRA_Handle engine = NULL;
+    assert(ucra_engine_create(&engine, options, chunk_frames ? (threads ? 3 : 2) : 1) == UCRA_SUCCESS);
+    return engine;
+}
+
+/* RMS of finite samples; fails on NaN or infinity */
+static double checked_rms(const float* pcm, uint64_t count) {
+    double energy = 0.0;
+    for (uint64_t i = 0; i < count; i++) {
+        assert(isfinite(pcm[i]));
+        energy += (double)pcm[i] * pcm[i];
+    }
+    return count ? sqrt(energy / (double)count) : 0.0;
+}
+
+/* Levels of two renders of the same phrase agree within a factor of two */
+static void check_level(double rms, double reference) {
+    assert(rms > 0.5 * reference && rms < 2.0 * reference);
+}
+
+static float* g_reference;
+static uint64_t g_frames;
+static double g_rms;
+
+static void test_render(void) {
+    printf("Testing offline render...\n");
+    UCRA_Handle engine = make_engine(NULL, NULL);
+    char info[256];
+    assert(ucra_engine_getinfo(engine, info, sizeof(info)) == UCRA_SUCCESS && strstr(info, "WORLD"));
+
+    UCRA_RenderConfig config = make_config();
+    UCRA_RenderResult result;
+    assert(ucra_render(engine, &config, &result) == UCRA_SUCCESS);
+    assert(result.frames >= (uint64_t)(2.5 * RATE) - RATE / 100 && result.channels == 1);
+    g_frames = result.frames;
+    g_rms = checked_rms(result.pcm, result.frames);
+    assert(g_rms > 1e-4);
+    g_reference = malloc(g_frames * sizeof(float));
+    assert(g_reference != NULL);
+    memcpy(g_reference, result.pcm, g_frames * sizeof(float));
+
+    /* render_into gives the same samples */
+    uint64_t frames = 0, samples = 0;
+    assert(ucra_render_query_size(engine, &config, &frames, &samples) == UCRA_SUCCESS);
+    assert(frames == g_frames && samples == g_frames);
+    float* pcm = malloc(samples * sizeof(float));
+    assert(pcm != NULL);
+    assert(ucra_render_into(engine, &config, pcm, samples, &result) == UCRA_SUCCESS);
+    assert(memcmp(pcm, g_reference, samples * sizeof(float)) == 0);
+    free(pcm);
+
+    /* as does each job of a batch */
+    UCRA_RenderConfig configs[2] = { config, config };
+    UCRA_RenderResult results[2];
+    assert(ucra_render_batch(engine, configs, results, 2) == UCRA_SUCCESS);
+    for (int i = 0; i < 2; i++) {
+        assert(results[i].status == UCRA_SUCCESS && results[i].frames == g_frames);
+        assert(memcmp(results[i].pcm, g_reference, g_frames * sizeof(float)) == 0);
+    }
+    ucra_engine_destroy(engine);
+    printf("✓ Offline render test passed\n");
+}
+
+static void test_chunked(void) {
+    printf("Testing chunked synthesis...\n");
+    UCRA_Handle engine = make_engine("64", NULL); /* 0.32 s windows: the phrase spans several */
+    UCRA_RenderConfig config = make_config();
+    UCRA_RenderResult result;
+    assert(ucra_render(engine, &config, &result) == UCRA_SUCCESS);
+    assert(result.frames == g_frames);
+    check_level(checked_rms(result.pcm, result.frames), g_rms);
+
+    /* windows filled on worker threads give the same samples */
+    UCRA_Handle threaded = make_engine("64", "4");
+    UCRA_RenderResult threaded_result;
+    assert(ucra_render(threaded, &config, &threaded_result) == UCRA_SUCCESS);
+    assert(threaded_result.frames == g_frames);
+    assert(memcmp(threaded_result.pcm, result.pcm, g_frames * sizeof(float)) == 0);
+    ucra_engine_destroy(threaded);
+
+    /* stereo interleaved duplicates the mono signal */
+    config.channels = 2;
+    assert(ucra_render(engine, &config, &result) == UCRA_SUCCESS);
+    assert(result.frames == g_frames && result.channels == 2);
+    for (uint64_t i = 0; i < result.frames; i++) assert(result.pcm[2 * i] == result.pcm[2 * i + 1]);
+    ucra_engine_destroy(engine);
+    printf("✓ Chunked synthesis test passed\n");
+}
+
+static void test_blocks(void) {
+    printf("Testing block rendering...\n");
+    UCRA_Handle engine = make_engine(NULL, NULL);
+    UCRA_RenderConfig config = make_config();
+    float* pcm = calloc(g_frames + 4096, sizeof(float));
+    assert(pcm != NULL);
+    uint64_t start = 0;
+    for (uint32_t block = 300; start < g_frames; block = block * 3 % 1000 + 100) {
+        assert(ucra_render_block(engine, &config, start, block, pcm + start) == UCRA_SUCCESS);
+        start += block;
+    }
+    check_level(checked_rms(pcm, g_frames), g_rms);
+    /* frames past the end are silence */
+    for (uint64_t i = g_frames + RATE / 50; i < start; i++) assert(pcm[i] == 0.0f);
+
+    /* a backward seek restarts and renders the start again */
+    float first[512];
+    assert(ucra_render_block(engine, &config, 0, 512, first) == UCRA_SUCCESS);
+    assert(memcmp(first, pcm, sizeof(first)) == 0);
+    free(pcm);
+    ucra_engine_destroy(engine);
+    printf("✓ Block rendering test passed\n");
+}
+
+static UCRA_Result UCRA_CALL pull_notes(void* user_data, UCRA_RenderConfig* out_config) {
+    (void)user_data;
+    out_config->notes = g_notes;
+    out_config->note_count = NOTES;
+    return UCRA_SUCCESS;
+}
+
+static void read_stream(UCRA_StreamHandle stream) {
+    float* pcm = malloc(g_frames * sizeof(float));
+    assert(pcm != NULL);
+    uint64_t total = 0;
+    while (total < g_frames) {
+        uint32_t want = g_frames - total < 1024 ? (uint32_t)(g_frames - total) : 1024;
+        uint32_t got = 0;
+        assert(ucra_stream_read(stream, pcm + total, want, &got) == UCRA_SUCCESS);
+        assert(got > 0);
+        total += got;
+    }
+    check_level(checked_rms(pcm, g_frames), g_rms);
+    free(pcm);
+}
+
+static void test_streams(void) {
+    printf("Testing streams...\n");
+    UCRA_RenderConfig config = make_config();
+
+    /* the stream's own realtime synthesizer */
+    UCRA_StreamHandle stream = NULL;
+    assert(ucra_stream_open(&stream, &config, pull_notes, NULL) == UCRA_SUCCESS);
+    read_stream(stream);
+    ucra_stream_close(stream);
+
+    /* and an engine's blocks */
+    UCRA_Handle engine = make_engine(NULL, NULL);
+    assert(ucra_stream_open_engine(&stream, engine, &config, pull_notes, NULL) == UCRA_SUCCESS);
+    read_stream(stream);
+    ucra_stream_close(stream);
+    ucra_engine_destroy(engine);
+    printf("✓ Streams test passed\n");
+}
+
+int main() {
+    printf("=== UCRA WORLD Engine Smoke Tests ===\n\n");
+
+    test_render();
+    test_chunked();
+    test_blocks();
+    test_streams();
+
+    free(g_reference);
+    printf("\n=== All WORLD engine smoke tests passed! ===\n");
+    return 0;
+}
@@ -0,0 +1,70 @@
+/*
+ * Audio Metrics
+ *
+ * WAV loading, file fingerprints and the sample-based comparison shared by
+ * audio_compare, mcd_calc and golden_runner. Audio is mixed down to mono
+ * float samples. Files are compared as a stream of fixed-size blocks, so
+ * memory does not grow with their length.
+ */
+
+#ifndef UCRA_TOOLS_AUDIO_METRICS_H
+#define UCRA_TOOLS_AUDIO_METRICS_H
+
+#include <stdint.h>
+
+#define HASH_SIZE 8            /* bytes of the 64-bit file fingerprint */
+#define TOLERANCE_SNR_DB 60.0  /* SNR threshold for pass/fail */
+#define TOLERANCE_RMS 0.001    /* RMS difference threshold */
+
+/* Audio data structure */
+typedef struct {
+    float* samples;
+    int length;
+    int sample_rate;
+    int channels;
+} AudioData;
+
+/* Comparison result */
+typedef struct {
+    int identical;          /* Bit-for-bit identical */
+    double rms_difference;  /* RMS difference */
+    double max_abs_difference; /* Largest sample difference */
+    double snr_db;          /* Signal-to-noise ratio in dB */
+    uint64_t samples_compared; /* Number of samples compared */
+    char hash1[HASH_SIZE * 2 + 1];  /* Hex string of first file hash */
+    char hash2[HASH_SIZE * 2 + 1];  /* Hex string of second file hash */
+} ComparisonResult;
+
+/* Initialize audio data structure */
+void audio_data_init(AudioData* audio);
+
+/* Free audio data memory */
+void audio_data_free(AudioData* audio);
+
+/* Load a WAV file (8/16/24/32-bit PCM or 32-bit IEEE float, RIFF or RF64) through ucra_wav */
+int load_wav_file(const char* filename, AudioData* audio);
+
+/* Mix interleaved float PCM, such as a render result, down into audio */
+int audio_data_from_pcm(const float* pcm, uint64_t frames, uint32_t channels, uint32_t sample_rate,
+                        AudioData* audio);
+
+/* 64-bit fingerprint of a file's contents (XXH64), as a hex string */
+int calculate_file_hash(const char* filename, char* hash_str);
+
+/* RMS difference and SNR of test against reference over their common length;
+ * identical is set when both hold the same samples */
+void compare_audio_data(const AudioData* reference, const AudioData* test, ComparisonResult* result);
+
+/* Compare two WAV files, of any encoding load_wav_file reads, in one pass over
+ * each: their fingerprints and, over their common length, their samples;
+ * rms_difference is negative if a file cannot be read */
+ComparisonResult compare_audio_files(const char* file1, const char* file2);
+
+/* Whether two files hold the same bytes, reading only until the first
+ * difference; -1 if a file cannot be read */
+int audio_files_equal(const char* file1, const char* file2);
+
+/* Whether a comparison passes: identical, or within TOLERANCE_RMS or TOLERANCE_SNR_DB */
+int audio_within_tolerance(const ComparisonResult* result);
+
+#endif /* UCRA_TOOLS_AUDIO_METRICS_H */
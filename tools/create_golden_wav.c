@@ -12,40 +12,13 @@
 static int write_wav_float32(const char* filename, const float* pcm, uint64_t frames,
                               uint32_t channels, uint32_t sample_rate) {
     if (!filename || !pcm || frames == 0 || channels == 0) return -1;
-    FILE* f = fopen(filename, "wb");
-    if (!f) return -2;
-
-    uint32_t data_size = (uint32_t)(frames * channels * sizeof(float));
-    uint32_t file_size = data_size + 36;
-
-    /* RIFF */
-    fwrite("RIFF", 1, 4, f);
-    fwrite(&file_size, 4, 1, f);
-    fwrite("WAVE", 1, 4, f);
-
-    /* fmt */
-    fwrite("fmt ", 1, 4, f);
-    uint32_t fmt_size = 16;
-    uint16_t audio_format = 3; /* IEEE float */
-    uint16_t num_channels = (uint16_t)channels;
-    uint32_t byte_rate = sample_rate * channels * (uint32_t)sizeof(float);
-    uint16_t block_align = (uint16_t)(channels * sizeof(float));
-    uint16_t bits_per_sample = 32;
-    fwrite(&fmt_size, 4, 1, f);
-    fwrite(&audio_format, 2, 1, f);
-    fwrite(&num_channels, 2, 1, f);
-    fwrite(&sample_rate, 4, 1, f);
-    fwrite(&byte_rate, 4, 1, f);
-    fwrite(&block_align, 2, 1, f);
-    fwrite(&bits_per_sample, 2, 1, f);
-
-    /* data */
-    fwrite("data", 1, 4, f);
-    fwrite(&data_size, 4, 1, f);
-    fwrite(pcm, sizeof(float), frames * channels, f);
-
-    fclose(f);
-    return 0;
+    UCRA_WavWriterHandle writer = NULL;
+    if (ucra_wav_writer_open(&writer, filename, sample_rate, channels, UCRA_SAMPLE_FLOAT32, 0) != UCRA_SUCCESS) {
+        return -2;
+    }
+    UCRA_Result written = ucra_wav_writer_write(writer, pcm, frames);
+    UCRA_Result closed = ucra_wav_writer_close(writer);
+    return written == UCRA_SUCCESS && closed == UCRA_SUCCESS ? 0 : -3;
 }
 
 int main(void) {
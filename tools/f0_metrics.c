@@ -0,0 +1,248 @@
+/*
+ * F0 Metrics
+ *
+ * F0 curves are read with the same ucra_f0_curve_open() loader as the
+ * resampler, or estimated from a WAV file with WORLD, and compared on a
+ * 10 ms grid that walks both curves forward together.
+ */
+
+#include "f0_metrics.h"
+#include "ucra/ucra.h"
+#include "ucra_wav.h"
+#ifdef UCRA_HAS_WORLD
+#include "ucra_world_analysis.h"
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <math.h>
+
+int f0_curve_init(F0Curve* curve) {
+    curve->capacity = 1000;
+    curve->points = malloc(curve->capacity * sizeof(F0Point));
+    curve->count = 0;
+    return curve->points ? 0 : -1;
+}
+
+/* Add a point to the F0 curve */
+static int f0_curve_add_point(F0Curve* curve, double time, double f0) {
+    if (curve->count >= curve->capacity) {
+        curve->capacity *= 2;
+        F0Point* new_points = realloc(curve->points, curve->capacity * sizeof(F0Point));
+        if (!new_points) {
+            return -1;
+        }
+        curve->points = new_points;
+    }
+
+    curve->points[curve->count].time = time;
+    curve->points[curve->count].f0 = f0;
+    curve->count++;
+    return 0;
+}
+
+void f0_curve_free(F0Curve* curve) {
+    if (curve->points) {
+        free(curve->points);
+        curve->points = NULL;
+    }
+    curve->count = 0;
+    curve->capacity = 0;
+}
+
+static int compare_points(const void* a, const void* b) {
+    const F0Point* pa = (const F0Point*)a;
+    const F0Point* pb = (const F0Point*)b;
+    return (pa->time > pb->time) - (pa->time < pb->time);
+}
+
+/* Put the points in time order if the file did not */
+static void f0_curve_sort(F0Curve* curve) {
+    for (int i = 1; i < curve->count; i++) {
+        if (curve->points[i].time < curve->points[i - 1].time) {
+            qsort(curve->points, curve->count, sizeof(F0Point), compare_points);
+            return;
+        }
+    }
+}
+
+int load_f0_curve(const char* filename, F0Curve* curve) {
+    UCRA_F0FileHandle file = NULL;
+    UCRA_F0Curve points;
+    UCRA_Result result = ucra_f0_curve_open(&file, filename, &points);
+    if (result == UCRA_ERR_FILE_NOT_FOUND) {
+        fprintf(stderr, "Error: Cannot open file '%s'\n", filename);
+        return -1;
+    }
+    if (result != UCRA_SUCCESS) {
+        fprintf(stderr, "Error: No valid data points found in file '%s'\n", filename);
+        return -1;
+    }
+
+    for (uint32_t i = 0; i < points.length; i++) {
+        if (f0_curve_add_point(curve, points.time_sec[i], points.f0_hz[i]) < 0) {
+            fprintf(stderr, "Error: Memory allocation failed at point %u\n", i + 1);
+            ucra_f0_curve_close(file);
+            return -1;
+        }
+    }
+    ucra_f0_curve_close(file);
+    f0_curve_sort(curve);
+    return 0;
+}
+
+void f0_estimate_options_init(UCRA_AnalysisOptions* options) {
+    options->frame_period = UCRA_ANALYSIS_DEFAULT_FRAME_PERIOD;
+    options->f0_floor = UCRA_ANALYSIS_DEFAULT_F0_FLOOR;
+    options->f0_ceil = UCRA_ANALYSIS_DEFAULT_F0_CEIL;
+    options->f0_method = UCRA_ANALYSIS_F0_HARVEST;
+}
+
+int f0_estimation_available(void) {
+#ifdef UCRA_HAS_WORLD
+    return 1;
+#else
+    return 0;
+#endif
+}
+
+int f0_curve_from_samples(const float* samples, uint32_t length, uint32_t sample_rate,
+                          const UCRA_AnalysisOptions* options, F0Curve* curve) {
+#ifdef UCRA_HAS_WORLD
+    float* f0 = NULL;
+    uint32_t frames = 0;
+    UCRA_Result result = ucra_world_estimate_f0(options, samples, length, sample_rate, &f0, &frames);
+    if (result != UCRA_SUCCESS) {
+        fprintf(stderr, "Error: F0 estimation failed (%d)\n", (int)result);
+        return -1;
+    }
+    for (uint32_t i = 0; i < frames; i++) {
+        if (f0_curve_add_point(curve, i * options->frame_period / 1000.0, f0[i]) < 0) {
+            fprintf(stderr, "Error: Memory allocation failed at point %u\n", i + 1);
+            free(f0);
+            return -1;
+        }
+    }
+    free(f0);
+    return 0;
+#else
+    (void)samples;
+    (void)length;
+    (void)sample_rate;
+    (void)options;
+    (void)curve;
+    fprintf(stderr, "Error: Built without WORLD; F0 cannot be estimated from audio\n");
+    return -1;
+#endif
+}
+
+int f0_is_wav_path(const char* filename) {
+    size_t length = strlen(filename);
+    if (length < 4) return 0;
+    const char* ext = filename + length - 4;
+    return ext[0] == '.' && tolower((unsigned char)ext[1]) == 'w' && tolower((unsigned char)ext[2]) == 'a' &&
+           tolower((unsigned char)ext[3]) == 'v';
+}
+
+int load_f0_input(const char* filename, const UCRA_AnalysisOptions* options, F0Curve* curve) {
+    if (!f0_is_wav_path(filename)) {
+        return load_f0_curve(filename, curve);
+    }
+    float* samples = NULL;
+    uint32_t length = 0, sample_rate = 0;
+    UCRA_Result result = ucra_wav_read_mono(filename, &samples, &length, &sample_rate);
+    if (result != UCRA_SUCCESS) {
+        fprintf(stderr, "Error: Cannot read WAV file '%s'\n", filename);
+        return -1;
+    }
+    int status = f0_curve_from_samples(samples, length, sample_rate, options, curve);
+    free(samples);
+    return status;
+}
+
+/* Position in a time-sorted curve; times only move forward, so a walk over a
+ * whole curve is linear in its length */
+typedef struct {
+    const F0Curve* curve;
+    int index; /* segment [index, index + 1] last sampled */
+} F0Cursor;
+
+/* Linear interpolation to get F0 value at target_time, not before the last one sampled */
+static double f0_cursor_sample(F0Cursor* cursor, double target_time) {
+    const F0Curve* curve = cursor->curve;
+    if (curve->count == 0) {
+        return 0.0;
+    }
+
+    /* Handle edge cases */
+    if (target_time <= curve->points[0].time) {
+        return curve->points[0].f0;
+    }
+    if (target_time >= curve->points[curve->count - 1].time) {
+        return curve->points[curve->count - 1].f0;
+    }
+
+    /* Advance to the first segment ending at or after target_time and interpolate */
+    int i = cursor->index;
+    while (target_time > curve->points[i + 1].time) {
+        i++;
+    }
+    cursor->index = i;
+    double t1 = curve->points[i].time;
+    double t2 = curve->points[i + 1].time;
+    double f1 = curve->points[i].f0;
+    double f2 = curve->points[i + 1].f0;
+
+    /* Linear interpolation */
+    double alpha = (target_time - t1) / (t2 - t1);
+    return f1 + alpha * (f2 - f1);
+}
+
+double calculate_f0_rmse(const F0Curve* ground_truth, const F0Curve* estimated, F0RMSEStats* stats) {
+    /* Determine time range */
+    double min_time = fmax(ground_truth->points[0].time, estimated->points[0].time);
+    double max_time = fmin(ground_truth->points[ground_truth->count - 1].time,
+                          estimated->points[estimated->count - 1].time);
+
+    if (min_time >= max_time) {
+        fprintf(stderr, "Error: No overlapping time range between curves\n");
+        return -1.0;
+    }
+
+    /* Calculate RMSE using fixed time step */
+    double time_step = 0.01; /* 10ms intervals */
+    double sum_squared_error = 0.0;
+    int sample_count = 0;
+
+    F0Cursor gt_cursor = { ground_truth, 0 };
+    F0Cursor est_cursor = { estimated, 0 };
+    for (double t = min_time; t <= max_time; t += time_step) {
+        double gt_f0 = f0_cursor_sample(&gt_cursor, t);
+        double est_f0 = f0_cursor_sample(&est_cursor, t);
+
+        /* Skip unvoiced regions (F0 = 0) */
+        if (gt_f0 > 0.0 && est_f0 > 0.0) {
+            double error = gt_f0 - est_f0;
+            sum_squared_error += error * error;
+            sample_count++;
+        }
+    }
+
+    if (sample_count == 0) {
+        fprintf(stderr, "Error: No voiced regions found for comparison\n");
+        return -1.0;
+    }
+
+    double mse = sum_squared_error / sample_count;
+    double rmse = sqrt(mse);
+
+    if (stats) {
+        stats->samples = sample_count;
+        stats->duration_sec = max_time - min_time;
+        stats->mse = mse;
+    }
+
+    return rmse;
+}
+
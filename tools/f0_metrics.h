@@ -0,0 +1,62 @@
+/*
+ * F0 Metrics
+ *
+ * F0 curves and their RMSE, shared by f0_rmse_calc and golden_runner.
+ * Curves come from curve files or, in WORLD builds, are estimated from audio.
+ */
+
+#ifndef UCRA_TOOLS_F0_METRICS_H
+#define UCRA_TOOLS_F0_METRICS_H
+
+#include "ucra_analysis.h"
+#include <stdint.h>
+
+typedef struct {
+    double time;
+    double f0;
+} F0Point;
+
+typedef struct {
+    F0Point* points;
+    int count;
+    int capacity;
+} F0Curve;
+
+/* What an RMSE was computed over */
+typedef struct {
+    int samples;          /* voiced 10 ms steps compared */
+    double duration_sec;  /* overlap of the two curves */
+    double mse;           /* in Hz squared */
+} F0RMSEStats;
+
+/* Initialize an F0 curve */
+int f0_curve_init(F0Curve* curve);
+
+/* Free F0 curve memory */
+void f0_curve_free(F0Curve* curve);
+
+/* Load F0 curve from a text or binary curve file; points are put in time order */
+int load_f0_curve(const char* filename, F0Curve* curve);
+
+/* Default estimation settings: Harvest with the analysis cache's defaults */
+void f0_estimate_options_init(UCRA_AnalysisOptions* options);
+
+/* Whether this build can estimate F0 from audio (needs UCRA_HAS_WORLD) */
+int f0_estimation_available(void);
+
+/* Estimate an F0 curve from mono samples with WORLD Harvest, or DIO + StoneMask */
+int f0_curve_from_samples(const float* samples, uint32_t length, uint32_t sample_rate,
+                          const UCRA_AnalysisOptions* options, F0Curve* curve);
+
+/* Whether filename ends in .wav, in any case */
+int f0_is_wav_path(const char* filename);
+
+/* Estimate the curve from a .wav file, or load it from any other file */
+int load_f0_input(const char* filename, const UCRA_AnalysisOptions* options, F0Curve* curve);
+
+/* Calculate F0 RMSE between two time-sorted curves over their overlap, skipping
+ * unvoiced (zero) regions, in one forward walk over both; returns a negative
+ * value on failure, and stats may be NULL */
+double calculate_f0_rmse(const F0Curve* ground_truth, const F0Curve* estimated, F0RMSEStats* stats);
+
+#endif /* UCRA_TOOLS_F0_METRICS_H */
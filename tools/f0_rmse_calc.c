@@ -4,241 +4,244 @@
  * This utility calculates the Root Mean Square Error (RMSE) between
  * a ground truth F0 curve and an estimated F0 curve.
  *
- * Usage: f0_rmse_calc <ground_truth_file> <estimated_file>
+ * Usage: f0_rmse_calc [options] <ground_truth_file> <estimated_file>
+ *        f0_rmse_calc [options] --list <pairs_file>
  *
  * File format: Two columns - time(sec) frequency(Hz)
  * Comments starting with # are ignored
+ * Binary curve files (see ucra_f0_curve_save) are read as well
+ * A .wav input has its F0 estimated with WORLD Harvest (or DIO) instead,
+ * in builds with WORLD
+ *
+ * --list reads one "<ground_truth_file> <estimated_file>" pair per line and
+ * scores the pairs on -j worker threads (default: one per CPU)
  */
 
+#include "f0_metrics.h"
+#include "ucra_threads.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <math.h>
-#include <errno.h>
 
-#define MAX_LINE_LENGTH 256
-#define MAX_POINTS 10000
+#define MAX_PATH 4096
 
 typedef struct {
-    double time;
-    double f0;
-} F0Point;
+    char ground_truth[MAX_PATH];
+    char estimated[MAX_PATH];
+    double rmse;              /* negative when the pair failed */
+    F0RMSEStats stats;
+} F0Pair;
 
 typedef struct {
-    F0Point* points;
-    int count;
-    int capacity;
-} F0Curve;
-
-/* Initialize an F0 curve */
-static int f0_curve_init(F0Curve* curve) {
-    curve->capacity = 1000;
-    curve->points = malloc(curve->capacity * sizeof(F0Point));
-    curve->count = 0;
-    return curve->points ? 0 : -1;
+    F0Pair* pairs;
+    const UCRA_AnalysisOptions* options;
+} ListRun;
+
+static void print_usage(const char* program_name) {
+    printf("Usage: %s [options] <ground_truth_file> <estimated_file>\n", program_name);
+    printf("       %s [options] --list <pairs_file>\n", program_name);
+    printf("\n");
+    printf("Calculate F0 Root Mean Square Error (RMSE) between two F0 curves.\n");
+    printf("\n");
+    printf("File format:\n");
+    printf("  Each line: <time_seconds> <frequency_hz>\n");
+    printf("  Comments starting with # are ignored\n");
+    printf("  Binary UCF0 curve files are accepted too\n");
+    printf("  Example:\n");
+    printf("    # Time(sec) F0(Hz)\n");
+    printf("    0.0 261.63\n");
+    printf("    0.1 262.45\n");
+    printf("  A .wav file has its F0 estimated with WORLD (WORLD builds only)\n");
+    printf("\n");
+    printf("Options:\n");
+    printf("  --list FILE        Score every \"<ground_truth> <estimated>\" line of FILE\n");
+    printf("  -j N               Worker threads for --list (default: 0, one per CPU)\n");
+    printf("  --f0-estimator E   harvest or dio, for .wav inputs (default: harvest)\n");
+    printf("  --frame-period MS  Estimation hop in milliseconds (default: %.1f)\n",
+           UCRA_ANALYSIS_DEFAULT_FRAME_PERIOD);
+    printf("\n");
+    printf("Output:\n");
+    printf("  F0 RMSE value in Hz\n");
 }
 
-/* Add a point to the F0 curve */
-static int f0_curve_add_point(F0Curve* curve, double time, double f0) {
-    if (curve->count >= curve->capacity) {
-        curve->capacity *= 2;
-        F0Point* new_points = realloc(curve->points, curve->capacity * sizeof(F0Point));
-        if (!new_points) {
-            return -1;
-        }
-        curve->points = new_points;
+/* Load one input into an initialized curve */
+static int load_input(const char* filename, const UCRA_AnalysisOptions* options, F0Curve* curve) {
+    if (f0_curve_init(curve) < 0) {
+        fprintf(stderr, "Error: Memory allocation failed for curve '%s'\n", filename);
+        return -1;
+    }
+    if (load_f0_input(filename, options, curve) < 0) {
+        f0_curve_free(curve);
+        return -1;
     }
-
-    curve->points[curve->count].time = time;
-    curve->points[curve->count].f0 = f0;
-    curve->count++;
     return 0;
 }
 
-/* Free F0 curve memory */
-static void f0_curve_free(F0Curve* curve) {
-    if (curve->points) {
-        free(curve->points);
-        curve->points = NULL;
+static void score_pair(void* ctx, uint32_t job, uint32_t worker) {
+    (void)worker;
+    ListRun* run = (ListRun*)ctx;
+    F0Pair* pair = &run->pairs[job];
+    F0Curve ground_truth, estimated;
+    pair->rmse = -1.0;
+    if (load_input(pair->ground_truth, run->options, &ground_truth) < 0) {
+        return;
+    }
+    if (load_input(pair->estimated, run->options, &estimated) == 0) {
+        pair->rmse = calculate_f0_rmse(&ground_truth, &estimated, &pair->stats);
+        f0_curve_free(&estimated);
     }
-    curve->count = 0;
-    curve->capacity = 0;
+    f0_curve_free(&ground_truth);
 }
 
-/* Load F0 curve from file */
-static int load_f0_curve(const char* filename, F0Curve* curve) {
+/* Read the pairs of a list file; returns the count, or -1 */
+static int read_pair_list(const char* filename, F0Pair** out_pairs) {
     FILE* file = fopen(filename, "r");
     if (!file) {
-        fprintf(stderr, "Error: Cannot open file '%s': %s\n", filename, strerror(errno));
+        fprintf(stderr, "Error: Cannot open list file '%s'\n", filename);
         return -1;
     }
-
-    char line[MAX_LINE_LENGTH];
-    int line_number = 0;
-
+    F0Pair* pairs = NULL;
+    int count = 0, capacity = 0;
+    char line[2 * MAX_PATH + 64];
     while (fgets(line, sizeof(line), file)) {
-        line_number++;
-
-        /* Skip comments and empty lines */
-        if (line[0] == '#' || line[0] == '\n' || line[0] == '\r') {
+        char* p = line + strspn(line, " \t");
+        if (*p == '#' || *p == '\n' || *p == '\r' || *p == '\0') {
             continue;
         }
-
-        double time, f0;
-        if (sscanf(line, "%lf %lf", &time, &f0) == 2) {
-            if (f0_curve_add_point(curve, time, f0) < 0) {
-                fprintf(stderr, "Error: Memory allocation failed at line %d\n", line_number);
+        if (count == capacity) {
+            capacity = capacity ? capacity * 2 : 64;
+            F0Pair* grown = realloc(pairs, (size_t)capacity * sizeof(F0Pair));
+            if (!grown) {
+                fprintf(stderr, "Error: Memory allocation failed for the pair list\n");
+                free(pairs);
                 fclose(file);
                 return -1;
             }
-        } else {
-            fprintf(stderr, "Warning: Invalid line format at line %d: %s", line_number, line);
+            pairs = grown;
         }
+        if (sscanf(p, "%4095s %4095s", pairs[count].ground_truth, pairs[count].estimated) != 2) {
+            fprintf(stderr, "Error: Expected two files on list line: %s", p);
+            free(pairs);
+            fclose(file);
+            return -1;
+        }
+        count++;
     }
-
     fclose(file);
-
-    if (curve->count == 0) {
-        fprintf(stderr, "Error: No valid data points found in file '%s'\n", filename);
-        return -1;
-    }
-
-    printf("Loaded %d F0 points from '%s'\n", curve->count, filename);
-    return 0;
+    *out_pairs = pairs;
+    return count;
 }
 
-/* Linear interpolation to get F0 value at specific time */
-static double interpolate_f0(const F0Curve* curve, double target_time) {
-    if (curve->count == 0) {
-        return 0.0;
+static int run_list(const char* list_file, int jobs, const UCRA_AnalysisOptions* options) {
+    F0Pair* pairs = NULL;
+    int count = read_pair_list(list_file, &pairs);
+    if (count <= 0) {
+        if (count == 0) fprintf(stderr, "Error: No pairs in list file '%s'\n", list_file);
+        return 1;
     }
 
-    /* Handle edge cases */
-    if (target_time <= curve->points[0].time) {
-        return curve->points[0].f0;
+    UCRA_ThreadPool* pool = NULL;
+    if (jobs != 1 && count > 1 && ucra_pool_create((uint32_t)jobs, &pool) != UCRA_SUCCESS) {
+        fprintf(stderr, "Warning: Cannot start %d workers; scoring pairs one at a time\n", jobs);
+        pool = NULL;
     }
-    if (target_time >= curve->points[curve->count - 1].time) {
-        return curve->points[curve->count - 1].f0;
-    }
-
-    /* Find surrounding points and interpolate */
-    for (int i = 0; i < curve->count - 1; i++) {
-        if (target_time >= curve->points[i].time && target_time <= curve->points[i + 1].time) {
-            double t1 = curve->points[i].time;
-            double t2 = curve->points[i + 1].time;
-            double f1 = curve->points[i].f0;
-            double f2 = curve->points[i + 1].f0;
-
-            /* Linear interpolation */
-            double alpha = (target_time - t1) / (t2 - t1);
-            return f1 + alpha * (f2 - f1);
+    printf("Scoring %d pairs on %u workers...\n\n", count, ucra_pool_size(pool));
+    ListRun run = { pairs, options };
+    ucra_pool_run(pool, (uint32_t)count, score_pair, &run);
+    ucra_pool_destroy(pool);
+
+    int failed = 0;
+    double sum = 0.0;
+    for (int i = 0; i < count; i++) {
+        if (pairs[i].rmse < 0.0) {
+            printf("%s %s FAILED\n", pairs[i].ground_truth, pairs[i].estimated);
+            failed++;
+        } else {
+            printf("%s %s F0 RMSE: %.6f Hz (%d samples)\n", pairs[i].ground_truth, pairs[i].estimated,
+                   pairs[i].rmse, pairs[i].stats.samples);
+            sum += pairs[i].rmse;
         }
     }
-
-    return 0.0; /* Should not reach here */
-}
-
-/* Calculate F0 RMSE between two curves */
-static double calculate_f0_rmse(const F0Curve* ground_truth, const F0Curve* estimated) {
-    /* Determine time range */
-    double min_time = fmax(ground_truth->points[0].time, estimated->points[0].time);
-    double max_time = fmin(ground_truth->points[ground_truth->count - 1].time,
-                          estimated->points[estimated->count - 1].time);
-
-    if (min_time >= max_time) {
-        fprintf(stderr, "Error: No overlapping time range between curves\n");
-        return -1.0;
-    }
-
-    /* Calculate RMSE using fixed time step */
-    double time_step = 0.01; /* 10ms intervals */
-    double sum_squared_error = 0.0;
-    int sample_count = 0;
-
-    for (double t = min_time; t <= max_time; t += time_step) {
-        double gt_f0 = interpolate_f0(ground_truth, t);
-        double est_f0 = interpolate_f0(estimated, t);
-
-        /* Skip unvoiced regions (F0 = 0) */
-        if (gt_f0 > 0.0 && est_f0 > 0.0) {
-            double error = gt_f0 - est_f0;
-            sum_squared_error += error * error;
-            sample_count++;
-        }
+    if (failed < count) {
+        printf("\nMean F0 RMSE: %.6f Hz over %d pairs\n", sum / (count - failed), count - failed);
     }
-
-    if (sample_count == 0) {
-        fprintf(stderr, "Error: No voiced regions found for comparison\n");
-        return -1.0;
+    if (failed > 0) {
+        printf("%d of %d pairs failed\n", failed, count);
     }
-
-    double mse = sum_squared_error / sample_count;
-    double rmse = sqrt(mse);
-
-    printf("Compared %d samples over %.3f seconds\n", sample_count, max_time - min_time);
-    printf("Mean Squared Error: %.6f Hz²\n", mse);
-
-    return rmse;
-}
-
-static void print_usage(const char* program_name) {
-    printf("Usage: %s <ground_truth_file> <estimated_file>\n", program_name);
-    printf("\n");
-    printf("Calculate F0 Root Mean Square Error (RMSE) between two F0 curves.\n");
-    printf("\n");
-    printf("File format:\n");
-    printf("  Each line: <time_seconds> <frequency_hz>\n");
-    printf("  Comments starting with # are ignored\n");
-    printf("  Example:\n");
-    printf("    # Time(sec) F0(Hz)\n");
-    printf("    0.0 261.63\n");
-    printf("    0.1 262.45\n");
-    printf("\n");
-    printf("Output:\n");
-    printf("  F0 RMSE value in Hz\n");
+    free(pairs);
+    return failed > 0 ? 1 : 0;
 }
 
 int main(int argc, char* argv[]) {
-    if (argc != 3) {
+    UCRA_AnalysisOptions options;
+    f0_estimate_options_init(&options);
+    const char* list_file = NULL;
+    const char* files[2];
+    int file_count = 0;
+    int jobs = 0;
+
+    for (int i = 1; i < argc; i++) {
+        int has_value = i + 1 < argc;
+        if (strcmp(argv[i], "--list") == 0 && has_value) {
+            list_file = argv[++i];
+        } else if (strcmp(argv[i], "-j") == 0 && has_value) {
+            jobs = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--frame-period") == 0 && has_value) {
+            options.frame_period = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--f0-estimator") == 0 && has_value) {
+            const char* name = argv[++i];
+            if (strcmp(name, "harvest") == 0) {
+                options.f0_method = UCRA_ANALYSIS_F0_HARVEST;
+            } else if (strcmp(name, "dio") == 0) {
+                options.f0_method = UCRA_ANALYSIS_F0_DIO;
+            } else {
+                fprintf(stderr, "Error: Unknown F0 estimator '%s'\n", name);
+                return 1;
+            }
+        } else if (argv[i][0] == '-' || file_count == 2) {
+            print_usage(argv[0]);
+            return 1;
+        } else {
+            files[file_count++] = argv[i];
+        }
+    }
+    if ((list_file != NULL) == (file_count == 2) || jobs < 0 || !(options.frame_period > 0.0)) {
         print_usage(argv[0]);
         return 1;
     }
 
-    const char* ground_truth_file = argv[1];
-    const char* estimated_file = argv[2];
+    if (list_file) {
+        return run_list(list_file, jobs, &options);
+    }
+
+    const char* ground_truth_file = files[0];
+    const char* estimated_file = files[1];
 
     /* Load F0 curves */
     F0Curve ground_truth, estimated;
 
-    if (f0_curve_init(&ground_truth) < 0) {
-        fprintf(stderr, "Error: Memory allocation failed for ground truth curve\n");
-        return 1;
-    }
-
-    if (f0_curve_init(&estimated) < 0) {
-        fprintf(stderr, "Error: Memory allocation failed for estimated curve\n");
-        f0_curve_free(&ground_truth);
-        return 1;
-    }
-
     /* Load data */
     printf("Loading ground truth F0 curve from '%s'...\n", ground_truth_file);
-    if (load_f0_curve(ground_truth_file, &ground_truth) < 0) {
-        f0_curve_free(&ground_truth);
-        f0_curve_free(&estimated);
+    if (load_input(ground_truth_file, &options, &ground_truth) < 0) {
         return 1;
     }
+    printf("Loaded %d F0 points from '%s'\n", ground_truth.count, ground_truth_file);
 
     printf("Loading estimated F0 curve from '%s'...\n", estimated_file);
-    if (load_f0_curve(estimated_file, &estimated) < 0) {
+    if (load_input(estimated_file, &options, &estimated) < 0) {
         f0_curve_free(&ground_truth);
-        f0_curve_free(&estimated);
         return 1;
     }
+    printf("Loaded %d F0 points from '%s'\n", estimated.count, estimated_file);
 
     /* Calculate RMSE */
     printf("\nCalculating F0 RMSE...\n");
-    double rmse = calculate_f0_rmse(&ground_truth, &estimated);
+    F0RMSEStats stats;
+    double rmse = calculate_f0_rmse(&ground_truth, &estimated, &stats);
+    if (rmse >= 0.0) {
+        printf("Compared %d samples over %.3f seconds\n", stats.samples, stats.duration_sec);
+        printf("Mean Squared Error: %.6f Hz²\n", stats.mse);
+    }
 
     /* Cleanup */
     f0_curve_free(&ground_truth);
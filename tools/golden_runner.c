@@ -5,15 +5,41 @@
  * for the UCRA rendering engine. It compares rendered outputs against
  * pre-recorded 'golden' reference files.
  *
- * Usage: golden_runner [test_directory]
+ * Usage: golden_runner [--in-process] [-j N] [--cases FILE] [--results FILE] [test_directory]
  *
  * Test directory structure:
  *   test_case_001/
  *     input.json         - Render configuration
  *     expected_output.wav - Golden reference WAV
- *     f0_curve.txt       - Optional F0 curve for F0 RMSE test
+ *     f0_curve.txt       - Optional F0 curve for F0 RMSE test; it is compared
+ *                          with actual_f0_curve.txt if present, otherwise with
+ *                          the F0 that WORLD estimates from the render
  *   test_case_002/
  *     ...
+ *
+ * By default each stage runs as its own process (resampler, audio_compare,
+ * f0_rmse_calc and mcd_calc). With --in-process the cases are rendered
+ * through the UCRA engine and scored with the same comparison code the
+ * tools use, linked into this binary: every WAV is loaded once and cases
+ * run on -j N workers.
+ *
+ * --cases FILE runs only the cases named in FILE, one per line; --results FILE
+ * writes each case's outcome as JSON, for validation_suite to cache:
+ *   [ { "name": "...", "passed": true, "audio_diff_score": 0.0, "f0_rmse": -1,
+ *       "mcd_score": 0.1, "runtime": 0.25, "error": "" } ]
+ * where -1 marks a metric that was not computed.
+ *
+ * input.json for --in-process:
+ *   {
+ *     "sample_rate": 44100,            optional, default 44100
+ *     "channels": 1,                   optional, default 1
+ *     "block_size": 512,               optional, default 512
+ *     "notes": [                       required, at least one
+ *       { "start_sec": 0.0, "duration_sec": 1.0, "midi_note": 60,
+ *         "velocity": 100, "lyric": "a" }
+ *     ],
+ *     "options": { "key": "value" }    optional engine options
+ *   }
  */
 
 #include <stdio.h>
@@ -21,9 +47,15 @@
 #include <string.h>
 #include <errno.h>
 #include <sys/stat.h>
+#include <sys/wait.h>
 #include <dirent.h>
 #include <unistd.h>
 #include "../third-party/cJSON.h"
+#include "ucra/ucra.h"
+#include "ucra_threads.h"
+#include "audio_metrics.h"
+#include "f0_metrics.h"
+#include "mcd_metrics.h"
 
 #define MAX_PATH 512
 #define MAX_TEST_CASES 1000
@@ -55,8 +87,15 @@ typedef struct {
     double audio_diff_score;
     double f0_rmse;
     double mcd_score;
+    double runtime;        /* seconds spent on the case */
 } TestResult;
 
+/* Case names given with --cases */
+typedef struct {
+    char** names;
+    int count;
+} CaseFilter;
+
 /* Initialize test suite */
 static int test_suite_init(TestSuite* suite, const char* base_dir) {
     suite->capacity = 100;
@@ -136,8 +175,69 @@ static int add_test_case(TestSuite* suite, const char* test_name, const char* te
     return 1;
 }
 
-/* Discover test cases in directory */
-static int discover_test_cases(TestSuite* suite) {
+/* Read the case names of a --cases file, one per line */
+static int case_filter_load(CaseFilter* filter, const char* path) {
+    filter->names = NULL;
+    filter->count = 0;
+    FILE* file = fopen(path, "r");
+    if (!file) {
+        fprintf(stderr, "Error: Cannot open case list '%s': %s\n", path, strerror(errno));
+        return -1;
+    }
+    char line[MAX_PATH];
+    int capacity = 0;
+    while (fgets(line, sizeof(line), file)) {
+        line[strcspn(line, "\r\n")] = '\0';
+        if (line[0] == '\0') {
+            continue;
+        }
+        if (filter->count == capacity) {
+            capacity = capacity ? capacity * 2 : 16;
+            char** names = realloc(filter->names, (size_t)capacity * sizeof(char*));
+            if (!names) {
+                break;
+            }
+            filter->names = names;
+        }
+        filter->names[filter->count] = strdup(line);
+        if (!filter->names[filter->count]) {
+            break;
+        }
+        filter->count++;
+    }
+    int failed = !feof(file);
+    fclose(file);
+    if (failed) {
+        fprintf(stderr, "Error: Cannot read case list '%s'\n", path);
+        return -1;
+    }
+    return 0;
+}
+
+static void case_filter_free(CaseFilter* filter) {
+    for (int i = 0; i < filter->count; i++) {
+        free(filter->names[i]);
+    }
+    free(filter->names);
+    filter->names = NULL;
+    filter->count = 0;
+}
+
+/* Whether name is selected; no filter selects every case */
+static int case_filter_match(const CaseFilter* filter, const char* name) {
+    if (!filter) {
+        return 1;
+    }
+    for (int i = 0; i < filter->count; i++) {
+        if (strcmp(filter->names[i], name) == 0) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/* Discover test cases in directory, keeping those filter selects */
+static int discover_test_cases(TestSuite* suite, const CaseFilter* filter) {
     DIR* dir = opendir(suite->base_directory);
     if (!dir) {
         fprintf(stderr, "Error: Cannot open test directory '%s': %s\n",
@@ -156,7 +256,7 @@ static int discover_test_cases(TestSuite* suite) {
         char test_dir[MAX_PATH];
         snprintf(test_dir, MAX_PATH, "%s/%s", suite->base_directory, entry->d_name);
 
-        if (dir_exists(test_dir)) {
+        if (dir_exists(test_dir) && case_filter_match(filter, entry->d_name)) {
             add_test_case(suite, entry->d_name, test_dir);
         }
     }
@@ -206,19 +306,18 @@ static int run_audio_comparison(const TestCase* test, TestResult* result) {
              "./audio_compare '%s' '%s' > '%s'",
              test->expected_wav, test->actual_output, temp_output);
 
-    int exit_code = system(command);
+    int status = system(command);
+    int exit_code = (status != -1 && WIFEXITED(status)) ? WEXITSTATUS(status) : 3;
 
-    /* Read the comparison result */
+    /* Read the RMS difference; identical files print none */
+    result->audio_diff_score = (exit_code == 0) ? 0.0 : -1.0;
     FILE* file = fopen(temp_output, "r");
     if (file) {
         char line[256];
-        if (fgets(line, sizeof(line), file)) {
-            if (strstr(line, "PASS")) {
-                result->audio_diff_score = 0.0;
-                return 0;
-            } else if (strstr(line, "FAIL")) {
-                sscanf(line, "FAIL: %lf", &result->audio_diff_score);
-                return 1;
+        while (fgets(line, sizeof(line), file)) {
+            if (strstr(line, "RMS difference:")) {
+                sscanf(strstr(line, "RMS difference:"), "RMS difference: %lf", &result->audio_diff_score);
+                break;
             }
         }
         fclose(file);
@@ -227,7 +326,8 @@ static int run_audio_comparison(const TestCase* test, TestResult* result) {
     /* Remove temporary file */
     unlink(temp_output);
 
-    return (exit_code == 0) ? 0 : 1;
+    /* audio_compare passes identical files (0) and files within tolerance (1) */
+    return (exit_code == 0 || exit_code == 1) ? 0 : 1;
 }
 
 /* Run F0 RMSE calculation */
@@ -243,14 +343,13 @@ static int run_f0_rmse(const TestCase* test, TestResult* result) {
     /* Create temporary file for F0 RMSE output */
     snprintf(temp_output, MAX_PATH, "%s/f0_rmse.txt", test->directory);
 
-    /* We need another F0 curve from the actual output for comparison */
-    /* For now, skip F0 RMSE if no reference curve */
+    /* Compare with a precomputed curve of the actual output if there is one; otherwise
+     * f0_rmse_calc estimates it from the render (WORLD builds only) */
     char actual_f0_curve[MAX_PATH];
     snprintf(actual_f0_curve, MAX_PATH, "%s/actual_f0_curve.txt", test->directory);
 
     if (!file_exists(actual_f0_curve)) {
-        result->f0_rmse = -1.0; /* Not available */
-        return 0;
+        snprintf(actual_f0_curve, MAX_PATH, "%s", test->actual_output);
     }
 
     snprintf(command, MAX_COMMAND_LENGTH,
@@ -311,6 +410,29 @@ static int run_mcd(const TestCase* test, TestResult* result) {
     return (exit_code == 0) ? 0 : 1;
 }
 
+/* Print the outcome of a case as it finishes */
+static void print_case_result(const TestResult* result) {
+    if (result->passed) {
+        printf("✓ PASS: %s\n", result->test_name);
+    } else {
+        printf("✗ FAIL: %s\n", result->test_name);
+        if (result->audio_diff_score >= 0) {
+            printf("  Audio difference: %.6f\n", result->audio_diff_score);
+        }
+        if (strlen(result->error_message) > 0) {
+            printf("  Error: %s\n", result->error_message);
+        }
+    }
+
+    if (result->f0_rmse >= 0) {
+        printf("  F0 RMSE: %.6f Hz\n", result->f0_rmse);
+    }
+
+    if (result->mcd_score >= 0) {
+        printf("  MCD: %.6f dB\n", result->mcd_score);
+    }
+}
+
 /* Run a single test case */
 static TestResult run_test_case(const TestCase* test) {
     TestResult result = {0};
@@ -318,6 +440,7 @@ static TestResult run_test_case(const TestCase* test) {
     result.audio_diff_score = -1.0;
     result.f0_rmse = -1.0;
     result.mcd_score = -1.0;
+    uint64_t start_ns = ucra_time_ns();
 
     printf("\n=== Running test case: %s ===\n", test->name);
 
@@ -325,6 +448,7 @@ static TestResult run_test_case(const TestCase* test) {
     if (execute_render(test) < 0) {
         strcpy(result.error_message, "Rendering failed");
         result.passed = 0;
+        result.runtime = (ucra_time_ns() - start_ns) / 1e9;
         return result;
     }
 
@@ -339,25 +463,287 @@ static TestResult run_test_case(const TestCase* test) {
 
     /* Determine overall pass/fail */
     result.passed = (audio_pass == 0);
+    result.runtime = (ucra_time_ns() - start_ns) / 1e9;
 
-    if (result.passed) {
-        printf("✓ PASS: %s\n", test->name);
-    } else {
-        printf("✗ FAIL: %s\n", test->name);
-        if (result.audio_diff_score >= 0) {
-            printf("  Audio difference: %.6f\n", result.audio_diff_score);
+    print_case_result(&result);
+
+    return result;
+}
+
+/* A parsed input.json; the strings point into json */
+typedef struct {
+    cJSON* json;
+    UCRA_NoteSegment* notes;
+    UCRA_KeyValue* options;
+    UCRA_RenderConfig config;
+} RenderSpec;
+
+static void render_spec_free(RenderSpec* spec) {
+    cJSON_Delete(spec->json);
+    free(spec->notes);
+    free(spec->options);
+    memset(spec, 0, sizeof(*spec));
+}
+
+static double json_number(const cJSON* object, const char* key, double fallback) {
+    const cJSON* item = cJSON_GetObjectItem(object, key);
+    return cJSON_IsNumber(item) ? item->valuedouble : fallback;
+}
+
+/* Read input.json into spec; fills error and returns -1 if it is not a render configuration.
+ * cJSON_Parse records errors in a global, so parses are serialized on lock */
+static int load_render_spec(const char* path, UCRA_Mutex* lock, RenderSpec* spec, char* error, size_t error_size) {
+    memset(spec, 0, sizeof(*spec));
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        snprintf(error, error_size, "Cannot open input.json: %s", strerror(errno));
+        return -1;
+    }
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    char* text = size >= 0 ? malloc((size_t)size + 1) : NULL;
+    size_t got = text ? fread(text, 1, (size_t)size, file) : 0;
+    fclose(file);
+    if (!text) {
+        snprintf(error, error_size, "Cannot read input.json");
+        return -1;
+    }
+    text[got] = '\0';
+    ucra_mutex_lock(lock);
+    spec->json = cJSON_Parse(text);
+    ucra_mutex_unlock(lock);
+    free(text);
+    if (!spec->json) {
+        snprintf(error, error_size, "Invalid JSON in input.json");
+        return -1;
+    }
+
+    const cJSON* notes = cJSON_GetObjectItem(spec->json, "notes");
+    int note_count = cJSON_IsArray(notes) ? cJSON_GetArraySize(notes) : 0;
+    if (note_count <= 0) {
+        snprintf(error, error_size, "input.json has no notes");
+        render_spec_free(spec);
+        return -1;
+    }
+    spec->notes = calloc((size_t)note_count, sizeof(UCRA_NoteSegment));
+    if (!spec->notes) {
+        snprintf(error, error_size, "Out of memory");
+        render_spec_free(spec);
+        return -1;
+    }
+    for (int i = 0; i < note_count; i++) {
+        const cJSON* item = cJSON_GetArrayItem(notes, i);
+        UCRA_NoteSegment* note = &spec->notes[i];
+        const cJSON* lyric = cJSON_GetObjectItem(item, "lyric");
+        note->start_sec = json_number(item, "start_sec", 0.0);
+        note->duration_sec = json_number(item, "duration_sec", 0.0);
+        note->midi_note = (int16_t)json_number(item, "midi_note", -1);
+        note->velocity = (uint8_t)json_number(item, "velocity", 100);
+        note->lyric = cJSON_IsString(lyric) ? lyric->valuestring : NULL;
+        if (!cJSON_IsObject(item) || note->duration_sec <= 0.0) {
+            snprintf(error, error_size, "Note %d in input.json needs a positive duration_sec", i + 1);
+            render_spec_free(spec);
+            return -1;
         }
     }
 
-    if (result.f0_rmse >= 0) {
-        printf("  F0 RMSE: %.6f Hz\n", result.f0_rmse);
+    const cJSON* options = cJSON_GetObjectItem(spec->json, "options");
+    int option_count = cJSON_IsObject(options) ? cJSON_GetArraySize(options) : 0;
+    if (option_count > 0) {
+        spec->options = calloc((size_t)option_count, sizeof(UCRA_KeyValue));
+        if (!spec->options) {
+            snprintf(error, error_size, "Out of memory");
+            render_spec_free(spec);
+            return -1;
+        }
+        int used = 0;
+        for (const cJSON* item = options->child; item; item = item->next) {
+            if (!cJSON_IsString(item)) {
+                snprintf(error, error_size, "Option '%s' in input.json is not a string", item->string);
+                render_spec_free(spec);
+                return -1;
+            }
+            spec->options[used].key = item->string;
+            spec->options[used].value = item->valuestring;
+            used++;
+        }
     }
 
-    if (result.mcd_score >= 0) {
-        printf("  MCD: %.6f dB\n", result.mcd_score);
+    double sample_rate = json_number(spec->json, "sample_rate", 44100);
+    double channels = json_number(spec->json, "channels", 1);
+    double block_size = json_number(spec->json, "block_size", 512);
+    if (sample_rate < 1 || sample_rate > 768000 || channels < 1 || channels > 64 || block_size < 1) {
+        snprintf(error, error_size, "Invalid sample_rate, channels or block_size in input.json");
+        render_spec_free(spec);
+        return -1;
     }
+    spec->config.sample_rate = (uint32_t)sample_rate;
+    spec->config.channels = (uint32_t)channels;
+    spec->config.block_size = (uint32_t)block_size;
+    spec->config.notes = spec->notes;
+    spec->config.note_count = (uint32_t)note_count;
+    spec->config.options = spec->options;
+    spec->config.option_count = (uint32_t)option_count;
+    return 0;
+}
 
-    return result;
+/* Shared by the in-process jobs */
+typedef struct {
+    const TestSuite* suite;
+    TestResult* results;
+    UCRA_Handle* engines;  /* one per pool worker, created on first use */
+    UCRA_Mutex lock;       /* held to print a result or parse input.json */
+} InProcessRun;
+
+/* Write the render beside the case, as the resampler would, for inspection */
+static int write_actual_output(const TestCase* test, const UCRA_RenderResult* rendered) {
+    UCRA_WavWriterHandle writer = NULL;
+    if (ucra_wav_writer_open(&writer, test->actual_output, rendered->sample_rate, rendered->channels,
+                             UCRA_SAMPLE_FLOAT32, 0) != UCRA_SUCCESS) {
+        return -1;
+    }
+    UCRA_Result written = ucra_wav_writer_write(writer, rendered->pcm, rendered->frames);
+    UCRA_Result closed = ucra_wav_writer_close(writer);
+    return written == UCRA_SUCCESS && closed == UCRA_SUCCESS ? 0 : -1;
+}
+
+/* F0 RMSE between f0_curve.txt and actual_f0_curve.txt, or the F0 estimated
+ * from the render when there is no actual_f0_curve.txt and WORLD is built in */
+static double in_process_f0_rmse(const TestCase* test, const AudioData* actual) {
+    char actual_f0_curve[MAX_PATH];
+    int length = snprintf(actual_f0_curve, MAX_PATH, "%s/actual_f0_curve.txt", test->directory);
+    if (length < 0 || length >= MAX_PATH) {
+        return -1.0; /* the path does not fit: no curve to compare */
+    }
+    int have_curve = file_exists(actual_f0_curve);
+    if (!file_exists(test->f0_curve) || (!have_curve && !f0_estimation_available())) {
+        return -1.0;
+    }
+
+    F0Curve ground_truth, estimated;
+    if (f0_curve_init(&ground_truth) < 0) {
+        return -1.0;
+    }
+    if (f0_curve_init(&estimated) < 0) {
+        f0_curve_free(&ground_truth);
+        return -1.0;
+    }
+    UCRA_AnalysisOptions options;
+    f0_estimate_options_init(&options);
+    double rmse = -1.0;
+    if (load_f0_curve(test->f0_curve, &ground_truth) == 0 &&
+        (have_curve ? load_f0_curve(actual_f0_curve, &estimated)
+                    : f0_curve_from_samples(actual->samples, (uint32_t)actual->length, (uint32_t)actual->sample_rate,
+                                            &options, &estimated)) == 0) {
+        rmse = calculate_f0_rmse(&ground_truth, &estimated, NULL);
+    }
+    f0_curve_free(&ground_truth);
+    f0_curve_free(&estimated);
+    return rmse;
+}
+
+/* MCD of the render against the golden WAV; each extraction runs on this worker alone */
+static double in_process_mcd(const AudioData* expected, const AudioData* actual) {
+    MFCCMatrix ref_mfcc, syn_mfcc;
+    if (extract_mfcc(expected, NULL, &ref_mfcc) < 0) {
+        return -1.0;
+    }
+    if (extract_mfcc(actual, NULL, &syn_mfcc) < 0) {
+        mfcc_matrix_free(&ref_mfcc);
+        return -1.0;
+    }
+    double mcd = calculate_mcd(&ref_mfcc, &syn_mfcc, 1, 0, NULL);
+    mfcc_matrix_free(&ref_mfcc);
+    mfcc_matrix_free(&syn_mfcc);
+    return mcd;
+}
+
+/* Render one case on this worker's engine and score it against its golden WAV */
+static void run_in_process_job(void* ctx, uint32_t job, uint32_t worker) {
+    InProcessRun* run = (InProcessRun*)ctx;
+    const TestCase* test = &run->suite->cases[job];
+    TestResult* result = &run->results[job];
+    memset(result, 0, sizeof(*result));
+    strncpy(result->test_name, test->name, MAX_PATH - 1);
+    result->audio_diff_score = -1.0;
+    result->f0_rmse = -1.0;
+    result->mcd_score = -1.0;
+    uint64_t start_ns = ucra_time_ns();
+
+    RenderSpec spec;
+    AudioData expected, actual;
+    audio_data_init(&expected);
+    audio_data_init(&actual);
+
+    if (!run->engines[worker] && ucra_engine_create(&run->engines[worker], NULL, 0) != UCRA_SUCCESS) {
+        run->engines[worker] = NULL;
+        strcpy(result->error_message, "Cannot create engine");
+    } else if (load_render_spec(test->input_config, &run->lock, &spec, result->error_message,
+                                sizeof(result->error_message)) == 0) {
+        UCRA_RenderResult rendered = {0};
+        UCRA_Result status = ucra_render(run->engines[worker], &spec.config, &rendered);
+        if (status != UCRA_SUCCESS || !rendered.pcm || rendered.frames == 0) {
+            snprintf(result->error_message, sizeof(result->error_message), "Rendering failed (error %d)", status);
+        } else if (write_actual_output(test, &rendered) < 0) {
+            strcpy(result->error_message, "Cannot write actual_output.wav");
+        } else if (audio_data_from_pcm(rendered.pcm, rendered.frames, rendered.channels, rendered.sample_rate,
+                                       &actual) < 0 || load_wav_file(test->expected_wav, &expected) < 0) {
+            strcpy(result->error_message, "Cannot load audio for comparison");
+        } else {
+            ComparisonResult comparison = {0};
+            compare_audio_data(&expected, &actual, &comparison);
+            if (comparison.rms_difference < 0.0) {
+                strcpy(result->error_message, "Audio comparison failed");
+            } else {
+                result->audio_diff_score = comparison.identical ? 0.0 : comparison.rms_difference;
+                result->passed = audio_within_tolerance(&comparison);
+            }
+            result->f0_rmse = in_process_f0_rmse(test, &actual);
+            result->mcd_score = in_process_mcd(&expected, &actual);
+        }
+        render_spec_free(&spec);
+    }
+
+    audio_data_free(&expected);
+    audio_data_free(&actual);
+    result->runtime = (ucra_time_ns() - start_ns) / 1e9;
+
+    ucra_mutex_lock(&run->lock);
+    print_case_result(result);
+    fflush(stdout);
+    ucra_mutex_unlock(&run->lock);
+}
+
+/* Run every case in-process on a pool of jobs workers (0 for one per CPU) */
+static int run_in_process(const TestSuite* suite, TestResult* results, int jobs) {
+    UCRA_ThreadPool* pool = NULL;
+    if (jobs != 1 && ucra_pool_create((uint32_t)jobs, &pool) != UCRA_SUCCESS) {
+        fprintf(stderr, "Warning: Cannot start %d workers; running cases one at a time\n", jobs);
+        pool = NULL;
+    }
+
+    InProcessRun run;
+    run.suite = suite;
+    run.results = results;
+    run.engines = calloc(ucra_pool_size(pool), sizeof(UCRA_Handle));
+    if (!run.engines || ucra_mutex_init(&run.lock) != 0) {
+        fprintf(stderr, "Error: Memory allocation failed for the in-process run\n");
+        free(run.engines);
+        ucra_pool_destroy(pool);
+        return -1;
+    }
+
+    printf("Running %d test cases in-process on %u worker(s)\n\n", suite->count, ucra_pool_size(pool));
+    ucra_pool_run(pool, (uint32_t)suite->count, run_in_process_job, &run);
+
+    for (uint32_t i = 0; i < ucra_pool_size(pool); i++) {
+        ucra_engine_destroy(run.engines[i]);
+    }
+    free(run.engines);
+    ucra_mutex_destroy(&run.lock);
+    ucra_pool_destroy(pool);
+    return 0;
 }
 
 /* Generate test report */
@@ -406,21 +792,68 @@ static void generate_report(const TestResult* results, int num_results) {
     printf("============================================================\n");
 }
 
+/* Write the results as the JSON array described at the top of this file */
+static int write_results_file(const char* path, const TestResult* results, int num_results) {
+    cJSON* array = cJSON_CreateArray();
+    if (!array) {
+        return -1;
+    }
+    for (int i = 0; i < num_results; i++) {
+        const TestResult* result = &results[i];
+        cJSON* item = cJSON_CreateObject();
+        if (!item) {
+            cJSON_Delete(array);
+            return -1;
+        }
+        cJSON_AddStringToObject(item, "name", result->test_name);
+        cJSON_AddBoolToObject(item, "passed", result->passed);
+        cJSON_AddNumberToObject(item, "audio_diff_score", result->audio_diff_score);
+        cJSON_AddNumberToObject(item, "f0_rmse", result->f0_rmse);
+        cJSON_AddNumberToObject(item, "mcd_score", result->mcd_score);
+        cJSON_AddNumberToObject(item, "runtime", result->runtime);
+        cJSON_AddStringToObject(item, "error", result->error_message);
+        cJSON_AddItemToArray(array, item);
+    }
+
+    char* text = cJSON_PrintUnformatted(array);
+    cJSON_Delete(array);
+    if (!text) {
+        return -1;
+    }
+    FILE* file = fopen(path, "w");
+    int failed = !file || fputs(text, file) < 0;
+    if (file && fclose(file) != 0) {
+        failed = 1;
+    }
+    free(text);
+    if (failed) {
+        fprintf(stderr, "Error: Cannot write results to '%s'\n", path);
+        return -1;
+    }
+    return 0;
+}
+
 static void print_usage(const char* program_name) {
-    printf("Usage: %s [test_directory]\n", program_name);
+    printf("Usage: %s [--in-process] [-j N] [--cases FILE] [--results FILE] [test_directory]\n", program_name);
     printf("\n");
     printf("Golden Runner Test Harness for UCRA\n");
     printf("\n");
     printf("Arguments:\n");
     printf("  test_directory  Directory containing test cases (default: ./tests/data)\n");
     printf("\n");
+    printf("Options:\n");
+    printf("  --in-process    Render and score cases in this process instead of running the tools\n");
+    printf("  -j, --jobs N    Run N cases at a time with --in-process (0: one per CPU; default: 1)\n");
+    printf("  --cases FILE    Run only the cases named in FILE, one per line\n");
+    printf("  --results FILE  Write each case's result to FILE as JSON\n");
+    printf("\n");
     printf("Test case structure:\n");
     printf("  test_case_XXX/\n");
     printf("    input.json          - Render configuration (required)\n");
     printf("    expected_output.wav - Golden reference WAV (required)\n");
     printf("    f0_curve.txt        - F0 curve for RMSE test (optional)\n");
     printf("\n");
-    printf("Prerequisites:\n");
+    printf("Prerequisites (without --in-process):\n");
     printf("  - resampler executable in current directory\n");
     printf("  - audio_compare executable in current directory\n");
     printf("  - f0_rmse_calc executable in current directory\n");
@@ -428,10 +861,38 @@ static void print_usage(const char* program_name) {
 }
 
 int main(int argc, char* argv[]) {
-    const char* test_directory = (argc > 1) ? argv[1] : "./tests/data";
-
-    if (argc > 2) {
-        print_usage(argv[0]);
+    const char* test_directory = NULL;
+    const char* cases_file = NULL;
+    const char* results_file = NULL;
+    int in_process = 0;
+    int jobs = 1;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--in-process") == 0) {
+            in_process = 1;
+        } else if ((strcmp(argv[i], "-j") == 0 || strcmp(argv[i], "--jobs") == 0) && i + 1 < argc) {
+            char* end = NULL;
+            long value = strtol(argv[++i], &end, 10);
+            if (!end || *end != '\0' || value < 0 || value > 1024) {
+                fprintf(stderr, "Error: Invalid job count '%s'\n", argv[i]);
+                return 1;
+            }
+            jobs = (int)value;
+        } else if (strcmp(argv[i], "--cases") == 0 && i + 1 < argc) {
+            cases_file = argv[++i];
+        } else if (strcmp(argv[i], "--results") == 0 && i + 1 < argc) {
+            results_file = argv[++i];
+        } else if (argv[i][0] != '-' && !test_directory) {
+            test_directory = argv[i];
+        } else {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+    if (!test_directory) {
+        test_directory = "./tests/data";
+    }
+    if (jobs != 1 && !in_process) {
+        fprintf(stderr, "Error: -j requires --in-process\n");
         return 1;
     }
 
@@ -446,15 +907,23 @@ int main(int argc, char* argv[]) {
     }
 
     /* Discover test cases */
-    if (discover_test_cases(&suite) < 0) {
+    CaseFilter filter = {0};
+    if (cases_file && case_filter_load(&filter, cases_file) < 0) {
+        test_suite_free(&suite);
+        return 1;
+    }
+    int discovered = discover_test_cases(&suite, cases_file ? &filter : NULL);
+    case_filter_free(&filter);
+    if (discovered < 0) {
         test_suite_free(&suite);
         return 1;
     }
 
     if (suite.count == 0) {
         printf("No test cases found in directory '%s'\n", test_directory);
+        int written = results_file ? write_results_file(results_file, NULL, 0) : 0;
         test_suite_free(&suite);
-        return 0;
+        return written < 0 ? 1 : 0;
     }
 
     /* Run test cases */
@@ -465,16 +934,25 @@ int main(int argc, char* argv[]) {
         return 1;
     }
 
-    for (int i = 0; i < suite.count; i++) {
-        results[i] = run_test_case(&suite.cases[i]);
+    if (in_process) {
+        if (run_in_process(&suite, results, jobs) < 0) {
+            free(results);
+            test_suite_free(&suite);
+            return 1;
+        }
+    } else {
+        for (int i = 0; i < suite.count; i++) {
+            results[i] = run_test_case(&suite.cases[i]);
+        }
     }
 
     /* Generate report */
     generate_report(results, suite.count);
+    int written = results_file ? write_results_file(results_file, results, suite.count) : 0;
 
     /* Cleanup */
     free(results);
     test_suite_free(&suite);
 
-    return 0;
+    return written < 0 ? 1 : 0;
 }
@@ -0,0 +1,438 @@
+/*
+ * MCD Metrics
+ *
+ * The window, the FFT twiddles, the mel filterbank and the DCT basis are
+ * computed once per sample rate, and the frames are spread over the UCRA
+ * worker pool. Frames are aligned with DTW inside a Sakoe-Chiba band, or
+ * linearly by index ratio.
+ */
+
+#include "mcd_metrics.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <stdint.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define MCD_SSE2 1
+    #include <emmintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+    #define MCD_NEON 1
+    #include <arm_neon.h>
+#endif
+
+#define MFCC_COEFFS 13
+#define MFCC_STRIDE 16
+#define FRAME_SIZE 1024
+#define HOP_SIZE 512
+#define MEL_FILTERS 26
+#define MIN_FREQ 0.0f
+#define MAX_FREQ 11025.0f
+#define PI 3.14159265358979323846
+#define FFT_HALF (FRAME_SIZE / 2)       /* complex FFT size of the real FFT */
+#define SPECTRUM_BINS (FRAME_SIZE / 2 + 1)
+#define FRAMES_PER_JOB 32
+
+/* Initialize MFCC matrix */
+static int mfcc_matrix_init(MFCCMatrix* mfcc, int num_frames, int num_coeffs) {
+    mfcc->num_frames = num_frames;
+    mfcc->num_coeffs = num_coeffs;
+
+    mfcc->features = calloc((size_t)num_frames * MFCC_STRIDE, sizeof(float));
+    if (!mfcc->features) {
+        return -1;
+    }
+
+    return 0;
+}
+
+void mfcc_matrix_free(MFCCMatrix* mfcc) {
+    free(mfcc->features);
+    mfcc->features = NULL;
+    mfcc->num_frames = 0;
+    mfcc->num_coeffs = 0;
+}
+
+/* Mel scale conversion */
+static float hz_to_mel(float hz) {
+    return 2595.0f * log10f(1.0f + hz / 700.0f);
+}
+
+static float mel_to_hz(float mel) {
+    return 700.0f * (powf(10.0f, mel / 2595.0f) - 1.0f);
+}
+
+/* Everything about the MFCC analysis that does not depend on the frame */
+typedef struct {
+    float window[FRAME_SIZE];              /* Hamming */
+    float twiddle_re[FFT_HALF];            /* exp(-2 pi i k / FRAME_SIZE) */
+    float twiddle_im[FFT_HALF];
+    uint16_t bit_reverse[FFT_HALF];
+    int filter_first[MEL_FILTERS];         /* first spectrum bin of each triangular filter */
+    int filter_count[MEL_FILTERS];         /* bins it spans */
+    int filter_offset[MEL_FILTERS];        /* start of its weights in filter_weights */
+    float* filter_weights;
+    float dct[MFCC_COEFFS][MFCC_COEFFS];   /* DCT-II basis */
+} MFCCPlan;
+
+static void mfcc_plan_free(MFCCPlan* plan) {
+    free(plan->filter_weights);
+    plan->filter_weights = NULL;
+}
+
+static int mfcc_plan_init(MFCCPlan* plan, int sample_rate) {
+    for (int i = 0; i < FRAME_SIZE; i++) {
+        plan->window[i] = 0.54f - 0.46f * cosf(2.0f * PI * i / (FRAME_SIZE - 1));
+    }
+    for (int k = 0; k < FFT_HALF; k++) {
+        double angle = -2.0 * PI * k / FRAME_SIZE;
+        plan->twiddle_re[k] = (float)cos(angle);
+        plan->twiddle_im[k] = (float)sin(angle);
+    }
+    int bits = 0;
+    while ((1 << bits) < FFT_HALF) bits++;
+    for (int i = 0; i < FFT_HALF; i++) {
+        int reversed = 0;
+        for (int b = 0; b < bits; b++) {
+            reversed |= ((i >> b) & 1) << (bits - 1 - b);
+        }
+        plan->bit_reverse[i] = (uint16_t)reversed;
+    }
+
+    /* Triangular filters between mel-spaced points; only the bins inside a filter are kept */
+    float mel_points[MEL_FILTERS + 2];
+    float mel_min = hz_to_mel(MIN_FREQ);
+    float mel_max = hz_to_mel(MAX_FREQ);
+    for (int i = 0; i < MEL_FILTERS + 2; i++) {
+        float mel = mel_min + (mel_max - mel_min) * i / (MEL_FILTERS + 1);
+        mel_points[i] = mel_to_hz(mel);
+    }
+    plan->filter_weights = malloc(MEL_FILTERS * SPECTRUM_BINS * sizeof(float));
+    if (!plan->filter_weights) {
+        return -1;
+    }
+    int used = 0;
+    for (int m = 0; m < MEL_FILTERS; m++) {
+        plan->filter_first[m] = 0;
+        plan->filter_count[m] = 0;
+        plan->filter_offset[m] = used;
+        for (int k = 0; k < SPECTRUM_BINS; k++) {
+            float freq = (float)k * sample_rate / FRAME_SIZE;
+            if (freq < mel_points[m] || freq > mel_points[m + 2]) {
+                continue;
+            }
+            float weight;
+            if (freq <= mel_points[m + 1]) {
+                weight = (freq - mel_points[m]) / (mel_points[m + 1] - mel_points[m]);
+            } else {
+                weight = (mel_points[m + 2] - freq) / (mel_points[m + 2] - mel_points[m + 1]);
+            }
+            if (plan->filter_count[m] == 0) {
+                plan->filter_first[m] = k;
+            }
+            plan->filter_weights[used++] = weight;
+            plan->filter_count[m]++;
+        }
+    }
+
+    /* DCT-II over the first MFCC_COEFFS log mel energies */
+    for (int k = 0; k < MFCC_COEFFS; k++) {
+        for (int n = 0; n < MFCC_COEFFS; n++) {
+            plan->dct[k][n] = cosf(PI * k * (2.0f * n + 1.0f) / (2.0f * MFCC_COEFFS));
+        }
+    }
+    return 0;
+}
+
+/* Power spectrum of a real frame: a FFT_HALF-point complex radix-2 FFT of the even and odd samples,
+ * split into the SPECTRUM_BINS bins of the real transform */
+static void power_spectrum(const MFCCPlan* plan, const float* input, float* re, float* im, float* power) {
+    for (int i = 0; i < FFT_HALF; i++) {
+        int j = plan->bit_reverse[i];
+        re[j] = input[2 * i];
+        im[j] = input[2 * i + 1];
+    }
+    for (int size = 2; size <= FFT_HALF; size <<= 1) {
+        int half = size >> 1;
+        int stride = FRAME_SIZE / size; /* twiddles of exp(-2 pi i / size) */
+        for (int start = 0; start < FFT_HALF; start += size) {
+            for (int k = 0; k < half; k++) {
+                float wr = plan->twiddle_re[k * stride];
+                float wi = plan->twiddle_im[k * stride];
+                int a = start + k, b = a + half;
+                float tr = re[b] * wr - im[b] * wi;
+                float ti = re[b] * wi + im[b] * wr;
+                re[b] = re[a] - tr;
+                im[b] = im[a] - ti;
+                re[a] += tr;
+                im[a] += ti;
+            }
+        }
+    }
+
+    power[0] = (re[0] + im[0]) * (re[0] + im[0]);
+    power[FFT_HALF] = (re[0] - im[0]) * (re[0] - im[0]);
+    for (int k = 1; k < FFT_HALF; k++) {
+        /* even and odd halves from Z[k] and conj(Z[N/2 - k]) */
+        float zr = re[k], zi = im[k];
+        float cr = re[FFT_HALF - k], ci = -im[FFT_HALF - k];
+        float er = 0.5f * (zr + cr), ei = 0.5f * (zi + ci);
+        float or_ = 0.5f * (zi - ci), oi = -0.5f * (zr - cr);
+        float wr = plan->twiddle_re[k], wi = plan->twiddle_im[k];
+        float xr = er + or_ * wr - oi * wi;
+        float xi = ei + or_ * wi + oi * wr;
+        power[k] = xr * xr + xi * xi;
+    }
+}
+
+/* One worker's buffers */
+typedef struct {
+    float windowed[FRAME_SIZE];
+    float re[FFT_HALF];
+    float im[FFT_HALF];
+    float power[SPECTRUM_BINS];
+    float log_mel[MEL_FILTERS];
+} MFCCScratch;
+
+typedef struct {
+    const MFCCPlan* plan;
+    const AudioData* audio;
+    MFCCMatrix* mfcc;
+    MFCCScratch* scratch;  /* one per pool worker */
+} MFCCJob;
+
+static void extract_mfcc_job(void* ctx, uint32_t job, uint32_t worker) {
+    MFCCJob* work = (MFCCJob*)ctx;
+    const MFCCPlan* plan = work->plan;
+    const AudioData* audio = work->audio;
+    MFCCScratch* scratch = &work->scratch[worker];
+    int first = (int)job * FRAMES_PER_JOB;
+    int last = first + FRAMES_PER_JOB < work->mfcc->num_frames ? first + FRAMES_PER_JOB : work->mfcc->num_frames;
+
+    for (int frame_idx = first; frame_idx < last; frame_idx++) {
+        int start_idx = frame_idx * HOP_SIZE;
+        for (int i = 0; i < FRAME_SIZE; i++) {
+            float sample = start_idx + i < audio->length ? audio->samples[start_idx + i] : 0.0f;
+            scratch->windowed[i] = sample * plan->window[i];
+        }
+        power_spectrum(plan, scratch->windowed, scratch->re, scratch->im, scratch->power);
+
+        for (int m = 0; m < MEL_FILTERS; m++) {
+            const float* power = scratch->power + plan->filter_first[m];
+            const float* weights = plan->filter_weights + plan->filter_offset[m];
+            float sum = 0.0f;
+            for (int k = 0; k < plan->filter_count[m]; k++) {
+                sum += power[k] * weights[k];
+            }
+            scratch->log_mel[m] = logf(sum + 1e-10f);
+        }
+
+        float* out = work->mfcc->features + (size_t)frame_idx * MFCC_STRIDE;
+        for (int k = 0; k < MFCC_COEFFS; k++) {
+            float sum = 0.0f;
+            for (int n = 0; n < MFCC_COEFFS; n++) {
+                sum += scratch->log_mel[n] * plan->dct[k][n];
+            }
+            out[k] = sum;
+        }
+    }
+}
+
+int extract_mfcc(const AudioData* audio, UCRA_ThreadPool* pool, MFCCMatrix* mfcc) {
+    if (audio->length < FRAME_SIZE) {
+        fprintf(stderr, "Error: Audio is shorter than one %d-sample frame\n", FRAME_SIZE);
+        return -1;
+    }
+    int num_frames = (audio->length - FRAME_SIZE) / HOP_SIZE + 1;
+
+    if (mfcc_matrix_init(mfcc, num_frames, MFCC_COEFFS) < 0) {
+        return -1;
+    }
+
+    MFCCPlan* plan = calloc(1, sizeof(MFCCPlan));
+    MFCCScratch* scratch = malloc(ucra_pool_size(pool) * sizeof(MFCCScratch));
+    if (!plan || !scratch || mfcc_plan_init(plan, audio->sample_rate) < 0) {
+        fprintf(stderr, "Error: Memory allocation failed for MFCC extraction\n");
+        if (plan) mfcc_plan_free(plan);
+        free(plan);
+        free(scratch);
+        mfcc_matrix_free(mfcc);
+        return -1;
+    }
+
+    MFCCJob job = { plan, audio, mfcc, scratch };
+    ucra_pool_run(pool, (uint32_t)((num_frames + FRAMES_PER_JOB - 1) / FRAMES_PER_JOB), extract_mfcc_job, &job);
+
+    mfcc_plan_free(plan);
+    free(plan);
+    free(scratch);
+
+    return 0;
+}
+
+/* Euclidean distance between two frames over C1-C12; C0 (energy) is left out */
+static double cepstral_distance(const float* a, const float* b) {
+#if defined(MCD_SSE2)
+    __m128 d0 = _mm_sub_ps(_mm_loadu_ps(a + 1), _mm_loadu_ps(b + 1));
+    __m128 d1 = _mm_sub_ps(_mm_loadu_ps(a + 5), _mm_loadu_ps(b + 5));
+    __m128 d2 = _mm_sub_ps(_mm_loadu_ps(a + 9), _mm_loadu_ps(b + 9));
+    __m128 sum = _mm_add_ps(_mm_add_ps(_mm_mul_ps(d0, d0), _mm_mul_ps(d1, d1)), _mm_mul_ps(d2, d2));
+    sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+    sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+    return sqrt((double)_mm_cvtss_f32(sum));
+#elif defined(MCD_NEON)
+    float32x4_t d0 = vsubq_f32(vld1q_f32(a + 1), vld1q_f32(b + 1));
+    float32x4_t d1 = vsubq_f32(vld1q_f32(a + 5), vld1q_f32(b + 5));
+    float32x4_t d2 = vsubq_f32(vld1q_f32(a + 9), vld1q_f32(b + 9));
+    float32x4_t sum = vmlaq_f32(vmlaq_f32(vmulq_f32(d0, d0), d1, d1), d2, d2);
+    return sqrt((double)vaddvq_f32(sum));
+#else
+    float sum = 0.0f;
+    for (int c = 1; c < MFCC_COEFFS; c++) {
+        float diff = a[c] - b[c];
+        sum += diff * diff;
+    }
+    return sqrt((double)sum);
+#endif
+}
+
+/* Linear alignment: frames paired by index ratio */
+static int align_linear(const MFCCMatrix* ref_mfcc, const MFCCMatrix* syn_mfcc,
+                        double* total_distance, int* path_frames) {
+    int ref_frames = ref_mfcc->num_frames;
+    int syn_frames = syn_mfcc->num_frames;
+    int min_frames = (ref_frames < syn_frames) ? ref_frames : syn_frames;
+
+    *total_distance = 0.0;
+    for (int i = 0; i < min_frames; i++) {
+        int ref_idx = (int)(i * (double)ref_frames / min_frames);
+        int syn_idx = (int)(i * (double)syn_frames / min_frames);
+        *total_distance += cepstral_distance(ref_mfcc->features + (size_t)ref_idx * MFCC_STRIDE,
+                                             syn_mfcc->features + (size_t)syn_idx * MFCC_STRIDE);
+    }
+    *path_frames = min_frames;
+    return 0;
+}
+
+/* DTW within a Sakoe-Chiba band of band frames around the diagonal from the
+ * first frame pair to the last. Only two rows of cumulative cost and path
+ * length are kept, so memory grows with the synthesized length alone and time
+ * with the reference length times the band. */
+static int align_dtw(const MFCCMatrix* ref_mfcc, const MFCCMatrix* syn_mfcc, int band,
+                     double* total_distance, int* path_frames, int* band_used) {
+    int ref_frames = ref_mfcc->num_frames;
+    int syn_frames = syn_mfcc->num_frames;
+    double slope = ref_frames > 1 ? (double)(syn_frames - 1) / (ref_frames - 1) : 0.0;
+
+    /* consecutive rows' windows must touch for the last cell to be reachable */
+    int min_band = (int)ceil(slope / 2.0);
+    if (band < min_band) band = min_band;
+    if (band > syn_frames || ref_frames == 1) band = syn_frames;
+
+    double* cost[2];
+    int* length[2];
+    cost[0] = malloc((size_t)syn_frames * sizeof(double));
+    cost[1] = malloc((size_t)syn_frames * sizeof(double));
+    length[0] = malloc((size_t)syn_frames * sizeof(int));
+    length[1] = malloc((size_t)syn_frames * sizeof(int));
+    if (!cost[0] || !cost[1] || !length[0] || !length[1]) {
+        fprintf(stderr, "Error: Memory allocation failed for DTW\n");
+        free(cost[0]);
+        free(cost[1]);
+        free(length[0]);
+        free(length[1]);
+        return -1;
+    }
+
+    /* each row keeps the window it filled; cells outside it count as unreachable */
+    int prev_lo = 0, prev_hi = -1;
+    for (int i = 0; i < ref_frames; i++) {
+        double* row = cost[i & 1];
+        int* row_length = length[i & 1];
+        const double* up = cost[(i + 1) & 1];
+        const int* up_length = length[(i + 1) & 1];
+        const float* ref = ref_mfcc->features + (size_t)i * MFCC_STRIDE;
+
+        int center = (int)lround(i * slope);
+        int lo = center - band > 0 ? center - band : 0;
+        int hi = center + band < syn_frames - 1 ? center + band : syn_frames - 1;
+
+        for (int j = lo; j <= hi; j++) {
+            double d = cepstral_distance(ref, syn_mfcc->features + (size_t)j * MFCC_STRIDE);
+            double best = HUGE_VAL;
+            int best_length = 0;
+            if (i == 0 && j == 0) {
+                best = 0.0;
+            }
+            if (j > lo && row[j - 1] < best) {
+                best = row[j - 1];
+                best_length = row_length[j - 1];
+            }
+            if (j >= prev_lo && j <= prev_hi && up[j] < best) {
+                best = up[j];
+                best_length = up_length[j];
+            }
+            if (j - 1 >= prev_lo && j - 1 <= prev_hi && up[j - 1] <= best) {
+                best = up[j - 1];
+                best_length = up_length[j - 1];
+            }
+            row[j] = best + d;
+            row_length[j] = best_length + 1;
+        }
+        prev_lo = lo;
+        prev_hi = hi;
+    }
+
+    int last = (ref_frames - 1) & 1;
+    int reached = prev_hi == syn_frames - 1 && cost[last][syn_frames - 1] < HUGE_VAL;
+    if (reached) {
+        *total_distance = cost[last][syn_frames - 1];
+        *path_frames = length[last][syn_frames - 1];
+        *band_used = band;
+    }
+    free(cost[0]);
+    free(cost[1]);
+    free(length[0]);
+    free(length[1]);
+    if (!reached) {
+        fprintf(stderr, "Error: DTW band does not reach the last frame pair\n");
+        return -1;
+    }
+    return 0;
+}
+
+double calculate_mcd(const MFCCMatrix* ref_mfcc, const MFCCMatrix* syn_mfcc, int use_dtw, int band,
+                     MCDAlignment* alignment) {
+    double total_distance = 0.0;
+    int valid_frames = 0;
+
+    if (use_dtw) {
+        if (band <= 0) {
+            int longer = ref_mfcc->num_frames > syn_mfcc->num_frames ? ref_mfcc->num_frames : syn_mfcc->num_frames;
+            band = longer * DTW_BAND_PERCENT / 100;
+            if (band < DTW_MIN_BAND) band = DTW_MIN_BAND;
+        }
+        if (align_dtw(ref_mfcc, syn_mfcc, band, &total_distance, &valid_frames, &band) < 0) {
+            return -1.0;
+        }
+    } else {
+        align_linear(ref_mfcc, syn_mfcc, &total_distance, &valid_frames);
+        band = 0;
+    }
+
+    if (valid_frames == 0) {
+        fprintf(stderr, "Error: No valid frames for MCD calculation\n");
+        return -1.0;
+    }
+
+    /* MCD formula: (10/ln(10)) * sqrt(2 * sum_squared_differences) */
+    double mcd = (10.0 / log(10.0)) * sqrt(2.0) * (total_distance / valid_frames);
+
+    if (alignment) {
+        alignment->frames = valid_frames;
+        alignment->band = band;
+    }
+    return mcd;
+}
+
@@ -0,0 +1,43 @@
+/*
+ * MCD Metrics
+ *
+ * MFCC(13) extraction and the frame alignment behind the Mel-Cepstral
+ * Distortion score, shared by mcd_calc and golden_runner.
+ */
+
+#ifndef UCRA_TOOLS_MCD_METRICS_H
+#define UCRA_TOOLS_MCD_METRICS_H
+
+#include "audio_metrics.h"
+#include "ucra_threads.h"
+
+#define DTW_BAND_PERCENT 10             /* default band radius, as a share of the longer file */
+#define DTW_MIN_BAND 8
+
+/* MFCC feature matrix; each frame's coefficients start a row of MFCC_STRIDE
+ * floats, zero past the last one, so C1-C12 load as three vectors */
+typedef struct {
+    float* features; /* [frame * MFCC_STRIDE + coefficient] */
+    int num_frames;
+    int num_coeffs;
+} MFCCMatrix;
+
+/* How the frames were paired */
+typedef struct {
+    int frames;  /* frame pairs compared */
+    int band;    /* DTW band radius used; 0 for the linear alignment */
+} MCDAlignment;
+
+/* Free MFCC matrix memory */
+void mfcc_matrix_free(MFCCMatrix* mfcc);
+
+/* Extract MFCC features from audio, with the frames spread over pool (NULL for this thread) */
+int extract_mfcc(const AudioData* audio, UCRA_ThreadPool* pool, MFCCMatrix* mfcc);
+
+/* Calculate MCD over the frame pairs of a DTW path, or of the linear alignment
+ * when use_dtw is 0; band <= 0 picks the default band. Returns a negative
+ * value on failure; alignment may be NULL */
+double calculate_mcd(const MFCCMatrix* ref_mfcc, const MFCCMatrix* syn_mfcc, int use_dtw, int band,
+                     MCDAlignment* alignment);
+
+#endif /* UCRA_TOOLS_MCD_METRICS_H */
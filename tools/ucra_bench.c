@@ -0,0 +1,503 @@
+/*
+ * UCRA Benchmark Suite
+ * Measures the hot paths hosts care about and prints the numbers as JSON, so
+ * runs can be stored and compared by scripts:
+ *   - ucra_render: realtime factor and heap allocations per render, over note
+ *     counts, F0 curve densities, sample rates and channel counts
+ *   - ucra_stream_read: per-call latency distribution for each block size
+ *   - manifest load time and flag mapper apply throughput
+ * The engine measured is the one this build links (the WORLD engine in
+ * WORLD builds, the reference engine otherwise); its name is in the output.
+ *
+ * Usage: ucra_bench [--quick] [--output FILE] [--manifest FILE] [--flag-map FILE] [--trace FILE]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "cJSON.h"
+#include "ucra/ucra.h"
+#include "ucra/ucra_flag_mapper.h"
+#include "ucra_kernels.h"
+#include "ucra_threads.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#define DEFAULT_MANIFEST "examples/sample-voicebank/resampler.json"
+#define DEFAULT_FLAG_MAP "tools/flag_mapper/mappings/moresampler_map.json"
+#define BENCH_FLAGS "g=-0.25;v=96;B=0.4;mode=1;unmapped=3"
+#define NOTE_SECONDS 0.25
+#define MAX_BLOCK 4096
+#define MAX_CHANNELS 2
+
+#ifdef __GLIBC__
+/* These wrappers take the place of libc's for the whole process, including the
+ * statically linked library, so the allocations a render makes can be counted */
+extern void* __libc_malloc(size_t size);
+extern void* __libc_calloc(size_t count, size_t size);
+extern void* __libc_realloc(void* ptr, size_t size);
+
+static volatile int counting = 0;
+static volatile unsigned long allocations = 0;
+
+void* malloc(size_t size) {
+    if (counting) allocations++;
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size) {
+    if (counting) allocations++;
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* ptr, size_t size) {
+    if (counting) allocations++;
+    return __libc_realloc(ptr, size);
+}
+
+#define COUNTS_ALLOCATIONS 1
+static void count_start(void) { allocations = 0; counting = 1; }
+static unsigned long count_stop(void) { counting = 0; return allocations; }
+#else
+#define COUNTS_ALLOCATIONS 0
+static void count_start(void) {}
+static unsigned long count_stop(void) { return 0; }
+#endif
+
+typedef struct Args {
+    int quick;
+    const char* output;
+    const char* manifest;
+    const char* flag_map;
+    const char* trace;
+} Args;
+
+/* Notes, and the F0 curves they carry, for one render case */
+typedef struct Song {
+    UCRA_NoteSegment* notes;
+    UCRA_F0Curve* curves;
+    float* curve_time;
+    float* curve_f0;
+    uint32_t note_count;
+    double seconds;
+} Song;
+
+static void print_usage(const char* program_name) {
+    printf("Usage: %s [options]\n", program_name);
+    printf("\n");
+    printf("Benchmark rendering, streaming, manifest loading and flag mapping,\n");
+    printf("and print the results as JSON.\n");
+    printf("\n");
+    printf("Options:\n");
+    printf("  --quick           Fewer cases and repetitions, for smoke runs\n");
+    printf("  --output FILE     Write the JSON to FILE instead of standard output\n");
+    printf("  --manifest FILE   Manifest to load (default: %s)\n", DEFAULT_MANIFEST);
+    printf("  --flag-map FILE   Flag mapping to apply (default: %s)\n", DEFAULT_FLAG_MAP);
+    printf("  --trace FILE      Write a Chrome trace of the run (UCRA_ENABLE_TRACING builds)\n");
+}
+
+static int compare_u64(const void* a, const void* b) {
+    uint64_t x = *(const uint64_t*)a, y = *(const uint64_t*)b;
+    return (x > y) - (x < y);
+}
+
+/* Nearest-rank percentile of sorted values */
+static uint64_t percentile(const uint64_t* sorted, uint32_t count, double p) {
+    uint32_t rank = (uint32_t)ceil(p / 100.0 * count);
+    return sorted[rank > 0 ? rank - 1 : 0];
+}
+
+static void add_allocations(cJSON* object, const char* key, double per_call) {
+    if (COUNTS_ALLOCATIONS) {
+        cJSON_AddNumberToObject(object, key, per_call);
+    } else {
+        cJSON_AddNullToObject(object, key);
+    }
+}
+
+static void song_free(Song* song) {
+    free(song->notes);
+    free(song->curves);
+    free(song->curve_time);
+    free(song->curve_f0);
+    memset(song, 0, sizeof(*song));
+}
+
+/* Back-to-back notes of NOTE_SECONDS; with points_per_second, each carries a
+ * vibrato F0 curve that dense */
+static int song_create(uint32_t note_count, uint32_t points_per_second, Song* song) {
+    memset(song, 0, sizeof(*song));
+    uint32_t points = (uint32_t)(points_per_second * NOTE_SECONDS);
+    song->notes = calloc(note_count, sizeof(UCRA_NoteSegment));
+    if (points > 0) {
+        song->curves = calloc(note_count, sizeof(UCRA_F0Curve));
+        song->curve_time = malloc((size_t)note_count * points * sizeof(float));
+        song->curve_f0 = malloc((size_t)note_count * points * sizeof(float));
+    }
+    if (!song->notes || (points > 0 && (!song->curves || !song->curve_time || !song->curve_f0))) {
+        song_free(song);
+        return -1;
+    }
+    for (uint32_t n = 0; n < note_count; n++) {
+        UCRA_NoteSegment* note = &song->notes[n];
+        note->start_sec = n * NOTE_SECONDS;
+        note->duration_sec = NOTE_SECONDS;
+        note->midi_note = (int16_t)(60 + n % 12);
+        note->velocity = 100;
+        note->lyric = "a";
+        if (points > 0) {
+            float* time = song->curve_time + (size_t)n * points;
+            float* f0 = song->curve_f0 + (size_t)n * points;
+            double base = 440.0 * pow(2.0, (note->midi_note - 69) / 12.0);
+            for (uint32_t i = 0; i < points; i++) {
+                time[i] = (float)(i * NOTE_SECONDS / points);
+                f0[i] = (float)(base * (1.0 + 0.02 * sin(2.0 * M_PI * 5.5 * time[i])));
+            }
+            song->curves[n].time_sec = time;
+            song->curves[n].f0_hz = f0;
+            song->curves[n].length = points;
+            note->f0_override = &song->curves[n];
+        }
+    }
+    song->note_count = note_count;
+    song->seconds = note_count * NOTE_SECONDS;
+    return 0;
+}
+
+static cJSON* bench_render_case(UCRA_Handle engine, const Song* song, uint32_t points_per_second,
+                                uint32_t sample_rate, uint32_t channels, uint32_t repeats) {
+    UCRA_RenderConfig config;
+    memset(&config, 0, sizeof(config));
+    config.sample_rate = sample_rate;
+    config.channels = channels;
+    config.block_size = 512;
+    config.notes = song->notes;
+    config.note_count = song->note_count;
+
+    /* the first render sizes the engine's buffers; it is not measured */
+    UCRA_RenderResult result;
+    if (ucra_render(engine, &config, &result) != UCRA_SUCCESS) {
+        return NULL;
+    }
+    uint64_t* times = malloc(repeats * sizeof(uint64_t));
+    if (!times) {
+        return NULL;
+    }
+    unsigned long allocated = 0;
+    for (uint32_t i = 0; i < repeats; i++) {
+        count_start();
+        uint64_t start = ucra_time_ns();
+        UCRA_Result status = ucra_render(engine, &config, &result);
+        times[i] = ucra_time_ns() - start;
+        allocated += count_stop();
+        if (status != UCRA_SUCCESS) {
+            free(times);
+            return NULL;
+        }
+    }
+    qsort(times, repeats, sizeof(uint64_t), compare_u64);
+    double median_sec = percentile(times, repeats, 50.0) * 1e-9;
+
+    cJSON* entry = cJSON_CreateObject();
+    cJSON_AddNumberToObject(entry, "notes", song->note_count);
+    cJSON_AddNumberToObject(entry, "f0_points_per_second", points_per_second);
+    cJSON_AddNumberToObject(entry, "sample_rate", sample_rate);
+    cJSON_AddNumberToObject(entry, "channels", channels);
+    cJSON_AddNumberToObject(entry, "audio_seconds", song->seconds);
+    cJSON_AddNumberToObject(entry, "frames", (double)result.frames);
+    cJSON_AddNumberToObject(entry, "repeats", repeats);
+    cJSON_AddNumberToObject(entry, "min_ms", times[0] * 1e-6);
+    cJSON_AddNumberToObject(entry, "median_ms", median_sec * 1e3);
+    cJSON_AddNumberToObject(entry, "realtime_factor", median_sec > 0.0 ? song->seconds / median_sec : 0.0);
+    add_allocations(entry, "allocations_per_render", (double)allocated / repeats);
+    free(times);
+    return entry;
+}
+
+static cJSON* bench_render(UCRA_Handle engine, int quick) {
+    static const uint32_t note_counts[] = { 1, 8, 32 };
+    static const uint32_t densities[] = { 0, 100, 1000 };
+    static const uint32_t rates[] = { 22050, 44100, 48000 };
+    static const uint32_t channel_counts[] = { 1, 2 };
+    size_t note_cases = quick ? 2 : 3, density_cases = quick ? 2 : 3, rate_cases = quick ? 1 : 3;
+    uint32_t repeats = quick ? 3 : 15;
+
+    cJSON* cases = cJSON_CreateArray();
+    for (size_t n = 0; n < note_cases; n++) {
+        for (size_t d = 0; d < density_cases; d++) {
+            Song song;
+            if (song_create(note_counts[n], densities[d], &song) < 0) {
+                fprintf(stderr, "Error: Cannot allocate %u notes\n", note_counts[n]);
+                continue;
+            }
+            for (size_t r = 0; r < rate_cases; r++) {
+                uint32_t rate = quick ? 44100 : rates[r];
+                for (size_t c = 0; c < 2; c++) {
+                    cJSON* entry = bench_render_case(engine, &song, densities[d], rate, channel_counts[c], repeats);
+                    if (entry) {
+                        cJSON_AddItemToArray(cases, entry);
+                    } else {
+                        fprintf(stderr, "Error: Render failed (%u notes, %u Hz, %u channels)\n",
+                                note_counts[n], rate, channel_counts[c]);
+                    }
+                }
+            }
+            song_free(&song);
+        }
+    }
+    return cases;
+}
+
+static UCRA_Result UCRA_CALL pull_song(void* user_data, UCRA_RenderConfig* out_config) {
+    const Song* song = (const Song*)user_data;
+    out_config->notes = song->notes;
+    out_config->note_count = song->note_count;
+    return UCRA_SUCCESS;
+}
+
+static cJSON* bench_stream_case(UCRA_Handle engine, const Song* song, uint32_t block_size, uint32_t reads) {
+    static float buffer[MAX_BLOCK * MAX_CHANNELS];
+    UCRA_RenderConfig config;
+    memset(&config, 0, sizeof(config));
+    config.sample_rate = 44100;
+    config.channels = MAX_CHANNELS;
+    config.block_size = block_size;
+
+    UCRA_StreamHandle stream = NULL;
+    if (ucra_stream_open_engine(&stream, engine, &config, pull_song, (void*)song) != UCRA_SUCCESS) {
+        return NULL;
+    }
+    uint64_t* times = malloc(reads * sizeof(uint64_t));
+    if (!times) {
+        ucra_stream_close(stream);
+        return NULL;
+    }
+    uint64_t frames = 0, total_ns = 0;
+    uint32_t short_reads = 0;
+    unsigned long allocated = 0;
+    for (uint32_t i = 0; i < reads; i++) {
+        uint32_t frames_read = 0;
+        count_start();
+        uint64_t start = ucra_time_ns();
+        UCRA_Result status = ucra_stream_read(stream, buffer, block_size, &frames_read);
+        times[i] = ucra_time_ns() - start;
+        allocated += count_stop();
+        if (status != UCRA_SUCCESS) {
+            free(times);
+            ucra_stream_close(stream);
+            return NULL;
+        }
+        total_ns += times[i];
+        frames += frames_read;
+        short_reads += frames_read < block_size;
+    }
+    ucra_stream_close(stream);
+    qsort(times, reads, sizeof(uint64_t), compare_u64);
+
+    /* a block is due every block_size / sample_rate seconds */
+    double budget_us = block_size * 1e6 / config.sample_rate;
+    cJSON* entry = cJSON_CreateObject();
+    cJSON_AddNumberToObject(entry, "block_size", block_size);
+    cJSON_AddNumberToObject(entry, "sample_rate", config.sample_rate);
+    cJSON_AddNumberToObject(entry, "channels", config.channels);
+    cJSON_AddNumberToObject(entry, "reads", reads);
+    cJSON_AddNumberToObject(entry, "frames", (double)frames);
+    cJSON_AddNumberToObject(entry, "short_reads", short_reads);
+    cJSON_AddNumberToObject(entry, "budget_us", budget_us);
+    cJSON_AddNumberToObject(entry, "mean_us", total_ns * 1e-3 / reads);
+    cJSON_AddNumberToObject(entry, "p50_us", percentile(times, reads, 50.0) * 1e-3);
+    cJSON_AddNumberToObject(entry, "p90_us", percentile(times, reads, 90.0) * 1e-3);
+    cJSON_AddNumberToObject(entry, "p99_us", percentile(times, reads, 99.0) * 1e-3);
+    cJSON_AddNumberToObject(entry, "max_us", times[reads - 1] * 1e-3);
+    add_allocations(entry, "allocations_per_read", (double)allocated / reads);
+    free(times);
+    return entry;
+}
+
+static cJSON* bench_stream(UCRA_Handle engine, int quick) {
+    static const uint32_t block_sizes[] = { 64, 128, 256, 512, 1024, 2048, 4096 };
+    uint32_t reads = quick ? 200 : 2000;
+    cJSON* cases = cJSON_CreateArray();
+
+    /* long enough that every read, even of the largest blocks, lands in the song */
+    Song song;
+    uint32_t note_count = (uint32_t)ceil(reads * (double)MAX_BLOCK / 44100.0 / NOTE_SECONDS) + 1;
+    if (song_create(note_count, 100, &song) < 0) {
+        fprintf(stderr, "Error: Cannot allocate the streamed song\n");
+        return cases;
+    }
+    for (size_t b = 0; b < sizeof(block_sizes) / sizeof(block_sizes[0]); b++) {
+        cJSON* entry = bench_stream_case(engine, &song, block_sizes[b], reads);
+        if (entry) {
+            cJSON_AddItemToArray(cases, entry);
+        } else {
+            fprintf(stderr, "Error: Streaming failed at block size %u\n", block_sizes[b]);
+        }
+    }
+    song_free(&song);
+    return cases;
+}
+
+static cJSON* bench_manifest(const char* path, int quick) {
+    uint32_t iterations = quick ? 50 : 1000;
+    UCRA_Manifest* manifest = NULL;
+    if (ucra_manifest_load(path, &manifest) != UCRA_SUCCESS) {
+        fprintf(stderr, "Error: Cannot load manifest '%s'\n", path);
+        return NULL;
+    }
+    uint32_t flag_count = manifest->flags_count;
+    ucra_manifest_free(manifest);
+
+    uint64_t start = ucra_time_ns();
+    for (uint32_t i = 0; i < iterations; i++) {
+        if (ucra_manifest_load(path, &manifest) != UCRA_SUCCESS) {
+            return NULL;
+        }
+        ucra_manifest_free(manifest);
+    }
+    double mean_us = (ucra_time_ns() - start) * 1e-3 / iterations;
+
+    cJSON* entry = cJSON_CreateObject();
+    cJSON_AddStringToObject(entry, "path", path);
+    cJSON_AddNumberToObject(entry, "flags", flag_count);
+    cJSON_AddNumberToObject(entry, "iterations", iterations);
+    cJSON_AddNumberToObject(entry, "load_us", mean_us);
+    return entry;
+}
+
+static cJSON* bench_flag_mapper(const char* path, int quick) {
+    uint32_t iterations = quick ? 10000 : 1000000;
+    UCRA_FlagMapper* mapper = NULL;
+    if (ucra_flag_mapper_load(path, &mapper) != UCRA_SUCCESS || ucra_flag_mapper_compile(mapper) != UCRA_SUCCESS) {
+        fprintf(stderr, "Error: Cannot load flag mapping '%s'\n", path);
+        ucra_flag_mapper_free(mapper);
+        return NULL;
+    }
+    UCRA_KeyValue* flags = NULL;
+    uint32_t flag_count = 0;
+    size_t arena_size = ucra_flag_mapper_arena_size(mapper);
+    void* arena = malloc(arena_size ? arena_size : 1);
+    if (!arena || ucra_parse_legacy_flags(BENCH_FLAGS, &flags, &flag_count) != UCRA_SUCCESS) {
+        free(arena);
+        ucra_flag_mapper_free(mapper);
+        return NULL;
+    }
+
+    UCRA_FlagMapResult result;
+    count_start();
+    uint64_t start = ucra_time_ns();
+    for (uint32_t i = 0; i < iterations; i++) {
+        if (ucra_flag_mapper_apply(mapper, flags, flag_count, &result) == UCRA_SUCCESS) {
+            ucra_flag_map_result_free(&result);
+        }
+    }
+    uint64_t apply_ns = ucra_time_ns() - start;
+    unsigned long apply_allocations = count_stop();
+
+    count_start();
+    start = ucra_time_ns();
+    for (uint32_t i = 0; i < iterations; i++) {
+        ucra_flag_mapper_apply_into(mapper, flags, flag_count, arena, arena_size, &result);
+    }
+    uint64_t into_ns = ucra_time_ns() - start;
+    unsigned long into_allocations = count_stop();
+
+    cJSON* entry = cJSON_CreateObject();
+    cJSON_AddStringToObject(entry, "path", path);
+    cJSON_AddStringToObject(entry, "flags", BENCH_FLAGS);
+    cJSON_AddNumberToObject(entry, "iterations", iterations);
+    cJSON_AddNumberToObject(entry, "apply_per_second", apply_ns ? iterations * 1e9 / apply_ns : 0.0);
+    add_allocations(entry, "apply_allocations", (double)apply_allocations / iterations);
+    cJSON_AddNumberToObject(entry, "apply_into_per_second", into_ns ? iterations * 1e9 / into_ns : 0.0);
+    add_allocations(entry, "apply_into_allocations", (double)into_allocations / iterations);
+
+    ucra_free_legacy_flags(flags, flag_count);
+    free(arena);
+    ucra_flag_mapper_free(mapper);
+    return entry;
+}
+
+int main(int argc, char* argv[]) {
+    Args args = { 0, NULL, DEFAULT_MANIFEST, DEFAULT_FLAG_MAP, NULL };
+    for (int i = 1; i < argc; i++) {
+        int has_value = i + 1 < argc;
+        if (strcmp(argv[i], "--quick") == 0) {
+            args.quick = 1;
+        } else if (strcmp(argv[i], "--output") == 0 && has_value) {
+            args.output = argv[++i];
+        } else if (strcmp(argv[i], "--manifest") == 0 && has_value) {
+            args.manifest = argv[++i];
+        } else if (strcmp(argv[i], "--flag-map") == 0 && has_value) {
+            args.flag_map = argv[++i];
+        } else if (strcmp(argv[i], "--trace") == 0 && has_value) {
+            args.trace = argv[++i];
+        } else {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (args.trace && ucra_trace_enable(1) != UCRA_SUCCESS) {
+        fprintf(stderr, "Error: This build has no tracing; configure with -DUCRA_ENABLE_TRACING=ON\n");
+        return 1;
+    }
+
+    UCRA_Handle engine = NULL;
+    if (ucra_engine_create(&engine, NULL, 0) != UCRA_SUCCESS) {
+        fprintf(stderr, "Error: Cannot create the engine\n");
+        return 1;
+    }
+    char engine_name[256] = "";
+    ucra_engine_getinfo(engine, engine_name, sizeof(engine_name));
+
+    cJSON* root = cJSON_CreateObject();
+    cJSON_AddStringToObject(root, "engine", engine_name);
+    cJSON_AddStringToObject(root, "kernels", ucra_kernels()->name);
+    cJSON_AddNumberToObject(root, "cpus", ucra_cpu_count());
+    cJSON_AddBoolToObject(root, "quick", args.quick);
+    cJSON_AddBoolToObject(root, "counts_allocations", COUNTS_ALLOCATIONS);
+
+    fprintf(stderr, "Benchmarking ucra_render...\n");
+    cJSON_AddItemToObject(root, "render", bench_render(engine, args.quick));
+    fprintf(stderr, "Benchmarking ucra_stream_read...\n");
+    cJSON_AddItemToObject(root, "stream", bench_stream(engine, args.quick));
+    ucra_engine_destroy(engine);
+
+    fprintf(stderr, "Benchmarking manifest loading and flag mapping...\n");
+    cJSON* manifest = bench_manifest(args.manifest, args.quick);
+    cJSON* flag_mapper = bench_flag_mapper(args.flag_map, args.quick);
+    int failed = !manifest || !flag_mapper;
+    if (args.trace) {
+        /* each thread keeps only its first events since the last drain */
+        ucra_trace_enable(0);
+        if (ucra_trace_write_chrome(args.trace) != UCRA_SUCCESS) {
+            fprintf(stderr, "Error: Cannot write trace '%s'\n", args.trace);
+            failed = 1;
+        }
+    }
+    cJSON_AddItemToObject(root, "manifest", manifest ? manifest : cJSON_CreateNull());
+    cJSON_AddItemToObject(root, "flag_mapper", flag_mapper ? flag_mapper : cJSON_CreateNull());
+
+    char* json = cJSON_Print(root);
+    cJSON_Delete(root);
+    if (!json) {
+        fprintf(stderr, "Error: Cannot format the results\n");
+        return 1;
+    }
+    FILE* out = args.output ? fopen(args.output, "w") : stdout;
+    if (!out) {
+        fprintf(stderr, "Error: Cannot write '%s'\n", args.output);
+        free(json);
+        return 1;
+    }
+    fprintf(out, "%s\n", json);
+    if (args.output) {
+        fclose(out);
+        fprintf(stderr, "Results written to %s\n", args.output);
+    }
+    free(json);
+    return failed ? 1 : 0;
+}
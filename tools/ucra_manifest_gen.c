@@ -1,6 +1,7 @@
 /*
  * UCRA -> OpenUtau Resampler Manifest Generator
- * Reads a UCRA resampler.json and emits an OpenUtau-style YAML manifest.
+ * Reads a UCRA resampler.json and emits an OpenUtau-style YAML manifest, and/or
+ * the compiled binary manifest that ucra_manifest_load() maps instead of the JSON.
  */
 
 #include <stdio.h>
@@ -8,20 +9,23 @@
 #include <string.h>
 #include <ctype.h>
 #include "cJSON.h"
+#include "ucra_manifest_compiled.h"
 
 typedef struct Args {
     const char* input;
     const char* output;
     const char* executable;
+    int compile;
 } Args;
 
 static void print_help(const char* prog) {
     printf("UCRA OpenUtau Manifest Generator\n");
-    printf("Usage: %s --input resampler.json --output resampler.yaml [--exe resampler]\n", prog);
+    printf("Usage: %s --input resampler.json [--output resampler.yaml] [--exe resampler] [--compile]\n", prog);
     printf("\nOptions:\n");
     printf("  --input, -i   Path to UCRA resampler.json\n");
     printf("  --output, -o  Path to output YAML file\n");
     printf("  --exe, -e     Resampler executable name/path (default: resampler)\n");
+    printf("  --compile, -c Also write the compiled manifest next to the input\n");
     printf("  --help, -h    Show this help\n");
 }
 
@@ -38,12 +42,14 @@ static int parse_args(int argc, char** argv, Args* out) {
             out->output = argv[++i];
         } else if ((!strcmp(argv[i], "--exe") || !strcmp(argv[i], "-e")) && i + 1 < argc) {
             out->executable = argv[++i];
+        } else if (!strcmp(argv[i], "--compile") || !strcmp(argv[i], "-c")) {
+            out->compile = 1;
         } else {
             fprintf(stderr, "Unknown or incomplete option: %s\n", argv[i]);
             return -1;
         }
     }
-    if (!out->input || !out->output) {
+    if (!out->input || (!out->output && !out->compile)) {
         fprintf(stderr, "Missing required --input and/or --output. Use --help.\n");
         return -1;
     }
@@ -104,6 +110,15 @@ int main(int argc, char** argv) {
     int par = parse_args(argc, argv, &args);
     if (par != 0) return (par > 0) ? 0 : 2;
 
+    if (args.compile) {
+        UCRA_Result result = ucra_manifest_compile(args.input, NULL);
+        if (result != UCRA_SUCCESS) {
+            fprintf(stderr, "Failed to compile %s (error %d)\n", args.input, (int)result);
+            return 6;
+        }
+        if (!args.output) return 0;
+    }
+
     long in_len = 0;
     char* json = read_all(args.input, &in_len);
     if (!json) {
@@ -0,0 +1,374 @@
+/*
+ * UCRA Voicebank Pre-Analysis
+ * Walks a voicebank directory and writes the analysis cache file next to every
+ * sample, so the first render does not pay for WORLD analysis. Samples are
+ * analyzed on all cores; the directory walk feeds the workers through a bounded
+ * queue, and samples whose cache is already up to date are skipped.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include "cJSON.h"
+#include "ucra_analysis.h"
+#include "ucra_threads.h"
+#include "ucra_wav.h"
+#ifdef UCRA_HAS_WORLD
+#include "ucra_world_analysis.h"
+#endif
+
+#ifdef _WIN32
+    #include <windows.h>
+    #define PATH_SEP '\\'
+#else
+    #include <dirent.h>
+    #include <sys/stat.h>
+    #define PATH_SEP '/'
+#endif
+
+#define MAX_PATH_LEN 4096
+
+typedef struct Args {
+    const char* voicebank;
+    uint32_t threads;
+    uint32_t queue;
+    UCRA_AnalysisOptions options;
+    int check;
+    int quiet;
+} Args;
+
+typedef enum SampleStatus {
+    SAMPLE_UP_TO_DATE,
+    SAMPLE_ANALYZED,
+    SAMPLE_STALE,
+    SAMPLE_FAILED
+} SampleStatus;
+
+/* Bounded path queue between the directory walk and the workers, plus progress counters */
+typedef struct WorkQueue {
+    UCRA_Mutex mutex;
+    UCRA_Cond not_empty;
+    UCRA_Cond not_full;
+    char** items;
+    uint32_t capacity;
+    uint32_t head;
+    uint32_t count;
+    int closed;
+
+    const Args* args;
+    uint64_t options_hash;
+    uint32_t found;
+    uint32_t done;
+    uint32_t status_counts[4];
+} WorkQueue;
+
+static void print_help(const char* prog) {
+    printf("UCRA Voicebank Pre-Analysis\n");
+    printf("Usage: %s --voicebank DIR [options]\n", prog);
+    printf("\nOptions:\n");
+    printf("  --voicebank, -v    Voicebank directory containing resampler.json\n");
+    printf("  --threads, -j      Worker threads (default: number of CPUs)\n");
+    printf("  --queue, -q        Pending samples held by the walk (default: 4 per thread)\n");
+    printf("  --frame-period     Analysis hop in milliseconds (default: %.1f)\n", UCRA_ANALYSIS_DEFAULT_FRAME_PERIOD);
+    printf("  --f0-estimator     harvest or dio (default: harvest)\n");
+    printf("  --check            Only report samples without an up-to-date cache\n");
+    printf("  --quiet            Print the summary only\n");
+    printf("  --help, -h         Show this help\n");
+    printf("\nThe frame period and estimator must match the engine's frame_period and\n");
+    printf("f0_estimator options, otherwise the engine treats the caches as stale.\n");
+}
+
+static int parse_args(int argc, char** argv, Args* out) {
+    memset(out, 0, sizeof(*out));
+    out->options.frame_period = UCRA_ANALYSIS_DEFAULT_FRAME_PERIOD;
+    out->options.f0_floor = UCRA_ANALYSIS_DEFAULT_F0_FLOOR;
+    out->options.f0_ceil = UCRA_ANALYSIS_DEFAULT_F0_CEIL;
+    out->options.f0_method = UCRA_ANALYSIS_F0_HARVEST;
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "--help") || !strcmp(argv[i], "-h")) {
+            print_help(argv[0]);
+            return 1; // signal help
+        } else if ((!strcmp(argv[i], "--voicebank") || !strcmp(argv[i], "-v")) && i + 1 < argc) {
+            out->voicebank = argv[++i];
+        } else if ((!strcmp(argv[i], "--threads") || !strcmp(argv[i], "-j")) && i + 1 < argc) {
+            out->threads = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if ((!strcmp(argv[i], "--queue") || !strcmp(argv[i], "-q")) && i + 1 < argc) {
+            out->queue = (uint32_t)strtoul(argv[++i], NULL, 10);
+        } else if (!strcmp(argv[i], "--frame-period") && i + 1 < argc) {
+            out->options.frame_period = atof(argv[++i]);
+            if (out->options.frame_period <= 0.0) {
+                fprintf(stderr, "--frame-period must be positive\n");
+                return -1;
+            }
+        } else if (!strcmp(argv[i], "--f0-estimator") && i + 1 < argc) {
+            const char* name = argv[++i];
+            if (!strcmp(name, "dio")) {
+                out->options.f0_method = UCRA_ANALYSIS_F0_DIO;
+            } else if (!strcmp(name, "harvest")) {
+                out->options.f0_method = UCRA_ANALYSIS_F0_HARVEST;
+            } else {
+                fprintf(stderr, "Unknown F0 estimator: %s\n", name);
+                return -1;
+            }
+        } else if (!strcmp(argv[i], "--check")) {
+            out->check = 1;
+        } else if (!strcmp(argv[i], "--quiet")) {
+            out->quiet = 1;
+        } else {
+            fprintf(stderr, "Unknown or incomplete option: %s\n", argv[i]);
+            return -1;
+        }
+    }
+    if (!out->voicebank) {
+        fprintf(stderr, "Missing required --voicebank. Use --help.\n");
+        return -1;
+    }
+    if (out->threads == 0) out->threads = ucra_cpu_count();
+    if (out->queue == 0) out->queue = out->threads * 4;
+    return 0;
+}
+
+static char* read_all(const char* path, long* out_len) {
+    FILE* f = fopen(path, "rb");
+    if (!f) return NULL;
+    if (fseek(f, 0, SEEK_END) != 0) { fclose(f); return NULL; }
+    long len = ftell(f);
+    if (len < 0) { fclose(f); return NULL; }
+    rewind(f);
+    char* buf = (char*)malloc((size_t)len + 1);
+    if (!buf) { fclose(f); return NULL; }
+    size_t n = fread(buf, 1, (size_t)len, f);
+    fclose(f);
+    buf[n] = '\0';
+    if (out_len) *out_len = (long)n;
+    return buf;
+}
+
+static int has_wav_extension(const char* name) {
+    size_t len = strlen(name);
+    if (len < 4) return 0;
+    const char* ext = name + len - 4;
+    return ext[0] == '.' && tolower((unsigned char)ext[1]) == 'w' &&
+           tolower((unsigned char)ext[2]) == 'a' && tolower((unsigned char)ext[3]) == 'v';
+}
+
+static SampleStatus process_sample(const WorkQueue* queue, const char* wav_path) {
+    uint64_t source_hash = 0;
+    char cache_path[MAX_PATH_LEN];
+    if (ucra_analysis_hash_file(wav_path, &source_hash) != UCRA_SUCCESS ||
+        ucra_analysis_cache_path(wav_path, cache_path, sizeof(cache_path)) != UCRA_SUCCESS) {
+        return SAMPLE_FAILED;
+    }
+
+    UCRA_AnalysisFile* file = NULL;
+    if (ucra_analysis_open(cache_path, source_hash, queue->options_hash, &file) == UCRA_SUCCESS) {
+        ucra_analysis_close(file);
+        return SAMPLE_UP_TO_DATE;
+    }
+    if (queue->args->check) {
+        return SAMPLE_STALE;
+    }
+
+#ifdef UCRA_HAS_WORLD
+    float* samples = NULL;
+    uint32_t length = 0, sample_rate = 0;
+    if (ucra_wav_read_mono(wav_path, &samples, &length, &sample_rate) != UCRA_SUCCESS) {
+        return SAMPLE_FAILED;
+    }
+    UCRA_AnalysisData data;
+    memset(&data, 0, sizeof(data));
+    UCRA_Result result = ucra_world_analyze((void*)&queue->args->options, samples, length, sample_rate, &data);
+    free(samples);
+    if (result == UCRA_SUCCESS) {
+        result = ucra_analysis_save(cache_path, source_hash, queue->options_hash, &data);
+    }
+    free((void*)data.f0);
+    free((void*)data.spectrogram);
+    free((void*)data.aperiodicity);
+    return result == UCRA_SUCCESS ? SAMPLE_ANALYZED : SAMPLE_FAILED;
+#else
+    return SAMPLE_FAILED;
+#endif
+}
+
+static void worker_main(void* arg) {
+    static const char* const labels[] = { "up to date", "analyzed", "stale", "FAILED" };
+    WorkQueue* queue = (WorkQueue*)arg;
+    for (;;) {
+        ucra_mutex_lock(&queue->mutex);
+        while (queue->count == 0 && !queue->closed) {
+            ucra_cond_wait(&queue->not_empty, &queue->mutex);
+        }
+        if (queue->count == 0) {
+            ucra_mutex_unlock(&queue->mutex);
+            return;
+        }
+        char* path = queue->items[queue->head];
+        queue->head = (queue->head + 1) % queue->capacity;
+        queue->count--;
+        ucra_cond_signal(&queue->not_full);
+        ucra_mutex_unlock(&queue->mutex);
+
+        SampleStatus status = process_sample(queue, path);
+
+        /* progress lines are printed under the lock so they never interleave */
+        ucra_mutex_lock(&queue->mutex);
+        queue->done++;
+        queue->status_counts[status]++;
+        if (!queue->args->quiet || status == SAMPLE_FAILED) {
+            fprintf(stderr, "[%u/%u%s] %s: %s\n", queue->done, queue->found, queue->closed ? "" : "+",
+                    path, labels[status]);
+        }
+        ucra_mutex_unlock(&queue->mutex);
+        free(path);
+    }
+}
+
+/* blocks while the queue is full, which bounds the walk's lead over the workers */
+static int queue_push(WorkQueue* queue, const char* path) {
+    char* copy = (char*)malloc(strlen(path) + 1);
+    if (!copy) return -1;
+    strcpy(copy, path);
+
+    ucra_mutex_lock(&queue->mutex);
+    while (queue->count == queue->capacity) {
+        ucra_cond_wait(&queue->not_full, &queue->mutex);
+    }
+    queue->items[(queue->head + queue->count) % queue->capacity] = copy;
+    queue->count++;
+    queue->found++;
+    ucra_cond_signal(&queue->not_empty);
+    ucra_mutex_unlock(&queue->mutex);
+    return 0;
+}
+
+/* recursive walk; UTAU voicebanks often keep pitch variants in subdirectories */
+static int walk_directory(WorkQueue* queue, const char* dir) {
+    char path[MAX_PATH_LEN];
+#ifdef _WIN32
+    char pattern[MAX_PATH_LEN];
+    snprintf(pattern, sizeof(pattern), "%s\\*", dir);
+    WIN32_FIND_DATAA entry;
+    HANDLE find = FindFirstFileA(pattern, &entry);
+    if (find == INVALID_HANDLE_VALUE) return -1;
+    do {
+        const char* name = entry.cFileName;
+        if (name[0] == '.') continue;
+        if (snprintf(path, sizeof(path), "%s%c%s", dir, PATH_SEP, name) >= (int)sizeof(path)) continue;
+        if (entry.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
+            walk_directory(queue, path);
+        } else if (has_wav_extension(name) && queue_push(queue, path) != 0) {
+            FindClose(find);
+            return -1;
+        }
+    } while (FindNextFileA(find, &entry));
+    FindClose(find);
+#else
+    DIR* handle = opendir(dir);
+    if (!handle) return -1;
+    struct dirent* entry;
+    while ((entry = readdir(handle)) != NULL) {
+        const char* name = entry->d_name;
+        if (name[0] == '.') continue;
+        if (snprintf(path, sizeof(path), "%s%c%s", dir, PATH_SEP, name) >= (int)sizeof(path)) continue;
+        struct stat info;
+        if (stat(path, &info) != 0) continue;
+        if (S_ISDIR(info.st_mode)) {
+            walk_directory(queue, path);
+        } else if (S_ISREG(info.st_mode) && has_wav_extension(name) && queue_push(queue, path) != 0) {
+            closedir(handle);
+            return -1;
+        }
+    }
+    closedir(handle);
+#endif
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    Args args;
+    int par = parse_args(argc, argv, &args);
+    if (par != 0) return (par > 0) ? 0 : 2;
+
+#ifndef UCRA_HAS_WORLD
+    if (!args.check) {
+        fprintf(stderr, "Built without WORLD; only --check is available\n");
+        return 2;
+    }
+#endif
+
+    char manifest_path[MAX_PATH_LEN];
+    snprintf(manifest_path, sizeof(manifest_path), "%s%cresampler.json", args.voicebank, PATH_SEP);
+    char* json = read_all(manifest_path, NULL);
+    if (!json) {
+        fprintf(stderr, "Failed to read manifest: %s\n", manifest_path);
+        return 3;
+    }
+    cJSON* root = cJSON_Parse(json);
+    free(json);
+    if (!root) {
+        fprintf(stderr, "Invalid JSON in %s\n", manifest_path);
+        return 4;
+    }
+    const cJSON* name = cJSON_GetObjectItemCaseSensitive(root, "name");
+    if (!args.quiet) {
+        printf("Voicebank: %s (%u threads)\n", cJSON_IsString(name) ? name->valuestring : args.voicebank,
+               args.threads);
+        fflush(stdout);
+    }
+    cJSON_Delete(root);
+
+    WorkQueue queue;
+    memset(&queue, 0, sizeof(queue));
+    queue.args = &args;
+    queue.options_hash = ucra_analysis_options_hash(&args.options);
+    queue.capacity = args.queue;
+    queue.items = (char**)calloc(queue.capacity, sizeof(char*));
+    UCRA_Thread* threads = (UCRA_Thread*)calloc(args.threads, sizeof(UCRA_Thread));
+    if (!queue.items || !threads) {
+        fprintf(stderr, "Out of memory\n");
+        free(queue.items);
+        free(threads);
+        return 5;
+    }
+    ucra_mutex_init(&queue.mutex);
+    ucra_cond_init(&queue.not_empty);
+    ucra_cond_init(&queue.not_full);
+
+    uint32_t started = 0;
+    while (started < args.threads && ucra_thread_create(&threads[started], worker_main, &queue) == 0) {
+        started++;
+    }
+    int walk_result = -1;
+    if (started > 0) {
+        walk_result = walk_directory(&queue, args.voicebank);
+    } else {
+        fprintf(stderr, "Failed to start worker threads\n");
+    }
+
+    ucra_mutex_lock(&queue.mutex);
+    queue.closed = 1;
+    ucra_cond_broadcast(&queue.not_empty);
+    ucra_mutex_unlock(&queue.mutex);
+    for (uint32_t i = 0; i < started; ++i) {
+        ucra_thread_join(threads[i]);
+    }
+
+    printf("%u samples: %u analyzed, %u up to date, %u stale, %u failed\n", queue.found,
+           queue.status_counts[SAMPLE_ANALYZED], queue.status_counts[SAMPLE_UP_TO_DATE],
+           queue.status_counts[SAMPLE_STALE], queue.status_counts[SAMPLE_FAILED]);
+
+    ucra_cond_destroy(&queue.not_full);
+    ucra_cond_destroy(&queue.not_empty);
+    ucra_mutex_destroy(&queue.mutex);
+    free(threads);
+    free(queue.items);
+
+    if (walk_result != 0) {
+        fprintf(stderr, "Failed to walk %s\n", args.voicebank);
+        return 6;
+    }
+    if (queue.status_counts[SAMPLE_FAILED] > 0) return 1;
+    return (args.check && queue.status_counts[SAMPLE_STALE] > 0) ? 1 : 0;
+}
@@ -5,6 +5,14 @@
  * audio comparison, F0 RMSE, and MCD calculation utilities into a single,
  * automated command-line tool that produces a consolidated test report.
  *
+ * Results are kept in a database keyed on content hashes: a case's key covers
+ * the validation tools' binaries (the resampler carries the engine build), this
+ * suite's version, whether cases run in-process and the case's input.json, expected_output.wav, f0_curve.txt
+ * and actual_f0_curve.txt. Only cases whose key changed since the last run are
+ * handed to golden_runner; the rest are reported from the database, marked as
+ * cached. Files an input.json refers to outside its case are not hashed; use
+ * --no-cache after changing them.
+ *
  * Usage: validation_suite [options] [test_directory]
  *
  * Options:
@@ -12,7 +20,10 @@
  *   --output FILE    Output report to file (default: console)
  *   --format FORMAT  Report format: console, json, markdown (default: console)
  *   --parallel N     Run N test cases in parallel (default: 1)
+ *   --in-process     Have golden_runner render and score the cases in-process
  *   --verbose        Enable verbose output
+ *   --results-db FILE  Results database (default: test_directory/.validation_results.json)
+ *   --no-cache       Re-evaluate every case, then refresh the database
  *   --help           Show this help message
  */
 
@@ -24,10 +35,36 @@
 #include <time.h>
 #include <unistd.h>
 #include "../third-party/cJSON.h"
+#include "ucra_file.h"
+#include "ucra_threads.h"
+#include "audio_metrics.h"
 
 #define MAX_PATH 512
 #define MAX_COMMAND_LENGTH 2048
+/* test_directory/name/file: a MAX_PATH directory and case name plus the longest case file */
+#define CASE_PATH_SIZE (2 * MAX_PATH + 32)
 #define VERSION "1.0.0"
+#define RESULTS_DB_NAME ".validation_results.json"
+#define KEY_SIZE (HASH_SIZE * 2 + 1)
+
+/* Tools the suite runs; their binaries are part of every case's key */
+static const char* const required_tools[] = {
+    "./golden_runner",
+    "./audio_compare",
+    "./f0_rmse_calc",
+    "./mcd_calc",
+    "./resampler"
+};
+#define REQUIRED_TOOL_COUNT (sizeof(required_tools) / sizeof(required_tools[0]))
+
+/* Case files whose contents are part of the case's key */
+static const char* const case_files[] = {
+    "input.json",
+    "expected_output.wav",
+    "f0_curve.txt",
+    "actual_f0_curve.txt"
+};
+#define CASE_FILE_COUNT (sizeof(case_files) / sizeof(case_files[0]))
 
 /* Configuration structure */
 typedef struct {
@@ -37,6 +74,9 @@ typedef struct {
     int parallel_jobs;
     int verbose;
     char config_file[MAX_PATH];
+    char results_db[MAX_PATH];  /* empty: RESULTS_DB_NAME in test_directory */
+    int use_cache;
+    int in_process;
 } Config;
 
 /* Test suite statistics */
@@ -45,7 +85,10 @@ typedef struct {
     int passed_tests;
     int failed_tests;
     int skipped_tests;
+    int cached_tests;     /* reported from the results database */
+    int evaluated_tests;  /* run by golden_runner this time */
     double total_runtime;
+    char build_hash[KEY_SIZE];
     char start_time[64];
     char end_time[64];
 } SuiteStats;
@@ -64,11 +107,23 @@ typedef struct {
     double mcd_score;
 
     /* File paths */
-    char input_config[MAX_PATH];
-    char expected_output[MAX_PATH];
-    char actual_output[MAX_PATH];
+    char input_config[CASE_PATH_SIZE];
+    char expected_output[CASE_PATH_SIZE];
+    char actual_output[CASE_PATH_SIZE];
+
+    /* Results database */
+    char key[KEY_SIZE];
+    int cached;
+    int has_result;  /* cleared until the case is cached or evaluated */
 } ValidationResult;
 
+/* Cases of the test directory, sorted by name */
+typedef struct {
+    ValidationResult* items;
+    int count;
+    int capacity;
+} CaseList;
+
 /* Initialize configuration with defaults */
 static void config_init(Config* config) {
     strcpy(config->test_directory, "./tests/data");
@@ -77,15 +132,16 @@ static void config_init(Config* config) {
     config->parallel_jobs = 1;
     config->verbose = 0;
     strcpy(config->config_file, "");
+    strcpy(config->results_db, "");
+    config->use_cache = 1;
+    config->in_process = 0;
 }
 
-/* Load configuration from JSON file */
-static int load_config_file(Config* config, const char* filename) {
-    FILE* file = fopen(filename, "r");
+/* Parse a JSON file; NULL if it cannot be read or parsed */
+static cJSON* read_json_file(const char* filename) {
+    FILE* file = fopen(filename, "rb");
     if (!file) {
-        fprintf(stderr, "Error: Cannot open config file '%s': %s\n",
-                filename, strerror(errno));
-        return -1;
+        return NULL;
     }
 
     /* Read file content */
@@ -93,20 +149,30 @@ static int load_config_file(Config* config, const char* filename) {
     long file_size = ftell(file);
     fseek(file, 0, SEEK_SET);
 
-    char* content = malloc(file_size + 1);
+    char* content = file_size >= 0 ? malloc((size_t)file_size + 1) : NULL;
     if (!content) {
         fclose(file);
-        return -1;
+        return NULL;
     }
 
-    fread(content, 1, file_size, file);
-    content[file_size] = '\0';
+    size_t got = fread(content, 1, (size_t)file_size, file);
+    content[got] = '\0';
     fclose(file);
 
-    /* Parse JSON */
     cJSON* json = cJSON_Parse(content);
     free(content);
+    return json;
+}
 
+/* Load configuration from JSON file */
+static int load_config_file(Config* config, const char* filename) {
+    if (access(filename, R_OK) != 0) {
+        fprintf(stderr, "Error: Cannot open config file '%s': %s\n",
+                filename, strerror(errno));
+        return -1;
+    }
+
+    cJSON* json = read_json_file(filename);
     if (!json) {
         fprintf(stderr, "Error: Invalid JSON in config file '%s'\n", filename);
         return -1;
@@ -135,6 +201,18 @@ static int load_config_file(Config* config, const char* filename) {
         config->verbose = cJSON_IsTrue(item);
     }
 
+    if ((item = cJSON_GetObjectItem(json, "results_db")) && cJSON_IsString(item)) {
+        strncpy(config->results_db, item->valuestring, MAX_PATH - 1);
+    }
+
+    if ((item = cJSON_GetObjectItem(json, "use_cache")) && cJSON_IsBool(item)) {
+        config->use_cache = cJSON_IsTrue(item);
+    }
+
+    if ((item = cJSON_GetObjectItem(json, "in_process")) && cJSON_IsBool(item)) {
+        config->in_process = cJSON_IsTrue(item);
+    }
+
     cJSON_Delete(json);
     return 0;
 }
@@ -148,17 +226,9 @@ static void get_timestamp(char* buffer, size_t size) {
 
 /* Check if required executables exist */
 static int check_prerequisites(const Config* config) {
-    const char* required_tools[] = {
-        "./golden_runner",
-        "./audio_compare",
-        "./f0_rmse_calc",
-        "./mcd_calc",
-        "./resampler"
-    };
-
     int missing_tools = 0;
 
-    for (int i = 0; i < 5; i++) {
+    for (size_t i = 0; i < REQUIRED_TOOL_COUNT; i++) {
         if (access(required_tools[i], X_OK) != 0) {
             fprintf(stderr, "Error: Required executable '%s' not found or not executable\n",
                     required_tools[i]);
@@ -175,61 +245,425 @@ static int check_prerequisites(const Config* config) {
     return 0;
 }
 
-/* Run the golden runner and capture results */
-static int run_validation_suite(const Config* config, SuiteStats* stats) {
+/* Check if file exists */
+static int file_exists(const char* path) {
+    struct stat st;
+    return (stat(path, &st) == 0 && S_ISREG(st.st_mode));
+}
+
+static void case_path(const Config* config, const char* name, const char* file, char* path) {
+    snprintf(path, CASE_PATH_SIZE, "%s/%s/%s", config->test_directory, name, file);
+}
+
+typedef struct {
+    const Config* config;
+    CaseList* list;
+    int failed;
+} DiscoverContext;
+
+/* Take a subdirectory with input.json and expected_output.wav as a case, as golden_runner does */
+static int discover_case(void* ctx, const char* name, int is_directory) {
+    DiscoverContext* discover = (DiscoverContext*)ctx;
+    CaseList* list = discover->list;
+    if (!is_directory || strlen(name) >= MAX_PATH) {
+        return 0;
+    }
+
+    ValidationResult result;
+    memset(&result, 0, sizeof(result));
+    strcpy(result.test_name, name);
+    case_path(discover->config, name, "input.json", result.input_config);
+    case_path(discover->config, name, "expected_output.wav", result.expected_output);
+    case_path(discover->config, name, "actual_output.wav", result.actual_output);
+    if (!file_exists(result.input_config) || !file_exists(result.expected_output)) {
+        return 0;
+    }
+    result.audio_diff_score = -1.0;
+    result.f0_rmse = -1.0;
+    result.mcd_score = -1.0;
+
+    if (list->count == list->capacity) {
+        int capacity = list->capacity ? list->capacity * 2 : 64;
+        ValidationResult* items = realloc(list->items, (size_t)capacity * sizeof(ValidationResult));
+        if (!items) {
+            discover->failed = 1;
+            return 1;
+        }
+        list->items = items;
+        list->capacity = capacity;
+    }
+    list->items[list->count++] = result;
+    return 0;
+}
+
+static int compare_case_names(const void* a, const void* b) {
+    return strcmp(((const ValidationResult*)a)->test_name, ((const ValidationResult*)b)->test_name);
+}
+
+static int discover_cases(const Config* config, CaseList* list) {
+    DiscoverContext discover = { config, list, 0 };
+    if (ucra_dir_list(config->test_directory, discover_case, &discover) != UCRA_SUCCESS) {
+        fprintf(stderr, "Error: Cannot open test directory '%s'\n", config->test_directory);
+        return -1;
+    }
+    if (discover.failed) {
+        fprintf(stderr, "Error: Memory allocation failed for test cases\n");
+        return -1;
+    }
+    if (list->count > 1) {
+        qsort(list->items, (size_t)list->count, sizeof(ValidationResult), compare_case_names);
+    }
+    return 0;
+}
+
+static ValidationResult* find_case(const CaseList* list, const char* name) {
+    ValidationResult probe;
+    strncpy(probe.test_name, name, MAX_PATH - 1);
+    probe.test_name[MAX_PATH - 1] = '\0';
+    if (list->count == 0) {
+        return NULL;
+    }
+    return bsearch(&probe, list->items, (size_t)list->count, sizeof(ValidationResult), compare_case_names);
+}
+
+/* Fold label and the fingerprint of path, or its absence, into hash */
+static int hash_file(uint64_t* hash, const char* label, const char* path) {
+    char digest[KEY_SIZE];
+    *hash = ucra_fnv1a(*hash, label, strlen(label) + 1);
+    if (!file_exists(path)) {
+        *hash = ucra_fnv1a(*hash, "absent", sizeof("absent"));
+        return 0;
+    }
+    if (calculate_file_hash(path, digest) < 0) {
+        return -1;
+    }
+    *hash = ucra_fnv1a(*hash, digest, sizeof(digest));
+    return 0;
+}
+
+static void format_key(uint64_t hash, char* key) {
+    snprintf(key, KEY_SIZE, "%016llx", (unsigned long long)hash);
+}
+
+/* Key of everything outside the cases that decides their results */
+static int compute_build_hash(const Config* config, char* build_hash) {
+    const char* mode = config->in_process ? "in-process" : "tools";
+    uint64_t hash = ucra_fnv1a(UCRA_FNV_OFFSET, VERSION, sizeof(VERSION));
+    hash = ucra_fnv1a(hash, mode, strlen(mode) + 1);
+    for (size_t i = 0; i < REQUIRED_TOOL_COUNT; i++) {
+        if (hash_file(&hash, required_tools[i], required_tools[i]) < 0) {
+            return -1;
+        }
+    }
+    format_key(hash, build_hash);
+    return 0;
+}
+
+static int compute_case_key(const Config* config, const char* build_hash, ValidationResult* result) {
+    uint64_t hash = ucra_fnv1a(UCRA_FNV_OFFSET, build_hash, KEY_SIZE);
+    for (size_t i = 0; i < CASE_FILE_COUNT; i++) {
+        char path[CASE_PATH_SIZE];
+        case_path(config, result->test_name, case_files[i], path);
+        if (hash_file(&hash, case_files[i], path) < 0) {
+            return -1;
+        }
+    }
+    format_key(hash, result->key);
+    return 0;
+}
+
+static double json_number(const cJSON* object, const char* key) {
+    const cJSON* item = cJSON_GetObjectItemCaseSensitive(object, key);
+    return cJSON_IsNumber(item) ? item->valuedouble : -1.0;
+}
+
+/* Read a result written by golden_runner --results or kept in the database */
+static void result_from_json(const cJSON* item, ValidationResult* result) {
+    const cJSON* error = cJSON_GetObjectItemCaseSensitive(item, "error");
+    result->passed = cJSON_IsTrue(cJSON_GetObjectItemCaseSensitive(item, "passed"));
+    result->audio_comparison_passed = result->passed;
+    result->audio_diff_score = json_number(item, "audio_diff_score");
+    result->f0_rmse = json_number(item, "f0_rmse");
+    result->mcd_score = json_number(item, "mcd_score");
+    result->runtime = json_number(item, "runtime");
+    if (result->runtime < 0.0) {
+        result->runtime = 0.0;
+    }
+    result->error_message[0] = '\0';
+    if (cJSON_IsString(error)) {
+        strncpy(result->error_message, error->valuestring, sizeof(result->error_message) - 1);
+        result->error_message[sizeof(result->error_message) - 1] = '\0';
+    }
+    result->has_result = 1;
+}
+
+static void add_result_fields(cJSON* item, const ValidationResult* result) {
+    cJSON_AddBoolToObject(item, "passed", result->passed);
+    cJSON_AddNumberToObject(item, "audio_diff_score", result->audio_diff_score);
+    cJSON_AddNumberToObject(item, "f0_rmse", result->f0_rmse);
+    cJSON_AddNumberToObject(item, "mcd_score", result->mcd_score);
+    cJSON_AddNumberToObject(item, "runtime", result->runtime);
+    cJSON_AddStringToObject(item, "error", result->error_message);
+}
+
+/* Take the stored result of every case whose key is unchanged */
+static void load_cached_results(const Config* config, CaseList* list) {
+    cJSON* db = read_json_file(config->results_db);
+    const cJSON* cases = cJSON_GetObjectItemCaseSensitive(db, "cases");
+    if (!cJSON_IsObject(cases)) {
+        if (db && config->verbose) {
+            printf("Ignoring malformed results database '%s'\n", config->results_db);
+        }
+        cJSON_Delete(db);
+        return;
+    }
+    for (int i = 0; i < list->count; i++) {
+        ValidationResult* result = &list->items[i];
+        const cJSON* entry = cJSON_GetObjectItemCaseSensitive(cases, result->test_name);
+        const cJSON* key = cJSON_GetObjectItemCaseSensitive(entry, "key");
+        if (cJSON_IsString(key) && strcmp(key->valuestring, result->key) == 0) {
+            result_from_json(entry, result);
+            result->cached = 1;
+        }
+    }
+    cJSON_Delete(db);
+}
+
+/* Replace the database with the results of this run; cases without one are left out */
+static int save_results_db(const Config* config, const SuiteStats* stats, const CaseList* list) {
+    cJSON* db = cJSON_CreateObject();
+    cJSON* cases = cJSON_CreateObject();
+    if (!db || !cases) {
+        cJSON_Delete(db);
+        cJSON_Delete(cases);
+        return -1;
+    }
+    cJSON_AddStringToObject(db, "version", VERSION);
+    cJSON_AddStringToObject(db, "build_hash", stats->build_hash);
+    cJSON_AddItemToObject(db, "cases", cases);
+    for (int i = 0; i < list->count; i++) {
+        const ValidationResult* result = &list->items[i];
+        if (!result->has_result) {
+            continue;
+        }
+        cJSON* entry = cJSON_CreateObject();
+        if (!entry) {
+            cJSON_Delete(db);
+            return -1;
+        }
+        cJSON_AddStringToObject(entry, "key", result->key);
+        add_result_fields(entry, result);
+        cJSON_AddItemToObject(cases, result->test_name, entry);
+    }
+
+    char* text = cJSON_Print(db);
+    cJSON_Delete(db);
+    if (!text) {
+        return -1;
+    }
+    char temp_path[MAX_PATH + 32];
+    snprintf(temp_path, sizeof(temp_path), "%s.%d.tmp", config->results_db, (int)getpid());
+    FILE* file = fopen(temp_path, "w");
+    int failed = !file || fputs(text, file) < 0;
+    if (file && fclose(file) != 0) {
+        failed = 1;
+    }
+    free(text);
+    if (failed) {
+        unlink(temp_path);
+    }
+    if (failed || ucra_file_replace(temp_path, config->results_db) != UCRA_SUCCESS) {
+        fprintf(stderr, "Warning: Cannot write results database '%s'\n", config->results_db);
+        return -1;
+    }
+    return 0;
+}
+
+/* Append length bytes of text to the command of the given size; -1 if they do not fit */
+static int append_text(char* command, size_t size, const char* text, size_t length) {
+    size_t used = strlen(command);
+    if (used + length >= size) {
+        return -1;
+    }
+    memcpy(command + used, text, length);
+    command[used + length] = '\0';
+    return 0;
+}
+
+static int append_command(char* command, size_t size, const char* text) {
+    return append_text(command, size, text, strlen(text));
+}
+
+/* Append arg single-quoted for the shell, each quote in it written as '\'' */
+static int append_quoted(char* command, size_t size, const char* arg) {
+    if (append_command(command, size, "'") < 0) {
+        return -1;
+    }
+    for (const char* quote; (quote = strchr(arg, '\'')) != NULL; arg = quote + 1) {
+        if (append_text(command, size, arg, (size_t)(quote - arg)) < 0 ||
+            append_command(command, size, "'\\''") < 0) {
+            return -1;
+        }
+    }
+    return append_command(command, size, arg) < 0 ? -1 : append_command(command, size, "'");
+}
+
+/* Run the golden runner on the cases without a result and read theirs back */
+static int run_golden_runner(const Config* config, CaseList* list) {
     char command[MAX_COMMAND_LENGTH];
     char temp_output[MAX_PATH];
+    char cases_file[MAX_PATH];
+    char results_file[MAX_PATH];
 
-    /* Create temporary output file */
+    /* Create temporary files */
     snprintf(temp_output, MAX_PATH, "/tmp/ucra_validation_%d.log", getpid());
+    snprintf(cases_file, MAX_PATH, "/tmp/ucra_validation_%d.cases", getpid());
+    snprintf(results_file, MAX_PATH, "/tmp/ucra_validation_%d.results.json", getpid());
 
-    /* Build command */
-    snprintf(command, MAX_COMMAND_LENGTH,
-             "./golden_runner '%s' > '%s' 2>&1",
-             config->test_directory, temp_output);
+    FILE* cases = fopen(cases_file, "w");
+    if (!cases) {
+        fprintf(stderr, "Error: Cannot create '%s': %s\n", cases_file, strerror(errno));
+        return -1;
+    }
+    for (int i = 0; i < list->count; i++) {
+        if (!list->items[i].has_result) {
+            fprintf(cases, "%s\n", list->items[i].test_name);
+        }
+    }
+    fclose(cases);
+
+    /* Build command; golden_runner runs cases in parallel only in-process */
+    char mode[64] = "";
+    if (config->in_process) {
+        snprintf(mode, sizeof(mode), "--in-process -j %d ", config->parallel_jobs);
+    }
+    snprintf(command, MAX_COMMAND_LENGTH, "./golden_runner %s--cases ", mode);
+    if (append_quoted(command, MAX_COMMAND_LENGTH, cases_file) < 0 ||
+        append_command(command, MAX_COMMAND_LENGTH, " --results ") < 0 ||
+        append_quoted(command, MAX_COMMAND_LENGTH, results_file) < 0 ||
+        append_command(command, MAX_COMMAND_LENGTH, " ") < 0 ||
+        append_quoted(command, MAX_COMMAND_LENGTH, config->test_directory) < 0 ||
+        append_command(command, MAX_COMMAND_LENGTH, " > ") < 0 ||
+        append_quoted(command, MAX_COMMAND_LENGTH, temp_output) < 0 ||
+        append_command(command, MAX_COMMAND_LENGTH, " 2>&1") < 0) {
+        fprintf(stderr, "Error: golden_runner command for '%s' is too long\n", config->test_directory);
+        unlink(cases_file);
+        return -1;
+    }
 
     if (config->verbose) {
         printf("Executing: %s\n", command);
     }
 
-    /* Record start time */
-    get_timestamp(stats->start_time, sizeof(stats->start_time));
-    clock_t start_clock = clock();
-
     /* Execute command */
     int exit_code = system(command);
 
-    /* Record end time */
-    clock_t end_clock = clock();
-    get_timestamp(stats->end_time, sizeof(stats->end_time));
-    stats->total_runtime = (double)(end_clock - start_clock) / CLOCKS_PER_SEC;
-
-    /* Parse output for statistics */
-    FILE* output_file = fopen(temp_output, "r");
-    if (output_file) {
-        char line[512];
-        while (fgets(line, sizeof(line), output_file)) {
-            if (config->verbose) {
+    if (config->verbose) {
+        FILE* output_file = fopen(temp_output, "r");
+        if (output_file) {
+            char line[512];
+            while (fgets(line, sizeof(line), output_file)) {
                 printf("%s", line);
             }
+            fclose(output_file);
+        }
+    }
 
-            /* Parse summary line */
-            if (strstr(line, "Summary:")) {
-                sscanf(line, "Summary: %d passed, %d failed, %d total",
-                       &stats->passed_tests, &stats->failed_tests, &stats->total_tests);
-            }
+    /* Merge the results */
+    cJSON* results = read_json_file(results_file);
+    const cJSON* item = NULL;
+    cJSON_ArrayForEach(item, results) {
+        const cJSON* name = cJSON_GetObjectItemCaseSensitive(item, "name");
+        ValidationResult* result = cJSON_IsString(name) ? find_case(list, name->valuestring) : NULL;
+        if (result && !result->has_result) {
+            result_from_json(item, result);
         }
-        fclose(output_file);
     }
+    cJSON_Delete(results);
 
-    /* Cleanup temporary file */
+    /* Cleanup temporary files */
     unlink(temp_output);
+    unlink(cases_file);
+    unlink(results_file);
 
     return (exit_code == 0) ? 0 : -1;
 }
 
+/* Evaluate the cases whose key changed and merge in the cached results of the rest */
+static int run_validation_suite(const Config* config, SuiteStats* stats, CaseList* list) {
+    /* Record start time */
+    get_timestamp(stats->start_time, sizeof(stats->start_time));
+    uint64_t start_ns = ucra_time_ns();
+
+    if (discover_cases(config, list) < 0) {
+        return -1;
+    }
+    if (compute_build_hash(config, stats->build_hash) < 0) {
+        return -1;
+    }
+    for (int i = 0; i < list->count; i++) {
+        if (compute_case_key(config, stats->build_hash, &list->items[i]) < 0) {
+            return -1;
+        }
+    }
+    if (config->use_cache) {
+        load_cached_results(config, list);
+    }
+
+    int stale = 0;
+    for (int i = 0; i < list->count; i++) {
+        stale += !list->items[i].has_result;
+    }
+    if (config->verbose) {
+        printf("Build hash: %s\n", stats->build_hash);
+        printf("%d of %d test case(s) need evaluation\n", stale, list->count);
+    }
+    if (stale > 0 && run_golden_runner(config, list) < 0) {
+        return -1;
+    }
+
+    for (int i = 0; i < list->count; i++) {
+        ValidationResult* result = &list->items[i];
+        if (result->cached) {
+            stats->cached_tests++;
+        } else if (result->has_result) {
+            stats->evaluated_tests++;
+        } else {
+            strcpy(result->error_message, "No result from golden_runner");
+        }
+        if (result->passed) {
+            stats->passed_tests++;
+        } else {
+            stats->failed_tests++;
+        }
+    }
+    stats->total_tests = list->count;
+    save_results_db(config, stats, list);
+
+    /* Record end time */
+    get_timestamp(stats->end_time, sizeof(stats->end_time));
+    stats->total_runtime = (ucra_time_ns() - start_ns) / 1e9;
+    return 0;
+}
+
+/* Metrics of a case, for the console report */
+static void print_case_metrics(const ValidationResult* result) {
+    if (result->audio_diff_score >= 0) {
+        printf("      Audio Diff: %.6f\n", result->audio_diff_score);
+    }
+    if (result->f0_rmse >= 0) {
+        printf("      F0 RMSE: %.6f Hz\n", result->f0_rmse);
+    }
+    if (result->mcd_score >= 0) {
+        printf("      MCD: %.6f dB\n", result->mcd_score);
+    }
+    if (!result->passed && strlen(result->error_message) > 0) {
+        printf("      Error: %s\n", result->error_message);
+    }
+}
+
 /* Generate console report */
-static void generate_console_report(const Config* config, const SuiteStats* stats) {
+static void generate_console_report(const Config* config, const SuiteStats* stats, const CaseList* list) {
     printf("\n");
     printf("============================================================\n");
     printf("UCRA Validation Suite Report\n");
@@ -239,12 +673,25 @@ static void generate_console_report(const Config* config, const SuiteStats* stat
     printf("Start Time:      %s\n", stats->start_time);
     printf("End Time:        %s\n", stats->end_time);
     printf("Total Runtime:   %.2f seconds\n", stats->total_runtime);
+    printf("Build Hash:      %s\n", stats->build_hash);
+    printf("------------------------------------------------------------\n");
+    printf("Test Cases:\n");
+    for (int i = 0; i < list->count; i++) {
+        const ValidationResult* result = &list->items[i];
+        printf("  %-30s %s%s\n", result->test_name, result->passed ? "PASS" : "FAIL",
+               result->cached ? " (cached)" : "");
+        if (config->verbose || !result->passed) {
+            print_case_metrics(result);
+        }
+    }
     printf("------------------------------------------------------------\n");
     printf("Test Results:\n");
     printf("  Total Tests:   %d\n", stats->total_tests);
     printf("  Passed:        %d\n", stats->passed_tests);
     printf("  Failed:        %d\n", stats->failed_tests);
     printf("  Skipped:       %d\n", stats->skipped_tests);
+    printf("  Cached:        %d\n", stats->cached_tests);
+    printf("  Evaluated:     %d\n", stats->evaluated_tests);
 
     if (stats->total_tests > 0) {
         double success_rate = (100.0 * stats->passed_tests) / stats->total_tests;
@@ -263,10 +710,11 @@ static void generate_console_report(const Config* config, const SuiteStats* stat
 }
 
 /* Generate JSON report */
-static void generate_json_report(const Config* config, const SuiteStats* stats) {
+static void generate_json_report(const Config* config, const SuiteStats* stats, const CaseList* list) {
     cJSON* report = cJSON_CreateObject();
     cJSON* metadata = cJSON_CreateObject();
     cJSON* results = cJSON_CreateObject();
+    cJSON* cases = cJSON_CreateArray();
 
     /* Metadata */
     cJSON_AddStringToObject(metadata, "version", VERSION);
@@ -274,12 +722,16 @@ static void generate_json_report(const Config* config, const SuiteStats* stats)
     cJSON_AddStringToObject(metadata, "start_time", stats->start_time);
     cJSON_AddStringToObject(metadata, "end_time", stats->end_time);
     cJSON_AddNumberToObject(metadata, "total_runtime", stats->total_runtime);
+    cJSON_AddStringToObject(metadata, "build_hash", stats->build_hash);
+    cJSON_AddStringToObject(metadata, "results_db", config->results_db);
 
     /* Results */
     cJSON_AddNumberToObject(results, "total_tests", stats->total_tests);
     cJSON_AddNumberToObject(results, "passed_tests", stats->passed_tests);
     cJSON_AddNumberToObject(results, "failed_tests", stats->failed_tests);
     cJSON_AddNumberToObject(results, "skipped_tests", stats->skipped_tests);
+    cJSON_AddNumberToObject(results, "cached_tests", stats->cached_tests);
+    cJSON_AddNumberToObject(results, "evaluated_tests", stats->evaluated_tests);
 
     if (stats->total_tests > 0) {
         double success_rate = (100.0 * stats->passed_tests) / stats->total_tests;
@@ -289,6 +741,18 @@ static void generate_json_report(const Config* config, const SuiteStats* stats)
     cJSON_AddItemToObject(report, "metadata", metadata);
     cJSON_AddItemToObject(report, "results", results);
 
+    /* Cases */
+    for (int i = 0; i < list->count; i++) {
+        const ValidationResult* result = &list->items[i];
+        cJSON* item = cJSON_CreateObject();
+        cJSON_AddStringToObject(item, "name", result->test_name);
+        add_result_fields(item, result);
+        cJSON_AddBoolToObject(item, "cached", result->cached);
+        cJSON_AddStringToObject(item, "key", result->key);
+        cJSON_AddItemToArray(cases, item);
+    }
+    cJSON_AddItemToObject(report, "cases", cases);
+
     char* json_string = cJSON_Print(report);
     printf("%s\n", json_string);
 
@@ -296,15 +760,25 @@ static void generate_json_report(const Config* config, const SuiteStats* stats)
     cJSON_Delete(report);
 }
 
+/* A metric cell of the markdown report; absent metrics are dashes */
+static void print_markdown_metric(double value) {
+    if (value >= 0) {
+        printf(" %.6f |", value);
+    } else {
+        printf(" - |");
+    }
+}
+
 /* Generate Markdown report */
-static void generate_markdown_report(const Config* config, const SuiteStats* stats) {
+static void generate_markdown_report(const Config* config, const SuiteStats* stats, const CaseList* list) {
     printf("# UCRA Validation Suite Report\n\n");
     printf("## Test Configuration\n\n");
     printf("- **Version**: %s\n", VERSION);
     printf("- **Test Directory**: `%s`\n", config->test_directory);
     printf("- **Start Time**: %s\n", stats->start_time);
     printf("- **End Time**: %s\n", stats->end_time);
-    printf("- **Total Runtime**: %.2f seconds\n\n", stats->total_runtime);
+    printf("- **Total Runtime**: %.2f seconds\n", stats->total_runtime);
+    printf("- **Build Hash**: `%s`\n\n", stats->build_hash);
 
     printf("## Test Results\n\n");
     printf("| Metric | Value |\n");
@@ -313,12 +787,26 @@ static void generate_markdown_report(const Config* config, const SuiteStats* sta
     printf("| Passed | %d |\n", stats->passed_tests);
     printf("| Failed | %d |\n", stats->failed_tests);
     printf("| Skipped | %d |\n", stats->skipped_tests);
+    printf("| Cached | %d |\n", stats->cached_tests);
+    printf("| Evaluated | %d |\n", stats->evaluated_tests);
 
     if (stats->total_tests > 0) {
         double success_rate = (100.0 * stats->passed_tests) / stats->total_tests;
         printf("| Success Rate | %.1f%% |\n", success_rate);
     }
 
+    printf("\n## Test Cases\n\n");
+    printf("| Case | Status | Audio Diff | F0 RMSE | MCD | Source |\n");
+    printf("|------|--------|------------|---------|-----|--------|\n");
+    for (int i = 0; i < list->count; i++) {
+        const ValidationResult* result = &list->items[i];
+        printf("| %s | %s |", result->test_name, result->passed ? "✅ PASS" : "❌ FAIL");
+        print_markdown_metric(result->audio_diff_score);
+        print_markdown_metric(result->f0_rmse);
+        print_markdown_metric(result->mcd_score);
+        printf(" %s |\n", result->cached ? "cached" : "evaluated");
+    }
+
     printf("\n## Status\n\n");
     if (stats->failed_tests == 0) {
         printf("✅ **ALL TESTS PASSED**\n");
@@ -328,7 +816,7 @@ static void generate_markdown_report(const Config* config, const SuiteStats* sta
 }
 
 /* Save report to file */
-static int save_report_to_file(const Config* config, const SuiteStats* stats) {
+static int save_report_to_file(const Config* config, const SuiteStats* stats, const CaseList* list) {
     FILE* file = fopen(config->output_file, "w");
     if (!file) {
         fprintf(stderr, "Error: Cannot open output file '%s': %s\n",
@@ -341,11 +829,11 @@ static int save_report_to_file(const Config* config, const SuiteStats* stats) {
     stdout = file;
 
     if (strcmp(config->format, "json") == 0) {
-        generate_json_report(config, stats);
+        generate_json_report(config, stats, list);
     } else if (strcmp(config->format, "markdown") == 0) {
-        generate_markdown_report(config, stats);
+        generate_markdown_report(config, stats, list);
     } else {
-        generate_console_report(config, stats);
+        generate_console_report(config, stats, list);
     }
 
     /* Restore stdout */
@@ -366,7 +854,10 @@ static void print_usage(const char* program_name) {
     printf("  --output FILE    Output report to file (default: console)\n");
     printf("  --format FORMAT  Report format: console, json, markdown (default: console)\n");
     printf("  --parallel N     Run N test cases in parallel (default: 1)\n");
+    printf("  --in-process     Have golden_runner render and score the cases in-process\n");
     printf("  --verbose        Enable verbose output\n");
+    printf("  --results-db FILE  Results database (default: test_directory/%s)\n", RESULTS_DB_NAME);
+    printf("  --no-cache       Re-evaluate every case, then refresh the database\n");
     printf("  --help           Show this help message\n");
     printf("\n");
     printf("Arguments:\n");
@@ -398,6 +889,12 @@ int main(int argc, char* argv[]) {
             config.parallel_jobs = atoi(argv[++i]);
         } else if (strcmp(argv[i], "--verbose") == 0) {
             config.verbose = 1;
+        } else if (strcmp(argv[i], "--results-db") == 0 && i + 1 < argc) {
+            strncpy(config.results_db, argv[++i], MAX_PATH - 1);
+        } else if (strcmp(argv[i], "--no-cache") == 0) {
+            config.use_cache = 0;
+        } else if (strcmp(argv[i], "--in-process") == 0) {
+            config.in_process = 1;
         } else if (argv[i][0] != '-') {
             /* Test directory argument */
             strncpy(config.test_directory, argv[i], MAX_PATH - 1);
@@ -415,6 +912,14 @@ int main(int argc, char* argv[]) {
         }
     }
 
+    if (strlen(config.results_db) == 0) {
+        int length = snprintf(config.results_db, MAX_PATH, "%s/%s", config.test_directory, RESULTS_DB_NAME);
+        if (length < 0 || length >= MAX_PATH) {
+            fprintf(stderr, "Error: Test directory path too long for the results database; use --results-db\n");
+            return 1;
+        }
+    }
+
     /* Validate format */
     if (strcmp(config.format, "console") != 0 &&
         strcmp(config.format, "json") != 0 &&
@@ -431,6 +936,7 @@ int main(int argc, char* argv[]) {
         printf("  Output Format:  %s\n", config.format);
         printf("  Parallel Jobs:  %d\n", config.parallel_jobs);
         printf("  Verbose Mode:   %s\n", config.verbose ? "enabled" : "disabled");
+        printf("  Results DB:     %s%s\n", config.results_db, config.use_cache ? "" : " (not read)");
         if (strlen(config.output_file) > 0) {
             printf("  Output File:    %s\n", config.output_file);
         }
@@ -444,26 +950,31 @@ int main(int argc, char* argv[]) {
 
     /* Run validation suite */
     SuiteStats stats = {0};
-    if (run_validation_suite(&config, &stats) < 0) {
+    CaseList list = {0};
+    if (run_validation_suite(&config, &stats, &list) < 0) {
         fprintf(stderr, "Error: Validation suite execution failed\n");
+        free(list.items);
         return 1;
     }
 
     /* Generate report */
     if (strlen(config.output_file) > 0) {
-        if (save_report_to_file(&config, &stats) < 0) {
+        if (save_report_to_file(&config, &stats, &list) < 0) {
+            free(list.items);
             return 1;
         }
     } else {
         if (strcmp(config.format, "json") == 0) {
-            generate_json_report(&config, &stats);
+            generate_json_report(&config, &stats, &list);
         } else if (strcmp(config.format, "markdown") == 0) {
-            generate_markdown_report(&config, &stats);
+            generate_markdown_report(&config, &stats, &list);
         } else {
-            generate_console_report(&config, &stats);
+            generate_console_report(&config, &stats, &list);
         }
     }
 
+    free(list.items);
+
     /* Return appropriate exit code */
     return (stats.failed_tests == 0) ? 0 : 1;
 }